@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+
+#include "bench_stats.h"
+
+#define DT_MODEL_PATH	"/proc/device-tree/model"
+#define DT_COMPAT_PATH	"/proc/device-tree/compatible"
+
+uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int bench_result_init(bench_result_t *res, const char *name, unsigned int capacity)
+{
+	memset(res, 0, sizeof(*res));
+	res->name = name;
+
+	if (!capacity)
+		return EXIT_SUCCESS;
+
+	res->samples = calloc(capacity, sizeof(uint64_t));
+	if (!res->samples) {
+		fprintf(stderr, "%s: Unable to allocate memory for %u samples\n",
+			name, capacity);
+		return EXIT_FAILURE;
+	}
+	res->capacity = capacity;
+
+	return EXIT_SUCCESS;
+}
+
+void bench_result_add(bench_result_t *res, uint64_t ns)
+{
+	if (res->count < res->capacity)
+		res->samples[res->count++] = ns;
+}
+
+void bench_result_free(bench_result_t *res)
+{
+	free(res->samples);
+	res->samples = NULL;
+	res->count = res->capacity = 0;
+}
+
+static void json_string(FILE *out, const char *str)
+{
+	fputc('"', out);
+	for (; str && *str; str++) {
+		unsigned char c = *str;
+
+		if (c == '"' || c == '\\')
+			fprintf(out, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(out, "\\u%04x", c);
+		else
+			fputc(c, out);
+	}
+	fputc('"', out);
+}
+
+/*
+ * Read the first string of a device tree property. The 'compatible' one
+ * is a list of NUL separated strings, the first is the most specific.
+ */
+static void read_dt_string(const char *path, char *buf, size_t len)
+{
+	FILE *fp;
+	size_t n;
+
+	buf[0] = '\0';
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return;
+
+	n = fread(buf, 1, len - 1, fp);
+	buf[n] = '\0';
+	fclose(fp);
+}
+
+void bench_report_begin(bench_report_t *report, FILE *out,
+			unsigned int iterations, unsigned int duration_ms)
+{
+	struct utsname uts;
+	char model[128], compatible[128];
+
+	report->out = out;
+	report->nresults = 0;
+
+	if (uname(&uts))
+		memset(&uts, 0, sizeof(uts));
+	read_dt_string(DT_MODEL_PATH, model, sizeof(model));
+	read_dt_string(DT_COMPAT_PATH, compatible, sizeof(compatible));
+
+	fprintf(out, "{\n  \"tool\": \"ldx-bench\",\n  \"timestamp\": %lld,\n",
+		(long long)time(NULL));
+	fprintf(out, "  \"system\": {\n    \"machine\": ");
+	json_string(out, uts.machine);
+	fprintf(out, ",\n    \"kernel\": ");
+	json_string(out, uts.release);
+	fprintf(out, ",\n    \"model\": ");
+	json_string(out, model);
+	fprintf(out, ",\n    \"soc\": ");
+	json_string(out, compatible);
+	fprintf(out, "\n  },\n  \"iterations\": %u,\n  \"duration_ms\": %u,\n"
+		"  \"results\": [", iterations, duration_ms);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* Nearest-rank percentile of the sorted samples, 'per_mille' in 0..1000 */
+static uint64_t percentile(const bench_result_t *res, unsigned int per_mille)
+{
+	uint64_t rank = ((uint64_t)res->count * per_mille + 999) / 1000;
+
+	return res->samples[rank ? rank - 1 : 0];
+}
+
+static void write_latency(FILE *out, bench_result_t *res)
+{
+	unsigned int hist[BENCH_HIST_BUCKETS] = { 0 };
+	unsigned int i, b;
+	uint64_t sum = 0;
+	bool first = true;
+
+	qsort(res->samples, res->count, sizeof(uint64_t), cmp_u64);
+
+	for (i = 0; i < res->count; i++) {
+		uint64_t ns = res->samples[i];
+
+		sum += ns;
+		for (b = 0; b < BENCH_HIST_BUCKETS - 1 && ns >> (b + 1); b++)
+			;
+		hist[b]++;
+	}
+
+	fprintf(out, ",\n      \"samples\": %u,\n      \"latency_ns\": {"
+		"\"min\": %llu, \"p50\": %llu, \"p99\": %llu, \"p999\": %llu, "
+		"\"max\": %llu, \"mean\": %llu}",
+		res->count,
+		(unsigned long long)res->samples[0],
+		(unsigned long long)percentile(res, 500),
+		(unsigned long long)percentile(res, 990),
+		(unsigned long long)percentile(res, 999),
+		(unsigned long long)res->samples[res->count - 1],
+		(unsigned long long)(sum / res->count));
+
+	/* Bucket 'b' holds the latencies in [2^b, 2^(b+1)) ns */
+	fprintf(out, ",\n      \"histogram_ns\": [");
+	for (b = 0; b < BENCH_HIST_BUCKETS; b++) {
+		if (!hist[b])
+			continue;
+		fprintf(out, "%s{\"from\": %llu, \"to\": %llu, \"count\": %u}",
+			first ? "" : ", ", b ? 1ULL << b : 0ULL, 1ULL << (b + 1),
+			hist[b]);
+		first = false;
+	}
+	fprintf(out, "]");
+}
+
+void bench_report_add(bench_report_t *report, bench_result_t *res)
+{
+	FILE *out = report->out;
+
+	fprintf(out, "%s\n    {\n      \"name\": ", report->nresults ? "," : "");
+	json_string(out, res->name);
+	fprintf(out, ",\n      \"status\": \"%s\"",
+		res->skipped ? "skipped" : res->status ? "error" : "ok");
+	if (res->status) {
+		fprintf(out, ",\n      \"reason\": ");
+		json_string(out, res->status);
+	}
+
+	if (!res->skipped && !res->status) {
+		fprintf(out, ",\n      \"errors\": %llu,\n      \"mismatches\": %llu",
+			(unsigned long long)res->errors,
+			(unsigned long long)res->mismatches);
+		if (res->count)
+			write_latency(out, res);
+		if (res->elapsed_ns) {
+			double secs = res->elapsed_ns / 1e9;
+
+			fprintf(out, ",\n      \"throughput\": {\"ops_per_sec\": %.1f, "
+				"\"bytes_per_sec\": %.1f}",
+				res->ops / secs, res->bytes / secs);
+		}
+	}
+	fprintf(out, "\n    }");
+	fflush(out);
+
+	report->nresults++;
+}
+
+void bench_report_end(bench_report_t *report)
+{
+	fprintf(report->out, "%s]\n}\n", report->nresults ? "\n  " : "");
+	fflush(report->out);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef BENCH_STATS_H_
+#define BENCH_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Number of power of two buckets of the latency histograms (up to ~18 min) */
+#define BENCH_HIST_BUCKETS	40
+
+/**
+ * bench_result_t - Measurements of a single benchmark
+ *
+ * @name:		Name of the benchmark, 'subsystem_operation'.
+ * @samples:		Latency of each measured call, in ns.
+ * @count:		Number of samples stored.
+ * @capacity:		Number of samples the array can hold.
+ * @errors:		Number of calls that failed.
+ * @mismatches:		Number of loopback transfers whose data did not match.
+ * @ops:		Number of operations of the throughput run.
+ * @bytes:		Number of payload bytes moved by the throughput run.
+ * @elapsed_ns:		Duration of the throughput run, 0 if there was none.
+ * @status:		NULL if the benchmark ran, the reason it did not
+ *			otherwise.
+ * @skipped:		True if the benchmark was not configured.
+ */
+typedef struct {
+	const char *name;
+	uint64_t *samples;
+	unsigned int count;
+	unsigned int capacity;
+	uint64_t errors;
+	uint64_t mismatches;
+	uint64_t ops;
+	uint64_t bytes;
+	uint64_t elapsed_ns;
+	const char *status;
+	bool skipped;
+} bench_result_t;
+
+/**
+ * bench_report_t - JSON report the results are written to
+ *
+ * @out:	Stream of the report.
+ * @nresults:	Number of results written so far.
+ */
+typedef struct {
+	FILE *out;
+	unsigned int nresults;
+} bench_report_t;
+
+/**
+ * bench_now_ns() - Get the current time of the monotonic clock
+ *
+ * Return: The time in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * bench_result_init() - Prepare a result to store measurements
+ *
+ * @res:	The result to initialize.
+ * @name:	Name of the benchmark.
+ * @capacity:	Maximum number of latency samples.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int bench_result_init(bench_result_t *res, const char *name, unsigned int capacity);
+
+/**
+ * bench_result_add() - Store the latency of a call
+ *
+ * @res:	The result.
+ * @ns:		The latency in nanoseconds.
+ */
+void bench_result_add(bench_result_t *res, uint64_t ns);
+
+/**
+ * bench_result_free() - Release the memory of a result
+ *
+ * @res:	The result.
+ */
+void bench_result_free(bench_result_t *res);
+
+/**
+ * bench_report_begin() - Start a JSON report
+ *
+ * @report:	The report to start.
+ * @out:	Stream to write the report to.
+ * @iterations:	Number of latency samples per benchmark.
+ * @duration_ms:	Duration of the throughput runs.
+ *
+ * The report includes the information of the system (machine, kernel and
+ * SoC model from the device tree) to compare runs of the same board.
+ */
+void bench_report_begin(bench_report_t *report, FILE *out,
+			unsigned int iterations, unsigned int duration_ms);
+
+/**
+ * bench_report_add() - Write a result to a JSON report
+ *
+ * @report:	The report.
+ * @res:	The result to write.
+ *
+ * The latencies are sorted to compute the percentiles.
+ */
+void bench_report_add(bench_report_t *report, bench_result_t *res);
+
+/**
+ * bench_report_end() - Finish a JSON report
+ *
+ * @report:	The report.
+ */
+void bench_report_end(bench_report_t *report);
+
+#endif /* BENCH_STATS_H_ */
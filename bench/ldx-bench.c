@@ -0,0 +1,774 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "adc.h"
+#ifndef CONFIG_DISABLE_CAN
+#include "can.h"
+#endif
+#include "gpio.h"
+#include "i2c.h"
+#include "spi.h"
+
+#include "bench_stats.h"
+
+#define DEF_ITERATIONS		10000
+#define DEF_WARMUP		100
+#define DEF_DURATION_MS		2000
+#define DEF_SPI_LEN		16
+#define DEF_I2C_LEN		2
+
+#define MAX_XFER_LEN		4096
+
+/* Maximum time for a value to come back through a loopback */
+#define LOOPBACK_TIMEOUT_NS	10000000ULL
+#define CAN_LOOPBACK_TIMEOUT_MS	100
+
+#define BENCH_CAN_ID		0x123
+#define BENCH_CAN_RX_QUEUE_LEN	4096
+
+/* Operations between clock reads in the throughput runs */
+#define THROUGHPUT_CHUNK	16
+
+/**
+ * bench_cfg_t - Configuration of a benchmark run
+ *
+ * @iterations:		Number of latency samples per benchmark.
+ * @warmup:		Number of calls before the latency samples.
+ * @duration_ms:	Duration of each throughput run.
+ * @gpio_out:		Output GPIO (kernel number or alias).
+ * @gpio_in:		Input GPIO wired to the output one, or NULL.
+ * @spi:		SPI to use ('device,slave' or alias).
+ * @spi_len:		Bytes per SPI transfer.
+ * @spi_speed:		SPI bus speed in Hz, 0 to keep the current one.
+ * @i2c:		I2C bus to use (bus number or alias).
+ * @i2c_addr:		Address of the I2C slave device.
+ * @i2c_len:		Bytes read per I2C transfer.
+ * @can:		CAN interface to use (for example 'vcan0').
+ * @adc:		ADC to use ('chip,channel' or alias).
+ */
+typedef struct {
+	unsigned int iterations;
+	unsigned int warmup;
+	unsigned int duration_ms;
+	const char *gpio_out;
+	const char *gpio_in;
+	const char *spi;
+	unsigned int spi_len;
+	unsigned int spi_speed;
+	const char *i2c;
+	unsigned int i2c_addr;
+	unsigned int i2c_len;
+	const char *can;
+	const char *adc;
+} bench_cfg_t;
+
+typedef void (*bench_fn_t)(const bench_cfg_t *cfg, bench_report_t *report);
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [options] [gpio] [spi] [i2c] [can] [adc]\n\n"
+	       "Measure the latency and throughput of the libdigiapix APIs and write\n"
+	       "the results in JSON. Without arguments, every subsystem is run and\n"
+	       "those not configured are reported as skipped.\n\n"
+	       "Options:\n"
+	       "  -n, --iterations=N      Latency samples per benchmark (%u)\n"
+	       "  -w, --warmup=N          Calls before measuring (%u)\n"
+	       "  -t, --time=MS           Duration of the throughput runs (%u)\n"
+	       "  -o, --output=FILE       Write the results to FILE instead of stdout\n"
+	       "  -g, --gpio=OUT[,IN]     Output GPIO and input GPIO wired to it\n"
+	       "                          (kernel numbers or aliases)\n"
+	       "  -s, --spi=DEV,SLAVE     SPI device and slave, or alias. Wire MOSI to\n"
+	       "                          MISO to verify the data\n"
+	       "      --spi-len=N         Bytes per SPI transfer (%u)\n"
+	       "      --spi-speed=HZ      SPI bus speed\n"
+	       "  -i, --i2c=BUS,ADDR      I2C bus (number or alias) and slave address\n"
+	       "      --i2c-len=N         Bytes read per I2C transfer (%u)\n"
+	       "  -c, --can=IFACE         CAN interface, for example vcan0\n"
+	       "  -a, --adc=CHIP,CHANNEL  ADC chip and channel, or alias\n"
+	       "  -h, --help              Show this help\n",
+	       name, DEF_ITERATIONS, DEF_WARMUP, DEF_DURATION_MS, DEF_SPI_LEN,
+	       DEF_I2C_LEN);
+}
+
+static bool is_number(const char *str)
+{
+	if (!*str)
+		return false;
+
+	for (; *str; str++) {
+		if (!isdigit((unsigned char)*str))
+			return false;
+	}
+
+	return true;
+}
+
+/* Parse a 'number,number' specification */
+static bool parse_pair(const char *spec, unsigned int *a, unsigned int *b)
+{
+	char *end;
+
+	errno = 0;
+	*a = strtoul(spec, &end, 0);
+	if (errno || end == spec || *end != ',')
+		return false;
+
+	spec = end + 1;
+	*b = strtoul(spec, &end, 0);
+
+	return !errno && end != spec && *end == '\0';
+}
+
+static bool time_is_up(uint64_t start, const bench_cfg_t *cfg)
+{
+	return bench_now_ns() - start >= (uint64_t)cfg->duration_ms * 1000000ULL;
+}
+
+static void report_status(bench_report_t *report, const char *name,
+			  const char *reason, bool skipped)
+{
+	bench_result_t res;
+
+	bench_result_init(&res, name, 0);
+	res.status = reason;
+	res.skipped = skipped;
+	bench_report_add(report, &res);
+}
+
+static gpio_t *request_gpio(const char *spec, gpio_mode_t mode)
+{
+	if (is_number(spec))
+		return ldx_gpio_request_fast(strtoul(spec, NULL, 10), mode);
+
+	return ldx_gpio_request_by_alias(spec, mode, REQUEST_SHARED);
+}
+
+static void bench_gpio(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	gpio_t *out = NULL, *in = NULL;
+	bench_result_t res;
+	uint64_t start, t0;
+	unsigned int i;
+
+	if (!cfg->gpio_out) {
+		report_status(report, "gpio_set_value", "no GPIO configured (--gpio)", true);
+		report_status(report, "gpio_loopback", "no GPIO configured (--gpio)", true);
+		return;
+	}
+
+	out = request_gpio(cfg->gpio_out, GPIO_OUTPUT_LOW);
+	if (!out) {
+		report_status(report, "gpio_set_value", "unable to request output GPIO", false);
+		report_status(report, "gpio_loopback", "unable to request output GPIO", false);
+		return;
+	}
+
+	if (bench_result_init(&res, "gpio_set_value", cfg->iterations) == EXIT_SUCCESS) {
+		for (i = 0; i < cfg->warmup; i++)
+			ldx_gpio_set_value(out, i & 1 ? GPIO_HIGH : GPIO_LOW);
+
+		for (i = 0; i < cfg->iterations; i++) {
+			t0 = bench_now_ns();
+			if (ldx_gpio_set_value(out, i & 1 ? GPIO_HIGH : GPIO_LOW))
+				res.errors++;
+			else
+				bench_result_add(&res, bench_now_ns() - t0);
+		}
+
+		start = bench_now_ns();
+		do {
+			for (i = 0; i < THROUGHPUT_CHUNK; i++)
+				ldx_gpio_set_value(out, res.ops++ & 1 ? GPIO_HIGH : GPIO_LOW);
+		} while (!time_is_up(start, cfg));
+		res.elapsed_ns = bench_now_ns() - start;
+
+		bench_report_add(report, &res);
+		bench_result_free(&res);
+	}
+
+	if (!cfg->gpio_in) {
+		report_status(report, "gpio_loopback", "no input GPIO configured (--gpio)", true);
+		goto free_out;
+	}
+
+	in = request_gpio(cfg->gpio_in, GPIO_INPUT);
+	if (!in) {
+		report_status(report, "gpio_loopback", "unable to request input GPIO", false);
+		goto free_out;
+	}
+
+	/* Time from setting the output until the input reads the new value */
+	if (bench_result_init(&res, "gpio_loopback", cfg->iterations) == EXIT_SUCCESS) {
+		for (i = 0; i < cfg->iterations + cfg->warmup; i++) {
+			gpio_value_t value = i & 1 ? GPIO_HIGH : GPIO_LOW;
+			gpio_value_t read;
+			uint64_t elapsed;
+
+			t0 = bench_now_ns();
+			if (ldx_gpio_set_value(out, value)) {
+				res.errors++;
+				continue;
+			}
+			do {
+				read = ldx_gpio_get_value(in);
+				elapsed = bench_now_ns() - t0;
+			} while (read != value && elapsed < LOOPBACK_TIMEOUT_NS);
+
+			if (read != value)
+				res.mismatches++;
+			else if (i >= cfg->warmup)
+				bench_result_add(&res, elapsed);
+		}
+
+		bench_report_add(report, &res);
+		bench_result_free(&res);
+	}
+
+	ldx_gpio_free(in);
+
+free_out:
+	ldx_gpio_free(out);
+}
+
+static void bench_spi(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	uint8_t tx[MAX_XFER_LEN], rx[MAX_XFER_LEN];
+	unsigned int dev, slave, i;
+	bench_result_t res;
+	spi_t *spi = NULL;
+	uint64_t start, t0;
+
+	if (!cfg->spi) {
+		report_status(report, "spi_transfer", "no SPI configured (--spi)", true);
+		return;
+	}
+
+	if (parse_pair(cfg->spi, &dev, &slave))
+		spi = ldx_spi_request(dev, slave);
+	else
+		spi = ldx_spi_request_by_alias(cfg->spi);
+	if (!spi) {
+		report_status(report, "spi_transfer", "unable to request SPI", false);
+		return;
+	}
+
+	if (cfg->spi_speed && ldx_spi_set_speed(spi, cfg->spi_speed)) {
+		report_status(report, "spi_transfer", "unable to set SPI speed", false);
+		goto free_spi;
+	}
+
+	if (bench_result_init(&res, "spi_transfer", cfg->iterations))
+		goto free_spi;
+
+	for (i = 0; i < cfg->warmup; i++)
+		ldx_spi_transfer(spi, tx, rx, cfg->spi_len);
+
+	/* With MOSI wired to MISO, the data read must be the data written */
+	for (i = 0; i < cfg->iterations; i++) {
+		memset(tx, i, cfg->spi_len);
+		tx[0] = ~i;
+
+		t0 = bench_now_ns();
+		if (ldx_spi_transfer(spi, tx, rx, cfg->spi_len)) {
+			res.errors++;
+			continue;
+		}
+		bench_result_add(&res, bench_now_ns() - t0);
+
+		if (memcmp(tx, rx, cfg->spi_len))
+			res.mismatches++;
+	}
+
+	start = bench_now_ns();
+	do {
+		for (i = 0; i < THROUGHPUT_CHUNK; i++) {
+			if (ldx_spi_transfer(spi, tx, rx, cfg->spi_len)) {
+				res.errors++;
+				continue;
+			}
+			res.ops++;
+			res.bytes += cfg->spi_len;
+		}
+	} while (!time_is_up(start, cfg));
+	res.elapsed_ns = bench_now_ns() - start;
+
+	bench_report_add(report, &res);
+	bench_result_free(&res);
+
+free_spi:
+	ldx_spi_free(spi);
+}
+
+static void bench_i2c(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	uint8_t rx[MAX_XFER_LEN], reg = 0;
+	bench_result_t res;
+	i2c_t *i2c = NULL;
+	uint64_t start, t0;
+	unsigned int i;
+
+	if (!cfg->i2c) {
+		report_status(report, "i2c_transfer", "no I2C configured (--i2c)", true);
+		return;
+	}
+
+	if (is_number(cfg->i2c))
+		i2c = ldx_i2c_request(strtoul(cfg->i2c, NULL, 10));
+	else
+		i2c = ldx_i2c_request_by_alias(cfg->i2c);
+	if (!i2c) {
+		report_status(report, "i2c_transfer", "unable to request I2C", false);
+		return;
+	}
+
+	if (bench_result_init(&res, "i2c_transfer", cfg->iterations))
+		goto free_i2c;
+
+	/* Register read: write the register address and read its value */
+	for (i = 0; i < cfg->warmup; i++)
+		ldx_i2c_transfer(i2c, cfg->i2c_addr, &reg, 1, rx, cfg->i2c_len);
+
+	for (i = 0; i < cfg->iterations; i++) {
+		t0 = bench_now_ns();
+		if (ldx_i2c_transfer(i2c, cfg->i2c_addr, &reg, 1, rx, cfg->i2c_len))
+			res.errors++;
+		else
+			bench_result_add(&res, bench_now_ns() - t0);
+	}
+
+	start = bench_now_ns();
+	do {
+		for (i = 0; i < THROUGHPUT_CHUNK; i++) {
+			if (ldx_i2c_transfer(i2c, cfg->i2c_addr, &reg, 1, rx,
+					     cfg->i2c_len)) {
+				res.errors++;
+				continue;
+			}
+			res.ops++;
+			res.bytes += cfg->i2c_len;
+		}
+	} while (!time_is_up(start, cfg));
+	res.elapsed_ns = bench_now_ns() - start;
+
+	bench_report_add(report, &res);
+	bench_result_free(&res);
+
+free_i2c:
+	ldx_i2c_free(i2c);
+}
+
+#ifndef CONFIG_DISABLE_CAN
+static void can_fill_frame(struct canfd_frame *frame, uint32_t seq)
+{
+	memset(frame, 0, sizeof(*frame));
+	frame->can_id = BENCH_CAN_ID;
+	frame->len = CAN_MAX_DLEN;
+	memcpy(frame->data, &seq, sizeof(seq));
+}
+
+static void can_drain(can_if_t *cif)
+{
+	struct canfd_frame frames[LDX_CAN_BATCH_LEN];
+
+	while (ldx_can_rx_pop_batch(cif, frames, NULL, LDX_CAN_BATCH_LEN, 0) > 0)
+		;
+}
+
+static void bench_can_latency(const bench_cfg_t *cfg, bench_report_t *report,
+			      can_if_t *cif)
+{
+	struct canfd_frame frame, rx;
+	bench_result_t res;
+	unsigned int i;
+	uint64_t t0;
+	int ret;
+
+	if (bench_result_init(&res, "can_tx_frame", cfg->iterations))
+		return;
+
+	for (i = 0; i < cfg->iterations + cfg->warmup; i++) {
+		can_fill_frame(&frame, i);
+
+		t0 = bench_now_ns();
+		ret = ldx_can_tx_frame(cif, &frame);
+		if (ret) {
+			res.errors++;
+			/* Let the controller empty its queue */
+			if (ret == -CAN_ERROR_TX_RETRY_LATER)
+				usleep(1000);
+			continue;
+		}
+		if (i >= cfg->warmup)
+			bench_result_add(&res, bench_now_ns() - t0);
+
+		/* Keep the rx queue from overflowing */
+		if (!(i % LDX_CAN_BATCH_LEN))
+			can_drain(cif);
+	}
+
+	bench_report_add(report, &res);
+	bench_result_free(&res);
+
+	/*
+	 * Time from the transmission of a frame until it is taken from the rx
+	 * queue. On vcan, or with the controller in loopback mode, every frame
+	 * sent comes back.
+	 */
+	if (bench_result_init(&res, "can_loopback", cfg->iterations))
+		return;
+
+	can_drain(cif);
+	for (i = 0; i < cfg->iterations + cfg->warmup; i++) {
+		uint32_t seq;
+
+		can_fill_frame(&frame, i);
+
+		t0 = bench_now_ns();
+		if (ldx_can_tx_frame(cif, &frame)) {
+			res.errors++;
+			continue;
+		}
+
+		do {
+			ret = ldx_can_rx_pop(cif, &rx, NULL, CAN_LOOPBACK_TIMEOUT_MS);
+			memcpy(&seq, rx.data, sizeof(seq));
+		} while (ret > 0 && (rx.can_id != BENCH_CAN_ID || seq != i));
+
+		if (ret <= 0)
+			res.mismatches++;
+		else if (i >= cfg->warmup)
+			bench_result_add(&res, bench_now_ns() - t0);
+	}
+
+	bench_report_add(report, &res);
+	bench_result_free(&res);
+}
+
+static void bench_can_throughput(const bench_cfg_t *cfg, bench_report_t *report,
+				 can_if_t *cif)
+{
+	struct canfd_frame frames[LDX_CAN_BATCH_LEN];
+	bench_result_t res;
+	uint64_t start;
+	unsigned int i;
+	int ret;
+
+	bench_result_init(&res, "can_tx_frames", 0);
+
+	for (i = 0; i < LDX_CAN_BATCH_LEN; i++)
+		can_fill_frame(&frames[i], i);
+
+	can_drain(cif);
+	start = bench_now_ns();
+	do {
+		ret = ldx_can_tx_frames(cif, frames, LDX_CAN_BATCH_LEN);
+		if (ret > 0) {
+			res.ops += ret;
+			res.bytes += ret * CAN_MAX_DLEN;
+		} else if (ret == -CAN_ERROR_TX_RETRY_LATER) {
+			sched_yield();
+		} else {
+			res.errors++;
+		}
+		can_drain(cif);
+	} while (!time_is_up(start, cfg));
+	res.elapsed_ns = bench_now_ns() - start;
+
+	bench_report_add(report, &res);
+}
+
+static void bench_can(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	can_if_cfg_t ifcfg;
+	can_if_t *cif;
+	int ret;
+
+	if (!cfg->can) {
+		report_status(report, "can_tx_frame", "no CAN configured (--can)", true);
+		report_status(report, "can_loopback", "no CAN configured (--can)", true);
+		report_status(report, "can_tx_frames", "no CAN configured (--can)", true);
+		return;
+	}
+
+	cif = ldx_can_request_by_name(cfg->can);
+	if (!cif) {
+		report_status(report, "can_tx_frame", "unable to request CAN", false);
+		return;
+	}
+
+	ldx_can_set_defconfig(&ifcfg);
+	ifcfg.rx_queue_len = BENCH_CAN_RX_QUEUE_LEN;
+
+	ret = ldx_can_init(cif, &ifcfg);
+	if (ret) {
+		report_status(report, "can_tx_frame", ldx_can_strerror(-ret), false);
+		goto free_can;
+	}
+
+	bench_can_latency(cfg, report, cif);
+	bench_can_throughput(cfg, report, cif);
+
+free_can:
+	ldx_can_free(cif);
+}
+#else
+static void bench_can(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	report_status(report, "can_tx_frame", "built without CAN support", true);
+}
+#endif /* CONFIG_DISABLE_CAN */
+
+static void bench_adc(const bench_cfg_t *cfg, bench_report_t *report)
+{
+	unsigned int chip, channel, i;
+	bench_result_t res;
+	adc_t *adc = NULL;
+	uint64_t start, t0;
+
+	if (!cfg->adc) {
+		report_status(report, "adc_get_sample", "no ADC configured (--adc)", true);
+		return;
+	}
+
+	if (parse_pair(cfg->adc, &chip, &channel))
+		adc = ldx_adc_request(chip, channel);
+	else
+		adc = ldx_adc_request_by_alias(cfg->adc);
+	if (!adc) {
+		report_status(report, "adc_get_sample", "unable to request ADC", false);
+		return;
+	}
+
+	if (bench_result_init(&res, "adc_get_sample", cfg->iterations))
+		goto free_adc;
+
+	for (i = 0; i < cfg->warmup; i++)
+		ldx_adc_get_sample(adc);
+
+	for (i = 0; i < cfg->iterations; i++) {
+		t0 = bench_now_ns();
+		if (ldx_adc_get_sample(adc) < 0)
+			res.errors++;
+		else
+			bench_result_add(&res, bench_now_ns() - t0);
+	}
+
+	start = bench_now_ns();
+	do {
+		for (i = 0; i < THROUGHPUT_CHUNK; i++) {
+			if (ldx_adc_get_sample(adc) < 0) {
+				res.errors++;
+				continue;
+			}
+			res.ops++;
+			res.bytes += sizeof(int);
+		}
+	} while (!time_is_up(start, cfg));
+	res.elapsed_ns = bench_now_ns() - start;
+
+	bench_report_add(report, &res);
+	bench_result_free(&res);
+
+free_adc:
+	ldx_adc_free(adc);
+}
+
+static const struct {
+	const char *name;
+	bench_fn_t fn;
+} benchmarks[] = {
+	{ "gpio", bench_gpio },
+	{ "spi", bench_spi },
+	{ "i2c", bench_i2c },
+	{ "can", bench_can },
+	{ "adc", bench_adc },
+};
+
+#define NUM_BENCHMARKS	(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+enum {
+	OPT_SPI_LEN = 256,
+	OPT_SPI_SPEED,
+	OPT_I2C_LEN,
+};
+
+static const struct option long_options[] = {
+	{ "iterations", required_argument, NULL, 'n' },
+	{ "warmup", required_argument, NULL, 'w' },
+	{ "time", required_argument, NULL, 't' },
+	{ "output", required_argument, NULL, 'o' },
+	{ "gpio", required_argument, NULL, 'g' },
+	{ "spi", required_argument, NULL, 's' },
+	{ "spi-len", required_argument, NULL, OPT_SPI_LEN },
+	{ "spi-speed", required_argument, NULL, OPT_SPI_SPEED },
+	{ "i2c", required_argument, NULL, 'i' },
+	{ "i2c-len", required_argument, NULL, OPT_I2C_LEN },
+	{ "can", required_argument, NULL, 'c' },
+	{ "adc", required_argument, NULL, 'a' },
+	{ "help", no_argument, NULL, 'h' },
+	{ NULL, 0, NULL, 0 }
+};
+
+static bool parse_uint(const char *str, unsigned int min, unsigned int max,
+		       unsigned int *val)
+{
+	unsigned long v;
+	char *end;
+
+	errno = 0;
+	v = strtoul(str, &end, 0);
+	if (errno || end == str || *end || v < min || v > max)
+		return false;
+
+	*val = v;
+
+	return true;
+}
+
+static bool parse_i2c(char *spec, bench_cfg_t *cfg)
+{
+	char *comma = strrchr(spec, ',');
+
+	if (!comma || !parse_uint(comma + 1, 0, 0x3ff, &cfg->i2c_addr))
+		return false;
+
+	*comma = '\0';
+	cfg->i2c = spec;
+
+	return *spec != '\0';
+}
+
+int main(int argc, char *argv[])
+{
+	bench_cfg_t cfg = {
+		.iterations = DEF_ITERATIONS,
+		.warmup = DEF_WARMUP,
+		.duration_ms = DEF_DURATION_MS,
+		.spi_len = DEF_SPI_LEN,
+		.i2c_len = DEF_I2C_LEN,
+	};
+	bool selected[NUM_BENCHMARKS] = { false };
+	bool any_selected = false;
+	bench_report_t report;
+	FILE *out = stdout;
+	char *comma;
+	unsigned int i;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "n:w:t:o:g:s:i:c:a:h", long_options,
+				  NULL)) != -1) {
+		bool ok = true;
+
+		switch (opt) {
+		case 'n':
+			ok = parse_uint(optarg, 1, 100000000, &cfg.iterations);
+			break;
+		case 'w':
+			ok = parse_uint(optarg, 0, 100000000, &cfg.warmup);
+			break;
+		case 't':
+			ok = parse_uint(optarg, 1, 3600000, &cfg.duration_ms);
+			break;
+		case 'o':
+			out = fopen(optarg, "w");
+			if (!out) {
+				fprintf(stderr, "Unable to open '%s': %s\n", optarg,
+					strerror(errno));
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'g':
+			cfg.gpio_out = optarg;
+			comma = strchr(optarg, ',');
+			if (comma) {
+				*comma = '\0';
+				cfg.gpio_in = comma + 1;
+			}
+			break;
+		case 's':
+			cfg.spi = optarg;
+			break;
+		case OPT_SPI_LEN:
+			ok = parse_uint(optarg, 1, MAX_XFER_LEN, &cfg.spi_len);
+			break;
+		case OPT_SPI_SPEED:
+			ok = parse_uint(optarg, 1, UINT32_MAX, &cfg.spi_speed);
+			break;
+		case 'i':
+			ok = parse_i2c(optarg, &cfg);
+			break;
+		case OPT_I2C_LEN:
+			ok = parse_uint(optarg, 1, MAX_XFER_LEN, &cfg.i2c_len);
+			break;
+		case 'c':
+			cfg.can = optarg;
+			break;
+		case 'a':
+			cfg.adc = optarg;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		if (!ok) {
+			fprintf(stderr, "Invalid value for option '%c': %s\n",
+				opt < 256 ? opt : '-', optarg);
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (; optind < argc; optind++) {
+		for (i = 0; i < NUM_BENCHMARKS; i++) {
+			if (!strcmp(argv[optind], benchmarks[i].name))
+				break;
+		}
+		if (i == NUM_BENCHMARKS) {
+			fprintf(stderr, "Unknown subsystem '%s'\n", argv[optind]);
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		selected[i] = any_selected = true;
+	}
+
+	/* Keep the library messages below errors out of the measurements */
+	ldx_set_log_level(LOG_ERR);
+
+	bench_report_begin(&report, out, cfg.iterations, cfg.duration_ms);
+	for (i = 0; i < NUM_BENCHMARKS; i++) {
+		if (!any_selected || selected[i])
+			benchmarks[i].fn(&cfg, &report);
+	}
+	bench_report_end(&report);
+
+	if (out != stdout)
+		fclose(out);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,767 @@
+# Copyright 2022, Digi International Inc.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+from array import array
+from ctypes import addressof, byref, c_bool, c_char_p, c_float, c_int, c_int64, c_size_t, \
+    c_uint, c_uint64, c_void_p, POINTER, Structure
+
+from digi.apix import library
+from digi.apix.common import _buffer_from
+from digi.apix.exceptions import DigiAPIXException
+
+# Constants.
+_ERROR_ADCS = "ADCs must be a non empty list of ADC objects"
+_ERROR_ALIAS = "Alias must be a valid string"
+_ERROR_CHANNEL = "Channel must be a positive integer"
+_ERROR_CHANNELS = "Channels must be a non empty list of positive integers"
+_ERROR_CHIP = "Chip must be a positive integer"
+_ERROR_INDEX = "Index must be a valid channel index of the capture"
+_ERROR_SCALE = "Scale must be a positive number"
+_ERROR_SCANS = "Scans must be a whole number of scans of the capture"
+_ERROR_SCANS_MAX = "Maximum number of scans must be a positive integer"
+
+# Variables.
+_libdigiapix = None
+
+
+class ADCException(DigiAPIXException):
+    """
+    Exception thrown when an error occurs working with ADCs
+    """
+
+
+class _ADCStruct(Structure):
+    """
+    Internal class to store C library ADC struct data.
+    """
+    _fields_ = [('alias', c_char_p),
+                ('chip', c_uint),
+                ('channel', c_uint),
+                ('data', c_void_p)]
+
+
+class _ADCGroupStruct(Structure):
+    """
+    Internal class to store C library ADC group struct data.
+    """
+    _fields_ = [('num_adcs', c_uint),
+                ('data', c_void_p)]
+
+
+class _ADCGroupStatsStruct(Structure):
+    """
+    Internal class to store C library ADC group statistics struct data.
+    """
+    _fields_ = [('ticks', c_uint64),
+                ('missed', c_uint64),
+                ('max_latency_ns', c_uint64),
+                ('last_latency_ns', c_uint64)]
+
+
+class _ADCScanFormatStruct(Structure):
+    """
+    Internal class to store C library ADC scan format struct data.
+    """
+    _fields_ = [('is_signed', c_bool),
+                ('is_be', c_bool),
+                ('realbits', c_uint),
+                ('storagebits', c_uint),
+                ('shift', c_uint),
+                ('offset', c_uint)]
+
+
+class _ADCBufferCfgStruct(Structure):
+    """
+    Internal class to store C library ADC buffer configuration struct data.
+    """
+    _fields_ = [('frequency', c_uint),
+                ('buffer_len', c_uint),
+                ('watermark', c_uint),
+                ('timestamp', c_bool),
+                ('trigger', c_char_p)]
+
+
+class _ADCBufferStruct(Structure):
+    """
+    Internal class to store C library ADC buffer struct data.
+    """
+    _fields_ = [('chip', c_uint),
+                ('num_channels', c_uint),
+                ('scan_size', c_uint),
+                ('data', c_void_p)]
+
+
+def _int_array(samples):
+    """
+    Returns a ctypes int array with the given samples.
+
+    Writable `array.array('i')` objects (and other buffers of C ints) are used in place,
+    other sequences are copied once.
+
+    Args:
+        samples (Object): The samples.
+
+    Returns:
+        :class:`ctypes.Array`: The ctypes int array.
+    """
+    try:
+        view = memoryview(samples)
+    except TypeError:
+        return (c_int * len(samples))(*samples)
+
+    if view.format == "i" and view.ndim == 1 and view.c_contiguous and not view.readonly:
+        return (c_int * len(view)).from_buffer(view)
+    return (c_int * len(view))(*view.tolist())
+
+
+class ADC:
+    """
+    This class represents an ADC channel. Instances of ADC should be created using the
+    'ADC.create_from_<x>' family of functions.
+    """
+
+    def __init__(self, adc_struct):
+        """
+        Class constructor. This method should not be called directly, instead use the
+        'ADC.create_from_<x>' family of functions.
+        """
+        self._adc_struct = adc_struct
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free ADC struct.
+        _libdigiapix.ldx_adc_free(self._adc_struct)
+
+    @classmethod
+    def create(cls, chip, channel):
+        """
+        Requests a new ADC using the given chip and channel.
+
+        Args:
+            chip (Integer): The ADC chip.
+            channel (Integer): The ADC channel.
+
+        Returns:
+            :class:`.ADC`: The instantiated ADC.
+
+        Raises:
+            ValueError: if `chip` or `channel` are not positive integers.
+            DigiAPIXException: if there is any error loading the library.
+            ADCException: if there is any error creating the ADC.
+        """
+        # Sanity checks.
+        if not isinstance(chip, int) or chip < 0:
+            raise ValueError(_ERROR_CHIP)
+        if not isinstance(channel, int) or channel < 0:
+            raise ValueError(_ERROR_CHANNEL)
+        _check_library()
+
+        adc_struct = _libdigiapix.ldx_adc_request(chip, channel)
+        if not adc_struct:
+            raise ADCException("Error creating ADC")
+        return cls(adc_struct)
+
+    @classmethod
+    def create_from_alias(cls, alias):
+        """
+        Requests a new ADC using the given alias.
+
+        Args:
+            alias (String): The alias name of the ADC to request.
+
+        Returns:
+            :class:`.ADC`: The instantiated ADC.
+
+        Raises:
+            ValueError: if `alias` is not a valid string.
+            DigiAPIXException: if there is any error loading the library.
+            ADCException: if there is any error creating the ADC.
+        """
+        # Sanity checks.
+        if not isinstance(alias, str):
+            raise ValueError(_ERROR_ALIAS)
+        _check_library()
+
+        adc_struct = _libdigiapix.ldx_adc_request_by_alias(
+            alias.encode(encoding="ascii", errors="ignore"))
+        if not adc_struct:
+            raise ADCException("Error creating ADC")
+        return cls(adc_struct)
+
+    @property
+    def alias(self):
+        """
+        Returns the ADC alias.
+
+        Returns:
+            String: ADC alias.
+        """
+        alias = self._adc_struct.contents.alias
+        return alias.decode(encoding="ascii", errors="ignore") if alias else None
+
+    @property
+    def chip(self):
+        """
+        Returns the ADC chip.
+
+        Returns:
+            Integer: ADC chip.
+        """
+        return self._adc_struct.contents.chip
+
+    @property
+    def channel(self):
+        """
+        Returns the ADC channel.
+
+        Returns:
+            Integer: ADC channel.
+        """
+        return self._adc_struct.contents.channel
+
+    def set_scale(self, scale):
+        """
+        Sets the scale factor applied to the raw samples to convert them to mV.
+
+        Args:
+            scale (Float): The scale factor.
+
+        Raises:
+            ValueError: if `scale` is not a positive number.
+            ADCException: if there is any error setting the scale.
+        """
+        # Sanity checks.
+        if not isinstance(scale, (int, float)) or scale <= 0:
+            raise ValueError(_ERROR_SCALE)
+
+        if _libdigiapix.ldx_adc_set_scale(self._adc_struct, scale) != 0:
+            raise ADCException("Error setting ADC scale")
+
+    def get_sample(self):
+        """
+        Reads a raw sample of the ADC channel.
+
+        Returns:
+            Integer: The raw sample.
+
+        Raises:
+            ADCException: if there is any error reading the sample.
+        """
+        sample = _libdigiapix.ldx_adc_get_sample(self._adc_struct)
+        if sample < 0:
+            raise ADCException("Error reading ADC sample")
+        return sample
+
+    def convert_sample_to_mv(self, sample):
+        """
+        Converts a raw sample of the ADC to mV.
+
+        Args:
+            sample (Integer): The raw sample.
+
+        Returns:
+            Float: The sample in mV.
+
+        Raises:
+            ADCException: if there is any error converting the sample.
+        """
+        value = _libdigiapix.ldx_adc_convert_sample_to_mv(self._adc_struct, sample)
+        if value < 0:
+            raise ADCException("Error converting ADC sample")
+        return value
+
+    def convert_samples_to_mv(self, samples):
+        """
+        Converts a block of raw samples of the ADC to mV with a single call to the C library.
+
+        Args:
+            samples (Object): The raw samples, an `array.array('i')` (used in place) or any
+                              sequence of integers.
+
+        Returns:
+            `array.array('f')`: The samples in mV.
+
+        Raises:
+            ADCException: if there is any error converting the samples.
+        """
+        in_samples = _int_array(samples)
+        out = array("f", bytes(len(in_samples) * 4))
+        if not len(in_samples):
+            return out
+
+        out_buf = (c_float * len(in_samples)).from_buffer(out)
+        if _libdigiapix.ldx_adc_convert_samples_to_mv(self._adc_struct, in_samples, out_buf,
+                                                      len(in_samples)) != 0:
+            raise ADCException("Error converting ADC samples")
+        return out
+
+
+class ADCGroup:
+    """
+    This class represents a group of ADCs read together.
+    """
+
+    def __init__(self, adcs):
+        """
+        Class constructor. Instantiates a new `ADCGroup` with the given ADCs. The ADCs must
+        not be freed while the group exists.
+
+        Args:
+            adcs (List): List of :class:`.ADC`.
+
+        Raises:
+            ValueError: if `adcs` is not a non empty list of :class:`.ADC`.
+            ADCException: if there is any error creating the group.
+        """
+        # Sanity checks.
+        if not adcs or not all(isinstance(adc, ADC) for adc in adcs):
+            raise ValueError(_ERROR_ADCS)
+
+        self._adcs = list(adcs)
+        adc_structs = (POINTER(_ADCStruct) * len(self._adcs))(
+            *[adc._adc_struct for adc in self._adcs])
+        self._group_struct = _libdigiapix.ldx_adc_group_create(adc_structs, len(self._adcs))
+        if not self._group_struct:
+            raise ADCException("Error creating ADC group")
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free ADC group struct.
+        if getattr(self, "_group_struct", None):
+            _libdigiapix.ldx_adc_group_free(self._group_struct)
+
+    @property
+    def adcs(self):
+        """
+        Returns the ADCs of the group.
+
+        Returns:
+            List: List of :class:`.ADC`, in the order given to the constructor.
+        """
+        return list(self._adcs)
+
+    def get_samples(self):
+        """
+        Reads one raw sample of every ADC of the group with a single call to the C library.
+
+        Returns:
+            `array.array('i')`: The samples, in the order of the group.
+
+        Raises:
+            ADCException: if there is any error reading the samples.
+        """
+        samples = array("i", bytes(len(self._adcs) * 4))
+        buf = (c_int * len(self._adcs)).from_buffer(samples)
+        if _libdigiapix.ldx_adc_group_get_samples(self._group_struct, buf) != 0:
+            raise ADCException("Error reading ADC group samples")
+        return samples
+
+    def get_stats(self):
+        """
+        Returns the timing statistics of the periodic sampling of the group.
+
+        Returns:
+            Dictionary: The number of periods sampled ('ticks') and missed ('missed'), and
+                        the maximum and last sampling latencies in nanoseconds
+                        ('max_latency_ns', 'last_latency_ns').
+
+        Raises:
+            ADCException: if there is any error reading the statistics.
+        """
+        stats = _ADCGroupStatsStruct()
+        if _libdigiapix.ldx_adc_group_get_stats(self._group_struct, byref(stats)) != 0:
+            raise ADCException("Error reading ADC group statistics")
+        return {name: getattr(stats, name) for name, _type in stats._fields_}
+
+
+class ADCBuffer:
+    """
+    This class represents a buffered capture of several channels of an ADC chip. Instances
+    should be created with 'ADCBuffer.start()'.
+
+    Each entry of the capture is a scan with one sample of every channel. Scans are read in
+    blocks with 'read()' and decoded with 'get_samples()' or 'convert_to_mv()', so whole
+    blocks are moved with each call to the C library.
+    """
+
+    def __init__(self, buffer_struct):
+        """
+        Class constructor. This method should not be called directly, instead use
+        'ADCBuffer.start()'.
+        """
+        self._buffer_struct = buffer_struct
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        self.stop()
+
+    @classmethod
+    def start(cls, chip, channels, frequency=0, buffer_len=0, watermark=0, timestamp=False,
+              trigger=None):
+        """
+        Starts a buffered capture on an ADC chip.
+
+        Args:
+            chip (Integer): The IIO ADC chip to capture.
+            channels (List): The ADC channels to capture.
+            frequency (Integer, optional): Sampling frequency in Hz, 0 to keep the current one.
+            buffer_len (Integer, optional): Number of scans the kernel buffer can hold, 0 to
+                                            keep the current length.
+            watermark (Integer, optional): Number of scans that must be available to wake up
+                                           a reader, 0 to keep the current value.
+            timestamp (Boolean, optional): `True` to add the capture timestamp to each scan.
+            trigger (String, optional): Name of the IIO trigger to use, `None` to select it
+                                        automatically.
+
+        Returns:
+            :class:`.ADCBuffer`: The started capture.
+
+        Raises:
+            ValueError: if `chip` or `channels` are not valid.
+            DigiAPIXException: if there is any error loading the library.
+            ADCException: if there is any error starting the capture.
+        """
+        # Sanity checks.
+        if not isinstance(chip, int) or chip < 0:
+            raise ValueError(_ERROR_CHIP)
+        if not channels or not all(isinstance(ch, int) and ch >= 0 for ch in channels):
+            raise ValueError(_ERROR_CHANNELS)
+        _check_library()
+
+        cfg = _ADCBufferCfgStruct()
+        _libdigiapix.ldx_adc_buffer_set_defconfig(byref(cfg))
+        cfg.frequency = frequency
+        cfg.buffer_len = buffer_len
+        cfg.watermark = watermark
+        cfg.timestamp = timestamp
+        if trigger is not None:
+            cfg.trigger = trigger.encode(encoding="ascii", errors="ignore")
+
+        chan_array = (c_uint * len(channels))(*channels)
+        buffer_struct = _libdigiapix.ldx_adc_buffer_start(chip, chan_array, len(channels),
+                                                          byref(cfg))
+        if not buffer_struct:
+            raise ADCException("Error starting ADC buffered capture")
+        return cls(buffer_struct)
+
+    def stop(self):
+        """
+        Stops the capture. The capture cannot be used afterwards.
+
+        Raises:
+            ADCException: if there is any error stopping the capture.
+        """
+        if not getattr(self, "_buffer_struct", None):
+            return
+
+        buffer_struct, self._buffer_struct = self._buffer_struct, None
+        if _libdigiapix.ldx_adc_buffer_stop(buffer_struct) != 0:
+            raise ADCException("Error stopping ADC buffered capture")
+
+    @property
+    def chip(self):
+        """
+        Returns the captured ADC chip.
+
+        Returns:
+            Integer: ADC chip.
+        """
+        return self._buffer_struct.contents.chip
+
+    @property
+    def num_channels(self):
+        """
+        Returns the number of channels in each scan.
+
+        Returns:
+            Integer: Number of channels.
+        """
+        return self._buffer_struct.contents.num_channels
+
+    @property
+    def scan_size(self):
+        """
+        Returns the size in bytes of each scan.
+
+        Returns:
+            Integer: Scan size in bytes.
+        """
+        return self._buffer_struct.contents.scan_size
+
+    def read(self, max_scans=64, timeout=-1):
+        """
+        Reads a block of scans from the capture.
+
+        The Python interpreter lock is released while waiting.
+
+        Args:
+            max_scans (Integer, optional): Maximum number of scans to read.
+            timeout (Integer, optional): The maximum number of milliseconds to wait for
+                                         scans, 0 to return immediately, -1 for blocking
+                                         indefinitely.
+
+        Returns:
+            Bytearray: The scans read, in binary form. Empty on timeout.
+
+        Raises:
+            ValueError: if `max_scans` is not a positive integer.
+            ADCException: if there is any error reading the scans.
+        """
+        # Sanity checks.
+        if not isinstance(max_scans, int) or max_scans <= 0:
+            raise ValueError(_ERROR_SCANS_MAX)
+
+        scans = bytearray(max_scans * self.scan_size)
+        nscans = self.read_into(scans, timeout)
+        del scans[nscans * self.scan_size:]
+        return scans
+
+    def read_into(self, buffer, timeout=-1):
+        """
+        Reads scans from the capture into the given buffer, as many as fit in it.
+
+        Args:
+            buffer (Object): Writable object supporting the buffer protocol.
+            timeout (Integer, optional): The maximum number of milliseconds to wait for
+                                         scans, 0 to return immediately, -1 for blocking
+                                         indefinitely.
+
+        Returns:
+            Integer: The number of scans read, 0 on timeout.
+
+        Raises:
+            ValueError: if `buffer` is not a writable buffer.
+            ADCException: if there is any error reading the scans.
+        """
+        buf, length = _buffer_from(buffer, writable=True)
+        max_scans = length // self.scan_size
+        if not max_scans:
+            raise ValueError(_ERROR_SCANS)
+
+        nscans = _libdigiapix.ldx_adc_buffer_read(self._buffer_struct, buf, max_scans, timeout)
+        if nscans < 0:
+            raise ADCException("Error reading ADC scans")
+        return nscans
+
+    def get_samples(self, index, scans):
+        """
+        Extracts the raw samples of a channel from a block of scans.
+
+        Args:
+            index (Integer): Index of the channel in the list given to 'ADCBuffer.start()'.
+            scans (Object): Scans returned by 'read()'.
+
+        Returns:
+            `array.array('i')`: The samples of the channel, one per scan.
+
+        Raises:
+            ValueError: if `index` or `scans` are not valid.
+            ADCException: if there is any error decoding the samples.
+        """
+        scans_buf, nscans = self._scans(index, scans)
+        out = array("i", bytes(nscans * 4))
+        if not nscans:
+            return out
+
+        out_buf = (c_int * nscans).from_buffer(out)
+        if _libdigiapix.ldx_adc_buffer_get_samples(self._buffer_struct, index, scans_buf,
+                                                   nscans, out_buf) != 0:
+            raise ADCException("Error decoding ADC samples")
+        return out
+
+    def convert_to_mv(self, index, scans):
+        """
+        Converts the samples of a channel in a block of scans to mV.
+
+        Args:
+            index (Integer): Index of the channel in the list given to 'ADCBuffer.start()'.
+            scans (Object): Scans returned by 'read()'.
+
+        Returns:
+            `array.array('f')`: The samples of the channel in mV, one per scan.
+
+        Raises:
+            ValueError: if `index` or `scans` are not valid.
+            ADCException: if there is any error converting the samples.
+        """
+        scans_buf, nscans = self._scans(index, scans)
+        out = array("f", bytes(nscans * 4))
+        if not nscans:
+            return out
+
+        out_buf = (c_float * nscans).from_buffer(out)
+        if _libdigiapix.ldx_adc_buffer_convert_to_mv(self._buffer_struct, index, scans_buf,
+                                                     nscans, out_buf) != 0:
+            raise ADCException("Error converting ADC samples")
+        return out
+
+    def get_timestamps(self, scans):
+        """
+        Returns the timestamps of a block of scans.
+
+        Args:
+            scans (Object): Scans returned by 'read()'.
+
+        Returns:
+            List: The timestamp of each scan in nanoseconds, empty if the capture has no
+                  timestamps.
+
+        Raises:
+            ValueError: if `scans` is not valid.
+        """
+        scans_buf, nscans = self._scans(0, scans)
+        base = addressof(scans_buf)
+        timestamps = []
+        for i in range(nscans):
+            timestamp = _libdigiapix.ldx_adc_buffer_get_timestamp(self._buffer_struct,
+                                                                  base + i * self.scan_size)
+            if timestamp < 0:
+                return []
+            timestamps.append(timestamp)
+        return timestamps
+
+    def get_format(self, index):
+        """
+        Returns the format of a channel in the scans.
+
+        Args:
+            index (Integer): Index of the channel in the list given to 'ADCBuffer.start()'.
+
+        Returns:
+            Dictionary: The fields of the format: 'is_signed', 'is_be', 'realbits',
+                        'storagebits', 'shift' and 'offset'.
+
+        Raises:
+            ADCException: if there is any error reading the format.
+        """
+        fmt = _ADCScanFormatStruct()
+        if _libdigiapix.ldx_adc_buffer_get_format(self._buffer_struct, index, byref(fmt)) != 0:
+            raise ADCException("Error reading ADC scan format")
+        return {name: getattr(fmt, name) for name, _type in fmt._fields_}
+
+    def _scans(self, index, scans):
+        """
+        Validates a channel index and a block of scans.
+
+        Args:
+            index (Integer): Index of the channel.
+            scans (Object): The scans.
+
+        Returns:
+            Tuple (:class:`ctypes.Array`, Integer): The scans and their number.
+
+        Raises:
+            ValueError: if `index` or `scans` are not valid.
+        """
+        if not isinstance(index, int) or not 0 <= index < self.num_channels:
+            raise ValueError(_ERROR_INDEX)
+        scans_buf, length = _buffer_from(scans)
+        if length % self.scan_size:
+            raise ValueError(_ERROR_SCANS)
+        return scans_buf, length // self.scan_size
+
+
+def _check_library():
+    """
+    Verifies that the 'digiapix' library is loaded.
+
+    Raises:
+        DigiAPIXException: if there is any error loading the library.
+    """
+    # Use global variable.
+    global _libdigiapix
+    # Load the library.
+    if _libdigiapix is None:
+        _libdigiapix = library.get_library()
+        # Configure the CTypes of the ADC methods to use.
+        _configure_adc_ctypes()
+
+
+def _configure_adc_ctypes():
+    """
+    Configures the ctypes for the library ADC methods
+    """
+    # Request ADC.
+    _libdigiapix.ldx_adc_request.argtypes = [c_uint, c_uint]
+    _libdigiapix.ldx_adc_request.restype = POINTER(_ADCStruct)
+    # Request by alias.
+    _libdigiapix.ldx_adc_request_by_alias.argtypes = [c_char_p]
+    _libdigiapix.ldx_adc_request_by_alias.restype = POINTER(_ADCStruct)
+    # Free ADC.
+    _libdigiapix.ldx_adc_free.argtypes = [POINTER(_ADCStruct)]
+    _libdigiapix.ldx_adc_free.restype = c_int
+    # Set scale.
+    _libdigiapix.ldx_adc_set_scale.argtypes = [POINTER(_ADCStruct), c_float]
+    _libdigiapix.ldx_adc_set_scale.restype = c_int
+    # Get sample.
+    _libdigiapix.ldx_adc_get_sample.argtypes = [POINTER(_ADCStruct)]
+    _libdigiapix.ldx_adc_get_sample.restype = c_int
+    # Convert sample to mV.
+    _libdigiapix.ldx_adc_convert_sample_to_mv.argtypes = [POINTER(_ADCStruct), c_int]
+    _libdigiapix.ldx_adc_convert_sample_to_mv.restype = c_float
+    # Convert samples to mV.
+    _libdigiapix.ldx_adc_convert_samples_to_mv.argtypes = [POINTER(_ADCStruct),
+                                                           POINTER(c_int), POINTER(c_float),
+                                                           c_size_t]
+    _libdigiapix.ldx_adc_convert_samples_to_mv.restype = c_int
+    # Create group.
+    _libdigiapix.ldx_adc_group_create.argtypes = [POINTER(POINTER(_ADCStruct)), c_uint]
+    _libdigiapix.ldx_adc_group_create.restype = POINTER(_ADCGroupStruct)
+    # Free group.
+    _libdigiapix.ldx_adc_group_free.argtypes = [POINTER(_ADCGroupStruct)]
+    _libdigiapix.ldx_adc_group_free.restype = c_int
+    # Get group samples.
+    _libdigiapix.ldx_adc_group_get_samples.argtypes = [POINTER(_ADCGroupStruct),
+                                                       POINTER(c_int)]
+    _libdigiapix.ldx_adc_group_get_samples.restype = c_int
+    # Get group statistics.
+    _libdigiapix.ldx_adc_group_get_stats.argtypes = [POINTER(_ADCGroupStruct),
+                                                     POINTER(_ADCGroupStatsStruct)]
+    _libdigiapix.ldx_adc_group_get_stats.restype = c_int
+    # Set buffer default configuration.
+    _libdigiapix.ldx_adc_buffer_set_defconfig.argtypes = [POINTER(_ADCBufferCfgStruct)]
+    _libdigiapix.ldx_adc_buffer_set_defconfig.restype = None
+    # Start buffer.
+    _libdigiapix.ldx_adc_buffer_start.argtypes = [c_uint, POINTER(c_uint), c_uint,
+                                                  POINTER(_ADCBufferCfgStruct)]
+    _libdigiapix.ldx_adc_buffer_start.restype = POINTER(_ADCBufferStruct)
+    # Read buffer.
+    _libdigiapix.ldx_adc_buffer_read.argtypes = [POINTER(_ADCBufferStruct), c_void_p, c_uint,
+                                                 c_int]
+    _libdigiapix.ldx_adc_buffer_read.restype = c_int
+    # Get buffer format.
+    _libdigiapix.ldx_adc_buffer_get_format.argtypes = [POINTER(_ADCBufferStruct), c_uint,
+                                                       POINTER(_ADCScanFormatStruct)]
+    _libdigiapix.ldx_adc_buffer_get_format.restype = c_int
+    # Get buffer samples.
+    _libdigiapix.ldx_adc_buffer_get_samples.argtypes = [POINTER(_ADCBufferStruct), c_uint,
+                                                        c_void_p, c_uint, POINTER(c_int)]
+    _libdigiapix.ldx_adc_buffer_get_samples.restype = c_int
+    # Convert buffer samples to mV.
+    _libdigiapix.ldx_adc_buffer_convert_to_mv.argtypes = [POINTER(_ADCBufferStruct), c_uint,
+                                                          c_void_p, c_uint, POINTER(c_float)]
+    _libdigiapix.ldx_adc_buffer_convert_to_mv.restype = c_int
+    # Get buffer timestamp.
+    _libdigiapix.ldx_adc_buffer_get_timestamp.argtypes = [POINTER(_ADCBufferStruct),
+                                                          c_void_p]
+    _libdigiapix.ldx_adc_buffer_get_timestamp.restype = c_int64
+    # Stop buffer.
+    _libdigiapix.ldx_adc_buffer_stop.argtypes = [POINTER(_ADCBufferStruct)]
+    _libdigiapix.ldx_adc_buffer_stop.restype = c_int
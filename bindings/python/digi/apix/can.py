@@ -0,0 +1,568 @@
+# Copyright 2022, Digi International Inc.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+from ctypes import addressof, byref, c_bool, c_char, c_char_p, c_int, c_long, c_uint, \
+    c_uint8, c_uint32, c_uint64, c_ubyte, c_void_p, memmove, POINTER, string_at, Structure
+
+from digi.apix import library
+from digi.apix.common import INTERFACE_NAME_SIZE
+from digi.apix.exceptions import DigiAPIXException
+
+# Constants.
+BATCH_LEN = 32
+DEF_RX_QUEUE_LEN = 1024
+
+CAN_MAX_DLEN = 8
+CANFD_MAX_DLEN = 64
+
+CAN_EFF_FLAG = 0x80000000
+CAN_RTR_FLAG = 0x40000000
+CAN_ERR_FLAG = 0x20000000
+CAN_SFF_MASK = 0x000007FF
+CAN_EFF_MASK = 0x1FFFFFFF
+
+CANFD_BRS = 0x01
+CANFD_ESI = 0x02
+
+_CAN_ERROR_TX_RETRY_LATER = 25
+
+_ERROR_BITRATE = "Bitrate must be a positive integer"
+_ERROR_DATA = "Frame data cannot be longer than %d bytes" % CANFD_MAX_DLEN
+_ERROR_FRAME = "Frames must be CANFrame objects"
+_ERROR_FRAMES_MAX = "Maximum number of frames must be a positive integer"
+_ERROR_ID = "CAN ID must be a valid 11 or 29 bit identifier"
+_ERROR_INDEX = "Interface index must be a positive integer"
+_ERROR_NAME = "Interface name must be a valid string"
+_ERROR_RX_QUEUE_LEN = "Rx queue length must be a positive integer"
+
+# Variables.
+_libdigiapix = None
+
+
+class CANException(DigiAPIXException):
+    """
+    Exception thrown when an error occurs working with CAN interfaces
+    """
+
+
+class _CANBitTimingStruct(Structure):
+    """
+    Internal class to store C library CAN bit timing struct data.
+    """
+    _fields_ = [('bitrate', c_uint32),
+                ('sample_point', c_uint32),
+                ('tq', c_uint32),
+                ('prop_seg', c_uint32),
+                ('phase_seg1', c_uint32),
+                ('phase_seg2', c_uint32),
+                ('sjw', c_uint32),
+                ('brp', c_uint32)]
+
+
+class _CANCtrlModeStruct(Structure):
+    """
+    Internal class to store C library CAN control mode struct data.
+    """
+    _fields_ = [('mask', c_uint32),
+                ('flags', c_uint32)]
+
+
+class _CANIfCfgStruct(Structure):
+    """
+    Internal class to store C library CAN interface configuration struct data.
+    """
+    _fields_ = [('nl_cmd_verify', c_bool),
+                ('canfd_enabled', c_bool),
+                ('process_header', c_bool),
+                ('hw_timestamp', c_bool),
+                ('shared_rx_skt', c_bool),
+                ('rx_queue_len', c_uint),
+                ('rx_buf_len', c_int),
+                ('tx_buf_len', c_int),
+                ('rx_buf_len_rd', c_int),
+                ('tx_buf_len_rd', c_int),
+                ('bitrate', c_uint32),
+                ('dbitrate', c_uint32),
+                ('restart_ms', c_uint32),
+                ('error_mask', c_uint32),
+                ('bit_timing', _CANBitTimingStruct),
+                ('dbit_timing', _CANBitTimingStruct),
+                ('ctrl_mode', _CANCtrlModeStruct)]
+
+
+class _CANIfStruct(Structure):
+    """
+    Internal class to store C library CAN interface struct data.
+    """
+    _fields_ = [('name', c_char * INTERFACE_NAME_SIZE),
+                ('cfg', _CANIfCfgStruct),
+                ('dropped_frames', c_uint32),
+                ('data', c_void_p)]
+
+
+class _CANFDFrameStruct(Structure):
+    """
+    Internal class to store C library CAN FD frame struct data.
+    """
+    _fields_ = [('can_id', c_uint32),
+                ('len', c_uint8),
+                ('flags', c_uint8),
+                ('res0', c_uint8),
+                ('res1', c_uint8),
+                ('data', c_ubyte * CANFD_MAX_DLEN)]
+
+
+class _TimevalStruct(Structure):
+    """
+    Internal class to store C library timeval struct data.
+    """
+    _fields_ = [('tv_sec', c_long),
+                ('tv_usec', c_long)]
+
+
+class _TimespecStruct(Structure):
+    """
+    Internal class to store C library timespec struct data.
+    """
+    _fields_ = [('tv_sec', c_long),
+                ('tv_nsec', c_long)]
+
+
+class _CANRxStatsStruct(Structure):
+    """
+    Internal class to store C library CAN reception statistics struct data.
+    """
+    _fields_ = [('frames', c_uint64),
+                ('dropped', c_uint32),
+                ('reads', c_uint64),
+                ('max_batch', c_uint),
+                ('last_tstamp', _TimespecStruct),
+                ('overruns', c_uint64)]
+
+
+class CANFrame:
+    """
+    This class represents a CAN or CAN FD frame.
+    """
+
+    def __init__(self, can_id, data=b"", extended=None, rtr=False, flags=0, timestamp=None):
+        """
+        Class constructor. Instantiates a new `CANFrame` with the provided parameters.
+
+        Args:
+            can_id (Integer): The CAN identifier, without flags.
+            data (Bytes, optional): The payload of the frame, up to 8 bytes for CAN frames
+                                    and 64 bytes for CAN FD frames.
+            extended (Boolean, optional): `True` for a 29 bit identifier. By default, it is
+                                          used only if the identifier does not fit in 11 bits.
+            rtr (Boolean, optional): `True` for a remote transmission request.
+            flags (Integer, optional): CAN FD flags (`CANFD_BRS`, `CANFD_ESI`).
+            timestamp (Float, optional): Reception time in seconds. Only set on received
+                                         frames.
+
+        Raises:
+            ValueError: if `can_id` or `data` are not valid.
+        """
+        if extended is None:
+            extended = isinstance(can_id, int) and can_id > CAN_SFF_MASK
+        if not isinstance(can_id, int) or can_id < 0 or \
+                can_id > (CAN_EFF_MASK if extended else CAN_SFF_MASK):
+            raise ValueError(_ERROR_ID)
+        data = bytes(data)
+        if len(data) > CANFD_MAX_DLEN:
+            raise ValueError(_ERROR_DATA)
+
+        self.can_id = can_id
+        self.data = data
+        self.extended = extended
+        self.rtr = rtr
+        self.flags = flags
+        self.timestamp = timestamp
+
+    def __repr__(self):
+        """
+        Returns a printable representation of the frame.
+        """
+        return "CANFrame(0x%X, %s%s%s)" % (self.can_id, self.data.hex(),
+                                           ", extended" if self.extended else "",
+                                           ", rtr" if self.rtr else "")
+
+    @classmethod
+    def _from_struct(cls, frame_struct, tv_struct):
+        """
+        Creates a frame from the given C library frame and timestamp structs.
+
+        Args:
+            frame_struct (:class:`._CANFDFrameStruct`): The frame.
+            tv_struct (:class:`._TimevalStruct`): The timestamp of the frame.
+
+        Returns:
+            :class:`.CANFrame`: The new frame.
+        """
+        frame = cls.__new__(cls)
+        frame.extended = bool(frame_struct.can_id & CAN_EFF_FLAG)
+        frame.rtr = bool(frame_struct.can_id & CAN_RTR_FLAG)
+        frame.can_id = frame_struct.can_id & (CAN_EFF_MASK if frame.extended else CAN_SFF_MASK)
+        frame.data = string_at(addressof(frame_struct.data), frame_struct.len)
+        frame.flags = frame_struct.flags
+        frame.timestamp = tv_struct.tv_sec + tv_struct.tv_usec / 1000000
+        return frame
+
+    def _fill(self, frame_struct):
+        """
+        Fills the given C library frame struct with the data of this frame.
+
+        Args:
+            frame_struct (:class:`._CANFDFrameStruct`): The struct to fill.
+        """
+        frame_struct.can_id = self.can_id | (CAN_EFF_FLAG if self.extended else 0) | \
+            (CAN_RTR_FLAG if self.rtr else 0)
+        frame_struct.len = len(self.data)
+        frame_struct.flags = self.flags
+        memmove(frame_struct.data, self.data, len(self.data))
+
+
+class CAN:
+    """
+    This class represents a CAN interface. Instances of CAN should be created using the
+    'CAN.create_from_<x>' family of functions and configured with 'init()'.
+
+    Frames are received through the rx queue of the C library: a library thread stores
+    every frame received by the interface, without running any Python code, and
+    'receive()' takes them in blocks.
+    """
+
+    def __init__(self, can_struct):
+        """
+        Class constructor. This method should not be called directly, instead use the
+        'CAN.create_from_<x>' family of functions.
+        """
+        self._can_struct = can_struct
+        self._tx_frames = None
+        self._rx_frames = None
+        self._rx_tv = None
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free CAN struct.
+        _libdigiapix.ldx_can_free(self._can_struct)
+
+    @classmethod
+    def create(cls, index):
+        """
+        Requests a CAN interface by index.
+
+        Args:
+            index (Integer): The CAN interface index.
+
+        Returns:
+            :class:`.CAN`: The instantiated CAN interface.
+
+        Raises:
+            ValueError: if `index` is not a positive integer.
+            DigiAPIXException: if there is any error loading the library.
+            CANException: if there is any error requesting the interface.
+        """
+        # Sanity checks.
+        if not isinstance(index, int) or index < 0:
+            raise ValueError(_ERROR_INDEX)
+        _check_library()
+
+        can_struct = _libdigiapix.ldx_can_request(index)
+        if not can_struct:
+            raise CANException("Error requesting CAN interface")
+        return cls(can_struct)
+
+    @classmethod
+    def create_from_name(cls, name):
+        """
+        Requests a CAN interface by name.
+
+        Args:
+            name (String): The CAN interface name, for example 'can0'.
+
+        Returns:
+            :class:`.CAN`: The instantiated CAN interface.
+
+        Raises:
+            ValueError: if `name` is not a valid string.
+            DigiAPIXException: if there is any error loading the library.
+            CANException: if there is any error requesting the interface.
+        """
+        # Sanity checks.
+        if not isinstance(name, str) or not name:
+            raise ValueError(_ERROR_NAME)
+        _check_library()
+
+        can_struct = _libdigiapix.ldx_can_request_by_name(
+            name.encode(encoding="ascii", errors="ignore"))
+        if not can_struct:
+            raise CANException("Error requesting CAN interface")
+        return cls(can_struct)
+
+    @property
+    def name(self):
+        """
+        Returns the CAN interface name.
+
+        Returns:
+            String: CAN interface name.
+        """
+        return self._can_struct.contents.name.decode(encoding="ascii", errors="ignore")
+
+    def init(self, bitrate=0, dbitrate=0, canfd=False, restart_ms=0, hw_timestamp=False,
+             rx_queue_len=DEF_RX_QUEUE_LEN):
+        """
+        Configures and starts the CAN interface.
+
+        Args:
+            bitrate (Integer, optional): Bitrate of the interface, 0 to keep the current one.
+            dbitrate (Integer, optional): CAN FD data bitrate, 0 to keep the current one.
+            canfd (Boolean, optional): `True` to enable CAN FD.
+            restart_ms (Integer, optional): Automatic restart time in ms after a bus-off, 0
+                                            to keep the current one.
+            hw_timestamp (Boolean, optional): `True` to use hardware timestamps.
+            rx_queue_len (Integer, optional): Number of frames of the rx queue.
+
+        Raises:
+            ValueError: if any parameter is not valid.
+            CANException: if there is any error configuring the interface.
+        """
+        # Sanity checks.
+        if not isinstance(bitrate, int) or bitrate < 0 or \
+                not isinstance(dbitrate, int) or dbitrate < 0:
+            raise ValueError(_ERROR_BITRATE)
+        if not isinstance(rx_queue_len, int) or rx_queue_len <= 0:
+            raise ValueError(_ERROR_RX_QUEUE_LEN)
+
+        cfg = _CANIfCfgStruct()
+        _libdigiapix.ldx_can_set_defconfig(byref(cfg))
+        cfg.bitrate = bitrate
+        cfg.dbitrate = dbitrate
+        cfg.canfd_enabled = canfd
+        cfg.restart_ms = restart_ms
+        cfg.hw_timestamp = hw_timestamp
+        cfg.rx_queue_len = rx_queue_len
+
+        _check_error(_libdigiapix.ldx_can_init(self._can_struct, byref(cfg)),
+                     "Error initializing CAN interface")
+
+    def start(self):
+        """
+        Starts the CAN interface.
+
+        Raises:
+            CANException: if there is any error starting the interface.
+        """
+        _check_error(_libdigiapix.ldx_can_start(self._can_struct),
+                     "Error starting CAN interface")
+
+    def stop(self):
+        """
+        Stops the CAN interface.
+
+        Raises:
+            CANException: if there is any error stopping the interface.
+        """
+        _check_error(_libdigiapix.ldx_can_stop(self._can_struct),
+                     "Error stopping CAN interface")
+
+    def send(self, frames):
+        """
+        Sends several frames in order, with a single call to the C library.
+
+        If the transmission queue of the interface fills up, the function stops and returns
+        the number of frames already queued, so the rest can be retried later.
+
+        Args:
+            frames (List): List of :class:`.CANFrame` to send.
+
+        Returns:
+            Integer: The number of frames queued.
+
+        Raises:
+            ValueError: if `frames` is not a list of :class:`.CANFrame`.
+            CANException: if there is any error sending the frames.
+        """
+        # Sanity checks.
+        if not all(isinstance(frame, CANFrame) for frame in frames):
+            raise ValueError(_ERROR_FRAME)
+        if not frames:
+            return 0
+
+        # Reuse the frames array between calls.
+        if self._tx_frames is None or len(self._tx_frames) < len(frames):
+            self._tx_frames = (_CANFDFrameStruct * max(len(frames), BATCH_LEN))()
+        for frame, frame_struct in zip(frames, self._tx_frames):
+            frame._fill(frame_struct)
+
+        res = _libdigiapix.ldx_can_tx_frames(self._can_struct, self._tx_frames, len(frames))
+        if res == -_CAN_ERROR_TX_RETRY_LATER:
+            return 0
+        _check_error(res, "Error sending CAN frames")
+        return res
+
+    def send_frame(self, frame):
+        """
+        Sends a frame.
+
+        Args:
+            frame (:class:`.CANFrame`): The frame to send.
+
+        Returns:
+            Boolean: `True` if the frame was queued, `False` if the transmission queue is
+                     full and it must be retried later.
+
+        Raises:
+            ValueError: if `frame` is not a :class:`.CANFrame`.
+            CANException: if there is any error sending the frame.
+        """
+        return self.send([frame]) == 1
+
+    def receive(self, max_frames=BATCH_LEN, timeout=-1):
+        """
+        Takes the received frames from the rx queue, with a single call to the C library.
+
+        This function blocks for the given amount of milliseconds (or indefinitely for -1)
+        until at least one frame is available, and returns all the queued frames up to
+        `max_frames`. The Python interpreter lock is released while waiting. Only one thread
+        may receive from an interface.
+
+        Args:
+            max_frames (Integer, optional): Maximum number of frames to take.
+            timeout (Integer, optional): The maximum number of milliseconds to wait for the
+                                         first frame, 0 to return immediately, -1 for
+                                         blocking indefinitely.
+
+        Returns:
+            List: List of :class:`.CANFrame`, oldest first, with their `timestamp`. Empty on
+                  timeout.
+
+        Raises:
+            ValueError: if `max_frames` is not a positive integer.
+            CANException: if there is any error receiving the frames.
+        """
+        # Sanity checks.
+        if not isinstance(max_frames, int) or max_frames <= 0:
+            raise ValueError(_ERROR_FRAMES_MAX)
+
+        # Reuse the frames arrays between calls.
+        if self._rx_frames is None or len(self._rx_frames) < max_frames:
+            self._rx_frames = (_CANFDFrameStruct * max_frames)()
+            self._rx_tv = (_TimevalStruct * max_frames)()
+
+        res = _libdigiapix.ldx_can_rx_pop_batch(self._can_struct, self._rx_frames, self._rx_tv,
+                                                max_frames, timeout)
+        _check_error(res, "Error receiving CAN frames")
+
+        return [CANFrame._from_struct(self._rx_frames[i], self._rx_tv[i]) for i in range(res)]
+
+    def get_rx_stats(self):
+        """
+        Returns the reception statistics of the rx queue.
+
+        Returns:
+            Dictionary: The number of frames received ('frames'), dropped by the socket
+                        ('dropped') and lost because the rx queue was full ('overruns'), the
+                        number of socket reads ('reads') and the largest number of frames
+                        drained at once ('max_batch').
+
+        Raises:
+            CANException: if there is any error reading the statistics.
+        """
+        stats = _CANRxStatsStruct()
+        _check_error(_libdigiapix.ldx_can_get_rx_queue_stats(self._can_struct, byref(stats)),
+                     "Error reading CAN rx statistics")
+        return {"frames": stats.frames, "dropped": stats.dropped, "reads": stats.reads,
+                "max_batch": stats.max_batch, "overruns": stats.overruns}
+
+
+def _check_error(res, message):
+    """
+    Raises a `CANException` if the given library result is an error code.
+
+    Args:
+        res (Integer): The result returned by the library.
+        message (String): The error message.
+
+    Raises:
+        CANException: if `res` is an error code.
+    """
+    if res >= 0:
+        return
+    reason = _libdigiapix.ldx_can_strerror(-res)
+    if reason:
+        message += ": " + reason.decode(encoding="ascii", errors="ignore")
+    raise CANException(message)
+
+
+def _check_library():
+    """
+    Verifies that the 'digiapix' library is loaded.
+
+    Raises:
+        DigiAPIXException: if there is any error loading the library.
+    """
+    # Use global variable.
+    global _libdigiapix
+    # Load the library.
+    if _libdigiapix is None:
+        _libdigiapix = library.get_library()
+        # Configure the CTypes of the CAN methods to use.
+        _configure_can_ctypes()
+
+
+def _configure_can_ctypes():
+    """
+    Configures the ctypes for the library CAN methods
+    """
+    # Request CAN.
+    _libdigiapix.ldx_can_request.argtypes = [c_uint]
+    _libdigiapix.ldx_can_request.restype = POINTER(_CANIfStruct)
+    # Request by name.
+    _libdigiapix.ldx_can_request_by_name.argtypes = [c_char_p]
+    _libdigiapix.ldx_can_request_by_name.restype = POINTER(_CANIfStruct)
+    # Free CAN.
+    _libdigiapix.ldx_can_free.argtypes = [POINTER(_CANIfStruct)]
+    _libdigiapix.ldx_can_free.restype = c_int
+    # Set default configuration.
+    _libdigiapix.ldx_can_set_defconfig.argtypes = [POINTER(_CANIfCfgStruct)]
+    _libdigiapix.ldx_can_set_defconfig.restype = None
+    # Init.
+    _libdigiapix.ldx_can_init.argtypes = [POINTER(_CANIfStruct), POINTER(_CANIfCfgStruct)]
+    _libdigiapix.ldx_can_init.restype = c_int
+    # Start.
+    _libdigiapix.ldx_can_start.argtypes = [POINTER(_CANIfStruct)]
+    _libdigiapix.ldx_can_start.restype = c_int
+    # Stop.
+    _libdigiapix.ldx_can_stop.argtypes = [POINTER(_CANIfStruct)]
+    _libdigiapix.ldx_can_stop.restype = c_int
+    # Send frames.
+    _libdigiapix.ldx_can_tx_frames.argtypes = [POINTER(_CANIfStruct),
+                                               POINTER(_CANFDFrameStruct), c_int]
+    _libdigiapix.ldx_can_tx_frames.restype = c_int
+    # Pop received frames.
+    _libdigiapix.ldx_can_rx_pop_batch.argtypes = [POINTER(_CANIfStruct),
+                                                  POINTER(_CANFDFrameStruct),
+                                                  POINTER(_TimevalStruct), c_int, c_int]
+    _libdigiapix.ldx_can_rx_pop_batch.restype = c_int
+    # Get rx queue statistics.
+    _libdigiapix.ldx_can_get_rx_queue_stats.argtypes = [POINTER(_CANIfStruct),
+                                                        POINTER(_CANRxStatsStruct)]
+    _libdigiapix.ldx_can_get_rx_queue_stats.restype = c_int
+    # Error string.
+    _libdigiapix.ldx_can_strerror.argtypes = [c_int]
+    _libdigiapix.ldx_can_strerror.restype = c_char_p
@@ -13,9 +13,13 @@
 # OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 import re
 
+from ctypes import c_ubyte
 from enum import Enum
 
 # Constants.
+_ERROR_BUFFER_CONTIGUOUS = "Buffer must be contiguous"
+_ERROR_BUFFER_WRITABLE = "Buffer must be writable"
+
 INTERFACE_NAME_SIZE = 16
 MAC_ADDRESS_GROUPS = 6
 MAX_IFACES = 32
@@ -190,6 +194,45 @@ class MacAddress:
         return bytearray(self.__address)
 
 
+def _buffer_from(data, writable=False):
+    """
+    Returns a ctypes array sharing the memory of the given object.
+
+    Objects supporting the buffer protocol (`bytearray`, `memoryview`, `array.array`,
+    numpy arrays...) are used in place, without copying their data. Read-only buffers
+    (`bytes`) and sequences of integers are copied once.
+
+    Args:
+        data (Object): The object with the data.
+        writable (Boolean): `True` if the library writes in the buffer.
+
+    Returns:
+        Tuple (:class:`ctypes.Array`, Integer): The ctypes array and its length in bytes.
+
+    Raises:
+        ValueError: if `data` is not contiguous or if `writable` is `True` and `data` is
+                    read-only.
+    """
+    try:
+        view = memoryview(data)
+    except TypeError:
+        if writable:
+            raise ValueError(_ERROR_BUFFER_WRITABLE) from None
+        view = memoryview(bytes(data))
+
+    if not view.c_contiguous:
+        raise ValueError(_ERROR_BUFFER_CONTIGUOUS)
+    if view.format != "B" or view.ndim != 1:
+        view = view.cast("B")
+
+    if view.readonly:
+        if writable:
+            raise ValueError(_ERROR_BUFFER_WRITABLE)
+        return (c_ubyte * view.nbytes).from_buffer_copy(view), view.nbytes
+
+    return (c_ubyte * view.nbytes).from_buffer(view), view.nbytes
+
+
 class _AbstractEnum(Enum):
     """
     Abstract enumeration class.
@@ -275,3 +318,23 @@ class RequestMode(_AbstractEnum):
             description (String): Request mode description.
         """
         super().__init__(code, title, description)
+
+
+class BusPriority(_AbstractEnum):
+    """
+    Enumeration class listing the priority classes of the I2C and SPI bus transactions.
+    """
+    HIGH = (0, "High", "Latency critical transactions (control)")
+    NORMAL = (1, "Normal", "Default priority")
+    LOW = (2, "Low", "Bulk transactions (logging)")
+
+    def __init__(self, code, title, description):
+        """
+        Class constructor. Instantiates a new `BusPriority` entry with the provided parameters.
+
+        Args:
+            code (Integer): Bus priority code.
+            title (String): Bus priority title.
+            description (String): Bus priority description.
+        """
+        super().__init__(code, title, description)
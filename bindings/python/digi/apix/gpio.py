@@ -12,7 +12,8 @@
 # ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
 # OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
-from ctypes import c_char_p, c_int, c_ubyte, c_uint32, c_void_p, CFUNCTYPE, POINTER, Structure
+from ctypes import byref, c_char_p, c_int, c_ubyte, c_uint32, c_uint64, c_void_p, CFUNCTYPE, \
+    POINTER, Structure
 
 from digi.apix import library
 from digi.apix.common import _AbstractEnum, RequestMode
@@ -23,6 +24,8 @@ _ERROR_ACTIVE_MODE = "Active mode must be a valid GPIOActiveMode entry"
 _ERROR_ALIAS = "Alias must be a valid string"
 _ERROR_CONTROLLER = "Controller must be a valid string"
 _ERROR_DEBOUNCE = "Debounce time must be positive integer"
+_ERROR_EVENTS_MAX = "Maximum number of events must be a positive integer"
+_ERROR_RING_LEN = "Ring length must be a positive integer"
 _ERROR_KERNEL_NUMBER = "Kernel number must be a positive integer"
 _ERROR_LINE = "Line must be a positive integer"
 _ERROR_MODE = "Mode must be a valid GPIOMode entry"
@@ -104,6 +107,32 @@ class GPIOActiveMode(_AbstractEnum):
         super().__init__(code, "", description)
 
 
+class GPIOEdge(_AbstractEnum):
+    """
+    Enumeration class listing the edges of the GPIO events.
+    """
+    RISING = (0, "Rising")
+    FALLING = (1, "Falling")
+
+    def __init__(self, code, description):
+        """
+        Class constructor. Instantiates a new `GPIOEdge` entry with the provided parameters.
+
+        Args:
+            code (Integer): GPIO edge code.
+            description (String): GPIO edge description.
+        """
+        super().__init__(code, "", description)
+
+
+class _GPIOEventStruct(Structure):
+    """
+    Internal class to store C library GPIO event struct data.
+    """
+    _fields_ = [('timestamp_ns', c_uint64),
+                ('edge', c_int)]
+
+
 class _GPIOStruct(Structure):
     """
     Internal class to store C library GPIO struct data.
@@ -130,6 +159,8 @@ class GPIO:
         self._irq_callback = None
         self._irq_callbacks = []
         self._irq_thread_running = False
+        self._event_buffer_running = False
+        self._events = None
 
     def __del__(self):
         """
@@ -138,6 +169,9 @@ class GPIO:
         # Check if interrupt thread is running.
         if self._irq_thread_running:
             self._stop_interrupts_thread()
+        # Check if event buffer is running.
+        if self._event_buffer_running:
+            self.stop_event_buffer()
         # Free GPIO struct.
         _libdigiapix.ldx_gpio_free(self._gpio_struct)
 
@@ -515,6 +549,113 @@ class GPIO:
         if self._irq_thread_running and not self._irq_callbacks:
             self._stop_interrupts_thread()
 
+    def start_event_buffer(self, ring_len=1024):
+        """
+        Starts queuing the edge events of the GPIO in a ring of the C library.
+
+        A thread of the library drains the kernel events as soon as they arrive, without
+        running any Python code, and the events wait in the ring until they are retrieved
+        with 'read_events()'. This keeps up with fast pulse trains that interrupt
+        callbacks cannot follow.
+
+        The GPIO must be requested with 'GPIO.create_from_controller()' and configured as
+        GPIOMode.IRQ_EDGE_RISING, GPIOMode.IRQ_EDGE_FALLING, or GPIOMode.IRQ_EDGE_BOTH, and
+        it cannot be used together with interrupt callbacks.
+
+        Args:
+            ring_len (Integer, optional): Number of events the ring can hold.
+
+        Raises:
+            ValueError: if `ring_len` is not a positive integer.
+            GPIOException: if there is any error starting the event buffer.
+        """
+        # Sanity checks.
+        if not isinstance(ring_len, int) or ring_len <= 0:
+            raise ValueError(_ERROR_RING_LEN)
+        if self._event_buffer_running:
+            return
+
+        if _libdigiapix.ldx_gpio_start_event_stream(self._gpio_struct, ring_len, None,
+                                                    None) != 0:
+            raise GPIOException("Error starting GPIO event buffer")
+        self._event_buffer_running = True
+
+    def stop_event_buffer(self):
+        """
+        Stops queuing the edge events of the GPIO. Events not read are discarded.
+
+        Threads blocked in 'read_events()' on the event buffer are woken up and get the
+        events left in the ring, or an empty list. The GPIO must not be closed while another
+        thread is still inside 'read_events()'.
+
+        Raises:
+            GPIOException: if there is any error stopping the event buffer.
+        """
+        if not self._event_buffer_running:
+            return
+
+        self._event_buffer_running = False
+        if _libdigiapix.ldx_gpio_stop_event_stream(self._gpio_struct) != 0:
+            raise GPIOException("Error stopping GPIO event buffer")
+
+    def read_events(self, max_events=64, timeout=1000):
+        """
+        Reads the edge events of the GPIO in a single call.
+
+        This function blocks for the given amount of milliseconds (or indefinitely for -1)
+        until at least one event is available, and returns all the queued events up to
+        `max_events`. The Python interpreter lock is released while waiting.
+
+        If the event buffer is running (see 'start_event_buffer()') the events are taken from
+        its ring, otherwise they are read from the kernel queue of the GPIO. Stopping the
+        event buffer from another thread ends the wait on the ring, but nothing ends a wait
+        on the kernel queue, so the default `timeout` is finite and the GPIO must not be
+        closed while a read is in progress.
+
+        Args:
+            max_events (Integer, optional): Maximum number of events to read.
+            timeout (Integer, optional): The maximum number of milliseconds to wait for the
+                                         first event, -1 for blocking indefinitely. One
+                                         second by default.
+
+        Returns:
+            List: List of (timestamp in nanoseconds, :class:`.GPIOEdge`) tuples, oldest first.
+                  Empty on timeout.
+
+        Raises:
+            ValueError: if `max_events` is not a positive integer.
+            GPIOException: if there is any error reading the events.
+        """
+        # Sanity checks.
+        if not isinstance(max_events, int) or max_events <= 0:
+            raise ValueError(_ERROR_EVENTS_MAX)
+
+        # Reuse the events array between calls.
+        if self._events is None or len(self._events) < max_events:
+            self._events = (_GPIOEventStruct * max_events)()
+
+        res = _libdigiapix.ldx_gpio_read_events(self._gpio_struct, self._events, max_events,
+                                                timeout)
+        if res < 0:
+            raise GPIOException("Error reading GPIO events")
+
+        return [(event.timestamp_ns, GPIOEdge.get(event.edge)) for event in self._events[:res]]
+
+    def get_lost_events(self):
+        """
+        Returns the number of events dropped because the event buffer was full.
+
+        Returns:
+            Integer: The number of events lost.
+
+        Raises:
+            GPIOException: if the event buffer is not running.
+        """
+        lost = c_uint64()
+        if _libdigiapix.ldx_gpio_get_lost_events(self._gpio_struct, byref(lost)) != 0:
+            raise GPIOException("Error getting GPIO lost events")
+        return lost.value
+
     def _start_interrupts_thread(self):
         """
         Starts waiting for interrupts.
@@ -632,3 +773,17 @@ def _configure_gpio_ctypes():
     # Stop wait interrupt.
     _libdigiapix.ldx_gpio_stop_wait_interrupt.argtypes = [POINTER(_GPIOStruct)]
     _libdigiapix.ldx_gpio_stop_wait_interrupt.restype = c_int
+    # Read events.
+    _libdigiapix.ldx_gpio_read_events.argtypes = [POINTER(_GPIOStruct),
+                                                  POINTER(_GPIOEventStruct), c_uint32, c_int]
+    _libdigiapix.ldx_gpio_read_events.restype = c_int
+    # Start event stream.
+    _libdigiapix.ldx_gpio_start_event_stream.argtypes = [POINTER(_GPIOStruct), c_uint32,
+                                                         c_void_p, c_void_p]
+    _libdigiapix.ldx_gpio_start_event_stream.restype = c_int
+    # Stop event stream.
+    _libdigiapix.ldx_gpio_stop_event_stream.argtypes = [POINTER(_GPIOStruct)]
+    _libdigiapix.ldx_gpio_stop_event_stream.restype = c_int
+    # Get lost events.
+    _libdigiapix.ldx_gpio_get_lost_events.argtypes = [POINTER(_GPIOStruct), POINTER(c_uint64)]
+    _libdigiapix.ldx_gpio_get_lost_events.restype = c_int
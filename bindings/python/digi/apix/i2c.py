@@ -0,0 +1,471 @@
+# Copyright 2022, Digi International Inc.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+from ctypes import c_char_p, c_int, c_ubyte, c_uint, c_uint16, c_void_p, cast, POINTER, \
+    Structure
+
+from digi.apix import library
+from digi.apix.common import _buffer_from, BusPriority
+from digi.apix.exceptions import DigiAPIXException
+
+# Constants.
+MAX_MSGS = 42
+MAX_LENGTH = 0xFFFF
+
+MSG_READ = 0x0001
+MSG_TEN = 0x0010
+MSG_NOSTART = 0x4000
+
+_ERROR_ADDRESS = "Address must be a positive integer"
+_ERROR_ALIAS = "Alias must be a valid string"
+_ERROR_BUS = "Bus must be a positive integer"
+_ERROR_LENGTH = "Length must be between 1 and %d" % MAX_LENGTH
+_ERROR_MSG = "Messages must be I2CMessage objects"
+_ERROR_MSGS_MAX = "Number of messages must be between 1 and %d" % MAX_MSGS
+_ERROR_PRIORITY = "Priority must be a valid BusPriority entry"
+_ERROR_RETRIES = "Retries must be a positive integer"
+_ERROR_TIMEOUT = "Timeout must be a positive integer"
+
+# Variables.
+_libdigiapix = None
+
+
+class I2CException(DigiAPIXException):
+    """
+    Exception thrown when an error occurs working with I2C buses
+    """
+
+
+class _I2CMsgStruct(Structure):
+    """
+    Internal class to store C library I2C message struct data.
+    """
+    _fields_ = [('address', c_uint16),
+                ('flags', c_uint16),
+                ('length', c_uint16),
+                ('buffer', POINTER(c_ubyte))]
+
+
+class _I2CStruct(Structure):
+    """
+    Internal class to store C library I2C struct data.
+    """
+    _fields_ = [('alias', c_char_p),
+                ('bus', c_uint),
+                ('data', c_void_p)]
+
+
+class I2CMessage:
+    """
+    This class represents a message of a combined I2C transfer. Instances should be created
+    with 'I2CMessage.write()' or 'I2CMessage.read()'. See 'I2C.transfer_msgs()'.
+    """
+
+    def __init__(self, address, buffer, length, flags):
+        """
+        Class constructor. This method should not be called directly, instead use
+        'I2CMessage.write()' or 'I2CMessage.read()'.
+        """
+        if not isinstance(address, int) or address < 0:
+            raise ValueError(_ERROR_ADDRESS)
+        if not 0 < length <= MAX_LENGTH:
+            raise ValueError(_ERROR_LENGTH)
+
+        self.address = address
+        self.flags = flags
+        self.length = length
+        self._buf = buffer
+
+    @classmethod
+    def write(cls, address, data, flags=0):
+        """
+        Creates a message that writes the given data to a slave device.
+
+        Args:
+            address (Integer): Address of the I2C slave device.
+            data (Object): The data to write, any object supporting the buffer protocol or a
+                           sequence of integers.
+            flags (Integer, optional): Additional message flags (`MSG_TEN`, `MSG_NOSTART`).
+
+        Returns:
+            :class:`.I2CMessage`: The new message.
+
+        Raises:
+            ValueError: if `address` is not a positive integer or `data` is not valid.
+        """
+        buf, length = _buffer_from(data)
+        return cls(address, buf, length, flags & ~MSG_READ)
+
+    @classmethod
+    def read(cls, address, length_or_buffer, flags=0):
+        """
+        Creates a message that reads data from a slave device.
+
+        The read data is available in the `data` attribute of the message after the transfer.
+        If a writable buffer is given, the data is stored in place in it.
+
+        Args:
+            address (Integer): Address of the I2C slave device.
+            length_or_buffer (Integer or Object): Number of bytes to read, or writable object
+                                                  supporting the buffer protocol to fill.
+            flags (Integer, optional): Additional message flags (`MSG_TEN`, `MSG_NOSTART`).
+
+        Returns:
+            :class:`.I2CMessage`: The new message.
+
+        Raises:
+            ValueError: if `address` is not a positive integer or `length_or_buffer` is not
+                        valid.
+        """
+        if isinstance(length_or_buffer, int):
+            if not 0 < length_or_buffer <= MAX_LENGTH:
+                raise ValueError(_ERROR_LENGTH)
+            length_or_buffer = bytearray(length_or_buffer)
+        buf, length = _buffer_from(length_or_buffer, writable=True)
+        msg = cls(address, buf, length, flags | MSG_READ)
+        msg.data = length_or_buffer
+        return msg
+
+    def _fill(self, msg_struct):
+        """
+        Fills the given C library message struct with the data of this message.
+
+        Args:
+            msg_struct (:class:`._I2CMsgStruct`): The struct to fill.
+        """
+        msg_struct.address = self.address
+        msg_struct.flags = self.flags
+        msg_struct.length = self.length
+        msg_struct.buffer = cast(self._buf, POINTER(c_ubyte))
+
+
+class I2C:
+    """
+    This class represents an I2C bus. Instances of I2C should be created using the
+    'I2C.create_from_<x>' family of functions.
+    """
+
+    def __init__(self, i2c_struct):
+        """
+        Class constructor. This method should not be called directly, instead use the
+        'I2C.create_from_<x>' family of functions.
+        """
+        self._i2c_struct = i2c_struct
+        self._msgs = None
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free I2C struct.
+        _libdigiapix.ldx_i2c_free(self._i2c_struct)
+
+    @classmethod
+    def create(cls, bus):
+        """
+        Requests a new I2C bus using the given Linux bus number.
+
+        Args:
+            bus (Integer): The Linux bus number of the I2C to request.
+
+        Returns:
+            :class:`.I2C`: The instantiated I2C.
+
+        Raises:
+            ValueError: if `bus` is not a positive integer.
+            DigiAPIXException: if there is any error loading the library.
+            I2CException: if there is any error creating the I2C.
+        """
+        # Sanity checks.
+        if not isinstance(bus, int) or bus < 0:
+            raise ValueError(_ERROR_BUS)
+        _check_library()
+
+        i2c_struct = _libdigiapix.ldx_i2c_request(bus)
+        if not i2c_struct:
+            raise I2CException("Error creating I2C")
+        return cls(i2c_struct)
+
+    @classmethod
+    def create_from_alias(cls, alias):
+        """
+        Requests a new I2C bus using the given alias.
+
+        Args:
+            alias (String): The alias name of the I2C to request.
+
+        Returns:
+            :class:`.I2C`: The instantiated I2C.
+
+        Raises:
+            ValueError: if `alias` is not a valid string.
+            DigiAPIXException: if there is any error loading the library.
+            I2CException: if there is any error creating the I2C.
+        """
+        # Sanity checks.
+        if not isinstance(alias, str):
+            raise ValueError(_ERROR_ALIAS)
+        _check_library()
+
+        i2c_struct = _libdigiapix.ldx_i2c_request_by_alias(
+            alias.encode(encoding="ascii", errors="ignore"))
+        if not i2c_struct:
+            raise I2CException("Error creating I2C")
+        return cls(i2c_struct)
+
+    @property
+    def alias(self):
+        """
+        Returns the I2C alias.
+
+        Returns:
+            String: I2C alias.
+        """
+        alias = self._i2c_struct.contents.alias
+        return alias.decode(encoding="ascii", errors="ignore") if alias else None
+
+    @property
+    def bus(self):
+        """
+        Returns the I2C Linux bus number.
+
+        Returns:
+            Integer: I2C bus number.
+        """
+        return self._i2c_struct.contents.bus
+
+    def set_timeout(self, timeout):
+        """
+        Sets the I2C bus timeout.
+
+        Args:
+            timeout (Integer): Timeout in units of 10 milliseconds.
+
+        Raises:
+            ValueError: if `timeout` is not a positive integer.
+            I2CException: if there is any error setting the timeout.
+        """
+        # Sanity checks.
+        if not isinstance(timeout, int) or timeout < 0:
+            raise ValueError(_ERROR_TIMEOUT)
+
+        if _libdigiapix.ldx_i2c_set_timeout(self._i2c_struct, timeout) != 0:
+            raise I2CException("Error setting I2C timeout")
+
+    def set_retries(self, retries):
+        """
+        Sets the number of times a device is polled when it does not acknowledge.
+
+        Args:
+            retries (Integer): Number of retries.
+
+        Raises:
+            ValueError: if `retries` is not a positive integer.
+            I2CException: if there is any error setting the retries.
+        """
+        # Sanity checks.
+        if not isinstance(retries, int) or retries < 0:
+            raise ValueError(_ERROR_RETRIES)
+
+        if _libdigiapix.ldx_i2c_set_retries(self._i2c_struct, retries) != 0:
+            raise I2CException("Error setting I2C retries")
+
+    def set_priority(self, priority):
+        """
+        Sets the priority class of the transactions of the I2C.
+
+        Args:
+            priority (:class:`.BusPriority`): The priority class.
+
+        Raises:
+            ValueError: if `priority` is not a valid :class:`.BusPriority`.
+            I2CException: if there is any error setting the priority.
+        """
+        # Sanity checks.
+        if not isinstance(priority, BusPriority):
+            raise ValueError(_ERROR_PRIORITY)
+
+        if _libdigiapix.ldx_i2c_set_priority(self._i2c_struct, priority.code) != 0:
+            raise I2CException("Error setting I2C priority")
+
+    def read(self, address, length):
+        """
+        Reads data from an I2C slave device.
+
+        Args:
+            address (Integer): Address of the I2C slave device.
+            length (Integer): Number of bytes to read.
+
+        Returns:
+            Bytearray: The read data.
+
+        Raises:
+            ValueError: if `address` or `length` are not valid.
+            I2CException: if there is any error reading the data.
+        """
+        # Sanity checks.
+        if not isinstance(address, int) or address < 0:
+            raise ValueError(_ERROR_ADDRESS)
+        if not isinstance(length, int) or not 0 < length <= MAX_LENGTH:
+            raise ValueError(_ERROR_LENGTH)
+
+        data = bytearray(length)
+        buf, _length = _buffer_from(data, writable=True)
+        if _libdigiapix.ldx_i2c_read(self._i2c_struct, address, buf, length) != 0:
+            raise I2CException("Error reading I2C data")
+        return data
+
+    def write(self, address, data):
+        """
+        Writes data to an I2C slave device.
+
+        Args:
+            address (Integer): Address of the I2C slave device.
+            data (Object): The data to write, any object supporting the buffer protocol or a
+                           sequence of integers.
+
+        Raises:
+            ValueError: if `address` or `data` are not valid.
+            I2CException: if there is any error writing the data.
+        """
+        # Sanity checks.
+        if not isinstance(address, int) or address < 0:
+            raise ValueError(_ERROR_ADDRESS)
+        buf, length = _buffer_from(data)
+        if not 0 < length <= MAX_LENGTH:
+            raise ValueError(_ERROR_LENGTH)
+
+        if _libdigiapix.ldx_i2c_write(self._i2c_struct, address, buf, length) != 0:
+            raise I2CException("Error writing I2C data")
+
+    def transfer(self, address, data, read_length):
+        """
+        Writes data to an I2C slave device and reads its answer in a single bus transaction,
+        with a repeated START and no STOP between them.
+
+        Args:
+            address (Integer): Address of the I2C slave device.
+            data (Object): The data to write, any object supporting the buffer protocol or a
+                           sequence of integers.
+            read_length (Integer): Number of bytes to read.
+
+        Returns:
+            Bytearray: The read data.
+
+        Raises:
+            ValueError: if any parameter is not valid.
+            I2CException: if there is any error transferring the data.
+        """
+        # Sanity checks.
+        if not isinstance(address, int) or address < 0:
+            raise ValueError(_ERROR_ADDRESS)
+        if not isinstance(read_length, int) or not 0 < read_length <= MAX_LENGTH:
+            raise ValueError(_ERROR_LENGTH)
+        tx_buf, length = _buffer_from(data)
+        if not 0 < length <= MAX_LENGTH:
+            raise ValueError(_ERROR_LENGTH)
+
+        rx_data = bytearray(read_length)
+        rx_buf, _length = _buffer_from(rx_data, writable=True)
+        if _libdigiapix.ldx_i2c_transfer(self._i2c_struct, address, tx_buf, length, rx_buf,
+                                         read_length) != 0:
+            raise I2CException("Error transferring I2C data")
+        return rx_data
+
+    def transfer_msgs(self, msgs):
+        """
+        Runs several messages as one I2C transaction, with a single call to the C library.
+
+        The messages are separated by repeated STARTs, with a STOP only after the last one,
+        and can address different slave devices. The read data is stored in the `data`
+        attribute of each read message.
+
+        Args:
+            msgs (List): List of :class:`.I2CMessage`, in transfer order.
+
+        Raises:
+            ValueError: if `msgs` is not a list of :class:`.I2CMessage` or it has more than
+                        `MAX_MSGS` entries.
+            I2CException: if there is any error transferring the messages.
+        """
+        # Sanity checks.
+        if not 0 < len(msgs) <= MAX_MSGS:
+            raise ValueError(_ERROR_MSGS_MAX)
+        if not all(isinstance(msg, I2CMessage) for msg in msgs):
+            raise ValueError(_ERROR_MSG)
+
+        # Reuse the messages array between calls.
+        if self._msgs is None:
+            self._msgs = (_I2CMsgStruct * MAX_MSGS)()
+        for msg, msg_struct in zip(msgs, self._msgs):
+            msg._fill(msg_struct)
+
+        if _libdigiapix.ldx_i2c_transfer_msgs(self._i2c_struct, self._msgs, len(msgs)) != 0:
+            raise I2CException("Error transferring I2C messages")
+
+
+def _check_library():
+    """
+    Verifies that the 'digiapix' library is loaded.
+
+    Raises:
+        DigiAPIXException: if there is any error loading the library.
+    """
+    # Use global variable.
+    global _libdigiapix
+    # Load the library.
+    if _libdigiapix is None:
+        _libdigiapix = library.get_library()
+        # Configure the CTypes of the I2C methods to use.
+        _configure_i2c_ctypes()
+
+
+def _configure_i2c_ctypes():
+    """
+    Configures the ctypes for the library I2C methods
+    """
+    # Request I2C.
+    _libdigiapix.ldx_i2c_request.argtypes = [c_uint]
+    _libdigiapix.ldx_i2c_request.restype = POINTER(_I2CStruct)
+    # Request by alias.
+    _libdigiapix.ldx_i2c_request_by_alias.argtypes = [c_char_p]
+    _libdigiapix.ldx_i2c_request_by_alias.restype = POINTER(_I2CStruct)
+    # Free I2C.
+    _libdigiapix.ldx_i2c_free.argtypes = [POINTER(_I2CStruct)]
+    _libdigiapix.ldx_i2c_free.restype = c_int
+    # Set timeout.
+    _libdigiapix.ldx_i2c_set_timeout.argtypes = [POINTER(_I2CStruct), c_uint]
+    _libdigiapix.ldx_i2c_set_timeout.restype = c_int
+    # Set retries.
+    _libdigiapix.ldx_i2c_set_retries.argtypes = [POINTER(_I2CStruct), c_uint]
+    _libdigiapix.ldx_i2c_set_retries.restype = c_int
+    # Set priority.
+    _libdigiapix.ldx_i2c_set_priority.argtypes = [POINTER(_I2CStruct), c_int]
+    _libdigiapix.ldx_i2c_set_priority.restype = c_int
+    # Read.
+    _libdigiapix.ldx_i2c_read.argtypes = [POINTER(_I2CStruct), c_uint, POINTER(c_ubyte),
+                                          c_uint16]
+    _libdigiapix.ldx_i2c_read.restype = c_int
+    # Write.
+    _libdigiapix.ldx_i2c_write.argtypes = [POINTER(_I2CStruct), c_uint, POINTER(c_ubyte),
+                                           c_uint16]
+    _libdigiapix.ldx_i2c_write.restype = c_int
+    # Transfer.
+    _libdigiapix.ldx_i2c_transfer.argtypes = [POINTER(_I2CStruct), c_uint, POINTER(c_ubyte),
+                                              c_uint16, POINTER(c_ubyte), c_uint16]
+    _libdigiapix.ldx_i2c_transfer.restype = c_int
+    # Transfer messages.
+    _libdigiapix.ldx_i2c_transfer_msgs.argtypes = [POINTER(_I2CStruct),
+                                                   POINTER(_I2CMsgStruct), c_uint]
+    _libdigiapix.ldx_i2c_transfer_msgs.restype = c_int
@@ -0,0 +1,625 @@
+# Copyright 2022, Digi International Inc.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+from ctypes import byref, c_char_p, c_int, c_long, c_uint, c_ulong, c_void_p, POINTER, \
+    Structure
+
+from digi.apix import library
+from digi.apix.common import _AbstractEnum, RequestMode
+from digi.apix.exceptions import DigiAPIXException
+
+# Constants.
+_ERROR_ALIAS = "Alias must be a valid string"
+_ERROR_CHANNEL = "Channel must be a positive integer"
+_ERROR_CHIP = "Chip must be a positive integer"
+_ERROR_DUTY_CYCLE = "Duty cycle must be a positive integer"
+_ERROR_DUTY_CYCLES = "There must be one duty cycle per PWM of the group"
+_ERROR_FREQUENCY = "Frequency must be a positive integer"
+_ERROR_PERCENTAGE = "Percentage must be an integer between 0 and 100"
+_ERROR_PERIOD = "Period must be a positive integer"
+_ERROR_POLARITY = "Polarity must be a valid PWMPolarity entry"
+_ERROR_PWMS = "PWMs must be a non empty list of PWM objects"
+_ERROR_REQUEST_MODE = "Request mode must be a valid RequestMode entry"
+
+_CONFIG_ERROR_NONE = 0
+_CONFIG_ERROR_INVALID = 2
+
+# Variables.
+_libdigiapix = None
+
+
+class PWMException(DigiAPIXException):
+    """
+    Exception thrown when an error occurs working with PWMs
+    """
+
+
+class PWMPolarity(_AbstractEnum):
+    """
+    Enumeration class listing all the PWM polarities.
+    """
+    NORMAL = (0, "Normal")
+    INVERSED = (1, "Inversed")
+
+    def __init__(self, code, description):
+        """
+        Class constructor. Instantiates a new `PWMPolarity` entry with the provided parameters.
+
+        Args:
+            code (Integer): PWM polarity code.
+            description (String): PWM polarity description.
+        """
+        super().__init__(code, "", description)
+
+
+class _PWMStateStruct(Structure):
+    """
+    Internal class to store C library PWM state struct data.
+    """
+    _fields_ = [('period', c_uint),
+                ('duty_cycle', c_uint),
+                ('polarity', c_int),
+                ('enabled', c_int)]
+
+
+class _PWMStruct(Structure):
+    """
+    Internal class to store C library PWM struct data.
+    """
+    _fields_ = [('alias', c_char_p),
+                ('channel', c_uint),
+                ('chip', c_uint),
+                ('data', c_void_p)]
+
+
+class _PWMGroupStruct(Structure):
+    """
+    Internal class to store C library PWM group struct data.
+    """
+    _fields_ = [('chip', c_uint),
+                ('num_pwms', c_uint),
+                ('data', c_void_p)]
+
+
+def _check_config_error(res, message):
+    """
+    Raises the exception corresponding to the given PWM configuration result.
+
+    Args:
+        res (Integer): The configuration result returned by the library.
+        message (String): The error message.
+
+    Raises:
+        ValueError: if the library rejected the configuration as invalid.
+        PWMException: if there was any other error.
+    """
+    if res == _CONFIG_ERROR_NONE:
+        return
+    if res == _CONFIG_ERROR_INVALID:
+        raise ValueError(message + ": invalid configuration")
+    raise PWMException(message)
+
+
+class PWM:
+    """
+    This class represents a PWM channel. Instances of PWM should be created using the
+    'PWM.create_from_<x>' family of functions.
+    """
+
+    def __init__(self, pwm_struct):
+        """
+        Class constructor. This method should not be called directly, instead use the
+        'PWM.create_from_<x>' family of functions.
+        """
+        self._pwm_struct = pwm_struct
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free PWM struct.
+        _libdigiapix.ldx_pwm_free(self._pwm_struct)
+
+    @classmethod
+    def create(cls, chip, channel, request_mode):
+        """
+        Requests a new PWM using the given chip and channel.
+
+        Args:
+            chip (Integer): The Linux chip number of the PWM.
+            channel (Integer): The channel of the PWM.
+            request_mode (:class:`.RequestMode`): Request mode for opening the PWM.
+
+        Returns:
+            :class:`.PWM`: The instantiated PWM.
+
+        Raises:
+            ValueError: if `chip` or `channel` are not positive integers or
+                        if `request_mode` is not a valid :class:`.RequestMode`.
+            DigiAPIXException: if there is any error loading the library.
+            PWMException: if there is any error creating the PWM.
+        """
+        # Sanity checks.
+        if not isinstance(chip, int) or chip < 0:
+            raise ValueError(_ERROR_CHIP)
+        if not isinstance(channel, int) or channel < 0:
+            raise ValueError(_ERROR_CHANNEL)
+        if not isinstance(request_mode, RequestMode):
+            raise ValueError(_ERROR_REQUEST_MODE)
+        _check_library()
+
+        pwm_struct = _libdigiapix.ldx_pwm_request(chip, channel, request_mode.code)
+        if not pwm_struct:
+            raise PWMException("Error creating PWM")
+        return cls(pwm_struct)
+
+    @classmethod
+    def create_from_alias(cls, alias, request_mode):
+        """
+        Requests a new PWM using the given alias.
+
+        Args:
+            alias (String): The alias name of the PWM to request.
+            request_mode (:class:`.RequestMode`): Request mode for opening the PWM.
+
+        Returns:
+            :class:`.PWM`: The instantiated PWM.
+
+        Raises:
+            ValueError: if `alias` is not a valid string or
+                        if `request_mode` is not a valid :class:`.RequestMode`.
+            DigiAPIXException: if there is any error loading the library.
+            PWMException: if there is any error creating the PWM.
+        """
+        # Sanity checks.
+        if not isinstance(alias, str):
+            raise ValueError(_ERROR_ALIAS)
+        if not isinstance(request_mode, RequestMode):
+            raise ValueError(_ERROR_REQUEST_MODE)
+        _check_library()
+
+        pwm_struct = _libdigiapix.ldx_pwm_request_by_alias(
+            alias.encode(encoding="ascii", errors="ignore"), request_mode.code)
+        if not pwm_struct:
+            raise PWMException("Error creating PWM")
+        return cls(pwm_struct)
+
+    @property
+    def alias(self):
+        """
+        Returns the PWM alias.
+
+        Returns:
+            String: PWM alias.
+        """
+        alias = self._pwm_struct.contents.alias
+        return alias.decode(encoding="ascii", errors="ignore") if alias else None
+
+    @property
+    def chip(self):
+        """
+        Returns the PWM chip.
+
+        Returns:
+            Integer: PWM chip number.
+        """
+        return self._pwm_struct.contents.chip
+
+    @property
+    def channel(self):
+        """
+        Returns the PWM channel.
+
+        Returns:
+            Integer: PWM channel.
+        """
+        return self._pwm_struct.contents.channel
+
+    def set_frequency(self, frequency):
+        """
+        Changes the frequency of the PWM signal.
+
+        Args:
+            frequency (Integer): The new frequency in Hz.
+
+        Raises:
+            ValueError: if `frequency` is not valid.
+            PWMException: if there is any error setting the frequency.
+        """
+        # Sanity checks.
+        if not isinstance(frequency, int) or frequency <= 0:
+            raise ValueError(_ERROR_FREQUENCY)
+
+        _check_config_error(_libdigiapix.ldx_pwm_set_freq(self._pwm_struct, frequency),
+                            "Error setting PWM frequency")
+
+    def get_frequency(self):
+        """
+        Gets the frequency of the PWM signal.
+
+        Returns:
+            Integer: The frequency in Hz.
+
+        Raises:
+            PWMException: if there is any error reading the frequency.
+        """
+        frequency = _libdigiapix.ldx_pwm_get_freq(self._pwm_struct)
+        if frequency < 0:
+            raise PWMException("Error reading PWM frequency")
+        return frequency
+
+    def set_period(self, period):
+        """
+        Changes the period of the PWM signal.
+
+        Args:
+            period (Integer): The new period in ns.
+
+        Raises:
+            ValueError: if `period` is not valid.
+            PWMException: if there is any error setting the period.
+        """
+        # Sanity checks.
+        if not isinstance(period, int) or period <= 0:
+            raise ValueError(_ERROR_PERIOD)
+
+        _check_config_error(_libdigiapix.ldx_pwm_set_period(self._pwm_struct, period),
+                            "Error setting PWM period")
+
+    def get_period(self):
+        """
+        Gets the period of the PWM signal.
+
+        Returns:
+            Integer: The period in ns.
+
+        Raises:
+            PWMException: if there is any error reading the period.
+        """
+        period = _libdigiapix.ldx_pwm_get_period(self._pwm_struct)
+        if period < 0:
+            raise PWMException("Error reading PWM period")
+        return period
+
+    def set_duty_cycle(self, duty_cycle):
+        """
+        Changes the duty cycle of the PWM signal.
+
+        Args:
+            duty_cycle (Integer): The new active time of the signal in ns.
+
+        Raises:
+            ValueError: if `duty_cycle` is not valid.
+            PWMException: if there is any error setting the duty cycle.
+        """
+        # Sanity checks.
+        if not isinstance(duty_cycle, int) or duty_cycle < 0:
+            raise ValueError(_ERROR_DUTY_CYCLE)
+
+        _check_config_error(_libdigiapix.ldx_pwm_set_duty_cycle(self._pwm_struct, duty_cycle),
+                            "Error setting PWM duty cycle")
+
+    def get_duty_cycle(self):
+        """
+        Gets the duty cycle of the PWM signal.
+
+        Returns:
+            Integer: The active time of the signal in ns.
+
+        Raises:
+            PWMException: if there is any error reading the duty cycle.
+        """
+        duty_cycle = _libdigiapix.ldx_pwm_get_duty_cycle(self._pwm_struct)
+        if duty_cycle < 0:
+            raise PWMException("Error reading PWM duty cycle")
+        return duty_cycle
+
+    def set_duty_cycle_percentage(self, percentage):
+        """
+        Changes the duty cycle of the PWM signal as a percentage of its period.
+
+        Args:
+            percentage (Integer): The new duty cycle percentage, from 0 to 100.
+
+        Raises:
+            ValueError: if `percentage` is not valid.
+            PWMException: if there is any error setting the duty cycle.
+        """
+        # Sanity checks.
+        if not isinstance(percentage, int) or not 0 <= percentage <= 100:
+            raise ValueError(_ERROR_PERCENTAGE)
+
+        _check_config_error(_libdigiapix.ldx_pwm_set_duty_cycle_percentage(self._pwm_struct,
+                                                                           percentage),
+                            "Error setting PWM duty cycle")
+
+    def get_duty_cycle_percentage(self):
+        """
+        Gets the duty cycle of the PWM signal as a percentage of its period.
+
+        Returns:
+            Integer: The duty cycle percentage.
+
+        Raises:
+            PWMException: if there is any error reading the duty cycle.
+        """
+        percentage = _libdigiapix.ldx_pwm_get_duty_cycle_percentage(self._pwm_struct)
+        if percentage < 0:
+            raise PWMException("Error reading PWM duty cycle")
+        return percentage
+
+    def set_polarity(self, polarity):
+        """
+        Changes the polarity of the PWM signal.
+
+        Args:
+            polarity (:class:`.PWMPolarity`): The new polarity.
+
+        Raises:
+            ValueError: if `polarity` is not a valid :class:`.PWMPolarity`.
+            PWMException: if there is any error setting the polarity.
+        """
+        # Sanity checks.
+        if not isinstance(polarity, PWMPolarity):
+            raise ValueError(_ERROR_POLARITY)
+
+        if _libdigiapix.ldx_pwm_set_polarity(self._pwm_struct, polarity.code) != 0:
+            raise PWMException("Error setting PWM polarity")
+
+    def get_polarity(self):
+        """
+        Gets the polarity of the PWM signal.
+
+        Returns:
+            :class:`.PWMPolarity`: The polarity.
+
+        Raises:
+            PWMException: if there is any error reading the polarity.
+        """
+        polarity = PWMPolarity.get(_libdigiapix.ldx_pwm_get_polarity(self._pwm_struct))
+        if not polarity:
+            raise PWMException("Error reading PWM polarity")
+        return polarity
+
+    def enable(self, enabled=True):
+        """
+        Enables or disables the PWM signal.
+
+        Args:
+            enabled (Boolean, optional): `True` to enable the signal, `False` to disable it.
+
+        Raises:
+            PWMException: if there is any error enabling the PWM.
+        """
+        if _libdigiapix.ldx_pwm_enable(self._pwm_struct, 1 if enabled else 0) != 0:
+            raise PWMException("Error enabling PWM")
+
+    def is_enabled(self):
+        """
+        Returns whether the PWM signal is enabled.
+
+        Returns:
+            Boolean: `True` if the signal is enabled, `False` otherwise.
+
+        Raises:
+            PWMException: if there is any error reading the PWM status.
+        """
+        enabled = _libdigiapix.ldx_pwm_is_enabled(self._pwm_struct)
+        if enabled < 0:
+            raise PWMException("Error reading PWM status")
+        return enabled == 1
+
+    def apply(self, period, duty_cycle, polarity=PWMPolarity.NORMAL, enabled=True):
+        """
+        Changes the whole configuration of the PWM with a single call to the C library.
+
+        Only the attributes that differ from the current configuration are written, in an
+        order that keeps every intermediate configuration valid.
+
+        Args:
+            period (Integer): Period of the signal in ns.
+            duty_cycle (Integer): Active time of the signal in ns.
+            polarity (:class:`.PWMPolarity`, optional): Polarity of the signal.
+            enabled (Boolean, optional): `True` to output the signal.
+
+        Raises:
+            ValueError: if any parameter is not valid.
+            PWMException: if there is any error configuring the PWM.
+        """
+        # Sanity checks.
+        if not isinstance(period, int) or period <= 0:
+            raise ValueError(_ERROR_PERIOD)
+        if not isinstance(duty_cycle, int) or duty_cycle < 0:
+            raise ValueError(_ERROR_DUTY_CYCLE)
+        if not isinstance(polarity, PWMPolarity):
+            raise ValueError(_ERROR_POLARITY)
+
+        state = _PWMStateStruct(period, duty_cycle, polarity.code, 1 if enabled else 0)
+        _check_config_error(_libdigiapix.ldx_pwm_apply(self._pwm_struct, byref(state)),
+                            "Error configuring PWM")
+
+    def get_state(self):
+        """
+        Gets the whole configuration of the PWM.
+
+        Returns:
+            Tuple (Integer, Integer, :class:`.PWMPolarity`, Boolean): The period in ns, the
+                duty cycle in ns, the polarity and whether the signal is enabled.
+
+        Raises:
+            PWMException: if there is any error reading the configuration.
+        """
+        state = _PWMStateStruct()
+        if _libdigiapix.ldx_pwm_get_state(self._pwm_struct, byref(state)) != 0:
+            raise PWMException("Error reading PWM state")
+        return (state.period, state.duty_cycle, PWMPolarity.get(state.polarity),
+                state.enabled == 1)
+
+
+class PWMGroup:
+    """
+    This class represents a group of PWMs of the same chip whose duty cycles are updated
+    together.
+    """
+
+    def __init__(self, pwms):
+        """
+        Class constructor. Instantiates a new `PWMGroup` with the given PWMs, all of them of
+        the same chip. The PWMs must not be freed while the group exists.
+
+        Args:
+            pwms (List): List of :class:`.PWM`.
+
+        Raises:
+            ValueError: if `pwms` is not a non empty list of :class:`.PWM`.
+            PWMException: if there is any error creating the group.
+        """
+        # Sanity checks.
+        if not pwms or not all(isinstance(pwm, PWM) for pwm in pwms):
+            raise ValueError(_ERROR_PWMS)
+
+        self._pwms = list(pwms)
+        self._duty_ns = (c_uint * len(self._pwms))()
+        pwm_structs = (POINTER(_PWMStruct) * len(self._pwms))(
+            *[pwm._pwm_struct for pwm in self._pwms])
+        self._group_struct = _libdigiapix.ldx_pwm_group_create(pwm_structs, len(self._pwms))
+        if not self._group_struct:
+            raise PWMException("Error creating PWM group")
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free PWM group struct.
+        if getattr(self, "_group_struct", None):
+            _libdigiapix.ldx_pwm_group_free(self._group_struct)
+
+    @property
+    def pwms(self):
+        """
+        Returns the PWMs of the group.
+
+        Returns:
+            List: List of :class:`.PWM`, in the order given to the constructor.
+        """
+        return list(self._pwms)
+
+    def set_duty_cycles(self, duty_cycles):
+        """
+        Sets the duty cycle of every PWM of the group with a single call to the C library.
+
+        All the values are validated before the first write, and then they are written back
+        to back to keep the skew between the channels as small as possible.
+
+        Args:
+            duty_cycles (List): The new duty cycle in ns of each PWM, in the order of the
+                                group.
+
+        Raises:
+            ValueError: if `duty_cycles` does not have one valid value per PWM.
+            PWMException: if there is any error setting the duty cycles.
+        """
+        # Sanity checks.
+        if len(duty_cycles) != len(self._pwms):
+            raise ValueError(_ERROR_DUTY_CYCLES)
+        if not all(isinstance(duty, int) and duty >= 0 for duty in duty_cycles):
+            raise ValueError(_ERROR_DUTY_CYCLE)
+
+        self._duty_ns[:] = duty_cycles
+        _check_config_error(_libdigiapix.ldx_pwm_group_set_duty_cycles(self._group_struct,
+                                                                       self._duty_ns),
+                            "Error setting PWM group duty cycles")
+
+
+def _check_library():
+    """
+    Verifies that the 'digiapix' library is loaded.
+
+    Raises:
+        DigiAPIXException: if there is any error loading the library.
+    """
+    # Use global variable.
+    global _libdigiapix
+    # Load the library.
+    if _libdigiapix is None:
+        _libdigiapix = library.get_library()
+        # Configure the CTypes of the PWM methods to use.
+        _configure_pwm_ctypes()
+
+
+def _configure_pwm_ctypes():
+    """
+    Configures the ctypes for the library PWM methods
+    """
+    # Request PWM.
+    _libdigiapix.ldx_pwm_request.argtypes = [c_uint, c_uint, c_int]
+    _libdigiapix.ldx_pwm_request.restype = POINTER(_PWMStruct)
+    # Request by alias.
+    _libdigiapix.ldx_pwm_request_by_alias.argtypes = [c_char_p, c_int]
+    _libdigiapix.ldx_pwm_request_by_alias.restype = POINTER(_PWMStruct)
+    # Free PWM.
+    _libdigiapix.ldx_pwm_free.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_free.restype = c_int
+    # Set frequency.
+    _libdigiapix.ldx_pwm_set_freq.argtypes = [POINTER(_PWMStruct), c_ulong]
+    _libdigiapix.ldx_pwm_set_freq.restype = c_int
+    # Get frequency.
+    _libdigiapix.ldx_pwm_get_freq.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_get_freq.restype = c_long
+    # Set period.
+    _libdigiapix.ldx_pwm_set_period.argtypes = [POINTER(_PWMStruct), c_uint]
+    _libdigiapix.ldx_pwm_set_period.restype = c_int
+    # Get period.
+    _libdigiapix.ldx_pwm_get_period.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_get_period.restype = c_int
+    # Set duty cycle.
+    _libdigiapix.ldx_pwm_set_duty_cycle.argtypes = [POINTER(_PWMStruct), c_uint]
+    _libdigiapix.ldx_pwm_set_duty_cycle.restype = c_int
+    # Get duty cycle.
+    _libdigiapix.ldx_pwm_get_duty_cycle.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_get_duty_cycle.restype = c_int
+    # Set duty cycle percentage.
+    _libdigiapix.ldx_pwm_set_duty_cycle_percentage.argtypes = [POINTER(_PWMStruct), c_uint]
+    _libdigiapix.ldx_pwm_set_duty_cycle_percentage.restype = c_int
+    # Get duty cycle percentage.
+    _libdigiapix.ldx_pwm_get_duty_cycle_percentage.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_get_duty_cycle_percentage.restype = c_int
+    # Set polarity.
+    _libdigiapix.ldx_pwm_set_polarity.argtypes = [POINTER(_PWMStruct), c_int]
+    _libdigiapix.ldx_pwm_set_polarity.restype = c_int
+    # Get polarity.
+    _libdigiapix.ldx_pwm_get_polarity.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_get_polarity.restype = c_int
+    # Enable.
+    _libdigiapix.ldx_pwm_enable.argtypes = [POINTER(_PWMStruct), c_int]
+    _libdigiapix.ldx_pwm_enable.restype = c_int
+    # Is enabled.
+    _libdigiapix.ldx_pwm_is_enabled.argtypes = [POINTER(_PWMStruct)]
+    _libdigiapix.ldx_pwm_is_enabled.restype = c_int
+    # Apply state.
+    _libdigiapix.ldx_pwm_apply.argtypes = [POINTER(_PWMStruct), POINTER(_PWMStateStruct)]
+    _libdigiapix.ldx_pwm_apply.restype = c_int
+    # Get state.
+    _libdigiapix.ldx_pwm_get_state.argtypes = [POINTER(_PWMStruct), POINTER(_PWMStateStruct)]
+    _libdigiapix.ldx_pwm_get_state.restype = c_int
+    # Create group.
+    _libdigiapix.ldx_pwm_group_create.argtypes = [POINTER(POINTER(_PWMStruct)), c_uint]
+    _libdigiapix.ldx_pwm_group_create.restype = POINTER(_PWMGroupStruct)
+    # Free group.
+    _libdigiapix.ldx_pwm_group_free.argtypes = [POINTER(_PWMGroupStruct)]
+    _libdigiapix.ldx_pwm_group_free.restype = c_int
+    # Set group duty cycles.
+    _libdigiapix.ldx_pwm_group_set_duty_cycles.argtypes = [POINTER(_PWMGroupStruct),
+                                                           POINTER(c_uint)]
+    _libdigiapix.ldx_pwm_group_set_duty_cycles.restype = c_int
@@ -0,0 +1,662 @@
+# Copyright 2022, Digi International Inc.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+from ctypes import byref, c_bool, c_char_p, c_int, c_ubyte, c_uint, c_uint8, c_uint16, \
+    c_void_p, cast, POINTER, Structure
+
+from digi.apix import library
+from digi.apix.common import _AbstractEnum, _buffer_from, BusPriority
+from digi.apix.exceptions import DigiAPIXException
+
+# Constants.
+MAX_SEGMENTS = 256
+
+_ERROR_ALIAS = "Alias must be a valid string"
+_ERROR_BIT_ORDER = "Bit order must be a valid SPIBitOrder entry"
+_ERROR_BPW = "Bits-per-word must be a valid SPIBitsPerWord entry"
+_ERROR_CHIP_SELECT = "Chip select must be a valid SPIChipSelect entry"
+_ERROR_CLK_MODE = "Clock mode must be a valid SPIClockMode entry"
+_ERROR_DEVICE = "Device must be a positive integer"
+_ERROR_LENGTH = "Length must be a positive integer"
+_ERROR_PRIORITY = "Priority must be a valid BusPriority entry"
+_ERROR_SEGMENT = "Segments must be SPISegment objects"
+_ERROR_SEGMENTS_MAX = "Number of segments must be between 1 and %d" % MAX_SEGMENTS
+_ERROR_SEGMENT_LENGTH = "Segment buffers must have the length of the segment"
+_ERROR_SLAVE = "Slave must be a positive integer"
+_ERROR_SPEED = "Speed must be a positive integer"
+
+# Variables.
+_libdigiapix = None
+
+
+class SPIException(DigiAPIXException):
+    """
+    Exception thrown when an error occurs working with SPIs
+    """
+
+
+class SPIClockMode(_AbstractEnum):
+    """
+    Enumeration class listing all the SPI clock modes.
+    """
+    MODE_0 = (0, "Mode 0", "CPOL=0 CPHA=0, clock idle low, data captured on rising edge")
+    MODE_1 = (1, "Mode 1", "CPOL=0 CPHA=1, clock idle low, data captured on falling edge")
+    MODE_2 = (2, "Mode 2", "CPOL=1 CPHA=0, clock idle high, data captured on falling edge")
+    MODE_3 = (3, "Mode 3", "CPOL=1 CPHA=1, clock idle high, data captured on rising edge")
+
+    def __init__(self, code, title, description):
+        """
+        Class constructor. Instantiates a new `SPIClockMode` entry with the provided parameters.
+
+        Args:
+            code (Integer): SPI clock mode code.
+            title (String): SPI clock mode title.
+            description (String): SPI clock mode description.
+        """
+        super().__init__(code, title, description)
+
+
+class SPIChipSelect(_AbstractEnum):
+    """
+    Enumeration class listing all the SPI chip select configurations.
+    """
+    ACTIVE_LOW = (0, "Chip select active at low level")
+    ACTIVE_HIGH = (1, "Chip select active at high level")
+    NO_CONTROL = (2, "Chip select not controlled")
+
+    def __init__(self, code, description):
+        """
+        Class constructor. Instantiates a new `SPIChipSelect` entry with the provided parameters.
+
+        Args:
+            code (Integer): SPI chip select code.
+            description (String): SPI chip select description.
+        """
+        super().__init__(code, "", description)
+
+
+class SPIBitOrder(_AbstractEnum):
+    """
+    Enumeration class listing all the SPI bit orders.
+    """
+    MSB_FIRST = (0, "Most significant bit first")
+    LSB_FIRST = (1, "Less significant bit first")
+
+    def __init__(self, code, description):
+        """
+        Class constructor. Instantiates a new `SPIBitOrder` entry with the provided parameters.
+
+        Args:
+            code (Integer): SPI bit order code.
+            description (String): SPI bit order description.
+        """
+        super().__init__(code, "", description)
+
+
+class SPIBitsPerWord(_AbstractEnum):
+    """
+    Enumeration class listing all the SPI bits-per-word values.
+    """
+    BPW_8 = (0, "8 bits-per-word")
+    BPW_16 = (1, "16 bits-per-word")
+
+    def __init__(self, code, description):
+        """
+        Class constructor. Instantiates a new `SPIBitsPerWord` entry with the provided
+        parameters.
+
+        Args:
+            code (Integer): SPI bits-per-word code.
+            description (String): SPI bits-per-word description.
+        """
+        super().__init__(code, "", description)
+
+
+class _SPITransferCfgStruct(Structure):
+    """
+    Internal class to store C library SPI transfer mode struct data.
+    """
+    _fields_ = [('clk_mode', c_int),
+                ('chip_select', c_int),
+                ('bit_order', c_int)]
+
+
+class _SPISegmentStruct(Structure):
+    """
+    Internal class to store C library SPI segment struct data.
+    """
+    _fields_ = [('tx_data', POINTER(c_ubyte)),
+                ('rx_data', POINTER(c_ubyte)),
+                ('length', c_uint),
+                ('speed', c_uint),
+                ('bits_per_word', c_uint8),
+                ('delay_usecs', c_uint16),
+                ('cs_change', c_bool)]
+
+
+class _SPIStruct(Structure):
+    """
+    Internal class to store C library SPI struct data.
+    """
+    _fields_ = [('alias', c_char_p),
+                ('spi_device', c_uint),
+                ('spi_slave', c_uint),
+                ('data', c_void_p)]
+
+
+class SPISegment:
+    """
+    This class represents a segment of a SPI transaction. See 'SPI.transfer_batch()'.
+    """
+
+    def __init__(self, tx_data=None, rx_data=None, length=None, speed=0, bits_per_word=0,
+                 delay_usecs=0, cs_change=False):
+        """
+        Class constructor. Instantiates a new `SPISegment` with the provided parameters.
+
+        Both buffers can be any object supporting the buffer protocol (`bytearray`,
+        `memoryview`, `array.array`, numpy arrays...); they are used in place, without
+        copying them. The transmit data can also be `bytes` or a sequence of integers, which
+        are copied once.
+
+        Args:
+            tx_data (Object, optional): Data to write, `None` to send zeros.
+            rx_data (Object, optional): Writable buffer to store the read data into, `None`
+                                        to discard it.
+            length (Integer, optional): Number of bytes of the segment. By default, the
+                                        length of the given buffers.
+            speed (Integer, optional): Bus speed in Hz for this segment, 0 to use the speed
+                                       of the SPI.
+            bits_per_word (Integer, optional): Bits-per-word for this segment, 0 to use the
+                                               bits-per-word of the SPI.
+            delay_usecs (Integer, optional): Microseconds to wait after this segment.
+            cs_change (Boolean, optional): `True` to deselect the device after this segment.
+
+        Raises:
+            ValueError: if any buffer is not valid or its length does not match the length of
+                        the segment.
+        """
+        self._tx = None
+        self._rx = None
+        tx_len = rx_len = None
+
+        if tx_data is not None:
+            self._tx, tx_len = _buffer_from(tx_data)
+        if rx_data is not None:
+            self._rx, rx_len = _buffer_from(rx_data, writable=True)
+
+        if length is None:
+            length = tx_len if tx_len is not None else rx_len
+        if not isinstance(length, int) or length <= 0:
+            raise ValueError(_ERROR_LENGTH)
+        if (tx_len is not None and tx_len < length) or (rx_len is not None and rx_len < length):
+            raise ValueError(_ERROR_SEGMENT_LENGTH)
+
+        self.rx_data = rx_data
+        self.length = length
+        self.speed = speed
+        self.bits_per_word = bits_per_word
+        self.delay_usecs = delay_usecs
+        self.cs_change = cs_change
+
+    @classmethod
+    def read(cls, length, **kwargs):
+        """
+        Creates a segment that only reads data, in a new `bytearray` available in the
+        `rx_data` attribute of the segment after the transfer.
+
+        Args:
+            length (Integer): Number of bytes to read.
+            **kwargs: Other segment parameters, see the class constructor.
+
+        Returns:
+            :class:`.SPISegment`: The new segment.
+        """
+        if not isinstance(length, int) or length <= 0:
+            raise ValueError(_ERROR_LENGTH)
+        return cls(rx_data=bytearray(length), length=length, **kwargs)
+
+    def _fill(self, seg_struct):
+        """
+        Fills the given C library segment struct with the data of this segment.
+
+        Args:
+            seg_struct (:class:`._SPISegmentStruct`): The struct to fill.
+        """
+        seg_struct.tx_data = cast(self._tx, POINTER(c_ubyte)) if self._tx is not None else None
+        seg_struct.rx_data = cast(self._rx, POINTER(c_ubyte)) if self._rx is not None else None
+        seg_struct.length = self.length
+        seg_struct.speed = self.speed
+        seg_struct.bits_per_word = self.bits_per_word
+        seg_struct.delay_usecs = self.delay_usecs
+        seg_struct.cs_change = self.cs_change
+
+
+class SPI:
+    """
+    This class represents a SPI slave. Instances of SPI should be created using the
+    'SPI.create_from_<x>' family of functions.
+    """
+
+    def __init__(self, spi_struct):
+        """
+        Class constructor. This method should not be called directly, instead use the
+        'SPI.create_from_<x>' family of functions.
+        """
+        self._spi_struct = spi_struct
+        self._segs = None
+
+    def __del__(self):
+        """
+        Executed when garbage collector collects this item.
+        """
+        # Free SPI struct.
+        _libdigiapix.ldx_spi_free(self._spi_struct)
+
+    @classmethod
+    def create(cls, device, slave):
+        """
+        Requests a new SPI using the given device and slave indexes.
+
+        Args:
+            device (Integer): The SPI device index to use.
+            slave (Integer): The SPI slave index to use.
+
+        Returns:
+            :class:`.SPI`: The instantiated SPI.
+
+        Raises:
+            ValueError: if `device` or `slave` are not positive integers.
+            DigiAPIXException: if there is any error loading the library.
+            SPIException: if there is any error creating the SPI.
+        """
+        # Sanity checks.
+        if not isinstance(device, int) or device < 0:
+            raise ValueError(_ERROR_DEVICE)
+        if not isinstance(slave, int) or slave < 0:
+            raise ValueError(_ERROR_SLAVE)
+        _check_library()
+
+        spi_struct = _libdigiapix.ldx_spi_request(device, slave)
+        if not spi_struct:
+            raise SPIException("Error creating SPI")
+        return cls(spi_struct)
+
+    @classmethod
+    def create_from_alias(cls, alias):
+        """
+        Requests a new SPI using the given alias.
+
+        Args:
+            alias (String): The alias name of the SPI to request.
+
+        Returns:
+            :class:`.SPI`: The instantiated SPI.
+
+        Raises:
+            ValueError: if `alias` is not a valid string.
+            DigiAPIXException: if there is any error loading the library.
+            SPIException: if there is any error creating the SPI.
+        """
+        # Sanity checks.
+        if not isinstance(alias, str):
+            raise ValueError(_ERROR_ALIAS)
+        _check_library()
+
+        spi_struct = _libdigiapix.ldx_spi_request_by_alias(
+            alias.encode(encoding="ascii", errors="ignore"))
+        if not spi_struct:
+            raise SPIException("Error creating SPI")
+        return cls(spi_struct)
+
+    @property
+    def alias(self):
+        """
+        Returns the SPI alias.
+
+        Returns:
+            String: SPI alias.
+        """
+        alias = self._spi_struct.contents.alias
+        return alias.decode(encoding="ascii", errors="ignore") if alias else None
+
+    @property
+    def device(self):
+        """
+        Returns the SPI device index.
+
+        Returns:
+            Integer: SPI device index.
+        """
+        return self._spi_struct.contents.spi_device
+
+    @property
+    def slave(self):
+        """
+        Returns the SPI slave index.
+
+        Returns:
+            Integer: SPI slave index.
+        """
+        return self._spi_struct.contents.spi_slave
+
+    def set_transfer_mode(self, clk_mode, chip_select, bit_order):
+        """
+        Changes the SPI transfer mode.
+
+        Args:
+            clk_mode (:class:`.SPIClockMode`): The SPI clock mode.
+            chip_select (:class:`.SPIChipSelect`): The chip select configuration.
+            bit_order (:class:`.SPIBitOrder`): The bit order.
+
+        Raises:
+            ValueError: if any parameter is not a valid entry of its enumeration.
+            SPIException: if there is any error setting the transfer mode.
+        """
+        # Sanity checks.
+        if not isinstance(clk_mode, SPIClockMode):
+            raise ValueError(_ERROR_CLK_MODE)
+        if not isinstance(chip_select, SPIChipSelect):
+            raise ValueError(_ERROR_CHIP_SELECT)
+        if not isinstance(bit_order, SPIBitOrder):
+            raise ValueError(_ERROR_BIT_ORDER)
+
+        cfg = _SPITransferCfgStruct(clk_mode.code, chip_select.code, bit_order.code)
+        if _libdigiapix.ldx_spi_set_transfer_mode(self._spi_struct, byref(cfg)) != 0:
+            raise SPIException("Error setting SPI transfer mode")
+
+    def get_transfer_mode(self):
+        """
+        Gets the SPI transfer mode.
+
+        Returns:
+            Tuple (:class:`.SPIClockMode`, :class:`.SPIChipSelect`, :class:`.SPIBitOrder`):
+                The SPI clock mode, chip select configuration and bit order.
+
+        Raises:
+            SPIException: if there is any error reading the transfer mode.
+        """
+        cfg = _SPITransferCfgStruct()
+        if _libdigiapix.ldx_spi_get_transfer_mode(self._spi_struct, byref(cfg)) != 0:
+            raise SPIException("Error reading SPI transfer mode")
+        return (SPIClockMode.get(cfg.clk_mode), SPIChipSelect.get(cfg.chip_select),
+                SPIBitOrder.get(cfg.bit_order))
+
+    def set_bits_per_word(self, bits_per_word):
+        """
+        Changes the SPI bits-per-word.
+
+        Args:
+            bits_per_word (:class:`.SPIBitsPerWord`): The new bits-per-word.
+
+        Raises:
+            ValueError: if `bits_per_word` is not a valid :class:`.SPIBitsPerWord`.
+            SPIException: if there is any error setting the bits-per-word.
+        """
+        # Sanity checks.
+        if not isinstance(bits_per_word, SPIBitsPerWord):
+            raise ValueError(_ERROR_BPW)
+
+        if _libdigiapix.ldx_spi_set_bits_per_word(self._spi_struct, bits_per_word.code) != 0:
+            raise SPIException("Error setting SPI bits-per-word")
+
+    def get_bits_per_word(self):
+        """
+        Gets the SPI bits-per-word.
+
+        Returns:
+            :class:`.SPIBitsPerWord`: The configured bits-per-word.
+
+        Raises:
+            SPIException: if there is any error reading the bits-per-word.
+        """
+        bits_per_word = SPIBitsPerWord.get(_libdigiapix.ldx_spi_get_bits_per_word(
+            self._spi_struct))
+        if not bits_per_word:
+            raise SPIException("Error reading SPI bits-per-word")
+        return bits_per_word
+
+    def set_speed(self, speed):
+        """
+        Changes the SPI bus max speed.
+
+        Args:
+            speed (Integer): The new speed in Hz.
+
+        Raises:
+            ValueError: if `speed` is not a positive integer.
+            SPIException: if there is any error setting the speed.
+        """
+        # Sanity checks.
+        if not isinstance(speed, int) or speed <= 0:
+            raise ValueError(_ERROR_SPEED)
+
+        if _libdigiapix.ldx_spi_set_speed(self._spi_struct, speed) != 0:
+            raise SPIException("Error setting SPI speed")
+
+    def get_speed(self):
+        """
+        Gets the SPI bus max speed.
+
+        Returns:
+            Integer: The configured max speed in Hz.
+
+        Raises:
+            SPIException: if there is any error reading the speed.
+        """
+        speed = _libdigiapix.ldx_spi_get_speed(self._spi_struct)
+        if speed < 0:
+            raise SPIException("Error reading SPI speed")
+        return speed
+
+    def set_priority(self, priority):
+        """
+        Sets the priority class of the transactions of the SPI.
+
+        Args:
+            priority (:class:`.BusPriority`): The priority class.
+
+        Raises:
+            ValueError: if `priority` is not a valid :class:`.BusPriority`.
+            SPIException: if there is any error setting the priority.
+        """
+        # Sanity checks.
+        if not isinstance(priority, BusPriority):
+            raise ValueError(_ERROR_PRIORITY)
+
+        if _libdigiapix.ldx_spi_set_priority(self._spi_struct, priority.code) != 0:
+            raise SPIException("Error setting SPI priority")
+
+    def write(self, data):
+        """
+        Writes data to the SPI bus.
+
+        Args:
+            data (Object): The data to write, any object supporting the buffer protocol or a
+                           sequence of integers.
+
+        Raises:
+            ValueError: if `data` is not valid.
+            SPIException: if there is any error writing the data.
+        """
+        buf, length = _buffer_from(data)
+        if not length:
+            return
+
+        if _libdigiapix.ldx_spi_write(self._spi_struct, buf, length) != 0:
+            raise SPIException("Error writing SPI data")
+
+    def read(self, length):
+        """
+        Reads data from the SPI bus.
+
+        Args:
+            length (Integer): Number of bytes to read.
+
+        Returns:
+            Bytearray: The read data.
+
+        Raises:
+            ValueError: if `length` is not a positive integer.
+            SPIException: if there is any error reading the data.
+        """
+        # Sanity checks.
+        if not isinstance(length, int) or length <= 0:
+            raise ValueError(_ERROR_LENGTH)
+
+        data = bytearray(length)
+        self.read_into(data)
+        return data
+
+    def read_into(self, buffer):
+        """
+        Reads data from the SPI bus into the given buffer, filling it completely.
+
+        Args:
+            buffer (Object): Writable object supporting the buffer protocol.
+
+        Raises:
+            ValueError: if `buffer` is not a writable buffer.
+            SPIException: if there is any error reading the data.
+        """
+        buf, length = _buffer_from(buffer, writable=True)
+        if not length:
+            return
+
+        if _libdigiapix.ldx_spi_read(self._spi_struct, buf, length) != 0:
+            raise SPIException("Error reading SPI data")
+
+    def transfer(self, data):
+        """
+        Writes and reads data from the SPI bus simultaneously.
+
+        Args:
+            data (Object): The data to write, any object supporting the buffer protocol or a
+                           sequence of integers.
+
+        Returns:
+            Bytearray: The read data, with the same length as `data`.
+
+        Raises:
+            ValueError: if `data` is not valid.
+            SPIException: if there is any error transferring the data.
+        """
+        tx_buf, length = _buffer_from(data)
+        rx_data = bytearray(length)
+        if not length:
+            return rx_data
+
+        rx_buf, _length = _buffer_from(rx_data, writable=True)
+        if _libdigiapix.ldx_spi_transfer(self._spi_struct, tx_buf, rx_buf, length) != 0:
+            raise SPIException("Error transferring SPI data")
+        return rx_data
+
+    def transfer_batch(self, segments):
+        """
+        Runs several segments as one SPI transaction, with a single call to the C library.
+
+        The device stays selected between the segments unless their `cs_change` attribute is
+        set. The read data is stored in place in the `rx_data` buffer of each segment.
+
+        Args:
+            segments (List): List of :class:`.SPISegment`, in transfer order.
+
+        Raises:
+            ValueError: if `segments` is not a list of :class:`.SPISegment` or it has more
+                        than `MAX_SEGMENTS` entries.
+            SPIException: if there is any error transferring the data.
+        """
+        # Sanity checks.
+        if not 0 < len(segments) <= MAX_SEGMENTS:
+            raise ValueError(_ERROR_SEGMENTS_MAX)
+        if not all(isinstance(seg, SPISegment) for seg in segments):
+            raise ValueError(_ERROR_SEGMENT)
+
+        # Reuse the segments array between calls.
+        if self._segs is None or len(self._segs) < len(segments):
+            self._segs = (_SPISegmentStruct * len(segments))()
+        for seg, seg_struct in zip(segments, self._segs):
+            seg._fill(seg_struct)
+
+        if _libdigiapix.ldx_spi_transfer_batch(self._spi_struct, self._segs,
+                                               len(segments)) != 0:
+            raise SPIException("Error transferring SPI segments")
+
+
+def _check_library():
+    """
+    Verifies that the 'digiapix' library is loaded.
+
+    Raises:
+        DigiAPIXException: if there is any error loading the library.
+    """
+    # Use global variable.
+    global _libdigiapix
+    # Load the library.
+    if _libdigiapix is None:
+        _libdigiapix = library.get_library()
+        # Configure the CTypes of the SPI methods to use.
+        _configure_spi_ctypes()
+
+
+def _configure_spi_ctypes():
+    """
+    Configures the ctypes for the library SPI methods
+    """
+    # Request SPI.
+    _libdigiapix.ldx_spi_request.argtypes = [c_uint, c_uint]
+    _libdigiapix.ldx_spi_request.restype = POINTER(_SPIStruct)
+    # Request by alias.
+    _libdigiapix.ldx_spi_request_by_alias.argtypes = [c_char_p]
+    _libdigiapix.ldx_spi_request_by_alias.restype = POINTER(_SPIStruct)
+    # Free SPI.
+    _libdigiapix.ldx_spi_free.argtypes = [POINTER(_SPIStruct)]
+    _libdigiapix.ldx_spi_free.restype = c_int
+    # Set transfer mode.
+    _libdigiapix.ldx_spi_set_transfer_mode.argtypes = [POINTER(_SPIStruct),
+                                                       POINTER(_SPITransferCfgStruct)]
+    _libdigiapix.ldx_spi_set_transfer_mode.restype = c_int
+    # Get transfer mode.
+    _libdigiapix.ldx_spi_get_transfer_mode.argtypes = [POINTER(_SPIStruct),
+                                                       POINTER(_SPITransferCfgStruct)]
+    _libdigiapix.ldx_spi_get_transfer_mode.restype = c_int
+    # Set bits-per-word.
+    _libdigiapix.ldx_spi_set_bits_per_word.argtypes = [POINTER(_SPIStruct), c_int]
+    _libdigiapix.ldx_spi_set_bits_per_word.restype = c_int
+    # Get bits-per-word.
+    _libdigiapix.ldx_spi_get_bits_per_word.argtypes = [POINTER(_SPIStruct)]
+    _libdigiapix.ldx_spi_get_bits_per_word.restype = c_int
+    # Set speed.
+    _libdigiapix.ldx_spi_set_speed.argtypes = [POINTER(_SPIStruct), c_uint]
+    _libdigiapix.ldx_spi_set_speed.restype = c_int
+    # Get speed.
+    _libdigiapix.ldx_spi_get_speed.argtypes = [POINTER(_SPIStruct)]
+    _libdigiapix.ldx_spi_get_speed.restype = c_int
+    # Set priority.
+    _libdigiapix.ldx_spi_set_priority.argtypes = [POINTER(_SPIStruct), c_int]
+    _libdigiapix.ldx_spi_set_priority.restype = c_int
+    # Write.
+    _libdigiapix.ldx_spi_write.argtypes = [POINTER(_SPIStruct), POINTER(c_ubyte), c_uint]
+    _libdigiapix.ldx_spi_write.restype = c_int
+    # Read.
+    _libdigiapix.ldx_spi_read.argtypes = [POINTER(_SPIStruct), POINTER(c_ubyte), c_uint]
+    _libdigiapix.ldx_spi_read.restype = c_int
+    # Transfer.
+    _libdigiapix.ldx_spi_transfer.argtypes = [POINTER(_SPIStruct), POINTER(c_ubyte),
+                                              POINTER(c_ubyte), c_uint]
+    _libdigiapix.ldx_spi_transfer.restype = c_int
+    # Transfer batch.
+    _libdigiapix.ldx_spi_transfer_batch.argtypes = [POINTER(_SPIStruct),
+                                                    POINTER(_SPISegmentStruct), c_uint]
+    _libdigiapix.ldx_spi_transfer_batch.restype = c_int
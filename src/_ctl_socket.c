@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "_common.h"
+#include "_ctl_socket.h"
+#include "_log.h"
+
+/* Defined in <bluetooth/bluetooth.h>, not available without Bluetooth support */
+#ifndef BTPROTO_HCI
+#define BTPROTO_HCI	1
+#endif
+
+static void __attribute__ ((destructor)) ctl_socket_fini(void);
+
+static const struct {
+	int domain;
+	int type;
+	int protocol;
+} ctl_socket_args[] = {
+	[CTL_SOCKET_INET] = { AF_INET, SOCK_DGRAM, 0 },
+	[CTL_SOCKET_HCI] = { AF_BLUETOOTH, SOCK_RAW, BTPROTO_HCI },
+};
+
+static int ctl_sockets[__CTL_SOCKET_LAST] = { [0 ... __CTL_SOCKET_LAST - 1] = -1 };
+static pthread_mutex_t ctl_sockets_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int ctl_socket_get(ctl_socket_type_t type)
+{
+	int sock;
+
+	if (type < 0 || type >= __CTL_SOCKET_LAST) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	sock = __atomic_load_n(&ctl_sockets[type], __ATOMIC_ACQUIRE);
+	if (sock >= 0)
+		return sock;
+
+	pthread_mutex_lock(&ctl_sockets_lock);
+
+	sock = ctl_sockets[type];
+	if (sock < 0) {
+		sock = socket(ctl_socket_args[type].domain,
+			      ctl_socket_args[type].type | SOCK_CLOEXEC,
+			      ctl_socket_args[type].protocol);
+		if (sock >= 0) {
+			__atomic_store_n(&ctl_sockets[type], sock, __ATOMIC_RELEASE);
+		} else {
+			int err = errno;
+
+			log_debug("%s: Unable to open control socket: %s (%d)",
+				  __func__, strerror(err), err);
+			errno = err;
+		}
+	}
+
+	pthread_mutex_unlock(&ctl_sockets_lock);
+
+	return sock;
+}
+
+/**
+ * ctl_socket_fini() - Close the cached control sockets
+ *
+ * Executed when the library is unloaded.
+ */
+static void ctl_socket_fini(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ctl_sockets); i++) {
+		if (ctl_sockets[i] >= 0)
+			close(ctl_sockets[i]);
+		ctl_sockets[i] = -1;
+	}
+}
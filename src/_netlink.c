@@ -0,0 +1,347 @@
+/*
+ * Copyright 2022, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "_log.h"
+#include "_netlink.h"
+
+int nl_open(nl_sock_t *nl, int protocol, uint32_t groups)
+{
+	struct sockaddr_nl addr;
+	socklen_t len = sizeof(addr);
+
+	memset(nl, 0, sizeof(*nl));
+
+	nl->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, protocol);
+	if (nl->fd < 0) {
+		log_debug("%s: Unable to open netlink socket: %s (%d)", __func__,
+			  strerror(errno), errno);
+		return EXIT_FAILURE;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = groups;
+	if (bind(nl->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+	    || getsockname(nl->fd, (struct sockaddr *)&addr, &len) < 0) {
+		log_debug("%s: Unable to bind netlink socket: %s (%d)", __func__,
+			  strerror(errno), errno);
+		goto error;
+	}
+
+	nl->buf = malloc(NL_BUF_LEN);
+	if (nl->buf == NULL) {
+		log_debug("%s: Unable to open netlink socket: Out of memory",
+			  __func__);
+		goto error;
+	}
+
+	nl->pid = addr.nl_pid;
+	nl->seq = time(NULL);
+
+	return EXIT_SUCCESS;
+
+error:
+	close(nl->fd);
+	nl->fd = -1;
+
+	return EXIT_FAILURE;
+}
+
+void nl_close(nl_sock_t *nl)
+{
+	if (nl->fd >= 0)
+		close(nl->fd);
+	nl->fd = -1;
+	free(nl->buf);
+	nl->buf = NULL;
+}
+
+int nl_request(nl_sock_t *nl, struct nlmsghdr *req, nl_msg_cb_t cb, void *arg)
+{
+	struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+	struct iovec iov = { .iov_base = nl->buf, .iov_len = NL_BUF_LEN };
+	struct msghdr msg = {
+		.msg_name = &kernel,
+		.msg_namelen = sizeof(kernel),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	bool stop = false;
+	int error = 0;
+
+	req->nlmsg_seq = ++nl->seq;
+	req->nlmsg_pid = 0;
+
+	while (sendto(nl->fd, req, req->nlmsg_len, 0, (struct sockaddr *)&kernel,
+		      sizeof(kernel)) < 0) {
+		if (errno != EINTR)
+			return EXIT_FAILURE;
+	}
+
+	for (;;) {
+		struct nlmsghdr *nlh;
+		ssize_t len;
+
+		len = recvmsg(nl->fd, &msg, 0);
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			return EXIT_FAILURE;
+		}
+
+		if (msg.msg_flags & MSG_TRUNC) {
+			errno = ENOBUFS;
+			return EXIT_FAILURE;
+		}
+
+		for (nlh = (struct nlmsghdr *)nl->buf; NLMSG_OK(nlh, len);
+		     nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_seq != nl->seq || nlh->nlmsg_pid != nl->pid)
+				continue;
+
+			if (nlh->nlmsg_type == NLMSG_DONE)
+				goto done;
+
+			if (nlh->nlmsg_type == NLMSG_ERROR) {
+				struct nlmsgerr *err = NLMSG_DATA(nlh);
+
+				error = err->error;
+				goto done;
+			}
+
+			if (!stop && cb != NULL && cb(nlh, arg) != 0)
+				stop = true;
+
+			/* A reply that is not a dump has a single message */
+			if (!(nlh->nlmsg_flags & NLM_F_MULTI))
+				goto done;
+		}
+	}
+
+done:
+	if (error < 0) {
+		errno = -error;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int nl_recv(nl_sock_t *nl, nl_msg_cb_t cb, void *arg)
+{
+	for (;;) {
+		struct nlmsghdr *nlh;
+		ssize_t len;
+
+		len = recv(nl->fd, nl->buf, NL_BUF_LEN, MSG_DONTWAIT);
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return EXIT_SUCCESS;
+			return EXIT_FAILURE;
+		}
+
+		for (nlh = (struct nlmsghdr *)nl->buf; NLMSG_OK(nlh, len);
+		     nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_type == NLMSG_DONE
+			    || nlh->nlmsg_type == NLMSG_ERROR)
+				continue;
+			cb(nlh, arg);
+		}
+	}
+}
+
+int nl_dump(nl_sock_t *nl, uint16_t type, unsigned char family,
+	    nl_msg_cb_t cb, void *arg)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct rtgenmsg gen;
+	} req;
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.gen));
+	req.nlh.nlmsg_type = type;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.gen.rtgen_family = family;
+
+	return nl_request(nl, &req.nlh, cb, arg);
+}
+
+void nl_parse_attrs(struct rtattr **tb, int max, struct rtattr *rta, int len)
+{
+	memset(tb, 0, sizeof(*tb) * (max + 1));
+
+	for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+		unsigned short type = rta->rta_type & ~NLA_F_NESTED;
+
+		if (type <= max && tb[type] == NULL)
+			tb[type] = rta;
+	}
+}
+
+int nl_add_attr(struct nlmsghdr *nlh, size_t maxlen, uint16_t type,
+		const void *data, size_t len)
+{
+	struct rtattr *rta;
+
+	if (NLMSG_ALIGN(nlh->nlmsg_len) + RTA_SPACE(len) > maxlen) {
+		errno = ENOBUFS;
+		return EXIT_FAILURE;
+	}
+
+	rta = (struct rtattr *)((char *)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+	rta->rta_type = type;
+	rta->rta_len = RTA_LENGTH(len);
+	if (len > 0)
+		memcpy(RTA_DATA(rta), data, len);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_SPACE(len);
+
+	return EXIT_SUCCESS;
+}
+
+int nl_join_group(nl_sock_t *nl, uint32_t group)
+{
+	if (setsockopt(nl->fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group,
+		       sizeof(group)) < 0)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * genl_query_t - Data of a generic netlink family query
+ *
+ * @group:	Name of the multicast group to look for, NULL for none.
+ * @id:		Identifier of the family or the group, -1 if not found.
+ */
+typedef struct {
+	const char *group;
+	int id;
+} genl_query_t;
+
+/*
+ * genl_family_cb() - Get an identifier from a generic netlink family reply
+ *
+ * @nlh:	The CTRL_CMD_NEWFAMILY message.
+ * @arg:	The genl_query_t to fill.
+ *
+ * Return: 0 always.
+ */
+static int genl_family_cb(struct nlmsghdr *nlh, void *arg)
+{
+	struct rtattr *tb[CTRL_ATTR_MAX + 1];
+	genl_query_t *query = arg;
+	struct rtattr *grp;
+	int len;
+
+	nl_parse_attrs(tb, CTRL_ATTR_MAX, GENL_ATTRS(nlh), GENL_ATTRS_LEN(nlh));
+
+	if (query->group == NULL) {
+		if (tb[CTRL_ATTR_FAMILY_ID] != NULL)
+			query->id = *(uint16_t *)RTA_DATA(tb[CTRL_ATTR_FAMILY_ID]);
+		return 0;
+	}
+
+	if (tb[CTRL_ATTR_MCAST_GROUPS] == NULL)
+		return 0;
+
+	grp = RTA_DATA(tb[CTRL_ATTR_MCAST_GROUPS]);
+	len = RTA_PAYLOAD(tb[CTRL_ATTR_MCAST_GROUPS]);
+	for (; RTA_OK(grp, len); grp = RTA_NEXT(grp, len)) {
+		struct rtattr *gtb[CTRL_ATTR_MCAST_GRP_MAX + 1];
+
+		nl_parse_attrs(gtb, CTRL_ATTR_MCAST_GRP_MAX, RTA_DATA(grp),
+			       RTA_PAYLOAD(grp));
+		if (gtb[CTRL_ATTR_MCAST_GRP_NAME] == NULL
+		    || gtb[CTRL_ATTR_MCAST_GRP_ID] == NULL)
+			continue;
+
+		if (strcmp(RTA_DATA(gtb[CTRL_ATTR_MCAST_GRP_NAME]), query->group) == 0) {
+			query->id = *(uint32_t *)RTA_DATA(gtb[CTRL_ATTR_MCAST_GRP_ID]);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * genl_query() - Query the controller for a generic netlink family
+ *
+ * @nl:		An open NETLINK_GENERIC socket.
+ * @name:	Name of the family.
+ * @query:	The query to fill.
+ *
+ * Return: EXIT_SUCCESS if the requested identifier was found, EXIT_FAILURE
+ *	   otherwise with errno set.
+ */
+static int genl_query(nl_sock_t *nl, const char *name, genl_query_t *query)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct genlmsghdr genl;
+		char attrs[RTA_SPACE(GENL_NAMSIZ)];
+	} req;
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+	req.nlh.nlmsg_type = GENL_ID_CTRL;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST;
+	req.genl.cmd = CTRL_CMD_GETFAMILY;
+	req.genl.version = 1;
+
+	if (nl_add_attr(&req.nlh, sizeof(req), CTRL_ATTR_FAMILY_NAME, name,
+			strnlen(name, GENL_NAMSIZ - 1) + 1) != EXIT_SUCCESS
+	    || nl_request(nl, &req.nlh, genl_family_cb, query) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (query->id < 0) {
+		errno = ENOENT;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int nl_genl_family(nl_sock_t *nl, const char *name)
+{
+	genl_query_t query = { .group = NULL, .id = -1 };
+
+	if (genl_query(nl, name, &query) != EXIT_SUCCESS)
+		return -1;
+
+	return query.id;
+}
+
+int nl_genl_group(nl_sock_t *nl, const char *name, const char *group)
+{
+	genl_query_t query = { .group = group, .id = -1 };
+
+	if (genl_query(nl, name, &query) != EXIT_SUCCESS)
+		return -1;
+
+	return query.id;
+}
@@ -22,7 +22,6 @@
 #include "_network.h"
 #include "process.h"
 
-#define CMD_CONN_EXISTS		"nmcli connection show %s >/dev/null 2>&1"
 #define CMD_ENABLE		"nmcli device %s %s"
 #define CMD_CONN_ADD		"nmcli connection add type %s connection.id %s connection.interface-name %s"
 #define CMD_CONN_MOD		"nmcli connection modify %s"
@@ -31,7 +30,22 @@
 #define CMD_CONN_GATEWAY	" ipv4.gateway %d.%d.%d.%d"
 #define CMD_CONN_ADD_DNS	" +ipv4.dns %d.%d.%d.%d"
 #define CMD_CONN_DEL_DNS	" -ipv4.dns %d.%d.%d.%d"
-#define CMD_GET_NM_NAME 	"o=\"$(nmcli -m tab -t -f GENERAL.IP-IFACE,GENERAL.%s device show)\" && { echo \"${o}\" | awk NF=NF RS='' FS='\n' OFS=':' ORS='\n' | grep ^%s | cut -d':' -f2; }"
+#define NM_NAME_FIELDS		"GENERAL.IP-IFACE,GENERAL.%s"
+
+/*
+ * nm_name_query_t - Search of the network manager name of an interface
+ *
+ * @iface_name:	Network interface name.
+ * @line:	Line of the current device block of the nmcli output.
+ * @match:	True if the current device block is the interface one.
+ * @name:	The name found, NULL if not found yet.
+ */
+typedef struct {
+	const char *iface_name;
+	int line;
+	bool match;
+	char *name;
+} nm_name_query_t;
 
 /*
  * is_valid_netmask() - Check if provided network mask is valid
@@ -87,24 +101,50 @@ static int get_cidr(uint8_t netmask[IPV4_GROUPS])
  */
 static bool check_conn_exists(const char *iface_name)
 {
-	bool exists = false;
-	char *cmd = NULL, *resp = NULL;
-	int rc, len = snprintf(NULL, 0, CMD_CONN_EXISTS, iface_name);
+	char *argv[] = { "nmcli", "connection", "show", (char *)iface_name, NULL };
+	int rc;
 
-	cmd = calloc(len + 1, sizeof(*cmd));
-	if (cmd == NULL)
-		return false;
-	sprintf(cmd, CMD_CONN_EXISTS, iface_name);
+	rc = ldx_process_spawn(argv, NULL, NULL, 0, 1);
+	if (rc < -255)
+		log_debug("%s: Unable to execute 'nmcli'", __func__);
 
-	rc = ldx_process_execute_cmd(cmd, &resp, 1);
-	exists = (rc == 0);
-	if (rc == 127) /* Command not found */
-		log_debug("%s: 'nmcli' not found", __func__);
+	return rc == 0;
+}
 
-	free(cmd);
-	free(resp);
+/*
+ * nm_name_cb() - Parse a line of the nmcli output of 'device show'
+ *
+ * @line:	The line.
+ * @len:	Length of the line.
+ * @arg:	The nm_name_query_t search.
+ *
+ * With '-m tab -t', each device is a block with one field per line (the
+ * interface name first) and blocks are separated by empty lines.
+ *
+ * Return: 0 to keep reading.
+ */
+static int nm_name_cb(const char *line, size_t len, void *arg)
+{
+	nm_name_query_t *query = arg;
+
+	if (len == 0) {
+		query->line = 0;
+		return 0;
+	}
 
-	return exists;
+	switch (query->line++) {
+	case 0:
+		query->match = strcmp(line, query->iface_name) == 0;
+		break;
+	case 1:
+		if (query->match && query->name == NULL)
+			query->name = strdup(line);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
 }
 
 /*
@@ -120,53 +160,39 @@ static bool check_conn_exists(const char *iface_name)
  */
 static int _get_nm_name(const char *iface_name, const char *type, char **name)
 {
-	int len, ret = 1;
-	char *cmd = NULL, *resp = NULL;
+	char fields[sizeof(NM_NAME_FIELDS) + 16];
+	char *argv[] = { "nmcli", "-m", "tab", "-t", "-f", fields, "device", "show", NULL };
+	nm_name_query_t query = {
+		.iface_name = iface_name,
+		.line = 0,
+		.match = false,
+		.name = NULL,
+	};
+	int rc;
 
 	*name = NULL;
 
-	len = snprintf(NULL, 0, CMD_GET_NM_NAME, type, iface_name);
-	cmd = calloc(len + 1, sizeof(*cmd));
-	if (cmd == NULL) {
-		log_debug("%s: Unable to get '%s' nmcli %s name: Out of memory",
-			  __func__, iface_name, type);
-		return ret;
-	}
+	snprintf(fields, sizeof(fields), NM_NAME_FIELDS, type);
 
-	sprintf(cmd, CMD_GET_NM_NAME, type, iface_name);
-	len = ldx_process_execute_cmd(cmd, &resp, 2);
-	if (len != 0 || resp == NULL) {
-		if (len == 127) /* Command not found */
-			log_debug("%s: 'nmcli' not found", __func__);
-		else if (resp != NULL)
-			log_debug("%s: Unable to get '%s' nmcli %s name: %s",
-				  __func__, iface_name, type, resp);
+	rc = ldx_process_spawn(argv, nm_name_cb, &query, LDX_PROCESS_LINES, 2);
+	if (rc != 0) {
+		if (rc < -255)
+			log_debug("%s: Unable to execute 'nmcli'", __func__);
 		else
-			log_debug("%s: Unable to get '%s' nmcli %s name",
-				  __func__, iface_name, type);
-		goto done;
+			log_debug("%s: Unable to get '%s' nmcli %s name (%d)",
+				  __func__, iface_name, type, rc);
+		free(query.name);
+		return 1;
 	}
 
-	resp[strlen(resp) - 1] = '\0';  /* Remove the last line feed */
-
-	if (strlen(resp) == 0)
-		goto done;
-
-	*name = calloc(strlen(resp) + 1, sizeof(**name));
-	if (*name == NULL) {
-		log_debug("%s: Unable to get '%s' nmcli %s name: Out of memory",
-			  __func__, iface_name, type);
-		goto done;
+	if (query.name == NULL || strlen(query.name) == 0) {
+		free(query.name);
+		return 1;
 	}
 
-	strcpy(*name, resp);
-	ret = 0;
+	*name = query.name;
 
-done:
-	free(cmd);
-	free(resp);
-
-	return ret;
+	return 0;
 }
 
 bool _is_valid_ip(uint8_t ip[IPV4_GROUPS])
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "_common.h"
+#include "_log.h"
+#include "_nl80211.h"
+
+static void __attribute__ ((destructor)) nl80211_fini(void);
+
+/**
+ * nl80211_t - Shared nl80211 socket
+ *
+ * @lock:	Serializes the requests.
+ * @nl:		Generic netlink socket, closed while 'fd' is -1.
+ * @family:	nl80211 family identifier.
+ * @pid:	Process that opened the socket. A child process created with
+ *		fork() must not share it, as replies would go to either one.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	nl_sock_t nl;
+	int family;
+	pid_t pid;
+} nl80211_t;
+
+/**
+ * nl80211_events_t - Receiver of the nl80211 notifications
+ *
+ * @lock:	Protects the start of the receiver.
+ * @nl:		Socket subscribed to the multicast groups.
+ * @stop_fd:	Event to stop the thread.
+ * @thread:	Thread that receives the notifications.
+ * @running:	True while the thread runs.
+ * @pid:	Process that started the thread.
+ * @cb:		Function to call for each notification.
+ * @arg:	Argument to pass to the callback.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	nl_sock_t nl;
+	int stop_fd;
+	pthread_t thread;
+	bool running;
+	pid_t pid;
+	nl_msg_cb_t cb;
+	void *arg;
+} nl80211_events_t;
+
+static nl80211_t nl80211 = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.nl = { .fd = -1 },
+	.family = -1,
+};
+
+static nl80211_events_t events = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.nl = { .fd = -1 },
+	.stop_fd = -1,
+};
+
+static const char *nl80211_groups[] = {
+	NL80211_MULTICAST_GROUP_CONFIG,
+	NL80211_MULTICAST_GROUP_SCAN,
+	NL80211_MULTICAST_GROUP_REG,
+	NL80211_MULTICAST_GROUP_MLME,
+};
+
+/**
+ * nl80211_open() - Open the shared socket if needed
+ *
+ * Must be called with the lock held.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+static int nl80211_open(void)
+{
+	int err;
+
+	if (nl80211.nl.fd >= 0) {
+		if (nl80211.pid == getpid())
+			return EXIT_SUCCESS;
+		nl_close(&nl80211.nl);
+	}
+
+	if (nl_open(&nl80211.nl, NETLINK_GENERIC, 0) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	nl80211.family = nl_genl_family(&nl80211.nl, NL80211_GENL_NAME);
+	if (nl80211.family < 0) {
+		err = errno;
+		log_debug("%s: Unable to resolve the nl80211 family: %s (%d)",
+			  __func__, strerror(err), err);
+		nl_close(&nl80211.nl);
+		errno = err;
+		return EXIT_FAILURE;
+	}
+
+	nl80211.pid = getpid();
+
+	return EXIT_SUCCESS;
+}
+
+int nl80211_request(uint8_t cmd, uint16_t flags, uint32_t ifindex,
+		    nl_msg_cb_t cb, void *arg)
+{
+	return nl80211_request_attrs(cmd, flags, ifindex, NULL, 0, cb, arg);
+}
+
+int nl80211_request_attrs(uint8_t cmd, uint16_t flags, uint32_t ifindex,
+			  const void *attrs, size_t len, nl_msg_cb_t cb, void *arg)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct genlmsghdr genl;
+		char attrs[RTA_SPACE(sizeof(uint32_t)) + NL80211_ATTRS_LEN];
+	} req;
+	int ret, err;
+
+	if (len > NL80211_ATTRS_LEN) {
+		errno = EINVAL;
+		return EXIT_FAILURE;
+	}
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+	req.nlh.nlmsg_flags = NLM_F_REQUEST | flags;
+	req.genl.cmd = cmd;
+	req.genl.version = 0;
+
+	if (ifindex > 0)
+		nl_add_attr(&req.nlh, sizeof(req), NL80211_ATTR_IFINDEX,
+			    &ifindex, sizeof(ifindex));
+
+	if (len > 0) {
+		memcpy((char *)&req + NLMSG_ALIGN(req.nlh.nlmsg_len), attrs, len);
+		req.nlh.nlmsg_len = NLMSG_ALIGN(req.nlh.nlmsg_len) + NLMSG_ALIGN(len);
+	}
+
+	pthread_mutex_lock(&nl80211.lock);
+
+	ret = nl80211_open();
+	if (ret == EXIT_SUCCESS) {
+		req.nlh.nlmsg_type = nl80211.family;
+		ret = nl_request(&nl80211.nl, &req.nlh, cb, arg);
+	}
+	err = errno;
+
+	pthread_mutex_unlock(&nl80211.lock);
+
+	errno = err;
+
+	return ret;
+}
+
+/**
+ * events_thread() - Receive the nl80211 notifications
+ *
+ * @arg:	Unused.
+ *
+ * Return: NULL always.
+ */
+static void *events_thread(void *arg)
+{
+	struct pollfd pfds[2];
+
+	(void)arg;
+
+	pfds[0].fd = events.nl.fd;
+	pfds[0].events = POLLIN;
+	pfds[1].fd = events.stop_fd;
+	pfds[1].events = POLLIN;
+
+	for (;;) {
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: Unable to wait for nl80211 notifications: %s (%d)",
+				  __func__, strerror(errno), errno);
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (nl_recv(&events.nl, events.cb, events.arg) != EXIT_SUCCESS) {
+			if (errno != ENOBUFS) {
+				log_error("%s: Unable to receive nl80211 notifications: %s (%d)",
+					  __func__, strerror(errno), errno);
+				break;
+			}
+
+			log_debug("%s: nl80211 notifications lost", __func__);
+			events.cb(NULL, events.arg);
+		}
+	}
+
+	/* Without notifications the consumer cannot trust its cached data */
+	events.cb(NULL, events.arg);
+
+	pthread_mutex_lock(&events.lock);
+	events.running = false;
+	pthread_mutex_unlock(&events.lock);
+
+	return NULL;
+}
+
+/**
+ * events_close() - Release the resources of the receiver
+ *
+ * Must be called with the lock held and the thread stopped.
+ */
+static void events_close(void)
+{
+	if (events.stop_fd >= 0)
+		close(events.stop_fd);
+	events.stop_fd = -1;
+	nl_close(&events.nl);
+}
+
+int nl80211_events_start(nl_msg_cb_t cb, void *arg)
+{
+	int i, ret = EXIT_FAILURE;
+
+	pthread_mutex_lock(&events.lock);
+
+	if (events.running && events.pid == getpid()) {
+		pthread_mutex_unlock(&events.lock);
+		return EXIT_SUCCESS;
+	}
+
+	/* A stopped thread or the thread of the parent process */
+	if (events.nl.fd >= 0) {
+		if (events.pid == getpid())
+			pthread_join(events.thread, NULL);
+		events_close();
+	}
+
+	if (nl_open(&events.nl, NETLINK_GENERIC, 0) != EXIT_SUCCESS)
+		goto done;
+
+	for (i = 0; i < ARRAY_SIZE(nl80211_groups); i++) {
+		int group = nl_genl_group(&events.nl, NL80211_GENL_NAME, nl80211_groups[i]);
+
+		/* The "mlme" group is missing in old kernels */
+		if (group < 0 && i != ARRAY_SIZE(nl80211_groups) - 1) {
+			log_debug("%s: Unable to resolve nl80211 group '%s': %s (%d)",
+				  __func__, nl80211_groups[i], strerror(errno), errno);
+			goto error;
+		}
+
+		if (group >= 0 && nl_join_group(&events.nl, group) != EXIT_SUCCESS) {
+			log_debug("%s: Unable to join nl80211 group '%s': %s (%d)",
+				  __func__, nl80211_groups[i], strerror(errno), errno);
+			goto error;
+		}
+	}
+
+	events.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (events.stop_fd < 0) {
+		log_error("%s: Unable to create stop event: %s (%d)", __func__,
+			  strerror(errno), errno);
+		goto error;
+	}
+
+	events.cb = cb;
+	events.arg = arg;
+	events.pid = getpid();
+
+	if (pthread_create(&events.thread, NULL, events_thread, NULL) != 0) {
+		log_error("%s: Unable to start the nl80211 notifications thread",
+			  __func__);
+		goto error;
+	}
+
+	events.running = true;
+	ret = EXIT_SUCCESS;
+	goto done;
+
+error:
+	events_close();
+done:
+	pthread_mutex_unlock(&events.lock);
+
+	return ret;
+}
+
+int nl80211_freq_to_channel(unsigned int freq)
+{
+	if (freq == 2484)
+		return 14;
+	if (freq > 2407 && freq < 2484)
+		return (freq - 2407) / 5;
+	if (freq >= 4910 && freq <= 4980)
+		return (freq - 4000) / 5;
+	if (freq >= 5150 && freq <= 5885)
+		return (freq - 5000) / 5;
+	/* 6 GHz band, channel 2 is the only one outside the 5 MHz raster */
+	if (freq == 5935)
+		return 2;
+	if (freq > 5950 && freq <= 7115)
+		return (freq - 5950) / 5;
+	if (freq >= 58320 && freq <= 70200)
+		return (freq - 56160) / 2160;
+
+	return -1;
+}
+
+/**
+ * nl80211_fini() - Stop the notifications and close the shared socket
+ *
+ * Executed when the library is unloaded.
+ */
+static void nl80211_fini(void)
+{
+	uint64_t val = 1;
+
+	if (events.nl.fd >= 0 && events.pid == getpid()) {
+		if (write(events.stop_fd, &val, sizeof(val)) == sizeof(val))
+			pthread_join(events.thread, NULL);
+		events_close();
+	}
+
+	if (nl80211.nl.fd >= 0)
+		nl_close(&nl80211.nl);
+}
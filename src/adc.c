@@ -17,21 +17,33 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
 #include <unistd.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "_common.h"
 #include "adc.h"
 #include "_adc.h"
 #include "_libsoc_interfaces.h"
 #include "_log.h"
+#include "_stats.h"
+#include "_timestamp.h"
 
 #define BUFF_SIZE		256
 
+#define NSEC_PER_SEC		1000000000ULL
+
 static float get_scale(adc_driver_t driver_type, unsigned int adc_chip);
+static int read_sample(adc_internal_t *_adc);
 
 adc_t *ldx_adc_request(unsigned int adc_chip, unsigned int adc_channel)
 {
@@ -142,7 +154,7 @@ adc_t *ldx_adc_request_by_alias(char const * const adc_alias)
 	return new_adc;
 }
 
-int ldx_set_scale(adc_t *adc, float scale)
+int ldx_adc_set_scale(adc_t *adc, float scale)
 {
 	adc_internal_t *_adc = NULL;
 
@@ -195,52 +207,51 @@ int ldx_adc_get_channel(char const * const adc_alias)
 	return config_get_adc_channel_number(adc_alias);
 }
 
-int ldx_adc_get_sample(adc_t *adc)
+static int adc_get_sample(adc_t *adc)
 {
-	char value[BUFF_SIZE];
-	int int_value = 0, nbytes;
-	adc_internal_t *_adc = NULL;
+	int int_value;
 
 	if (adc == NULL) {
 		log_error("%s: ADC cannot be NULL", __func__);
 		return -1;
 	}
 
-	_adc = (adc_internal_t *) adc->_data;
+	log_debug("%s: Reading ADC value.", __func__);
 
-	log_info("%s: Reading ADC value.", __func__);
+	int_value = read_sample((adc_internal_t *) adc->_data);
+	if (int_value >= 0)
+		log_debug("%s: Value read in ADC chip: %d ", __func__, int_value);
 
-	/* We need to restart the pointer in each read */
-	lseek(_adc->input_fd, 0, SEEK_SET);
+	return int_value;
+}
 
-	nbytes = read(_adc->input_fd, value, sizeof(value) - 1);
-	if (nbytes < 0) {
-		if (errno == EAGAIN)
-			log_warning("%s: EAGAIN reading input", __func__);
-		else
-			log_error("%s: Error %d reading input", __func__, errno);
+int ldx_adc_get_sample(adc_t *adc)
+{
+	uint64_t start = stats_begin();
+	int ret;
 
-		/*
-		 * Propagate errno so user can check against EAGAIN or ETIMEDOUT
-		 * in order to retry.
-		 */
-		return -errno;
-	}
+	ret = adc_get_sample(adc);
+	stats_end(STATS_API_ADC_GET_SAMPLE, start, stats_result_count(ret), 1);
 
-	/* Remove newline character read from the sysfs */
-	value[nbytes - 1] = 0;
+	return ret;
+}
 
-	errno = 0;
-	int_value = strtol(value, NULL, 10);
-	if ((errno == ERANGE && (int_value == LONG_MAX || int_value == LONG_MIN))
-	    || (errno != 0 && int_value == 0)) {
-		log_error("%s: ADC value can't be lower than 0", __func__);
+int ldx_adc_get_sample_ts(adc_t *adc, ldx_timestamp_t *ts)
+{
+	ldx_timestamp_t before;
+	int ret;
+
+	if (ts == NULL) {
+		log_error("%s: Timestamp cannot be NULL", __func__);
 		return -1;
 	}
 
-	log_debug("%s: Value read in ADC chip: %d ", __func__, int_value);
+	ldx_timestamp_now(&before);
+	ret = ldx_adc_get_sample(adc);
+	ldx_timestamp_now(ts);
+	ts->ns = before.ns + (ts->ns - before.ns) / 2;
 
-	return int_value;
+	return ret;
 }
 
 float ldx_adc_convert_sample_to_mv(adc_t *adc, int sample)
@@ -255,6 +266,53 @@ float ldx_adc_convert_sample_to_mv(adc_t *adc, int sample)
 	return sample * _adc->scale;
 
 }
+
+void adc_convert_to_mv(const int *in, float *out, size_t n, float offset,
+		       float scale)
+{
+	const int *restrict src = in;
+	float *restrict dst = out;
+	size_t i = 0;
+
+#if defined(__ARM_NEON)
+	const float32x4_t voffset = vdupq_n_f32(offset);
+	const float32x4_t vscale = vdupq_n_f32(scale);
+
+	for (; i + 8 <= n; i += 8) {
+		float32x4_t a = vcvtq_f32_s32(vld1q_s32(src + i));
+		float32x4_t b = vcvtq_f32_s32(vld1q_s32(src + i + 4));
+
+		vst1q_f32(dst + i, vmulq_f32(vaddq_f32(a, voffset), vscale));
+		vst1q_f32(dst + i + 4, vmulq_f32(vaddq_f32(b, voffset), vscale));
+	}
+#endif
+
+	/* Remaining samples, vectorized by the compiler where possible */
+	for (; i < n; i++)
+		dst[i] = ((float)src[i] + offset) * scale;
+}
+
+int ldx_adc_convert_samples_to_mv(adc_t *adc, const int *in, float *out,
+				  size_t n)
+{
+	adc_internal_t *_adc = NULL;
+
+	if (adc == NULL || in == NULL || out == NULL) {
+		log_error("%s: ADC and arrays cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_adc = (adc_internal_t *) adc->_data;
+	if (_adc->scale <= 0) {
+		log_error("%s: Scale should be a number greater than 0", __func__);
+		return EXIT_FAILURE;
+	}
+
+	adc_convert_to_mv(in, out, n, 0, _adc->scale);
+
+	return EXIT_SUCCESS;
+}
+
 void *ldx_sampling_callback_thread(void *callback_adc)
 {
 	adc_t *adc = callback_adc;
@@ -374,6 +432,348 @@ int ldx_adc_start_sampling(adc_t *adc, const ldx_adc_read_cb_t read_cb,
 	return EXIT_SUCCESS;
 }
 
+adc_group_t *ldx_adc_group_create(adc_t **adcs, unsigned int num_adcs)
+{
+	adc_group_t *new_group = NULL;
+	adc_group_internal_t *_group = NULL;
+	unsigned int i;
+
+	if (adcs == NULL || num_adcs == 0) {
+		log_error("%s: Invalid ADC list", __func__);
+		return NULL;
+	}
+
+	for (i = 0; i < num_adcs; i++) {
+		if (adcs[i] == NULL) {
+			log_error("%s: ADC cannot be NULL", __func__);
+			return NULL;
+		}
+	}
+
+	new_group = calloc(1, sizeof(adc_group_t));
+	_group = calloc(1, sizeof(adc_group_internal_t));
+	if (_group != NULL) {
+		_group->adcs = calloc(num_adcs, sizeof(adc_t *));
+		_group->samples = calloc(num_adcs, sizeof(int));
+	}
+	if (new_group == NULL || _group == NULL || _group->adcs == NULL ||
+	    _group->samples == NULL) {
+		log_error("%s: Unable to create ADC group, cannot allocate memory",
+			  __func__);
+		if (_group != NULL) {
+			free(_group->adcs);
+			free(_group->samples);
+		}
+		free(_group);
+		free(new_group);
+		return NULL;
+	}
+
+	memcpy(_group->adcs, adcs, num_adcs * sizeof(adc_t *));
+	_group->timer_fd = -1;
+	_group->stop_fd = -1;
+	pthread_mutex_init(&_group->stats_lock, NULL);
+
+	{
+		adc_group_t init_group = {
+			.num_adcs = num_adcs,
+			._data = _group
+		};
+
+		memcpy(new_group, &init_group, sizeof(adc_group_t));
+	}
+
+	return new_group;
+}
+
+int ldx_adc_group_free(adc_group_t *group)
+{
+	adc_group_internal_t *_group = NULL;
+	int ret;
+
+	if (group == NULL)
+		return EXIT_SUCCESS;
+
+	_group = (adc_group_internal_t *) group->_data;
+
+	ret = ldx_adc_group_stop_sampling(group);
+
+	pthread_mutex_destroy(&_group->stats_lock);
+	free(_group->adcs);
+	free(_group->samples);
+	free(_group);
+	free(group);
+
+	return ret;
+}
+
+int ldx_adc_group_get_samples(adc_group_t *group, int *samples)
+{
+	adc_group_internal_t *_group = NULL;
+	int ret = EXIT_SUCCESS;
+	unsigned int i;
+
+	if (group == NULL || samples == NULL) {
+		log_error("%s: Group and samples cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_group = (adc_group_internal_t *) group->_data;
+
+	for (i = 0; i < group->num_adcs; i++) {
+		samples[i] = read_sample((adc_internal_t *) _group->adcs[i]->_data);
+		if (samples[i] < 0)
+			ret = EXIT_FAILURE;
+	}
+
+	return ret;
+}
+
+/**
+ * group_sampling_thread() - Sample an ADC group on every timer expiration
+ *
+ * @arg:	The ADC group (adc_group_t *).
+ *
+ * Return: NULL.
+ */
+static void *group_sampling_thread(void *arg)
+{
+	adc_group_t *group = arg;
+	adc_group_internal_t *_group = (adc_group_internal_t *) group->_data;
+	struct pollfd pfds[2];
+	struct timespec now;
+	uint64_t expirations, total = 0, latency;
+
+	pfds[0].fd = _group->timer_fd;
+	pfds[0].events = POLLIN;
+	pfds[1].fd = _group->stop_fd;
+	pfds[1].events = POLLIN;
+
+	while (1) {
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: Error %d waiting for the timer", __func__,
+				  errno);
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (read(_group->timer_fd, &expirations, sizeof(expirations)) !=
+		    sizeof(expirations))
+			continue;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		total += expirations;
+		latency = now.tv_sec * NSEC_PER_SEC + now.tv_nsec -
+			  (_group->start_ns + (total - 1) * _group->period_ns);
+
+		pthread_mutex_lock(&_group->stats_lock);
+		_group->stats.ticks++;
+		_group->stats.missed += expirations - 1;
+		_group->stats.last_latency_ns = latency;
+		if (latency > _group->stats.max_latency_ns)
+			_group->stats.max_latency_ns = latency;
+		pthread_mutex_unlock(&_group->stats_lock);
+
+		ldx_adc_group_get_samples(group, _group->samples);
+		ldx_timestamp_now(&_group->scan_ts);
+		_group->scan_ts.ns = timestamp_timespec_ns(&now) +
+				     (_group->scan_ts.ns - timestamp_timespec_ns(&now)) / 2;
+		_group->callback_fn(_group->samples, group->num_adcs,
+				    _group->callback_arg);
+	}
+
+	return NULL;
+}
+
+int ldx_adc_group_start_sampling(adc_group_t *group,
+				 const ldx_adc_group_cb_t read_cb,
+				 unsigned int period_us, void *arg)
+{
+	adc_group_internal_t *_group = NULL;
+	struct itimerspec its;
+	struct timespec now;
+	uint64_t period_ns, deadline;
+
+	if (group == NULL || read_cb == NULL) {
+		log_error("%s: Group and callback cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (period_us == 0) {
+		log_error("%s: Invalid sampling period", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_group = (adc_group_internal_t *) group->_data;
+	if (_group->running) {
+		log_error("%s: The group is already sampling", __func__);
+		return EXIT_FAILURE;
+	}
+
+	log_debug("%s: Start sampling %u ADCs every %u us", __func__,
+		  group->num_adcs, period_us);
+
+	_group->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	_group->stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (_group->timer_fd < 0 || _group->stop_fd < 0) {
+		log_error("%s: Unable to create the sampling timer (%d)", __func__,
+			  errno);
+		goto err_close;
+	}
+
+	period_ns = (uint64_t)period_us * 1000;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	deadline = now.tv_sec * NSEC_PER_SEC + now.tv_nsec + period_ns;
+
+	its.it_interval.tv_sec = period_ns / NSEC_PER_SEC;
+	its.it_interval.tv_nsec = period_ns % NSEC_PER_SEC;
+	its.it_value.tv_sec = deadline / NSEC_PER_SEC;
+	its.it_value.tv_nsec = deadline % NSEC_PER_SEC;
+	if (timerfd_settime(_group->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+		log_error("%s: Unable to start the sampling timer (%d)", __func__,
+			  errno);
+		goto err_close;
+	}
+
+	_group->callback_fn = read_cb;
+	_group->callback_arg = arg;
+	_group->period_ns = period_ns;
+	_group->start_ns = deadline;
+	memset(&_group->stats, 0, sizeof(_group->stats));
+
+	if (pthread_create(&_group->thread, NULL, group_sampling_thread,
+			   group) != 0) {
+		log_error("%s: Unable to create the sampling thread", __func__);
+		goto err_close;
+	}
+	_group->running = true;
+
+	return EXIT_SUCCESS;
+
+err_close:
+	if (_group->timer_fd >= 0)
+		close(_group->timer_fd);
+	if (_group->stop_fd >= 0)
+		close(_group->stop_fd);
+	_group->timer_fd = -1;
+	_group->stop_fd = -1;
+
+	return EXIT_FAILURE;
+}
+
+int ldx_adc_group_stop_sampling(adc_group_t *group)
+{
+	adc_group_internal_t *_group = NULL;
+	uint64_t one = 1;
+	int ret = EXIT_SUCCESS;
+
+	if (group == NULL) {
+		log_error("%s: Group cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_group = (adc_group_internal_t *) group->_data;
+	if (!_group->running)
+		return EXIT_SUCCESS;
+
+	if (write(_group->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+		log_error("%s: Unable to stop the sampling thread", __func__);
+		return EXIT_FAILURE;
+	}
+
+	pthread_join(_group->thread, NULL);
+	_group->running = false;
+
+	if (close(_group->timer_fd) < 0 || close(_group->stop_fd) < 0) {
+		log_error("%s: Error closing the sampling descriptors", __func__);
+		ret = EXIT_FAILURE;
+	}
+	_group->timer_fd = -1;
+	_group->stop_fd = -1;
+
+	log_debug("%s: Group sampling was stopped", __func__);
+
+	return ret;
+}
+
+int ldx_adc_group_get_stats(adc_group_t *group, adc_group_stats_t *stats)
+{
+	adc_group_internal_t *_group = NULL;
+
+	if (group == NULL || stats == NULL) {
+		log_error("%s: Group and stats cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_group = (adc_group_internal_t *) group->_data;
+
+	pthread_mutex_lock(&_group->stats_lock);
+	*stats = _group->stats;
+	pthread_mutex_unlock(&_group->stats_lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_adc_group_get_timestamp(adc_group_t *group, ldx_timestamp_t *ts)
+{
+	adc_group_internal_t *_group = NULL;
+
+	if (group == NULL || ts == NULL) {
+		log_error("%s: Group and timestamp cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_group = (adc_group_internal_t *) group->_data;
+	*ts = _group->scan_ts;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * read_sample() - Read the raw value of an ADC from the sysfs
+ *
+ * @_adc:	The internal data of the ADC.
+ *
+ * Return: The value of the ADC channel, -errno on error.
+ */
+static int read_sample(adc_internal_t *_adc)
+{
+	char value[BUFF_SIZE];
+	int int_value = 0, nbytes;
+
+	/* Read from the beginning of the attribute in each read */
+	nbytes = pread(_adc->input_fd, value, sizeof(value) - 1, 0);
+	if (nbytes < 0) {
+		if (errno == EAGAIN)
+			log_warning("%s: EAGAIN reading input", __func__);
+		else
+			log_error("%s: Error %d reading input", __func__, errno);
+
+		/*
+		 * Propagate errno so user can check against EAGAIN or ETIMEDOUT
+		 * in order to retry.
+		 */
+		return -errno;
+	}
+
+	/* Remove newline character read from the sysfs */
+	value[nbytes > 0 ? nbytes - 1 : 0] = 0;
+
+	errno = 0;
+	int_value = strtol(value, NULL, 10);
+	if ((errno == ERANGE && (int_value == LONG_MAX || int_value == LONG_MIN))
+	    || (errno != 0 && int_value == 0)) {
+		log_error("%s: ADC value can't be lower than 0", __func__);
+		return -1;
+	}
+
+	return int_value;
+}
+
 static float get_scale(adc_driver_t driver_type, unsigned int adc_chip)
 {
 	char scale_path[BUFF_SIZE];
@@ -0,0 +1,992 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <dirent.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "adc.h"
+#include "_adc.h"
+#include "_log.h"
+#include "_stats.h"
+#include "_timestamp.h"
+
+#define BUFF_SIZE		256
+
+#define IIO_DEVICES_PATH	"/sys/bus/iio/devices"
+#define IIO_HRTIMER_PATH	"/sys/kernel/config/iio/triggers/hrtimer"
+
+/* Fits "IIO_DEVICES_PATH/<entry>/<attribute>" for any directory entry name */
+#define IIO_ENTRY_PATH_LEN	\
+	(sizeof(IIO_DEVICES_PATH "/") + NAME_MAX + sizeof("/sampling_frequency"))
+
+/* Samples decoded on the stack per conversion step */
+#define CONVERT_CHUNK		256
+
+/**
+ * sysfs_write() - Write a string to a sysfs attribute
+ *
+ * @path:	The attribute path.
+ * @value:	The string to write.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int sysfs_write(const char *path, const char *value)
+{
+	int fd, ret = EXIT_SUCCESS;
+
+	fd = open(path, O_WRONLY);
+	if (fd < 0)
+		return EXIT_FAILURE;
+
+	if (write(fd, value, strlen(value)) < 0)
+		ret = EXIT_FAILURE;
+
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * sysfs_write_uint() - Write a number to a sysfs attribute
+ *
+ * @path:	The attribute path.
+ * @value:	The number to write.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int sysfs_write_uint(const char *path, unsigned int value)
+{
+	char str[16];
+
+	snprintf(str, sizeof(str), "%u", value);
+
+	return sysfs_write(path, str);
+}
+
+/**
+ * sysfs_read() - Read the first line of a sysfs attribute
+ *
+ * @path:	The attribute path.
+ * @buf:	Buffer to store the line, without the new line.
+ * @len:	Size of the buffer.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int sysfs_read(const char *path, char *buf, size_t len)
+{
+	int fd, nbytes;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return EXIT_FAILURE;
+
+	nbytes = read(fd, buf, len - 1);
+	close(fd);
+	if (nbytes < 0)
+		return EXIT_FAILURE;
+
+	buf[nbytes] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * parse_scan_type() - Parse the contents of a 'scan_elements/<element>_type' file
+ *
+ * @type:	The type string, for example "le:s12/16>>4".
+ * @format:	Where to store the parsed format.
+ * @repeat:	Where to store the number of times the element is repeated.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int parse_scan_type(const char *type, adc_scan_format_t *format,
+			   unsigned int *repeat)
+{
+	char endian, sign;
+
+	*repeat = 1;
+	if (sscanf(type, "%ce:%c%u/%uX%u>>%u", &endian, &sign,
+		   &format->realbits, &format->storagebits, repeat,
+		   &format->shift) != 6 &&
+	    sscanf(type, "%ce:%c%u/%u>>%u", &endian, &sign,
+		   &format->realbits, &format->storagebits,
+		   &format->shift) != 5)
+		return EXIT_FAILURE;
+
+	if ((endian != 'b' && endian != 'l') || (sign != 's' && sign != 'u') ||
+	    format->storagebits == 0 || format->storagebits % 8 ||
+	    format->storagebits > 64 || format->realbits > format->storagebits ||
+	    *repeat == 0)
+		return EXIT_FAILURE;
+
+	format->is_be = endian == 'b';
+	format->is_signed = sign == 's';
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * read_scan_element() - Get the index and format of a scan element
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @name:	Name of the element, for example "in_voltage3".
+ * @index:	Where to store the scan index of the element.
+ * @format:	Where to store the format of the element.
+ * @repeat:	Where to store the number of times the element is repeated.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_scan_element(unsigned int adc_chip, const char *name,
+			     unsigned int *index, adc_scan_format_t *format,
+			     unsigned int *repeat)
+{
+	char path[BUFF_SIZE], value[64];
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/scan_elements/%s_index",
+		 adc_chip, name);
+	if (sysfs_read(path, value, sizeof(value)) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+	*index = strtoul(value, NULL, 10);
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/scan_elements/%s_type",
+		 adc_chip, name);
+	if (sysfs_read(path, value, sizeof(value)) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	return parse_scan_type(value, format, repeat);
+}
+
+/**
+ * read_channel_float() - Read a float attribute of an IIO voltage channel
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @channel:	The ADC channel.
+ * @attr:	The attribute name ("scale", "offset").
+ * @value:	Where to store the value.
+ *
+ * The channel specific attribute (in_voltage<channel>_<attr>) takes
+ * precedence over the one shared by all the channels (in_voltage_<attr>).
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_channel_float(unsigned int adc_chip, unsigned int channel,
+			      const char *attr, float *value)
+{
+	char path[BUFF_SIZE], str[32];
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/in_voltage%u_%s",
+		 adc_chip, channel, attr);
+	if (sysfs_read(path, str, sizeof(str)) != EXIT_SUCCESS) {
+		snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/in_voltage_%s",
+			 adc_chip, attr);
+		if (sysfs_read(path, str, sizeof(str)) != EXIT_SUCCESS)
+			return EXIT_FAILURE;
+	}
+
+	*value = atof(str);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * decode_samples() - Decode the raw samples of an element from scans
+ *
+ * @format:	Format of the element.
+ * @scan_size:	Size in bytes of each scan.
+ * @scans:	The scans.
+ * @nscans:	Number of scans.
+ * @out:	Array of 'nscans' elements to store the samples.
+ */
+static void decode_samples(const adc_scan_format_t *format,
+			   unsigned int scan_size, const uint8_t *scans,
+			   unsigned int nscans, int *out)
+{
+	const unsigned int bytes = format->storagebits / 8;
+	const uint64_t mask = format->realbits >= 64 ?
+			      ~0ULL : (1ULL << format->realbits) - 1;
+	const uint64_t sign = format->realbits ?
+			      1ULL << (format->realbits - 1) : 0;
+	const uint8_t *p = scans + format->offset;
+	unsigned int i, j;
+
+	for (i = 0; i < nscans; i++, p += scan_size) {
+		uint64_t raw = 0;
+		uint16_t v16;
+		uint32_t v32;
+
+		switch (bytes) {
+		case 1:
+			raw = p[0];
+			break;
+		case 2:
+			memcpy(&v16, p, sizeof(v16));
+			raw = format->is_be ? be16toh(v16) : le16toh(v16);
+			break;
+		case 4:
+			memcpy(&v32, p, sizeof(v32));
+			raw = format->is_be ? be32toh(v32) : le32toh(v32);
+			break;
+		case 8:
+			memcpy(&raw, p, sizeof(raw));
+			raw = format->is_be ? be64toh(raw) : le64toh(raw);
+			break;
+		default:
+			for (j = 0; j < bytes; j++) {
+				unsigned int k = format->is_be ? j : bytes - 1 - j;
+
+				raw = (raw << 8) | p[k];
+			}
+			break;
+		}
+
+		raw = (raw >> format->shift) & mask;
+		if (format->is_signed && (raw & sign))
+			raw |= ~mask;
+
+		out[i] = (int)(int64_t)raw;
+	}
+}
+
+/**
+ * set_scan_element() - Enable or disable a scan element
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @name:	Name of the element, for example "in_voltage3".
+ * @enable:	True to enable the element, false to disable it.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int set_scan_element(unsigned int adc_chip, const char *name, bool enable)
+{
+	char path[BUFF_SIZE];
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/scan_elements/%s_en",
+		 adc_chip, name);
+
+	return sysfs_write(path, enable ? "1" : "0");
+}
+
+/**
+ * disable_scan_elements() - Disable every scan element of a chip
+ *
+ * @adc_chip:	The IIO ADC chip.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int disable_scan_elements(unsigned int adc_chip)
+{
+	char path[BUFF_SIZE];
+	struct dirent *entry;
+	DIR *dir;
+	int ret = EXIT_SUCCESS;
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/scan_elements",
+		 adc_chip);
+	dir = opendir(path);
+	if (dir == NULL)
+		return EXIT_FAILURE;
+
+	while ((entry = readdir(dir)) != NULL) {
+		size_t len = strlen(entry->d_name);
+
+		if (len <= 3 || strcmp(entry->d_name + len - 3, "_en"))
+			continue;
+
+		snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/scan_elements/%s",
+			 adc_chip, entry->d_name);
+		if (sysfs_write(path, "0") != EXIT_SUCCESS)
+			ret = EXIT_FAILURE;
+	}
+
+	closedir(dir);
+
+	return ret;
+}
+
+/**
+ * compute_scan_layout() - Compute the offsets of the elements in the scans
+ *
+ * @_buffer:		The buffered capture data.
+ * @num_channels:	Number of captured channels.
+ * @repeat:		Array with the repeat count of each channel.
+ * @ts_index:		Scan index of the timestamp.
+ *
+ * The IIO core places the enabled elements by increasing scan index, each one
+ * aligned to its total storage size (including repetitions), and pads the
+ * scan to the largest element.
+ *
+ * Return: The size of the scan in bytes.
+ */
+static unsigned int compute_scan_layout(adc_buffer_internal_t *_buffer,
+					unsigned int num_channels,
+					const unsigned int *repeat,
+					unsigned int ts_index)
+{
+	unsigned int offset = 0, max_bytes = 1, done = 0;
+	long last_index = -1;
+
+	while (done < num_channels + (_buffer->timestamp ? 1 : 0)) {
+		adc_scan_format_t *format = NULL;
+		unsigned int next_index = 0, bytes, count = 1, i;
+
+		/* Find the element with the next scan index */
+		for (i = 0; i < num_channels; i++) {
+			unsigned int idx = _buffer->channels[i].scan_index;
+
+			if ((long)idx > last_index && (!format || idx < next_index)) {
+				format = &_buffer->channels[i].format;
+				next_index = idx;
+				count = repeat[i];
+			}
+		}
+		if (_buffer->timestamp && (long)ts_index > last_index &&
+		    (!format || ts_index < next_index)) {
+			format = &_buffer->ts_format;
+			next_index = ts_index;
+			count = 1;
+		}
+
+		bytes = format->storagebits / 8 * count;
+		offset = (offset + bytes - 1) / bytes * bytes;
+		format->offset = offset;
+		offset += bytes;
+		if (bytes > max_bytes)
+			max_bytes = bytes;
+
+		last_index = next_index;
+		done++;
+	}
+
+	return (offset + max_bytes - 1) / max_bytes * max_bytes;
+}
+
+/**
+ * find_trigger_dir() - Find the sysfs directory of a trigger
+ *
+ * @name:	The trigger name.
+ * @path:	Buffer of IIO_ENTRY_PATH_LEN bytes to store the directory path.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int find_trigger_dir(const char *name, char *path)
+{
+	char value[64];
+	struct dirent *entry;
+	DIR *dir;
+	int ret = EXIT_FAILURE;
+
+	dir = opendir(IIO_DEVICES_PATH);
+	if (dir == NULL)
+		return EXIT_FAILURE;
+
+	while ((entry = readdir(dir)) != NULL) {
+		if (strncmp(entry->d_name, "trigger", strlen("trigger")))
+			continue;
+
+		snprintf(path, IIO_ENTRY_PATH_LEN, IIO_DEVICES_PATH "/%s/name",
+			 entry->d_name);
+		if (sysfs_read(path, value, sizeof(value)) != EXIT_SUCCESS ||
+		    strcmp(value, name))
+			continue;
+
+		snprintf(path, IIO_ENTRY_PATH_LEN, IIO_DEVICES_PATH "/%s", entry->d_name);
+		ret = EXIT_SUCCESS;
+		break;
+	}
+
+	closedir(dir);
+
+	return ret;
+}
+
+/**
+ * setup_trigger() - Attach a trigger to the chip and set its frequency
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @_buffer:	The buffered capture data.
+ * @cfg:	The capture configuration.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int setup_trigger(unsigned int adc_chip, adc_buffer_internal_t *_buffer,
+			 const adc_buffer_cfg_t *cfg)
+{
+	char path[BUFF_SIZE], trig_path[IIO_ENTRY_PATH_LEN], current[64];
+	const char *name = cfg->trigger;
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/trigger/current_trigger",
+		 adc_chip);
+	if (sysfs_read(path, current, sizeof(current)) != EXIT_SUCCESS) {
+		/* The device fills the buffer by itself */
+		if (cfg->trigger != NULL) {
+			log_error("%s: ADC chip %u does not support triggers",
+				  __func__, adc_chip);
+			return EXIT_FAILURE;
+		}
+		if (cfg->frequency == 0)
+			return EXIT_SUCCESS;
+
+		snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/sampling_frequency",
+			 adc_chip);
+		if (sysfs_write_uint(path, cfg->frequency) != EXIT_SUCCESS) {
+			log_error("%s: Unable to set the sampling frequency of ADC chip %u",
+				  __func__, adc_chip);
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	if (name == NULL && current[0] != '\0')
+		name = current;
+
+	if (name == NULL) {
+		snprintf(_buffer->trigger, sizeof(_buffer->trigger), "ldx_adc%u",
+			 adc_chip);
+		snprintf(trig_path, sizeof(trig_path), IIO_HRTIMER_PATH "/%s",
+			 _buffer->trigger);
+		if (mkdir(trig_path, 0755) < 0) {
+			log_error("%s: Unable to create trigger '%s' (%d)", __func__,
+				  _buffer->trigger, errno);
+			_buffer->trigger[0] = '\0';
+			return EXIT_FAILURE;
+		}
+		name = _buffer->trigger;
+	}
+
+	if (cfg->frequency > 0) {
+		if (find_trigger_dir(name, trig_path) != EXIT_SUCCESS) {
+			log_error("%s: Unable to find trigger '%s'", __func__, name);
+			return EXIT_FAILURE;
+		}
+		strncat(trig_path, "/sampling_frequency",
+			sizeof(trig_path) - strlen(trig_path) - 1);
+		if (sysfs_write_uint(trig_path, cfg->frequency) != EXIT_SUCCESS) {
+			log_error("%s: Unable to set the frequency of trigger '%s'",
+				  __func__, name);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (name != current && sysfs_write(path, name) != EXIT_SUCCESS) {
+		log_error("%s: Unable to attach trigger '%s' to ADC chip %u",
+			  __func__, name, adc_chip);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * release_trigger() - Detach and remove the trigger created for a capture
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @_buffer:	The buffered capture data.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int release_trigger(unsigned int adc_chip, adc_buffer_internal_t *_buffer)
+{
+	char path[BUFF_SIZE];
+	int ret = EXIT_SUCCESS;
+
+	if (_buffer->trigger[0] == '\0')
+		return EXIT_SUCCESS;
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/trigger/current_trigger",
+		 adc_chip);
+	sysfs_write(path, "\n");
+
+	snprintf(path, sizeof(path), IIO_HRTIMER_PATH "/%s", _buffer->trigger);
+	if (rmdir(path) < 0) {
+		log_error("%s: Unable to remove trigger '%s' (%d)", __func__,
+			  _buffer->trigger, errno);
+		ret = EXIT_FAILURE;
+	}
+	_buffer->trigger[0] = '\0';
+
+	return ret;
+}
+
+/**
+ * set_buffer_attr() - Write an attribute of the buffer of a chip
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @attr:	The attribute name ("enable", "length", "watermark").
+ * @value:	The value to write.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int set_buffer_attr(unsigned int adc_chip, const char *attr,
+			   unsigned int value)
+{
+	char path[BUFF_SIZE];
+
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/buffer/%s",
+		 adc_chip, attr);
+
+	return sysfs_write_uint(path, value);
+}
+
+/**
+ * select_monotonic_clock() - Stamp the scans with the monotonic clock
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @_buffer:	The capture, to store the selected clock.
+ *
+ * IIO devices use the wall clock by default. Switching them to
+ * CLOCK_MONOTONIC gives the time base of 'ldx_timestamp_t', immune to clock
+ * steps. The previous clock is saved to restore it when the capture stops.
+ */
+static void select_monotonic_clock(unsigned int adc_chip,
+				   adc_buffer_internal_t *_buffer)
+{
+	char path[BUFF_SIZE], clock[sizeof(_buffer->ts_clock)];
+
+	snprintf(path, sizeof(path),
+		 IIO_DEVICES_PATH "/iio:device%u/current_timestamp_clock", adc_chip);
+
+	/* Kernels before 4.10 only have the wall clock */
+	if (sysfs_read(path, clock, sizeof(clock)) != EXIT_SUCCESS)
+		return;
+
+	if (!strcmp(clock, "monotonic")) {
+		_buffer->ts_monotonic = true;
+		return;
+	}
+
+	if (sysfs_write(path, "monotonic") != EXIT_SUCCESS) {
+		log_debug("%s: Unable to select the monotonic clock of ADC chip %u",
+			  __func__, adc_chip);
+		return;
+	}
+
+	strcpy(_buffer->ts_clock, clock);
+	_buffer->ts_monotonic = true;
+}
+
+/**
+ * restore_clock() - Restore the timestamp clock changed for a capture
+ *
+ * @adc_chip:	The IIO ADC chip.
+ * @_buffer:	The capture.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int restore_clock(unsigned int adc_chip, adc_buffer_internal_t *_buffer)
+{
+	char path[BUFF_SIZE];
+
+	if (_buffer->ts_clock[0] == '\0')
+		return EXIT_SUCCESS;
+
+	snprintf(path, sizeof(path),
+		 IIO_DEVICES_PATH "/iio:device%u/current_timestamp_clock", adc_chip);
+
+	return sysfs_write(path, _buffer->ts_clock);
+}
+
+void ldx_adc_buffer_set_defconfig(adc_buffer_cfg_t *cfg)
+{
+	memset(cfg, 0, sizeof(adc_buffer_cfg_t));
+	cfg->timestamp = false;
+	cfg->trigger = NULL;
+}
+
+adc_buffer_t *ldx_adc_buffer_start(unsigned int adc_chip,
+				   const unsigned int *channels,
+				   unsigned int num_channels,
+				   const adc_buffer_cfg_t *cfg)
+{
+	adc_buffer_t *new_buffer = NULL;
+	adc_buffer_internal_t *_buffer = NULL;
+	adc_buffer_cfg_t defcfg;
+	unsigned int *repeat = NULL;
+	unsigned int ts_index = 0, ts_repeat, scan_size, i;
+	char path[BUFF_SIZE], name[32];
+
+	if (channels == NULL || num_channels == 0) {
+		log_error("%s: Invalid channel list", __func__);
+		return NULL;
+	}
+
+	if (cfg == NULL) {
+		ldx_adc_buffer_set_defconfig(&defcfg);
+		cfg = &defcfg;
+	}
+
+	log_debug("%s: Starting buffered capture on ADC chip: %u, %u channels",
+		  __func__, adc_chip, num_channels);
+
+	new_buffer = calloc(1, sizeof(adc_buffer_t));
+	_buffer = calloc(1, sizeof(adc_buffer_internal_t));
+	repeat = calloc(num_channels, sizeof(unsigned int));
+	if (_buffer != NULL)
+		_buffer->channels = calloc(num_channels, sizeof(adc_buffer_channel_t));
+	if (new_buffer == NULL || _buffer == NULL || repeat == NULL ||
+	    _buffer->channels == NULL) {
+		log_error("%s: Unable to start capture on ADC chip: %u, "
+			  "cannot allocate memory", __func__, adc_chip);
+		goto err_free;
+	}
+	_buffer->dev_fd = -1;
+	_buffer->timestamp = cfg->timestamp;
+
+	/* The scan layout can only be changed with the buffer disabled */
+	snprintf(path, sizeof(path), IIO_DEVICES_PATH "/iio:device%u/buffer/enable",
+		 adc_chip);
+	if (sysfs_read(path, name, sizeof(name)) != EXIT_SUCCESS) {
+		log_error("%s: ADC chip %u does not support buffered capture",
+			  __func__, adc_chip);
+		goto err_free;
+	}
+	if (atoi(name) != 0) {
+		log_error("%s: The buffer of ADC chip %u is already in use",
+			  __func__, adc_chip);
+		goto err_free;
+	}
+
+	if (disable_scan_elements(adc_chip) != EXIT_SUCCESS) {
+		log_error("%s: Unable to reset the scan elements of ADC chip %u",
+			  __func__, adc_chip);
+		goto err_free;
+	}
+
+	for (i = 0; i < num_channels; i++) {
+		unsigned int j;
+
+		for (j = 0; j < i; j++) {
+			if (channels[j] == channels[i]) {
+				log_error("%s: Channel %u is repeated", __func__,
+					  channels[i]);
+				goto err_disable;
+			}
+		}
+
+		_buffer->channels[i].channel = channels[i];
+		if (read_channel_float(adc_chip, channels[i], "scale",
+				       &_buffer->channels[i].scale) != EXIT_SUCCESS)
+			_buffer->channels[i].scale = -1;
+		if (read_channel_float(adc_chip, channels[i], "offset",
+				       &_buffer->channels[i].offset) != EXIT_SUCCESS)
+			_buffer->channels[i].offset = 0;
+
+		snprintf(name, sizeof(name), "in_voltage%u", channels[i]);
+		if (read_scan_element(adc_chip, name, &_buffer->channels[i].scan_index,
+				      &_buffer->channels[i].format,
+				      &repeat[i]) != EXIT_SUCCESS ||
+		    set_scan_element(adc_chip, name, true) != EXIT_SUCCESS) {
+			log_error("%s: Unable to enable channel %u of ADC chip %u",
+				  __func__, channels[i], adc_chip);
+			goto err_disable;
+		}
+	}
+
+	if (_buffer->timestamp) {
+		if (read_scan_element(adc_chip, "in_timestamp", &ts_index,
+				      &_buffer->ts_format, &ts_repeat) != EXIT_SUCCESS ||
+		    set_scan_element(adc_chip, "in_timestamp", true) != EXIT_SUCCESS) {
+			log_error("%s: Unable to enable the timestamp of ADC chip %u",
+				  __func__, adc_chip);
+			goto err_disable;
+		}
+		select_monotonic_clock(adc_chip, _buffer);
+	}
+
+	scan_size = compute_scan_layout(_buffer, num_channels, repeat, ts_index);
+
+	if (setup_trigger(adc_chip, _buffer, cfg) != EXIT_SUCCESS)
+		goto err_trigger;
+
+	if (cfg->buffer_len > 0 &&
+	    set_buffer_attr(adc_chip, "length", cfg->buffer_len) != EXIT_SUCCESS) {
+		log_error("%s: Unable to set the buffer length of ADC chip %u",
+			  __func__, adc_chip);
+		goto err_trigger;
+	}
+
+	if (cfg->watermark > 0 &&
+	    set_buffer_attr(adc_chip, "watermark", cfg->watermark) != EXIT_SUCCESS) {
+		log_error("%s: Unable to set the buffer watermark of ADC chip %u",
+			  __func__, adc_chip);
+		goto err_trigger;
+	}
+
+	snprintf(path, sizeof(path), "/dev/iio:device%u", adc_chip);
+	_buffer->dev_fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (_buffer->dev_fd < 0) {
+		log_error("%s: Unable to open '%s' (%d)", __func__, path, errno);
+		goto err_trigger;
+	}
+
+	if (set_buffer_attr(adc_chip, "enable", 1) != EXIT_SUCCESS) {
+		log_error("%s: Unable to enable the buffer of ADC chip %u",
+			  __func__, adc_chip);
+		goto err_close;
+	}
+
+	free(repeat);
+
+	{
+		adc_buffer_t init_buffer = {
+			.chip = adc_chip,
+			.num_channels = num_channels,
+			.scan_size = scan_size,
+			._data = _buffer
+		};
+
+		memcpy(new_buffer, &init_buffer, sizeof(adc_buffer_t));
+	}
+
+	return new_buffer;
+
+err_close:
+	close(_buffer->dev_fd);
+err_trigger:
+	release_trigger(adc_chip, _buffer);
+err_disable:
+	disable_scan_elements(adc_chip);
+	restore_clock(adc_chip, _buffer);
+err_free:
+	if (_buffer != NULL)
+		free(_buffer->channels);
+	free(_buffer);
+	free(repeat);
+	free(new_buffer);
+
+	return NULL;
+}
+
+static int adc_buffer_read(adc_buffer_t *buffer, void *data,
+			   unsigned int nscans, int timeout)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+	struct pollfd pfd;
+	ssize_t nbytes;
+	int ret;
+
+	if (buffer == NULL || data == NULL) {
+		log_error("%s: Buffer and data cannot be NULL", __func__);
+		return -1;
+	}
+
+	if (nscans == 0)
+		return 0;
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+
+	pfd.fd = _buffer->dev_fd;
+	pfd.events = POLLIN;
+
+	do {
+		ret = poll(&pfd, 1, timeout);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		log_error("%s: Error %d waiting for scans", __func__, errno);
+		return -1;
+	}
+	if (ret == 0)
+		return 0;
+
+	nbytes = read(_buffer->dev_fd, data, (size_t)nscans * buffer->scan_size);
+	if (nbytes < 0) {
+		if (errno == EAGAIN)
+			return 0;
+
+		log_error("%s: Error %d reading scans", __func__, errno);
+		return -1;
+	}
+
+	return nbytes / buffer->scan_size;
+}
+
+int ldx_adc_buffer_read(adc_buffer_t *buffer, void *data, unsigned int nscans,
+			int timeout)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = adc_buffer_read(buffer, data, nscans, timeout);
+	stats_end(STATS_API_ADC_BUFFER_READ, start, stats_result_count(ret),
+		  stats_count(ret));
+
+	return ret;
+}
+
+int ldx_adc_buffer_get_format(adc_buffer_t *buffer, unsigned int index,
+			      adc_scan_format_t *format)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+
+	if (buffer == NULL || format == NULL || index >= buffer->num_channels) {
+		log_error("%s: Invalid arguments", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+	*format = _buffer->channels[index].format;
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_adc_buffer_get_samples(adc_buffer_t *buffer, unsigned int index,
+			       const void *scans, unsigned int nscans, int *out)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+
+	if (buffer == NULL || scans == NULL || out == NULL ||
+	    index >= buffer->num_channels) {
+		log_error("%s: Invalid arguments", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+	decode_samples(&_buffer->channels[index].format, buffer->scan_size,
+		       scans, nscans, out);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_adc_buffer_convert_to_mv(adc_buffer_t *buffer, unsigned int index,
+				 const void *scans, unsigned int nscans,
+				 float *out)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+	adc_buffer_channel_t *ch;
+	int raw[CONVERT_CHUNK];
+	unsigned int done, n;
+
+	if (buffer == NULL || scans == NULL || out == NULL ||
+	    index >= buffer->num_channels) {
+		log_error("%s: Invalid arguments", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+	ch = &_buffer->channels[index];
+	if (ch->scale <= 0) {
+		log_error("%s: Unknown scale for channel %u", __func__,
+			  ch->channel);
+		return EXIT_FAILURE;
+	}
+
+	for (done = 0; done < nscans; done += n) {
+		n = nscans - done;
+		if (n > CONVERT_CHUNK)
+			n = CONVERT_CHUNK;
+
+		decode_samples(&ch->format, buffer->scan_size,
+			       (const uint8_t *)scans + (size_t)done * buffer->scan_size,
+			       n, raw);
+		adc_convert_to_mv(raw, out + done, n, ch->offset, ch->scale);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int64_t ldx_adc_buffer_get_timestamp(adc_buffer_t *buffer, const void *scan)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+	uint64_t ts;
+
+	if (buffer == NULL || scan == NULL)
+		return -1;
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+	if (!_buffer->timestamp || _buffer->ts_format.storagebits != 64)
+		return -1;
+
+	memcpy(&ts, (const uint8_t *)scan + _buffer->ts_format.offset, sizeof(ts));
+
+	return _buffer->ts_format.is_be ? be64toh(ts) : le64toh(ts);
+}
+
+int ldx_adc_buffer_get_scan_timestamp(adc_buffer_t *buffer, const void *scan,
+				      ldx_timestamp_t *ts)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+	int64_t ns;
+
+	if (ts == NULL)
+		return EXIT_FAILURE;
+
+	ns = ldx_adc_buffer_get_timestamp(buffer, scan);
+	if (ns < 0)
+		return EXIT_FAILURE;
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+	if (_buffer->ts_monotonic) {
+		ts->ns = ns;
+		ts->hw_ns = 0;
+		ts->source = LDX_TIMESTAMP_SRC_KERNEL;
+	} else {
+		timestamp_from_realtime(ts, ns, timestamp_realtime_offset(),
+					LDX_TIMESTAMP_SRC_KERNEL);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_adc_buffer_stop(adc_buffer_t *buffer)
+{
+	adc_buffer_internal_t *_buffer = NULL;
+	int ret = EXIT_SUCCESS;
+
+	if (buffer == NULL)
+		return EXIT_SUCCESS;
+
+	_buffer = (adc_buffer_internal_t *) buffer->_data;
+
+	log_debug("%s: Stopping buffered capture on ADC chip: %u", __func__,
+		  buffer->chip);
+
+	if (set_buffer_attr(buffer->chip, "enable", 0) != EXIT_SUCCESS) {
+		log_error("%s: Unable to disable the buffer of ADC chip %u",
+			  __func__, buffer->chip);
+		ret = EXIT_FAILURE;
+	}
+
+	if (close(_buffer->dev_fd) < 0) {
+		log_error("%s: Error closing the ADC device", __func__);
+		ret = EXIT_FAILURE;
+	}
+
+	if (release_trigger(buffer->chip, _buffer) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+
+	if (disable_scan_elements(buffer->chip) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+
+	if (restore_clock(buffer->chip, _buffer) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+
+	free(_buffer->channels);
+	free(_buffer);
+	free(buffer);
+
+	return ret;
+}
@@ -22,6 +22,7 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include "_ctl_socket.h"
 #include "_log.h"
 #include "bluetooth.h"
 
@@ -47,7 +48,10 @@ static const char* bt_state_error_descs[] = {
  */
 static bt_state_error_t get_hci_dev_info(uint16_t dev_id, struct hci_dev_info *dev_info)
 {
-	if (hci_devinfo(dev_id, dev_info) < 0) {
+	int sock = ctl_socket_get(CTL_SOCKET_HCI);
+
+	dev_info->dev_id = dev_id;
+	if (sock < 0 || ioctl(sock, HCIGETDEVINFO, dev_info) < 0) {
 		bt_state_error_t ret = BT_STATE_ERROR_HCI_INFO;
 		log_debug("%s: %s of '%d': %s (%d)", __func__,
 			  ldx_bt_code_to_str(ret), dev_id, strerror(errno), errno);
@@ -127,7 +131,7 @@ int ldx_bt_list_available_devices(uint16_t **ids)
 	struct hci_dev_req *dev_req = NULL;
 	int i, sock, n_dev = -1;
 
-	sock = socket(AF_BLUETOOTH, SOCK_RAW | SOCK_CLOEXEC, BTPROTO_HCI);
+	sock = ctl_socket_get(CTL_SOCKET_HCI);
 	if (sock < 0) {
 		log_error("%s: Unable to get Bluetooth interfaces: %s (%d)",
 			  __func__, strerror(errno), errno);
@@ -138,7 +142,7 @@ int ldx_bt_list_available_devices(uint16_t **ids)
 	if (dev_list == NULL) {
 		log_error("%s: Unable to get Bluetooth interfaces: Out of memory",
 			  __func__);
-		goto done;
+		return -1;
 	}
 
 	memset(dev_list, 0, HCI_MAX_DEV * sizeof(*dev_req) + sizeof(*dev_list));
@@ -168,8 +172,6 @@ int ldx_bt_list_available_devices(uint16_t **ids)
 
 free:
 	free(dev_list);
-done:
-	close(sock);
 
 	return n_dev;
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "_bus_sched.h"
+#include "_log.h"
+
+static LIST_HEAD(schedulers);
+static pthread_mutex_t schedulers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+bus_sched_t *bus_sched_get(bus_type_t type, unsigned int bus)
+{
+	bus_sched_t *sched;
+	int i;
+
+	pthread_mutex_lock(&schedulers_lock);
+
+	list_for_each_entry(sched, &schedulers, list) {
+		if (sched->type == type && sched->bus == bus) {
+			sched->refs++;
+			pthread_mutex_unlock(&schedulers_lock);
+			return sched;
+		}
+	}
+
+	sched = calloc(1, sizeof(bus_sched_t));
+	if (sched == NULL) {
+		pthread_mutex_unlock(&schedulers_lock);
+		log_error("%s: Unable to create the scheduler of bus %u, cannot allocate memory",
+			  __func__, bus);
+		return NULL;
+	}
+
+	sched->type = type;
+	sched->bus = bus;
+	sched->refs = 1;
+	sched->granted = -1;
+	pthread_mutex_init(&sched->lock, NULL);
+	for (i = 0; i < BUS_PRIO_COUNT; i++)
+		pthread_cond_init(&sched->cond[i], NULL);
+	list_add_tail(&sched->list, &schedulers);
+
+	pthread_mutex_unlock(&schedulers_lock);
+
+	return sched;
+}
+
+void bus_sched_put(bus_sched_t *sched)
+{
+	int i;
+
+	if (sched == NULL)
+		return;
+
+	pthread_mutex_lock(&schedulers_lock);
+
+	if (--sched->refs > 0) {
+		pthread_mutex_unlock(&schedulers_lock);
+		return;
+	}
+
+	list_del(&sched->list);
+	pthread_mutex_unlock(&schedulers_lock);
+
+	for (i = 0; i < BUS_PRIO_COUNT; i++)
+		pthread_cond_destroy(&sched->cond[i]);
+	pthread_mutex_destroy(&sched->lock);
+	free(sched);
+}
+
+void bus_sched_acquire(bus_sched_t *sched, bus_prio_t prio)
+{
+	uint64_t ticket;
+
+	if (prio < 0 || prio >= BUS_PRIO_COUNT)
+		prio = BUS_PRIO_NORMAL;
+
+	pthread_mutex_lock(&sched->lock);
+
+	/* Nested acquisition by the owner */
+	if (sched->busy && sched->granted < 0 &&
+	    pthread_equal(sched->owner, pthread_self())) {
+		sched->depth++;
+		pthread_mutex_unlock(&sched->lock);
+		return;
+	}
+
+	/* The bus is only free when nobody is waiting for it */
+	if (!sched->busy) {
+		sched->busy = true;
+		sched->owner = pthread_self();
+		sched->depth = 1;
+		pthread_mutex_unlock(&sched->lock);
+		return;
+	}
+
+	ticket = sched->next_ticket[prio]++;
+	sched->waiting[prio]++;
+	while (sched->granted != (int)prio || sched->serving[prio] != ticket)
+		pthread_cond_wait(&sched->cond[prio], &sched->lock);
+
+	sched->serving[prio]++;
+	sched->waiting[prio]--;
+	sched->granted = -1;
+	sched->owner = pthread_self();
+	sched->depth = 1;
+
+	pthread_mutex_unlock(&sched->lock);
+}
+
+/**
+ * pick_next_class() - Choose the class the bus is granted to
+ *
+ * @sched:	The scheduler, with its lock held.
+ *
+ * The highest class with waiters is chosen, unless a lower class with
+ * waiters has already been skipped LDX_BUS_SCHED_BATCH times.
+ *
+ * Return: The chosen class, -1 if nobody is waiting.
+ */
+static int pick_next_class(bus_sched_t *sched)
+{
+	int highest = -1, chosen, i;
+
+	for (i = 0; i < BUS_PRIO_COUNT; i++) {
+		if (sched->waiting[i] > 0) {
+			highest = i;
+			break;
+		}
+	}
+
+	if (highest < 0)
+		return -1;
+
+	chosen = highest;
+	for (i = highest + 1; i < BUS_PRIO_COUNT; i++) {
+		if (sched->waiting[i] > 0 &&
+		    sched->skipped[i] >= LDX_BUS_SCHED_BATCH) {
+			chosen = i;
+			break;
+		}
+	}
+
+	for (i = chosen + 1; i < BUS_PRIO_COUNT; i++) {
+		if (sched->waiting[i] > 0)
+			sched->skipped[i]++;
+	}
+	sched->skipped[chosen] = 0;
+
+	return chosen;
+}
+
+int bus_sched_release(bus_sched_t *sched)
+{
+	int next;
+
+	pthread_mutex_lock(&sched->lock);
+
+	if (!sched->busy || sched->granted >= 0 ||
+	    !pthread_equal(sched->owner, pthread_self())) {
+		pthread_mutex_unlock(&sched->lock);
+		log_error("%s: The bus %u is not held by this thread", __func__,
+			  sched->bus);
+		return EXIT_FAILURE;
+	}
+
+	if (--sched->depth > 0) {
+		pthread_mutex_unlock(&sched->lock);
+		return EXIT_SUCCESS;
+	}
+
+	next = pick_next_class(sched);
+	if (next < 0) {
+		sched->busy = false;
+	} else {
+		/* Hand the bus over, so no newcomer can take it in between */
+		sched->granted = next;
+		pthread_cond_broadcast(&sched->cond[next]);
+	}
+
+	pthread_mutex_unlock(&sched->lock);
+
+	return EXIT_SUCCESS;
+}
@@ -23,12 +23,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
 #include "can.h"
 #include "_can.h"
 #include "_log.h"
+#include "_stats.h"
+#include "_trace.h"
+
+/* Maximum number of ready descriptors served per epoll_wait() call */
+#define LDX_CAN_MAX_EVENTS		16
 
 /* map the sanitized data length to an appropriate data length code */
 #define CAN_LEN2DLC(len)		len > 64 ? 0xF : len2dlc[len]
@@ -96,6 +103,25 @@ const char *const __can_error_str[CAN_ERROR_MAX + 1] = {
 	[CAN_ERROR_GETSKTOPT_RCVBUF]	= "getsocketopt SO_RCVBUF error",
 
 	[CAN_ERROR_DROPPED_FRAMES]		= "Dropped frames",
+
+	[CAN_ERROR_EPOLL_CREATE]		= "epoll create error",
+	[CAN_ERROR_EPOLL_CTL]		= "epoll_ctl error",
+	[CAN_ERROR_EVENTFD_CREATE]	= "eventfd create error",
+	[CAN_ERROR_REACTOR_ADD]		= "Unable to attach to the reactor",
+
+	[CAN_ERROR_RX_CB_MAX]		= "Too many rx handlers on the shared socket",
+
+	[CAN_ERROR_RX_QUEUE_DISABLED]	= "Rx queue not enabled",
+	[CAN_ERROR_RX_QUEUE_WAIT]	= "Error waiting for rx queue frames",
+	[CAN_ERROR_RX_QUEUE_LEN]	= "Invalid rx queue length",
+
+	[CAN_ERROR_CAPTURE_RUNNING]	= "Capture already running",
+	[CAN_ERROR_CAPTURE_DISABLED]	= "Capture not running",
+	[CAN_ERROR_CAPTURE_FILE]	= "Capture file error",
+	[CAN_ERROR_CAPTURE_FORMAT]	= "Invalid capture file",
+
+	[CAN_ERROR_NULL_FRAME]		= "CAN frame is NULL",
+	[CAN_ERROR_INVALID_NFRAMES]	= "Invalid number of frames",
 };
 
 /* Default error handler, used to log information */
@@ -113,7 +139,7 @@ const char * ldx_can_strerror(int error)
 {
 	const char *err_string = NULL;
 
-	if (error > 0 && error < CAN_ERROR_MAX)
+	if (error > 0 && error <= CAN_ERROR_MAX)
 		err_string = __can_error_str[error];
 
 	return err_string;
@@ -125,6 +151,8 @@ void ldx_can_set_defconfig(can_if_cfg_t *cfg)
 	cfg->canfd_enabled	= false;
 	cfg->process_header	= true;
 	cfg->hw_timestamp	= false;
+	cfg->shared_rx_skt	= false;
+	cfg->rx_queue_len	= 0;
 	cfg->bitrate		= LDX_CAN_INVALID_BITRATE;
 	cfg->dbitrate		= LDX_CAN_INVALID_BITRATE;
 	cfg->restart_ms		= LDX_CAN_INVALID_RESTART_MS;
@@ -137,10 +165,12 @@ void ldx_can_set_defconfig(can_if_cfg_t *cfg)
 				  CAN_ERR_RESTARTED;
 }
 
-static void process_can_process_msgheader(struct msghdr *msg, struct timeval *tv, uint32_t *df)
+static void process_can_process_msgheader(struct msghdr *msg, struct timespec *ts,
+					  struct timespec *sw, uint32_t *df)
 {
 	struct cmsghdr *cmsg;
 	struct timespec *stamp;
+	struct timeval tv;
 
 	for (cmsg = CMSG_FIRSTHDR(msg);
 		 cmsg && (cmsg->cmsg_level == SOL_SOCKET);
@@ -152,7 +182,15 @@ static void process_can_process_msgheader(struct msghdr *msg, struct timeval *tv
 			break;
 
 		case SO_TIMESTAMP:
-			memcpy(tv, CMSG_DATA(cmsg), sizeof(*tv));
+			memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+			ts->tv_sec = tv.tv_sec;
+			ts->tv_nsec = tv.tv_usec * 1000;
+			*sw = *ts;
+			break;
+
+		case SO_TIMESTAMPNS:
+			memcpy(ts, CMSG_DATA(cmsg), sizeof(*ts));
+			*sw = *ts;
 			break;
 
 		case SO_TIMESTAMPING:
@@ -162,10 +200,16 @@ static void process_can_process_msgheader(struct msghdr *msg, struct timeval *tv
 			 * stamp[2] is the raw hardware timestamp
 			 * See chapter 2.1.2 Receive timestamps in
 			 * linux/Documentation/networking/timestamping.txt
+			 *
+			 * Fall back to the software one when the controller
+			 * does not provide hardware timestamps.
 			 */
 			stamp = (struct timespec *)CMSG_DATA(cmsg);
-			tv->tv_sec = stamp[2].tv_sec;
-			tv->tv_usec = stamp[2].tv_nsec / 1000;
+			if (stamp[2].tv_sec || stamp[2].tv_nsec)
+				*ts = stamp[2];
+			else
+				*ts = stamp[0];
+			*sw = stamp[0];
 			break;
 
 		default:
@@ -174,15 +218,77 @@ static void process_can_process_msgheader(struct msghdr *msg, struct timeval *tv
 	}
 }
 
+/*
+ * Call the error handlers of the interface. They are called on a copy of the
+ * list taken with the mutex held, so they can register or remove handlers.
+ */
 static void ldx_can_call_err_cb(const can_if_t *cif, int error, void *data)
 {
 	can_priv_t *pdata = cif->_data;
 	can_err_cb_t *err_cb;
+	ldx_can_error_cb_t *handlers;
+	int i, n = 0;
 
-	list_for_each_entry(err_cb, &pdata->err_cb_list_head, list) {
-		if (err_cb->handler)
-			err_cb->handler(error, data);
+	pthread_mutex_lock(&pdata->mutex);
+	list_for_each_entry(err_cb, &pdata->err_cb_list_head, list)
+		n++;
+
+	handlers = n ? calloc(n, sizeof(*handlers)) : NULL;
+	if (!handlers) {
+		pthread_mutex_unlock(&pdata->mutex);
+		if (n)
+			log_error("%s: Unable to alloc memory for error callbacks on %s",
+				  __func__, cif->name);
+		return;
+	}
+
+	n = 0;
+	list_for_each_entry(err_cb, &pdata->err_cb_list_head, list)
+		handlers[n++] = err_cb->handler;
+	pthread_mutex_unlock(&pdata->mutex);
+
+	for (i = 0; i < n; i++) {
+		if (handlers[i])
+			handlers[i](error, data);
+	}
+
+	free(handlers);
+}
+
+/* Wake up the working thread so it reconsiders its state */
+static void ldx_can_wake_thr(can_priv_t *pdata)
+{
+	uint64_t val = 1;
+
+	if (write(pdata->evfd, &val, sizeof(val)) < 0)
+		log_debug("%s: eventfd write error (%d)", __func__, errno);
+}
+
+/*
+ * Release the rx callbacks removed from the epoll set and the replaced
+ * filter tables of the shared socket. Must be called
+ * with the mutex held, from a context where no callback can be running.
+ */
+static void ldx_can_reap_rx_cbs(can_priv_t *pdata)
+{
+	can_cb_t *rx_cb, *rx_cb_tmp;
+	can_filter_table_t *table, *table_tmp;
+
+	list_for_each_entry_safe(rx_cb, rx_cb_tmp, &pdata->rx_cb_free_list_head, list) {
+		if (rx_cb->rx_skt >= 0)
+			close(rx_cb->rx_skt);
+		list_del(&rx_cb->list);
+		free(rx_cb->filters);
+		free(rx_cb);
+	}
+
+	list_for_each_entry_safe(table, table_tmp, &pdata->ftable_free_list_head, list) {
+		list_del(&table->list);
+		can_filter_table_free(table);
 	}
+
+	pdata->reap_seq++;
+	pthread_cond_broadcast(&pdata->reap_cond);
 }
 
 static int ldx_can_process_tx_socket(const can_if_t *cif)
@@ -231,234 +337,689 @@ static int ldx_can_process_tx_socket(const can_if_t *cif)
 	return ret;
 }
 
-static int ldx_can_process_rx_socket(can_if_t *cif, can_cb_t *rx_cb)
+static void ldx_can_init_rx_ring(can_rx_ring_t *ring)
+{
+	int i;
+
+	for (i = 0; i < LDX_CAN_BATCH_LEN; i++) {
+		ring->iov[i].iov_base = &ring->frames[i];
+		ring->iov[i].iov_len = sizeof(ring->frames[i]);
+
+		ring->msgs[i].msg_hdr.msg_name = &ring->addr[i];
+		ring->msgs[i].msg_hdr.msg_iov = &ring->iov[i];
+		ring->msgs[i].msg_hdr.msg_iovlen = 1;
+		ring->msgs[i].msg_hdr.msg_control = ring->ctrlmsg[i];
+	}
+}
+
+/*
+ * Deliver the frames received on the shared socket to the handlers that
+ * accept them, according to the current filter table.
+ */
+static void ldx_can_dispatch_shared(can_if_t *cif, int nmsgs)
 {
 	can_priv_t *pdata = cif->_data;
-	struct timeval tstamp;
-	struct msghdr msg;
-	struct canfd_frame frame;
-	struct iovec iov;
-	char ctrlmsg[CMSG_SPACE(sizeof(struct timeval) + 3 *sizeof(struct timespec) + sizeof(__u32))];
-	int ret = EXIT_SUCCESS, nbytes;
-	bool done = false;
+	can_rx_ring_t *ring = &pdata->rx_ring;
+	can_filter_table_t *table;
+	uint64_t pending = 0, bits;
+	int i, slot;
 
-	/* Lets do some initializations out of the main loop... */
-	iov.iov_base = &frame;
-	iov.iov_len = sizeof(frame);
+	table = __atomic_load_n(&pdata->ftable, __ATOMIC_ACQUIRE);
+	if (!table)
+		return;
 
-	msg.msg_name = &pdata->addr;
-	msg.msg_iov = &iov;
-	msg.msg_iovlen = 1;
-	msg.msg_control = &ctrlmsg;
-	msg.msg_namelen = sizeof(struct sockaddr_can);
-	msg.msg_controllen = sizeof(ctrlmsg);
-	msg.msg_flags = 0;
+	for (i = 0; i < nmsgs; i++) {
+		ring->match[i] = can_filter_table_lookup(table, ring->frames[i].can_id);
+		pending |= ring->match[i] & table->batch_mask;
 
-	while (!done) {
-		nbytes = recvmsg(rx_cb->rx_skt, &msg, 0);
-		if (nbytes < 0) {
-			if (errno == ENETDOWN) {
-				log_error("%s: CAN network is down", __func__);
-				ret = -CAN_ERROR_NETWORK_DOWN;
-			}
-			return ret;
-		}
+		for (bits = ring->match[i] & ~table->batch_mask; bits; bits &= bits - 1) {
+			can_cb_t *rx_cb;
 
-		if (nbytes == 0) {
-			done = true;
-			continue;
+			slot = __builtin_ctzll(bits);
+			rx_cb = table->handlers[slot];
+			rx_cb->stats.frames++;
+			rx_cb->stats.last_tstamp = ring->tstamp_ns[i];
+			rx_cb->handler(&ring->frames[i], &ring->tstamp[i]);
 		}
+	}
 
-		if(cif->cfg.process_header) {
-			uint32_t dropf = 0;
+	for (; pending; pending &= pending - 1) {
+		can_cb_t *rx_cb;
+		uint64_t bit;
+		int n = 0, last = 0;
 
-			process_can_process_msgheader(&msg, &tstamp, &dropf);
-			if (dropf) {
-				log_error("%s: CAN frames dropped", __func__);
-				cif->dropped_frames = dropf;
-				ldx_can_call_err_cb(cif, CAN_ERROR_DROPPED_FRAMES, NULL);
+		slot = __builtin_ctzll(pending);
+		bit = 1ULL << slot;
+		rx_cb = table->handlers[slot];
+
+		for (i = 0; i < nmsgs; i++) {
+			if (ring->match[i] & bit) {
+				n++;
+				last = i;
 			}
 		}
 
-		if (frame.can_id & CAN_ERR_FLAG) {
-			log_error("%s: CAN frame error", __func__);
-			ldx_can_call_err_cb(cif, frame.can_id, NULL);
+		rx_cb->stats.frames += n;
+		rx_cb->stats.last_tstamp = ring->tstamp_ns[last];
+
+		/* Avoid the copy when the handler accepts the whole batch */
+		if (n == nmsgs) {
+			rx_cb->batch_handler(ring->frames, ring->tstamp, nmsgs);
+			continue;
+		}
+
+		for (i = 0, n = 0; i < nmsgs; i++) {
+			if (!(ring->match[i] & bit))
+				continue;
+			ring->batch_frames[n] = ring->frames[i];
+			ring->batch_tstamp[n] = ring->tstamp[i];
+			n++;
 		}
+		rx_cb->batch_handler(ring->batch_frames, ring->batch_tstamp, n);
+	}
+}
 
-		if (rx_cb->handler)
-			rx_cb->handler(&frame, &tstamp);
+/*
+ * Move the kernel timestamps of a batch to the CLOCK_MONOTONIC time base of
+ * 'ldx_timestamp_t', keeping the raw hardware ones.
+ */
+static void ldx_can_fill_timestamps(const can_if_t *cif, can_rx_ring_t *ring,
+				    int nmsgs)
+{
+	int64_t offset;
+	int i;
+
+	if (!cif->cfg.process_header) {
+		ldx_timestamp_now(&ring->ts[0]);
+		for (i = 1; i < nmsgs; i++)
+			ring->ts[i] = ring->ts[0];
+		return;
 	}
 
-	return ret;
+	offset = timestamp_realtime_offset();
+	for (i = 0; i < nmsgs; i++) {
+		const struct timespec *hw = &ring->tstamp_ns[i];
+		const struct timespec *sw = &ring->tstamp_sw[i];
+
+		timestamp_from_realtime(&ring->ts[i], timestamp_timespec_ns(sw),
+					offset, LDX_TIMESTAMP_SRC_KERNEL);
+		if (hw->tv_sec != sw->tv_sec || hw->tv_nsec != sw->tv_nsec) {
+			ring->ts[i].hw_ns = timestamp_timespec_ns(hw);
+			ring->ts[i].source = LDX_TIMESTAMP_SRC_HARDWARE;
+		}
+	}
 }
 
-static void *ldx_can_thr(void *arg)
+static int ldx_can_process_rx_socket(can_if_t *cif, can_cb_t *rx_cb)
 {
-	can_if_t *cif = (can_if_t *)arg;
 	can_priv_t *pdata = cif->_data;
-	int ret;
+	can_rx_ring_t *ring = &pdata->rx_ring;
+	int ret = EXIT_SUCCESS, nmsgs, i;
+	bool done = false;
 
-	while (pdata->run_thr) {
-		fd_set fds;
-		struct timeval tout;
+	while (!done) {
+		/* The kernel updates these lengths on every reception */
+		for (i = 0; i < LDX_CAN_BATCH_LEN; i++) {
+			ring->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_can);
+			ring->msgs[i].msg_hdr.msg_controllen = CAN_CTRLMSG_LEN;
+			ring->msgs[i].msg_hdr.msg_flags = 0;
+		}
 
-		pthread_mutex_lock(&pdata->mutex);
+		nmsgs = recvmmsg(rx_cb->rx_skt, ring->msgs, LDX_CAN_BATCH_LEN,
+				 MSG_DONTWAIT, NULL);
+		if (nmsgs < 0) {
+			if (errno == ENETDOWN) {
+				log_error("%s: CAN network is down", __func__);
+				ret = -CAN_ERROR_NETWORK_DOWN;
+			}
+			return ret;
+		}
 
-		memcpy(&fds, &pdata->can_fds, sizeof(fds));
-		memcpy(&tout, &pdata->can_tout, sizeof(tout));
+		/* A short batch means the socket queue is already empty */
+		if (nmsgs < LDX_CAN_BATCH_LEN)
+			done = true;
 
-		ret = select(pdata->maxfd + 1, &fds, NULL, NULL, &tout);
-		if (ret < 0 && errno != EINTR) {
-			log_error("%s|%s: select error (%d|%d)",
-					  cif->name, __func__, ret, errno);
-			ldx_can_call_err_cb(cif, errno, NULL);
-		} else if (ret > 0) {
-			can_cb_t *rx_cb;
+		if (nmsgs > 0) {
+			trace_can_rx_begin(cif->name, nmsgs);
+			rx_cb->stats.reads++;
+			rx_cb->stats.frames += nmsgs;
+			if ((unsigned int)nmsgs > rx_cb->stats.max_batch)
+				rx_cb->stats.max_batch = nmsgs;
+		}
 
-			/*
-			 * Check the socket for each registered rx handler and
-			 * trigger the callback acordingly
-			 */
-			list_for_each_entry(rx_cb, &pdata->rx_cb_list_head, list) {
-				if (FD_ISSET(rx_cb->rx_skt, &fds)) {
-					ret = ldx_can_process_rx_socket(cif, rx_cb);
-					if (ret) {
-						log_error("%s|%s: select error (%d|%d)",
-								  cif->name, __func__, ret, errno);
-					}
+		for (i = 0; i < nmsgs; i++) {
+			struct canfd_frame *frame = &ring->frames[i];
+
+			if (cif->cfg.process_header) {
+				uint32_t dropf = 0;
+
+				process_can_process_msgheader(&ring->msgs[i].msg_hdr,
+							      &ring->tstamp_ns[i],
+							      &ring->tstamp_sw[i], &dropf);
+				ring->tstamp[i].tv_sec = ring->tstamp_ns[i].tv_sec;
+				ring->tstamp[i].tv_usec = ring->tstamp_ns[i].tv_nsec / 1000;
+
+				/* The kernel reports the total drops of the socket */
+				if (dropf != rx_cb->stats.dropped) {
+					log_error("%s: %u CAN frames dropped", __func__,
+						  dropf - rx_cb->stats.dropped);
+					rx_cb->stats.dropped = dropf;
+					cif->dropped_frames = dropf;
+					ldx_can_call_err_cb(cif, CAN_ERROR_DROPPED_FRAMES, NULL);
 				}
 			}
 
-			/* Check also the tx socket to detect errors */
-			if (FD_ISSET(pdata->tx_skt, &fds)) {
-				ret = ldx_can_process_tx_socket(cif);
-				if (ret)
-					log_error("%s|%s: select error (%d|%d)",
-							  cif->name, __func__, ret, errno);
+			if (frame->can_id & CAN_ERR_FLAG) {
+				log_error("%s: CAN frame error", __func__);
+				ldx_can_call_err_cb(cif, frame->can_id, NULL);
 			}
+
+			if (rx_cb->handler)
+				rx_cb->handler(frame, &ring->tstamp[i]);
 		}
 
-		pthread_mutex_unlock(&pdata->mutex);
+		if (nmsgs > 0)
+			rx_cb->stats.last_tstamp = ring->tstamp_ns[nmsgs - 1];
+
+		if (rx_cb->batch_handler && nmsgs > 0)
+			rx_cb->batch_handler(ring->frames, ring->tstamp, nmsgs);
 
-		sched_yield();
+		if (rx_cb->ts_handler && nmsgs > 0) {
+			ldx_can_fill_timestamps(cif, ring, nmsgs);
+			rx_cb->ts_handler(ring->frames, ring->ts, nmsgs, rx_cb->arg);
+		}
+
+		if (rx_cb == pdata->shared_rx && nmsgs > 0)
+			ldx_can_dispatch_shared(cif, nmsgs);
+
+		if (rx_cb == pdata->queue_rx && nmsgs > 0)
+			can_rx_queue_push(pdata->rx_queue, ring->frames,
+					  ring->tstamp, nmsgs);
+
+		if (rx_cb == pdata->capture_rx && nmsgs > 0) {
+			can_capture_t *cap = __atomic_load_n(&pdata->capture,
+							     __ATOMIC_ACQUIRE);
+
+			/* Without headers there are only reception times */
+			if (cap)
+				can_capture_write(cap, ring->frames,
+						  cif->cfg.process_header ?
+						  ring->tstamp_sw : NULL,
+						  cap->flags & LDX_CAN_CAPTURE_FLAG_HW_TSTAMP ?
+						  ring->tstamp_ns : NULL, nmsgs);
+		}
+
+		if (nmsgs > 0)
+			trace_can_rx_end(cif->name, nmsgs);
 	}
-	return NULL;
+
+	return ret;
 }
 
-int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
+/*
+ * Wait up to tout_ms for events on the interface sockets and dispatch them.
+ * Used both by the working thread and by the reactor callback.
+ */
+static void ldx_can_process_events(can_if_t *cif, int tout_ms)
 {
-	int ret = 0;
-	can_priv_t *pdata = NULL;
+	can_priv_t *pdata = cif->_data;
+	struct epoll_event events[LDX_CAN_MAX_EVENTS];
+	int ret, nfds, i;
 
-	if (!cif)
-		return -CAN_ERROR_NULL_INTERFACE;
+	pthread_mutex_lock(&pdata->mutex);
+	pdata->in_dispatch = true;
+	pdata->dispatch_thr = pthread_self();
+	pthread_mutex_unlock(&pdata->mutex);
 
-	pdata = cif->_data;
-	cif->cfg = *cfg;
+	nfds = epoll_wait(pdata->epfd, events, LDX_CAN_MAX_EVENTS, tout_ms);
+	if (nfds < 0 && errno != EINTR) {
+		log_error("%s|%s: epoll_wait error (%d|%d)",
+			  cif->name, __func__, nfds, errno);
+		ldx_can_call_err_cb(cif, errno, NULL);
+	}
 
-	/* Set bitrate if required */
-	if (cfg->bitrate != LDX_CAN_INVALID_BITRATE) {
-		ret = ldx_can_set_bitrate(cif, cfg->bitrate);
-		if (ret)
-			return ret;
+	for (i = 0; i < nfds; i++) {
+		void *ptr = events[i].data.ptr;
 
-		cif->cfg.bitrate = cfg->bitrate;
-	}
+		if (ptr == &pdata->evfd) {
+			uint64_t val;
 
-	/* Set data bitrate if required */
-	if (cfg->dbitrate != LDX_CAN_INVALID_BITRATE) {
-		ret = ldx_can_set_data_bitrate(cif, cfg->dbitrate);
-		if (ret)
-			return ret;
+			/* Handlers were removed or the thread must stop */
+			if (read(pdata->evfd, &val, sizeof(val)) < 0)
+				log_debug("%s: eventfd read error (%d)",
+					  __func__, errno);
+		} else if (ptr == &pdata->tx_skt) {
+			/* Check also the tx socket to detect errors */
+			ret = ldx_can_process_tx_socket(cif);
+			if (ret)
+				log_error("%s|%s: tx socket error (%d|%d)",
+					  cif->name, __func__, ret, errno);
+		} else if (ptr == &pdata->capture) {
+			can_capture_t *cap = __atomic_load_n(&pdata->capture,
+							     __ATOMIC_ACQUIRE);
 
-		cif->cfg.bitrate = cfg->bitrate;
+			/* Periodic write back of the captured frames */
+			if (cap)
+				can_capture_flush(cap);
+		} else {
+			ret = ldx_can_process_rx_socket(cif, ptr);
+			if (ret)
+				log_error("%s|%s: rx socket error (%d|%d)",
+					  cif->name, __func__, ret, errno);
+		}
 	}
 
-	/* Set restart ms if required */
-	if (cfg->restart_ms != LDX_CAN_INVALID_RESTART_MS) {
-		ret = ldx_can_set_restart_ms(cif, cfg->restart_ms);
-		if (ret)
-			return ret;
+	/*
+	 * Removed handlers can still be referenced by the events of this
+	 * iteration, so they are only released once it is over.
+	 */
+	pthread_mutex_lock(&pdata->mutex);
+	if (!list_empty(&pdata->rx_cb_free_list_head) ||
+	    !list_empty(&pdata->ftable_free_list_head) || pdata->reap_waiters)
+		ldx_can_reap_rx_cbs(pdata);
+	pdata->in_dispatch = false;
+	pthread_mutex_unlock(&pdata->mutex);
+}
 
-		cif->cfg.restart_ms = cfg->restart_ms;
-	}
+static void *ldx_can_thr(void *arg)
+{
+	can_if_t *cif = (can_if_t *)arg;
+	can_priv_t *pdata = cif->_data;
+	int tout_ms = pdata->can_tout.tv_sec * 1000 + pdata->can_tout.tv_usec / 1000;
 
-	/* Configure the bit_timing setting */
-	if (cfg->bit_timing.bitrate) {
-		ret = ldx_can_set_restart_ms(cif, cfg->restart_ms);
-		if (ret)
-			return ret;
+	while (pdata->run_thr)
+		ldx_can_process_events(cif, tout_ms);
 
-		cif->cfg.restart_ms = cfg->restart_ms;
-	}
+	return NULL;
+}
 
-	/* Configure the control mode setting */
-	if (cfg->ctrl_mode.mask != LDX_CAN_UNCONFIGURED_MASK) {
-		ret = ldx_can_set_ctrlmode(cif, &cfg->ctrl_mode);
-		if (ret)
-			return ret;
+/* Reactor callback, the interface epoll instance has ready sockets */
+static void ldx_can_reactor_cb(int fd, uint32_t events, void *arg)
+{
+	ldx_can_process_events(arg, 0);
+}
 
-		cif->cfg.ctrl_mode = cfg->ctrl_mode;
-	}
+/* Add a descriptor to the epoll set of the working thread */
+static int ldx_can_epoll_add(can_priv_t *pdata, int fd, void *ptr)
+{
+	struct epoll_event ev;
 
-	/* Once configured, start the interface */
-	ret = ldx_can_start(cif);
-	if (ret)
-		return ret;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = ptr;
 
-	pdata->tx_skt = socket(PF_CAN, SOCK_RAW, CAN_RAW);
-	if (pdata->tx_skt < 0) {
-		log_error("%s: Unable to create socket", __func__);
-		return -CAN_ERROR_TX_SKT_CREATE;
-	}
+	return epoll_ctl(pdata->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
 
-	strncpy(pdata->ifr.ifr_name, cif->name, IFNAMSIZ - 1);
-	pdata->ifr.ifr_name[IFNAMSIZ - 1] = 0;
-	pdata->ifr.ifr_ifindex = if_nametoindex(pdata->ifr.ifr_name);
-	if (!pdata->ifr.ifr_ifindex) {
-		log_error("%s: Unable to get interface index on %s",
-			  __func__, cif->name);
-		ret = -CAN_ERROR_IFR_IDX;
-		goto err_skt_close;
-	}
+/*
+ * Create a rx socket bound to the interface with the configuration of
+ * the interface and the given filters.
+ */
+static int ldx_can_open_rx_socket(can_if_t *cif, struct can_filter *filters,
+				  int nfilters, int *skt)
+{
+	can_priv_t *pdata = cif->_data;
+	int ret, fd;
 
-	pdata->addr.can_family = AF_CAN;
-	pdata->addr.can_ifindex = pdata->ifr.ifr_ifindex;
+	fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (fd < 0) {
+		log_error("%s: Unable to create rx socket on %s", __func__,
+			  cif->name);
+		return -CAN_ERROR_RX_SKT_CREATE;
+	}
 
 	/*
 	 * Set the socket as non blocking. Anyway, it does not seem to have any
 	 * real effect setting it as blocking or non blocking.
 	 */
-	ret = fcntl(pdata->tx_skt, F_SETFL, O_NONBLOCK);
+	ret = fcntl(fd, F_SETFL, O_NONBLOCK);
 	if (ret)
-		goto err_skt_close;
+		goto rx_skt_close;
 
-	if (cif->cfg.canfd_enabled) {
-		int canfd_en = 1;
+	if(cif->cfg.process_header) {
+		/*
+		 * For details, check:
+		 * Documentation/networking/timestamping.txt
+		 */
+		int option_name, tstamp_flags, rxq_ovfl = 1;
 
-		ret = ioctl(pdata->tx_skt, SIOCGIFMTU, &pdata->ifr);
-		if (ret < 0) {
-			log_error("%s: error on ioctl SIOCGIFMTU on %s",
-				  __func__, cif->name);
-			ret = -CAN_ERROR_SIOCGIFMTU;
-			goto err_skt_close;
+		if (cif->cfg.hw_timestamp) {
+			option_name = SO_TIMESTAMPING;
+			tstamp_flags = SOF_TIMESTAMPING_SOFTWARE |
+				       SOF_TIMESTAMPING_RX_SOFTWARE |
+				       SOF_TIMESTAMPING_RX_HARDWARE |
+				       SOF_TIMESTAMPING_RAW_HARDWARE;
+		} else {
+			option_name = SO_TIMESTAMPNS;
+			tstamp_flags = 1;
 		}
 
-		if (pdata->ifr.ifr_mtu != CANFD_MTU) {
-			log_error("%s: CAN FD mtu not supported on %s",
-				  __func__, cif->name);
-			ret = CAN_ERROR_NOT_CANFD;
-			goto err_skt_close;
+		ret = setsockopt(fd, SOL_SOCKET, option_name,
+				  &tstamp_flags, sizeof(tstamp_flags));
+		if (ret) {
+			log_info("%s: setsockopt %s not supported",
+				 __func__, cif->cfg.hw_timestamp ?
+				"SO_TIMESTAMPING" : "SO_TIMESTAMPNS");
+			ret = -CAN_ERROR_SETSKTOPT_TIMESTAMP;
+			goto rx_skt_close;
 		}
 
-		ret = setsockopt(pdata->tx_skt, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
-				 &canfd_en, sizeof(canfd_en));
-		if (ret < 0) {
-			log_error("%s: setsockopt CAN_RAW_FD_FRAMES error on %s",
-				  __func__, cif->name);
-			ret = -CAN_ERROR_SETSKTOPT_CANFD;
-			goto err_skt_close;
-		}
+		/* Report the frames dropped because the queue was full */
+		ret = setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL,
+				 &rxq_ovfl, sizeof(rxq_ovfl));
+		if (ret)
+			log_info("%s: setsockopt SO_RXQ_OVFL not supported",
+				 __func__);
+	}
+
+	if (cif->cfg.canfd_enabled) {
+		int canfd_en = 1;
+
+		ret = setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
+				 &canfd_en, sizeof(canfd_en));
+		if (ret < 0) {
+			log_error("%s|%s: setsockopt CAN_RAW_FD_FRAMES error",
+				  cif->name, __func__);
+			ret = -CAN_ERROR_SETSKTOPT_CANFD;
+			goto rx_skt_close;
+		}
+	}
+
+	if (cif->cfg.rx_buf_len) {
+		socklen_t size_rx_buf_len_rd = sizeof(cif->cfg.rx_buf_len_rd);
+
+		/*
+		 * Try first with SO_RCVBUFFORCE which allows to exceed rmem_max limit
+		 * for privileged (CAP_NET_ADMIN) processes.
+		 */
+		ret = setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE,
+				 &cif->cfg.rx_buf_len, sizeof(cif->cfg.rx_buf_len));
+		if (ret < 0) {
+			log_warning("%s|%s: setsockopt SO_RCVBUFFORCE error",
+				   cif->name, __func__);
+			ret = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+					 &cif->cfg.rx_buf_len, sizeof(cif->cfg.rx_buf_len));
+			if (ret < 0) {
+				log_error("%s|%s: setsockopt SO_RCVBUF error",
+					  cif->name, __func__);
+				ret = -CAN_ERROR_SETSKTOPT_RCVBUF;
+				goto rx_skt_close;
+			}
+		}
+
+		ret = getsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+				 &cif->cfg.rx_buf_len_rd, &size_rx_buf_len_rd);
+		if (ret < 0) {
+			log_error("%s|%s: getsockopt SO_RCVBUF error",
+					  cif->name, __func__);
+			ret = -CAN_ERROR_GETSKTOPT_RCVBUF;
+			goto rx_skt_close;
+		}
+	}
+
+	if (cif->cfg.error_mask) {
+		ret = setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER,
+				 &cif->cfg.error_mask,
+				 sizeof(cif->cfg.error_mask));
+		if (ret < 0) {
+			log_error("%s: setsockopt CAN_RAW_ERR_FILTER error on %s",
+				  __func__, cif->name);
+			ret = -CAN_ERROR_SETSKTOPT_ERR_FLT;
+			goto rx_skt_close;
+		}
+	}
+
+	if (nfilters > 0 && filters) {
+		ret = setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER,
+				 filters, nfilters * sizeof(struct can_filter));
+		if (ret) {
+			log_error("%s: setsockopt CAN_RAW_FILTER error (%d) on %s",
+				  __func__, ret, cif->name);
+			ret = -CAN_ERROR_SETSKTOPT_RAW_FLT;
+			goto rx_skt_close;
+		}
+	}
+
+	ret = bind(fd, (struct sockaddr *)&pdata->addr, sizeof(pdata->addr));
+	if (ret < 0) {
+		log_error("%s: socket bind error on %s", __func__, cif->name);
+		ret = -CAN_ERROR_RX_SKT_BIND;
+		goto rx_skt_close;
+	}
+
+	*skt = fd;
+
+	return CAN_ERROR_NONE;
+
+rx_skt_close:
+	close(fd);
+
+	return ret;
+}
+
+/* Set up the rx queue and the socket feeding it */
+static int ldx_can_init_rx_queue(can_if_t *cif)
+{
+	can_priv_t *pdata = cif->_data;
+	can_cb_t *queue_rx;
+	int ret;
+
+	if (cif->cfg.rx_queue_len > LDX_CAN_RX_QUEUE_MAX_LEN) {
+		log_error("%s: Rx queue length %u on %s above the maximum %u",
+			  __func__, cif->cfg.rx_queue_len, cif->name,
+			  LDX_CAN_RX_QUEUE_MAX_LEN);
+		return -CAN_ERROR_RX_QUEUE_LEN;
+	}
+
+	pdata->rx_queue = can_rx_queue_create(cif->cfg.rx_queue_len);
+	if (!pdata->rx_queue)
+		return -CAN_ERROR_NO_MEM;
+
+	queue_rx = calloc(1, sizeof(can_cb_t));
+	if (!queue_rx) {
+		log_error("%s: Unable to alloc memory for rx socket on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_NO_MEM;
+		goto err_queue_free;
+	}
+	queue_rx->slot = -1;
+
+	ret = ldx_can_open_rx_socket(cif, NULL, 0, &queue_rx->rx_skt);
+	if (ret)
+		goto err_cb_free;
+
+	if (ldx_can_epoll_add(pdata, queue_rx->rx_skt, queue_rx)) {
+		log_error("%s: Unable to add rx socket to epoll on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EPOLL_CTL;
+		goto err_skt_close;
+	}
+
+	pdata->queue_rx = queue_rx;
+
+	return CAN_ERROR_NONE;
+
+err_skt_close:
+	close(queue_rx->rx_skt);
+
+err_cb_free:
+	free(queue_rx);
+
+err_queue_free:
+	can_rx_queue_free(pdata->rx_queue);
+	pdata->rx_queue = NULL;
+
+	return ret;
+}
+
+static void ldx_can_free_rx_queue(can_priv_t *pdata)
+{
+	if (pdata->queue_rx) {
+		epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, pdata->queue_rx->rx_skt, NULL);
+		shutdown(pdata->queue_rx->rx_skt, SHUT_RDWR);
+		close(pdata->queue_rx->rx_skt);
+		free(pdata->queue_rx);
+		pdata->queue_rx = NULL;
+	}
+
+	can_rx_queue_free(pdata->rx_queue);
+	pdata->rx_queue = NULL;
+}
+
+static void ldx_can_free_capture(can_priv_t *pdata)
+{
+	if (pdata->capture_rx) {
+		epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, pdata->capture_rx->rx_skt, NULL);
+		shutdown(pdata->capture_rx->rx_skt, SHUT_RDWR);
+		close(pdata->capture_rx->rx_skt);
+		free(pdata->capture_rx);
+		pdata->capture_rx = NULL;
+	}
+
+	if (pdata->capture) {
+		epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, pdata->capture->timer_fd, NULL);
+		can_capture_close(pdata->capture);
+		pdata->capture = NULL;
+	}
+}
+
+int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
+{
+	int ret = 0;
+	can_priv_t *pdata = NULL;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	cif->cfg = *cfg;
+
+	/* Set bitrate if required */
+	if (cfg->bitrate != LDX_CAN_INVALID_BITRATE) {
+		ret = ldx_can_set_bitrate(cif, cfg->bitrate);
+		if (ret)
+			return ret;
+
+		cif->cfg.bitrate = cfg->bitrate;
+	}
+
+	/* Set data bitrate if required */
+	if (cfg->dbitrate != LDX_CAN_INVALID_BITRATE) {
+		ret = ldx_can_set_data_bitrate(cif, cfg->dbitrate);
+		if (ret)
+			return ret;
+
+		cif->cfg.bitrate = cfg->bitrate;
+	}
+
+	/* Set restart ms if required */
+	if (cfg->restart_ms != LDX_CAN_INVALID_RESTART_MS) {
+		ret = ldx_can_set_restart_ms(cif, cfg->restart_ms);
+		if (ret)
+			return ret;
+
+		cif->cfg.restart_ms = cfg->restart_ms;
+	}
+
+	/* Configure the bit_timing setting */
+	if (cfg->bit_timing.bitrate) {
+		ret = ldx_can_set_restart_ms(cif, cfg->restart_ms);
+		if (ret)
+			return ret;
+
+		cif->cfg.restart_ms = cfg->restart_ms;
+	}
+
+	/* Configure the control mode setting */
+	if (cfg->ctrl_mode.mask != LDX_CAN_UNCONFIGURED_MASK) {
+		ret = ldx_can_set_ctrlmode(cif, &cfg->ctrl_mode);
+		if (ret)
+			return ret;
+
+		cif->cfg.ctrl_mode = cfg->ctrl_mode;
+	}
+
+	/* Once configured, start the interface */
+	ret = ldx_can_start(cif);
+	if (ret)
+		return ret;
+
+	pdata->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (pdata->epfd < 0) {
+		log_error("%s: Unable to create epoll instance on %s",
+			  __func__, cif->name);
+		return -CAN_ERROR_EPOLL_CREATE;
+	}
+
+	pdata->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (pdata->evfd < 0) {
+		log_error("%s: Unable to create eventfd on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EVENTFD_CREATE;
+		goto err_epoll_close;
+	}
+
+	if (ldx_can_epoll_add(pdata, pdata->evfd, &pdata->evfd)) {
+		log_error("%s: Unable to add eventfd to epoll on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EPOLL_CTL;
+		goto err_evfd_close;
+	}
+
+	pdata->tx_skt = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (pdata->tx_skt < 0) {
+		log_error("%s: Unable to create socket", __func__);
+		ret = -CAN_ERROR_TX_SKT_CREATE;
+		goto err_evfd_close;
+	}
+
+	strncpy(pdata->ifr.ifr_name, cif->name, IFNAMSIZ - 1);
+	pdata->ifr.ifr_name[IFNAMSIZ - 1] = 0;
+	pdata->ifr.ifr_ifindex = if_nametoindex(pdata->ifr.ifr_name);
+	if (!pdata->ifr.ifr_ifindex) {
+		log_error("%s: Unable to get interface index on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_IFR_IDX;
+		goto err_skt_close;
+	}
+
+	pdata->addr.can_family = AF_CAN;
+	pdata->addr.can_ifindex = pdata->ifr.ifr_ifindex;
+
+	/*
+	 * Set the socket as non blocking. Anyway, it does not seem to have any
+	 * real effect setting it as blocking or non blocking.
+	 */
+	ret = fcntl(pdata->tx_skt, F_SETFL, O_NONBLOCK);
+	if (ret)
+		goto err_skt_close;
+
+	if (cif->cfg.canfd_enabled) {
+		int canfd_en = 1;
+
+		ret = ioctl(pdata->tx_skt, SIOCGIFMTU, &pdata->ifr);
+		if (ret < 0) {
+			log_error("%s: error on ioctl SIOCGIFMTU on %s",
+				  __func__, cif->name);
+			ret = -CAN_ERROR_SIOCGIFMTU;
+			goto err_skt_close;
+		}
+
+		if (pdata->ifr.ifr_mtu != CANFD_MTU) {
+			log_error("%s: CAN FD mtu not supported on %s",
+				  __func__, cif->name);
+			ret = CAN_ERROR_NOT_CANFD;
+			goto err_skt_close;
+		}
+
+		ret = setsockopt(pdata->tx_skt, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
+				 &canfd_en, sizeof(canfd_en));
+		if (ret < 0) {
+			log_error("%s: setsockopt CAN_RAW_FD_FRAMES error on %s",
+				  __func__, cif->name);
+			ret = -CAN_ERROR_SETSKTOPT_CANFD;
+			goto err_skt_close;
+		}
 	}
 
 	/*
@@ -525,10 +1086,13 @@ int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
 		goto err_skt_close;
 	}
 
-	/* Add the tx socket to the fd_set structure to detect errors */
-	FD_ZERO(&pdata->can_fds);
-	FD_SET(pdata->tx_skt, &pdata->can_fds);
-	pdata->maxfd = pdata->tx_skt;
+	/* Add the tx socket to the epoll set to detect errors */
+	if (ldx_can_epoll_add(pdata, pdata->tx_skt, &pdata->tx_skt)) {
+		log_error("%s: Unable to add tx socket to epoll on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EPOLL_CTL;
+		goto err_skt_close;
+	}
 
 	ret = ldx_can_register_error_handler(cif, ldx_can_default_error_handler);
 	if (ret < 0) {
@@ -538,6 +1102,26 @@ int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
 		goto err_skt_close;
 	}
 
+	if (cif->cfg.rx_queue_len) {
+		ret = ldx_can_init_rx_queue(cif);
+		if (ret)
+			goto err_skt_close;
+	}
+
+	/* Let the reactor process the async events, if the interface has one */
+	if (pdata->reactor) {
+		ret = ldx_reactor_add_fd(pdata->reactor, pdata->epfd, EPOLLIN,
+					 ldx_can_reactor_cb, cif);
+		if (ret) {
+			log_error("%s: Unable to attach %s to the reactor",
+				  __func__, cif->name);
+			ret = -CAN_ERROR_REACTOR_ADD;
+			goto err_queue_free;
+		}
+
+		return CAN_ERROR_NONE;
+	}
+
 	/* Create the thread to process async events */
 	if (!pdata->can_thr) {
 		pdata->can_thr = malloc(sizeof(pthread_t));
@@ -545,26 +1129,16 @@ int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
 			log_error("%s: Unable to alloc thread memory in %s",
 				  __func__, cif->name);
 			ret = -CAN_ERROR_THREAD_ALLOC;
-			goto err_skt_close;
+			goto err_queue_free;
 		}
 
 		pthread_attr_init(&pdata->can_thr_attr);
 		pthread_attr_setschedpolicy(&pdata->can_thr_attr, SCHED_FIFO);
 
-		ret = pthread_mutex_init(&pdata->mutex, NULL);
-		if (ret) {
-			log_error("%s: Unable init thread mutex %s",
-				  __func__, cif->name);
-			ret = -CAN_ERROR_THREAD_MUTEX_INIT;
-			goto err_thr_alloc;
-		}
-
 		ret = pthread_create(pdata->can_thr, NULL, ldx_can_thr, cif);
 		if (ret) {
 			log_error("%s: Unable to create thread in %s",
 				  __func__, cif->name);
-			pthread_mutex_unlock(&pdata->mutex);
-			pthread_mutex_destroy(&pdata->mutex);
 			ret = -CAN_ERROR_THREAD_CREATE;
 			goto err_thr_alloc;
 		}
@@ -574,9 +1148,22 @@ int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg)
 
 err_thr_alloc:
 	free(pdata->can_thr);
+	pdata->can_thr = NULL;
+
+err_queue_free:
+	ldx_can_free_rx_queue(pdata);
 
 err_skt_close:
 	close(pdata->tx_skt);
+	pdata->tx_skt = 0;
+
+err_evfd_close:
+	close(pdata->evfd);
+	pdata->evfd = -1;
+
+err_epoll_close:
+	close(pdata->epfd);
+	pdata->epfd = -1;
 
 	return ret;
 }
@@ -606,9 +1193,24 @@ can_if_t *ldx_can_request_by_name(const char * const if_name)
 	cif->name[IFNAMSIZ - 1] = '\0';
 	INIT_LIST_HEAD(&priv->err_cb_list_head);
 	INIT_LIST_HEAD(&priv->rx_cb_list_head);
-	priv->can_tout.tv_sec = LDX_CAN_DEF_TOUT_SEC;
-	priv->can_tout.tv_usec = LDX_CAN_DEF_TOUT_USEC;
-	priv->run_thr = true;
+	INIT_LIST_HEAD(&priv->rx_cb_free_list_head);
+	INIT_LIST_HEAD(&priv->ftable_free_list_head);
+
+	if (pthread_mutex_init(&priv->mutex, NULL) ||
+	    pthread_cond_init(&priv->reap_cond, NULL)) {
+		log_error("%s: Unable to init thread mutex for %s node",
+			  __func__, if_name);
+		free(priv);
+		free(cif);
+		return NULL;
+	}
+
+	priv->epfd = -1;
+	priv->evfd = -1;
+	priv->can_tout.tv_sec = LDX_CAN_DEF_TOUT_SEC;
+	priv->can_tout.tv_usec = LDX_CAN_DEF_TOUT_USEC;
+	priv->run_thr = true;
+	ldx_can_init_rx_ring(&priv->rx_ring);
 	cif->_data = priv;
 
 	return cif;
@@ -646,34 +1248,47 @@ int ldx_can_free(can_if_t *cif)
 		can_err_cb_t *err_cb = NULL, *err_cb_tmp = NULL;
 		can_cb_t *rx_cb = NULL, *rx_cb_tmp = NULL;
 
-		/* Stop flag CAN thread */
-		pdata->run_thr = false;
-
-		/* Shutdown tx socket */
-		if (pdata->tx_skt)
-			shutdown(pdata->tx_skt, SHUT_RDWR);
-
-		/* Shutdown rx sockets */
-		list_for_each_entry(rx_cb, &pdata->rx_cb_list_head, list) {
-			shutdown(rx_cb->rx_skt, SHUT_RDWR);
-		}
+		/* Detach from the reactor, waiting for any running dispatch */
+		if (pdata->reactor && pdata->epfd >= 0)
+			ldx_reactor_del_fd(pdata->reactor, pdata->epfd);
 
+		/* Stop the CAN thread and wait for it to finish */
+		pdata->run_thr = false;
 		if (pdata->can_thr) {
-			ret = pthread_mutex_lock(&pdata->mutex);
-			if (ret)
-				log_error("%s: error mutex lock %s", __func__, cif->name);
+			ldx_can_wake_thr(pdata);
+			pthread_join(*pdata->can_thr, NULL);
+			free(pdata->can_thr);
 		}
 
-		if (pdata->tx_skt)
+		/* Shutdown and close tx socket */
+		if (pdata->tx_skt) {
+			shutdown(pdata->tx_skt, SHUT_RDWR);
 			close(pdata->tx_skt);
+		}
 
 		/* Unregister rx handlers */
 		list_for_each_entry_safe(rx_cb, rx_cb_tmp, &pdata->rx_cb_list_head, list) {
-			FD_CLR(rx_cb->rx_skt, &pdata->can_fds);
-			close(rx_cb->rx_skt);
+			if (rx_cb->rx_skt >= 0) {
+				shutdown(rx_cb->rx_skt, SHUT_RDWR);
+				close(rx_cb->rx_skt);
+			}
 			list_del(&rx_cb->list);
+			free(rx_cb->filters);
 			free(rx_cb);
 		}
+		ldx_can_reap_rx_cbs(pdata);
+
+		ldx_can_free_rx_queue(pdata);
+		ldx_can_free_capture(pdata);
+
+		/* Release the shared socket */
+		if (pdata->shared_rx) {
+			shutdown(pdata->shared_rx->rx_skt, SHUT_RDWR);
+			close(pdata->shared_rx->rx_skt);
+			free(pdata->shared_rx);
+		}
+		if (pdata->ftable)
+			can_filter_table_free(pdata->ftable);
 
 		/* Unregister error handlers */
 		list_for_each_entry_safe(err_cb, err_cb_tmp, &pdata->err_cb_list_head, list) {
@@ -681,14 +1296,13 @@ int ldx_can_free(can_if_t *cif)
 			free(err_cb);
 		}
 
-		/* Stop CAN thread */
-		if (pdata->can_thr) {
-			pthread_cancel(*pdata->can_thr);
-			pthread_join(*pdata->can_thr, NULL);
-			free(pdata->can_thr);
-			pthread_mutex_unlock(&pdata->mutex);
-			pthread_mutex_destroy(&pdata->mutex);
-		}
+		if (pdata->evfd >= 0)
+			close(pdata->evfd);
+		if (pdata->epfd >= 0)
+			close(pdata->epfd);
+
+		pthread_cond_destroy(&pdata->reap_cond);
+		pthread_mutex_destroy(&pdata->mutex);
 	}
 
 	ret = ldx_can_stop(cif);
@@ -701,7 +1315,23 @@ int ldx_can_free(can_if_t *cif)
 	return ret;
 }
 
-int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame)
+/**
+ * tx_result() - Get the statistics outcome of a transmission
+ *
+ * @ret:	Value returned by the transmission.
+ *
+ * Return: The outcome, a full transmission queue is a retry.
+ */
+static stats_result_t tx_result(int ret)
+{
+	if (ret >= 0)
+		return STATS_RESULT_OK;
+
+	return ret == -CAN_ERROR_TX_RETRY_LATER ? STATS_RESULT_RETRY
+						: STATS_RESULT_ERROR;
+}
+
+static int can_tx_frame(const can_if_t *cif, struct canfd_frame *frame)
 {
 	can_priv_t *pdata = NULL;
 	int mtu = CAN_MTU;
@@ -710,6 +1340,9 @@ int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame)
 	if (!cif)
 		return -CAN_ERROR_NULL_INTERFACE;
 
+	if (!frame)
+		return -CAN_ERROR_NULL_FRAME;
+
 	pdata = cif->_data;
 
 	/* Set proper length and mtu for standard or fd frames */
@@ -738,6 +1371,121 @@ int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame)
 	return EXIT_SUCCESS;
 }
 
+int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = can_tx_frame(cif, frame);
+	stats_end(STATS_API_CAN_TX_FRAME, start, tx_result(ret), 1);
+
+	return ret;
+}
+
+static int can_tx_frames(const can_if_t *cif, struct canfd_frame *frames,
+			 int nframes)
+{
+	can_priv_t *pdata = NULL;
+	struct mmsghdr msgs[LDX_CAN_BATCH_LEN];
+	struct iovec iov[LDX_CAN_BATCH_LEN];
+	int mtu = CAN_MTU;
+	int sent = 0;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	if (nframes < 0)
+		return -CAN_ERROR_INVALID_NFRAMES;
+
+	if (!frames && nframes > 0)
+		return -CAN_ERROR_NULL_FRAME;
+
+	pdata = cif->_data;
+
+	if (cif->cfg.canfd_enabled)
+		mtu = CANFD_MTU;
+
+	memset(msgs, 0, sizeof(msgs));
+
+	while (sent < nframes) {
+		int n = nframes - sent;
+		int i, ret;
+
+		if (n > LDX_CAN_BATCH_LEN)
+			n = LDX_CAN_BATCH_LEN;
+
+		/* The headers point straight to the caller frames, no copies */
+		for (i = 0; i < n; i++) {
+			struct canfd_frame *frame = &frames[sent + i];
+
+			/* Set proper length for fd frames */
+			if (cif->cfg.canfd_enabled)
+				frame->len = can_dlc2len(CAN_LEN2DLC(frame->len));
+
+			iov[i].iov_base = frame;
+			iov[i].iov_len = mtu;
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		ret = sendmmsg(pdata->tx_skt, msgs, n, 0);
+		if (ret < 0) {
+			if (errno == ENOBUFS || errno == EAGAIN)
+				/*
+				 * The txqueue is full, report what was already
+				 * queued and let user space retry the rest.
+				 */
+				return sent ? sent : -CAN_ERROR_TX_RETRY_LATER;
+
+			log_error("%s: socket write (%d/%d) on %s", __func__, ret,
+				  errno, cif->name);
+			return sent ? sent : -CAN_ERROR_TX_SKT_WR;
+		}
+
+		for (i = 0; i < ret; i++) {
+			if (msgs[i].msg_len < mtu)
+				return sent + i ? sent + i : -CAN_ERROR_INCOMP_FRAME;
+		}
+
+		sent += ret;
+		if (ret < n)
+			break;
+	}
+
+	return sent;
+}
+
+int ldx_can_tx_frames(const can_if_t *cif, struct canfd_frame *frames, int nframes)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = can_tx_frames(cif, frames, nframes);
+	stats_end(STATS_API_CAN_TX_FRAMES, start, tx_result(ret),
+		  stats_count(ret));
+
+	return ret;
+}
+
+int ldx_can_set_reactor(can_if_t *cif, reactor_t *reactor)
+{
+	can_priv_t *pdata = NULL;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+
+	if (pdata->can_thr || pdata->epfd >= 0) {
+		log_error("%s: %s is already initialized", __func__, cif->name);
+		return -CAN_ERROR_REACTOR_ADD;
+	}
+
+	pdata->reactor = reactor;
+
+	return CAN_ERROR_NONE;
+}
+
 static can_err_cb_t *find_errcb_by_function(const can_if_t *cif,
 					    const ldx_can_error_cb_t cb)
 {
@@ -833,14 +1581,17 @@ unreg_errh_ret:
 
 }
 
-static can_cb_t *find_rxcb_by_function(const can_if_t *cif, const ldx_can_rx_cb_t cb)
+static can_cb_t *find_rxcb_by_function(const can_if_t *cif, const ldx_can_rx_cb_t cb,
+					const ldx_can_rx_batch_cb_t batch_cb,
+					const ldx_can_rx_ts_cb_t ts_cb, void *arg)
 {
 	can_priv_t *pdata;
 	can_cb_t *rx_cb;
 
 	pdata = cif->_data;
 	list_for_each_entry(rx_cb, &pdata->rx_cb_list_head, list) {
-		if (rx_cb->handler == cb) {
+		if (rx_cb->handler == cb && rx_cb->batch_handler == batch_cb &&
+		    rx_cb->ts_handler == ts_cb && rx_cb->arg == arg) {
 			return rx_cb;
 		}
 	}
@@ -848,8 +1599,137 @@ static can_cb_t *find_rxcb_by_function(const can_if_t *cif, const ldx_can_rx_cb_
 	return NULL;
 }
 
-int ldx_can_register_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
-				struct can_filter *filters, int nfilters)
+/*
+ * Wait until the thread dispatching the events of the interface, if any,
+ * stops referencing the entries removed by the caller, and release them.
+ * Must be called with the mutex held. When called from a callback, the
+ * entries are released after returning from it.
+ */
+static void ldx_can_sync_dispatch(can_priv_t *pdata)
+{
+	unsigned int seq;
+
+	if (!pdata->in_dispatch) {
+		ldx_can_reap_rx_cbs(pdata);
+		return;
+	}
+
+	if (pthread_equal(pthread_self(), pdata->dispatch_thr))
+		return;
+
+	seq = pdata->reap_seq;
+	pdata->reap_waiters++;
+	ldx_can_wake_thr(pdata);
+	while (seq == pdata->reap_seq)
+		pthread_cond_wait(&pdata->reap_cond, &pdata->mutex);
+	pdata->reap_waiters--;
+}
+
+/*
+ * Rebuild the filter table and the kernel filters of the shared socket
+ * after the list of handlers changed. Must be called with the mutex held.
+ * On error nothing is changed. The replaced table is queued for release,
+ * the caller must call ldx_can_sync_dispatch() afterwards.
+ */
+static int ldx_can_update_shared_filters(const can_if_t *cif)
+{
+	can_priv_t *pdata = cif->_data;
+	can_filter_table_t *table, *old_table;
+	struct can_filter *kfilters, accept_all = { 0, 0 };
+	int nkfilters, ret;
+
+	table = can_filter_table_compile(&pdata->rx_cb_list_head);
+	if (!table)
+		return -CAN_ERROR_NO_MEM;
+
+	/*
+	 * Let the kernel drop the frames no handler wants. When the filters
+	 * can not be merged, the table does all the filtering.
+	 */
+	nkfilters = can_filter_merge(&pdata->rx_cb_list_head, &kfilters);
+	if (nkfilters < 0)
+		ret = setsockopt(pdata->shared_rx->rx_skt, SOL_CAN_RAW, CAN_RAW_FILTER,
+				 &accept_all, sizeof(accept_all));
+	else
+		ret = setsockopt(pdata->shared_rx->rx_skt, SOL_CAN_RAW, CAN_RAW_FILTER,
+				 kfilters, nkfilters * sizeof(struct can_filter));
+	free(kfilters);
+	if (ret) {
+		log_error("%s: setsockopt CAN_RAW_FILTER error (%d) on %s",
+			  __func__, ret, cif->name);
+		can_filter_table_free(table);
+		return -CAN_ERROR_SETSKTOPT_RAW_FLT;
+	}
+
+	old_table = pdata->ftable;
+	__atomic_store_n(&pdata->ftable, table, __ATOMIC_RELEASE);
+	if (old_table)
+		list_add(&old_table->list, &pdata->ftable_free_list_head);
+
+	return CAN_ERROR_NONE;
+}
+
+/* Register a handler on the shared socket. Must be called with the mutex held */
+static int ldx_can_add_shared_rx_handler(can_if_t *cif, can_cb_t *rxcb)
+{
+	can_priv_t *pdata = cif->_data;
+	int ret;
+
+	if (pdata->shared_slots == ~0ULL) {
+		log_error("%s: too many rx handlers on %s", __func__, cif->name);
+		return -CAN_ERROR_RX_CB_MAX;
+	}
+
+	if (!pdata->shared_rx) {
+		can_cb_t *shared;
+
+		shared = calloc(1, sizeof(can_cb_t));
+		if (!shared) {
+			log_error("%s: Unable to alloc memory for rx socket on %s",
+				  __func__, cif->name);
+			return -CAN_ERROR_NO_MEM;
+		}
+		shared->slot = -1;
+
+		ret = ldx_can_open_rx_socket(cif, NULL, 0, &shared->rx_skt);
+		if (ret) {
+			free(shared);
+			return ret;
+		}
+
+		/* Frames received before the first table is built are dropped */
+		ret = ldx_can_epoll_add(pdata, shared->rx_skt, shared);
+		if (ret) {
+			log_error("%s: Unable to add rx socket to epoll on %s",
+				  __func__, cif->name);
+			close(shared->rx_skt);
+			free(shared);
+			return -CAN_ERROR_EPOLL_CTL;
+		}
+
+		pdata->shared_rx = shared;
+	}
+
+	rxcb->slot = __builtin_ctzll(~pdata->shared_slots);
+	list_add(&rxcb->list, &pdata->rx_cb_list_head);
+
+	ret = ldx_can_update_shared_filters(cif);
+	if (ret) {
+		list_del(&rxcb->list);
+		rxcb->slot = -1;
+		return ret;
+	}
+
+	pdata->shared_slots |= 1ULL << rxcb->slot;
+	ldx_can_sync_dispatch(pdata);
+
+	return CAN_ERROR_NONE;
+}
+
+static int ldx_can_add_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
+				  const ldx_can_rx_batch_cb_t batch_cb,
+				  const ldx_can_rx_ts_cb_t ts_cb, void *arg,
+				  struct can_filter *filters, int nfilters)
 {
 	can_cb_t *rxcb;
 	can_priv_t *pdata = NULL;
@@ -868,14 +1748,14 @@ int ldx_can_register_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
 	}
 
 	/* Ensure the callback is not registered more than once */
-	rxcb = find_rxcb_by_function(cif, cb);
+	rxcb = find_rxcb_by_function(cif, cb, batch_cb, ts_cb, arg);
 	if (rxcb) {
 		log_error("%s: callback already registered on %s", __func__, cif->name);
 		ret = -CAN_ERROR_RX_CB_ALR_REG;
 		goto rx_err_unlock;
 	}
 
-	rxcb = (can_cb_t *)malloc(sizeof(can_cb_t));
+	rxcb = (can_cb_t *)calloc(1, sizeof(can_cb_t));
 	if (!rxcb) {
 		log_error("%s: Unable to alloc memory for rx callback on %s",
 			  __func__, cif->name);
@@ -883,134 +1763,49 @@ int ldx_can_register_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
 		goto rx_err_unlock;
 	}
 
-	/*
-	 * Create the socket, set the filter condition and add it to the
-	 * the fd_set variable
-	 */
-	rxcb->rx_skt = socket(PF_CAN, SOCK_RAW, CAN_RAW);
-	if (rxcb->rx_skt < 0) {
-		log_error("%s: Unable to create rx socket on %s", __func__,
-			  cif->name);
-		ret = -CAN_ERROR_RX_SKT_CREATE;
-		goto rx_err_free;
-	}
-
-	/*
-	 * Set the socket as non blocking. Anyway, it does not seem to have any
-	 * real effect setting it as blocking or non blocking.
-	 */
-	ret = fcntl(rxcb->rx_skt, F_SETFL, O_NONBLOCK);
-	if (ret)
-		goto rx_err_skt_close;
-
-	if(cif->cfg.process_header) {
-		/*
-		 * For details, check:
-		 * Documentation/networking/timestamping.txt
-		 */
-		int option_name, tstamp_flags;
-
-		if (cif->cfg.hw_timestamp) {
-			option_name = SO_TIMESTAMPING;
-			tstamp_flags = SOF_TIMESTAMPING_SOFTWARE |
-				       SOF_TIMESTAMPING_RX_SOFTWARE |
-				       SOF_TIMESTAMPING_RAW_HARDWARE;
-		} else {
-			option_name = SO_TIMESTAMP;
-			tstamp_flags = 1;
-		}
-
-		ret = setsockopt(rxcb->rx_skt, SOL_SOCKET, option_name,
-				  &tstamp_flags, sizeof(tstamp_flags));
-		if (ret) {
-			log_info("%s: setsockopt %s not supported",
-				 __func__, cif->cfg.hw_timestamp ?
-				"SO_TIMESTAMPING" : "SO_TIMESTAMP");
-			ret = -CAN_ERROR_SETSKTOPT_TIMESTAMP;
-			goto rx_err_skt_close;
-		}
-	}
-
-	if (cif->cfg.canfd_enabled) {
-		int canfd_en = 1;
+	rxcb->handler = cb;
+	rxcb->batch_handler = batch_cb;
+	rxcb->ts_handler = ts_cb;
+	rxcb->arg = arg;
+	rxcb->rx_skt = -1;
+	rxcb->slot = -1;
 
-		ret = setsockopt(rxcb->rx_skt, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
-				 &canfd_en, sizeof(canfd_en));
-		if (ret < 0) {
-			log_error("%s|%s: setsockopt CAN_RAW_FD_FRAMES error",
-				  cif->name, __func__);
-			ret = -CAN_ERROR_SETSKTOPT_CANFD;
-			goto rx_err_skt_close;
+	if (nfilters > 0 && filters) {
+		rxcb->filters = malloc(nfilters * sizeof(struct can_filter));
+		if (!rxcb->filters) {
+			log_error("%s: Unable to alloc memory for rx filters on %s",
+				  __func__, cif->name);
+			ret = -CAN_ERROR_NO_MEM;
+			goto rx_err_free;
 		}
+		memcpy(rxcb->filters, filters, nfilters * sizeof(struct can_filter));
+		rxcb->nfilters = nfilters;
 	}
 
-	if (cif->cfg.rx_buf_len) {
-		socklen_t size_rx_buf_len_rd = sizeof(cif->cfg.rx_buf_len_rd);
-
-		/*
-		 * Try first with SO_RCVBUFFORCE which allows to exceed rmem_max limit
-		 * for privileged (CAP_NET_ADMIN) processes.
-		 */
-		ret = setsockopt(rxcb->rx_skt, SOL_SOCKET, SO_RCVBUFFORCE,
-				 &cif->cfg.rx_buf_len, sizeof(cif->cfg.rx_buf_len));
-		if (ret < 0) {
-			log_warning("%s|%s: setsockopt SO_RCVBUFFORCE error",
-				   cif->name, __func__);
-			ret = setsockopt(rxcb->rx_skt, SOL_SOCKET, SO_RCVBUF,
-					 &cif->cfg.rx_buf_len, sizeof(cif->cfg.rx_buf_len));
-			if (ret < 0) {
-				log_error("%s|%s: setsockopt SO_RCVBUF error",
-					  cif->name, __func__);
-				ret = -CAN_ERROR_SETSKTOPT_RCVBUF;
-				goto rx_err_skt_close;
-			}
-		}
+	/* The shared socket dispatcher does not build timestamps */
+	if (cif->cfg.shared_rx_skt && !ts_cb) {
+		ret = ldx_can_add_shared_rx_handler(cif, rxcb);
+		if (ret)
+			goto rx_err_free;
 
-		ret = getsockopt(rxcb->rx_skt, SOL_SOCKET, SO_RCVBUF,
-				 &cif->cfg.rx_buf_len_rd, &size_rx_buf_len_rd);
-		if (ret < 0) {
-			log_error("%s|%s: getsockopt SO_RCVBUF error",
-					  cif->name, __func__);
-			ret = -CAN_ERROR_GETSKTOPT_RCVBUF;
-			goto rx_err_skt_close;
-		}
-	}
+		pthread_mutex_unlock(&pdata->mutex);
 
-	if (cif->cfg.error_mask) {
-		ret = setsockopt(rxcb->rx_skt, SOL_CAN_RAW, CAN_RAW_ERR_FILTER,
-				 &cif->cfg.error_mask,
-				 sizeof(cif->cfg.error_mask));
-		if (ret < 0) {
-			log_error("%s: setsockopt CAN_RAW_ERR_FILTER error on %s",
-				  __func__, cif->name);
-			ret = -CAN_ERROR_SETSKTOPT_ERR_FLT;
-			goto rx_err_skt_close;
-		}
+		return CAN_ERROR_NONE;
 	}
 
-	if (nfilters > 0 && filters) {
-		ret = setsockopt(rxcb->rx_skt, SOL_CAN_RAW, CAN_RAW_FILTER,
-				 filters, nfilters * sizeof(struct can_filter));
-		if (ret) {
-			log_error("%s: setsockopt CAN_RAW_FILTER error (%d) on %s",
-				  __func__, ret, cif->name);
-			ret = -CAN_ERROR_SETSKTOPT_RAW_FLT;
-			goto rx_err_skt_close;
-		}
-	}
+	ret = ldx_can_open_rx_socket(cif, filters, nfilters, &rxcb->rx_skt);
+	if (ret)
+		goto rx_err_free;
 
-	ret = bind(rxcb->rx_skt, (struct sockaddr *)&pdata->addr, sizeof(pdata->addr));
-	if (ret < 0) {
-		log_error("%s: socket bind error on %s", __func__, cif->name);
-		ret = -CAN_ERROR_RX_SKT_BIND;
+	/* From now on the thread dispatches the socket events to this entry */
+	ret = ldx_can_epoll_add(pdata, rxcb->rx_skt, rxcb);
+	if (ret) {
+		log_error("%s: Unable to add rx socket to epoll on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EPOLL_CTL;
 		goto rx_err_skt_close;
 	}
 
-	FD_SET(rxcb->rx_skt, &pdata->can_fds);
-	if (rxcb->rx_skt > pdata->maxfd)
-		pdata->maxfd = rxcb->rx_skt;
-
-	rxcb->handler = cb;
 	list_add(&(rxcb->list), &(pdata->rx_cb_list_head));
 	pthread_mutex_unlock(&pdata->mutex);
 
@@ -1020,6 +1815,7 @@ rx_err_skt_close:
 	close(rxcb->rx_skt);
 
 rx_err_free:
+	free(rxcb->filters);
 	free(rxcb);
 
 rx_err_unlock:
@@ -1028,7 +1824,33 @@ rx_err_unlock:
 	return ret;
 }
 
-int ldx_can_unregister_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb)
+int ldx_can_register_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
+				struct can_filter *filters, int nfilters)
+{
+	return ldx_can_add_rx_handler(cif, cb, NULL, NULL, NULL, filters, nfilters);
+}
+
+int ldx_can_register_rx_batch_handler(can_if_t *cif, const ldx_can_rx_batch_cb_t cb,
+				      struct can_filter *filters, int nfilters)
+{
+	return ldx_can_add_rx_handler(cif, NULL, cb, NULL, NULL, filters, nfilters);
+}
+
+int ldx_can_register_rx_ts_handler(can_if_t *cif, const ldx_can_rx_ts_cb_t cb,
+				   void *arg, struct can_filter *filters,
+				   int nfilters)
+{
+	if (!cb) {
+		log_error("%s: Invalid callback", __func__);
+		return -CAN_ERROR_RX_CB_NOT_FOUND;
+	}
+
+	return ldx_can_add_rx_handler(cif, NULL, NULL, cb, arg, filters, nfilters);
+}
+
+static int ldx_can_remove_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb,
+				     const ldx_can_rx_batch_cb_t batch_cb,
+				     const ldx_can_rx_ts_cb_t ts_cb, void *arg)
 {
 	can_priv_t *pdata = NULL;
 	can_cb_t *rxcb;
@@ -1047,18 +1869,34 @@ int ldx_can_unregister_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb)
 	}
 
 	/* Find the callback and remove it from the list */
-	rxcb = find_rxcb_by_function(cif, cb);
+	rxcb = find_rxcb_by_function(cif, cb, batch_cb, ts_cb, arg);
 	if (!rxcb) {
 		log_error("%s: callback not found on %s", __func__, cif->name);
 		ret = -CAN_ERROR_RX_CB_NOT_FOUND;
 		goto unreg_rxh_unlock;
 	}
 
-	/* Remove the socket from can_fds and release the resources */
-	FD_CLR(rxcb->rx_skt, &pdata->can_fds);
-	close(rxcb->rx_skt);
-	list_del(&rxcb->list);
-	free(rxcb);
+	if (rxcb->slot >= 0) {
+		/* Drop the handler from the shared socket filter table */
+		list_del(&rxcb->list);
+		ret = ldx_can_update_shared_filters(cif);
+		if (ret) {
+			list_add(&rxcb->list, &pdata->rx_cb_list_head);
+			goto unreg_rxh_unlock;
+		}
+		pdata->shared_slots &= ~(1ULL << rxcb->slot);
+		list_add(&rxcb->list, &pdata->rx_cb_free_list_head);
+	} else {
+		/* Stop watching the socket and release it */
+		epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, rxcb->rx_skt, NULL);
+		list_move(&rxcb->list, &pdata->rx_cb_free_list_head);
+	}
+
+	/*
+	 * The events may be being dispatched to the callback right now, do
+	 * not release the entry until the current batch is done.
+	 */
+	ldx_can_sync_dispatch(pdata);
 
 unreg_rxh_unlock:
 	pthread_mutex_unlock(&pdata->mutex);
@@ -1066,3 +1904,292 @@ unreg_rxh_unlock:
 unreg_rxh_ret:
 	return ret;
 }
+
+int ldx_can_unregister_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb)
+{
+	return ldx_can_remove_rx_handler(cif, cb, NULL, NULL, NULL);
+}
+
+int ldx_can_unregister_rx_batch_handler(const can_if_t *cif,
+					const ldx_can_rx_batch_cb_t cb)
+{
+	return ldx_can_remove_rx_handler(cif, NULL, cb, NULL, NULL);
+}
+
+int ldx_can_unregister_rx_ts_handler(const can_if_t *cif,
+				     const ldx_can_rx_ts_cb_t cb, void *arg)
+{
+	return ldx_can_remove_rx_handler(cif, NULL, NULL, cb, arg);
+}
+
+static int ldx_can_get_handler_stats(const can_if_t *cif, const ldx_can_rx_cb_t cb,
+				     const ldx_can_rx_batch_cb_t batch_cb,
+				     can_rx_stats_t *stats)
+{
+	can_priv_t *pdata = NULL;
+	can_cb_t *rxcb;
+	int ret;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	ret = pthread_mutex_lock(&pdata->mutex);
+	if (ret) {
+		log_error("%s: error mutex lock %s",
+			  __func__, cif->name);
+		return -CAN_ERROR_THREAD_MUTEX_LOCK;
+	}
+
+	rxcb = find_rxcb_by_function(cif, cb, batch_cb, NULL, NULL);
+	if (!rxcb) {
+		log_error("%s: callback not found on %s", __func__, cif->name);
+		ret = -CAN_ERROR_RX_CB_NOT_FOUND;
+		goto stats_unlock;
+	}
+
+	*stats = rxcb->stats;
+
+	/* The socket counters of shared handlers are those of the shared socket */
+	if (rxcb->slot >= 0 && pdata->shared_rx) {
+		stats->dropped = pdata->shared_rx->stats.dropped;
+		stats->reads = pdata->shared_rx->stats.reads;
+		stats->max_batch = pdata->shared_rx->stats.max_batch;
+	}
+
+stats_unlock:
+	pthread_mutex_unlock(&pdata->mutex);
+
+	return ret;
+}
+
+int ldx_can_get_rx_stats(const can_if_t *cif, const ldx_can_rx_cb_t cb,
+			 can_rx_stats_t *stats)
+{
+	return ldx_can_get_handler_stats(cif, cb, NULL, stats);
+}
+
+int ldx_can_get_rx_batch_stats(const can_if_t *cif, const ldx_can_rx_batch_cb_t cb,
+			       can_rx_stats_t *stats)
+{
+	return ldx_can_get_handler_stats(cif, NULL, cb, stats);
+}
+
+static int can_rx_pop_batch(const can_if_t *cif, struct canfd_frame *frames,
+			    struct timeval *tv, int nframes, int timeout_ms)
+{
+	can_priv_t *pdata;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	if (!pdata->rx_queue) {
+		log_error("%s: rx queue not enabled on %s", __func__, cif->name);
+		return -CAN_ERROR_RX_QUEUE_DISABLED;
+	}
+
+	if (nframes <= 0)
+		return 0;
+
+	return can_rx_queue_pop(pdata->rx_queue, frames, tv, nframes, timeout_ms);
+}
+
+int ldx_can_rx_pop(const can_if_t *cif, struct canfd_frame *frame,
+		   struct timeval *tv, int timeout_ms)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = can_rx_pop_batch(cif, frame, tv, 1, timeout_ms);
+	stats_end(STATS_API_CAN_RX_POP, start, stats_result_count(ret),
+		  stats_count(ret));
+
+	return ret;
+}
+
+int ldx_can_rx_pop_batch(const can_if_t *cif, struct canfd_frame *frames,
+			 struct timeval *tv, int nframes, int timeout_ms)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = can_rx_pop_batch(cif, frames, tv, nframes, timeout_ms);
+	stats_end(STATS_API_CAN_RX_POP_BATCH, start, stats_result_count(ret),
+		  stats_count(ret));
+
+	return ret;
+}
+
+int ldx_can_get_rx_queue_stats(const can_if_t *cif, can_rx_stats_t *stats)
+{
+	can_priv_t *pdata;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	if (!pdata->rx_queue) {
+		log_error("%s: rx queue not enabled on %s", __func__, cif->name);
+		return -CAN_ERROR_RX_QUEUE_DISABLED;
+	}
+
+	*stats = pdata->queue_rx->stats;
+	stats->overruns = pdata->rx_queue->overruns;
+
+	return CAN_ERROR_NONE;
+}
+
+/*
+ * Stop feeding the capture and return it, so the caller can close it.
+ * Must be called with the mutex held.
+ */
+static can_capture_t *ldx_can_detach_capture(can_priv_t *pdata)
+{
+	can_capture_t *cap = pdata->capture;
+
+	epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, cap->timer_fd, NULL);
+	epoll_ctl(pdata->epfd, EPOLL_CTL_DEL, pdata->capture_rx->rx_skt, NULL);
+	__atomic_store_n(&pdata->capture, NULL, __ATOMIC_RELEASE);
+	list_add(&pdata->capture_rx->list, &pdata->rx_cb_free_list_head);
+	pdata->capture_rx = NULL;
+
+	/*
+	 * After this the working thread finds no capture, so it can be closed
+	 * even when called from a callback.
+	 */
+	ldx_can_sync_dispatch(pdata);
+
+	return cap;
+}
+
+int ldx_can_capture_start(can_if_t *cif, const char *path,
+			  const can_capture_opts_t *opts)
+{
+	can_priv_t *pdata;
+	can_capture_t *cap;
+	can_cb_t *capture_rx;
+	uint32_t flags = 0;
+	int ret;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	if (!path) {
+		log_error("%s: Invalid capture path", __func__);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	pdata = cif->_data;
+	if (pdata->epfd < 0) {
+		log_error("%s: %s is not initialized", __func__, cif->name);
+		return -CAN_ERROR_NULL_INTERFACE;
+	}
+
+	if (cif->cfg.canfd_enabled)
+		flags |= LDX_CAN_CAPTURE_FLAG_FD;
+	if (cif->cfg.process_header && cif->cfg.hw_timestamp)
+		flags |= LDX_CAN_CAPTURE_FLAG_HW_TSTAMP;
+
+	pthread_mutex_lock(&pdata->mutex);
+
+	if (pdata->capture) {
+		log_error("%s: Capture already running on %s", __func__, cif->name);
+		ret = -CAN_ERROR_CAPTURE_RUNNING;
+		goto err_unlock;
+	}
+
+	cap = can_capture_open(path, cif->name, opts, flags, &ret);
+	if (!cap)
+		goto err_unlock;
+
+	capture_rx = calloc(1, sizeof(can_cb_t));
+	if (!capture_rx) {
+		log_error("%s: Unable to alloc memory for rx socket on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_NO_MEM;
+		goto err_capture_close;
+	}
+	capture_rx->slot = -1;
+
+	ret = ldx_can_open_rx_socket(cif, NULL, 0, &capture_rx->rx_skt);
+	if (ret) {
+		free(capture_rx);
+		goto err_capture_close;
+	}
+
+	pdata->capture_rx = capture_rx;
+	__atomic_store_n(&pdata->capture, cap, __ATOMIC_RELEASE);
+
+	if (ldx_can_epoll_add(pdata, cap->timer_fd, &pdata->capture) ||
+	    ldx_can_epoll_add(pdata, capture_rx->rx_skt, capture_rx)) {
+		log_error("%s: Unable to add capture to epoll on %s",
+			  __func__, cif->name);
+		ret = -CAN_ERROR_EPOLL_CTL;
+		cap = ldx_can_detach_capture(pdata);
+		goto err_capture_close;
+	}
+
+	pthread_mutex_unlock(&pdata->mutex);
+
+	return CAN_ERROR_NONE;
+
+err_capture_close:
+	can_capture_close(cap);
+
+err_unlock:
+	pthread_mutex_unlock(&pdata->mutex);
+
+	return ret;
+}
+
+int ldx_can_capture_stop(can_if_t *cif)
+{
+	can_priv_t *pdata;
+	can_capture_t *cap;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	pthread_mutex_lock(&pdata->mutex);
+
+	if (!pdata->capture) {
+		pthread_mutex_unlock(&pdata->mutex);
+		log_error("%s: No capture running on %s", __func__, cif->name);
+		return -CAN_ERROR_CAPTURE_DISABLED;
+	}
+
+	cap = ldx_can_detach_capture(pdata);
+
+	pthread_mutex_unlock(&pdata->mutex);
+
+	/* Waits for the frames to be written back, keep it out of the lock */
+	can_capture_close(cap);
+
+	return CAN_ERROR_NONE;
+}
+
+int ldx_can_get_capture_stats(const can_if_t *cif, can_rx_stats_t *stats)
+{
+	can_priv_t *pdata;
+	int ret = CAN_ERROR_NONE;
+
+	if (!cif)
+		return -CAN_ERROR_NULL_INTERFACE;
+
+	pdata = cif->_data;
+	pthread_mutex_lock(&pdata->mutex);
+
+	if (pdata->capture) {
+		*stats = pdata->capture_rx->stats;
+		stats->overruns = pdata->capture->lost;
+	} else {
+		log_error("%s: No capture running on %s", __func__, cif->name);
+		ret = -CAN_ERROR_CAPTURE_DISABLED;
+	}
+
+	pthread_mutex_unlock(&pdata->mutex);
+
+	return ret;
+}
@@ -0,0 +1,637 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can.h"
+#include "_can.h"
+#include "_log.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+
+/* Defined by recent 'linux/can.h' headers only */
+#ifndef CANFD_FDF
+#define CANFD_FDF		0x04
+#endif
+
+/* PCAP-NG blocks, options and link type */
+#define PCAPNG_SHB		0x0A0D0D0A
+#define PCAPNG_IDB		0x00000001
+#define PCAPNG_EPB		0x00000006
+#define PCAPNG_BYTE_ORDER	0x1A2B3C4D
+#define PCAPNG_OPT_END		0
+#define PCAPNG_OPT_IF_NAME	2
+#define PCAPNG_OPT_IF_TSRESOL	9
+#define LINKTYPE_CAN_SOCKETCAN	227
+
+static int64_t capture_realtime_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	return (int64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static size_t capture_file_size(const can_capture_t *cap)
+{
+	return LDX_CAN_CAPTURE_HEADER_SIZE + cap->capacity * cap->record_size;
+}
+
+static can_capture_record_t *capture_record(const can_capture_header_t *hdr,
+					    uint64_t index)
+{
+	return (can_capture_record_t *)((char *)hdr + hdr->header_size
+					+ index * hdr->record_size);
+}
+
+/* Path of the file prepared to replace the active one when it is full */
+static void capture_next_path(const can_capture_t *cap, char *buf, size_t len)
+{
+	snprintf(buf, len, "%s.next", cap->path);
+}
+
+/* Create a file, preallocated and mapped, with an empty header */
+static int capture_map_file(const can_capture_t *cap, const char *path,
+			    int *fdp, can_capture_header_t **hdrp)
+{
+	size_t size = capture_file_size(cap);
+	can_capture_header_t *hdr;
+	int fd;
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		log_error_ratelimited("%s: Unable to create capture file %s (%d)",
+				      __func__, path, errno);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	/*
+	 * Reserve the blocks now, so storing a record is a plain memory copy
+	 * that can not fail for lack of space.
+	 */
+	if (fallocate(fd, 0, 0, size) < 0) {
+		if (errno != EOPNOTSUPP || ftruncate(fd, size) < 0) {
+			log_error_ratelimited("%s: Unable to allocate %zu bytes for %s (%d)",
+					      __func__, size, path, errno);
+			goto err_close;
+		}
+	}
+
+	hdr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (hdr == MAP_FAILED) {
+		log_error_ratelimited("%s: Unable to map capture file %s (%d)",
+				      __func__, path, errno);
+		goto err_close;
+	}
+
+	memcpy(hdr->magic, LDX_CAN_CAPTURE_MAGIC, sizeof(hdr->magic));
+	hdr->version = LDX_CAN_CAPTURE_VERSION;
+	hdr->header_size = LDX_CAN_CAPTURE_HEADER_SIZE;
+	hdr->record_size = cap->record_size;
+	hdr->flags = cap->flags;
+	hdr->capacity = cap->capacity;
+	hdr->count = 0;
+	hdr->start_ns = capture_realtime_ns();
+	/* Same size, and 'cap->iface' is always NUL terminated */
+	memcpy(hdr->iface, cap->iface, sizeof(hdr->iface));
+
+	*fdp = fd;
+	*hdrp = hdr;
+
+	return CAN_ERROR_NONE;
+
+err_close:
+	close(fd);
+	unlink(path);
+
+	return -CAN_ERROR_CAPTURE_FILE;
+}
+
+/*
+ * Unmap and close a file. The write back is only started unless 'wait' is
+ * set, so retiring a full file does not delay the next rotation.
+ */
+static void capture_unmap_file(const can_capture_t *cap, int fd,
+			       can_capture_header_t *hdr, uint64_t count,
+			       bool wait)
+{
+	size_t size = capture_file_size(cap);
+
+	__atomic_store_n(&hdr->count, count, __ATOMIC_RELEASE);
+
+	if (wait) {
+		if (msync(hdr, size, MS_SYNC) < 0)
+			log_error("%s: Unable to write back %s (%d)", __func__,
+				  cap->path, errno);
+	} else {
+		sync_file_range(fd, 0, size, SYNC_FILE_RANGE_WRITE);
+	}
+
+	munmap(hdr, size);
+	close(fd);
+}
+
+/*
+ * Keep the full file as '<path>.1', shifting the older ones, and give the
+ * active file, created as '<path>.next', its final name.
+ */
+static void capture_retire_file(const can_capture_t *cap, int fd,
+				can_capture_header_t *hdr, uint64_t count)
+{
+	size_t len = strlen(cap->path) + 12;
+	char from[len], to[len];
+	unsigned int i;
+
+	capture_unmap_file(cap, fd, hdr, count, false);
+
+	for (i = cap->opts.max_files; i > 1; i--) {
+		snprintf(from, len, "%s.%u", cap->path, i - 1);
+		snprintf(to, len, "%s.%u", cap->path, i);
+		if (rename(from, to) < 0 && errno != ENOENT)
+			log_debug("%s: Unable to rename %s (%d)", __func__, from,
+				  errno);
+	}
+
+	snprintf(to, len, "%s.1", cap->path);
+	if (rename(cap->path, to) < 0)
+		log_error_ratelimited("%s: Unable to rename %s (%d)", __func__,
+				      cap->path, errno);
+
+	capture_next_path(cap, from, len);
+	if (rename(from, cap->path) < 0)
+		log_error_ratelimited("%s: Unable to rename %s (%d)", __func__,
+				      from, errno);
+}
+
+/*
+ * Open, preallocate and map the next file ahead of time, and close and
+ * rename the full ones, so the working thread only swaps pointers when
+ * the active file is full.
+ */
+static void *capture_rotator(void *arg)
+{
+	can_capture_t *cap = arg;
+	size_t len = strlen(cap->path) + 12;
+	char next_path[len];
+	can_capture_header_t *hdr;
+	uint64_t count;
+	int fd;
+
+	capture_next_path(cap, next_path, len);
+
+	pthread_mutex_lock(&cap->lock);
+	for (;;) {
+		while (!cap->stop && cap->old_fd < 0 && cap->next_fd >= 0)
+			pthread_cond_wait(&cap->cond, &cap->lock);
+
+		/* The full file is retired even when stopping */
+		if (cap->old_fd >= 0) {
+			fd = cap->old_fd;
+			hdr = cap->old_hdr;
+			count = cap->old_count;
+			pthread_mutex_unlock(&cap->lock);
+
+			capture_retire_file(cap, fd, hdr, count);
+
+			pthread_mutex_lock(&cap->lock);
+			cap->old_fd = -1;
+			cap->old_hdr = NULL;
+			continue;
+		}
+
+		if (cap->stop)
+			break;
+
+		pthread_mutex_unlock(&cap->lock);
+		if (capture_map_file(cap, next_path, &fd, &hdr)) {
+			/* Retried on the next flush, see can_capture_flush() */
+			pthread_mutex_lock(&cap->lock);
+			if (!cap->stop)
+				pthread_cond_wait(&cap->cond, &cap->lock);
+			continue;
+		}
+
+		pthread_mutex_lock(&cap->lock);
+		cap->next_fd = fd;
+		cap->next_hdr = hdr;
+	}
+	pthread_mutex_unlock(&cap->lock);
+
+	return NULL;
+}
+
+/*
+ * Make the prepared file the active one and hand the full one to the
+ * rotator. Fails if the rotator did not prepare the next file yet.
+ */
+static int capture_switch_file(can_capture_t *cap)
+{
+	int ret = -CAN_ERROR_CAPTURE_FILE;
+
+	pthread_mutex_lock(&cap->lock);
+	if (cap->next_fd >= 0 && cap->old_fd < 0) {
+		cap->old_fd = cap->fd;
+		cap->old_hdr = cap->hdr;
+		cap->old_count = cap->count;
+
+		cap->fd = cap->next_fd;
+		cap->hdr = cap->next_hdr;
+		cap->hdr->start_ns = capture_realtime_ns();
+		cap->count = 0;
+		cap->flushed = 0;
+		cap->next_fd = -1;
+		cap->next_hdr = NULL;
+
+		pthread_cond_signal(&cap->cond);
+		ret = CAN_ERROR_NONE;
+	}
+	pthread_mutex_unlock(&cap->lock);
+
+	return ret;
+}
+
+can_capture_t *can_capture_open(const char *path, const char *iface,
+				const can_capture_opts_t *opts, uint32_t flags,
+				int *ret)
+{
+	struct itimerspec its = { 0 };
+	can_capture_t *cap;
+
+	cap = calloc(1, sizeof(can_capture_t));
+	if (!cap) {
+		log_error("%s: Unable to allocate memory for the capture", __func__);
+		*ret = -CAN_ERROR_NO_MEM;
+		return NULL;
+	}
+	cap->fd = -1;
+	cap->timer_fd = -1;
+	cap->next_fd = -1;
+	cap->old_fd = -1;
+
+	if (opts)
+		cap->opts = *opts;
+	if (!cap->opts.file_size)
+		cap->opts.file_size = LDX_CAN_CAPTURE_DEF_FILE_SIZE;
+	if (!cap->opts.flush_ms)
+		cap->opts.flush_ms = LDX_CAN_CAPTURE_DEF_FLUSH_MS;
+
+	if (cap->opts.file_size < LDX_CAN_CAPTURE_MIN_FILE_SIZE) {
+		log_error("%s: Capture file size must be at least %d bytes",
+			  __func__, LDX_CAN_CAPTURE_MIN_FILE_SIZE);
+		*ret = -CAN_ERROR_CAPTURE_FILE;
+		goto err_free;
+	}
+
+	cap->path = strdup(path);
+	if (!cap->path) {
+		*ret = -CAN_ERROR_NO_MEM;
+		goto err_free;
+	}
+	strncpy(cap->iface, iface, sizeof(cap->iface) - 1);
+
+	cap->flags = flags;
+	if (!cap->opts.max_files)
+		cap->flags |= LDX_CAN_CAPTURE_FLAG_RING;
+	cap->record_size = sizeof(can_capture_record_t) +
+		(flags & LDX_CAN_CAPTURE_FLAG_FD ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+	cap->capacity = (cap->opts.file_size - LDX_CAN_CAPTURE_HEADER_SIZE) /
+			cap->record_size;
+
+	cap->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (cap->timer_fd < 0) {
+		log_error("%s: Unable to create the flush timer (%d)", __func__,
+			  errno);
+		*ret = -CAN_ERROR_CAPTURE_FILE;
+		goto err_free;
+	}
+
+	its.it_interval.tv_sec = cap->opts.flush_ms / 1000;
+	its.it_interval.tv_nsec = (cap->opts.flush_ms % 1000) * 1000000;
+	its.it_value = its.it_interval;
+	if (timerfd_settime(cap->timer_fd, 0, &its, NULL) < 0) {
+		log_error("%s: Unable to start the flush timer (%d)", __func__,
+			  errno);
+		*ret = -CAN_ERROR_CAPTURE_FILE;
+		goto err_free;
+	}
+
+	*ret = capture_map_file(cap, cap->path, &cap->fd, &cap->hdr);
+	if (*ret)
+		goto err_free;
+
+	pthread_mutex_init(&cap->lock, NULL);
+	pthread_cond_init(&cap->cond, NULL);
+	if (!(cap->flags & LDX_CAN_CAPTURE_FLAG_RING)) {
+		if (pthread_create(&cap->rotator, NULL, capture_rotator, cap)) {
+			log_error("%s: Unable to create the rotator thread", __func__);
+			*ret = -CAN_ERROR_THREAD_CREATE;
+			goto err_unmap;
+		}
+		cap->has_rotator = true;
+	}
+
+	log_debug("%s: Capturing %s to %s, %llu records of %zu bytes", __func__,
+		  iface, path, (unsigned long long)cap->capacity, cap->record_size);
+
+	return cap;
+
+err_unmap:
+	pthread_cond_destroy(&cap->cond);
+	pthread_mutex_destroy(&cap->lock);
+	capture_unmap_file(cap, cap->fd, cap->hdr, 0, false);
+	unlink(cap->path);
+
+err_free:
+	if (cap->timer_fd >= 0)
+		close(cap->timer_fd);
+	free(cap->path);
+	free(cap);
+
+	return NULL;
+}
+
+void can_capture_close(can_capture_t *cap)
+{
+	if (!cap)
+		return;
+
+	if (cap->has_rotator) {
+		pthread_mutex_lock(&cap->lock);
+		cap->stop = true;
+		pthread_cond_signal(&cap->cond);
+		pthread_mutex_unlock(&cap->lock);
+		pthread_join(cap->rotator, NULL);
+	}
+
+	capture_unmap_file(cap, cap->fd, cap->hdr, cap->count, true);
+
+	/* The prepared file was never used */
+	if (cap->next_fd >= 0) {
+		size_t len = strlen(cap->path) + 12;
+		char next_path[len];
+
+		capture_unmap_file(cap, cap->next_fd, cap->next_hdr, 0, false);
+		capture_next_path(cap, next_path, len);
+		unlink(next_path);
+	}
+
+	pthread_cond_destroy(&cap->cond);
+	pthread_mutex_destroy(&cap->lock);
+	close(cap->timer_fd);
+	free(cap->path);
+	free(cap);
+}
+
+static uint64_t capture_timespec_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+void can_capture_write(can_capture_t *cap, const struct canfd_frame *frames,
+		       const struct timespec *tstamp,
+		       const struct timespec *hw_tstamp, unsigned int nframes)
+{
+	size_t data_len = cap->record_size - sizeof(can_capture_record_t);
+	uint64_t now = tstamp ? 0 : capture_realtime_ns();
+	unsigned int i;
+
+	for (i = 0; i < nframes; i++) {
+		const struct canfd_frame *frame = &frames[i];
+		can_capture_record_t *rec;
+		uint64_t index = cap->count;
+
+		if (cap->count >= cap->capacity) {
+			if (cap->flags & LDX_CAN_CAPTURE_FLAG_RING) {
+				index = cap->count % cap->capacity;
+			} else if (capture_switch_file(cap)) {
+				cap->lost += nframes - i;
+				break;
+			} else {
+				index = 0;
+			}
+		}
+
+		rec = capture_record(cap->hdr, index);
+		rec->tstamp_ns = tstamp ? capture_timespec_ns(&tstamp[i]) : now;
+		rec->hw_tstamp_ns = 0;
+		if (hw_tstamp && (hw_tstamp[i].tv_sec != tstamp[i].tv_sec ||
+				  hw_tstamp[i].tv_nsec != tstamp[i].tv_nsec))
+			rec->hw_tstamp_ns = capture_timespec_ns(&hw_tstamp[i]);
+		rec->can_id = frame->can_id;
+		rec->len = frame->len;
+		rec->flags = frame->flags;
+		rec->reserved[0] = 0;
+		rec->reserved[1] = 0;
+		memcpy(rec->data, frame->data, data_len);
+		cap->count++;
+	}
+
+	/* Readers of the mapping only look at the records 'count' covers */
+	__atomic_store_n(&cap->hdr->count, cap->count, __ATOMIC_RELEASE);
+}
+
+void can_capture_flush(can_capture_t *cap)
+{
+	uint64_t expirations, first, last;
+	off_t offset = LDX_CAN_CAPTURE_HEADER_SIZE;
+	off_t len = cap->capacity * cap->record_size;
+
+	if (read(cap->timer_fd, &expirations, sizeof(expirations)) < 0 &&
+	    errno != EAGAIN)
+		log_debug("%s: timerfd read error (%d)", __func__, errno);
+
+	/* The rotator waits for a flush to retry preparing the next file */
+	if (cap->has_rotator) {
+		pthread_mutex_lock(&cap->lock);
+		if (cap->next_fd < 0 && cap->old_fd < 0)
+			pthread_cond_signal(&cap->cond);
+		pthread_mutex_unlock(&cap->lock);
+	}
+
+	if (cap->count == cap->flushed)
+		return;
+
+	/* Write back only the records stored since the last flush if they are contiguous */
+	first = cap->flushed % cap->capacity;
+	last = cap->count % cap->capacity;
+	if (cap->count - cap->flushed < cap->capacity && first < last) {
+		offset += first * cap->record_size;
+		len = (last - first) * cap->record_size;
+	}
+
+	sync_file_range(cap->fd, 0, LDX_CAN_CAPTURE_HEADER_SIZE, SYNC_FILE_RANGE_WRITE);
+	sync_file_range(cap->fd, offset, len, SYNC_FILE_RANGE_WRITE);
+	cap->flushed = cap->count;
+}
+
+/* Write a PCAP-NG option, padded to 32 bits */
+static void pcapng_write_option(FILE *f, uint16_t code, const void *value,
+				uint16_t len)
+{
+	static const uint8_t pad[4];
+
+	fwrite(&code, sizeof(code), 1, f);
+	fwrite(&len, sizeof(len), 1, f);
+	fwrite(value, len, 1, f);
+	fwrite(pad, (4 - len % 4) % 4, 1, f);
+}
+
+/* Write the section header and the description of the CAN interface */
+static void pcapng_write_headers(FILE *f, const can_capture_header_t *hdr,
+				 uint32_t snaplen)
+{
+	size_t name_len = strnlen(hdr->iface, sizeof(hdr->iface));
+	uint32_t shb[] = { PCAPNG_SHB, 28, PCAPNG_BYTE_ORDER, 1 /* 1.0 */,
+			   0xFFFFFFFF, 0xFFFFFFFF /* Unknown length */, 28 };
+	uint32_t idb[] = { PCAPNG_IDB, 0, LINKTYPE_CAN_SOCKETCAN, snaplen };
+	uint8_t tsresol = 9;	/* Nanoseconds */
+	uint32_t opt_end = PCAPNG_OPT_END;
+	uint32_t idb_len;
+
+	fwrite(shb, sizeof(shb), 1, f);
+
+	idb_len = sizeof(idb) + 4 + (name_len + 3) / 4 * 4 + 4 + 4 + 4 + 4;
+	idb[1] = idb_len;
+	fwrite(idb, sizeof(idb), 1, f);
+	pcapng_write_option(f, PCAPNG_OPT_IF_NAME, hdr->iface, name_len);
+	pcapng_write_option(f, PCAPNG_OPT_IF_TSRESOL, &tsresol, sizeof(tsresol));
+	fwrite(&opt_end, sizeof(opt_end), 1, f);
+	fwrite(&idb_len, sizeof(idb_len), 1, f);
+}
+
+/* Write a record as an enhanced packet block with the SocketCAN header */
+static void pcapng_write_record(FILE *f, const can_capture_record_t *rec,
+				size_t data_len)
+{
+	uint8_t pkt[8 + CANFD_MAX_DLEN] = { 0 };
+	uint32_t can_id = htobe32(rec->can_id);
+	uint32_t pkt_len, block_len;
+	uint32_t epb[7];
+
+	/* CAN FD frames use the CAN FD MTU, classic frames the CAN one */
+	pkt_len = (rec->flags & CANFD_FDF) || rec->len > CAN_MAX_DLEN ?
+		  CANFD_MTU : CAN_MTU;
+	if (pkt_len - 8 > data_len)
+		pkt_len = 8 + data_len;
+
+	memcpy(pkt, &can_id, sizeof(can_id));
+	pkt[4] = rec->len;
+	pkt[5] = rec->flags;
+	memcpy(pkt + 8, rec->data, pkt_len - 8);
+
+	block_len = sizeof(epb) + pkt_len + 4;
+	epb[0] = PCAPNG_EPB;
+	epb[1] = block_len;
+	epb[2] = 0;	/* Interface */
+	epb[3] = rec->tstamp_ns >> 32;
+	epb[4] = rec->tstamp_ns & 0xFFFFFFFF;
+	epb[5] = pkt_len;
+	epb[6] = pkt_len;
+
+	fwrite(epb, sizeof(epb), 1, f);
+	fwrite(pkt, pkt_len, 1, f);	/* CAN_MTU and CANFD_MTU are 32-bit aligned */
+	fwrite(&block_len, sizeof(block_len), 1, f);
+}
+
+int ldx_can_capture_export_pcapng(const char *capture_path, const char *pcapng_path)
+{
+	const can_capture_header_t *hdr;
+	uint64_t count, first, i;
+	size_t data_len, size;
+	int ret = CAN_ERROR_NONE;
+	struct stat st;
+	FILE *f;
+	int fd;
+
+	if (!capture_path || !pcapng_path) {
+		log_error("%s: Invalid file paths", __func__);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	fd = open(capture_path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		log_error("%s: Unable to open %s (%d)", __func__, capture_path, errno);
+		if (fd >= 0)
+			close(fd);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	size = st.st_size;
+	if (size < LDX_CAN_CAPTURE_HEADER_SIZE) {
+		close(fd);
+		goto err_format;
+	}
+
+	hdr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (hdr == MAP_FAILED) {
+		log_error("%s: Unable to map %s (%d)", __func__, capture_path, errno);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	if (memcmp(hdr->magic, LDX_CAN_CAPTURE_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != LDX_CAN_CAPTURE_VERSION ||
+	    hdr->header_size != LDX_CAN_CAPTURE_HEADER_SIZE ||
+	    hdr->record_size <= sizeof(can_capture_record_t) ||
+	    hdr->record_size > sizeof(can_capture_record_t) + CANFD_MAX_DLEN ||
+	    hdr->capacity == 0 ||
+	    hdr->header_size + hdr->capacity * hdr->record_size > size) {
+		munmap((void *)hdr, size);
+		goto err_format;
+	}
+
+	f = fopen(pcapng_path, "we");
+	if (!f) {
+		log_error("%s: Unable to create %s (%d)", __func__, pcapng_path, errno);
+		munmap((void *)hdr, size);
+		return -CAN_ERROR_CAPTURE_FILE;
+	}
+
+	/* The file may be being written, take a consistent count */
+	count = __atomic_load_n(&hdr->count, __ATOMIC_ACQUIRE);
+	first = count > hdr->capacity ? count - hdr->capacity : 0;
+	data_len = hdr->record_size - sizeof(can_capture_record_t);
+
+	pcapng_write_headers(f, hdr, 8 + data_len);
+	for (i = first; i < count; i++)
+		pcapng_write_record(f, capture_record(hdr, i % hdr->capacity), data_len);
+
+	if (fclose(f) != 0) {
+		log_error("%s: Unable to write %s (%d)", __func__, pcapng_path, errno);
+		ret = -CAN_ERROR_CAPTURE_FILE;
+	}
+	munmap((void *)hdr, size);
+
+	return ret;
+
+err_format:
+	log_error("%s: %s is not a valid capture file", __func__, capture_path);
+
+	return -CAN_ERROR_CAPTURE_FORMAT;
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "can.h"
+#include "_can.h"
+#include "_log.h"
+
+/* Bits of the CAN ID that take part in the filtering */
+#define CAN_FILTER_KEY_MASK	(CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK)
+
+/* Fibonacci hashing of the 29-bit IDs into the lookup hash */
+#define CAN_EFF_HASH(key)	(((key) * 2654435761u) >> (32 - CAN_EFF_HASH_BITS))
+
+/* Keep the hash sparse enough for short probe sequences */
+#define CAN_EFF_HASH_MAX_USED	(CAN_EFF_HASH_LEN * 3 / 4)
+
+/*
+ * Same matching rule the kernel applies in raw_rcv():
+ * (received_can_id & mask) == (can_id & mask), inverted when the filter
+ * has the CAN_INV_FILTER flag.
+ */
+static bool can_filter_match(const struct can_filter *f, canid_t can_id)
+{
+	bool match;
+
+	match = ((can_id ^ f->can_id) & f->can_mask & ~CAN_INV_FILTER) == 0;
+
+	return (f->can_id & CAN_INV_FILTER) ? !match : match;
+}
+
+static bool can_cb_match(const can_cb_t *rx_cb, canid_t can_id)
+{
+	int i;
+
+	/* No filters means the handler wants every frame */
+	if (rx_cb->nfilters <= 0)
+		return true;
+
+	for (i = 0; i < rx_cb->nfilters; i++) {
+		if (can_filter_match(&rx_cb->filters[i], can_id))
+			return true;
+	}
+
+	return false;
+}
+
+/* Evaluate the filters of every handler in the table for the given ID */
+static uint64_t can_filter_table_eval(const can_filter_table_t *table, canid_t can_id)
+{
+	uint64_t handlers = 0;
+	int slot;
+
+	for (slot = 0; slot < CAN_SHARED_MAX_HANDLERS; slot++) {
+		const can_cb_t *rx_cb = table->handlers[slot];
+
+		if (rx_cb && can_cb_match(rx_cb, can_id))
+			handlers |= 1ULL << slot;
+	}
+
+	return handlers;
+}
+
+can_filter_table_t *can_filter_table_compile(struct list_head *rx_cb_list_head)
+{
+	can_filter_table_t *table;
+	can_cb_t *rx_cb;
+	canid_t id;
+	int rtr;
+
+	table = calloc(1, sizeof(can_filter_table_t));
+	if (!table) {
+		log_error("%s: Unable to allocate memory for the filter table",
+			  __func__);
+		return NULL;
+	}
+
+	INIT_LIST_HEAD(&table->list);
+
+	list_for_each_entry(rx_cb, rx_cb_list_head, list) {
+		uint64_t bit;
+
+		if (rx_cb->slot < 0)
+			continue;
+
+		bit = 1ULL << rx_cb->slot;
+		table->handlers[rx_cb->slot] = rx_cb;
+		table->all_mask |= bit;
+		if (rx_cb->batch_handler)
+			table->batch_mask |= bit;
+	}
+
+	/* The 11-bit space is small enough to be resolved up front */
+	for (rtr = 0; rtr < 2; rtr++) {
+		for (id = 0; id <= CAN_SFF_MASK; id++)
+			table->sff[rtr][id] = can_filter_table_eval(table,
+						id | (rtr ? CAN_RTR_FLAG : 0));
+	}
+
+	return table;
+}
+
+void can_filter_table_free(can_filter_table_t *table)
+{
+	free(table);
+}
+
+uint64_t can_filter_table_lookup(can_filter_table_t *table, canid_t can_id)
+{
+	canid_t key;
+	unsigned int idx;
+	uint64_t handlers;
+
+	/* Error frames are reported to every handler */
+	if (can_id & CAN_ERR_FLAG)
+		return table->all_mask;
+
+	if (!(can_id & CAN_EFF_FLAG))
+		return table->sff[!!(can_id & CAN_RTR_FLAG)][can_id & CAN_SFF_MASK];
+
+	/*
+	 * 29-bit IDs are resolved the first time they are received and
+	 * cached. The key always has CAN_EFF_FLAG set, so 0 marks a free entry.
+	 */
+	key = can_id & CAN_FILTER_KEY_MASK;
+	for (idx = CAN_EFF_HASH(key); table->eff[idx].key;
+	     idx = (idx + 1) & (CAN_EFF_HASH_LEN - 1)) {
+		if (table->eff[idx].key == key)
+			return table->eff[idx].handlers;
+	}
+
+	handlers = can_filter_table_eval(table, key);
+	if (table->eff_count < CAN_EFF_HASH_MAX_USED) {
+		table->eff[idx].key = key;
+		table->eff[idx].handlers = handlers;
+		table->eff_count++;
+	}
+
+	return handlers;
+}
+
+/* True if every ID accepted by filter b is also accepted by filter a */
+static bool can_filter_covers(const struct can_filter *a, const struct can_filter *b)
+{
+	if ((a->can_id | b->can_id) & CAN_INV_FILTER)
+		return a->can_id == b->can_id && a->can_mask == b->can_mask;
+
+	return (a->can_mask & ~b->can_mask) == 0 &&
+	       ((a->can_id ^ b->can_id) & a->can_mask) == 0;
+}
+
+int can_filter_merge(struct list_head *rx_cb_list_head, struct can_filter **kfilters)
+{
+	struct can_filter *merged = NULL;
+	can_cb_t *rx_cb;
+	int total = 0, n = 0, i, j;
+
+	*kfilters = NULL;
+
+	list_for_each_entry(rx_cb, rx_cb_list_head, list) {
+		if (rx_cb->slot < 0)
+			continue;
+
+		/* A handler without filters needs every frame */
+		if (rx_cb->nfilters <= 0)
+			return -1;
+
+		total += rx_cb->nfilters;
+	}
+
+	if (!total)
+		return 0;
+
+	/* Too many entries for the kernel, filter in user space only */
+	if (total > CAN_RAW_FILTER_MAX)
+		return -1;
+
+	merged = calloc(total, sizeof(struct can_filter));
+	if (!merged) {
+		log_error("%s: Unable to allocate memory for the filters", __func__);
+		return -1;
+	}
+
+	list_for_each_entry(rx_cb, rx_cb_list_head, list) {
+		if (rx_cb->slot < 0)
+			continue;
+
+		for (i = 0; i < rx_cb->nfilters; i++) {
+			const struct can_filter *f = &rx_cb->filters[i];
+			bool covered = false;
+
+			for (j = 0; j < n; j++) {
+				if (can_filter_covers(&merged[j], f)) {
+					covered = true;
+					break;
+				}
+			}
+			if (covered)
+				continue;
+
+			/* Drop the filters the new one makes redundant */
+			for (j = 0; j < n; ) {
+				if (can_filter_covers(f, &merged[j]))
+					merged[j] = merged[--n];
+				else
+					j++;
+			}
+
+			merged[n++] = *f;
+		}
+	}
+
+	*kfilters = merged;
+
+	return n;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can.h"
+#include "_can.h"
+#include "_log.h"
+
+static unsigned int roundup_pow_of_two(unsigned int n)
+{
+	unsigned int len = 1;
+
+	while (len < n)
+		len <<= 1;
+
+	return len;
+}
+
+can_rx_queue_t *can_rx_queue_create(unsigned int len)
+{
+	can_rx_queue_t *queue;
+
+	/* Rounding up a length above 2^31 would overflow to 0 */
+	if (len > LDX_CAN_RX_QUEUE_MAX_LEN) {
+		log_error("%s: Rx queue length %u above the maximum %u",
+			  __func__, len, LDX_CAN_RX_QUEUE_MAX_LEN);
+		return NULL;
+	}
+
+	queue = calloc(1, sizeof(can_rx_queue_t));
+	if (!queue) {
+		log_error("%s: Unable to allocate memory for the rx queue", __func__);
+		return NULL;
+	}
+
+	/* A power of two length lets the indexes wrap with a mask */
+	queue->len = roundup_pow_of_two(len);
+	queue->frames = calloc(queue->len, sizeof(struct canfd_frame));
+	queue->tstamp = calloc(queue->len, sizeof(struct timeval));
+	if (!queue->frames || !queue->tstamp) {
+		log_error("%s: Unable to allocate memory for %u queued frames",
+			  __func__, queue->len);
+		goto err_free;
+	}
+
+	queue->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (queue->evfd < 0) {
+		log_error("%s: Unable to create eventfd (%d)", __func__, errno);
+		goto err_free;
+	}
+
+	return queue;
+
+err_free:
+	free(queue->frames);
+	free(queue->tstamp);
+	free(queue);
+
+	return NULL;
+}
+
+void can_rx_queue_free(can_rx_queue_t *queue)
+{
+	if (!queue)
+		return;
+
+	close(queue->evfd);
+	free(queue->frames);
+	free(queue->tstamp);
+	free(queue);
+}
+
+unsigned int can_rx_queue_push(can_rx_queue_t *queue, const struct canfd_frame *frames,
+			       const struct timeval *tstamp, unsigned int nframes)
+{
+	unsigned int head, tail, room, idx, i;
+
+	/* Only this side writes head, only the consumer writes tail */
+	head = queue->head;
+	tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+	room = queue->len - (head - tail);
+	if (nframes > room) {
+		queue->overruns += nframes - room;
+		nframes = room;
+	}
+
+	for (i = 0; i < nframes; i++) {
+		idx = (head + i) & (queue->len - 1);
+		queue->frames[idx] = frames[i];
+		queue->tstamp[idx] = tstamp[i];
+	}
+
+	__atomic_store_n(&queue->head, head + nframes, __ATOMIC_RELEASE);
+
+	/*
+	 * Pairs with the fence of the consumer: either it sees the new head
+	 * or this side sees it is going to sleep and wakes it up.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (nframes && __atomic_load_n(&queue->waiting, __ATOMIC_RELAXED)) {
+		uint64_t val = 1;
+
+		if (write(queue->evfd, &val, sizeof(val)) < 0)
+			log_debug("%s: eventfd write error (%d)", __func__, errno);
+	}
+
+	return nframes;
+}
+
+static unsigned int can_rx_queue_take(can_rx_queue_t *queue, struct canfd_frame *frames,
+				      struct timeval *tstamp, unsigned int max)
+{
+	unsigned int head, tail, avail, idx, i;
+
+	tail = queue->tail;
+	head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+	avail = head - tail;
+	if (avail > max)
+		avail = max;
+
+	for (i = 0; i < avail; i++) {
+		idx = (tail + i) & (queue->len - 1);
+		frames[i] = queue->frames[idx];
+		if (tstamp)
+			tstamp[i] = queue->tstamp[idx];
+	}
+
+	__atomic_store_n(&queue->tail, tail + avail, __ATOMIC_RELEASE);
+
+	return avail;
+}
+
+static int64_t can_rx_queue_now_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+int can_rx_queue_pop(can_rx_queue_t *queue, struct canfd_frame *frames,
+		     struct timeval *tstamp, unsigned int max, int timeout_ms)
+{
+	int64_t deadline = 0;
+	unsigned int n;
+
+	if (timeout_ms > 0)
+		deadline = can_rx_queue_now_ms() + timeout_ms;
+
+	for (;;) {
+		struct pollfd pfd = { .fd = queue->evfd, .events = POLLIN };
+		int tout = timeout_ms;
+		uint64_t val;
+		int ret;
+
+		n = can_rx_queue_take(queue, frames, tstamp, max);
+		if (n || !timeout_ms)
+			return n;
+
+		/* Announce the wait and check again, see can_rx_queue_push() */
+		__atomic_store_n(&queue->waiting, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		n = can_rx_queue_take(queue, frames, tstamp, max);
+		if (n) {
+			__atomic_store_n(&queue->waiting, 0, __ATOMIC_RELAXED);
+			return n;
+		}
+
+		if (timeout_ms > 0) {
+			int64_t left = deadline - can_rx_queue_now_ms();
+
+			tout = left > 0 ? (int)left : 0;
+		}
+
+		ret = poll(&pfd, 1, tout);
+		__atomic_store_n(&queue->waiting, 0, __ATOMIC_RELAXED);
+		if (ret < 0 && errno != EINTR) {
+			log_error("%s: poll error (%d)", __func__, errno);
+			return -CAN_ERROR_RX_QUEUE_WAIT;
+		}
+
+		if (ret > 0 && read(queue->evfd, &val, sizeof(val)) < 0)
+			log_debug("%s: eventfd read error (%d)", __func__, errno);
+
+		if (ret == 0)
+			return can_rx_queue_take(queue, frames, tstamp, max);
+	}
+}
@@ -14,11 +14,16 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <ctype.h>
+#include <errno.h>
 #include <linux/version.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "_log.h"
@@ -26,6 +31,8 @@
 #include "common.h"
 
 #define DEFAULT_DIGIAPIX_CFG_FILE	"/etc/libdigiapix.conf"
+#define DEFAULT_LIBSOC_CFG_FILE		"/etc/libsoc.conf"
+#define CFG_LINE_LEN			256
 #define PLATFORM_PATH				"/proc/device-tree/compatible"
 
 #if (LINUX_VERSION_CODE < KERNEL_VERSION(5,0,0))
@@ -41,17 +48,138 @@
 #define CC6_PLATFORM_STRING			"imx6q"
 #define CC6DL_PLATFORM_STRING 		"imx6dl"
 
+int ldx_log_mask = LOG_UPTO(LOG_ERR);
+
+static pthread_mutex_t log_ratelimit_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static void __attribute__ ((constructor(101))) digiapix_init(void);
 static void __attribute__ ((destructor(101))) digiapix_fini(void);
 
-static int config_load(void);
+/* Number of buckets of the alias table, must be a power of 2 */
+#define ALIAS_HASH_LEN			128
+
+/**
+ * alias_type_t - Configuration groups with aliases
+ */
+typedef enum {
+	ALIAS_GPIO,
+	ALIAS_PWM,
+	ALIAS_SPI,
+	ALIAS_I2C,
+	ALIAS_ADC,
+	__ALIAS_LAST
+} alias_type_t;
+
+static const char * const alias_groups[] = {
+	[ALIAS_GPIO] = "GPIO",
+	[ALIAS_PWM] = "PWM",
+	[ALIAS_SPI] = "SPI",
+	[ALIAS_I2C] = "I2C",
+	[ALIAS_ADC] = "ADC",
+};
+
+/**
+ * alias_t - Parsed alias of the configuration file
+ *
+ * @next:	Next alias in the same bucket.
+ * @type:	Group of the alias.
+ * @name:	Name of the alias.
+ * @gpio:	GPIO: kernel number ("<number>"), or controller and line
+ *		("<controller>,<line>"), -1 and NULL if not set.
+ * @pwm:	PWM chip and channel ("<chip>,<channel>").
+ * @spi:	SPI device and slave ("<device>,<slave>").
+ * @i2c:	I2C bus ("<bus>").
+ * @adc:	ADC chip and channel ("<chip>,<channel>").
+ */
+typedef struct alias {
+	struct alias *next;
+	alias_type_t type;
+	char *name;
+	union {
+		struct {
+			int kernel_number;
+			char *controller;
+			int line;
+		} gpio;
+		struct {
+			int chip;
+			int channel;
+		} pwm;
+		struct {
+			int device;
+			int slave;
+		} spi;
+		struct {
+			int bus;
+		} i2c;
+		struct {
+			int chip;
+			int channel;
+		} adc;
+	};
+} alias_t;
+
+static void config_load(void);
 static void config_free(void);
-static int config_get_csv_integer(const char * const group, const char * const alias,
-				  int index);
-static int config_get_csv_string(const char * const group, const char * const alias,
-				 char * const controller, int index);
 
-static board_config *config;
+static alias_t *aliases[ALIAS_HASH_LEN];
+static bool config_loaded;
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+
+/**
+ * alias_hash() - Get the bucket of an alias
+ *
+ * @type:	Group of the alias.
+ * @name:	Name of the alias.
+ *
+ * Return: The bucket index (FNV-1a hash).
+ */
+static unsigned int alias_hash(alias_type_t type, const char *name)
+{
+	uint32_t hash = 2166136261u ^ type;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash & (ALIAS_HASH_LEN - 1);
+}
+
+/**
+ * config_get() - Get the configuration, loading it if needed
+ *
+ * Return: True if the configuration is available, false otherwise.
+ */
+static bool config_get(void)
+{
+	pthread_once(&config_once, config_load);
+
+	return config_loaded;
+}
+
+/**
+ * alias_find() - Find an alias in the configuration
+ *
+ * @type:	Group of the alias.
+ * @name:	Name of the alias.
+ *
+ * Return: The alias, NULL if not found.
+ */
+static const alias_t *alias_find(alias_type_t type, const char *name)
+{
+	const alias_t *alias;
+
+	if (name == NULL || !config_get())
+		return NULL;
+
+	for (alias = aliases[alias_hash(type, name)]; alias; alias = alias->next) {
+		if (alias->type == type && strcmp(alias->name, name) == 0)
+			return alias;
+	}
+
+	return NULL;
+}
 
 int config_check_alias(const char * const alias)
 {
@@ -61,7 +189,7 @@ int config_check_alias(const char * const alias)
 		return EXIT_FAILURE;
 	}
 
-	if (config == NULL) {
+	if (!config_get()) {
 		log_error("%s: Unable get requested alias ('%s')",
 				__func__, alias);
 		return EXIT_FAILURE;
@@ -72,52 +200,78 @@ int config_check_alias(const char * const alias)
 
 int config_get_gpio_kernel_number(const char * const alias)
 {
-	return libsoc_board_gpio_id(config, alias);
+	const alias_t *a = alias_find(ALIAS_GPIO, alias);
+
+	return a ? a->gpio.kernel_number : -1;
 }
 
 int config_get_gpio_controller(const char * const alias, char * const controller)
 {
-	return config_get_csv_string("GPIO", alias, controller, 0);
+	const alias_t *a = alias_find(ALIAS_GPIO, alias);
+
+	if (a == NULL || controller == NULL)
+		return EXIT_FAILURE;
+
+	if (a->gpio.controller != NULL)
+		strcpy(controller, a->gpio.controller);
+
+	return EXIT_SUCCESS;
 }
 
 int config_get_gpio_line(const char * const alias)
 {
-	return config_get_csv_integer("GPIO", alias, 1);
+	const alias_t *a = alias_find(ALIAS_GPIO, alias);
+
+	return a ? a->gpio.line : -1;
 }
 
 int config_get_pwm_chip_number(const char * const alias)
 {
-	return config_get_csv_integer("PWM", alias, 0);
+	const alias_t *a = alias_find(ALIAS_PWM, alias);
+
+	return a ? a->pwm.chip : -1;
 }
 
 int config_get_pwm_channel_number(const char * const alias)
 {
-	return config_get_csv_integer("PWM", alias, 1);
+	const alias_t *a = alias_find(ALIAS_PWM, alias);
+
+	return a ? a->pwm.channel : -1;
 }
 
 int config_get_spi_device_number(const char * const alias)
 {
-	return config_get_csv_integer("SPI", alias, 0);
+	const alias_t *a = alias_find(ALIAS_SPI, alias);
+
+	return a ? a->spi.device : -1;
 }
 
 int config_get_spi_slave_number(const char * const alias)
 {
-	return config_get_csv_integer("SPI", alias, 1);
+	const alias_t *a = alias_find(ALIAS_SPI, alias);
+
+	return a ? a->spi.slave : -1;
 }
 
 int config_get_i2c_bus(const char * const alias)
 {
-	return conffile_get_int(config->conf, "I2C", alias, -1);
+	const alias_t *a = alias_find(ALIAS_I2C, alias);
+
+	return a ? a->i2c.bus : -1;
 }
 
 int config_get_adc_chip_number(const char * const alias)
 {
-	return config_get_csv_integer("ADC", alias, 0);
+	const alias_t *a = alias_find(ALIAS_ADC, alias);
+
+	return a ? a->adc.chip : -1;
 }
 
 int config_get_adc_channel_number(const char * const alias)
 {
-	return config_get_csv_integer("ADC", alias, 1);
+	const alias_t *a = alias_find(ALIAS_ADC, alias);
+
+	return a ? a->adc.channel : -1;
 }
 
 int check_request_mode(request_mode_t request_mode)
@@ -132,6 +286,62 @@ int check_request_mode(request_mode_t request_mode)
 	}
 }
 
+int log_set_mask(int mask)
+{
+	int old_mask = setlogmask(mask);
+
+	/*
+	 * Cache the mask the system logger really uses, so a mask set by the
+	 * process with 'setlogmask()' is picked up here too.
+	 */
+	__atomic_store_n(&ldx_log_mask, setlogmask(0), __ATOMIC_RELAXED);
+
+	return old_mask;
+}
+
+bool log_ratelimit(log_ratelimit_t *rs, const char *func)
+{
+	struct timespec ts;
+	int64_t now;
+	int missed = 0;
+	bool ret;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+
+	pthread_mutex_lock(&log_ratelimit_mutex);
+
+	if (rs->begin_ms == 0 || now - rs->begin_ms >= LOG_RATELIMIT_INTERVAL_MS) {
+		missed = rs->missed;
+		rs->begin_ms = now;
+		rs->printed = 0;
+		rs->missed = 0;
+	}
+
+	ret = rs->printed < LOG_RATELIMIT_BURST;
+	if (ret)
+		rs->printed++;
+	else
+		rs->missed++;
+
+	pthread_mutex_unlock(&log_ratelimit_mutex);
+
+	if (missed > 0)
+		syslog(LOG_WARNING, "[WARNING] %s: %d messages suppressed", func, missed);
+
+	return ret;
+}
+
+int ldx_set_log_level(int level)
+{
+	return log_set_mask(LOG_UPTO(level));
+}
+
+int ldx_refresh_log_mask(void)
+{
+	return log_set_mask(0);
+}
+
 /**
  * digiapix_init() - Initializes the library
  *
@@ -141,7 +351,9 @@ static void digiapix_init(void)
 {
 	init_logger(LOG_ERR, LOG_CONS | LOG_NDELAY | LOG_PID | LOG_PERROR);
 
-	config_load();
+#ifndef LDX_LAZY_CONFIG
+	config_get();
+#endif
 }
 
 /**
@@ -158,114 +370,262 @@ static void digiapix_fini(void)
 }
 
 /**
- * config_load() - Load board configuration specific values
+ * strip() - Remove the leading and trailing white spaces of a string
  *
- * Use 'config_free()' to free the configuration memory.
+ * @str:	The string to strip, it is modified.
  *
- * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ * Return: Pointer to the first non white space character of the string.
  */
-static int config_load(void)
+static char *strip(char *str)
 {
-	if (config == NULL) {
-		if (access(DEFAULT_DIGIAPIX_CFG_FILE, R_OK) == 0 &&
-		    setenv("LIBSOC_CONF", DEFAULT_DIGIAPIX_CFG_FILE, 1) != 0)
-			return EXIT_FAILURE;
-		config = libsoc_board_init();
-	}
+	char *end;
+
+	while (isspace((unsigned char)*str))
+		str++;
+
+	end = str + strlen(str);
+	while (end > str && isspace((unsigned char)end[-1]))
+		end--;
+	*end = '\0';
 
-	return config == NULL ? EXIT_FAILURE : EXIT_SUCCESS;
+	return str;
 }
 
 /**
- * config_free() - Free up memory for the configuration
+ * get_int() - Parse a string that must be an integer
+ *
+ * @str:	The string to parse.
+ *
+ * Return: The integer, -1 if the string is not an integer.
  */
-static void config_free(void)
+static int get_int(const char *str)
 {
-	if (config != NULL) {
-		libsoc_board_free(config);
-		config = NULL;
+	char *end;
+	long value;
+
+	value = strtol(str, &end, 10);
+	if (end == str || *end != '\0')
+		return -1;
+
+	return value;
+}
+
+/**
+ * get_csv_field() - Get a field of a comma-separated value
+ *
+ * @value:	The comma-separated value.
+ * @index:	The index of the field.
+ * @len:	Pointer to store the length of the field.
+ *
+ * Return: Pointer to the beginning of the field, NULL if it does not exist.
+ */
+static const char *get_csv_field(const char *value, int index, size_t *len)
+{
+	const char *field = value;
+
+	/* Same as strtok(): empty fields are skipped */
+	for (;;) {
+		field += strspn(field, ",");
+		if (*field == '\0')
+			return NULL;
+		*len = strcspn(field, ",");
+		if (index-- == 0)
+			return field;
+		field += *len;
 	}
 }
 
 /**
- * config_get_csv_integer() - Return the comma-separated integer for the given
- *                            index in the requested configuration value
+ * get_csv_int() - Get an integer field of a comma-separated value
  *
- * @group: The configuration group.
- * @alias: The alias of the comma-separated configuration value.
- * @index: The index of the comma-separated value to get
+ * @value:	The comma-separated value.
+ * @index:	The index of the field.
  *
- * Return: The selected item, or -1 on error.
+ * Return: The integer, -1 if the field does not exist.
  */
-static int config_get_csv_integer(const char * const group, const char * const alias, int index)
+static int get_csv_int(const char *value, int index)
 {
-	char *array = NULL;
-	char *token = NULL;
-	int item_index = 0;
-	int item = -1;
-	const char *value = conffile_get(config->conf, group, alias, NULL);
+	size_t len;
+	const char *field = get_csv_field(value, index, &len);
 
-	if (value == NULL)
-		return -1;
+	return field ? atoi(field) : -1;
+}
 
-	array = strdup(value);
-	if (array == NULL)
-		return -1;
-	token = strtok(array, ",");
+/**
+ * alias_add() - Parse an alias and add it to the configuration
+ *
+ * @type:	Group of the alias.
+ * @name:	Name of the alias.
+ * @value:	Value of the alias.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int alias_add(alias_type_t type, const char *name, const char *value)
+{
+	unsigned int bucket = alias_hash(type, name);
+	const char *field;
+	alias_t *alias, **a;
+	size_t len;
+
+	/* The first definition of an alias wins */
+	for (a = &aliases[bucket]; *a; a = &(*a)->next) {
+		if ((*a)->type == type && strcmp((*a)->name, name) == 0)
+			return EXIT_SUCCESS;
+	}
+
+	alias = calloc(1, sizeof(*alias));
+	if (alias == NULL)
+		return EXIT_FAILURE;
 
-	/* Walk through other tokens */
-	while (token && (item_index < index)) {
-		token = strtok(NULL, ",");
-		item_index++;
+	alias->type = type;
+	alias->name = strdup(name);
+	if (alias->name == NULL) {
+		free(alias);
+		return EXIT_FAILURE;
 	}
 
-	if (token != NULL)
-		item = (unsigned int)atoi(token);
+	switch (type) {
+	case ALIAS_GPIO:
+		alias->gpio.kernel_number = get_int(value);
+		alias->gpio.line = get_csv_int(value, 1);
+		field = get_csv_field(value, 0, &len);
+		if (field != NULL) {
+			alias->gpio.controller = strndup(field, len);
+			if (alias->gpio.controller == NULL) {
+				free(alias->name);
+				free(alias);
+				return EXIT_FAILURE;
+			}
+		}
+		break;
+	case ALIAS_PWM:
+		alias->pwm.chip = get_csv_int(value, 0);
+		alias->pwm.channel = get_csv_int(value, 1);
+		break;
+	case ALIAS_SPI:
+		alias->spi.device = get_csv_int(value, 0);
+		alias->spi.slave = get_csv_int(value, 1);
+		break;
+	case ALIAS_I2C:
+		alias->i2c.bus = get_int(value);
+		break;
+	case ALIAS_ADC:
+		alias->adc.chip = get_csv_int(value, 0);
+		alias->adc.channel = get_csv_int(value, 1);
+		break;
+	default:
+		break;
+	}
 
-	free(array);
+	*a = alias;
 
-	return item;
+	return EXIT_SUCCESS;
 }
 
 /**
- * config_get_csv_string() - Reads the comma-separated string for the given
- *                           index in the requested configuration value
+ * config_parse() - Parse a configuration file into the alias table
  *
- * @group: The configuration group.
- * @alias: The alias of the comma-separated configuration value.
- * @item: Array where the item is stored on success.
- * @index: The index of the comma-separated value to get
+ * @path:	Path of the configuration file.
  *
- * Return: EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ * The file has the same format libsoc uses: '[GROUP]' lines start a group
+ * and 'alias = value' lines define the aliases of the group.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int config_get_csv_string(const char * const group, const char * const alias,
-				 char * const item, int index)
+static int config_parse(const char *path)
 {
-	char *array = NULL;
-	char *token = NULL;
-	int item_index = 0;
-	const char *value = conffile_get(config->conf, group, alias, NULL);
+	char line[CFG_LINE_LEN];
+	int type = __ALIAS_LAST;
+	FILE *f;
 
-	if (value == NULL || item == NULL)
+	f = fopen(path, "re");
+	if (f == NULL) {
+		log_debug("%s: Unable to open '%s': %s", __func__, path, strerror(errno));
 		return EXIT_FAILURE;
+	}
 
-	array = strdup(value);
-	if (array == NULL)
-		return EXIT_FAILURE;
-	token = strtok(array, ",");
+	while (fgets(line, sizeof(line), f) != NULL) {
+		char *l = strip(line), *sep;
+
+		if (*l == '\0' || *l == '#')
+			continue;
+
+		if (*l == '[') {
+			sep = strchr(l, ']');
+			if (sep == NULL)
+				continue;
+			*sep = '\0';
+			for (type = 0; type < __ALIAS_LAST; type++) {
+				if (strcmp(l + 1, alias_groups[type]) == 0)
+					break;
+			}
+			continue;
+		}
+
+		sep = strchr(l, '=');
+		if (sep == NULL || type == __ALIAS_LAST)
+			continue;
+		*sep = '\0';
+
+		if (alias_add(type, strip(l), strip(sep + 1)) != EXIT_SUCCESS) {
+			log_error("%s: Unable to load '%s': Out of memory", __func__, path);
+			fclose(f);
+			return EXIT_FAILURE;
+		}
+	}
+
+	fclose(f);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * config_load() - Load board configuration specific values
+ *
+ * The configuration file is parsed once into a table of aliases. Run it
+ * through 'config_get()'; use 'config_free()' to free the configuration
+ * memory.
+ */
+static void config_load(void)
+{
+	const char *path;
+
+	if (access(DEFAULT_DIGIAPIX_CFG_FILE, R_OK) == 0 &&
+	    setenv("LIBSOC_CONF", DEFAULT_DIGIAPIX_CFG_FILE, 1) != 0)
+		return;
+
+	path = getenv("LIBSOC_CONF");
+	if (path == NULL)
+		path = DEFAULT_LIBSOC_CFG_FILE;
 
-	/* Walk through other tokens */
-	while (token && (item_index < index)) {
-		token = strtok(NULL, ",");
-		item_index++;
+	if (config_parse(path) != EXIT_SUCCESS) {
+		config_free();
+		return;
 	}
 
-	if (token != NULL)
-		strcpy(item, token);
+	config_loaded = true;
+}
 
-	free(array);
+/**
+ * config_free() - Free up memory for the configuration
+ */
+static void config_free(void)
+{
+	int i;
+
+	for (i = 0; i < ALIAS_HASH_LEN; i++) {
+		while (aliases[i] != NULL) {
+			alias_t *alias = aliases[i];
+
+			aliases[i] = alias->next;
+			if (alias->type == ALIAS_GPIO)
+				free(alias->gpio.controller);
+			free(alias->name);
+			free(alias);
+		}
+	}
 
-	return EXIT_SUCCESS;
+	config_loaded = false;
 }
 
 /**
@@ -14,20 +14,30 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <dirent.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <errno.h>
 #include <gpiod.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <linux/gpio.h>
 
 #include "_common.h"
 #include "_libsoc_interfaces.h"
 #include "_log.h"
+#include "_stats.h"
+#include "_timestamp.h"
+#include "_trace.h"
 #include "gpio.h"
+#include "reactor.h"
 
 struct wait_irq_t {
 	pthread_t *poll_thread;
@@ -35,12 +45,39 @@ struct wait_irq_t {
 };
 
 struct poll_ctx_t {
+	gpio_t *gpio;
 	int fd;
 	int sigfd;
+	bool sysfs;
 	int (*callback_fn) (void *);
 	void *arg;
 };
 
+/* libgpiod reads at most this number of events at once */
+#define GPIO_EVENT_READ_MAX	16
+
+struct event_stream_t {
+	gpio_t *gpio;
+	int fd;
+	int stopfd;
+	bool run;
+	pthread_t reader;
+	pthread_t dispatcher;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	gpio_event_t *ring;
+	unsigned int len;	/* Power of two, so the indexes wrap with a mask */
+	unsigned int head;
+	unsigned int tail;
+	uint64_t overruns;
+	unsigned int readers;	/* Threads in 'read_stream_events()' */
+	ldx_gpio_events_cb_t callback_fn;
+	void *arg;
+};
+
+/* Protects the '_event_stream' pointer of the GPIOs while it is taken */
+static pthread_mutex_t event_streams_lock = PTHREAD_MUTEX_INITIALIZER;
+
 struct _gpio_t {
 	int _mode;
 	gpio_active_mode_t _active_mode;
@@ -48,12 +85,27 @@ struct _gpio_t {
 	struct gpiod_chip *_chip;
 	struct gpiod_line *_line;
 	struct wait_irq_t *_wait_irq;
+	struct event_stream_t *_event_stream;
+	reactor_t *_reactor;
+	int _active_low_fd;
+	bool _own_controller;
+};
+
+struct _gpio_bank_t {
+	struct gpiod_chip *_chip;
+	struct gpiod_line_bulk _bulk;
+	int _mode;
+	uint64_t _values;
 };
 
 #define UNDEFINED_SYSFS_GPIO (-1)
 
 #define BUFF_SIZE	256
 
+/* Fits "/sys/class/gpio/<entry>/<attribute>" for any directory entry name */
+#define GPIOCHIP_ATTR_PATH_LEN	\
+	(sizeof("/sys/class/gpio/") + NAME_MAX + sizeof("/ngpio"))
+
 #define _GPIO_DIR_MODES	M(in) \
 			M(low) \
 			M(high)
@@ -98,6 +150,11 @@ static int check_gpio(gpio_t *gpio);
 static char * show_gpio(gpio_t *gpio);
 static int set_direction(libsoc_gpio_t *gpio, _gpio_dir_modes_t dir);
 static int check_mode(gpio_mode_t mode);
+static int check_gpio_bank(gpio_bank_t *bank);
+static int check_bank_mode(gpio_mode_t mode);
+static int open_sysfs_attr(unsigned int kernel_number, const char *attr);
+static int resolve_kernel_number(unsigned int kernel_number, char *label,
+				 unsigned int *line);
 
 gpio_t *ldx_gpio_request(unsigned int kernel_number, gpio_mode_t mode,
 			 request_mode_t request_mode)
@@ -156,6 +213,9 @@ gpio_t *ldx_gpio_request(unsigned int kernel_number, gpio_mode_t mode,
 	data->_mode = GPIO_MODE_ERROR;
 	data->_internal_gpio = internal_gpio;
 
+	/* Keep the attribute open so hot calls do not pay the path lookup */
+	data->_active_low_fd = open_sysfs_attr(kernel_number, "active_low");
+
 	memcpy(new_gpio, &init_gpio, sizeof(gpio_t));
 	new_gpio->_data = data;
 
@@ -300,6 +360,7 @@ gpio_t *ldx_gpio_request_by_controller(const char * const controller,
 
 	data->_mode = GPIO_MODE_ERROR;
 	data->_active_mode = GPIO_ACTIVE_HIGH;
+	data->_active_low_fd = -1;
 	data->_chip = chip;
 	data->_line = line;
 
@@ -314,6 +375,48 @@ gpio_t *ldx_gpio_request_by_controller(const char * const controller,
 	return new_gpio;
 }
 
+gpio_t *ldx_gpio_request_fast(unsigned int kernel_number, gpio_mode_t mode)
+{
+	char label[MAX_CONTROLLER_LEN];
+	unsigned int line;
+	gpio_t *new_gpio = NULL;
+
+	if (check_mode(mode) != EXIT_SUCCESS)
+		return NULL;
+
+	if (resolve_kernel_number(kernel_number, label, &line) != EXIT_SUCCESS) {
+		log_debug("%s: GPIO %d has no controller, using sysfs",
+			  __func__, kernel_number);
+		return ldx_gpio_request(kernel_number, mode, REQUEST_SHARED);
+	}
+
+	log_debug("%s: GPIO %d is '%s %u'", __func__, kernel_number, label, line);
+
+	new_gpio = ldx_gpio_request_by_controller(label, line, mode);
+	if (new_gpio != NULL) {
+		struct _gpio_t *_data = new_gpio->_data;
+		gpio_t init_gpio = {
+			.alias = NULL,
+			.kernel_number = UNDEFINED_SYSFS_GPIO,
+			.gpio_controller = strdup(label),
+			.gpio_line = line,
+			._data = _data
+		};
+
+		if (init_gpio.gpio_controller == NULL) {
+			log_error("%s: Unable to request GPIO %d, cannot allocate memory",
+				  __func__, kernel_number);
+			ldx_gpio_free(new_gpio);
+			return NULL;
+		}
+
+		memcpy(new_gpio, &init_gpio, sizeof(gpio_t));
+		_data->_own_controller = true;
+	}
+
+	return new_gpio;
+}
+
 int ldx_gpio_get_kernel_number(const char * const gpio_alias)
 {
 	if (config_check_alias(gpio_alias) != EXIT_SUCCESS)
@@ -353,6 +456,13 @@ int ldx_gpio_free(gpio_t *gpio)
 	if (gpio->_data == NULL)
 		return EXIT_SUCCESS;
 
+	/* Make sure no thread or reactor keeps using the GPIO */
+	if (_data->_wait_irq != NULL)
+		ldx_gpio_stop_wait_interrupt(gpio);
+
+	if (_data->_event_stream != NULL)
+		ldx_gpio_stop_event_stream(gpio);
+
 	if (_data->_internal_gpio != NULL)
 		ret = libsoc_gpio_free(_data->_internal_gpio);
 
@@ -362,11 +472,18 @@ int ldx_gpio_free(gpio_t *gpio)
 	if (_data->_chip != NULL)
 		gpiod_chip_close(_data->_chip);
 
-	free(gpio->_data);
+	if (_data->_active_low_fd >= 0)
+		close(_data->_active_low_fd);
 
-	/* Free controller label if requested internally by request_by_alias */
-	if (gpio->gpio_controller != NULL && gpio->alias != NULL)
+	/*
+	 * Free controller label if requested internally by request_by_alias
+	 * or request_fast
+	 */
+	if (gpio->gpio_controller != NULL &&
+	    (gpio->alias != NULL || _data->_own_controller))
 		free((char*)gpio->gpio_controller);
+
+	free(gpio->_data);
 	free(gpio);
 
 	return ret;
@@ -627,7 +744,7 @@ gpio_mode_t ldx_gpio_get_mode(gpio_t *gpio)
 	return GPIO_MODE_ERROR;
 }
 
-int ldx_gpio_set_value(gpio_t *gpio, gpio_value_t value)
+static int gpio_set_value(gpio_t *gpio, gpio_value_t value)
 {
 	struct _gpio_t *_data = NULL;
 	int ret = EXIT_FAILURE;
@@ -654,6 +771,10 @@ int ldx_gpio_set_value(gpio_t *gpio, gpio_value_t value)
 
 	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO)
 		ret = gpiod_line_set_value(_data->_line, value);
+	else if (_data->_internal_gpio->value_fd >= 0)
+		ret = pwrite(_data->_internal_gpio->value_fd,
+			     value == GPIO_HIGH ? "1" : "0", 1, 0) == 1 ?
+			EXIT_SUCCESS : EXIT_FAILURE;
 	else
 		ret = libsoc_gpio_set_level(_data->_internal_gpio, value);
 
@@ -664,7 +785,18 @@ int ldx_gpio_set_value(gpio_t *gpio, gpio_value_t value)
 	return ret;
 }
 
-gpio_value_t ldx_gpio_get_value(gpio_t *gpio)
+int ldx_gpio_set_value(gpio_t *gpio, gpio_value_t value)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = gpio_set_value(gpio, value);
+	stats_end(STATS_API_GPIO_SET_VALUE, start, stats_result(ret), 0);
+
+	return ret;
+}
+
+static gpio_value_t gpio_get_value(gpio_t *gpio)
 {
 	struct _gpio_t *_data = NULL;
 	int level;
@@ -677,10 +809,19 @@ gpio_value_t ldx_gpio_get_value(gpio_t *gpio)
 
 	_data = gpio->_data;
 
-	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO)
+	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO) {
 		level = gpiod_line_get_value(_data->_line);
-	else
+	} else if (_data->_internal_gpio->value_fd >= 0) {
+		char buf;
+
+		/* One syscall, no need to rewind the file */
+		if (pread(_data->_internal_gpio->value_fd, &buf, 1, 0) == 1)
+			level = buf == '1' ? GPIO_HIGH : GPIO_LOW;
+		else
+			level = LEVEL_ERROR;
+	} else {
 		level = libsoc_gpio_get_level(_data->_internal_gpio);
+	}
 
 	if (level == LEVEL_ERROR) {
 		log_error("%s: Unable to get GPIO %s value", __func__,
@@ -690,6 +831,18 @@ gpio_value_t ldx_gpio_get_value(gpio_t *gpio)
 	return level;
 }
 
+gpio_value_t ldx_gpio_get_value(gpio_t *gpio)
+{
+	uint64_t start = stats_begin();
+	gpio_value_t ret;
+
+	ret = gpio_get_value(gpio);
+	stats_end(STATS_API_GPIO_GET_VALUE, start,
+		  stats_result_ok(ret != GPIO_VALUE_ERROR), 0);
+
+	return ret;
+}
+
 int ldx_gpio_set_active_mode(gpio_t *gpio, gpio_active_mode_t active_mode)
 {
 	struct _gpio_t *_data = gpio->_data;
@@ -728,29 +881,17 @@ int ldx_gpio_set_active_mode(gpio_t *gpio, gpio_active_mode_t active_mode)
 		if (ldx_gpio_set_mode(gpio, _data->_mode) != EXIT_SUCCESS)
 			return EXIT_FAILURE;
 	} else {
-		int fd;
-		char path[BUFF_SIZE];
-
-		sprintf(path, "/sys/class/gpio/gpio%d/active_low", gpio->kernel_number);
+		const char *str = gpio_active_mode_strings[active_mode];
 
-		fd = open(path, O_SYNC | O_WRONLY);
-
-		if (fd < 0) {
+		if (_data->_active_low_fd < 0) {
 			log_error("%s: Unable to set GPIO %d active mode",
 					  __func__, gpio->kernel_number);
 			return EXIT_FAILURE;
 		}
 
-		if (write(fd, gpio_active_mode_strings[active_mode], BUFF_SIZE) < 0) {
+		if (pwrite(_data->_active_low_fd, str, strlen(str), 0) < 0) {
 			log_error("%s: Unable to change GPIO %d active mode",
 					  __func__, gpio->kernel_number);
-			close(fd);
-			return EXIT_FAILURE;
-		}
-
-		if (close(fd) < 0) {
-			log_error("%s: Unable to set GPIO %d active mode",
-					  __func__, gpio->kernel_number);
 			return EXIT_FAILURE;
 		}
 	}
@@ -775,29 +916,11 @@ gpio_active_mode_t ldx_gpio_get_active_mode(gpio_t *gpio)
 		return (current_active_mode == GPIOD_LINE_ACTIVE_STATE_HIGH) ?
 			   GPIO_ACTIVE_HIGH : GPIO_ACTIVE_LOW;
 	} else {
-		char tmp_str[BUFF_SIZE], level[2];
-		int fd;
-
-		sprintf(tmp_str, "/sys/class/gpio/gpio%d/active_low", gpio->kernel_number);
-
-		fd = open(tmp_str, O_RDONLY);
-
-		if (fd < 0) {
-			log_error("%s: Unable to get GPIO %d active mode",
-					  __func__, gpio->kernel_number);
-			return GPIO_ACTIVE_MODE_ERROR;
-		}
-
-		lseek(fd, 0, SEEK_SET);
-
-		if (read(fd, level, 2) != 2) {
-			log_error("%s: Unable to get GPIO %d active mode",
-					  __func__, gpio->kernel_number);
-			close(fd);
-			return GPIO_ACTIVE_MODE_ERROR;
-		}
+		struct _gpio_t *_data = gpio->_data;
+		char level[2];
 
-		if (close(fd) < 0) {
+		if (_data->_active_low_fd < 0 ||
+		    pread(_data->_active_low_fd, level, 2, 0) != 2) {
 			log_error("%s: Unable to get GPIO %d active mode",
 					  __func__, gpio->kernel_number);
 			return GPIO_ACTIVE_MODE_ERROR;
@@ -901,13 +1024,141 @@ void *libgpio_poll_thread(void *data)
 		}
 
 		if (pfds.revents) {
-			struct gpiod_line_event event;
+			struct gpiod_line_event events[GPIO_EVENT_READ_MAX];
+			int i, n;
+
+			/* Drain every queued edge with a single read */
+			n = gpiod_line_event_read_fd_multiple(ctx->fd, events,
+							      GPIO_EVENT_READ_MAX);
+			if (n <= 0)
+				continue;
+
+			trace_gpio_irq_begin(ctx->gpio, n);
+			for (i = 0; i < n; i++)
+				ctx->callback_fn(ctx->arg);
+			trace_gpio_irq_end(ctx->gpio, n);
+		}
+	}
+}
+
+/**
+ * gpio_reactor_cb() - Reactor callback for GPIO interrupts
+ *
+ * @fd:		The GPIO event descriptor (gpiod line or sysfs value file).
+ * @events:	The ready events.
+ * @data:	The poll context of the GPIO.
+ */
+static void gpio_reactor_cb(int fd, uint32_t events, void *data)
+{
+	struct poll_ctx_t *ctx = data;
+	struct gpiod_line_event gevents[GPIO_EVENT_READ_MAX];
+	int i, n = 1;
 
-			gpiod_line_event_read_fd(ctx->fd, &event);
+	if (ctx->sysfs) {
+		char level[2];
 
-			ctx->callback_fn(ctx->arg);
+		/* sysfs value file, read it to acknowledge the edge */
+		if (pread(fd, level, sizeof(level), 0) < 0) {
+			log_debug("%s: error reading GPIO value", __func__);
+			return;
+		}
+	} else {
+		/* Drain every queued edge with a single read */
+		n = gpiod_line_event_read_fd_multiple(fd, gevents,
+						      GPIO_EVENT_READ_MAX);
+		if (n <= 0) {
+			log_debug("%s: error reading GPIO events", __func__);
+			return;
 		}
 	}
+
+	trace_gpio_irq_begin(ctx->gpio, n);
+	for (i = 0; i < n; i++)
+		ctx->callback_fn(ctx->arg);
+	trace_gpio_irq_end(ctx->gpio, n);
+}
+
+/**
+ * gpio_reactor_add() - Serve the given interrupt descriptor from the reactor
+ *
+ * @gpio:		The GPIO to wait for interrupts on.
+ * @fd:			The descriptor that signals the interrupts.
+ * @sysfs:		True if the descriptor is a sysfs value file.
+ * @interrupt_cb:	Function to call when an interrupt occurs.
+ * @arg:		Argument of the callback.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int gpio_reactor_add(gpio_t *gpio, int fd, bool sysfs,
+			    const ldx_gpio_interrupt_cb_t interrupt_cb, void *arg)
+{
+	struct _gpio_t *_data = gpio->_data;
+	struct wait_irq_t *wait_irq = NULL;
+	struct poll_ctx_t *poll_ctx = NULL;
+
+	wait_irq = calloc(1, sizeof(struct wait_irq_t));
+	poll_ctx = calloc(1, sizeof(struct poll_ctx_t));
+	if (wait_irq == NULL || poll_ctx == NULL) {
+		log_error("%s: Error allocating mem for wait_irq on GPIO %s",
+			  __func__, show_gpio(gpio));
+		goto err_free;
+	}
+
+	poll_ctx->gpio = gpio;
+	poll_ctx->fd = fd;
+	poll_ctx->sysfs = sysfs;
+	poll_ctx->callback_fn = interrupt_cb;
+	poll_ctx->arg = arg;
+	wait_irq->poll_ctx = poll_ctx;
+
+	/* Discard any stale level before waiting for edges */
+	if (sysfs) {
+		char level[2];
+
+		if (pread(fd, level, sizeof(level), 0) < 0)
+			log_debug("%s: error reading GPIO %s value", __func__,
+				  show_gpio(gpio));
+	}
+
+	if (ldx_reactor_add_fd(_data->_reactor, fd, sysfs ? EPOLLPRI : EPOLLIN,
+			       gpio_reactor_cb, poll_ctx) != EXIT_SUCCESS) {
+		log_error("%s: Unable to attach GPIO %s to the reactor", __func__,
+			  show_gpio(gpio));
+		goto err_free;
+	}
+
+	_data->_wait_irq = wait_irq;
+
+	log_debug("%s: Start waiting for interrupts on GPIO %s", __func__,
+		  show_gpio(gpio));
+
+	return EXIT_SUCCESS;
+
+err_free:
+	free(poll_ctx);
+	free(wait_irq);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_gpio_set_reactor(gpio_t *gpio, reactor_t *reactor)
+{
+	struct _gpio_t *_data = NULL;
+
+	if (check_gpio(gpio) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_data = gpio->_data;
+
+	if (_data->_wait_irq != NULL) {
+		log_error("%s: irq already in use on GPIO %s", __func__,
+			  show_gpio(gpio));
+		return EXIT_FAILURE;
+	}
+
+	_data->_reactor = reactor;
+
+	return EXIT_SUCCESS;
 }
 
 int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t interrupt_cb,
@@ -947,7 +1198,7 @@ int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t in
 			return EXIT_FAILURE;
 		}
 
-		if (_data->_wait_irq != NULL) {
+		if (_data->_wait_irq != NULL || _data->_event_stream != NULL) {
 			log_error("%s: irq already in use on GPIO %s", __func__,
 				  show_gpio(gpio));
 			return EXIT_FAILURE;
@@ -960,6 +1211,9 @@ int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t in
 			return EXIT_FAILURE;
 		}
 
+		if (_data->_reactor)
+			return gpio_reactor_add(gpio, fd, false, interrupt_cb, arg);
+
 		wait_irq = malloc (sizeof (struct wait_irq_t));
 		if (wait_irq == NULL) {
 			log_error("%s: Error allocating mem for wait_irq on GPIO %s",
@@ -987,7 +1241,9 @@ int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t in
 		pthread_attr_init(&pthread_attr);
 		pthread_attr_setschedpolicy(&pthread_attr, SCHED_FIFO);
 
+		poll_ctx->gpio = gpio;
 		poll_ctx->fd = fd;
+		poll_ctx->sysfs = false;
 		poll_ctx->callback_fn = interrupt_cb;
 		poll_ctx->arg = arg;
 
@@ -1031,6 +1287,17 @@ int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t in
 			return EXIT_FAILURE;
 		}
 
+		if (_data->_reactor) {
+			if (_data->_wait_irq != NULL) {
+				log_error("%s: irq already in use on GPIO %s", __func__,
+					  show_gpio(gpio));
+				return EXIT_FAILURE;
+			}
+
+			return gpio_reactor_add(gpio, _data->_internal_gpio->value_fd,
+						true, interrupt_cb, arg);
+		}
+
 		log_debug("%s: Start waiting for interrupts on GPIO %d", __func__,
 			  gpio->kernel_number);
 
@@ -1050,7 +1317,17 @@ int ldx_gpio_stop_wait_interrupt(gpio_t *gpio)
 
 	_data = gpio->_data;
 
-	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO) {
+	if (_data->_reactor && _data->_wait_irq) {
+		/* Waits for the callback if it is running in a reactor thread */
+		ret = ldx_reactor_del_fd(_data->_reactor, _data->_wait_irq->poll_ctx->fd);
+
+		free(_data->_wait_irq->poll_ctx);
+		free(_data->_wait_irq);
+		_data->_wait_irq = NULL;
+
+		log_debug("%s: Stop waiting for interrupts on GPIO %s",
+			  __func__, show_gpio(gpio));
+	} else if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO) {
 		if (_data->_wait_irq && _data->_wait_irq->poll_thread != NULL) {
 			pthread_cancel(*_data->_wait_irq->poll_thread);
 			pthread_join(*_data->_wait_irq->poll_thread, NULL);
@@ -1083,100 +1360,978 @@ int ldx_gpio_stop_wait_interrupt(gpio_t *gpio)
 	return ret;
 }
 
-/**
- * check_gpio() - Verify that the GPIO pointer is valid
- *
- * @gpio:	The GPIO pointer to check.
- *
- * Return: EXIT_SUCCESS if the GPIO is valid, EXIT_FAILURE otherwise.
- */
-static int check_gpio(gpio_t *gpio)
+gpio_bank_t *ldx_gpio_bank_request(const char * const controller,
+				   const unsigned int * const lines,
+				   const unsigned int num_lines, gpio_mode_t mode)
 {
-	struct _gpio_t *_data = NULL;
+	gpio_bank_t *new_bank = NULL;
+	struct _gpio_bank_t *data = NULL;
+	struct gpiod_chip *chip = NULL;
+	unsigned int *bank_lines = NULL;
 
-	if (gpio == NULL) {
-		log_error("%s: GPIO cannot be NULL", __func__);
-		return EXIT_FAILURE;
+	if (check_bank_mode(mode) != EXIT_SUCCESS)
+		return NULL;
+
+	if (lines == NULL || num_lines == 0 || num_lines > LDX_GPIO_BANK_MAX_LINES) {
+		log_error("%s: Invalid number of lines, %u. It must be between 1 and %d",
+			  __func__, num_lines, LDX_GPIO_BANK_MAX_LINES);
+		return NULL;
 	}
 
-	_data = gpio->_data;
-	if (_data == NULL || (_data->_internal_gpio == NULL &&
-		_data->_chip == NULL && _data->_line == NULL)) {
-		log_error("%s: Invalid GPIO, %s", __func__,
-			  show_gpio(gpio));
-		return EXIT_FAILURE;
+	log_debug("%s: Requesting %u GPIOs of '%s' [mode '%s' (%d)]", __func__,
+		  num_lines, controller, gpio_mode_strings[mode], mode);
+
+	chip = gpiod_chip_open_lookup(controller);
+	if (!chip) {
+		log_error("%s: Unable to request GPIO bank of '%s', chip open failed",
+			  __func__, controller);
+		return NULL;
 	}
 
-	return EXIT_SUCCESS;
+	data = calloc(1, sizeof(struct _gpio_bank_t));
+	bank_lines = calloc(num_lines, sizeof(unsigned int));
+	new_bank = calloc(1, sizeof(gpio_bank_t));
+	if (data == NULL || bank_lines == NULL || new_bank == NULL) {
+		log_error("%s: Unable to request GPIO bank of '%s', cannot allocate memory",
+			  __func__, controller);
+		goto err_free;
+	}
+
+	memcpy(bank_lines, lines, num_lines * sizeof(unsigned int));
+
+	gpiod_line_bulk_init(&data->_bulk);
+	if (gpiod_chip_get_lines(chip, bank_lines, num_lines, &data->_bulk)) {
+		log_error("%s: Unable to request GPIO bank of '%s', chip get lines failed",
+			  __func__, controller);
+		goto err_free;
+	}
+
+	data->_chip = chip;
+	data->_mode = GPIO_MODE_ERROR;
+
+	{
+		gpio_bank_t init_bank = {
+			.gpio_controller = controller,
+			.gpio_lines = bank_lines,
+			.num_lines = num_lines,
+			._data = data
+		};
+
+		memcpy(new_bank, &init_bank, sizeof(gpio_bank_t));
+	}
+
+	if (ldx_gpio_bank_set_mode(new_bank, mode) != EXIT_SUCCESS) {
+		ldx_gpio_bank_free(new_bank);
+		return NULL;
+	}
+
+	return new_bank;
+
+err_free:
+	gpiod_chip_close(chip);
+	free(new_bank);
+	free(bank_lines);
+	free(data);
+
+	return NULL;
 }
 
-static char * show_gpio(gpio_t *gpio)
+int ldx_gpio_bank_free(gpio_bank_t *bank)
 {
-	static char _show_gpio[MAX_CONTROLLER_LEN] = "";
+	struct _gpio_bank_t *_data = NULL;
 
-	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO)
-		sprintf(_show_gpio, "%s %d", gpio->gpio_controller, gpio->gpio_line);
-	else
-		sprintf(_show_gpio, "%d", gpio->kernel_number);
+	if (bank == NULL)
+		return EXIT_SUCCESS;
 
-	return _show_gpio;
+	log_debug("%s: Freeing GPIO bank of '%s'", __func__, bank->gpio_controller);
+
+	_data = bank->_data;
+	if (_data != NULL) {
+		if (_data->_mode != GPIO_MODE_ERROR)
+			gpiod_line_release_bulk(&_data->_bulk);
+		gpiod_chip_close(_data->_chip);
+		free(_data);
+	}
+
+	free((unsigned int *)bank->gpio_lines);
+	free(bank);
+
+	return EXIT_SUCCESS;
 }
 
-/**
- * set_direction() - Set GPIO to input or output
- *
- * @gpio:	A pointer to the requested GPIO to set its direction.
- * @dir:	The desired GPIO direction (_gpio_dir_modes_t).
- *
- * This function configures the direction (_gpio_dir_modes_t) of the given GPIO:
- *    - in: input, its value can be read.
- *    - low: output with low as initial value, its value can be written.
- *    - high: output with high as initial value, its value can be written.
- *
- * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
- */
-static int set_direction(libsoc_gpio_t *gpio, _gpio_dir_modes_t dir)
+int ldx_gpio_bank_set_mode(gpio_bank_t *bank, gpio_mode_t mode)
 {
-	int fd;
-	char path[BUFF_SIZE];
-
-	sprintf(path, "/sys/class/gpio/gpio%d/direction", gpio->gpio);
+	struct gpiod_line_request_config request_cfg = { 0 };
+	int default_vals[LDX_GPIO_BANK_MAX_LINES];
+	struct _gpio_bank_t *_data = NULL;
+	unsigned int i;
 
-	fd = open(path, O_SYNC | O_WRONLY);
-	if (fd < 0)
+	if (check_gpio_bank(bank) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
-	if (write(fd, gpio_dir_strings[dir], BUFF_SIZE) < 0) {
-		close(fd);
+	if (check_bank_mode(mode) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
+
+	log_debug("%s: Setting mode for GPIO bank of '%s', mode: '%s' (%d)",
+		  __func__, bank->gpio_controller, gpio_mode_strings[mode], mode);
+
+	_data = bank->_data;
+
+	request_cfg.consumer = bank->gpio_controller;
+	if (mode == GPIO_INPUT) {
+		request_cfg.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+	} else {
+		request_cfg.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+		_data->_values = mode == GPIO_OUTPUT_HIGH ? ~0ULL : 0;
 	}
 
-	if (close(fd) < 0)
+	for (i = 0; i < bank->num_lines; i++)
+		default_vals[i] = (_data->_values >> i) & 1;
+
+	/* Release the lines so they can be requested again */
+	if (_data->_mode != GPIO_MODE_ERROR) {
+		gpiod_line_release_bulk(&_data->_bulk);
+		_data->_mode = GPIO_MODE_ERROR;
+	}
+
+	if (gpiod_line_request_bulk(&_data->_bulk, &request_cfg, default_vals)) {
+		log_error("%s: Unable to set GPIO bank of '%s' to mode: '%s' (%d)",
+			  __func__, bank->gpio_controller, gpio_mode_strings[mode],
+			  mode);
 		return EXIT_FAILURE;
+	}
+
+	_data->_mode = mode;
 
 	return EXIT_SUCCESS;
 }
 
-/**
- * check_mode() - Verify that the given mode is valid
- *
- * @mode:	The mode to check.
- *
- * Return: EXIT_SUCCESS if the mode is valid, EXIT_FAILURE otherwise.
- */
-static int check_mode(gpio_mode_t mode)
+static int gpio_bank_set_values(gpio_bank_t *bank, uint64_t mask, uint64_t values)
 {
-	switch (mode) {
-	case GPIO_INPUT:
-	case GPIO_OUTPUT_LOW:
-	case GPIO_OUTPUT_HIGH:
-	case GPIO_IRQ_EDGE_RISING:
-	case GPIO_IRQ_EDGE_FALLING:
-	case GPIO_IRQ_EDGE_BOTH:
-		return EXIT_SUCCESS;
-	default:
-		log_error("%s: Invalid GPIO mode, %d. "
-			  "Mode must be '%s', '%s', '%s', '%s', '%s', or '%s'",
+	int vals[LDX_GPIO_BANK_MAX_LINES];
+	struct _gpio_bank_t *_data = NULL;
+	uint64_t new_values;
+	unsigned int i;
+
+	if (check_gpio_bank(bank) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_data = bank->_data;
+
+	if (_data->_mode != GPIO_OUTPUT_LOW && _data->_mode != GPIO_OUTPUT_HIGH) {
+		log_error("%s: GPIO bank of '%s' is not an output", __func__,
+			  bank->gpio_controller);
+		return EXIT_FAILURE;
+	}
+
+	/* Lines out of the mask keep the last written value */
+	new_values = (_data->_values & ~mask) | (values & mask);
+	for (i = 0; i < bank->num_lines; i++)
+		vals[i] = (new_values >> i) & 1;
+
+	if (gpiod_line_set_value_bulk(&_data->_bulk, vals)) {
+		log_error("%s: Unable to set values of GPIO bank of '%s'", __func__,
+			  bank->gpio_controller);
+		return EXIT_FAILURE;
+	}
+
+	_data->_values = new_values;
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_gpio_bank_set_values(gpio_bank_t *bank, uint64_t mask, uint64_t values)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = gpio_bank_set_values(bank, mask, values);
+	stats_end(STATS_API_GPIO_BANK_SET_VALUES, start, stats_result(ret), 0);
+
+	return ret;
+}
+
+static int gpio_bank_get_values(gpio_bank_t *bank, uint64_t *values)
+{
+	int vals[LDX_GPIO_BANK_MAX_LINES];
+	struct _gpio_bank_t *_data = NULL;
+	unsigned int i;
+
+	if (check_gpio_bank(bank) != EXIT_SUCCESS || values == NULL)
+		return EXIT_FAILURE;
+
+	_data = bank->_data;
+
+	if (_data->_mode == GPIO_MODE_ERROR) {
+		log_error("%s: GPIO bank of '%s' is not requested", __func__,
+			  bank->gpio_controller);
+		return EXIT_FAILURE;
+	}
+
+	if (gpiod_line_get_value_bulk(&_data->_bulk, vals)) {
+		log_error("%s: Unable to get values of GPIO bank of '%s'", __func__,
+			  bank->gpio_controller);
+		return EXIT_FAILURE;
+	}
+
+	*values = 0;
+	for (i = 0; i < bank->num_lines; i++) {
+		if (vals[i])
+			*values |= 1ULL << i;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_gpio_bank_get_values(gpio_bank_t *bank, uint64_t *values)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	ret = gpio_bank_get_values(bank, values);
+	stats_end(STATS_API_GPIO_BANK_GET_VALUES, start, stats_result(ret), 0);
+
+	return ret;
+}
+
+/**
+ * read_line_events() - Read the pending edge events of a gpiod line
+ *
+ * @fd:		The line event descriptor.
+ * @events:	Array to store the events.
+ * @max:	Maximum number of events to read.
+ * @timeout:	Milliseconds to wait for the first event, -1 for blocking
+ *		indefinitely.
+ *
+ * Return: The number of events read, 0 on timeout, -1 on error.
+ */
+static int read_line_events(int fd, gpio_event_t *events, unsigned int max, int timeout)
+{
+	struct gpiod_line_event gevents[GPIO_EVENT_READ_MAX];
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	unsigned int count = 0, n, i;
+	struct timespec now;
+	int64_t offset;
+	int rv;
+
+	while (count < max) {
+		/* Only the first read waits, the rest drain what is queued */
+		rv = poll(&pfd, 1, count ? 0 : timeout);
+		if (rv < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: error polling GPIO (%d)", __func__, errno);
+			return count ? (int)count : -1;
+		} else if (rv == 0) {
+			break;
+		}
+
+		n = max - count;
+		if (n > GPIO_EVENT_READ_MAX)
+			n = GPIO_EVENT_READ_MAX;
+
+		rv = gpiod_line_event_read_fd_multiple(fd, gevents, n);
+		if (rv < 0) {
+			log_error("%s: error reading GPIO events (%d)", __func__, errno);
+			return count ? (int)count : -1;
+		}
+
+		/*
+		 * Kernels before 5.7 stamp the events with CLOCK_REALTIME,
+		 * which is always ahead of the monotonic clock.
+		 */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		offset = 0;
+		if (rv > 0 && timestamp_timespec_ns(&gevents[0].ts) > timestamp_timespec_ns(&now))
+			offset = timestamp_realtime_offset();
+
+		for (i = 0; i < (unsigned int)rv; i++, count++) {
+			events[count].timestamp_ns = timestamp_timespec_ns(&gevents[i].ts) - offset;
+			events[count].edge = gevents[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE ?
+					     GPIO_EVENT_RISING_EDGE : GPIO_EVENT_FALLING_EDGE;
+		}
+
+		/* The kernel queue is empty */
+		if ((unsigned int)rv < n)
+			break;
+	}
+
+	return count;
+}
+
+/**
+ * check_event_gpio() - Verify that the GPIO can report edge events
+ *
+ * @gpio:	The GPIO to check.
+ *
+ * Return: The line event descriptor on success, -1 otherwise.
+ */
+static int check_event_gpio(gpio_t *gpio)
+{
+	struct _gpio_t *_data = NULL;
+	int fd;
+
+	if (check_gpio(gpio) != EXIT_SUCCESS)
+		return -1;
+
+	_data = gpio->_data;
+
+	if (gpio->kernel_number != UNDEFINED_SYSFS_GPIO) {
+		log_error("%s: GPIO %s has no event timestamps, request it by controller",
+			  __func__, show_gpio(gpio));
+		return -1;
+	}
+
+	switch (_data->_mode) {
+	case GPIO_IRQ_EDGE_RISING:
+	case GPIO_IRQ_EDGE_FALLING:
+	case GPIO_IRQ_EDGE_BOTH:
+		break;
+	default:
+		log_error("%s: Invalid GPIO mode. Mode must be '%s', '%s', or '%s'",
+			  __func__,
+			  gpio_mode_strings[GPIO_IRQ_EDGE_RISING],
+			  gpio_mode_strings[GPIO_IRQ_EDGE_FALLING],
+			  gpio_mode_strings[GPIO_IRQ_EDGE_BOTH]);
+		return -1;
+	}
+
+	fd = gpiod_line_event_get_fd(_data->_line);
+	if (fd == -1)
+		log_error("%s: Error getting file descriptor on GPIO %s",
+			  __func__, show_gpio(gpio));
+
+	return fd;
+}
+
+static struct event_stream_t *get_ring_stream(struct _gpio_t *_data);
+static int read_stream_events(struct event_stream_t *stream, gpio_event_t *events,
+			      unsigned int max, int timeout);
+
+int ldx_gpio_read_events(gpio_t *gpio, gpio_event_t *events, unsigned int max,
+			 int timeout)
+{
+	struct _gpio_t *_data = NULL;
+	struct event_stream_t *stream = NULL;
+	int fd;
+
+	if (timeout < -1) {
+		log_error("%s: Invalid timeout value, %d", __func__, timeout);
+		return -1;
+	}
+
+	if (events == NULL || max == 0) {
+		log_error("%s: Invalid events buffer", __func__);
+		return -1;
+	}
+
+	fd = check_event_gpio(gpio);
+	if (fd < 0)
+		return -1;
+
+	_data = gpio->_data;
+
+	/* A stream without callback keeps the events in its ring */
+	stream = get_ring_stream(_data);
+	if (stream != NULL)
+		return read_stream_events(stream, events, max, timeout);
+
+	if (_data->_wait_irq != NULL || _data->_event_stream != NULL) {
+		log_error("%s: irq already in use on GPIO %s", __func__,
+			  show_gpio(gpio));
+		return -1;
+	}
+
+	return read_line_events(fd, events, max, timeout);
+}
+
+void ldx_gpio_event_get_timestamp(const gpio_event_t *event, ldx_timestamp_t *ts)
+{
+	ts->ns = event->timestamp_ns;
+	ts->hw_ns = 0;
+	ts->source = LDX_TIMESTAMP_SRC_KERNEL;
+}
+
+/**
+ * event_stream_reader() - Thread moving the kernel events to the ring
+ *
+ * @data:	The event stream.
+ *
+ * The kernel only queues a few events per line, so this thread does
+ * nothing but drain them, leaving the callback to a second thread.
+ */
+static void *event_stream_reader(void *data)
+{
+	struct event_stream_t *stream = data;
+	gpio_event_t batch[GPIO_EVENT_READ_MAX];
+	struct pollfd pfds[2] = {
+		{ .fd = stream->fd, .events = POLLIN },
+		{ .fd = stream->stopfd, .events = POLLIN },
+	};
+	int n, i;
+
+	while (1) {
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: error polling GPIO (%d)", __func__, errno);
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (!pfds[0].revents)
+			continue;
+
+		n = read_line_events(stream->fd, batch, GPIO_EVENT_READ_MAX, 0);
+		if (n <= 0)
+			continue;
+
+		pthread_mutex_lock(&stream->mutex);
+		for (i = 0; i < n; i++) {
+			if (stream->head - stream->tail == stream->len) {
+				stream->overruns += n - i;
+				break;
+			}
+			stream->ring[stream->head++ & (stream->len - 1)] = batch[i];
+		}
+		pthread_cond_signal(&stream->cond);
+		pthread_mutex_unlock(&stream->mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * event_stream_dispatcher() - Thread delivering the ring events to the callback
+ *
+ * @data:	The event stream.
+ */
+static void *event_stream_dispatcher(void *data)
+{
+	struct event_stream_t *stream = data;
+	gpio_event_t chunk[LDX_GPIO_EVENT_CB_MAX];
+	unsigned int n, i;
+
+	pthread_mutex_lock(&stream->mutex);
+	while (stream->run) {
+		if (stream->head == stream->tail) {
+			pthread_cond_wait(&stream->cond, &stream->mutex);
+			continue;
+		}
+
+		n = stream->head - stream->tail;
+		if (n > LDX_GPIO_EVENT_CB_MAX)
+			n = LDX_GPIO_EVENT_CB_MAX;
+		for (i = 0; i < n; i++)
+			chunk[i] = stream->ring[stream->tail++ & (stream->len - 1)];
+		pthread_mutex_unlock(&stream->mutex);
+
+		trace_gpio_irq_begin(stream->gpio, n);
+		stream->callback_fn(stream->gpio, chunk, n, stream->arg);
+		trace_gpio_irq_end(stream->gpio, n);
+
+		pthread_mutex_lock(&stream->mutex);
+	}
+	pthread_mutex_unlock(&stream->mutex);
+
+	return NULL;
+}
+
+/**
+ * get_ring_stream() - Register a reader on the event stream of a GPIO
+ *
+ * @_data:	The GPIO data.
+ *
+ * The stream is not freed by 'ldx_gpio_stop_event_stream()' until the reader
+ * leaves 'read_stream_events()'.
+ *
+ * Return: The event stream if it has no callback, NULL otherwise.
+ */
+static struct event_stream_t *get_ring_stream(struct _gpio_t *_data)
+{
+	struct event_stream_t *stream = NULL;
+
+	pthread_mutex_lock(&event_streams_lock);
+	if (_data->_event_stream != NULL
+	    && _data->_event_stream->callback_fn == NULL) {
+		stream = _data->_event_stream;
+		pthread_mutex_lock(&stream->mutex);
+		stream->readers++;
+		pthread_mutex_unlock(&stream->mutex);
+	}
+	pthread_mutex_unlock(&event_streams_lock);
+
+	return stream;
+}
+
+/**
+ * read_stream_events() - Take the events queued in the ring of a stream
+ *
+ * @stream:	The event stream, without callback, taken with
+ *		'get_ring_stream()'.
+ * @events:	Array to store the events.
+ * @max:	Maximum number of events to take.
+ * @timeout:	The maximum number of milliseconds to wait for the first event,
+ *		-1 for blocking indefinitely.
+ *
+ * The wait ends early if the stream is stopped.
+ *
+ * Return: The number of events taken, 0 on timeout.
+ */
+static int read_stream_events(struct event_stream_t *stream, gpio_event_t *events,
+			      unsigned int max, int timeout)
+{
+	struct timespec deadline;
+	unsigned int n = 0;
+
+	if (timeout > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&stream->mutex);
+	while (stream->run && stream->head == stream->tail && timeout != 0) {
+		if (timeout < 0)
+			pthread_cond_wait(&stream->cond, &stream->mutex);
+		else if (pthread_cond_timedwait(&stream->cond, &stream->mutex,
+						&deadline) == ETIMEDOUT)
+			break;
+	}
+
+	while (n < max && stream->head != stream->tail)
+		events[n++] = stream->ring[stream->tail++ & (stream->len - 1)];
+
+	/* The last reader lets a stop in progress free the stream */
+	if (--stream->readers == 0 && !stream->run)
+		pthread_cond_broadcast(&stream->cond);
+	pthread_mutex_unlock(&stream->mutex);
+
+	return n;
+}
+
+/**
+ * roundup_pow_of_two() - Round a length up to the next power of two
+ *
+ * @n:		The length, at most 2^31.
+ *
+ * Return: The smallest power of two not lower than 'n'.
+ */
+static unsigned int roundup_pow_of_two(unsigned int n)
+{
+	unsigned int len = 1;
+
+	while (len < n)
+		len <<= 1;
+
+	return len;
+}
+
+int ldx_gpio_start_event_stream(gpio_t *gpio, unsigned int ring_len,
+				const ldx_gpio_events_cb_t events_cb, void *arg)
+{
+	struct _gpio_t *_data = NULL;
+	struct event_stream_t *stream = NULL;
+	pthread_condattr_t cond_attr;
+	int fd;
+
+	if (ring_len == 0 || ring_len > LDX_GPIO_EVENT_RING_MAX_LEN) {
+		log_error("%s: Invalid ring length %u", __func__, ring_len);
+		return EXIT_FAILURE;
+	}
+	ring_len = roundup_pow_of_two(ring_len);
+
+	fd = check_event_gpio(gpio);
+	if (fd < 0)
+		return EXIT_FAILURE;
+
+	_data = gpio->_data;
+
+	/* Held until the stream is published, so only one start can take it */
+	pthread_mutex_lock(&event_streams_lock);
+	if (_data->_wait_irq != NULL || _data->_event_stream != NULL) {
+		pthread_mutex_unlock(&event_streams_lock);
+		log_error("%s: irq already in use on GPIO %s", __func__,
+			  show_gpio(gpio));
+		return EXIT_FAILURE;
+	}
+
+	stream = calloc(1, sizeof(struct event_stream_t));
+	if (stream == NULL)
+		goto err_alloc;
+
+	stream->ring = calloc(ring_len, sizeof(gpio_event_t));
+	if (stream->ring == NULL)
+		goto err_alloc;
+
+	stream->stopfd = eventfd(0, EFD_CLOEXEC);
+	if (stream->stopfd < 0) {
+		log_error("%s: Unable to create eventfd on GPIO %s", __func__,
+			  show_gpio(gpio));
+		goto err_free;
+	}
+
+	stream->gpio = gpio;
+	stream->fd = fd;
+	stream->len = ring_len;
+	stream->callback_fn = events_cb;
+	stream->arg = arg;
+	stream->run = true;
+	pthread_mutex_init(&stream->mutex, NULL);
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&stream->cond, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+
+	if (events_cb != NULL
+	    && pthread_create(&stream->dispatcher, NULL, event_stream_dispatcher, stream)) {
+		log_error("%s: Unable to create thread on GPIO %s", __func__,
+			  show_gpio(gpio));
+		goto err_sync;
+	}
+
+	if (pthread_create(&stream->reader, NULL, event_stream_reader, stream)) {
+		log_error("%s: Unable to create thread on GPIO %s", __func__,
+			  show_gpio(gpio));
+		pthread_mutex_lock(&stream->mutex);
+		stream->run = false;
+		pthread_cond_signal(&stream->cond);
+		pthread_mutex_unlock(&stream->mutex);
+		if (events_cb != NULL)
+			pthread_join(stream->dispatcher, NULL);
+		goto err_sync;
+	}
+
+	_data->_event_stream = stream;
+	pthread_mutex_unlock(&event_streams_lock);
+
+	log_debug("%s: Start streaming events of GPIO %s", __func__,
+		  show_gpio(gpio));
+
+	return EXIT_SUCCESS;
+
+err_alloc:
+	log_error("%s: Error allocating mem for event stream on GPIO %s",
+		  __func__, show_gpio(gpio));
+	goto err_free;
+
+err_sync:
+	pthread_cond_destroy(&stream->cond);
+	pthread_mutex_destroy(&stream->mutex);
+	close(stream->stopfd);
+
+err_free:
+	pthread_mutex_unlock(&event_streams_lock);
+	if (stream)
+		free(stream->ring);
+	free(stream);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_gpio_stop_event_stream(gpio_t *gpio)
+{
+	struct _gpio_t *_data = NULL;
+	struct event_stream_t *stream = NULL;
+	uint64_t val = 1;
+
+	if (check_gpio(gpio) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_data = gpio->_data;
+	pthread_mutex_lock(&event_streams_lock);
+	stream = _data->_event_stream;
+	if (stream == NULL) {
+		pthread_mutex_unlock(&event_streams_lock);
+		return EXIT_SUCCESS;
+	}
+
+	/* Wake the dispatcher and the readers, then wait for the readers */
+	pthread_mutex_lock(&stream->mutex);
+	stream->run = false;
+	pthread_cond_broadcast(&stream->cond);
+	while (stream->readers > 0)
+		pthread_cond_wait(&stream->cond, &stream->mutex);
+	pthread_mutex_unlock(&stream->mutex);
+
+	_data->_event_stream = NULL;
+	pthread_mutex_unlock(&event_streams_lock);
+
+	if (write(stream->stopfd, &val, sizeof(val)) < 0)
+		log_debug("%s: eventfd write error (%d)", __func__, errno);
+	pthread_join(stream->reader, NULL);
+	if (stream->callback_fn != NULL)
+		pthread_join(stream->dispatcher, NULL);
+
+	if (stream->overruns)
+		log_warning("%s: %llu events lost on GPIO %s", __func__,
+			    (unsigned long long)stream->overruns, show_gpio(gpio));
+
+	pthread_cond_destroy(&stream->cond);
+	pthread_mutex_destroy(&stream->mutex);
+	close(stream->stopfd);
+	free(stream->ring);
+	free(stream);
+
+	log_debug("%s: Stop streaming events of GPIO %s", __func__,
+		  show_gpio(gpio));
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_gpio_get_lost_events(gpio_t *gpio, uint64_t *lost)
+{
+	struct _gpio_t *_data = NULL;
+	struct event_stream_t *stream = NULL;
+
+	if (check_gpio(gpio) != EXIT_SUCCESS || lost == NULL)
+		return EXIT_FAILURE;
+
+	_data = gpio->_data;
+	pthread_mutex_lock(&event_streams_lock);
+	stream = _data->_event_stream;
+	if (stream == NULL) {
+		pthread_mutex_unlock(&event_streams_lock);
+		log_error("%s: No event stream on GPIO %s", __func__,
+			  show_gpio(gpio));
+		return EXIT_FAILURE;
+	}
+
+	pthread_mutex_lock(&stream->mutex);
+	*lost = stream->overruns;
+	pthread_mutex_unlock(&stream->mutex);
+	pthread_mutex_unlock(&event_streams_lock);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * check_gpio() - Verify that the GPIO pointer is valid
+ *
+ * @gpio:	The GPIO pointer to check.
+ *
+ * Return: EXIT_SUCCESS if the GPIO is valid, EXIT_FAILURE otherwise.
+ */
+static int check_gpio(gpio_t *gpio)
+{
+	struct _gpio_t *_data = NULL;
+
+	if (gpio == NULL) {
+		log_error("%s: GPIO cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_data = gpio->_data;
+	if (_data == NULL || (_data->_internal_gpio == NULL &&
+		_data->_chip == NULL && _data->_line == NULL)) {
+		log_error("%s: Invalid GPIO, %s", __func__,
+			  show_gpio(gpio));
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * check_gpio_bank() - Verify that the GPIO bank pointer is valid
+ *
+ * @bank:	The GPIO bank pointer to check.
+ *
+ * Return: EXIT_SUCCESS if the bank is valid, EXIT_FAILURE otherwise.
+ */
+static int check_gpio_bank(gpio_bank_t *bank)
+{
+	if (bank == NULL) {
+		log_error("%s: GPIO bank cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (bank->_data == NULL) {
+		log_error("%s: Invalid GPIO bank of '%s'", __func__,
+			  bank->gpio_controller);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static char * show_gpio(gpio_t *gpio)
+{
+	static char _show_gpio[MAX_CONTROLLER_LEN] = "";
+
+	if (gpio->kernel_number == UNDEFINED_SYSFS_GPIO)
+		sprintf(_show_gpio, "%s %d", gpio->gpio_controller, gpio->gpio_line);
+	else
+		sprintf(_show_gpio, "%d", gpio->kernel_number);
+
+	return _show_gpio;
+}
+
+/**
+ * open_sysfs_attr() - Open an attribute of an exported sysfs GPIO
+ *
+ * @kernel_number:	The Linux ID number of the GPIO.
+ * @attr:		The attribute name.
+ *
+ * Return: The file descriptor on success, -1 on error.
+ */
+static int open_sysfs_attr(unsigned int kernel_number, const char *attr)
+{
+	char path[BUFF_SIZE];
+	int fd;
+
+	snprintf(path, sizeof(path), "/sys/class/gpio/gpio%u/%s", kernel_number, attr);
+
+	fd = open(path, O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+		log_debug("%s: Unable to open '%s' (%d)", __func__, path, errno);
+
+	return fd;
+}
+
+/**
+ * read_sysfs_str() - Read the first line of the given sysfs file
+ *
+ * @path:	The file path.
+ * @buf:	Buffer to store the line, without the new line.
+ * @len:	Size of the buffer.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_sysfs_str(const char *path, char *buf, size_t len)
+{
+	FILE *f;
+	int ret = EXIT_FAILURE;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return EXIT_FAILURE;
+
+	if (fgets(buf, len, f) != NULL) {
+		buf[strcspn(buf, "\n")] = '\0';
+		ret = EXIT_SUCCESS;
+	}
+
+	fclose(f);
+
+	return ret;
+}
+
+/**
+ * resolve_kernel_number() - Find the controller and line of a GPIO number
+ *
+ * @kernel_number:	The Linux ID number of the GPIO.
+ * @label:		Buffer of MAX_CONTROLLER_LEN bytes to store the
+ *			controller label.
+ * @line:		Where to store the line number.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int resolve_kernel_number(unsigned int kernel_number, char *label,
+				 unsigned int *line)
+{
+	struct dirent *entry;
+	DIR *dir;
+	int ret = EXIT_FAILURE;
+
+	dir = opendir("/sys/class/gpio");
+	if (dir == NULL)
+		return EXIT_FAILURE;
+
+	while ((entry = readdir(dir)) != NULL) {
+		char path[GPIOCHIP_ATTR_PATH_LEN], value[BUFF_SIZE];
+		unsigned int base, ngpio;
+
+		if (strncmp(entry->d_name, "gpiochip", strlen("gpiochip")))
+			continue;
+
+		snprintf(path, sizeof(path), "/sys/class/gpio/%s/base", entry->d_name);
+		if (read_sysfs_str(path, value, sizeof(value)) != EXIT_SUCCESS)
+			continue;
+		base = strtoul(value, NULL, 10);
+
+		snprintf(path, sizeof(path), "/sys/class/gpio/%s/ngpio", entry->d_name);
+		if (read_sysfs_str(path, value, sizeof(value)) != EXIT_SUCCESS)
+			continue;
+		ngpio = strtoul(value, NULL, 10);
+
+		if (kernel_number < base || kernel_number >= base + ngpio)
+			continue;
+
+		snprintf(path, sizeof(path), "/sys/class/gpio/%s/label", entry->d_name);
+		if (read_sysfs_str(path, label, MAX_CONTROLLER_LEN) == EXIT_SUCCESS) {
+			*line = kernel_number - base;
+			ret = EXIT_SUCCESS;
+		}
+		break;
+	}
+
+	closedir(dir);
+
+	return ret;
+}
+
+/**
+ * set_direction() - Set GPIO to input or output
+ *
+ * @gpio:	A pointer to the requested GPIO to set its direction.
+ * @dir:	The desired GPIO direction (_gpio_dir_modes_t).
+ *
+ * This function configures the direction (_gpio_dir_modes_t) of the given GPIO:
+ *    - in: input, its value can be read.
+ *    - low: output with low as initial value, its value can be written.
+ *    - high: output with high as initial value, its value can be written.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int set_direction(libsoc_gpio_t *gpio, _gpio_dir_modes_t dir)
+{
+	int fd;
+	char path[BUFF_SIZE];
+
+	sprintf(path, "/sys/class/gpio/gpio%d/direction", gpio->gpio);
+
+	fd = open(path, O_SYNC | O_WRONLY);
+	if (fd < 0)
+		return EXIT_FAILURE;
+
+	if (write(fd, gpio_dir_strings[dir], BUFF_SIZE) < 0) {
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	if (close(fd) < 0)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * check_mode() - Verify that the given mode is valid
+ *
+ * @mode:	The mode to check.
+ *
+ * Return: EXIT_SUCCESS if the mode is valid, EXIT_FAILURE otherwise.
+ */
+static int check_mode(gpio_mode_t mode)
+{
+	switch (mode) {
+	case GPIO_INPUT:
+	case GPIO_OUTPUT_LOW:
+	case GPIO_OUTPUT_HIGH:
+	case GPIO_IRQ_EDGE_RISING:
+	case GPIO_IRQ_EDGE_FALLING:
+	case GPIO_IRQ_EDGE_BOTH:
+		return EXIT_SUCCESS;
+	default:
+		log_error("%s: Invalid GPIO mode, %d. "
+			  "Mode must be '%s', '%s', '%s', '%s', '%s', or '%s'",
 			  __func__, mode, gpio_mode_strings[GPIO_INPUT],
 			  gpio_mode_strings[GPIO_OUTPUT_LOW],
 			  gpio_mode_strings[GPIO_OUTPUT_HIGH],
@@ -1186,3 +2341,27 @@ static int check_mode(gpio_mode_t mode)
 		return EXIT_FAILURE;
 	}
 }
+
+/**
+ * check_bank_mode() - Verify that the given mode is valid for a GPIO bank
+ *
+ * @mode:	The mode to check.
+ *
+ * Return: EXIT_SUCCESS if the mode is valid, EXIT_FAILURE otherwise.
+ */
+static int check_bank_mode(gpio_mode_t mode)
+{
+	switch (mode) {
+	case GPIO_INPUT:
+	case GPIO_OUTPUT_LOW:
+	case GPIO_OUTPUT_HIGH:
+		return EXIT_SUCCESS;
+	default:
+		log_error("%s: Invalid GPIO bank mode, %d. "
+			  "Mode must be '%s', '%s', or '%s'",
+			  __func__, mode, gpio_mode_strings[GPIO_INPUT],
+			  gpio_mode_strings[GPIO_OUTPUT_LOW],
+			  gpio_mode_strings[GPIO_OUTPUT_HIGH]);
+		return EXIT_FAILURE;
+	}
+}
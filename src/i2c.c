@@ -14,26 +14,37 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
 
 #include "_common.h"
+#include "_i2c.h"
 #include "_libsoc_interfaces.h"
 #include "_log.h"
+#include "_stats.h"
+#include "_trace.h"
 #include "i2c.h"
 
 #define MAX_I2C_BUSES	10
 #define LIST_I2C_BUSES_CMD	"ls /dev/i2c-* |  sed -e 's,/dev/i2c-,,' | xargs"
 
+static inline libsoc_i2c_t *get_libsoc_i2c(i2c_t *i2c);
+static void i2c_bus_acquire(i2c_t *i2c);
+static int i2c_bus_release(i2c_t *i2c);
 static int check_i2c(i2c_t *i2c);
+static int i2c_rdwr(i2c_t *i2c, i2c_msg_t *msgs, unsigned int n);
 
 i2c_t *ldx_i2c_request(unsigned int i2c_bus)
 {
 	libsoc_i2c_t *_i2c = NULL;
+	i2c_internal_t *internal_data = NULL;
 	i2c_t *new_i2c = NULL;
 	i2c_t init_i2c = {
 		.alias = NULL,
@@ -49,15 +60,28 @@ i2c_t *ldx_i2c_request(unsigned int i2c_bus)
 		return NULL;
 
 	new_i2c = calloc(1, sizeof(i2c_t));
-	if (new_i2c == NULL) {
+	internal_data = calloc(1, sizeof(i2c_internal_t));
+	if (new_i2c == NULL || internal_data == NULL) {
 		log_error("%s: Unable to request I2C %d, cannot allocate memory",
 			  __func__, i2c_bus);
 		libsoc_i2c_free(_i2c);
+		free(new_i2c);
+		free(internal_data);
 		return NULL;
 	}
 
+	internal_data->sched = bus_sched_get(BUS_TYPE_I2C, i2c_bus);
+	if (internal_data->sched == NULL) {
+		libsoc_i2c_free(_i2c);
+		free(new_i2c);
+		free(internal_data);
+		return NULL;
+	}
+	internal_data->libsoc = _i2c;
+	internal_data->prio = BUS_PRIO_NORMAL;
+
 	memcpy(new_i2c, &init_i2c, sizeof(i2c_t));
-	((i2c_t *)new_i2c)->_data = _i2c;
+	((i2c_t *)new_i2c)->_data = internal_data;
 
 	return new_i2c;
 }
@@ -156,8 +180,13 @@ int ldx_i2c_free(i2c_t *i2c)
 
 	log_debug("%s: Freeing I2C %d", __func__, i2c->bus);
 
-	if (i2c->_data != NULL)
-		ret = libsoc_i2c_free(i2c->_data);
+	if (i2c->_data != NULL) {
+		i2c_internal_t *_i2c = (i2c_internal_t *)i2c->_data;
+
+		ret = libsoc_i2c_free(_i2c->libsoc);
+		bus_sched_put(_i2c->sched);
+		free(_i2c);
+	}
 
 	free(i2c);
 
@@ -171,7 +200,7 @@ int ldx_i2c_set_timeout(i2c_t *i2c, unsigned int timeout)
 
 	log_debug("%s: Setting I2C %d timeout to %d", __func__, i2c->bus, timeout);
 
-	if (libsoc_i2c_set_timeout(i2c->_data, timeout) != EXIT_SUCCESS) {
+	if (libsoc_i2c_set_timeout(get_libsoc_i2c(i2c), timeout) != EXIT_SUCCESS) {
 		log_error("%s: Unable to set I2C-%d timeout", __func__,
 			  i2c->bus);
 		return EXIT_FAILURE;
@@ -187,7 +216,7 @@ int ldx_i2c_set_retries(i2c_t *i2c, unsigned int retry)
 	if (check_i2c(i2c) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
-	_i2c = i2c->_data;
+	_i2c = get_libsoc_i2c(i2c);
 
 	log_debug("%s: Setting I2C %d bus retries to %d", __func__, i2c->bus, retry);
 
@@ -200,15 +229,16 @@ int ldx_i2c_set_retries(i2c_t *i2c, unsigned int retry)
 	return EXIT_SUCCESS;
 }
 
-int ldx_i2c_read(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
-		 uint16_t length)
+static int i2c_read(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
+		    uint16_t length)
 {
 	libsoc_i2c_t *_i2c = NULL;
+	int ret;
 
 	if (check_i2c(i2c) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
-	_i2c = i2c->_data;
+	_i2c = get_libsoc_i2c(i2c);
 
 	if (length == 0)
 		return EXIT_SUCCESS;
@@ -219,13 +249,16 @@ int ldx_i2c_read(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
 		return EXIT_FAILURE;
 	}
 
-	_i2c->address = i2c_address;
-
 	log_debug("%s: Reading %d bytes from I2C-%d at address %d", __func__,
 		  length, i2c->bus, i2c_address);
 
-	if (libsoc_i2c_read(_i2c, buffer, length) != EXIT_SUCCESS) {
-		log_error("%s: Unable to read data from I2C-%d slave 0x%x",
+	/* libsoc reads the address at transfer time, set it with the bus held */
+	i2c_bus_acquire(i2c);
+	_i2c->address = i2c_address;
+	ret = libsoc_i2c_read(_i2c, buffer, length);
+	i2c_bus_release(i2c);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to read data from I2C-%d slave 0x%x",
 			  __func__, i2c->bus, i2c_address);
 		return EXIT_FAILURE;
 	}
@@ -233,15 +266,30 @@ int ldx_i2c_read(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
 	return EXIT_SUCCESS;
 }
 
-int ldx_i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
-		  uint16_t length)
+int ldx_i2c_read(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
+		 uint16_t length)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_i2c_begin(__func__, i2c, i2c_address, length);
+	ret = i2c_read(i2c, i2c_address, buffer, length);
+	trace_i2c_end(__func__, i2c, i2c_address, ret);
+	stats_end(STATS_API_I2C_READ, start, stats_result(ret), length);
+
+	return ret;
+}
+
+static int i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
+		     uint16_t length)
 {
 	libsoc_i2c_t *_i2c = NULL;
+	int ret;
 
 	if (check_i2c(i2c) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
-	_i2c = i2c->_data;
+	_i2c = get_libsoc_i2c(i2c);
 
 	if (length == 0)
 		return EXIT_SUCCESS;
@@ -252,13 +300,16 @@ int ldx_i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
 		return EXIT_FAILURE;
 	}
 
-	_i2c->address = i2c_address;
-
 	log_debug("%s: Writing %d bytes to I2C-%d at address %d", __func__,
 		  length, i2c->bus, i2c_address);
 
-	if (libsoc_i2c_write(_i2c, buffer, length) != EXIT_SUCCESS) {
-		log_error("%s: Unable to write data from I2C-%d slave 0x%x",
+	/* libsoc reads the address at transfer time, set it with the bus held */
+	i2c_bus_acquire(i2c);
+	_i2c->address = i2c_address;
+	ret = libsoc_i2c_write(_i2c, buffer, length);
+	i2c_bus_release(i2c);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to write data from I2C-%d slave 0x%x",
 			  __func__, i2c->bus, i2c_address);
 		return EXIT_FAILURE;
 	}
@@ -266,40 +317,261 @@ int ldx_i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
 	return EXIT_SUCCESS;
 }
 
-int ldx_i2c_transfer(i2c_t *i2c, unsigned int i2c_address,
-		     uint8_t *buffer_to_write, uint16_t w_length,
-		     uint8_t *buffer_to_read, uint16_t r_length)
+int ldx_i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer,
+		  uint16_t length)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_i2c_begin(__func__, i2c, i2c_address, length);
+	ret = i2c_write(i2c, i2c_address, buffer, length);
+	trace_i2c_end(__func__, i2c, i2c_address, ret);
+	stats_end(STATS_API_I2C_WRITE, start, stats_result(ret), length);
+
+	return ret;
+}
+
+static int i2c_transfer(i2c_t *i2c, unsigned int i2c_address,
+			uint8_t *buffer_to_write, uint16_t w_length,
+			uint8_t *buffer_to_read, uint16_t r_length)
 {
 	libsoc_i2c_t *_i2c = NULL;
+	i2c_msg_t msgs[2];
+	unsigned int n = 0;
+	int ret;
 
 	if (check_i2c(i2c) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
-	_i2c = i2c->_data;
-	_i2c->address = i2c_address;
+	_i2c = get_libsoc_i2c(i2c);
 
 	log_debug("%s: Transferring data with I2C-%d at address %d: Writing %d bytes and reading %d bytes",
 		  __func__, i2c->bus, i2c_address, w_length, r_length);
 
 	if ((buffer_to_write != NULL) && (w_length > 0)) {
-		if (libsoc_i2c_write(_i2c, buffer_to_write, w_length) != EXIT_SUCCESS) {
-			log_error("%s: Unable to transfer data to the I2C-%d slave 0x%x",
-				  __func__, i2c->bus, i2c_address);
-			return EXIT_FAILURE;
-		}
+		msgs[n].address = i2c_address;
+		msgs[n].flags = 0;
+		msgs[n].length = w_length;
+		msgs[n].buffer = buffer_to_write;
+		n++;
 	}
 
 	if ((buffer_to_read != NULL) && (r_length > 0)) {
-		if (libsoc_i2c_read(_i2c, buffer_to_read, r_length) != EXIT_SUCCESS) {
-			log_error("%s: Unable to transfer data to the I2C-%d slave 0x%x",
-				  __func__, i2c->bus, i2c_address);
+		msgs[n].address = i2c_address;
+		msgs[n].flags = LDX_I2C_MSG_READ;
+		msgs[n].length = r_length;
+		msgs[n].buffer = buffer_to_read;
+		n++;
+	}
+
+	if (n == 0)
+		return EXIT_SUCCESS;
+
+	i2c_bus_acquire(i2c);
+
+	ret = i2c_rdwr(i2c, msgs, n);
+
+	/* Adapters without plain I2C support only allow separate transfers */
+	if (ret != EXIT_SUCCESS && errno == EOPNOTSUPP) {
+		_i2c->address = i2c_address;
+		ret = EXIT_SUCCESS;
+		if ((buffer_to_write != NULL) && (w_length > 0))
+			ret = libsoc_i2c_write(_i2c, buffer_to_write, w_length);
+		if (ret == EXIT_SUCCESS && (buffer_to_read != NULL) && (r_length > 0))
+			ret = libsoc_i2c_read(_i2c, buffer_to_read, r_length);
+	}
+
+	i2c_bus_release(i2c);
+
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to transfer data to the I2C-%d slave 0x%x",
+			  __func__, i2c->bus, i2c_address);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_transfer(i2c_t *i2c, unsigned int i2c_address,
+		     uint8_t *buffer_to_write, uint16_t w_length,
+		     uint8_t *buffer_to_read, uint16_t r_length)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_i2c_begin(__func__, i2c, i2c_address, w_length + r_length);
+	ret = i2c_transfer(i2c, i2c_address, buffer_to_write, w_length,
+			   buffer_to_read, r_length);
+	trace_i2c_end(__func__, i2c, i2c_address, ret);
+	stats_end(STATS_API_I2C_TRANSFER, start, stats_result(ret),
+		  (uint64_t)w_length + r_length);
+
+	return ret;
+}
+
+static int i2c_transfer_msgs(i2c_t *i2c, i2c_msg_t *msgs, unsigned int n)
+{
+	unsigned int i;
+	int ret;
+
+	if (check_i2c(i2c) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (n == 0)
+		return EXIT_SUCCESS;
+
+	if (msgs == NULL || n > LDX_I2C_MAX_MSGS) {
+		log_error("%s: Invalid messages for I2C-%d", __func__, i2c->bus);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (msgs[i].buffer == NULL && msgs[i].length > 0) {
+			log_error("%s: Invalid buffer in message %u", __func__, i);
 			return EXIT_FAILURE;
 		}
 	}
 
+	log_debug("%s: Transferring %u messages with I2C-%d", __func__, n,
+		  i2c->bus);
+
+	i2c_bus_acquire(i2c);
+	ret = i2c_rdwr(i2c, msgs, n);
+	i2c_bus_release(i2c);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to transfer %u messages with I2C-%d (%d)",
+			  __func__, n, i2c->bus, errno);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_transfer_msgs(i2c_t *i2c, i2c_msg_t *msgs, unsigned int n)
+{
+	uint64_t start = stats_begin(), bytes = 0;
+	unsigned int i;
+	int ret;
+
+	trace_i2c_begin(__func__, i2c, trace_i2c_msgs_address(msgs, n), n);
+	ret = i2c_transfer_msgs(i2c, msgs, n);
+	trace_i2c_end(__func__, i2c, trace_i2c_msgs_address(msgs, n), ret);
+	if (ret == EXIT_SUCCESS) {
+		for (i = 0; i < n; i++)
+			bytes += msgs[i].length;
+	}
+	stats_end(STATS_API_I2C_TRANSFER_MSGS, start, stats_result(ret), bytes);
+
+	return ret;
+}
+
+int ldx_i2c_set_priority(i2c_t *i2c, bus_prio_t prio)
+{
+	if (check_i2c(i2c) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (prio < 0 || prio >= BUS_PRIO_COUNT) {
+		log_error("%s: Invalid priority, %d", __func__, prio);
+		return EXIT_FAILURE;
+	}
+
+	((i2c_internal_t *)i2c->_data)->prio = prio;
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_lock_bus(i2c_t *i2c)
+{
+	if (check_i2c(i2c) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	i2c_bus_acquire(i2c);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_unlock_bus(i2c_t *i2c)
+{
+	if (check_i2c(i2c) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	return i2c_bus_release(i2c);
+}
+
+/**
+ * i2c_rdwr() - Submit a combined transfer with the I2C_RDWR ioctl
+ *
+ * @i2c:	A requested I2C bus.
+ * @msgs:	Array of messages to transfer.
+ * @n:		Number of messages, up to LDX_I2C_MAX_MSGS.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+static int i2c_rdwr(i2c_t *i2c, i2c_msg_t *msgs, unsigned int n)
+{
+	libsoc_i2c_t *_i2c = get_libsoc_i2c(i2c);
+	struct i2c_msg kmsgs[LDX_I2C_MAX_MSGS];
+	struct i2c_rdwr_ioctl_data data = {
+		.msgs = kmsgs,
+		.nmsgs = n
+	};
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		kmsgs[i].addr = msgs[i].address;
+		kmsgs[i].flags = msgs[i].flags &
+				 (I2C_M_RD | I2C_M_TEN | I2C_M_NOSTART);
+		kmsgs[i].len = msgs[i].length;
+		kmsgs[i].buf = msgs[i].buffer;
+	}
+
+	/* The public flags have the values of the kernel ones */
+	errno = 0;
+	if (ioctl(_i2c->fd, I2C_RDWR, &data) != (int)n) {
+		if (errno == 0)
+			errno = EIO;
+		return EXIT_FAILURE;
+	}
+
 	return EXIT_SUCCESS;
 }
 
+/**
+ * get_libsoc_i2c() - Get the libsoc handle of an I2C
+ *
+ * @i2c:	A requested I2C bus.
+ *
+ * Return: The libsoc I2C handle.
+ */
+static inline libsoc_i2c_t *get_libsoc_i2c(i2c_t *i2c)
+{
+	return ((i2c_internal_t *)i2c->_data)->libsoc;
+}
+
+/**
+ * i2c_bus_acquire() - Wait for the turn of an I2C handle on its bus
+ *
+ * @i2c:	A requested I2C bus.
+ */
+static void i2c_bus_acquire(i2c_t *i2c)
+{
+	i2c_internal_t *_i2c = (i2c_internal_t *)i2c->_data;
+
+	bus_sched_acquire(_i2c->sched, _i2c->prio);
+}
+
+/**
+ * i2c_bus_release() - Release the bus of an I2C handle
+ *
+ * @i2c:	A requested I2C bus.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int i2c_bus_release(i2c_t *i2c)
+{
+	return bus_sched_release(((i2c_internal_t *)i2c->_data)->sched);
+}
+
 /**
  * check_i2c() - Verify that the I2C pointer is valid
  *
@@ -0,0 +1,596 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_log.h"
+#include "i2c.h"
+
+/* Bursts submitted in each combined transfer (two messages per burst) */
+#define REGMAP_BURSTS_PER_XFER	(LDX_I2C_MAX_MSGS / 2)
+
+/* Longest message i2c-dev accepts in an I2C_RDWR transfer */
+#define REGMAP_MAX_MSG_LEN	8192
+
+/**
+ * regmap_range_t - Range of cached registers
+ *
+ * @first:	First register of the range.
+ * @last:	Last register of the range.
+ * @values:	Cached value of each register.
+ * @valid:	True for each register whose value is cached.
+ */
+typedef struct {
+	unsigned int first;
+	unsigned int last;
+	uint32_t *values;
+	bool *valid;
+} regmap_range_t;
+
+/**
+ * regmap_internal_t - Data of a register map for internal use
+ *
+ * @lock:	Protects the cache ranges and their values.
+ * @ranges:	Array with the cached register ranges.
+ * @nranges:	Number of ranges.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	regmap_range_t *ranges;
+	unsigned int nranges;
+} regmap_internal_t;
+
+/**
+ * regmap_pair_t - Register to read and where to store its value
+ *
+ * @reg:	The register.
+ * @idx:	Index of the value in the caller array.
+ */
+typedef struct {
+	unsigned int reg;
+	unsigned int idx;
+} regmap_pair_t;
+
+/**
+ * check_regmap() - Verify that the register map pointer is valid
+ *
+ * @map:	The register map pointer to check.
+ *
+ * Return: EXIT_SUCCESS if the register map is valid, EXIT_FAILURE otherwise.
+ */
+static int check_regmap(i2c_regmap_t *map)
+{
+	if (map == NULL || map->_data == NULL) {
+		log_error("%s: Invalid register map", __func__);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * find_cache() - Find the cache entry of a register
+ *
+ * @map:	The register map.
+ * @reg:	The register.
+ * @range:	Where to store the range of the register.
+ *
+ * Must be called with the lock of the map held.
+ *
+ * Return: The index of the register in the range, -1 if it is not cacheable.
+ */
+static long find_cache(i2c_regmap_t *map, unsigned int reg,
+		       regmap_range_t **range)
+{
+	regmap_internal_t *_map = map->_data;
+	unsigned int i;
+
+	for (i = 0; i < _map->nranges; i++) {
+		if (reg >= _map->ranges[i].first && reg <= _map->ranges[i].last) {
+			*range = &_map->ranges[i];
+			return reg - _map->ranges[i].first;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * cache_get() - Get the cached value of a register
+ *
+ * @map:	The register map.
+ * @reg:	The register.
+ * @val:	Where to store the value.
+ *
+ * Return: True if the value was cached, false otherwise.
+ */
+static bool cache_get(i2c_regmap_t *map, unsigned int reg, uint32_t *val)
+{
+	regmap_internal_t *_map = map->_data;
+	regmap_range_t *range;
+	bool cached = false;
+	long i;
+
+	pthread_mutex_lock(&_map->lock);
+	i = find_cache(map, reg, &range);
+	if (i >= 0 && range->valid[i]) {
+		*val = range->values[i];
+		cached = true;
+	}
+	pthread_mutex_unlock(&_map->lock);
+
+	return cached;
+}
+
+/**
+ * cache_set() - Store the value of a register if it is cacheable
+ *
+ * @map:	The register map.
+ * @reg:	The register.
+ * @val:	The value.
+ */
+static void cache_set(i2c_regmap_t *map, unsigned int reg, uint32_t val)
+{
+	regmap_internal_t *_map = map->_data;
+	regmap_range_t *range;
+	long i;
+
+	pthread_mutex_lock(&_map->lock);
+	i = find_cache(map, reg, &range);
+	if (i >= 0) {
+		range->values[i] = val;
+		range->valid[i] = true;
+	}
+	pthread_mutex_unlock(&_map->lock);
+}
+
+/**
+ * encode_be() - Store a value in big endian
+ *
+ * @buf:	Destination buffer.
+ * @val:	The value.
+ * @bytes:	Number of bytes to store.
+ */
+static void encode_be(uint8_t *buf, uint32_t val, unsigned int bytes)
+{
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		buf[i] = val >> (8 * (bytes - 1 - i));
+}
+
+/**
+ * decode_be() - Get a big endian value
+ *
+ * @buf:	Source buffer.
+ * @bytes:	Number of bytes of the value.
+ *
+ * Return: The value.
+ */
+static uint32_t decode_be(const uint8_t *buf, unsigned int bytes)
+{
+	uint32_t val = 0;
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		val = (val << 8) | buf[i];
+
+	return val;
+}
+
+/**
+ * compare_pairs() - Order register pairs by register
+ */
+static int compare_pairs(const void *a, const void *b)
+{
+	const regmap_pair_t *pa = a, *pb = b;
+
+	return (pa->reg > pb->reg) - (pa->reg < pb->reg);
+}
+
+/**
+ * read_pairs() - Read registers from the device, coalescing adjacent ones
+ *
+ * @map:	The register map.
+ * @pairs:	Registers to read, sorted by register.
+ * @n:		Number of registers.
+ * @vals:	Caller array to store the values.
+ *
+ * Runs of consecutive registers are read in a single burst (a write of the
+ * first register address followed by a read with repeated START), and up to
+ * REGMAP_BURSTS_PER_XFER bursts are submitted with each combined transfer.
+ * The bus is kept during the reads, so a concurrent write can not be
+ * overwritten in the cache by an older value.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_pairs(i2c_regmap_t *map, regmap_pair_t *pairs, unsigned int n,
+		      uint32_t *vals)
+{
+	const unsigned int reg_bytes = map->reg_bits / 8;
+	const unsigned int val_bytes = map->val_bits / 8;
+	const unsigned int max_burst = REGMAP_MAX_MSG_LEN / val_bytes;
+	i2c_msg_t msgs[LDX_I2C_MAX_MSGS];
+	unsigned int burst_start[REGMAP_BURSTS_PER_XFER];
+	unsigned int burst_len[REGMAP_BURSTS_PER_XFER];
+	uint8_t addr[REGMAP_BURSTS_PER_XFER][4];
+	uint8_t *data;
+	unsigned int i = 0;
+	int ret = EXIT_SUCCESS;
+
+	data = malloc((size_t)n * val_bytes);
+	if (data == NULL) {
+		log_error("%s: Unable to read registers, cannot allocate memory",
+			  __func__);
+		return EXIT_FAILURE;
+	}
+
+	ldx_i2c_lock_bus(map->i2c);
+	while (i < n && ret == EXIT_SUCCESS) {
+		unsigned int nbursts = 0, offset = 0, b, k = i;
+
+		/* Group the next runs of consecutive registers in bursts */
+		while (k < n && nbursts < REGMAP_BURSTS_PER_XFER) {
+			unsigned int first = pairs[k].reg, len = 1;
+
+			for (k++; k < n; k++) {
+				if (pairs[k].reg == pairs[k - 1].reg)
+					continue;
+				if (pairs[k].reg != pairs[k - 1].reg + 1 ||
+				    len == max_burst)
+					break;
+				len++;
+			}
+
+			encode_be(addr[nbursts], first, reg_bytes);
+			msgs[2 * nbursts].address = map->address;
+			msgs[2 * nbursts].flags = 0;
+			msgs[2 * nbursts].length = reg_bytes;
+			msgs[2 * nbursts].buffer = addr[nbursts];
+			msgs[2 * nbursts + 1].address = map->address;
+			msgs[2 * nbursts + 1].flags = LDX_I2C_MSG_READ;
+			msgs[2 * nbursts + 1].length = len * val_bytes;
+			msgs[2 * nbursts + 1].buffer = data + offset;
+
+			burst_start[nbursts] = first;
+			burst_len[nbursts] = len;
+			offset += len * val_bytes;
+			nbursts++;
+		}
+
+		ret = ldx_i2c_transfer_msgs(map->i2c, msgs, 2 * nbursts);
+		if (ret != EXIT_SUCCESS)
+			break;
+
+		/* Distribute the values and fill in the cache */
+		offset = 0;
+		for (b = 0; b < nbursts; b++) {
+			unsigned int r;
+
+			for (r = 0; r < burst_len[b]; r++) {
+				uint32_t val = decode_be(data + offset, val_bytes);
+				unsigned int reg = burst_start[b] + r;
+
+				cache_set(map, reg, val);
+				for (; i < k && pairs[i].reg == reg; i++)
+					vals[pairs[i].idx] = val;
+				offset += val_bytes;
+			}
+		}
+	}
+	ldx_i2c_unlock_bus(map->i2c);
+
+	free(data);
+
+	return ret;
+}
+
+i2c_regmap_t *ldx_i2c_regmap_create(i2c_t *i2c, unsigned int address,
+				    unsigned int reg_bits, unsigned int val_bits)
+{
+	i2c_regmap_t *new_map = NULL;
+	regmap_internal_t *_map = NULL;
+
+	if (i2c == NULL) {
+		log_error("%s: I2C cannot be NULL", __func__);
+		return NULL;
+	}
+
+	if ((reg_bits != 8 && reg_bits != 16) ||
+	    (val_bits != 8 && val_bits != 16 && val_bits != 32)) {
+		log_error("%s: Invalid register (%u) or value (%u) width",
+			  __func__, reg_bits, val_bits);
+		return NULL;
+	}
+
+	new_map = calloc(1, sizeof(i2c_regmap_t));
+	_map = calloc(1, sizeof(regmap_internal_t));
+	if (new_map == NULL || _map == NULL) {
+		log_error("%s: Unable to create register map, cannot allocate memory",
+			  __func__);
+		free(new_map);
+		free(_map);
+		return NULL;
+	}
+	pthread_mutex_init(&_map->lock, NULL);
+
+	{
+		i2c_regmap_t init_map = {
+			.i2c = i2c,
+			.address = address,
+			.reg_bits = reg_bits,
+			.val_bits = val_bits,
+			._data = _map
+		};
+
+		memcpy(new_map, &init_map, sizeof(i2c_regmap_t));
+	}
+
+	return new_map;
+}
+
+int ldx_i2c_regmap_free(i2c_regmap_t *map)
+{
+	regmap_internal_t *_map = NULL;
+	unsigned int i;
+
+	if (map == NULL)
+		return EXIT_SUCCESS;
+
+	_map = map->_data;
+	if (_map != NULL) {
+		for (i = 0; i < _map->nranges; i++) {
+			free(_map->ranges[i].values);
+			free(_map->ranges[i].valid);
+		}
+		free(_map->ranges);
+		pthread_mutex_destroy(&_map->lock);
+		free(_map);
+	}
+	free(map);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_regmap_set_cacheable(i2c_regmap_t *map, unsigned int first,
+				 unsigned int last)
+{
+	regmap_internal_t *_map = NULL;
+	regmap_range_t *ranges, *range;
+	unsigned int i, count;
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (last < first || last >= (1U << map->reg_bits)) {
+		log_error("%s: Invalid register range 0x%x-0x%x", __func__,
+			  first, last);
+		return EXIT_FAILURE;
+	}
+
+	_map = map->_data;
+	pthread_mutex_lock(&_map->lock);
+	for (i = first; i <= last; i++) {
+		if (find_cache(map, i, &range) >= 0) {
+			log_error("%s: Register 0x%x is already cacheable",
+				  __func__, i);
+			goto err;
+		}
+	}
+
+	ranges = realloc(_map->ranges, (_map->nranges + 1) * sizeof(regmap_range_t));
+	if (ranges == NULL) {
+		log_error("%s: Unable to add cache range, cannot allocate memory",
+			  __func__);
+		goto err;
+	}
+	_map->ranges = ranges;
+
+	count = last - first + 1;
+	range = &_map->ranges[_map->nranges];
+	range->first = first;
+	range->last = last;
+	range->values = calloc(count, sizeof(uint32_t));
+	range->valid = calloc(count, sizeof(bool));
+	if (range->values == NULL || range->valid == NULL) {
+		log_error("%s: Unable to add cache range, cannot allocate memory",
+			  __func__);
+		free(range->values);
+		free(range->valid);
+		goto err;
+	}
+	_map->nranges++;
+	pthread_mutex_unlock(&_map->lock);
+
+	return EXIT_SUCCESS;
+
+err:
+	pthread_mutex_unlock(&_map->lock);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_i2c_regmap_cache_drop(i2c_regmap_t *map)
+{
+	regmap_internal_t *_map = NULL;
+	unsigned int i;
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_map = map->_data;
+	pthread_mutex_lock(&_map->lock);
+	for (i = 0; i < _map->nranges; i++)
+		memset(_map->ranges[i].valid, 0,
+		       (_map->ranges[i].last - _map->ranges[i].first + 1) * sizeof(bool));
+	pthread_mutex_unlock(&_map->lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_regmap_read(i2c_regmap_t *map, unsigned int reg, uint32_t *val)
+{
+	return ldx_i2c_regmap_read_multi(map, &reg, val, 1);
+}
+
+int ldx_i2c_regmap_bulk_read(i2c_regmap_t *map, unsigned int reg,
+			     uint32_t *vals, unsigned int count)
+{
+	regmap_pair_t *pairs;
+	unsigned int i, n = 0;
+	int ret = EXIT_SUCCESS;
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (vals == NULL) {
+		log_error("%s: Values cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (count == 0)
+		return EXIT_SUCCESS;
+
+	if (reg >= (1U << map->reg_bits) || count > (1U << map->reg_bits) - reg) {
+		log_error("%s: Invalid register range 0x%x-0x%x", __func__,
+			  reg, reg + count - 1);
+		return EXIT_FAILURE;
+	}
+
+	pairs = malloc(count * sizeof(regmap_pair_t));
+	if (pairs == NULL) {
+		log_error("%s: Unable to read registers, cannot allocate memory",
+			  __func__);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (cache_get(map, reg + i, &vals[i]))
+			continue;
+		pairs[n].reg = reg + i;
+		pairs[n].idx = i;
+		n++;
+	}
+
+	if (n > 0)
+		ret = read_pairs(map, pairs, n, vals);
+
+	free(pairs);
+
+	return ret;
+}
+
+int ldx_i2c_regmap_read_multi(i2c_regmap_t *map, const unsigned int *regs,
+			      uint32_t *vals, unsigned int count)
+{
+	regmap_pair_t *pairs;
+	unsigned int i, n = 0;
+	int ret = EXIT_SUCCESS;
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (regs == NULL || vals == NULL) {
+		log_error("%s: Registers and values cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (count == 0)
+		return EXIT_SUCCESS;
+
+	pairs = malloc(count * sizeof(regmap_pair_t));
+	if (pairs == NULL) {
+		log_error("%s: Unable to read registers, cannot allocate memory",
+			  __func__);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (cache_get(map, regs[i], &vals[i]))
+			continue;
+		pairs[n].reg = regs[i];
+		pairs[n].idx = i;
+		n++;
+	}
+
+	if (n > 0) {
+		qsort(pairs, n, sizeof(regmap_pair_t), compare_pairs);
+		ret = read_pairs(map, pairs, n, vals);
+	}
+
+	free(pairs);
+
+	return ret;
+}
+
+int ldx_i2c_regmap_write(i2c_regmap_t *map, unsigned int reg, uint32_t val)
+{
+	const unsigned int reg_bytes = map ? map->reg_bits / 8 : 0;
+	const unsigned int val_bytes = map ? map->val_bits / 8 : 0;
+	uint8_t buf[6];
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	encode_be(buf, reg, reg_bytes);
+	encode_be(buf + reg_bytes, val, val_bytes);
+
+	/* Keep the bus so the cache is updated in the order of the writes */
+	ldx_i2c_lock_bus(map->i2c);
+	if (ldx_i2c_write(map->i2c, map->address, buf,
+			  reg_bytes + val_bytes) != EXIT_SUCCESS) {
+		ldx_i2c_unlock_bus(map->i2c);
+		log_error("%s: Unable to write register 0x%x of I2C-%d slave 0x%x",
+			  __func__, reg, map->i2c->bus, map->address);
+		return EXIT_FAILURE;
+	}
+
+	/* Write-through: the cached value always matches the device */
+	cache_set(map, reg, val);
+	ldx_i2c_unlock_bus(map->i2c);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_i2c_regmap_update_bits(i2c_regmap_t *map, unsigned int reg,
+			       uint32_t mask, uint32_t val)
+{
+	uint32_t old, new;
+	int ret = EXIT_SUCCESS;
+
+	if (check_regmap(map) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	/* No other handle can modify the register between the read and write */
+	ldx_i2c_lock_bus(map->i2c);
+
+	if (ldx_i2c_regmap_read(map, reg, &old) != EXIT_SUCCESS) {
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	new = (old & ~mask) | (val & mask);
+	if (new != old)
+		ret = ldx_i2c_regmap_write(map, reg, new);
+
+out:
+	ldx_i2c_unlock_bus(map->i2c);
+
+	return ret;
+}
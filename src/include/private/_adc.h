@@ -62,6 +62,91 @@ typedef struct {
 	adc_callback_t *callback;
 } adc_internal_t;
 
+/**
+ * adc_group_internal_t - Data of an ADC scan group for internal use
+ *
+ * @adcs:		Array with the ADCs of the group.
+ * @samples:		Array where the sampling thread stores the samples.
+ * @callback_fn:	The function to be called every period.
+ * @callback_arg:	Custom argument to pass to the callback function.
+ * @thread:		Sampling thread.
+ * @running:		True while the sampling thread exists.
+ * @timer_fd:		Periodic timer descriptor.
+ * @stop_fd:		Event descriptor to stop the sampling thread.
+ * @period_ns:		Sampling period in nanoseconds.
+ * @start_ns:		First deadline, in nanoseconds of the monotonic clock.
+ * @stats:		Timing statistics.
+ * @stats_lock:		Protects the statistics.
+ * @scan_ts:		Time of the scan passed to the callback.
+ */
+typedef struct {
+	adc_t **adcs;
+	int *samples;
+	ldx_adc_group_cb_t callback_fn;
+	void *callback_arg;
+	pthread_t thread;
+	bool running;
+	int timer_fd;
+	int stop_fd;
+	uint64_t period_ns;
+	uint64_t start_ns;
+	adc_group_stats_t stats;
+	pthread_mutex_t stats_lock;
+	ldx_timestamp_t scan_ts;
+} adc_group_internal_t;
+
+/**
+ * adc_buffer_channel_t - Data of a channel in a buffered capture
+ *
+ * @channel:		The ADC channel number.
+ * @scan_index:		Position of the channel in the scans.
+ * @format:		Format of the channel in the scans.
+ * @offset:		Offset to add to the raw samples before scaling.
+ * @scale:		Scale to get mV from the raw samples, -1 if unknown.
+ */
+typedef struct {
+	unsigned int channel;
+	unsigned int scan_index;
+	adc_scan_format_t format;
+	float offset;
+	float scale;
+} adc_buffer_channel_t;
+
+/**
+ * adc_buffer_internal_t - Data of a buffered capture for internal use
+ *
+ * @dev_fd:		Descriptor of the IIO character device.
+ * @channels:		Array with the captured channels.
+ * @timestamp:		True if the scans include the timestamp.
+ * @ts_format:		Format of the timestamp in the scans.
+ * @ts_monotonic:	True if the device timestamps use CLOCK_MONOTONIC.
+ * @ts_clock:		Timestamp clock of the device before the capture, to
+ *			restore it, empty if it was not changed.
+ * @trigger:		Name of the trigger created for the capture, empty
+ *			if an existing trigger is used.
+ */
+typedef struct {
+	int dev_fd;
+	adc_buffer_channel_t *channels;
+	bool timestamp;
+	adc_scan_format_t ts_format;
+	bool ts_monotonic;
+	char ts_clock[16];
+	char trigger[32];
+} adc_buffer_internal_t;
+
+/**
+ * adc_convert_to_mv() - Apply offset and scale to an array of samples
+ *
+ * @in:		Array with the raw samples.
+ * @out:	Array to store the values in mV.
+ * @n:		Number of samples.
+ * @offset:	Offset to add to each raw sample.
+ * @scale:	Scale to multiply each sample.
+ */
+void adc_convert_to_mv(const int *in, float *out, size_t n, float offset,
+		       float scale);
+
 #ifdef __cplusplus
 }
 #endif
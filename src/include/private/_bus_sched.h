@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__BUS_SCHED_H_
+#define PRIVATE__BUS_SCHED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "_list.h"
+#include "common.h"
+
+/**
+ * bus_type_t - Types of buses with a scheduler
+ */
+typedef enum {
+	BUS_TYPE_I2C,
+	BUS_TYPE_SPI,
+} bus_type_t;
+
+/**
+ * bus_sched_t - Transaction scheduler shared by the handles of a bus
+ *
+ * @list:	Entry in the list of schedulers.
+ * @type:	Type of the bus.
+ * @bus:	Bus number.
+ * @refs:	Number of handles using the scheduler.
+ * @lock:	Protects the scheduler state.
+ * @cond:	Signaled when the bus is granted to a class.
+ * @owner:	Thread that holds the bus.
+ * @depth:	Number of nested acquisitions of the owner.
+ * @busy:	True while the bus is held or being handed over.
+ * @granted:	Class the bus is being handed over to, -1 if none.
+ * @waiting:	Number of waiting threads of each class.
+ * @next_ticket: Next arrival ticket of each class.
+ * @serving:	Ticket of each class that is served next.
+ * @skipped:	Grants to higher classes while each class was waiting.
+ */
+typedef struct {
+	struct list_head list;
+	bus_type_t type;
+	unsigned int bus;
+	unsigned int refs;
+	pthread_mutex_t lock;
+	pthread_cond_t cond[BUS_PRIO_COUNT];
+	pthread_t owner;
+	unsigned int depth;
+	bool busy;
+	int granted;
+	unsigned int waiting[BUS_PRIO_COUNT];
+	uint64_t next_ticket[BUS_PRIO_COUNT];
+	uint64_t serving[BUS_PRIO_COUNT];
+	unsigned int skipped[BUS_PRIO_COUNT];
+} bus_sched_t;
+
+/**
+ * bus_sched_get() - Get the scheduler of a bus, creating it if needed
+ *
+ * @type:	Type of the bus.
+ * @bus:	Bus number.
+ *
+ * Return: The scheduler, NULL on error.
+ */
+bus_sched_t *bus_sched_get(bus_type_t type, unsigned int bus);
+
+/**
+ * bus_sched_put() - Release a reference to a bus scheduler
+ *
+ * @sched:	The scheduler.
+ */
+void bus_sched_put(bus_sched_t *sched);
+
+/**
+ * bus_sched_acquire() - Wait for the bus to be granted
+ *
+ * @sched:	The scheduler.
+ * @prio:	Priority class of the transaction.
+ *
+ * The owner of the bus can acquire it again (nested), for example to run
+ * several calls as one sequence.
+ */
+void bus_sched_acquire(bus_sched_t *sched, bus_prio_t prio);
+
+/**
+ * bus_sched_release() - Release the bus and grant it to the next class
+ *
+ * @sched:	The scheduler.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE if the calling thread does
+ *	   not hold the bus.
+ */
+int bus_sched_release(bus_sched_t *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__BUS_SCHED_H_ */
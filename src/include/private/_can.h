@@ -23,7 +23,7 @@ extern "C" {
 
 #include <net/if.h>
 #include <pthread.h>
-#include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 /*
  * Define _UAPI_CAN_NETLINK_H to avoid 'libsocketcan.h' including
@@ -34,21 +34,185 @@ extern "C" {
 #include <libsocketcan.h>
 
 #include "_list.h"
+#include "reactor.h"
+#include "_timestamp.h"
+
+/* Maximum number of rx handlers sharing the rx socket of an interface */
+#define CAN_SHARED_MAX_HANDLERS	64
+
+/* Size of the 29-bit ID lookup hash of the shared rx socket */
+#define CAN_EFF_HASH_BITS	10
+#define CAN_EFF_HASH_LEN	(1 << CAN_EFF_HASH_BITS)
+
+/* Room for a SO_TIMESTAMPNS or SO_TIMESTAMPING and a SO_RXQ_OVFL control message */
+#define CAN_CTRLMSG_LEN	(CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(__u32)))
 
 /**
  * can_cb - Data required in the CAN rx callback
  *
  * @list:			A list that contains CAN interfaces.
- * @function:		Function to be executed in the callback.
- * @rx_skt:			Reception socket for incoming frames.
- * @droped_frames:	Dropped frames.
+ * @handler:		Function to be executed for each received frame.
+ * @batch_handler:	Function to be executed for each batch of frames.
+ * @ts_handler:		Function to be executed for each batch of timestamped frames.
+ * @arg:		Argument of the timestamped handler.
+ * @rx_skt:			Reception socket for incoming frames, -1 for handlers
+ *			served by the shared socket.
+ * @slot:		Index in the shared socket filter table, -1 if unused.
+ * @filters:		Copy of the filters of the handler.
+ * @nfilters:		Number of filters.
+ * @stats:		Reception statistics of the handler.
  */
 typedef struct can_cb {
 	struct list_head	list;
 	ldx_can_rx_cb_t		handler;
+	ldx_can_rx_batch_cb_t	batch_handler;
+	ldx_can_rx_ts_cb_t	ts_handler;
+	void			*arg;
 	int			rx_skt;
+	int			slot;
+	struct can_filter	*filters;
+	int			nfilters;
+	can_rx_stats_t		stats;
 } can_cb_t;
 
+/**
+ * can_id_entry_t - Cached handler set of a 29-bit CAN ID
+ *
+ * @key:		CAN ID with its EFF and RTR flags, 0 if the entry is free.
+ * @handlers:		Bitmask of the handler slots that accept the ID.
+ */
+typedef struct can_id_entry {
+	canid_t			key;
+	uint64_t		handlers;
+} can_id_entry_t;
+
+/**
+ * can_filter_table_t - Compiled filters of the handlers on the shared socket
+ *
+ * @list:		Entry in the list of tables pending release.
+ * @handlers:		Handler registered in each slot.
+ * @all_mask:		Bitmask of every registered slot.
+ * @batch_mask:		Bitmask of the slots with a batch handler.
+ * @sff:		Handler bitmask of every 11-bit ID, without and with RTR.
+ * @eff:		Open addressing hash of the 29-bit IDs already seen.
+ * @eff_count:		Number of used entries in the hash.
+ */
+typedef struct can_filter_table {
+	struct list_head	list;
+	can_cb_t		*handlers[CAN_SHARED_MAX_HANDLERS];
+	uint64_t		all_mask;
+	uint64_t		batch_mask;
+	uint64_t		sff[2][CAN_SFF_MASK + 1];
+	can_id_entry_t		eff[CAN_EFF_HASH_LEN];
+	unsigned int		eff_count;
+} can_filter_table_t;
+
+/**
+ * can_rx_queue_t - Single producer, single consumer queue of received frames
+ *
+ * @len:		Number of frames the queue holds, a power of two.
+ * @head:		Total frames pushed, only written by the working thread.
+ * @tail:		Total frames popped, only written by the consumer.
+ * @waiting:		Set while the consumer sleeps on @evfd.
+ * @evfd:		Eventfd used to wake up the consumer.
+ * @overruns:		Frames lost because the queue was full.
+ * @frames:		Queued frames.
+ * @tstamp:		Timestamp of each queued frame.
+ */
+typedef struct can_rx_queue {
+	unsigned int		len;
+	unsigned int		head __attribute__((aligned(64)));
+	unsigned int		tail __attribute__((aligned(64)));
+	int			waiting __attribute__((aligned(64)));
+	int			evfd;
+	uint64_t		overruns;
+	struct canfd_frame	*frames;
+	struct timeval		*tstamp;
+} can_rx_queue_t;
+
+/**
+ * can_rx_ring_t - Preallocated buffers used to drain the rx sockets
+ *
+ * @msgs:		Message headers passed to recvmmsg().
+ * @iov:		One I/O vector per frame slot.
+ * @addr:		Source address of each received frame.
+ * @frames:		Received frames.
+ * @tstamp:		Timestamp of each received frame.
+ * @tstamp_ns:		Nanosecond timestamp of each received frame.
+ * @tstamp_sw:		Software (CLOCK_REALTIME) timestamp of each received frame.
+ * @ts:			Timestamp of each frame, for the timestamped handlers.
+ * @ctrlmsg:		Control message buffer of each frame slot.
+ * @match:		Handlers that accept each frame, for the shared socket.
+ * @batch_frames:	Frames of a batch handler on the shared socket.
+ * @batch_tstamp:	Timestamps of a batch handler on the shared socket.
+ */
+typedef struct can_rx_ring {
+	struct mmsghdr		msgs[LDX_CAN_BATCH_LEN];
+	struct iovec		iov[LDX_CAN_BATCH_LEN];
+	struct sockaddr_can	addr[LDX_CAN_BATCH_LEN];
+	struct canfd_frame	frames[LDX_CAN_BATCH_LEN];
+	struct timeval		tstamp[LDX_CAN_BATCH_LEN];
+	struct timespec		tstamp_ns[LDX_CAN_BATCH_LEN];
+	struct timespec		tstamp_sw[LDX_CAN_BATCH_LEN];
+	ldx_timestamp_t		ts[LDX_CAN_BATCH_LEN];
+	char			ctrlmsg[LDX_CAN_BATCH_LEN][CAN_CTRLMSG_LEN];
+	uint64_t		match[LDX_CAN_BATCH_LEN];
+	struct canfd_frame	batch_frames[LDX_CAN_BATCH_LEN];
+	struct timeval		batch_tstamp[LDX_CAN_BATCH_LEN];
+} can_rx_ring_t;
+
+/**
+ * can_capture_t - Capture of the received frames to memory-mapped files
+ *
+ * @path:		Path of the active file.
+ * @iface:		Name of the captured interface.
+ * @opts:		Capture options, with the defaults applied.
+ * @flags:		LDX_CAN_CAPTURE_FLAG_* flags of the files.
+ * @fd:			Descriptor of the active file.
+ * @timer_fd:		Timer of the periodic flushes.
+ * @hdr:		Mapping of the active file.
+ * @record_size:	Size of a record.
+ * @capacity:		Number of records of a file.
+ * @count:		Records written to the active file.
+ * @flushed:		Records of the active file already written back.
+ * @lost:		Frames lost because the next file was not ready.
+ * @rotator:		Thread preparing the next file and retiring the full one.
+ * @has_rotator:	Whether 'rotator' was started, only without
+ *			LDX_CAN_CAPTURE_FLAG_RING.
+ * @lock:		Protects the fields below.
+ * @cond:		Wakes up the rotator.
+ * @stop:		Whether the rotator must exit.
+ * @next_fd:		Descriptor of the prepared next file, -1 if not ready.
+ * @next_hdr:		Mapping of the prepared next file.
+ * @old_fd:		Descriptor of the full file to retire, -1 if there is none.
+ * @old_hdr:		Mapping of the full file to retire.
+ * @old_count:		Records written to the full file.
+ */
+typedef struct can_capture {
+	char			*path;
+	char			iface[IFNAMSIZ];
+	can_capture_opts_t	opts;
+	uint32_t		flags;
+	int			fd;
+	int			timer_fd;
+	can_capture_header_t	*hdr;
+	size_t			record_size;
+	uint64_t		capacity;
+	uint64_t		count;
+	uint64_t		flushed;
+	uint64_t		lost;
+	pthread_t		rotator;
+	bool			has_rotator;
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond;
+	bool			stop;
+	int			next_fd;
+	can_capture_header_t	*next_hdr;
+	int			old_fd;
+	can_capture_header_t	*old_hdr;
+	uint64_t		old_count;
+} can_capture_t;
+
 /**
  * can_err_cb	CAN callback on error
  *
@@ -68,15 +232,31 @@ typedef struct can_err_cb {
  * @tx_skt:		Transmission socket.
  * @mtu:		Maximun transmit unit for the CAN interface.
  * @maxdlen:	Maximun length of the data to transmit.
- * @maxfd:		Maximun flexible data rate.
- * @can_fds:	CAN Flexible data rate.
+ * @epfd:		Epoll instance watched by the working thread.
+ * @evfd:		Eventfd used to wake up the working thread.
  * @can_tout:	CAN timeval.
  * @can_thr:		Working thread used by the library.
  * @can_thr_attr:	Working thread attribute structure.
- * @mux:			Mutex lock thread.
+ * @mutex:		Mutex protecting the callback lists.
+ * @reap_cond:		Signaled each time the thread releases removed rx callbacks.
+ * @reap_seq:		Number of times removed rx callbacks have been released.
+ * @reap_waiters:	Number of threads waiting for the current dispatch to end.
+ * @in_dispatch:	True while events are being waited for or dispatched.
+ * @dispatch_thr:	Thread waiting for or dispatching the events.
+ * @reactor:		Reactor processing the events instead of can_thr, if any.
  * @run_thr:		Variable to check if the thread is running.
  * @rx_cb_list_head:	Linked list head for rx callbacks.
+ * @rx_cb_free_list_head:	Linked list head for rx callbacks pending release.
+ * @shared_rx:		Entry of the rx socket shared by the handlers, if any.
+ * @ftable:		Compiled filters of the handlers on the shared socket.
+ * @ftable_free_list_head:	Linked list head for filter tables pending release.
+ * @shared_slots:	Bitmask of the used shared socket handler slots.
+ * @queue_rx:		Entry of the rx socket feeding the rx queue, if any.
+ * @rx_queue:		Queue of received frames, if enabled.
+ * @capture_rx:		Entry of the rx socket feeding the capture, if any.
+ * @capture:		Capture of the received frames, if running.
  * @err_cb_list_head:	Linked list head for error callbacks.
+ * @rx_ring:		Buffers used by the working thread to receive frames.
  */
 typedef struct {
 	struct ifreq		ifr;
@@ -85,20 +265,175 @@ typedef struct {
 	uint32_t		mtu;
 	uint32_t		maxdlen;
 
-	int			maxfd;
-	fd_set			can_fds;
+	int			epfd;
+	int			evfd;
 	struct timeval		can_tout;
 
 	pthread_t		*can_thr;
 	pthread_attr_t		can_thr_attr;
 	pthread_mutex_t		mutex;
+	pthread_cond_t		reap_cond;
+	unsigned int		reap_seq;
+	unsigned int		reap_waiters;
+	bool			in_dispatch;
+	pthread_t		dispatch_thr;
+	reactor_t		*reactor;
 	bool			run_thr;
 
 	struct list_head	rx_cb_list_head;
+	struct list_head	rx_cb_free_list_head;
+
+	can_cb_t		*shared_rx;
+	can_filter_table_t	*ftable;
+	struct list_head	ftable_free_list_head;
+	uint64_t		shared_slots;
+
+	can_cb_t		*queue_rx;
+	can_rx_queue_t		*rx_queue;
+	can_cb_t		*capture_rx;
+	can_capture_t		*capture;
 	struct list_head	err_cb_list_head;
 
+	can_rx_ring_t		rx_ring;
 } can_priv_t;
 
+/**
+ * can_filter_table_compile() - Build the ID lookup table of the shared socket
+ *
+ * @rx_cb_list_head:	List of rx handlers, those with a slot are included.
+ *
+ * Return: The new table on success, NULL on error.
+ */
+can_filter_table_t *can_filter_table_compile(struct list_head *rx_cb_list_head);
+
+/**
+ * can_filter_table_free() - Free a table built by can_filter_table_compile()
+ *
+ * @table:	The table to free.
+ */
+void can_filter_table_free(can_filter_table_t *table);
+
+/**
+ * can_filter_table_lookup() - Get the handlers that accept a CAN ID
+ *
+ * @table:	The compiled table.
+ * @can_id:	The can_id of the received frame.
+ *
+ * Return: Bitmask of the slots of the handlers accepting the frame.
+ */
+uint64_t can_filter_table_lookup(can_filter_table_t *table, canid_t can_id);
+
+/**
+ * can_filter_merge() - Merge the filters of the shared socket handlers
+ *
+ * @rx_cb_list_head:	List of rx handlers, those with a slot are included.
+ * @kfilters:		Where to store the merged filters. Memory is obtained
+ *			with 'malloc' and must be freed by the caller.
+ *
+ * Duplicated filters and filters covered by others are removed, so the
+ * result is the smallest set the kernel has to evaluate.
+ *
+ * Return: The number of merged filters, 0 if no frame is needed, -1 if
+ *         every frame is needed.
+ */
+int can_filter_merge(struct list_head *rx_cb_list_head, struct can_filter **kfilters);
+
+/**
+ * can_rx_queue_create() - Allocate a rx queue
+ *
+ * @len:	Minimum number of frames to hold, rounded up to a power of two.
+ *
+ * Return: The new queue on success, NULL on error.
+ */
+can_rx_queue_t *can_rx_queue_create(unsigned int len);
+
+/**
+ * can_rx_queue_free() - Free a queue allocated by can_rx_queue_create()
+ *
+ * @queue:	The queue to free.
+ */
+void can_rx_queue_free(can_rx_queue_t *queue);
+
+/**
+ * can_rx_queue_push() - Queue received frames, from the producer only
+ *
+ * @queue:	The rx queue.
+ * @frames:	The frames to queue.
+ * @tstamp:	The timestamp of each frame.
+ * @nframes:	Number of frames.
+ *
+ * Frames that do not fit are dropped and counted as overruns.
+ *
+ * Return: The number of queued frames.
+ */
+unsigned int can_rx_queue_push(can_rx_queue_t *queue, const struct canfd_frame *frames,
+			       const struct timeval *tstamp, unsigned int nframes);
+
+/**
+ * can_rx_queue_pop() - Take frames from the queue, from the consumer only
+ *
+ * @queue:	The rx queue.
+ * @frames:	Where to store the frames.
+ * @tstamp:	Where to store the timestamps, may be NULL.
+ * @max:	Maximum number of frames to take.
+ * @timeout_ms:	Milliseconds to wait for frames, 0 to return immediately
+ *		and -1 to wait indefinitely.
+ *
+ * Return: The number of frames taken, 0 on timeout, error code otherwise.
+ */
+int can_rx_queue_pop(can_rx_queue_t *queue, struct canfd_frame *frames,
+		     struct timeval *tstamp, unsigned int max, int timeout_ms);
+
+/**
+ * can_capture_open() - Create the first file of a capture
+ *
+ * @path:	Path of the active file.
+ * @iface:	Name of the captured interface.
+ * @opts:	Capture options, NULL for the defaults.
+ * @flags:	LDX_CAN_CAPTURE_FLAG_FD and LDX_CAN_CAPTURE_FLAG_HW_TSTAMP.
+ * @ret:	Where to store the error code on failure.
+ *
+ * Return: The new capture on success, NULL on error.
+ */
+can_capture_t *can_capture_open(const char *path, const char *iface,
+				const can_capture_opts_t *opts, uint32_t flags,
+				int *ret);
+
+/**
+ * can_capture_close() - Write back and close the files of a capture
+ *
+ * @cap:	The capture to close.
+ */
+void can_capture_close(can_capture_t *cap);
+
+/**
+ * can_capture_write() - Store received frames, from the working thread only
+ *
+ * @cap:	The capture.
+ * @frames:	The received frames.
+ * @tstamp:	The CLOCK_REALTIME timestamp of each frame, NULL to use the
+ *		current time.
+ * @hw_tstamp:	The raw hardware timestamp of each frame, NULL if there are
+ *		none. Equal to 'tstamp' when the controller did not stamp it.
+ * @nframes:	Number of frames.
+ *
+ * When the active file is full, unless it is a ring, the capture switches
+ * to the file prepared by the rotator thread, which retires the full one.
+ */
+void can_capture_write(can_capture_t *cap, const struct canfd_frame *frames,
+		       const struct timespec *tstamp,
+		       const struct timespec *hw_tstamp, unsigned int nframes);
+
+/**
+ * can_capture_flush() - Start the write back of the captured frames
+ *
+ * @cap:	The capture.
+ *
+ * Called when the flush timer of the capture expires. Also wakes up the
+ * rotator if it could not prepare the next file yet.
+ */
+void can_capture_flush(can_capture_t *cap);
+
 #ifdef __cplusplus
 }
 #endif
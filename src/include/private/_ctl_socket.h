@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__CTL_SOCKET_H_
+#define PRIVATE__CTL_SOCKET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * ctl_socket_type_t - Types of control sockets in the cache
+ *
+ * CTL_SOCKET_INET is used for the interface (SIOCGIF*) and the wireless
+ * extensions (SIOCGIW*) requests, CTL_SOCKET_HCI for the requests to the
+ * Bluetooth subsystem that are not bound to a device (HCIGETDEV*).
+ */
+typedef enum {
+	CTL_SOCKET_INET,
+	CTL_SOCKET_HCI,
+	__CTL_SOCKET_LAST,
+} ctl_socket_type_t;
+
+/*
+ * ctl_socket_get() - Get the shared control socket of a type
+ *
+ * @type:	Type of the socket.
+ *
+ * The socket is created the first time it is requested and kept open until
+ * the library is unloaded. It can be used from several threads at the same
+ * time and must not be closed by the caller.
+ *
+ * Return: The socket descriptor, -1 on error with errno set.
+ */
+int ctl_socket_get(ctl_socket_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__CTL_SOCKET_H_ */
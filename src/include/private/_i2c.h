@@ -0,0 +1,44 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__I2C_H_
+#define PRIVATE__I2C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "_bus_sched.h"
+#include "_libsoc_interfaces.h"
+
+/**
+ * i2c_internal_t - Defined values for internal use
+ *
+ * @libsoc:	The libsoc I2C handle.
+ * @sched:	Transaction scheduler of the bus.
+ * @prio:	Priority class of the transactions of this handle.
+ */
+typedef struct {
+	libsoc_i2c_t *libsoc;
+	bus_sched_t *sched;
+	bus_prio_t prio;
+} i2c_internal_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__I2C_H_ */
@@ -21,10 +21,92 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <syslog.h>
 
 #define API_ID			"DIGIAPIX"
 
+/*
+ * Messages with a priority lower than LDX_LOG_MIN_LEVEL (for example,
+ * LOG_DEBUG and LOG_INFO with LDX_LOG_MIN_LEVEL=LOG_NOTICE) are removed at
+ * build time. Define it with 'make CONFIG_LOG_MIN_LEVEL=<level>'.
+ */
+#ifndef LDX_LOG_MIN_LEVEL
+#define LDX_LOG_MIN_LEVEL	LOG_DEBUG
+#endif
+
+/* Rate limit of 'log_error_ratelimited()': burst of messages per interval */
+#define LOG_RATELIMIT_INTERVAL_MS	5000
+#define LOG_RATELIMIT_BURST		10
+
+/**
+ * log_ratelimit_t - State of a rate limited log call site
+ *
+ * @begin_ms:	Start of the current interval in milliseconds.
+ * @printed:	Messages logged in the current interval.
+ * @missed:	Messages suppressed in the current interval.
+ */
+typedef struct {
+	int64_t begin_ms;
+	int printed;
+	int missed;
+} log_ratelimit_t;
+
+/*
+ * Copy of the mask configured with 'setlogmask()', so disabled messages
+ * are discarded before formatting their arguments. Not exported.
+ */
+extern int ldx_log_mask __attribute__ ((visibility("hidden")));
+
+/**
+ * log_set_mask() - Set the log mask of the library and the system logger
+ *
+ * @mask:	New log mask, see 'setlogmask()'. 0 keeps the current mask of
+ *		the system logger and only refreshes the library copy.
+ *
+ * Return: The previous log mask.
+ */
+int log_set_mask(int mask);
+
+/**
+ * log_ratelimit() - Check if a rate limited message can be logged
+ *
+ * @rs:		State of the call site.
+ * @func:	Name of the function of the call site.
+ *
+ * At most LOG_RATELIMIT_BURST messages are logged every
+ * LOG_RATELIMIT_INTERVAL_MS, and the number of suppressed messages is
+ * logged when a new interval starts.
+ *
+ * Return: True if the message can be logged, false otherwise.
+ */
+bool log_ratelimit(log_ratelimit_t *rs, const char *func);
+
+/**
+ * log_enabled() - Check if messages of the given priority are logged
+ *
+ * @level:	Log level.
+ */
+#define log_enabled(level)					\
+	((level) <= LDX_LOG_MIN_LEVEL				\
+	 && (__atomic_load_n(&ldx_log_mask, __ATOMIC_RELAXED) & LOG_MASK(level)))
+
+/**
+ * log_msg() - Log the given message if its priority is enabled
+ *
+ * @level:	Log level.
+ * @format:	Message to log.
+ * @args:	Additional arguments.
+ *
+ * The arguments are not evaluated if the priority is disabled.
+ */
+#define log_msg(level, format, ...)				\
+	do {							\
+		if (log_enabled(level))				\
+			syslog(level, format, __VA_ARGS__);	\
+	} while (0)
+
 /**
  * init_logger() - Initialize the logger with the given log level
  *
@@ -35,7 +117,7 @@ extern "C" {
 #define init_logger(level, options)				\
 	do {							\
 		openlog(API_ID, options, LOG_USER);		\
-		setlogmask(LOG_UPTO(level));			\
+		log_set_mask(LOG_UPTO(level));			\
 	} while (0)
 
 /**
@@ -52,7 +134,24 @@ extern "C" {
  * @args:	Additional arguments.
  */
 #define log_error(format, ...)					\
-	syslog(LOG_ERR, "[ERROR] " format, __VA_ARGS__)
+	log_msg(LOG_ERR, "[ERROR] " format, __VA_ARGS__)
+
+/**
+ * log_error_ratelimited() - Log the given message as error with a rate limit
+ *
+ * @format:	Error message to log.
+ * @args:	Additional arguments.
+ *
+ * For errors in paths that can repeat at high rate (transfers, reads), so
+ * a failing device does not flood the system logger. See 'log_ratelimit()'.
+ */
+#define log_error_ratelimited(format, ...)				\
+	do {								\
+		static log_ratelimit_t _rs;				\
+									\
+		if (log_enabled(LOG_ERR) && log_ratelimit(&_rs, __func__))	\
+			syslog(LOG_ERR, "[ERROR] " format, __VA_ARGS__);	\
+	} while (0)
 
 /**
  * log_warning() - Log the given message as warning
@@ -61,7 +160,7 @@ extern "C" {
  * @args:	   Additional arguments.
  */
 #define log_warning(format, ...)					\
-	syslog(LOG_WARNING, "[WARNING] " format, __VA_ARGS__)
+	log_msg(LOG_WARNING, "[WARNING] " format, __VA_ARGS__)
 
 /**
  * log_notice() - Log the given message as notice
@@ -70,7 +169,7 @@ extern "C" {
  * @args:	  Additional arguments.
  */
 #define log_notice(format, ...)					\
-	syslog(LOG_NOTICE, "[NOTICE] " format, __VA_ARGS__)
+	log_msg(LOG_NOTICE, "[NOTICE] " format, __VA_ARGS__)
 
 /**
  * log_info() - Log the given message as info
@@ -79,7 +178,7 @@ extern "C" {
  * @args:	Additional arguments.
  */
 #define log_info(format, ...)					\
-	syslog(LOG_INFO, "[INFO] " format, __VA_ARGS__)
+	log_msg(LOG_INFO, "[INFO] " format, __VA_ARGS__)
 
 /**
  * log_debug() - Log the given message as debug
@@ -88,7 +187,7 @@ extern "C" {
  * @args:	Additional arguments.
  */
 #define log_debug(format, ...)					\
-	syslog(LOG_DEBUG, "[DEBUG] " format, __VA_ARGS__)
+	log_msg(LOG_DEBUG, "[DEBUG] " format, __VA_ARGS__)
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2022, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__NETLINK_H_
+#define PRIVATE__NETLINK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Receive buffer size, large enough for a full dump message of the kernel */
+#define NL_BUF_LEN	32768
+
+/* First attribute and length of the attributes of a generic netlink message */
+#define GENL_ATTRS(nlh)		((struct rtattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN))
+#define GENL_ATTRS_LEN(nlh)	((int)(nlh)->nlmsg_len - (int)NLMSG_LENGTH(GENL_HDRLEN))
+
+/**
+ * nl_sock_t - A netlink socket
+ *
+ * @fd:		Socket descriptor.
+ * @pid:	Port ID assigned by the kernel to the socket.
+ * @seq:	Sequence number of the last request.
+ * @buf:	Receive buffer of NL_BUF_LEN bytes.
+ */
+typedef struct {
+	int fd;
+	uint32_t pid;
+	uint32_t seq;
+	char *buf;
+} nl_sock_t;
+
+/**
+ * Callback function type used to process the messages of a reply
+ *
+ * @nlh:	The received message.
+ * @arg:	The argument given to 'nl_request()'.
+ *
+ * Return: 0 to keep processing messages, any other value to ignore the rest
+ *	   of the reply.
+ */
+typedef int (*nl_msg_cb_t)(struct nlmsghdr *nlh, void *arg);
+
+/*
+ * nl_open() - Open a netlink socket
+ *
+ * @nl:		The socket to open.
+ * @protocol:	Netlink protocol (NETLINK_ROUTE, NETLINK_GENERIC, ...).
+ * @groups:	Bitmask of the multicast groups to join (RTMGRP_*), 0 for
+ *		none.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int nl_open(nl_sock_t *nl, int protocol, uint32_t groups);
+
+/*
+ * nl_close() - Close a netlink socket
+ *
+ * @nl:		The socket to close.
+ */
+void nl_close(nl_sock_t *nl);
+
+/*
+ * nl_request() - Send a request and process its reply
+ *
+ * @nl:		An open socket.
+ * @req:	The request, with 'nlmsg_len', 'nlmsg_type' and 'nlmsg_flags'
+ *		filled. The sequence number is set by this function.
+ * @cb:		Function to call for each message of the reply, can be NULL.
+ * @arg:	Argument to pass to the callback.
+ *
+ * Dump requests (NLM_F_DUMP) are processed until their end. Messages that do
+ * not belong to the request, like multicast notifications, are skipped.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+int nl_request(nl_sock_t *nl, struct nlmsghdr *req, nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl_recv() - Receive and process the pending messages of a socket
+ *
+ * @nl:		An open socket.
+ * @cb:		Function to call for each received message.
+ * @arg:	Argument to pass to the callback.
+ *
+ * This function does not block, it is meant to drain the multicast
+ * notifications of a socket once it is readable.
+ *
+ * Return: EXIT_SUCCESS when there are no more pending messages, EXIT_FAILURE
+ *	   otherwise with errno set (ENOBUFS means notifications were lost).
+ */
+int nl_recv(nl_sock_t *nl, nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl_dump() - Dump the objects of a rtnetlink family
+ *
+ * @nl:		An open socket.
+ * @type:	Type of the dump request (RTM_GETLINK, RTM_GETADDR, ...).
+ * @family:	Address family of the objects, AF_UNSPEC for all.
+ * @cb:		Function to call for each object.
+ * @arg:	Argument to pass to the callback.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+int nl_dump(nl_sock_t *nl, uint16_t type, unsigned char family,
+	    nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl_parse_attrs() - Index the attributes of a message by type
+ *
+ * @tb:		Array of 'max' + 1 entries to fill.
+ * @max:	Highest attribute type to index.
+ * @rta:	First attribute.
+ * @len:	Length of the attributes.
+ *
+ * Entries of missing attributes are set to NULL.
+ */
+void nl_parse_attrs(struct rtattr **tb, int max, struct rtattr *rta, int len);
+
+/*
+ * nl_add_attr() - Append an attribute to a request
+ *
+ * @nlh:	The request.
+ * @maxlen:	Size of the buffer of the request.
+ * @type:	Type of the attribute.
+ * @data:	Payload of the attribute, can be NULL if 'len' is 0.
+ * @len:	Length of the payload.
+ *
+ * Generic netlink attributes (struct nlattr) have the same layout as the
+ * rtnetlink ones, so this function and 'nl_parse_attrs()' serve both.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE if the attribute does not
+ *	   fit in the buffer.
+ */
+int nl_add_attr(struct nlmsghdr *nlh, size_t maxlen, uint16_t type,
+		const void *data, size_t len);
+
+/*
+ * nl_genl_family() - Resolve the identifier of a generic netlink family
+ *
+ * @nl:		An open NETLINK_GENERIC socket.
+ * @name:	Name of the family ("nl80211", ...).
+ *
+ * Return: The family identifier, -1 on error with errno set.
+ */
+int nl_genl_family(nl_sock_t *nl, const char *name);
+
+/*
+ * nl_genl_group() - Resolve the identifier of a generic netlink multicast
+ *		     group
+ *
+ * @nl:		An open NETLINK_GENERIC socket.
+ * @name:	Name of the family ("nl80211", ...).
+ * @group:	Name of the multicast group of the family ("scan", ...).
+ *
+ * Return: The group identifier, -1 on error with errno set.
+ */
+int nl_genl_group(nl_sock_t *nl, const char *name, const char *group);
+
+/*
+ * nl_join_group() - Join a multicast group
+ *
+ * @nl:		An open socket.
+ * @group:	Identifier of the group. Unlike the 'groups' bitmask of
+ *		'nl_open()', it is not limited to the first 32 groups.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+int nl_join_group(nl_sock_t *nl, uint32_t group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__NETLINK_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__NL80211_H_
+#define PRIVATE__NL80211_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <linux/nl80211.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "_netlink.h"
+
+/* Maximum length of the extra attributes of a request */
+#define NL80211_ATTRS_LEN	256
+
+/*
+ * nl80211_request() - Send a nl80211 command and process its reply
+ *
+ * @cmd:	The command (NL80211_CMD_*).
+ * @flags:	Extra request flags, like NLM_F_DUMP.
+ * @ifindex:	Index of the interface the command applies to, 0 for none.
+ * @cb:		Function to call for each message of the reply, can be NULL.
+ *		It is called with the socket locked, so it must not issue
+ *		other requests.
+ * @arg:	Argument to pass to the callback.
+ *
+ * Requests go through a generic netlink socket that is opened on first use
+ * and shared by all the threads of the process.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+int nl80211_request(uint8_t cmd, uint16_t flags, uint32_t ifindex,
+		    nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl80211_request_attrs() - Send a nl80211 command with extra attributes and
+ *			     process its reply
+ *
+ * @cmd:	The command (NL80211_CMD_*).
+ * @flags:	Extra request flags, like NLM_F_DUMP.
+ * @ifindex:	Index of the interface the command applies to, 0 for none.
+ * @attrs:	Attributes to append to the request, already formatted.
+ * @len:	Length of the attributes, up to NL80211_ATTRS_LEN bytes.
+ * @cb:		Function to call for each message of the reply, can be NULL.
+ * @arg:	Argument to pass to the callback.
+ *
+ * See 'nl80211_request()'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise with errno set.
+ */
+int nl80211_request_attrs(uint8_t cmd, uint16_t flags, uint32_t ifindex,
+			  const void *attrs, size_t len, nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl80211_events_start() - Start receiving the nl80211 notifications
+ *
+ * @cb:		Function to call for each notification. It is called with
+ *		NULL when notifications were lost and cached data must be
+ *		discarded.
+ * @arg:	Argument to pass to the callback.
+ *
+ * The notifications of the "config", "scan", "regulatory" and "mlme" groups
+ * are delivered from a thread that runs until the library is unloaded. There
+ * is a single consumer: once started, later calls only check the thread is
+ * running and ignore their arguments. The callback can issue requests with
+ * 'nl80211_request()'.
+ *
+ * Return: EXIT_SUCCESS if the notifications are being received, EXIT_FAILURE
+ *	   otherwise.
+ */
+int nl80211_events_start(nl_msg_cb_t cb, void *arg);
+
+/*
+ * nl80211_freq_to_channel() - Convert a frequency to its channel number
+ *
+ * @freq:	Frequency in MHz.
+ *
+ * Return: The channel number, -1 if the frequency does not belong to a
+ *	   known band.
+ */
+int nl80211_freq_to_channel(unsigned int freq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__NL80211_H_ */
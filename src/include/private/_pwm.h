@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__PWM_H_
+#define PRIVATE__PWM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include "_libsoc_interfaces.h"
+#include "pwm.h"
+
+/**
+ * pwm_internal_t - Defined values for internal use
+ *
+ * @libsoc:	The libsoc PWM handle, with the sysfs attributes open.
+ * @state:	Last state written to the PWM.
+ * @cached:	True if 'state' matches the hardware.
+ */
+typedef struct {
+	libsoc_pwm_t *libsoc;
+	pwm_state_t state;
+	bool cached;
+} pwm_internal_t;
+
+/**
+ * PWM_GROUP_DIGITS - Maximum number of digits of a value written to a PWM
+ */
+#define PWM_GROUP_DIGITS	10
+
+/**
+ * pwm_group_internal_t - Data of a PWM group for internal use
+ *
+ * @pwms:	Array with the PWMs of the group.
+ * @duty_fds:	Open 'duty_cycle' attributes of the PWMs.
+ * @digits:	Scratch space to format the values, PWM_GROUP_DIGITS
+ *		characters per PWM.
+ * @lengths:	Length of the formatted value of each PWM.
+ */
+typedef struct {
+	pwm_t **pwms;
+	int *duty_fds;
+	char *digits;
+	unsigned int *lengths;
+} pwm_group_internal_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__PWM_H_ */
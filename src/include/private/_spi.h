@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PRIVATE__SPI_H_
+#define PRIVATE__SPI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "_bus_sched.h"
+#include "_libsoc_interfaces.h"
+#include "spi.h"
+
+/**
+ * spi_request_t - Asynchronous SPI request
+ *
+ * @segs:	Segments to transfer, owned by the caller.
+ * @n:		Number of segments.
+ * @cb:		Function to call when the request completes.
+ * @arg:	Argument to pass to the callback.
+ */
+typedef struct {
+	spi_segment_t *segs;
+	unsigned int n;
+	ldx_spi_done_cb_t cb;
+	void *arg;
+} spi_request_t;
+
+/**
+ * spi_async_t - Asynchronous submission queue of a SPI
+ *
+ * @requests:	Preallocated ring of requests.
+ * @len:	Number of requests of the ring.
+ * @head:	Index of the oldest queued request.
+ * @count:	Number of queued requests.
+ * @busy:	True while the worker is running a request.
+ * @stop:	True to make the worker exit once the queue is empty.
+ * @thread:	Worker thread.
+ * @lock:	Protects the queue.
+ * @not_empty:	Signaled when a request is queued or the worker must stop.
+ * @not_full:	Signaled when a request leaves the queue.
+ * @idle:	Signaled when the queue becomes empty and the worker idle.
+ */
+typedef struct {
+	spi_request_t *requests;
+	unsigned int len;
+	unsigned int head;
+	unsigned int count;
+	bool busy;
+	bool stop;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	pthread_cond_t idle;
+} spi_async_t;
+
+/**
+ * spi_internal_t - Defined values for internal use
+ *
+ * @libsoc:	The libsoc SPI handle.
+ * @async:	Asynchronous submission queue, NULL until started.
+ * @async_lock:	Serializes starting and stopping the submission queue.
+ * @sched:	Transaction scheduler of the SPI device.
+ * @prio:	Priority class of the transactions of this handle.
+ */
+typedef struct {
+	libsoc_spi_t *libsoc;
+	spi_async_t *async;
+	pthread_mutex_t async_lock;
+	bus_sched_t *sched;
+	bus_prio_t prio;
+} spi_internal_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__SPI_H_ */
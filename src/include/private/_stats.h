@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef PRIVATE__STATS_H_
+#define PRIVATE__STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stats.h"
+
+/**
+ * stats_result_t - Outcome of an instrumented call
+ */
+typedef enum {
+	STATS_RESULT_OK,
+	STATS_RESULT_ERROR,
+	STATS_RESULT_RETRY,
+} stats_result_t;
+
+/*
+ * The instrumentation is built with 'make CONFIG_STATS=1'. Otherwise the
+ * helpers below are empty and the compiler removes them from the callers.
+ */
+#ifdef LDX_STATS
+
+/**
+ * stats_begin() - Get the start time of an instrumented call
+ *
+ * Return: The CLOCK_MONOTONIC time in nanoseconds.
+ */
+static inline uint64_t stats_begin(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * stats_end() - Account an instrumented call
+ *
+ * @api:	The entry point.
+ * @start_ns:	Value returned by 'stats_begin()' for the call.
+ * @result:	Outcome of the call.
+ * @bytes:	Bytes moved by the call.
+ *
+ * Only the counters of the calling thread are updated, without locks.
+ * 'errno' is preserved.
+ */
+void stats_end(stats_api_t api, uint64_t start_ns, stats_result_t result,
+	       uint64_t bytes);
+
+#else
+
+static inline uint64_t stats_begin(void)
+{
+	return 0;
+}
+
+static inline void stats_end(stats_api_t api, uint64_t start_ns,
+			     stats_result_t result, uint64_t bytes)
+{
+}
+
+#endif /* LDX_STATS */
+
+/**
+ * stats_result() - Get the outcome of a call returning EXIT_SUCCESS/FAILURE
+ *
+ * @ret:	Value returned by the call.
+ *
+ * Return: The outcome, failures with errno set to EAGAIN are retries.
+ */
+static inline stats_result_t stats_result(int ret)
+{
+	if (ret == EXIT_SUCCESS)
+		return STATS_RESULT_OK;
+
+	return errno == EAGAIN ? STATS_RESULT_RETRY : STATS_RESULT_ERROR;
+}
+
+/**
+ * stats_result_ok() - Get the outcome of a call from its success
+ *
+ * @ok:		True if the call succeeded.
+ *
+ * Return: The outcome.
+ */
+static inline stats_result_t stats_result_ok(bool ok)
+{
+	return ok ? STATS_RESULT_OK : STATS_RESULT_ERROR;
+}
+
+/**
+ * stats_result_count() - Get the outcome of a call returning a count
+ *
+ * @ret:	Value returned by the call, negative on error.
+ *
+ * Return: The outcome.
+ */
+static inline stats_result_t stats_result_count(int ret)
+{
+	return stats_result_ok(ret >= 0);
+}
+
+/**
+ * stats_count() - Get the number of items moved by a call returning a count
+ *
+ * @ret:	Value returned by the call, negative on error.
+ *
+ * Return: The count, 0 on error.
+ */
+static inline uint64_t stats_count(int ret)
+{
+	return ret > 0 ? ret : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__STATS_H_ */
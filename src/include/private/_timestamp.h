@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef PRIVATE__TIMESTAMP_H_
+#define PRIVATE__TIMESTAMP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <time.h>
+
+#include "timestamp.h"
+
+static inline uint64_t timestamp_timespec_ns(const struct timespec *t)
+{
+	return (uint64_t)t->tv_sec * 1000000000ULL + t->tv_nsec;
+}
+
+/**
+ * timestamp_realtime_offset() - Get the offset between the wall and monotonic clocks
+ *
+ * Return: CLOCK_REALTIME minus CLOCK_MONOTONIC, in nanoseconds.
+ */
+int64_t timestamp_realtime_offset(void);
+
+/**
+ * timestamp_from_realtime() - Convert a CLOCK_REALTIME time with a known offset
+ *
+ * @ts:		Where to store the timestamp.
+ * @rt_ns:	The CLOCK_REALTIME time in nanoseconds.
+ * @offset:	Value of 'timestamp_realtime_offset()', so a whole batch of
+ *		times is converted with a single clock reading.
+ * @source:	Origin of the time.
+ */
+static inline void timestamp_from_realtime(ldx_timestamp_t *ts, uint64_t rt_ns,
+					   int64_t offset,
+					   ldx_timestamp_source_t source)
+{
+	int64_t ns = (int64_t)rt_ns - offset;
+
+	/* Times before boot can not be represented */
+	ts->ns = ns > 0 ? ns : 0;
+	ts->hw_ns = 0;
+	ts->source = source;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__TIMESTAMP_H_ */
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef PRIVATE__TRACE_H_
+#define PRIVATE__TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*
+ * Begin/end events of the peripheral hot paths, to correlate them with the
+ * kernel scheduling:
+ *
+ * - can_rx_begin/end:		Dispatch of a batch of received CAN frames.
+ * - gpio_irq_begin/end:	Dispatch of GPIO edges to the callback.
+ * - spi_begin/end:		SPI write, read and transfers.
+ * - i2c_begin/end:		I2C read, write and transfers.
+ *
+ * The 'length' of the begin events is the number of bytes, or the number of
+ * segments or messages for 'ldx_spi_transfer_batch()' and
+ * 'ldx_i2c_transfer_msgs()'. The I2C address of the latter is the one of
+ * the first message.
+ *
+ * The tracing backend is selected at build time:
+ *
+ * - 'make CONFIG_TRACE=lttng': LTTng-UST tracepoints of the 'digiapix'
+ *   provider, see '_trace_lttng.h'.
+ * - 'make CONFIG_TRACE=1': Lines written to the ftrace 'trace_marker' file,
+ *   for example "digiapix:spi_begin: op=ldx_spi_write device=0 slave=0
+ *   length=4". Skipped if the file cannot be opened when the library loads.
+ *
+ * Without CONFIG_TRACE the events are removed at build time.
+ */
+
+#if defined(LDX_TRACE_LTTNG)
+
+#include "_trace_lttng.h"
+
+#define trace_event(name, ...)	tracepoint(digiapix, name, __VA_ARGS__)
+
+#define trace_can_rx_begin(iface, nframes)				\
+	trace_event(can_rx_begin, iface, nframes)
+#define trace_can_rx_end(iface, nframes)				\
+	trace_event(can_rx_end, iface, nframes)
+#define trace_gpio_irq_begin(gpio, nevents)				\
+	trace_event(gpio_irq_begin, trace_gpio_chip(gpio),		\
+		    trace_gpio_line(gpio), trace_gpio_number(gpio), nevents)
+#define trace_gpio_irq_end(gpio, nevents)				\
+	trace_event(gpio_irq_end, trace_gpio_chip(gpio),		\
+		    trace_gpio_line(gpio), trace_gpio_number(gpio), nevents)
+#define trace_spi_begin(op, spi, length)				\
+	trace_event(spi_begin, op, trace_spi_device(spi),		\
+		    trace_spi_slave(spi), length)
+#define trace_spi_end(op, spi, ret)					\
+	trace_event(spi_end, op, trace_spi_device(spi),		\
+		    trace_spi_slave(spi), ret)
+#define trace_i2c_begin(op, i2c, address, length)			\
+	trace_event(i2c_begin, op, trace_i2c_bus(i2c), address, length)
+#define trace_i2c_end(op, i2c, address, ret)				\
+	trace_event(i2c_end, op, trace_i2c_bus(i2c), address, ret)
+
+#elif defined(LDX_TRACE)
+
+/* Descriptor of the ftrace 'trace_marker' file, -1 if not available */
+extern int trace_marker_fd;
+
+/**
+ * trace_marker_write() - Write an event to the 'trace_marker' file
+ *
+ * @format:	Event to write.
+ * @args:	Additional arguments.
+ */
+void trace_marker_write(const char *format, ...)
+	__attribute__ ((format (printf, 1, 2)));
+
+/**
+ * trace_marker() - Write an event if the 'trace_marker' file is available
+ *
+ * @format:	Event to write.
+ * @args:	Additional arguments.
+ *
+ * The arguments are not evaluated if the file is not available.
+ */
+#define trace_marker(format, ...)					\
+	do {								\
+		if (__atomic_load_n(&trace_marker_fd, __ATOMIC_RELAXED) >= 0) \
+			trace_marker_write("digiapix:" format, __VA_ARGS__); \
+	} while (0)
+
+#define trace_can_rx_begin(iface, nframes)				\
+	trace_marker("can_rx_begin: iface=%s nframes=%d", iface, nframes)
+#define trace_can_rx_end(iface, nframes)				\
+	trace_marker("can_rx_end: iface=%s nframes=%d", iface, nframes)
+#define trace_gpio_irq_begin(gpio, nevents)				\
+	trace_marker("gpio_irq_begin: chip=%s line=%d number=%d nevents=%d", \
+		     trace_gpio_chip(gpio), trace_gpio_line(gpio),		\
+		     trace_gpio_number(gpio), nevents)
+#define trace_gpio_irq_end(gpio, nevents)				\
+	trace_marker("gpio_irq_end: chip=%s line=%d number=%d nevents=%d", \
+		     trace_gpio_chip(gpio), trace_gpio_line(gpio),		\
+		     trace_gpio_number(gpio), nevents)
+#define trace_spi_begin(op, spi, length)				\
+	trace_marker("spi_begin: op=%s device=%d slave=%d length=%u", op, \
+		     trace_spi_device(spi), trace_spi_slave(spi), length)
+#define trace_spi_end(op, spi, ret)					\
+	trace_marker("spi_end: op=%s device=%d slave=%d ret=%d", op,	\
+		     trace_spi_device(spi), trace_spi_slave(spi), ret)
+#define trace_i2c_begin(op, i2c, address, length)			\
+	trace_marker("i2c_begin: op=%s bus=%d address=0x%x length=%u", op, \
+		     trace_i2c_bus(i2c), address, length)
+#define trace_i2c_end(op, i2c, address, ret)				\
+	trace_marker("i2c_end: op=%s bus=%d address=0x%x ret=%d", op,	\
+		     trace_i2c_bus(i2c), address, ret)
+
+#else
+
+#define trace_can_rx_begin(iface, nframes)		do { } while (0)
+#define trace_can_rx_end(iface, nframes)		do { } while (0)
+#define trace_gpio_irq_begin(gpio, nevents)		do { } while (0)
+#define trace_gpio_irq_end(gpio, nevents)		do { } while (0)
+#define trace_spi_begin(op, spi, length)		do { } while (0)
+#define trace_spi_end(op, spi, ret)			do { } while (0)
+#define trace_i2c_begin(op, i2c, address, length)	do { } while (0)
+#define trace_i2c_end(op, i2c, address, ret)		do { } while (0)
+
+#endif
+
+/*
+ * Identifiers of the handles, -1 if they are NULL. Sysfs GPIOs have no
+ * controller, so they are identified by their Linux ID number.
+ */
+#define trace_gpio_chip(gpio)						\
+	((gpio) != NULL && (gpio)->gpio_controller != NULL ?		\
+	 (gpio)->gpio_controller : "")
+#define trace_gpio_line(gpio)	((gpio) != NULL ? (int)(gpio)->gpio_line : -1)
+#define trace_gpio_number(gpio)						\
+	((gpio) != NULL ? (int)(gpio)->kernel_number : -1)
+#define trace_spi_device(spi)	((spi) != NULL ? (int)(spi)->spi_device : -1)
+#define trace_spi_slave(spi)	((spi) != NULL ? (int)(spi)->spi_slave : -1)
+#define trace_i2c_bus(i2c)	((i2c) != NULL ? (int)(i2c)->bus : -1)
+#define trace_i2c_msgs_address(msgs, n)					\
+	((msgs) != NULL && (n) > 0 ? (msgs)[0].address : 0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIVATE__TRACE_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/*
+ * LTTng-UST tracepoint provider of the library, used when it is built with
+ * 'make CONFIG_TRACE=lttng'. See '_trace.h' for the events.
+ */
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER digiapix
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "_trace_lttng.h"
+
+#if !defined(PRIVATE__TRACE_LTTNG_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define PRIVATE__TRACE_LTTNG_H_
+
+#include <lttng/tracepoint.h>
+
+TRACEPOINT_EVENT_CLASS(digiapix, can_rx,
+	TP_ARGS(const char *, iface, int, nframes),
+	TP_FIELDS(
+		ctf_string(iface, iface)
+		ctf_integer(int, nframes, nframes)
+	)
+)
+TRACEPOINT_EVENT_INSTANCE(digiapix, can_rx, can_rx_begin,
+	TP_ARGS(const char *, iface, int, nframes))
+TRACEPOINT_EVENT_INSTANCE(digiapix, can_rx, can_rx_end,
+	TP_ARGS(const char *, iface, int, nframes))
+
+TRACEPOINT_EVENT_CLASS(digiapix, gpio_irq,
+	TP_ARGS(const char *, chip, int, line, int, number, int, nevents),
+	TP_FIELDS(
+		ctf_string(chip, chip)
+		ctf_integer(int, line, line)
+		ctf_integer(int, number, number)
+		ctf_integer(int, nevents, nevents)
+	)
+)
+TRACEPOINT_EVENT_INSTANCE(digiapix, gpio_irq, gpio_irq_begin,
+	TP_ARGS(const char *, chip, int, line, int, number, int, nevents))
+TRACEPOINT_EVENT_INSTANCE(digiapix, gpio_irq, gpio_irq_end,
+	TP_ARGS(const char *, chip, int, line, int, number, int, nevents))
+
+TRACEPOINT_EVENT(digiapix, spi_begin,
+	TP_ARGS(const char *, op, int, device, int, slave, unsigned int, length),
+	TP_FIELDS(
+		ctf_string(op, op)
+		ctf_integer(int, device, device)
+		ctf_integer(int, slave, slave)
+		ctf_integer(unsigned int, length, length)
+	)
+)
+TRACEPOINT_EVENT(digiapix, spi_end,
+	TP_ARGS(const char *, op, int, device, int, slave, int, ret),
+	TP_FIELDS(
+		ctf_string(op, op)
+		ctf_integer(int, device, device)
+		ctf_integer(int, slave, slave)
+		ctf_integer(int, ret, ret)
+	)
+)
+
+TRACEPOINT_EVENT(digiapix, i2c_begin,
+	TP_ARGS(const char *, op, int, bus, unsigned int, address, unsigned int, length),
+	TP_FIELDS(
+		ctf_string(op, op)
+		ctf_integer(int, bus, bus)
+		ctf_integer_hex(unsigned int, address, address)
+		ctf_integer(unsigned int, length, length)
+	)
+)
+TRACEPOINT_EVENT(digiapix, i2c_end,
+	TP_ARGS(const char *, op, int, bus, unsigned int, address, int, ret),
+	TP_FIELDS(
+		ctf_string(op, op)
+		ctf_integer(int, bus, bus)
+		ctf_integer_hex(unsigned int, address, address)
+		ctf_integer(int, ret, ret)
+	)
+)
+
+#endif /* PRIVATE__TRACE_LTTNG_H_ */
+
+#include <lttng/tracepoint-event.h>
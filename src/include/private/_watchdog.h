@@ -21,13 +21,58 @@
 extern "C" {
 #endif
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "watchdog.h"
+
+/**
+ * wd_client_state_t - States of a supervisor client slot
+ */
+typedef enum {
+	WD_CLIENT_FREE,		/* Slot available */
+	WD_CLIENT_BUSY,		/* Slot being registered */
+	WD_CLIENT_ACTIVE,	/* Client registered */
+} wd_client_state_t;
+
+/**
+ * wd_client_t - Heartbeat slot of a supervisor client
+ *
+ * @state:		wd_client_state_t of the slot.
+ * @deadline_ns:	Maximum time between kicks in nanoseconds.
+ * @last_kick_ns:	Time of the last kick (CLOCK_MONOTONIC).
+ *
+ * The fields are accessed with atomic operations, clients never take a lock.
+ */
+typedef struct {
+	int state;
+	uint64_t deadline_ns;
+	uint64_t last_kick_ns;
+} wd_client_t;
+
 /**
  * wd_internal_t - Defined values for internal use
  *
- * @fd:		watchdog file descriptor.
+ * @fd:			watchdog file descriptor.
+ * @clients:		Heartbeat slots of the supervisor clients.
+ * @running:		True while the supervisor thread runs.
+ * @thread:		Supervisor thread.
+ * @timer_fd:		timerfd with the supervisor refresh period.
+ * @stop_fd:		eventfd to stop the supervisor thread.
+ * @pretimeout_fd:	eventfd signaled when the watchdog reaches the
+ *			pretimeout because a client is late.
+ * @late_clients:	Bitmask of the clients that missed their deadline.
  */
 typedef struct {
 	int fd;
+	wd_client_t clients[LDX_WATCHDOG_MAX_CLIENTS];
+	bool running;
+	pthread_t thread;
+	int timer_fd;
+	int stop_fd;
+	int pretimeout_fd;
+	uint64_t late_clients;
 } wd_internal_t;
 
 #ifdef __cplusplus
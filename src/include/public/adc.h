@@ -21,7 +21,12 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 #include "common.h"
+#include "timestamp.h"
 
 /**
  * Callback function type used as ADC interrupt handler
@@ -30,6 +35,20 @@ extern "C" {
  */
 typedef int (*ldx_adc_read_cb_t)(int sample, void *arg);
 
+/**
+ * Callback function type used as ADC scan group handler
+ *
+ * @samples:		Array with one sample of each ADC of the group, in the
+ *			order given to 'ldx_adc_group_create()'. Failed reads
+ *			are reported as -errno.
+ * @num_samples:	Number of samples in the array.
+ * @arg:		The argument given to 'ldx_adc_group_start_sampling()'.
+ *
+ * See 'ldx_adc_group_start_sampling()'.
+ */
+typedef int (*ldx_adc_group_cb_t)(int *samples, unsigned int num_samples,
+				  void *arg);
+
 /**
  * adc_t - Representation of a single requested ADC
  *
@@ -45,6 +64,92 @@ typedef struct {
 	void *_data;
 } adc_t;
 
+/**
+ * adc_scan_format_t - Format of an element in the scans of an ADC buffer
+ *
+ * @is_signed:		True if the sample is a signed value.
+ * @is_be:		True if the sample is stored in big endian.
+ * @realbits:		Number of valid bits of the sample.
+ * @storagebits:	Number of bits the sample takes in the scan.
+ * @shift:		Number of bits to shift right to get the sample.
+ * @offset:		Offset in bytes of the element inside the scan.
+ *
+ * This is the information the IIO subsystem reports in the
+ * 'scan_elements/<channel>_type' sysfs files.
+ */
+typedef struct {
+	bool is_signed;
+	bool is_be;
+	unsigned int realbits;
+	unsigned int storagebits;
+	unsigned int shift;
+	unsigned int offset;
+} adc_scan_format_t;
+
+/**
+ * adc_buffer_cfg_t - Configuration of a buffered ADC capture
+ *
+ * @frequency:		Sampling frequency in Hz, 0 to keep the current one.
+ * @buffer_len:		Number of scans the kernel buffer can hold, 0 to keep
+ *			the current length.
+ * @watermark:		Number of scans that must be available to wake up a
+ *			reader, 0 to keep the current value.
+ * @timestamp:		Add the capture timestamp at the end of each scan.
+ * @trigger:		Name of the IIO trigger to use, NULL to use the trigger
+ *			already attached to the device or to create a new
+ *			'hrtimer' trigger.
+ */
+typedef struct {
+	unsigned int frequency;
+	unsigned int buffer_len;
+	unsigned int watermark;
+	bool timestamp;
+	const char *trigger;
+} adc_buffer_cfg_t;
+
+/**
+ * adc_buffer_t - Representation of a buffered ADC capture
+ *
+ * @chip:		ADC chip being captured.
+ * @num_channels:	Number of channels in each scan.
+ * @scan_size:		Size in bytes of each scan.
+ * @_data:		Data for internal usage.
+ */
+typedef struct {
+	const unsigned int chip;
+	const unsigned int num_channels;
+	const unsigned int scan_size;
+	void *_data;
+} adc_buffer_t;
+
+/**
+ * adc_group_t - Representation of a group of ADCs sampled together
+ *
+ * @num_adcs:	Number of ADCs in the group.
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	const unsigned int num_adcs;
+	void *_data;
+} adc_group_t;
+
+/**
+ * adc_group_stats_t - Timing statistics of a sampling scan group
+ *
+ * @ticks:		Number of periods sampled.
+ * @missed:		Number of periods skipped because the previous one
+ *			(reads plus callback) took longer than the period.
+ * @max_latency_ns:	Maximum delay between a deadline and the start of
+ *			its reads, in nanoseconds.
+ * @last_latency_ns:	Delay of the last period, in nanoseconds.
+ */
+typedef struct {
+	uint64_t ticks;
+	uint64_t missed;
+	uint64_t max_latency_ns;
+	uint64_t last_latency_ns;
+} adc_group_stats_t;
+
 /**
  * ldx_adc_request() - Request an ADC to use
  *
@@ -110,6 +215,20 @@ int ldx_adc_free(adc_t *adc);
  */
 int ldx_adc_get_sample(adc_t *adc);
 
+/**
+ * ldx_adc_get_sample_ts() - Read the ADC sample with its timestamp
+ *
+ * @adc:	A requested ADC to read the sample.
+ * @ts:		Where to store the time of the sample.
+ *
+ * Same as 'ldx_adc_get_sample()'. The sysfs read does not report when the
+ * conversion happened, so the sample is stamped with the middle of the read
+ * (LDX_TIMESTAMP_SRC_SOFTWARE).
+ *
+ * Return: The ADC sample read, -1 on error.
+ */
+int ldx_adc_get_sample_ts(adc_t *adc, ldx_timestamp_t *ts);
+
 /**
  * ldx_adc_convert_sample_to_mv() - Convert the sample to mV
  *
@@ -120,6 +239,24 @@ int ldx_adc_get_sample(adc_t *adc);
  */
 float ldx_adc_convert_sample_to_mv(adc_t *adc, int sample);
 
+/**
+ * ldx_adc_convert_samples_to_mv() - Convert an array of samples to mV
+ *
+ * @adc:	A requested ADC whose scale is applied.
+ * @in:		Array with the samples to convert.
+ * @out:	Array of 'n' elements to store the values in mV. It can not
+ *		overlap 'in'.
+ * @n:		Number of samples to convert.
+ *
+ * Unlike 'ldx_adc_convert_sample_to_mv()', the scale is validated once for
+ * the whole array and negative results (from bipolar ADCs) are not treated
+ * as errors. On ARM targets with NEON the conversion is vectorized.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_convert_samples_to_mv(adc_t *adc, const int *in, float *out,
+				  size_t n);
+
 /**
  * ldx_adc_start_sampling() - Start sampling in the requested ADC
  *
@@ -172,6 +309,263 @@ int ldx_adc_stop_sampling(adc_t *adc);
  */
 int ldx_adc_set_scale(adc_t *adc, float scale);
 
+/**
+ * ldx_adc_group_create() - Create a group of ADCs to sample together
+ *
+ * @adcs:	Array with the requested ADCs of the group.
+ * @num_adcs:	Number of ADCs in the array.
+ *
+ * The ADCs must remain requested while the group exists and must be freed
+ * by the caller after 'ldx_adc_group_free()'.
+ *
+ * Memory for the group is obtained with 'malloc' and must be freed with
+ * 'ldx_adc_group_free()'.
+ *
+ * Return: A pointer to 'adc_group_t' on success, NULL on error.
+ */
+adc_group_t *ldx_adc_group_create(adc_t **adcs, unsigned int num_adcs);
+
+/**
+ * ldx_adc_group_free() - Free a group of ADCs
+ *
+ * @group:	The group to free.
+ *
+ * The sampling of the group is stopped if running. The ADCs of the group are
+ * not freed.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_free(adc_group_t *group);
+
+/**
+ * ldx_adc_group_get_samples() - Read one sample of every ADC of a group
+ *
+ * @group:	The group to read.
+ * @samples:	Array of 'num_adcs' elements to store the samples. Failed
+ *		reads are stored as -errno.
+ *
+ * Return: EXIT_SUCCESS if every ADC was read, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_get_samples(adc_group_t *group, int *samples);
+
+/**
+ * ldx_adc_group_start_sampling() - Start the periodic sampling of a group
+ *
+ * @group:	The group to sample.
+ * @read_cb:	Callback function to be called each period with the samples.
+ * @period_us:	Sampling period in microseconds.
+ * @arg:	Void casted pointer to pass to the callback as parameter.
+ *
+ * This function creates a new thread that reads every ADC of the group and
+ * executes the callback once per period. Periods are scheduled on absolute
+ * deadlines of the monotonic clock, so the time spent reading and in the
+ * callback does not accumulate as drift. If a period takes longer than
+ * 'period_us', the deadlines already passed are skipped and counted as
+ * missed, see 'ldx_adc_group_get_stats()'.
+ *
+ * To stop the sampling use 'ldx_adc_group_stop_sampling()'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_start_sampling(adc_group_t *group,
+				 const ldx_adc_group_cb_t read_cb,
+				 unsigned int period_us, void *arg);
+
+/**
+ * ldx_adc_group_stop_sampling() - Stop the periodic sampling of a group
+ *
+ * @group:	The group to stop.
+ *
+ * The sampling thread is stopped between periods, never in the middle of the
+ * callback. It must not be called from the callback.
+ *
+ * If the group is not sampling, this function does nothing and returns
+ * EXIT_SUCCESS.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_stop_sampling(adc_group_t *group);
+
+/**
+ * ldx_adc_group_get_stats() - Get the timing statistics of a group
+ *
+ * @group:	The group.
+ * @stats:	Where to store the statistics of the current (or last)
+ *		sampling.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_get_stats(adc_group_t *group, adc_group_stats_t *stats);
+
+/**
+ * ldx_adc_group_get_timestamp() - Get the time of the scan being processed
+ *
+ * @group:	The sampling group.
+ * @ts:		Where to store the time of the scan.
+ *
+ * Only valid from the callback given to 'ldx_adc_group_start_sampling()',
+ * for the samples it receives. The scan is stamped with the middle of the
+ * reads of the group (LDX_TIMESTAMP_SRC_SOFTWARE).
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_group_get_timestamp(adc_group_t *group, ldx_timestamp_t *ts);
+
+/**
+ * ldx_adc_buffer_set_defconfig() - Set the default buffered capture settings
+ *
+ * @cfg:	A pointer to the configuration to fill.
+ *
+ * The default configuration keeps the frequency, buffer length and watermark
+ * of the device, does not add timestamps and selects the trigger
+ * automatically.
+ */
+void ldx_adc_buffer_set_defconfig(adc_buffer_cfg_t *cfg);
+
+/**
+ * ldx_adc_buffer_start() - Start a buffered capture on an ADC chip
+ *
+ * @adc_chip:		The IIO ADC chip to capture.
+ * @channels:		Array with the ADC channels to capture.
+ * @num_channels:	Number of channels in the array.
+ * @cfg:		The capture configuration, NULL to use the default one.
+ *
+ * Instead of reading each sample from the sysfs, the channels are enabled in
+ * the IIO buffer of the chip and the driver fills it each time the trigger
+ * fires. Each entry of the buffer is a scan with one sample of every channel,
+ * in increasing order of their scan index, followed by the timestamp if
+ * enabled. Use 'ldx_adc_buffer_get_format()' to locate and decode them.
+ *
+ * When no trigger is given and the device does not have one attached, an
+ * 'hrtimer' trigger is created through configfs (requires
+ * CONFIG_IIO_HRTIMER_TRIGGER and configfs mounted in /sys/kernel/config) and
+ * removed when the capture is stopped. Devices without trigger support use
+ * their own 'sampling_frequency'.
+ *
+ * Only one capture can run on a chip at a time, and it excludes the rest of
+ * the channels of the chip from the buffer.
+ *
+ * Memory for the capture is obtained with 'malloc' and must be freed with
+ * 'ldx_adc_buffer_stop()'.
+ *
+ * Return: A pointer to 'adc_buffer_t' on success, NULL on error.
+ */
+adc_buffer_t *ldx_adc_buffer_start(unsigned int adc_chip,
+				   const unsigned int *channels,
+				   unsigned int num_channels,
+				   const adc_buffer_cfg_t *cfg);
+
+/**
+ * ldx_adc_buffer_read() - Read scans from a buffered capture
+ *
+ * @buffer:	The buffered capture to read from.
+ * @data:	Buffer to store the scans, at least 'nscans * scan_size' bytes.
+ * @nscans:	Maximum number of scans to read.
+ * @timeout:	Maximum number of milliseconds to wait for scans, 0 to return
+ *		immediately, -1 to block indefinitely.
+ *
+ * Scans are copied in binary form, as the driver stores them.
+ *
+ * Return: The number of scans read, 0 on timeout, -1 on error.
+ */
+int ldx_adc_buffer_read(adc_buffer_t *buffer, void *data, unsigned int nscans,
+			int timeout);
+
+/**
+ * ldx_adc_buffer_get_format() - Get the format of a channel in the scans
+ *
+ * @buffer:	The buffered capture.
+ * @index:	Index of the channel in the array given to
+ *		'ldx_adc_buffer_start()'.
+ * @format:	Where to store the format of the channel.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_buffer_get_format(adc_buffer_t *buffer, unsigned int index,
+			      adc_scan_format_t *format);
+
+/**
+ * ldx_adc_buffer_get_samples() - Extract the samples of a channel from scans
+ *
+ * @buffer:	The buffered capture.
+ * @index:	Index of the channel in the array given to
+ *		'ldx_adc_buffer_start()'.
+ * @scans:	Scans read with 'ldx_adc_buffer_read()'.
+ * @nscans:	Number of scans.
+ * @out:	Array of 'nscans' elements to store the samples.
+ *
+ * The raw samples are decoded according to the channel format: endianness,
+ * shift, valid bits and sign.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_buffer_get_samples(adc_buffer_t *buffer, unsigned int index,
+			       const void *scans, unsigned int nscans, int *out);
+
+/**
+ * ldx_adc_buffer_convert_to_mv() - Convert the samples of a channel to mV
+ *
+ * @buffer:	The buffered capture.
+ * @index:	Index of the channel in the array given to
+ *		'ldx_adc_buffer_start()'.
+ * @scans:	Scans read with 'ldx_adc_buffer_read()'.
+ * @nscans:	Number of scans.
+ * @out:	Array of 'nscans' elements to store the values in mV.
+ *
+ * This decodes the raw samples like 'ldx_adc_buffer_get_samples()' and
+ * applies the offset and scale the IIO driver reports for the channel, so a
+ * whole block of scans is converted with a single call.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_buffer_convert_to_mv(adc_buffer_t *buffer, unsigned int index,
+				 const void *scans, unsigned int nscans,
+				 float *out);
+
+/**
+ * ldx_adc_buffer_get_timestamp() - Get the timestamp of a scan
+ *
+ * @buffer:	The buffered capture.
+ * @scan:	Pointer to a scan read with 'ldx_adc_buffer_read()'.
+ *
+ * The time is in the clock of the IIO device, which
+ * 'ldx_adc_buffer_start()' sets to CLOCK_MONOTONIC when the kernel allows it.
+ *
+ * Return: The timestamp of the scan in nanoseconds, -1 if the capture has no
+ *	   timestamps.
+ */
+int64_t ldx_adc_buffer_get_timestamp(adc_buffer_t *buffer, const void *scan);
+
+/**
+ * ldx_adc_buffer_get_scan_timestamp() - Get the timestamp of a scan in the
+ *					  common time base
+ *
+ * @buffer:	The buffered capture.
+ * @scan:	Pointer to a scan read with 'ldx_adc_buffer_read()'.
+ * @ts:		Where to store the time of the scan.
+ *
+ * Like 'ldx_adc_buffer_get_timestamp()', but the time is converted to the
+ * CLOCK_MONOTONIC base of 'ldx_timestamp_t' if the device uses the wall
+ * clock.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE if the capture has no
+ *	   timestamps.
+ */
+int ldx_adc_buffer_get_scan_timestamp(adc_buffer_t *buffer, const void *scan,
+				      ldx_timestamp_t *ts);
+
+/**
+ * ldx_adc_buffer_stop() - Stop a buffered capture
+ *
+ * @buffer:	The buffered capture to stop.
+ *
+ * This function disables the buffer and the channels, detaches the trigger
+ * if it was created by 'ldx_adc_buffer_start()' and frees the capture.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_adc_buffer_stop(adc_buffer_t *buffer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,8 +25,11 @@ extern "C" {
 #include <linux/can/netlink.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "common.h"
+#include "reactor.h"
+#include "timestamp.h"
 
 #define NLMSG_TAIL(nmsg) \
         ((struct rtattr *)(((void *) (nmsg)) + NLMSG_ALIGN((nmsg)->nlmsg_len)))
@@ -39,12 +42,47 @@ extern "C" {
 #define LDX_CAN_UNCONFIGURED_FLAGS	0
 #define LDX_CAN_UNCONFIGURED_MASK	0
 
+/* Maximum number of frames moved per sendmmsg()/recvmmsg() call */
+#define LDX_CAN_BATCH_LEN		32
+
+/* Maximum number of frames of the rx queue, see 'rx_queue_len' */
+#define LDX_CAN_RX_QUEUE_MAX_LEN	(1u << 20)
+
+/* Capture files, see 'ldx_can_capture_start()' */
+#define LDX_CAN_CAPTURE_MAGIC		"LDXCANCP"
+#define LDX_CAN_CAPTURE_VERSION		2
+#define LDX_CAN_CAPTURE_HEADER_SIZE	4096
+#define LDX_CAN_CAPTURE_DEF_FILE_SIZE	(64 * 1024 * 1024)
+#define LDX_CAN_CAPTURE_MIN_FILE_SIZE	(64 * 1024)
+#define LDX_CAN_CAPTURE_DEF_FLUSH_MS	1000
+
+/* Flags of a capture file */
+#define LDX_CAN_CAPTURE_FLAG_FD		(1 << 0)	/* 64 data bytes per record */
+#define LDX_CAN_CAPTURE_FLAG_HW_TSTAMP	(1 << 1)	/* Raw hardware timestamps too */
+#define LDX_CAN_CAPTURE_FLAG_RING	(1 << 2)	/* Oldest records overwritten */
+
 /**
  * Callback functions
  */
 typedef void (*ldx_can_rx_cb_t)(struct canfd_frame *frame, struct timeval *tv);
+typedef void (*ldx_can_rx_batch_cb_t)(struct canfd_frame *frames, struct timeval *tv,
+				      int nframes);
 typedef void (*ldx_can_error_cb_t)(int error, void *data);
 
+/**
+ * Callback function type used as timestamped CAN frame handler
+ *
+ * @frames:	Received frames.
+ * @ts:		Timestamp of each frame, see 'ldx_timestamp_t'.
+ * @nframes:	Number of frames.
+ * @arg:	The argument given to 'ldx_can_register_rx_ts_handler()'.
+ *
+ * See 'ldx_can_register_rx_ts_handler()'.
+ */
+typedef void (*ldx_can_rx_ts_cb_t)(const struct canfd_frame *frames,
+				   const ldx_timestamp_t *ts,
+				   unsigned int nframes, void *arg);
+
 /**
  * can_if_cfg_t - CAN interface configuration type.
  *
@@ -52,6 +90,9 @@ typedef void (*ldx_can_error_cb_t)(int error, void *data);
  * @canfd_enabled:		Enable the flexible data rate.
  * @process_header:		Enable the processing of the frame headers.
  * @hw_timestamp:		Enable the hardware timestamp.
+ * @shared_rx_skt:		Serve all the rx handlers from one socket.
+ * @rx_queue_len:		Number of frames of the rx queue, 0 to disable it,
+ *				up to LDX_CAN_RX_QUEUE_MAX_LEN.
  * @rx_buf_len:			Length of the reception buffer.
  * @tx_buf_len:			Length of the transmission buffer.
  * @rx_buf_len_rd:		Length of the reception buffer socket.
@@ -67,6 +108,8 @@ typedef struct can_if_cfg {
 	bool			canfd_enabled;
 	bool			process_header;
 	bool			hw_timestamp;
+	bool			shared_rx_skt;
+	unsigned int		rx_queue_len;
 	int			rx_buf_len;
 	int			tx_buf_len;
 	int			rx_buf_len_rd;
@@ -80,6 +123,112 @@ typedef struct can_if_cfg {
 	struct can_ctrlmode	ctrl_mode;
 } can_if_cfg_t;
 
+/**
+ * can_rx_stats_t - Reception statistics of a rx handler
+ *
+ * @frames:		Number of frames delivered to the handler.
+ * @dropped:		Number of frames dropped because the socket receive
+ *			queue was full (SO_RXQ_OVFL). Only updated when
+ *			'process_header' is enabled.
+ * @reads:		Number of times frames were drained from the socket.
+ * @max_batch:		Largest number of frames drained at once. Reaching
+ *			LDX_CAN_BATCH_LEN means the queue is building up.
+ * @last_tstamp:	Timestamp of the last frame delivered to the handler.
+ * @overruns:		Number of frames lost because the rx queue was full.
+ *			Only used by the rx queue.
+ *
+ * For handlers on the shared rx socket, 'dropped', 'reads' and 'max_batch'
+ * refer to the shared socket.
+ */
+typedef struct can_rx_stats {
+	uint64_t		frames;
+	uint32_t		dropped;
+	uint64_t		reads;
+	unsigned int		max_batch;
+	struct timespec		last_tstamp;
+	uint64_t		overruns;
+} can_rx_stats_t;
+
+/**
+ * can_capture_opts_t - Options of a capture of received frames
+ *
+ * @file_size:		Size of each capture file in bytes, preallocated when
+ *			the file is created. 0 for LDX_CAN_CAPTURE_DEF_FILE_SIZE.
+ * @max_files:		Number of full files kept besides the active one. When
+ *			the active file is full it is renamed to '<path>.1',
+ *			the previous '<path>.1' to '<path>.2' and so on up to
+ *			'<path>.<max_files>', and the capture goes on in a
+ *			file preallocated in advance as '<path>.next'. 0 to
+ *			use a single file as a ring, overwriting the oldest
+ *			frames.
+ * @flush_ms:		Maximum time in milliseconds the captured frames stay
+ *			in memory before being written to the file. 0 for
+ *			LDX_CAN_CAPTURE_DEF_FLUSH_MS.
+ */
+typedef struct can_capture_opts {
+	size_t			file_size;
+	unsigned int		max_files;
+	unsigned int		flush_ms;
+} can_capture_opts_t;
+
+/**
+ * can_capture_header_t - Header at the beginning of a capture file
+ *
+ * @magic:		LDX_CAN_CAPTURE_MAGIC, not NULL terminated.
+ * @version:		LDX_CAN_CAPTURE_VERSION.
+ * @header_size:	Offset of the first record, LDX_CAN_CAPTURE_HEADER_SIZE.
+ * @record_size:	Size of each record, 32 bytes, or 88 bytes with
+ *			LDX_CAN_CAPTURE_FLAG_FD.
+ * @flags:		LDX_CAN_CAPTURE_FLAG_* flags.
+ * @capacity:		Number of records the file holds.
+ * @count:		Number of records written to the file. With
+ *			LDX_CAN_CAPTURE_FLAG_RING record 'n' is stored at
+ *			index 'n % capacity', and only the last 'capacity'
+ *			records are available.
+ * @start_ns:		CLOCK_REALTIME time the file was created, in
+ *			nanoseconds.
+ * @iface:		Name of the captured interface.
+ *
+ * All the fields are in host byte order. The file is a fixed size array of
+ * records after the header, so it can be mapped and read while it is
+ * being written: 'count' is updated after the records it covers.
+ */
+typedef struct can_capture_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		header_size;
+	uint32_t		record_size;
+	uint32_t		flags;
+	uint64_t		capacity;
+	uint64_t		count;
+	int64_t			start_ns;
+	char			iface[IFNAMSIZ];
+} can_capture_header_t;
+
+/**
+ * can_capture_record_t - Frame stored in a capture file
+ *
+ * @tstamp_ns:		CLOCK_REALTIME reception time in nanoseconds.
+ * @hw_tstamp_ns:	Raw hardware reception time in nanoseconds, in the
+ *			time base of the controller, with
+ *			LDX_CAN_CAPTURE_FLAG_HW_TSTAMP. 0 if the controller
+ *			did not stamp the frame.
+ * @can_id:		'can_id' of the frame, with the EFF/RTR/ERR flags.
+ * @len:		Data length of the frame.
+ * @flags:		CAN FD flags of the frame.
+ * @reserved:		Set to 0.
+ * @data:		Frame data, 8 bytes or 64 with LDX_CAN_CAPTURE_FLAG_FD.
+ */
+typedef struct can_capture_record {
+	uint64_t		tstamp_ns;
+	uint64_t		hw_tstamp_ns;
+	uint32_t		can_id;
+	uint8_t			len;
+	uint8_t			flags;
+	uint8_t			reserved[2];
+	uint8_t			data[];
+} can_capture_record_t;
+
 typedef struct can_if {
 	char			name[IFNAMSIZ];
 	can_if_cfg_t		cfg;
@@ -153,6 +302,30 @@ enum {
 	CAN_ERROR_ERR_CB_NOT_FOUND,
 	CAN_ERROR_ERR_CB_ALR_REG,
 
+	/* Event loop */
+	CAN_ERROR_EPOLL_CREATE,
+	CAN_ERROR_EPOLL_CTL,
+	CAN_ERROR_EVENTFD_CREATE,
+	CAN_ERROR_REACTOR_ADD,
+
+	/* Shared rx socket */
+	CAN_ERROR_RX_CB_MAX,
+
+	/* Rx queue */
+	CAN_ERROR_RX_QUEUE_DISABLED,
+	CAN_ERROR_RX_QUEUE_WAIT,
+	CAN_ERROR_RX_QUEUE_LEN,
+
+	/* Capture */
+	CAN_ERROR_CAPTURE_RUNNING,
+	CAN_ERROR_CAPTURE_DISABLED,
+	CAN_ERROR_CAPTURE_FILE,
+	CAN_ERROR_CAPTURE_FORMAT,
+
+	/* Arguments */
+	CAN_ERROR_NULL_FRAME,
+	CAN_ERROR_INVALID_NFRAMES,
+
 	__CAN_ERR_LAST
 };
 
@@ -291,6 +464,8 @@ int ldx_can_free(can_if_t *cif);
  *    * canfd_enabled: Disabled
  *    * process_header: Enabled
  *    * hw_timestamp: Disabled
+ *    * shared_rx_skt: Disabled
+ *    * rx_queue_len: 0 (rx queue disabled)
  *    * error_mask: CAN_ERR_TX_TIMEOUT | CAN_ERR_CRTL | CAN_ERR_BUSOFF |
  *    			    CAN_ERR_BUSERROR | CAN_ERR_RESTARTED;
  */
@@ -307,6 +482,21 @@ void ldx_can_set_defconfig(can_if_cfg_t *cfg);
  */
 int ldx_can_init(can_if_t *cif, can_if_cfg_t *cfg);
 
+/**
+ * ldx_can_set_reactor() - Serve the CAN interface from a shared reactor
+ *
+ * @cif:	A pointer to the requested CAN to configure.
+ * @reactor:	The reactor that will process the interface events.
+ *
+ * By default, 'ldx_can_init()' creates a working thread for every
+ * interface. When a reactor is set, no thread is created and the frames
+ * and errors of the interface are processed by the threads running
+ * 'ldx_reactor_run()'. It must be called before 'ldx_can_init()'.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_set_reactor(can_if_t *cif, reactor_t *reactor);
+
 /**
  * ldx_can_set_bitrate() - Set the bitrate in the CAN interface
  *
@@ -367,6 +557,25 @@ int ldx_can_start(const can_if_t *cif);
  */
 int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame);
 
+/**
+ * ldx_can_tx_frames() - Send several frames through the CAN interface
+ *
+ * @cif:	A pointer to the requested CAN to send the frames.
+ * @frames:	Array of frames to send (struct canfd_frame).
+ * @nframes:	Number of frames in the array.
+ *
+ * This function queues the frames in the interface using one 'sendmmsg()'
+ * call for every LDX_CAN_BATCH_LEN frames. Frames are sent in order. If the
+ * transmission queue fills up, the function stops and returns the number of
+ * frames already queued, so the caller can retry the rest later.
+ *
+ * Return: The number of frames sent, -CAN_ERROR_TX_RETRY_LATER if no frame
+ *         could be queued, -CAN_ERROR_NULL_FRAME if 'frames' is NULL,
+ *         -CAN_ERROR_INVALID_NFRAMES if 'nframes' is negative, error code
+ *         otherwise.
+ */
+int ldx_can_tx_frames(const can_if_t *cif, struct canfd_frame *frames, int nframes);
+
 /**
  * ldx_can_register_rx_handler() - Start frame reception on the given CAN
  *
@@ -380,6 +589,11 @@ int ldx_can_tx_frame(const can_if_t *cif, struct canfd_frame *frame);
  * executed when a frame is received. After that it continues waiting for
  * new frames.
  *
+ * By default each handler gets its own socket. With 'shared_rx_skt' enabled
+ * in the interface configuration, up to 64 handlers share a single socket:
+ * the kernel applies the merged filters of all of them and each frame is
+ * delivered to the handlers whose filters accept it.
+ *
  * To stop listening for interrupts use 'ldx_can_unregister_rx_handler()'.
  *
  * Return: CAN_ERR_NONE on success, error code otherwise.
@@ -400,6 +614,221 @@ int ldx_can_register_rx_handler(can_if_t *cif, const ldx_can_rx_cb_t cb,
  */
 int ldx_can_unregister_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb);
 
+/**
+ * ldx_can_register_rx_batch_handler() - Start batched frame reception on the
+ *					  given CAN
+ *
+ * @cif:	A pointer to the requested CAN to start the reception.
+ * @cb:		Callback to execute each time a batch of frames is received.
+ * @filters:	A set of filters to filter the reception of frames.
+ * @nfilters:	The number of filters contained in the filters variable.
+ *
+ * This function is equivalent to 'ldx_can_register_rx_handler()', but the
+ * socket is drained with 'recvmmsg()' and the callback receives up to
+ * LDX_CAN_BATCH_LEN frames per call, together with an array of timestamps
+ * (one per frame). The arrays belong to the library and are only valid during
+ * the callback.
+ *
+ * To stop listening for frames use 'ldx_can_unregister_rx_batch_handler()'.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_register_rx_batch_handler(can_if_t *cif, const ldx_can_rx_batch_cb_t cb,
+				      struct can_filter *filters, int nfilters);
+
+/**
+ * ldx_can_unregister_rx_batch_handler() - Remove the batched frame reception
+ *					    on the given CAN
+ *
+ * @cif:	A pointer to a requested CAN to stop a frame reception handler.
+ * @cb:		Callback to be removed.
+ *
+ * This function stops the previously set handler on a CAN using
+ * 'ldx_can_register_rx_batch_handler()'.
+ *
+ * Return: EXIT_SUCCESS on success, error code otherwise.
+ */
+int ldx_can_unregister_rx_batch_handler(const can_if_t *cif,
+					const ldx_can_rx_batch_cb_t cb);
+
+/**
+ * ldx_can_register_rx_ts_handler() - Start timestamped frame reception on the
+ *				       given CAN
+ *
+ * @cif:	A pointer to the requested CAN to start the reception.
+ * @cb:		Callback to execute each time a batch of frames is received.
+ * @arg:	Void casted pointer to pass to the callback as parameter.
+ * @filters:	A set of filters to filter the reception of frames.
+ * @nfilters:	The number of filters contained in the filters variable.
+ *
+ * This function is equivalent to 'ldx_can_register_rx_batch_handler()', but
+ * each frame comes with an 'ldx_timestamp_t', in the CLOCK_MONOTONIC time
+ * base shared with the GPIO events and ADC samples. The kernel time of
+ * reception is used when 'process_header' is enabled, together with the raw
+ * hardware timestamp if 'hw_timestamp' is also enabled and the controller
+ * supports it. Otherwise frames are stamped when the library reads them.
+ *
+ * The handler always gets its own socket, even if 'shared_rx_skt' is set.
+ * The same callback can be registered several times with different
+ * arguments.
+ *
+ * To stop listening for frames use 'ldx_can_unregister_rx_ts_handler()'.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_register_rx_ts_handler(can_if_t *cif, const ldx_can_rx_ts_cb_t cb,
+				   void *arg, struct can_filter *filters,
+				   int nfilters);
+
+/**
+ * ldx_can_unregister_rx_ts_handler() - Remove the timestamped frame reception
+ *					 on the given CAN
+ *
+ * @cif:	A pointer to a requested CAN to stop a frame reception handler.
+ * @cb:		Callback to be removed.
+ * @arg:	The argument it was registered with.
+ *
+ * This function stops the previously set handler on a CAN using
+ * 'ldx_can_register_rx_ts_handler()'.
+ *
+ * Return: EXIT_SUCCESS on success, error code otherwise.
+ */
+int ldx_can_unregister_rx_ts_handler(const can_if_t *cif,
+				     const ldx_can_rx_ts_cb_t cb, void *arg);
+
+/**
+ * ldx_can_get_rx_stats() - Get the reception statistics of a rx handler
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @cb:		The callback registered with 'ldx_can_register_rx_handler()'.
+ * @stats:	Where to store the statistics.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_get_rx_stats(const can_if_t *cif, const ldx_can_rx_cb_t cb,
+			 can_rx_stats_t *stats);
+
+/**
+ * ldx_can_get_rx_batch_stats() - Get the reception statistics of a batch handler
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @cb:		The callback registered with 'ldx_can_register_rx_batch_handler()'.
+ * @stats:	Where to store the statistics.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_get_rx_batch_stats(const can_if_t *cif, const ldx_can_rx_batch_cb_t cb,
+			       can_rx_stats_t *stats);
+
+/**
+ * ldx_can_rx_pop() - Take a frame from the rx queue of the given CAN
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @frame:	Where to store the frame.
+ * @tv:		Where to store the frame timestamp, may be NULL.
+ * @timeout_ms:	Milliseconds to wait for a frame when the queue is empty, 0
+ *		to return immediately and -1 to wait indefinitely.
+ *
+ * When 'rx_queue_len' is set in the interface configuration, the working
+ * thread stores every received frame in a lock-free queue allocated by
+ * 'ldx_can_init()'. Frames are then consumed from the application thread
+ * with this function or 'ldx_can_rx_pop_batch()', keeping the processing
+ * out of the reception path. Only one thread may consume from the queue.
+ * Frames received while the queue is full are dropped, see
+ * 'ldx_can_get_rx_queue_stats()'.
+ *
+ * Return: 1 if a frame was taken, 0 on timeout, error code otherwise.
+ */
+int ldx_can_rx_pop(const can_if_t *cif, struct canfd_frame *frame,
+		   struct timeval *tv, int timeout_ms);
+
+/**
+ * ldx_can_rx_pop_batch() - Take several frames from the rx queue of the given CAN
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @frames:	Where to store the frames.
+ * @tv:		Where to store the frame timestamps, may be NULL.
+ * @nframes:	Maximum number of frames to take.
+ * @timeout_ms:	Milliseconds to wait for frames when the queue is empty, 0
+ *		to return immediately and -1 to wait indefinitely.
+ *
+ * See 'ldx_can_rx_pop()'.
+ *
+ * Return: The number of frames taken, 0 on timeout, error code otherwise.
+ */
+int ldx_can_rx_pop_batch(const can_if_t *cif, struct canfd_frame *frames,
+			 struct timeval *tv, int nframes, int timeout_ms);
+
+/**
+ * ldx_can_get_rx_queue_stats() - Get the reception statistics of the rx queue
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @stats:	Where to store the statistics.
+ *
+ * Return: CAN_ERR_NONE on success, error code otherwise.
+ */
+int ldx_can_get_rx_queue_stats(const can_if_t *cif, can_rx_stats_t *stats);
+
+/**
+ * ldx_can_capture_start() - Capture every received frame of the given CAN to files
+ *
+ * @cif:	A pointer to the initialized CAN.
+ * @path:	Path of the active capture file, created or replaced.
+ * @opts:	Capture options, NULL for the defaults.
+ *
+ * The working thread drains a dedicated rx socket without filters in
+ * batches and copies the frames and their timestamps to a preallocated
+ * memory-mapped file, with no system call per frame. Dirty pages are
+ * written back at least every 'flush_ms' and when the capture stops.
+ * See 'can_capture_header_t' for the file format, and
+ * 'ldx_can_capture_export_pcapng()' to convert it.
+ *
+ * The kernel reception time is stored when 'process_header' is enabled,
+ * and also the raw hardware one when 'hw_timestamp' is enabled. Without 'process_header' the frames of a batch share the
+ * time they were drained.
+ *
+ * Return: CAN_ERROR_NONE on success, error code otherwise.
+ */
+int ldx_can_capture_start(can_if_t *cif, const char *path,
+			  const can_capture_opts_t *opts);
+
+/**
+ * ldx_can_capture_stop() - Stop the capture of the given CAN
+ *
+ * @cif:	A pointer to the requested CAN.
+ *
+ * Writes the captured frames back to the file and closes it. Also done
+ * by 'ldx_can_free()'.
+ *
+ * Return: CAN_ERROR_NONE on success, error code otherwise.
+ */
+int ldx_can_capture_stop(can_if_t *cif);
+
+/**
+ * ldx_can_get_capture_stats() - Get the reception statistics of the capture
+ *
+ * @cif:	A pointer to the requested CAN.
+ * @stats:	Where to store the statistics. 'overruns' counts the frames
+ *		lost because the next capture file was not ready.
+ *
+ * Return: CAN_ERROR_NONE on success, error code otherwise.
+ */
+int ldx_can_get_capture_stats(const can_if_t *cif, can_rx_stats_t *stats);
+
+/**
+ * ldx_can_capture_export_pcapng() - Convert a capture file to PCAP-NG
+ *
+ * @capture_path:	A file written by 'ldx_can_capture_start()'.
+ * @pcapng_path:	PCAP-NG file to create, with LINKTYPE_CAN_SOCKETCAN
+ *			packets and nanosecond timestamps.
+ *
+ * The frames are exported from the oldest to the newest. The capture file
+ * may still be being written.
+ *
+ * Return: CAN_ERROR_NONE on success, error code otherwise.
+ */
+int ldx_can_capture_export_pcapng(const char *capture_path, const char *pcapng_path);
+
 /**
  * ldx_can_register_error_handler() - Start an error handler on the given CAN
  *
@@ -409,7 +838,7 @@ int ldx_can_unregister_rx_handler(const can_if_t *cif, const ldx_can_rx_cb_t cb)
  * This function waits for errors on the CAN interface asynchronously.
  * It is a non-blocking function that registers the provided callback to be
  * executed when an error happens in the interface. After that it continues waiting for
- * new errors.
+ * new errors. The callback can register and remove handlers of the CAN.
  *
  * To stop listening for errors use 'ldx_can_unregister_error_handler()'.
  *
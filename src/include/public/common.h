@@ -39,9 +39,28 @@ extern "C" {
  * ldx_set_log_level() - Set the new log level
  *
  * @level:	New log level.
+ *
+ * Messages of the library with a lower priority are discarded before their
+ * arguments are formatted. Use this function instead of 'setlogmask()' to
+ * change the level of the library messages: the library keeps a copy of
+ * the mask, which is refreshed from 'setlogmask(0)' on every call. A mask
+ * set with 'setlogmask()' that enables more priorities only applies to the
+ * library messages after the next call to this function (or to
+ * 'ldx_refresh_log_mask()').
+ *
+ * Return: The previous log mask.
+ */
+int ldx_set_log_level(int level);
+
+/**
+ * ldx_refresh_log_mask() - Refresh the library copy of the log mask
+ *
+ * Call it after changing the mask with 'setlogmask()' so the library
+ * messages follow the new mask.
+ *
+ * Return: The current log mask.
  */
-#define ldx_set_log_level(level)			\
-	setlogmask(LOG_UPTO(level))
+int ldx_refresh_log_mask(void);
 
 /**
  * request_mode_t - Defined values for high/low GPIO level
@@ -57,6 +76,27 @@ typedef enum {
 			 */
 } request_mode_t;
 
+/**
+ * bus_prio_t - Priority classes of the I2C and SPI bus transactions
+ *
+ * Transactions of handles requested for the same bus are served by priority
+ * class and in arrival order within a class. To avoid starvation, a waiting
+ * lower class is served after LDX_BUS_SCHED_BATCH consecutive transactions
+ * of higher classes.
+ */
+typedef enum {
+	BUS_PRIO_HIGH,		/* Latency critical transactions (control) */
+	BUS_PRIO_NORMAL,	/* Default priority */
+	BUS_PRIO_LOW,		/* Bulk transactions (logging) */
+	BUS_PRIO_COUNT
+} bus_prio_t;
+
+/**
+ * LDX_BUS_SCHED_BATCH - Transactions of higher classes that a waiting lower
+ * priority class yields to before it is served
+ */
+#define LDX_BUS_SCHED_BATCH	8
+
 /**
  * platform_t - Defined Digi platforms
  */
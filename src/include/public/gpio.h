@@ -21,13 +21,32 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "common.h"
+#include "reactor.h"
+#include "timestamp.h"
 
 /**
  * MAX_CONTROLLER_LEN - Maximum length for controller strings.
  */
 #define MAX_CONTROLLER_LEN 30
 
+/**
+ * LDX_GPIO_EVENT_CB_MAX - Maximum number of events passed to an events callback.
+ */
+#define LDX_GPIO_EVENT_CB_MAX 64
+
+/**
+ * LDX_GPIO_BANK_MAX_LINES - Maximum number of lines of a GPIO bank.
+ */
+#define LDX_GPIO_BANK_MAX_LINES 64
+
+/**
+ * LDX_GPIO_EVENT_RING_MAX_LEN - Maximum number of events of an event stream ring.
+ */
+#define LDX_GPIO_EVENT_RING_MAX_LEN (1u << 20)
+
 /**
  * gpio_mode_t - Defined values for GPIO mode.
  */
@@ -78,6 +97,27 @@ typedef enum {
 	GPIO_IRQ_ERROR_TIMEOUT,
 } gpio_irq_error_t;
 
+/**
+ * gpio_event_edge_t - Defined values for the edge of a GPIO event
+ */
+typedef enum {
+	GPIO_EVENT_RISING_EDGE,
+	GPIO_EVENT_FALLING_EDGE,
+} gpio_event_edge_t;
+
+/**
+ * gpio_event_t - Edge event captured by the kernel on a GPIO
+ *
+ * @timestamp_ns:	CLOCK_MONOTONIC time of the edge in nanoseconds, as
+ *			reported by the kernel. This is the time base of
+ *			'ldx_timestamp_t', see 'ldx_gpio_event_get_timestamp()'.
+ * @edge:		The edge that triggered the event (gpio_event_edge_t).
+ */
+typedef struct {
+	uint64_t timestamp_ns;
+	gpio_event_edge_t edge;
+} gpio_event_t;
+
 /**
  * gpio_t - Representation of a single requested GPIO
  *
@@ -93,6 +133,22 @@ typedef struct {
 	void *_data;
 } gpio_t;
 
+/**
+ * gpio_bank_t - Representation of a group of GPIOs of the same controller
+ *
+ * @gpio_controller:	Controller of the GPIOs
+ * @gpio_lines:		Line number of each GPIO, bit N of the values of the
+ *			bank corresponds to gpio_lines[N]
+ * @num_lines:		Number of GPIOs in the bank
+ * @_data:		Data for internal usage
+ */
+typedef struct {
+	const char * const gpio_controller;
+	const unsigned int * const gpio_lines;
+	const unsigned int num_lines;
+	void *_data;
+} gpio_bank_t;
+
 /**
  * Callback function type used as GPIO interrupt handler
  *
@@ -100,6 +156,19 @@ typedef struct {
  */
 typedef int (*ldx_gpio_interrupt_cb_t)(void *arg);
 
+/**
+ * Callback function type used as GPIO event stream handler
+ *
+ * @gpio:	The GPIO the events belong to.
+ * @events:	The events, oldest first.
+ * @nevents:	Number of events, up to LDX_GPIO_EVENT_CB_MAX.
+ * @arg:	The argument given to 'ldx_gpio_start_event_stream()'.
+ *
+ * See 'ldx_gpio_start_event_stream()'.
+ */
+typedef void (*ldx_gpio_events_cb_t)(gpio_t *gpio, gpio_event_t *events,
+				     unsigned int nevents, void *arg);
+
 /**
  * ldx_gpio_request() - Request a GPIO to use
  *
@@ -146,6 +215,25 @@ gpio_t *ldx_gpio_request_by_alias(const char * const gpio_alias, gpio_mode_t mod
 gpio_t *ldx_gpio_request_by_controller(const char * const controller,
 				       const unsigned char line, gpio_mode_t mode);
 
+/**
+ * ldx_gpio_request_fast() - Request a GPIO by its Linux ID number using the fastest path
+ *
+ * @kernel_number:	The Linux ID number of the GPIO to request.
+ * @mode:		The desired GPIO working mode (gpio_mode_t).
+ *
+ * When the GPIO number belongs to a controller exposed by the kernel, the
+ * GPIO is requested through its character device as
+ * 'ldx_gpio_request_by_controller()' does, so it does not pay the cost of
+ * the sysfs files on each access. Otherwise it is requested through sysfs
+ * with REQUEST_SHARED mode.
+ *
+ * This function returns a gpio_t pointer. Memory for the struct is obtained
+ * with 'malloc' and must be freed with 'ldx_gpio_free()'.
+ *
+ * Return: A pointer to gpio_t on success, NULL on error.
+ */
+gpio_t *ldx_gpio_request_fast(unsigned int kernel_number, gpio_mode_t mode);
+
 /**
  * ldx_gpio_get_kernel_number() - Retrieve the GPIO Linux ID number of a given alias
  *
@@ -359,6 +447,184 @@ int ldx_gpio_start_wait_interrupt(gpio_t *gpio, const ldx_gpio_interrupt_cb_t in
  */
 int ldx_gpio_stop_wait_interrupt(gpio_t *gpio);
 
+/**
+ * ldx_gpio_read_events() - Read the edge events of the given GPIO
+ *
+ * @gpio:	A requested GPIO configured as GPIO_IRQ_EDGE_RISING,
+ *		GPIO_IRQ_EDGE_FALLING, or GPIO_IRQ_EDGE_BOTH.
+ * @events:	Array to store the events.
+ * @max:	Maximum number of events to read.
+ * @timeout:	The maximum number of milliseconds to wait for the first event,
+ *		-1 for blocking indefinitely.
+ *
+ * This function blocks until at least one event is available and then
+ * returns every queued event, up to 'max', with the kernel timestamp of each
+ * edge. Events are read in batches, so fast pulse trains do not cost a
+ * system call per edge.
+ *
+ * Only GPIOs requested through libgpiod (see
+ * 'ldx_gpio_request_by_controller()') provide event timestamps.
+ *
+ * If an event stream without callback is running on the GPIO (see
+ * 'ldx_gpio_start_event_stream()'), the events are taken from its ring.
+ *
+ * Return: The number of events read, 0 on timeout, -1 on error.
+ */
+int ldx_gpio_read_events(gpio_t *gpio, gpio_event_t *events, unsigned int max,
+			 int timeout);
+
+/**
+ * ldx_gpio_event_get_timestamp() - Get the timestamp of an edge event
+ *
+ * @event:	An event read with 'ldx_gpio_read_events()' or received by an
+ *		event stream callback.
+ * @ts:		Where to store the timestamp.
+ *
+ * The timestamp can be compared with those of the CAN frames and ADC
+ * samples.
+ */
+void ldx_gpio_event_get_timestamp(const gpio_event_t *event, ldx_timestamp_t *ts);
+
+/**
+ * ldx_gpio_start_event_stream() - Start delivering the edge events of a GPIO
+ *
+ * @gpio:	A requested GPIO configured as GPIO_IRQ_EDGE_RISING,
+ *		GPIO_IRQ_EDGE_FALLING, or GPIO_IRQ_EDGE_BOTH.
+ * @ring_len:	Number of events the internal ring can hold, up to
+ *		LDX_GPIO_EVENT_RING_MAX_LEN. It is rounded up to a power of two.
+ * @events_cb:	Callback function called with batches of events, NULL to
+ *		keep the events in the ring until they are read with
+ *		'ldx_gpio_read_events()'.
+ * @arg:	Void casted pointer to pass to the callback as parameter.
+ *
+ * A thread drains the kernel event queue of the GPIO into a ring as soon as
+ * edges arrive, and a second thread passes the events of the ring to the
+ * callback in batches. A slow callback does not make the kernel drop edges
+ * until the ring is full; lost events can be checked with
+ * 'ldx_gpio_get_lost_events()'.
+ *
+ * Without callback, only the reader thread runs and the application drains
+ * the ring with 'ldx_gpio_read_events()' at its own pace, for example from
+ * an interpreter that can not afford to run code on each batch.
+ *
+ * Only GPIOs requested through libgpiod provide event timestamps. The
+ * stream can not be used together with 'ldx_gpio_start_wait_interrupt()'.
+ *
+ * To stop the stream use 'ldx_gpio_stop_event_stream()'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_start_event_stream(gpio_t *gpio, unsigned int ring_len,
+				const ldx_gpio_events_cb_t events_cb, void *arg);
+
+/**
+ * ldx_gpio_stop_event_stream() - Stop delivering the edge events of a GPIO
+ *
+ * @gpio:	A pointer to a requested GPIO with an event stream.
+ *
+ * This function waits for the callback to return, so it must not be called
+ * from the callback itself. Threads blocked in 'ldx_gpio_read_events()' on
+ * the ring of the stream are woken up and return the events left, or 0.
+ *
+ * If no event stream is running on the GPIO, this function does nothing and
+ * returns EXIT_SUCCESS.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_stop_event_stream(gpio_t *gpio);
+
+/**
+ * ldx_gpio_get_lost_events() - Get the events dropped by an event stream
+ *
+ * @gpio:	A pointer to a requested GPIO with an event stream.
+ * @lost:	Where to store the number of events dropped because the ring
+ *		was full.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_get_lost_events(gpio_t *gpio, uint64_t *lost);
+
+/**
+ * ldx_gpio_set_reactor() - Serve the GPIO interrupts from a shared reactor
+ *
+ * @gpio:	A requested GPIO to configure.
+ * @reactor:	The reactor that will wait for the GPIO interrupts, NULL to
+ *		go back to a dedicated thread.
+ *
+ * By default, 'ldx_gpio_start_wait_interrupt()' creates a thread for every
+ * GPIO. When a reactor is set, the interrupt descriptor is added to it
+ * instead and the handler runs in the threads running 'ldx_reactor_run()'.
+ * It must be called while no interrupt handler is registered on the GPIO.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_set_reactor(gpio_t *gpio, reactor_t *reactor);
+
+/**
+ * ldx_gpio_bank_request() - Request several GPIOs of a controller using libgpiod
+ *
+ * @controller:	The controller name of the GPIOs to request.
+ * @lines:	The line numbers of the GPIOs to request.
+ * @num_lines:	Number of lines, up to LDX_GPIO_BANK_MAX_LINES.
+ * @mode:	The desired working mode: GPIO_INPUT, GPIO_OUTPUT_LOW or
+ *		GPIO_OUTPUT_HIGH.
+ *
+ * The lines of a bank are read and written at once, with a single ioctl,
+ * so all of them change at the same time. This is useful to drive parallel
+ * buses or to scan keypad matrices.
+ *
+ * This function returns a gpio_bank_t pointer. Memory for the struct is
+ * obtained with 'malloc' and must be freed with 'ldx_gpio_bank_free()'.
+ *
+ * Return: A pointer to gpio_bank_t on success, NULL on error.
+ */
+gpio_bank_t *ldx_gpio_bank_request(const char * const controller,
+				   const unsigned int * const lines,
+				   const unsigned int num_lines, gpio_mode_t mode);
+
+/**
+ * ldx_gpio_bank_free() - Free a previously requested GPIO bank
+ *
+ * @bank:	A pointer to the requested GPIO bank to free.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_bank_free(gpio_bank_t *bank);
+
+/**
+ * ldx_gpio_bank_set_mode() - Change the working mode of all the GPIOs of a bank
+ *
+ * @bank:	A requested GPIO bank to set its working mode.
+ * @mode:	Working mode to configure: GPIO_INPUT, GPIO_OUTPUT_LOW or
+ *		GPIO_OUTPUT_HIGH.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_bank_set_mode(gpio_bank_t *bank, gpio_mode_t mode);
+
+/**
+ * ldx_gpio_bank_set_values() - Set the value of the GPIOs of a bank
+ *
+ * @bank:	A requested GPIO bank configured as output.
+ * @mask:	Bitmask of the GPIOs to change, the rest keep their value.
+ * @values:	Bitmask with the new GPIO values, bit N is the value of
+ *		'gpio_lines[N]'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_bank_set_values(gpio_bank_t *bank, uint64_t mask, uint64_t values);
+
+/**
+ * ldx_gpio_bank_get_values() - Get the value of the GPIOs of a bank
+ *
+ * @bank:	A requested GPIO bank.
+ * @values:	Where to store the bitmask with the GPIO values, bit N is the
+ *		value of 'gpio_lines[N]'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_gpio_bank_get_values(gpio_bank_t *bank, uint64_t *values);
+
 #ifdef __cplusplus
 }
 #endif
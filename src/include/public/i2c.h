@@ -21,8 +21,35 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "common.h"
 
+/**
+ * LDX_I2C_MAX_MSGS - Maximum number of messages of a combined I2C transfer
+ */
+#define LDX_I2C_MAX_MSGS	42
+
+/* Flags of the I2C messages */
+#define LDX_I2C_MSG_READ	0x0001	/* Read data from the slave */
+#define LDX_I2C_MSG_TEN		0x0010	/* Ten bit slave address */
+#define LDX_I2C_MSG_NOSTART	0x4000	/* Do not send a (repeated) START */
+
+/**
+ * i2c_msg_t - Representation of a message of a combined I2C transfer
+ *
+ * @address:	Address of the I2C slave device.
+ * @flags:	Message flags (LDX_I2C_MSG_READ, ...), 0 to write.
+ * @length:	Number of bytes to read or write.
+ * @buffer:	Data to write, or buffer to store the read data.
+ */
+typedef struct {
+	uint16_t address;
+	uint16_t flags;
+	uint16_t length;
+	uint8_t *buffer;
+} i2c_msg_t;
+
 /**
  * i2c_t - Representation of a single requested I2C
  *
@@ -36,6 +63,23 @@ typedef struct {
 	void *_data;
 } i2c_t;
 
+/**
+ * i2c_regmap_t - Register map of an I2C slave device
+ *
+ * @i2c:	The I2C bus of the device.
+ * @address:	Address of the I2C slave device.
+ * @reg_bits:	Width of the register addresses in bits (8 or 16).
+ * @val_bits:	Width of the register values in bits (8, 16 or 32).
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	i2c_t * const i2c;
+	const unsigned int address;
+	const unsigned int reg_bits;
+	const unsigned int val_bits;
+	void *_data;
+} i2c_regmap_t;
+
 /**
  * ldx_i2c_request() - Request a I2C bus to use
  *
@@ -161,13 +205,203 @@ int ldx_i2c_write(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer, uint16_
  * @r_length:		Length of the data that should be read over the I2C bus.
  *
  * This function transfers data to and from a I2C device connected to the
- * requested I2C bus.
+ * requested I2C bus. The write and the read are done in a single bus
+ * transaction, with a repeated START and no STOP between them.
  *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
 int ldx_i2c_transfer(i2c_t *i2c, unsigned int i2c_address, uint8_t *buffer_to_write,
 		uint16_t w_length, uint8_t *buffer_to_read, uint16_t r_length);
 
+/**
+ * ldx_i2c_transfer_msgs() - Run several I2C messages as one transaction
+ *
+ * @i2c:	A requested I2C bus to transfer to/from.
+ * @msgs:	Array of messages to transfer, in order.
+ * @n:		Number of messages, up to LDX_I2C_MAX_MSGS.
+ *
+ * The messages are submitted to the kernel with a single I2C_RDWR system call
+ * and separated by repeated STARTs, with a STOP only after the last one. The
+ * messages can address different slave devices, so the registers of several
+ * devices can be read in one call.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_transfer_msgs(i2c_t *i2c, i2c_msg_t *msgs, unsigned int n);
+
+/**
+ * ldx_i2c_set_priority() - Set the priority class of the transactions of a I2C
+ *
+ * @i2c:	A requested I2C.
+ * @prio:	The priority class, BUS_PRIO_NORMAL by default.
+ *
+ * Transactions of all the handles requested for the same bus are
+ * serialized and served by priority class. See 'bus_prio_t'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_set_priority(i2c_t *i2c, bus_prio_t prio);
+
+/**
+ * ldx_i2c_lock_bus() - Reserve the bus of a I2C for several transactions
+ *
+ * @i2c:	A requested I2C.
+ *
+ * Waits for the turn of the handle and keeps the bus until
+ * 'ldx_i2c_unlock_bus()' is called, so a sequence of transactions is not
+ * interleaved with those of other handles. Transactions of the same thread
+ * are still allowed while the bus is locked.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_lock_bus(i2c_t *i2c);
+
+/**
+ * ldx_i2c_unlock_bus() - Release the bus reserved with 'ldx_i2c_lock_bus()'
+ *
+ * @i2c:	A requested I2C.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_unlock_bus(i2c_t *i2c);
+
+/**
+ * ldx_i2c_regmap_create() - Create a register map for an I2C slave device
+ *
+ * @i2c:	A requested I2C bus the device is connected to.
+ * @address:	Address of the I2C slave device.
+ * @reg_bits:	Width of the register addresses in bits (8 or 16).
+ * @val_bits:	Width of the register values in bits (8, 16 or 32).
+ *
+ * Register addresses and values are transferred in big endian, most
+ * significant byte first. Reads of consecutive registers are coalesced in
+ * bursts, so the device must auto-increment the register address.
+ *
+ * All the registers are volatile (read from the device every time) until
+ * they are declared cacheable with 'ldx_i2c_regmap_set_cacheable()'.
+ *
+ * A map can be used from several threads. Handles of the same bus that
+ * access the device without the map are not seen by its cache.
+ *
+ * Memory for the register map is obtained with 'malloc' and must be freed
+ * with 'ldx_i2c_regmap_free()'. The I2C bus must remain requested while the
+ * map exists.
+ *
+ * Return: A pointer to i2c_regmap_t on success, NULL on error.
+ */
+i2c_regmap_t *ldx_i2c_regmap_create(i2c_t *i2c, unsigned int address,
+				    unsigned int reg_bits, unsigned int val_bits);
+
+/**
+ * ldx_i2c_regmap_free() - Free a register map
+ *
+ * @map:	The register map to free.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_free(i2c_regmap_t *map);
+
+/**
+ * ldx_i2c_regmap_set_cacheable() - Declare a range of registers cacheable
+ *
+ * @map:	The register map.
+ * @first:	First register of the range.
+ * @last:	Last register of the range.
+ *
+ * Cacheable registers are only changed by the host, such as configuration
+ * registers. They are read from the device once and then served from the
+ * cache, and writes go to the device and to the cache (write-through).
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_set_cacheable(i2c_regmap_t *map, unsigned int first,
+				 unsigned int last);
+
+/**
+ * ldx_i2c_regmap_cache_drop() - Invalidate the cached register values
+ *
+ * @map:	The register map.
+ *
+ * Use it after the device is reset, so the next reads go to the device.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_cache_drop(i2c_regmap_t *map);
+
+/**
+ * ldx_i2c_regmap_read() - Read a register
+ *
+ * @map:	The register map.
+ * @reg:	The register to read.
+ * @val:	Where to store the value.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_read(i2c_regmap_t *map, unsigned int reg, uint32_t *val);
+
+/**
+ * ldx_i2c_regmap_bulk_read() - Read consecutive registers
+ *
+ * @map:	The register map.
+ * @reg:	The first register to read.
+ * @vals:	Array of 'count' elements to store the values.
+ * @count:	Number of registers to read.
+ *
+ * Cached registers are not read from the device, and the rest are read in as
+ * few bursts as possible, of up to 8192 bytes each. The last register must
+ * fit in the register address width of the map.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_bulk_read(i2c_regmap_t *map, unsigned int reg,
+			     uint32_t *vals, unsigned int count);
+
+/**
+ * ldx_i2c_regmap_read_multi() - Read a list of registers
+ *
+ * @map:	The register map.
+ * @regs:	Array with the registers to read, in any order.
+ * @vals:	Array of 'count' elements to store the values, in the order of
+ *		'regs'.
+ * @count:	Number of registers to read.
+ *
+ * Registers not in the cache are sorted and the adjacent ones are read in
+ * bursts. All the bursts are submitted in a single combined transfer (as
+ * long as they fit in LDX_I2C_MAX_MSGS messages).
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_read_multi(i2c_regmap_t *map, const unsigned int *regs,
+			      uint32_t *vals, unsigned int count);
+
+/**
+ * ldx_i2c_regmap_write() - Write a register
+ *
+ * @map:	The register map.
+ * @reg:	The register to write.
+ * @val:	The value to write.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_write(i2c_regmap_t *map, unsigned int reg, uint32_t val);
+
+/**
+ * ldx_i2c_regmap_update_bits() - Update some bits of a register
+ *
+ * @map:	The register map.
+ * @reg:	The register to update.
+ * @mask:	Bits to update.
+ * @val:	New value of the bits in 'mask'.
+ *
+ * The read and the write are done with the bus locked, see
+ * 'ldx_i2c_lock_bus()', so the update is atomic for the users of the bus.
+ * The register is only written if its value changes.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_i2c_regmap_update_bits(i2c_regmap_t *map, unsigned int reg,
+			       uint32_t mask, uint32_t val);
+
 #ifdef __cplusplus
 }
 #endif
@@ -144,6 +144,96 @@ typedef struct {
 	uint32_t rx_nohandler;
 } net_stats_t;
 
+/**
+ * net_stats64_t - Representation of 64-bit network statistics
+ *
+ * Same counters as 'net_stats_t', see its description.
+ */
+typedef struct {
+	uint64_t rx_packets;
+	uint64_t tx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_bytes;
+	uint64_t rx_errors;
+	uint64_t tx_errors;
+	uint64_t rx_dropped;
+	uint64_t tx_dropped;
+	uint64_t multicast;
+	uint64_t collisions;
+
+	/* Detailed rx_errors: */
+	uint64_t rx_length_errors;
+	uint64_t rx_over_errors;
+	uint64_t rx_crc_errors;
+	uint64_t rx_frame_errors;
+	uint64_t rx_fifo_errors;
+	uint64_t rx_missed_errors;
+
+	/* Detailed tx_errors */
+	uint64_t tx_aborted_errors;
+	uint64_t tx_carrier_errors;
+	uint64_t tx_fifo_errors;
+	uint64_t tx_heartbeat_errors;
+	uint64_t tx_window_errors;
+
+	/* For cslip etc */
+	uint64_t rx_compressed;
+	uint64_t tx_compressed;
+
+	uint64_t rx_nohandler;
+} net_stats64_t;
+
+/**
+ * net_iface_stats_t - Statistics of a network interface in a snapshot
+ *
+ * @name:		Interface name.
+ * @index:		Interface index.
+ * @stats:		Interface statistics.
+ */
+typedef struct {
+	char name[IFNAMSIZ];
+	int index;
+	net_stats64_t stats;
+} net_iface_stats_t;
+
+/**
+ * net_stats_snapshot_t - Statistics of all the network interfaces
+ *
+ * @n_ifaces:		Number of interfaces in 'ifaces'.
+ * @timestamp_ns:	Time the snapshot was taken, in nanoseconds of the
+ *			monotonic clock.
+ * @ifaces:		Array of interface statistics.
+ * @_data:		Data for internal usage.
+ *
+ * Must be zeroed before its first use and released with
+ * 'ldx_net_free_stats_snapshot()'.
+ */
+typedef struct {
+	unsigned int n_ifaces;
+	uint64_t timestamp_ns;
+	net_iface_stats_t *ifaces;
+	void *_data;
+} net_stats_snapshot_t;
+
+/**
+ * net_stats_rate_t - Evolution of the statistics of an interface
+ *
+ * @interval_ns:	Time between the two snapshots, in nanoseconds.
+ * @delta:		Increment of each counter.
+ * @rx_bytes_rate:	Received bytes per second.
+ * @tx_bytes_rate:	Transmitted bytes per second.
+ * @rx_packets_rate:	Received packets per second.
+ * @tx_packets_rate:	Transmitted packets per second.
+ */
+typedef struct {
+	uint64_t interval_ns;
+	net_stats64_t delta;
+	double rx_bytes_rate;
+	double tx_bytes_rate;
+	double rx_packets_rate;
+	double tx_packets_rate;
+} net_stats_rate_t;
+
 /**
  * net_state_t - Representation of a network interface state
  *
@@ -174,6 +264,37 @@ typedef struct {
 	uint8_t dns2[IPV4_GROUPS];
 } net_state_t;
 
+/**
+ * net_change_t - Kinds of changes of a network interface state
+ *
+ * @NET_CHANGE_NEW:	The interface appeared.
+ * @NET_CHANGE_REMOVED:	The interface disappeared.
+ * @NET_CHANGE_LINK:	Name, status, MAC or MTU changed.
+ * @NET_CHANGE_ADDR:	IP, network mask, broadcast or DHCP changed.
+ * @NET_CHANGE_ROUTE:	Gateway changed.
+ * @NET_CHANGE_DNS:	DNS servers changed.
+ */
+typedef enum {
+	NET_CHANGE_NEW = 1 << 0,
+	NET_CHANGE_REMOVED = 1 << 1,
+	NET_CHANGE_LINK = 1 << 2,
+	NET_CHANGE_ADDR = 1 << 3,
+	NET_CHANGE_ROUTE = 1 << 4,
+	NET_CHANGE_DNS = 1 << 5,
+} net_change_t;
+
+/**
+ * Callback function type used to notify network interface changes
+ *
+ * @net_state:	The new state of the interface.
+ * @changes:	Bitmask of what changed (net_change_t).
+ * @arg:	The argument given to 'ldx_net_register_change_cb()'.
+ *
+ * See 'ldx_net_register_change_cb()'.
+ */
+typedef void (*ldx_net_change_cb_t)(const net_state_t *net_state,
+				    unsigned int changes, void *arg);
+
 /**
  * net_config_t - Network configuration
  *
@@ -235,6 +356,14 @@ int ldx_net_list_available_ifaces(net_names_list_t *iface_list);
  * @iface_name:		Network interface name.
  * @net_state_t:	Struct to fill with the network interface state.
  *
+ * The link, address and route data are read from rtnetlink. The DNS
+ * servers are those systemd-resolved, systemd-networkd or NetworkManager
+ * (over D-Bus, only if it is running and the library is built with
+ * 'make CONFIG_NM_DBUS=1') assign to the interface. Nothing is forked. When
+ * none of them knows the interface, the global servers of the resolver
+ * configuration are reported, and NET_STATE_ERROR_DNS is returned only if
+ * there are no servers at all.
+ *
  * Return: NET_STATE_ERROR_NONE on success, any other error code otherwise.
  */
 net_state_error_t ldx_net_get_iface_state(const char *iface_name, net_state_t *net_state);
@@ -249,6 +378,94 @@ net_state_error_t ldx_net_get_iface_state(const char *iface_name, net_state_t *n
  */
 net_state_error_t ldx_net_get_iface_stats(const char *iface_name, net_stats_t *net_stats);
 
+/**
+ * ldx_net_get_all_stats() - Get the statistics of every network interface
+ *
+ * @snapshot:	Snapshot to fill, zeroed before its first use.
+ *
+ * All the statistics are taken from a single rtnetlink dump with the 64-bit
+ * counters. The snapshot keeps its socket and array from one call to the
+ * next, so refreshing a snapshot does not allocate memory unless the number
+ * of interfaces grows. To compute rates, keep two snapshots and alternate
+ * them.
+ *
+ * Return: NET_STATE_ERROR_NONE on success, any other error code otherwise.
+ */
+net_state_error_t ldx_net_get_all_stats(net_stats_snapshot_t *snapshot);
+
+/**
+ * ldx_net_free_stats_snapshot() - Release the resources of a snapshot
+ *
+ * @snapshot:	The snapshot to release.
+ *
+ * The snapshot is zeroed and can be used again.
+ */
+void ldx_net_free_stats_snapshot(net_stats_snapshot_t *snapshot);
+
+/**
+ * ldx_net_get_stats_rate() - Compute the evolution of an interface statistics
+ *
+ * @prev:	The older snapshot.
+ * @cur:	The newer snapshot.
+ * @index:	Position of the interface in the 'ifaces' array of 'cur'.
+ * @rate:	Struct to fill with the increments and rates.
+ *
+ * The interface is looked up in 'prev' by its interface index. Counters
+ * that went backwards (the interface was reset) count from zero.
+ *
+ * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_NO_EXIST if the
+ *	   interface is not in 'prev', NET_STATE_ERROR_STATS otherwise.
+ */
+net_state_error_t ldx_net_get_stats_rate(const net_stats_snapshot_t *prev,
+					 const net_stats_snapshot_t *cur,
+					 unsigned int index, net_stats_rate_t *rate);
+
+/**
+ * ldx_net_register_change_cb() - Register a function to call on network changes
+ *
+ * @cb:		Function to call when the state of an interface changes.
+ * @arg:	Argument to pass to the callback.
+ *
+ * The first registration starts a monitor thread that subscribes to the link,
+ * IPv4 address and IPv4 route notifications of rtnetlink and keeps the state
+ * of every interface in memory, updated incrementally from the notifications.
+ * The callbacks run in that thread, only when the state of an interface
+ * really changes. The DNS servers are refreshed when the link, the address
+ * or the gateway of an interface changes.
+ *
+ * Callbacks must not register or unregister callbacks.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_net_register_change_cb(ldx_net_change_cb_t cb, void *arg);
+
+/**
+ * ldx_net_unregister_change_cb() - Unregister a network change callback
+ *
+ * @cb:		The registered function.
+ * @arg:	The argument it was registered with.
+ *
+ * Unregistering the last callback stops the monitor thread.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_net_unregister_change_cb(ldx_net_change_cb_t cb, void *arg);
+
+/**
+ * ldx_net_get_cached_state() - Get the state of an interface from the monitor
+ *
+ * @iface_name:		Network interface name.
+ * @net_state:		Struct to fill with the network interface state.
+ *
+ * While a change callback is registered the state is copied from memory,
+ * otherwise it is read like 'ldx_net_get_iface_state()' does. It is also
+ * read that way if the monitor thread stopped on an error; the next
+ * 'ldx_net_register_change_cb()' restarts it.
+ *
+ * Return: NET_STATE_ERROR_NONE on success, any other error code otherwise.
+ */
+net_state_error_t ldx_net_get_cached_state(const char *iface_name, net_state_t *net_state);
+
 /*
  * ldx_net_set_config() - Configure the given network interface
  *
@@ -21,9 +21,32 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <unistd.h>
 #include <sys/types.h>
 
+/**
+ * LDX_PROCESS_LINES - Pass the output to the callback line by line
+ */
+#define LDX_PROCESS_LINES	(1 << 0)
+
+/**
+ * LDX_PROCESS_STDERR - Pass the error output to the callback too
+ */
+#define LDX_PROCESS_STDERR	(1 << 1)
+
+/**
+ * Callback function type used to receive the output of a process
+ *
+ * @data:	The output. With LDX_PROCESS_LINES it is a NULL terminated
+ *		line without the line feed.
+ * @len:	Number of bytes in 'data'.
+ * @arg:	The argument given to 'ldx_process_spawn()'.
+ *
+ * Return: 0 to keep reading, any other value to stop the process.
+ */
+typedef int (*ldx_process_output_cb_t)(const char *data, size_t len, void *arg);
+
 /**
  * ldx_process_execute_cmd() - Execute the provided command and gets the response.
  *
@@ -64,6 +87,34 @@ pid_t _ldx_process_exec_fd(int infd, int outfd, int errfd, const char *cmd, ...)
  */
 #define ldx_process_exec_fd(tout, ...) _ldx_process_exec_fd(tout, __VA_ARGS__, NULL)
 
+/**
+ * ldx_process_spawn() - Execute a command and stream its output
+ *
+ * @argv:	NULL terminated list with the command and its arguments. The
+ *		command is searched in the PATH, no shell is involved.
+ * @cb:		Callback to pass the output to as it arrives, NULL to discard
+ *		the output.
+ * @arg:	Argument to pass to the callback.
+ * @flags:	LDX_PROCESS_LINES to receive the output line by line instead
+ *		of in chunks, LDX_PROCESS_STDERR to receive the error output
+ *		too (discarded otherwise).
+ * @timeout:	Number of seconds to wait for the command execution, 0 for
+ *		no limit.
+ *
+ * The process is started with 'posix_spawn()', so unlike
+ * 'ldx_process_execute_cmd()' the address space of the caller is not
+ * duplicated and no '/bin/sh' is run in between.
+ *
+ * The process is killed with SIGKILL if it does not finish in time, and
+ * with SIGTERM if the callback asks to stop.
+ *
+ * Return: The exit value of the process, the negative number of the signal
+ *	   that terminates the process, or a value lower than -255 if the
+ *	   process cannot be started or waited for.
+ */
+int ldx_process_spawn(char *const argv[], const ldx_process_output_cb_t cb,
+		      void *arg, int flags, int timeout);
+
 /**
  * ldx_process_wait() - Waits for the provided pid.
  *
@@ -50,6 +50,21 @@ typedef enum {
 	PWM_CONFIG_ERROR_INVALID,
 } pwm_config_error_t;
 
+/**
+ * pwm_state_t - Complete configuration of a PWM signal
+ *
+ * @period:		Period of the signal in ns.
+ * @duty_cycle:		Active time of the signal in ns.
+ * @polarity:		Polarity of the signal.
+ * @enabled:		Whether the signal is output.
+ */
+typedef struct {
+	unsigned int period;
+	unsigned int duty_cycle;
+	pwm_polarity_t polarity;
+	pwm_enabled_t enabled;
+} pwm_state_t;
+
 /**
  * pwm_t - Representation of a single requested PWM
  *
@@ -65,6 +80,20 @@ typedef struct {
 	void *_data;
 } pwm_t;
 
+/**
+ * pwm_group_t - Representation of a group of PWMs of the same chip updated
+ *		 together
+ *
+ * @chip:	PWM chip of the PWMs of the group.
+ * @num_pwms:	Number of PWMs in the group.
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	const unsigned int chip;
+	const unsigned int num_pwms;
+	void *_data;
+} pwm_group_t;
+
 /**
  * ldx_pwm_request() - Request a PWM to use
  *
@@ -206,7 +235,8 @@ int ldx_pwm_get_period(pwm_t *pwm);
 pwm_config_error_t ldx_pwm_set_duty_cycle_percentage(pwm_t *pwm, unsigned int percentage);
 
 /**
- * ldx_pwm_get_duty_percentage() - Get the duty cycle percentage of a PWM signal
+ * ldx_pwm_get_duty_cycle_percentage() - Get the duty cycle percentage of a
+ *					 PWM signal
  *
  * @pwm:	A requested PWM to get the duty cycle.
  *
@@ -296,6 +326,83 @@ int ldx_pwm_enable(pwm_t *pwm, pwm_enabled_t enabled);
  */
 pwm_enabled_t ldx_pwm_is_enabled(pwm_t *pwm);
 
+/**
+ * ldx_pwm_apply() - Change the whole configuration of a PWM at once
+ *
+ * @pwm:	A requested PWM.
+ * @state:	The new configuration of the PWM.
+ *
+ * Only the attributes that differ from the last state written to the PWM
+ * are written, in an order that keeps every intermediate configuration
+ * valid: the duty cycle never exceeds the period, the PWM is disabled to
+ * change the polarity, and it is enabled only once fully configured.
+ *
+ * The state is cached in the PWM, so no sysfs reads are needed except the
+ * first time the state of the PWM is required.
+ *
+ * Return: PWM_CONFIG_ERROR_NONE on success, PWM_CONFIG_ERROR_INVALID if the
+ *	   state is not valid, PWM_CONFIG_ERROR otherwise.
+ */
+pwm_config_error_t ldx_pwm_apply(pwm_t *pwm, const pwm_state_t *state);
+
+/**
+ * ldx_pwm_get_state() - Get the whole configuration of a PWM
+ *
+ * @pwm:	A requested PWM.
+ * @state:	Where to store the configuration of the PWM.
+ *
+ * The configuration is read from sysfs only the first time, afterwards the
+ * last state written through this PWM is returned.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_pwm_get_state(pwm_t *pwm, pwm_state_t *state);
+
+/**
+ * ldx_pwm_group_create() - Create a group of PWMs to update together
+ *
+ * @pwms:	Array with the requested PWMs of the group, all of them of the
+ *		same chip.
+ * @num_pwms:	Number of PWMs in the array.
+ *
+ * The PWMs must remain requested while the group exists and must be freed
+ * by the caller after 'ldx_pwm_group_free()'.
+ *
+ * Memory for the group is obtained with 'malloc' and must be freed with
+ * 'ldx_pwm_group_free()'.
+ *
+ * Return: A pointer to 'pwm_group_t' on success, NULL on error.
+ */
+pwm_group_t *ldx_pwm_group_create(pwm_t **pwms, unsigned int num_pwms);
+
+/**
+ * ldx_pwm_group_free() - Free a PWM group
+ *
+ * @group:	The group to free.
+ *
+ * The PWMs of the group are not freed.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_pwm_group_free(pwm_group_t *group);
+
+/**
+ * ldx_pwm_group_set_duty_cycles() - Set the duty cycle of every PWM of a group
+ *
+ * @group:	The PWM group.
+ * @duty_ns:	Array with the new duty cycle (in ns) of each PWM, in the order
+ *		given to 'ldx_pwm_group_create()'.
+ *
+ * Every value is validated against the cached period of its PWM and
+ * formatted before the first write, and then all of them are written back
+ * to back, to keep the skew between the channels as small as possible.
+ *
+ * Return: PWM_CONFIG_ERROR_NONE on success, PWM_CONFIG_ERROR_INVALID if any
+ *	   duty cycle is longer than its period, PWM_CONFIG_ERROR otherwise.
+ */
+pwm_config_error_t ldx_pwm_group_set_duty_cycles(pwm_group_t *group,
+						 const unsigned int *duty_ns);
+
 #ifdef __cplusplus
 }
 #endif
@@ -69,6 +69,73 @@ typedef struct {
 	size_t len;
 } available_frequencies_t;
 
+/**
+ * cpu_policy_profile_t - Configuration of a cpufreq policy in a profile
+ *
+ * @policy:	The cpufreq policy (see 'ldx_cpu_list_policies()').
+ * @governor:	The governor to set, GOVERNOR_INVALID to keep the current one.
+ * @min_freq:	The min scaling frequency, -1 to keep the current one.
+ * @max_freq:	The max scaling frequency, -1 to keep the current one.
+ */
+typedef struct {
+	int policy;
+	governor_mode_t governor;
+	int min_freq;
+	int max_freq;
+} cpu_policy_profile_t;
+
+/**
+ * cpu_profile_t - CPU power profile
+ *
+ * @n_policies:		Number of entries in 'policies'.
+ * @policies:		Configuration of each cpufreq policy to change.
+ * @n_cores:		Number of entries in 'cores_online'.
+ * @cores_online:	Status of each core, indexed by core: 1 to enable it,
+ *			0 to disable it, -1 to keep the current status.
+ *
+ * See 'ldx_cpu_apply_profile()'.
+ */
+typedef struct {
+	size_t n_policies;
+	const cpu_policy_profile_t *policies;
+	size_t n_cores;
+	const int *cores_online;
+} cpu_profile_t;
+
+/**
+ * cpu_sample_t - CPU telemetry sample
+ *
+ * @timestamp_ns:	Time of the sample in nanoseconds (CLOCK_MONOTONIC).
+ * @usage:		Usage of all the cores in %, -1 if unknown.
+ * @n_cores:		Number of entries in 'core_usage'.
+ * @core_usage:		Usage of each core in %, -1 if unknown, for example
+ *			while the core is offline.
+ * @temp:		CPU temperature in mºC, -1 if unknown.
+ * @freq:		Current CPU frequency in KHz, -1 if unknown.
+ *
+ * The usage is measured between the sample and the previous one (or the
+ * creation of the sampler for the first one).
+ */
+typedef struct {
+	uint64_t timestamp_ns;
+	int usage;
+	int n_cores;
+	const int *core_usage;
+	int temp;
+	int freq;
+} cpu_sample_t;
+
+/**
+ * cpu_sampler_t - Representation of a CPU telemetry sampler
+ *
+ * @n_cores:	Number of CPU cores.
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	const int n_cores;
+	void *_data;
+} cpu_sampler_t;
+
 /**
  * ldx_cpu_get_number_of_cores() - Get the number of CPU cores
  *
@@ -227,6 +294,157 @@ int ldx_cpu_set_governor (governor_mode_t governor);
  */
 governor_mode_t ldx_cpu_get_governor();
 
+/**
+ * ldx_cpu_list_policies() - Get the cpufreq policies of the CPU
+ *
+ * @policies:	Pointer to store the array with the indexes of the policies,
+ *		sorted in ascending order.
+ *
+ * Each cpufreq policy controls the frequency of a group of cores sharing
+ * the same clock (a cluster). Functions without a policy argument work on
+ * policy 0.
+ *
+ * Memory for the array is obtained with 'malloc' and must be freed.
+ *
+ * Return: The number of policies, -1 on error.
+ */
+int ldx_cpu_list_policies(int **policies);
+
+/**
+ * ldx_cpu_policy_get_available_freq() - Get available frequencies of a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * See 'ldx_cpu_get_available_freq()'.
+ *
+ * Return: An available_frequencies_t struct, with 'len' 0 on error.
+ */
+available_frequencies_t ldx_cpu_policy_get_available_freq(int policy);
+
+/**
+ * ldx_cpu_policy_get_max_freq() - Get the max frequency supported by a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The maximum frequency on success, -1 otherwise.
+ */
+int ldx_cpu_policy_get_max_freq(int policy);
+
+/**
+ * ldx_cpu_policy_get_min_freq() - Get the min frequency supported by a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The minimum frequency on success, -1 otherwise.
+ */
+int ldx_cpu_policy_get_min_freq(int policy);
+
+/**
+ * ldx_cpu_policy_get_max_scaling_freq() - Get the max scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The maximum scaling frequency on success, -1 otherwise.
+ */
+int ldx_cpu_policy_get_max_scaling_freq(int policy);
+
+/**
+ * ldx_cpu_policy_get_min_scaling_freq() - Get the min scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The minimum scaling frequency on success, -1 otherwise.
+ */
+int ldx_cpu_policy_get_min_scaling_freq(int policy);
+
+/**
+ * ldx_cpu_policy_set_min_scaling_freq() - Set the min scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @freq:	The frequency to set.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_policy_set_min_scaling_freq(int policy, int freq);
+
+/**
+ * ldx_cpu_policy_set_max_scaling_freq() - Set the max scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @freq:	The frequency to set.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_policy_set_max_scaling_freq(int policy, int freq);
+
+/**
+ * ldx_cpu_policy_get_scaling_freq() - Get the scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The scaling frequency on success, -1 otherwise.
+ */
+int ldx_cpu_policy_get_scaling_freq(int policy);
+
+/**
+ * ldx_cpu_policy_set_scaling_freq() - Set the scaling frequency of a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @freq:	The frequency to set. Requires the GOVERNOR_USERSPACE governor.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_policy_set_scaling_freq(int policy, int freq);
+
+/**
+ * ldx_cpu_policy_is_governor_available() - Verify if a governor is available for a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @governor:	The governor to check availability.
+ *
+ * Return: EXIT_SUCCESS if the governor is supported, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_policy_is_governor_available(int policy, governor_mode_t governor);
+
+/**
+ * ldx_cpu_policy_set_governor() - Set the governor of a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @governor:	The governor to set.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_policy_set_governor(int policy, governor_mode_t governor);
+
+/**
+ * ldx_cpu_policy_get_governor() - Get the governor of a policy
+ *
+ * @policy:	The cpufreq policy.
+ *
+ * Return: The configured governor, GOVERNOR_INVALID on error.
+ */
+governor_mode_t ldx_cpu_policy_get_governor(int policy);
+
+/**
+ * ldx_cpu_apply_profile() - Apply a CPU power profile
+ *
+ * @profile:	The profile to apply.
+ *
+ * The whole profile is validated before changing anything: the policies must
+ * exist, the governors must be available, the frequencies must be supported
+ * with min <= max, and at least one core must stay enabled.
+ *
+ * Then cores are enabled, governors and frequency limits are set (in the
+ * order the kernel accepts regardless of the current limits) and finally
+ * cores are disabled.
+ *
+ * A failure while applying (for example, a write rejected by the kernel)
+ * stops the process and the changes already applied are not reverted.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_apply_profile(const cpu_profile_t *profile);
+
 /**
  * ldx_cpu_governor_type_from_string() - Get a governor mode providing an string
  *
@@ -296,11 +514,51 @@ int ldx_cpu_set_passive_trip_point(int temp);
 /**
  * ldx_cpu_get_cpu_usage() - Get the current CPU usage in %
  *
+ * This function measures the usage during one second and blocks until then.
+ * Use a sampler ('ldx_cpu_sampler_create()') to get the usage without
+ * blocking.
  *
  * Return: The usage of the CPU in %, -1 on error.
  */
 int ldx_cpu_get_usage();
 
+/**
+ * ldx_cpu_sampler_create() - Create a CPU telemetry sampler
+ *
+ * The sampler keeps the CPU statistics, temperature and frequency files open,
+ * so each sample only costs a few reads.
+ *
+ * Memory for the sampler is obtained with 'malloc' and must be freed with
+ * 'ldx_cpu_sampler_free()'.
+ *
+ * Return: A pointer to cpu_sampler_t on success, NULL on error.
+ */
+cpu_sampler_t *ldx_cpu_sampler_create(void);
+
+/**
+ * ldx_cpu_sampler_read() - Take a CPU telemetry sample
+ *
+ * @sampler:	The sampler.
+ * @sample:	Struct to fill with the sample.
+ *
+ * This function does not block. The usage is computed from the time spent
+ * by the cores since the previous sample; if no time was accounted in
+ * between (samples closer than a scheduler tick) it is reported as -1.
+ *
+ * The 'core_usage' array belongs to the sampler and is valid until the next
+ * call or until the sampler is freed.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_cpu_sampler_read(cpu_sampler_t *sampler, cpu_sample_t *sample);
+
+/**
+ * ldx_cpu_sampler_free() - Free a previously created CPU telemetry sampler
+ *
+ * @sampler:	The sampler to free.
+ */
+void ldx_cpu_sampler_free(cpu_sampler_t *sampler);
+
 /**
  * ldx_cpu_get_gpu_min_multiplier() - Get the min multiplier
  *
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef REACTOR_H_
+#define REACTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#include "common.h"
+
+/**
+ * LDX_REACTOR_DEF_MAX_FDS - Default number of descriptors a reactor can watch
+ */
+#define LDX_REACTOR_DEF_MAX_FDS		256
+
+/**
+ * reactor_t - Representation of an event loop shared by several interfaces
+ *
+ * @max_fds:	Maximum number of descriptors the reactor can watch.
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	const unsigned int max_fds;
+	void *_data;
+} reactor_t;
+
+/**
+ * Callback function type used to handle descriptor events
+ *
+ * @fd:		The descriptor that is ready.
+ * @events:	The ready events (EPOLLIN, EPOLLPRI, EPOLLERR, ...).
+ * @arg:	The argument given when the descriptor was added.
+ *
+ * See 'ldx_reactor_add_fd()'.
+ */
+typedef void (*ldx_reactor_cb_t)(int fd, uint32_t events, void *arg);
+
+/**
+ * ldx_reactor_create() - Create a new reactor
+ *
+ * @max_fds:	Maximum number of descriptors to watch, 0 to use
+ *		LDX_REACTOR_DEF_MAX_FDS.
+ *
+ * A reactor is an epoll based event loop that can serve the I/O of several
+ * interfaces from a single thread. CAN interfaces and GPIO interrupts are
+ * attached with 'ldx_can_set_reactor()' and 'ldx_gpio_set_reactor()', and
+ * applications can add their own descriptors with 'ldx_reactor_add_fd()'.
+ *
+ * Memory for the reactor is obtained with 'malloc' and must be freed with
+ * 'ldx_reactor_free()'.
+ *
+ * Return: A pointer to reactor_t on success, NULL on error.
+ */
+reactor_t *ldx_reactor_create(unsigned int max_fds);
+
+/**
+ * ldx_reactor_free() - Free a previously created reactor
+ *
+ * @reactor:	The reactor to free.
+ *
+ * All the threads running the reactor must have returned and every attached
+ * interface must have been released before calling this function.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_reactor_free(reactor_t *reactor);
+
+/**
+ * ldx_reactor_add_fd() - Start watching a descriptor
+ *
+ * @reactor:	The reactor to add the descriptor to.
+ * @fd:		The descriptor to watch.
+ * @events:	The events to watch (EPOLLIN, EPOLLPRI, EPOLLOUT).
+ * @cb:		Callback to execute each time the descriptor is ready.
+ * @arg:	Argument to pass to the callback.
+ *
+ * The callback of a descriptor never runs in two threads at the same time,
+ * even when several threads run the reactor.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_reactor_add_fd(reactor_t *reactor, int fd, uint32_t events,
+		       const ldx_reactor_cb_t cb, void *arg);
+
+/**
+ * ldx_reactor_del_fd() - Stop watching a descriptor
+ *
+ * @reactor:	The reactor to remove the descriptor from.
+ * @fd:		The descriptor to remove.
+ *
+ * If the callback of the descriptor is running in another thread, this
+ * function waits for it to return. When called from the callback itself,
+ * it returns immediately and the descriptor is released after the callback.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_reactor_del_fd(reactor_t *reactor, int fd);
+
+/**
+ * ldx_reactor_run_once() - Wait for events and dispatch them
+ *
+ * @reactor:	The reactor to run.
+ * @timeout:	The maximum number of milliseconds to wait for events, -1
+ *		for blocking indefinitely.
+ *
+ * Return: The number of events dispatched, -1 on error.
+ */
+int ldx_reactor_run_once(reactor_t *reactor, int timeout);
+
+/**
+ * ldx_reactor_run() - Run the reactor until it is stopped
+ *
+ * @reactor:	The reactor to run.
+ *
+ * This function blocks dispatching events until 'ldx_reactor_stop()' is
+ * called. Several threads (for example, one per core) can run the same
+ * reactor to share the load.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_reactor_run(reactor_t *reactor);
+
+/**
+ * ldx_reactor_stop() - Stop every thread running the reactor
+ *
+ * @reactor:	The reactor to stop.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_reactor_stop(reactor_t *reactor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REACTOR_H_ */
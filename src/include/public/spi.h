@@ -22,6 +22,7 @@ extern "C" {
 #endif
 
 #include "common.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
@@ -100,6 +101,37 @@ typedef struct {
 	spi_bo_t bit_order;
 } spi_transfer_cfg_t;
 
+/**
+ * LDX_SPI_MAX_SEGMENTS - Maximum number of segments of a SPI batch
+ */
+#define LDX_SPI_MAX_SEGMENTS	256
+
+/**
+ * spi_segment_t - Representation of a segment of a SPI transaction
+ *
+ * @tx_data:		Array of bytes to write, NULL to send zeros.
+ * @rx_data:		Array of bytes to store read data into, NULL to
+ *			discard the read data.
+ * @length:		Number of bytes of the segment.
+ * @speed:		Bus speed in Hz for this segment, 0 to use the speed of
+ *			the SPI.
+ * @bits_per_word:	Bits-per-word for this segment (8, 16, ...), 0 to use
+ *			the bits-per-word of the SPI.
+ * @delay_usecs:	Microseconds to wait after this segment before the next
+ *			one or before deselecting the device.
+ * @cs_change:		Deselect the device after this segment. On the last
+ *			segment of a batch, keep it selected after the batch.
+ */
+typedef struct {
+	uint8_t *tx_data;
+	uint8_t *rx_data;
+	unsigned int length;
+	unsigned int speed;
+	uint8_t bits_per_word;
+	uint16_t delay_usecs;
+	bool cs_change;
+} spi_segment_t;
+
 /**
  * spi_t - Representation of a single SPI
  *
@@ -115,6 +147,26 @@ typedef struct {
 	void *_data;
 } spi_t;
 
+/**
+ * LDX_SPI_DEF_QUEUE_LEN - Default number of requests of the SPI async queue
+ */
+#define LDX_SPI_DEF_QUEUE_LEN	16
+
+/**
+ * Callback function type used to report the completion of a SPI request
+ *
+ * @spi:	The SPI the request was submitted to.
+ * @segs:	The segments of the request.
+ * @n:		Number of segments.
+ * @status:	EXIT_SUCCESS if the transfer succeeded, EXIT_FAILURE
+ *		otherwise.
+ * @arg:	The argument given to 'ldx_spi_submit()'.
+ *
+ * See 'ldx_spi_submit()'.
+ */
+typedef void (*ldx_spi_done_cb_t)(spi_t *spi, spi_segment_t *segs,
+				  unsigned int n, int status, void *arg);
+
 /**
  * ldx_spi_request() - Request a SPI to use
  *
@@ -297,11 +349,135 @@ int ldx_spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length);
  * @rx_data:	Array of bytes to store read data into.
  * @length:	Number of bytes to transfer.
  *
+ * Transfers of any length are accepted, see 'ldx_spi_transfer_batch()' for
+ * how those larger than the spidev 'bufsiz' are handled. The same applies
+ * to 'ldx_spi_write()' and 'ldx_spi_read()'.
+ *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
 int ldx_spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data,
 		     unsigned int length);
 
+/**
+ * ldx_spi_transfer_batch() - Run several SPI segments as one transaction
+ *
+ * @spi:	A requested SPI to transfer data with.
+ * @segs:	Array of segments to transfer, in order.
+ * @n:		Number of segments, up to LDX_SPI_MAX_SEGMENTS.
+ *
+ * All the segments are submitted to the kernel with a single system call and
+ * the device stays selected between them unless 'cs_change' is set. This
+ * allows, for example, to write a command and read its response without
+ * releasing the chip select.
+ *
+ * Segments, and batches, larger than the spidev 'bufsiz' module parameter
+ * (4096 bytes by default) are split in several messages without copying the
+ * data. The device is kept selected between them, as long as the SPI
+ * controller driver honors 'cs_change' at the end of a message.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_transfer_batch(spi_t *spi, spi_segment_t *segs, unsigned int n);
+
+/**
+ * ldx_spi_async_start() - Start the asynchronous submission queue of a SPI
+ *
+ * @spi:	A requested SPI.
+ * @queue_len:	Maximum number of pending requests, 0 to use
+ *		LDX_SPI_DEF_QUEUE_LEN.
+ *
+ * This creates a worker thread for the SPI and preallocates 'queue_len'
+ * request descriptors, so 'ldx_spi_submit()' does not allocate memory. It is
+ * called automatically, with the default length, by the first
+ * 'ldx_spi_submit()'; if several threads submit to the same SPI, call it
+ * before they start. Workers of different SPIs run in parallel.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_async_start(spi_t *spi, unsigned int queue_len);
+
+/**
+ * ldx_spi_submit() - Queue a SPI transaction to run in the background
+ *
+ * @spi:	A requested SPI.
+ * @segs:	Array of segments to transfer, see 'ldx_spi_transfer_batch()'.
+ * @n:		Number of segments.
+ * @cb:		Function to call when the transaction completes, or NULL.
+ * @arg:	Argument to pass to the callback.
+ *
+ * The transaction is run by the SPI worker thread, in submission order, and
+ * the callback is executed from that thread. The segments array and its
+ * buffers must remain valid until the callback is called.
+ *
+ * If the queue is full, this function waits for a free descriptor, except
+ * when called from a completion callback, where it fails instead.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_submit(spi_t *spi, spi_segment_t *segs, unsigned int n,
+		   const ldx_spi_done_cb_t cb, void *arg);
+
+/**
+ * ldx_spi_async_flush() - Wait for the submitted SPI transactions
+ *
+ * @spi:	A requested SPI.
+ *
+ * This function blocks until every transaction submitted to the SPI has
+ * completed and its callback has returned. It must not be called from a
+ * completion callback.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_async_flush(spi_t *spi);
+
+/**
+ * ldx_spi_async_stop() - Stop the asynchronous submission queue of a SPI
+ *
+ * @spi:	A requested SPI.
+ *
+ * The pending transactions are completed before the worker thread exits.
+ * 'ldx_spi_free()' calls this function automatically.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_async_stop(spi_t *spi);
+
+/**
+ * ldx_spi_set_priority() - Set the priority class of the transactions of a SPI
+ *
+ * @spi:	A requested SPI.
+ * @prio:	The priority class, BUS_PRIO_NORMAL by default.
+ *
+ * Transactions of all the handles requested for the same SPI device are
+ * serialized and served by priority class. See 'bus_prio_t'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_set_priority(spi_t *spi, bus_prio_t prio);
+
+/**
+ * ldx_spi_lock_bus() - Reserve the SPI device of a SPI for several transactions
+ *
+ * @spi:	A requested SPI.
+ *
+ * Waits for the turn of the handle and keeps the SPI device until
+ * 'ldx_spi_unlock_bus()' is called, so a sequence of transactions is not
+ * interleaved with those of other handles. Transactions of the same thread
+ * are still allowed while the SPI device is locked.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_lock_bus(spi_t *spi);
+
+/**
+ * ldx_spi_unlock_bus() - Release the SPI device reserved with 'ldx_spi_lock_bus()'
+ *
+ * @spi:	A requested SPI.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_spi_unlock_bus(spi_t *spi);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * STATS_HIST_SUB_BUCKETS - Linear sub-buckets of each power of two
+ *
+ * The latency histograms are log-linear: every power of two of nanoseconds
+ * is split in STATS_HIST_SUB_BUCKETS buckets, so the width of a bucket is
+ * at most 25% of its value.
+ */
+#define STATS_HIST_SUB_BUCKETS	4
+
+/**
+ * STATS_HIST_BUCKETS - Number of buckets of a latency histogram
+ *
+ * Latencies of 2^33 ns (about 8.6 seconds) and above are counted in the
+ * last bucket.
+ */
+#define STATS_HIST_BUCKETS	128
+
+/**
+ * stats_api_t - Instrumented entry points of the library
+ */
+typedef enum {
+	STATS_API_GPIO_SET_VALUE,
+	STATS_API_GPIO_GET_VALUE,
+	STATS_API_GPIO_BANK_SET_VALUES,
+	STATS_API_GPIO_BANK_GET_VALUES,
+	STATS_API_SPI_WRITE,
+	STATS_API_SPI_READ,
+	STATS_API_SPI_TRANSFER,
+	STATS_API_SPI_TRANSFER_BATCH,
+	STATS_API_I2C_READ,
+	STATS_API_I2C_WRITE,
+	STATS_API_I2C_TRANSFER,
+	STATS_API_I2C_TRANSFER_MSGS,
+	STATS_API_ADC_GET_SAMPLE,
+	STATS_API_ADC_BUFFER_READ,
+	STATS_API_PWM_SET_DUTY_CYCLE,
+	STATS_API_PWM_APPLY,
+	STATS_API_CAN_TX_FRAME,
+	STATS_API_CAN_TX_FRAMES,
+	STATS_API_CAN_RX_POP,
+	STATS_API_CAN_RX_POP_BATCH,
+	STATS_API_COUNT,
+} stats_api_t;
+
+/**
+ * stats_counters_t - Counters of an instrumented entry point
+ *
+ * @calls:	Number of calls.
+ * @errors:	Calls that failed.
+ * @retries:	Calls that failed with a transient error the caller is
+ *		expected to retry (EAGAIN, 'CAN_ERROR_TX_RETRY_LATER'). They
+ *		are not counted in @errors.
+ * @bytes:	Bytes written and read by the successful calls. Frames for
+ *		the CAN entry points, samples for 'ldx_adc_get_sample()' and
+ *		scans for 'ldx_adc_buffer_read()'.
+ * @total_ns:	Accumulated time spent in the calls, in nanoseconds.
+ * @hist:	Latency histogram, see 'ldx_stats_bucket_limit()'.
+ *
+ * All the counters are cumulative since the library was loaded, so the
+ * activity of an interval is the difference of two snapshots.
+ */
+typedef struct {
+	uint64_t calls;
+	uint64_t errors;
+	uint64_t retries;
+	uint64_t bytes;
+	uint64_t total_ns;
+	uint64_t hist[STATS_HIST_BUCKETS];
+} stats_counters_t;
+
+/**
+ * stats_snapshot_t - Counters of all the instrumented entry points
+ *
+ * @timestamp_ns:	CLOCK_MONOTONIC time of the snapshot in nanoseconds.
+ * @api:		Counters of each entry point, indexed by 'stats_api_t'.
+ */
+typedef struct {
+	uint64_t timestamp_ns;
+	stats_counters_t api[STATS_API_COUNT];
+} stats_snapshot_t;
+
+/**
+ * ldx_stats_snapshot() - Get the counters of the instrumented entry points
+ *
+ * @snapshot:	Where the counters are stored.
+ *
+ * The counters are updated by every thread without locks and summed up
+ * here, so the snapshot is not an atomic picture of all of them: a call in
+ * progress may be reflected in some counters and not yet in others.
+ *
+ * The instrumentation is only available when the library is built with
+ * 'make CONFIG_STATS=1'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE on error or if the library
+ *	   was built without instrumentation.
+ */
+int ldx_stats_snapshot(stats_snapshot_t *snapshot);
+
+/**
+ * ldx_stats_api_name() - Get the name of an instrumented entry point
+ *
+ * @api:	The entry point.
+ *
+ * Return: The name of the function, for example "ldx_spi_transfer", NULL
+ *	   if the entry point is not valid.
+ */
+const char *ldx_stats_api_name(stats_api_t api);
+
+/**
+ * ldx_stats_bucket_limit() - Get the upper limit of a histogram bucket
+ *
+ * @bucket:	Index of the bucket in 'stats_counters_t.hist'.
+ *
+ * A bucket counts the latencies from the limit of the previous bucket (0
+ * for the first one) up to its own limit, not included.
+ *
+ * Return: The limit in nanoseconds, UINT64_MAX for the last bucket.
+ */
+uint64_t ldx_stats_bucket_limit(unsigned int bucket);
+
+/**
+ * ldx_stats_percentile() - Estimate a latency percentile
+ *
+ * @counters:	Counters of an entry point.
+ * @percentile:	Percentile to estimate, from 0 to 100 (for example 99.9).
+ *
+ * Return: The limit of the bucket holding the percentile in nanoseconds,
+ *	   so the real value is at most 25% lower. 0 if there are no samples.
+ */
+uint64_t ldx_stats_percentile(const stats_counters_t *counters, double percentile);
+
+/**
+ * ldx_stats_export_start() - Export the counters over a Unix socket
+ *
+ * @path:	Path of the Unix stream socket to create.
+ *
+ * A thread listens on the socket and writes a JSON snapshot of the counters
+ * to every client that connects, then closes the connection. For example:
+ *
+ *	socat - UNIX-CONNECT:/run/myapp-stats.sock
+ *
+ * An existing file at @path is replaced.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE on error, if the export is
+ *	   already running or if the library was built without
+ *	   instrumentation.
+ */
+int ldx_stats_export_start(const char *path);
+
+/**
+ * ldx_stats_export_stop() - Stop exporting the counters
+ *
+ * Stops the thread started with 'ldx_stats_export_start()' and removes the
+ * socket.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int ldx_stats_export_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATS_H_ */
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <linux/can.h>
+#include <stdint.h>
+
+#include "adc.h"
+#include "gpio.h"
+#include "timestamp.h"
+
+struct can_if;
+
+/* Default number of events a timeline can hold */
+#define TIMELINE_DEF_LEN		4096
+
+/* Default time events are held to put the late ones in order */
+#define TIMELINE_DEF_LATENCY_MS		100
+
+/* Maximum number of sources of a timeline */
+#define TIMELINE_MAX_SOURCES		32
+
+/**
+ * timeline_event_type_t - Peripheral an event of a timeline comes from
+ */
+typedef enum {
+	TIMELINE_EVENT_CAN,
+	TIMELINE_EVENT_GPIO,
+	TIMELINE_EVENT_ADC,
+} timeline_event_type_t;
+
+/**
+ * timeline_event_t - Event of a timeline
+ *
+ * @ts:		Time of the event.
+ * @type:	Peripheral of the event (timeline_event_type_t), selects the
+ *		member of @data.
+ * @source:	Identifier returned when the source was added.
+ * @data:	The received CAN frame, the edge of the GPIO, or the index of
+ *		the ADC in its group and the raw sample.
+ */
+typedef struct {
+	ldx_timestamp_t ts;
+	timeline_event_type_t type;
+	unsigned int source;
+	union {
+		struct canfd_frame can;
+		gpio_event_edge_t edge;
+		struct {
+			unsigned int index;
+			int sample;
+		} adc;
+	} data;
+} timeline_event_t;
+
+/**
+ * timeline_t - Time-ordered capture of the events of several peripherals
+ *
+ * @capacity:	Number of events the timeline can hold.
+ * @latency_ms:	Time events are held before they can be read.
+ * @_data:	Data for internal usage.
+ */
+typedef struct {
+	const unsigned int capacity;
+	const unsigned int latency_ms;
+	void *_data;
+} timeline_t;
+
+/**
+ * ldx_timeline_create() - Create a time-correlated capture session
+ *
+ * @capacity:	Number of events the timeline can hold, 0 for
+ *		TIMELINE_DEF_LEN.
+ * @latency_ms:	Milliseconds events are held before they can be read, 0
+ *		for TIMELINE_DEF_LATENCY_MS.
+ *
+ * Events of the CAN interfaces, GPIOs and ADC groups added to the timeline
+ * are merged in a single buffer, ordered by their 'ldx_timestamp_t'. Each
+ * peripheral is served by its own thread, so an event may arrive after a
+ * later one of another source. To give them the chance to be put in order,
+ * events are only handed to 'ldx_timeline_read()' once they are
+ * 'latency_ms' old.
+ *
+ * Memory for the timeline is obtained with 'malloc' and must be freed with
+ * 'ldx_timeline_free()'.
+ *
+ * Return: A pointer to 'timeline_t' on success, NULL on error.
+ */
+timeline_t *ldx_timeline_create(unsigned int capacity, unsigned int latency_ms);
+
+/**
+ * ldx_timeline_add_can() - Capture the frames of a CAN interface
+ *
+ * @tl:		The timeline.
+ * @cif:	An initialized CAN interface.
+ *
+ * Frames are received with 'ldx_can_register_rx_ts_handler()'. Enable
+ * 'process_header' in the interface configuration to use the kernel time of
+ * reception instead of the time the library reads the frames.
+ *
+ * Return: The identifier of the source in the events, -1 on error.
+ */
+int ldx_timeline_add_can(timeline_t *tl, struct can_if *cif);
+
+/**
+ * ldx_timeline_add_gpio() - Capture the edges of a GPIO
+ *
+ * @tl:		The timeline.
+ * @gpio:	A GPIO requested through libgpiod and configured as
+ *		GPIO_IRQ_EDGE_RISING, GPIO_IRQ_EDGE_FALLING, or
+ *		GPIO_IRQ_EDGE_BOTH.
+ *
+ * Edges are received with an event stream, see
+ * 'ldx_gpio_start_event_stream()', so the GPIO can not be used to wait for
+ * interrupts until the timeline is stopped.
+ *
+ * Return: The identifier of the source in the events, -1 on error.
+ */
+int ldx_timeline_add_gpio(timeline_t *tl, gpio_t *gpio);
+
+/**
+ * ldx_timeline_add_adc_group() - Capture the samples of a group of ADCs
+ *
+ * @tl:		The timeline.
+ * @group:	A group of ADCs that is not being sampled.
+ * @period_us:	Sampling period in microseconds.
+ *
+ * The group is sampled with 'ldx_adc_group_start_sampling()'. Each scan
+ * adds one event per ADC, all with the time of the scan.
+ *
+ * Return: The identifier of the source in the events, -1 on error.
+ */
+int ldx_timeline_add_adc_group(timeline_t *tl, adc_group_t *group,
+			       unsigned int period_us);
+
+/**
+ * ldx_timeline_read() - Read the events of a timeline in time order
+ *
+ * @tl:		The timeline.
+ * @events:	Array to store the events.
+ * @max:	Maximum number of events to read.
+ * @timeout:	Maximum number of milliseconds to wait for events, 0 to
+ *		return immediately, -1 to block indefinitely.
+ *
+ * Once the timeline is stopped the held events are returned without waiting
+ * for their latency, and the function does not block when none is left.
+ *
+ * Return: The number of events read, 0 on timeout, -1 on error.
+ */
+int ldx_timeline_read(timeline_t *tl, timeline_event_t *events,
+		      unsigned int max, int timeout);
+
+/**
+ * ldx_timeline_get_lost() - Get the events dropped because the timeline was full
+ *
+ * @tl:		The timeline.
+ * @lost:	Where to store the number of events.
+ *
+ * Events can also be dropped before reaching the timeline, see
+ * 'ldx_can_get_rx_stats()' and 'ldx_gpio_get_lost_events()'.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_timeline_get_lost(timeline_t *tl, uint64_t *lost);
+
+/**
+ * ldx_timeline_stop() - Stop capturing the events of a timeline
+ *
+ * @tl:		The timeline to stop.
+ *
+ * Every source is released, so the peripherals can be used again. The events
+ * already captured can still be read.
+ *
+ * This function waits for the sources to finish delivering events, so it
+ * must not be called while other threads add sources.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_timeline_stop(timeline_t *tl);
+
+/**
+ * ldx_timeline_free() - Stop and free a timeline
+ *
+ * @tl:		The timeline to free.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_timeline_free(timeline_t *tl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMELINE_H_ */
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef TIMESTAMP_H_
+#define TIMESTAMP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * ldx_timestamp_source_t - Origin of a timestamp
+ */
+typedef enum {
+	LDX_TIMESTAMP_SRC_SOFTWARE,
+	LDX_TIMESTAMP_SRC_KERNEL,
+	LDX_TIMESTAMP_SRC_HARDWARE,
+} ldx_timestamp_source_t;
+
+/**
+ * ldx_timestamp_t - Time of an event or sample, common to every peripheral
+ *
+ * @ns:		CLOCK_MONOTONIC time in nanoseconds. Times of different
+ *		peripherals can be compared directly.
+ * @hw_ns:	Raw value of the hardware clock of the device (for example
+ *		the timestamp counter of a CAN controller) when @source is
+ *		LDX_TIMESTAMP_SRC_HARDWARE, 0 otherwise. This clock is not
+ *		related to @ns.
+ * @source:	Where the time was taken (ldx_timestamp_source_t):
+ *		LDX_TIMESTAMP_SRC_SOFTWARE by the library when the event
+ *		was read, LDX_TIMESTAMP_SRC_KERNEL by the kernel when the
+ *		event happened, or LDX_TIMESTAMP_SRC_HARDWARE by the device,
+ *		@ns still being the kernel time of reception.
+ */
+typedef struct {
+	uint64_t ns;
+	uint64_t hw_ns;
+	ldx_timestamp_source_t source;
+} ldx_timestamp_t;
+
+/**
+ * ldx_timestamp_now() - Get the current time as a software timestamp
+ *
+ * @ts:		Where to store the timestamp.
+ */
+void ldx_timestamp_now(ldx_timestamp_t *ts);
+
+/**
+ * ldx_timestamp_from_realtime() - Convert a CLOCK_REALTIME time
+ *
+ * @ts:		Where to store the timestamp.
+ * @rt:		The CLOCK_REALTIME time to convert, as given for example by
+ *		'SO_TIMESTAMP' or the IIO 'realtime' clock.
+ * @source:	Origin of the time (ldx_timestamp_source_t).
+ *
+ * The time is moved to CLOCK_MONOTONIC with the current offset between both
+ * clocks, so the result is only exact for times taken after the last clock
+ * step (settimeofday, NTP step).
+ */
+void ldx_timestamp_from_realtime(ldx_timestamp_t *ts, const struct timespec *rt,
+				 ldx_timestamp_source_t source);
+
+/**
+ * ldx_timestamp_to_realtime() - Get the CLOCK_REALTIME time of a timestamp
+ *
+ * @ts:		The timestamp.
+ * @rt:		Where to store the CLOCK_REALTIME time.
+ *
+ * Useful to show the wall clock time of captured events. The current offset
+ * between both clocks is used, see 'ldx_timestamp_from_realtime()'.
+ */
+void ldx_timestamp_to_realtime(const ldx_timestamp_t *ts, struct timespec *rt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMESTAMP_H_ */
@@ -24,6 +24,11 @@ extern "C" {
 #include <stdint.h>
 #include "common.h"
 
+/**
+ * LDX_WATCHDOG_MAX_CLIENTS - Maximum number of clients of a watchdog supervisor
+ */
+#define LDX_WATCHDOG_MAX_CLIENTS	64
+
 /**
  * wd_t - Representation of a single requested watchdog
  *
@@ -143,6 +148,103 @@ int ldx_watchdog_stop(wd_t *wd);
  */
 int ldx_watchdog_start(wd_t *wd);
 
+/**
+ * ldx_watchdog_supervisor_start() - Start refreshing a watchdog on behalf of its clients
+ *
+ * @wd:		A requested watchdog.
+ * @period_ms:	Period (in milliseconds) to check the clients and refresh
+ *		the watchdog, 0 to use a quarter of the watchdog timeout.
+ *
+ * A supervisor thread owns the watchdog and refreshes it only while every
+ * client registered with 'ldx_watchdog_client_register()' has kicked with
+ * 'ldx_watchdog_client_kick()' within its deadline. If a client is late,
+ * the watchdog is not refreshed anymore and the system reboots at the
+ * watchdog timeout, unless the client recovers before.
+ *
+ * The timeout and pretimeout are read when the supervisor starts. Do not
+ * call 'ldx_watchdog_refresh()' while the supervisor runs.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_watchdog_supervisor_start(wd_t *wd, unsigned int period_ms);
+
+/**
+ * ldx_watchdog_supervisor_stop() - Stop the supervisor of a watchdog
+ *
+ * @wd:		A watchdog with a running supervisor.
+ *
+ * The watchdog keeps running: refresh it, stop it or restart the
+ * supervisor to avoid a reboot.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_watchdog_supervisor_stop(wd_t *wd);
+
+/**
+ * ldx_watchdog_supervisor_get_pretimeout_fd() - Get the pretimeout descriptor
+ *
+ * @wd:		A watchdog with a running supervisor.
+ *
+ * The descriptor becomes readable (POLLIN) when the watchdog has not been
+ * refreshed because of a late client and the time left before the reboot
+ * is the watchdog pretimeout (or immediately if there is no pretimeout).
+ * Read an uint64_t from it to clear the notification, and use
+ * 'ldx_watchdog_supervisor_get_late_clients()' to know the late clients.
+ *
+ * The descriptor belongs to the supervisor and is closed when it stops.
+ *
+ * Return: The descriptor, -1 on error.
+ */
+int ldx_watchdog_supervisor_get_pretimeout_fd(wd_t *wd);
+
+/**
+ * ldx_watchdog_supervisor_get_late_clients() - Get the clients late on their deadline
+ *
+ * @wd:		A watchdog with a running supervisor.
+ *
+ * Return: Bitmask with the identifiers of the late clients at the last
+ *	   supervisor check.
+ */
+uint64_t ldx_watchdog_supervisor_get_late_clients(wd_t *wd);
+
+/**
+ * ldx_watchdog_client_register() - Register a client of the watchdog supervisor
+ *
+ * @wd:			A requested watchdog.
+ * @deadline_ms:	Maximum time (in milliseconds) between kicks of the
+ *			client.
+ *
+ * The client is considered alive at registration. Clients can be registered
+ * before or after starting the supervisor.
+ *
+ * Return: The client identifier (0 to LDX_WATCHDOG_MAX_CLIENTS - 1), -1 on
+ *	   error.
+ */
+int ldx_watchdog_client_register(wd_t *wd, unsigned int deadline_ms);
+
+/**
+ * ldx_watchdog_client_kick() - Notify the supervisor that a client is alive
+ *
+ * @wd:		A requested watchdog.
+ * @client:	The client identifier.
+ *
+ * This function does not block nor perform system calls other than reading
+ * the clock, so it can be called from time critical loops.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_watchdog_client_kick(wd_t *wd, int client);
+
+/**
+ * ldx_watchdog_client_unregister() - Unregister a client of the watchdog supervisor
+ *
+ * @wd:		A requested watchdog.
+ * @client:	The client identifier.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int ldx_watchdog_client_unregister(wd_t *wd, int client);
+
 /**
  * ldx_watchdog_free() - Free a previously requested watchdog
  *
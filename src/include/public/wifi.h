@@ -46,6 +46,8 @@ typedef enum {
 	WIFI_STATE_ERROR_FREQ,
 	WIFI_STATE_ERROR_CHANNEL,
 	WIFI_STATE_ERROR_SEC_MODE,
+	WIFI_STATE_ERROR_SCAN,
+	WIFI_STATE_ERROR_STATION,
 	__WIFI_STATE_ERROR_LAST,
 } wifi_state_error_t;
 
@@ -95,6 +97,77 @@ typedef struct {
 	net_config_t net_config;
 } wifi_config_t;
 
+/**
+ * wifi_bss_t - Representation of an access point found in a scan
+ *
+ * @bssid:		MAC address of the access point.
+ * @ssid:		SSID name, empty for hidden networks.
+ * @freq:		Frequency in Hertz, -1 if unknown.
+ * @channel:		Channel, -1 if unknown.
+ * @signal:		Signal strength in dBm.
+ * @sec_mode:		WiFi security mode.
+ * @associated:		True if the interface is associated to the access point.
+ * @age:		Milliseconds since the access point was last seen.
+ */
+typedef struct {
+	uint8_t bssid[MAC_ADDRESS_GROUPS];
+	char ssid[IW_ESSID_MAX_SIZE];
+	double freq;
+	int channel;
+	int signal;
+	wifi_sec_mode_t sec_mode;
+	bool associated;
+	unsigned int age;
+} wifi_bss_t;
+
+/**
+ * wifi_station_info_t - Link information of a connected WiFi interface
+ *
+ * @bssid:		MAC address of the access point.
+ * @signal:		Signal strength of the last received frame in dBm.
+ * @signal_avg:		Average signal strength in dBm.
+ * @tx_bitrate:		Transmit bitrate in kbit/s.
+ * @rx_bitrate:		Receive bitrate in kbit/s.
+ * @tx_retries:		Number of transmit retries.
+ * @tx_failed:		Number of failed transmissions.
+ * @rx_packets:		Number of received packets.
+ * @tx_packets:		Number of transmitted packets.
+ * @rx_bytes:		Number of received bytes.
+ * @tx_bytes:		Number of transmitted bytes.
+ * @connected_time:	Seconds since the connection was established.
+ * @inactive_time:	Milliseconds since the last activity.
+ */
+typedef struct {
+	uint8_t bssid[MAC_ADDRESS_GROUPS];
+	int signal;
+	int signal_avg;
+	unsigned int tx_bitrate;
+	unsigned int rx_bitrate;
+	uint32_t tx_retries;
+	uint32_t tx_failed;
+	uint32_t rx_packets;
+	uint32_t tx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_bytes;
+	uint32_t connected_time;
+	uint32_t inactive_time;
+} wifi_station_info_t;
+
+/**
+ * Callback function type used to receive the results of a scan
+ *
+ * @iface_name:	Name of the scanned WiFi interface.
+ * @n_bss:	Number of found access points, -1 if the scan failed or was
+ *		aborted.
+ * @bss:	Array with the found access points, only valid during the
+ *		call.
+ * @arg:	The argument given to 'ldx_wifi_scan_start()'.
+ *
+ * See 'ldx_wifi_scan_start()'.
+ */
+typedef void (*ldx_wifi_scan_cb_t)(const char *iface_name, int n_bss,
+				   const wifi_bss_t *bss, void *arg);
+
 /**
  * ldx_wifi_code_to_str() - String that describes code
  *
@@ -132,6 +205,21 @@ int ldx_wifi_list_available_ifaces(net_names_list_t *iface_list);
  */
 wifi_state_error_t ldx_wifi_get_iface_state(const char *iface_name, wifi_state_t *wifi_state);
 
+/*
+ * ldx_wifi_get_iface_state_fast() - Retrieve the given WiFi interface state
+ *				     through nl80211
+ *
+ * @iface_name:	WiFi interface name.
+ * @wifi_state:	Struct to fill with the WiFi interface state.
+ *
+ * Same as 'ldx_wifi_get_iface_state()', but the SSID, frequency and channel
+ * are fetched with a single nl80211 request instead of several wireless
+ * extension requests. The channel is derived from the frequency.
+ *
+ * Return: WIFI_STATE_ERROR_NONE on success, any other error code otherwise.
+ */
+wifi_state_error_t ldx_wifi_get_iface_state_fast(const char *iface_name, wifi_state_t *wifi_state);
+
 /*
  * ldx_wifi_set_config() - Configure the given WiFi interface
  *
@@ -148,6 +236,8 @@ wifi_state_error_t ldx_wifi_set_config(wifi_config_t wifi_cfg);
  * @freqs:	A pointer to store the available frequencies of the interface.
  *
  * This function returns in 'channels' the available WiFi interface frequencies.
+ * The list is cached until a regulatory or wireless device change is
+ * notified by nl80211.
  *
  * Memory for the 'freqs' pointer is obtained with 'malloc' and must be freed
  * when return value is greater than 0.
@@ -163,6 +253,8 @@ int ldx_wifi_list_available_freqs(const char *iface_name, double **freqs);
  * @channels:	A pointer to store the available channels of the interface.
  *
  * This function returns in 'channels' the available WiFi interface channels.
+ * The list is cached until a regulatory or wireless device change is
+ * notified by nl80211.
  *
  * Memory for the 'freqs' pointer is obtained with 'malloc' and must be freed
  * when return value is greater than 0.
@@ -171,6 +263,52 @@ int ldx_wifi_list_available_freqs(const char *iface_name, double **freqs);
  */
 int ldx_wifi_list_available_channels(const char *iface_name, int **channels);
 
+/**
+ * ldx_wifi_scan_start() - Start a scan of the access points
+ *
+ * @iface_name:	WiFi interface name.
+ * @cb:		Function to call with the results once the scan finishes,
+ *		NULL to only trigger it.
+ * @arg:	Argument to pass to the callback.
+ *
+ * This function returns immediately. The callback is executed from a thread
+ * of the library. If a scan is already running, the callback gets its
+ * results.
+ *
+ * Return: WIFI_STATE_ERROR_NONE on success, any other error code otherwise.
+ */
+wifi_state_error_t ldx_wifi_scan_start(const char *iface_name, const ldx_wifi_scan_cb_t cb, void *arg);
+
+/**
+ * ldx_wifi_get_scan_results() - Get the results of the last scans
+ *
+ * @iface_name:	WiFi interface name.
+ * @bss:	A pointer to store the found access points.
+ *
+ * The kernel keeps the access points found in the recent scans, this
+ * function returns them without scanning.
+ *
+ * Memory for the 'bss' pointer is obtained with 'malloc' and must be freed
+ * when return value is greater than 0.
+ *
+ * Return: The number of access points, -1 on error.
+ */
+int ldx_wifi_get_scan_results(const char *iface_name, wifi_bss_t **bss);
+
+/**
+ * ldx_wifi_get_station_info() - Get the link information of a connected
+ *				 WiFi interface
+ *
+ * @iface_name:	WiFi interface name.
+ * @info:	Struct to fill with the link information.
+ *
+ * The information comes from a single nl80211 request, so this function is
+ * suitable for polling the link quality at a high rate.
+ *
+ * Return: WIFI_STATE_ERROR_NONE on success, any other error code otherwise.
+ */
+wifi_state_error_t ldx_wifi_get_station_info(const char *iface_name, wifi_station_info_t *info);
+
 /**
  * ldx_str_sec_mode() - String that describes security mode
  *
@@ -17,25 +17,40 @@
 #include <arpa/inet.h>
 #include <ctype.h>
 #include <errno.h>
-#include <ifaddrs.h>
 #include <linux/if_link.h>
 #include <net/if.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/ioctl.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
+#ifdef LDX_NM_DBUS
+#include <systemd/sd-bus.h>
+#endif
 
+#include "_list.h"
 #include "_log.h"
+#include "_netlink.h"
 #include "_network.h"
 #include "network.h"
 #include "process.h"
 
-#define CMD_GET_GATEWAY		"route -n | grep %s | grep 'UG[ \t]' | awk '{print $2}'"
-#define CMD_IS_DHCP		"ip route | grep %s | grep default | awk '{print $7}'"
-#define CMD_GET_DNS		"nmcli -g IP4.DNS device show %s"
-#define CMD_IFACE_STATE		"nmcli -g GENERAL.STATE device show %s | awk -F'[()]' '{print $2}'"
+#define RESOLV_CONF		"/etc/resolv.conf"
+#define RESOLVED_RESOLV_CONF	"/run/systemd/resolve/resolv.conf"
+#define RESOLVED_LINK_FMT	"/run/systemd/resolve/netif/%d"
+#define NETWORKD_LINK_FMT	"/run/systemd/netif/links/%d"
+#define NM_RUN_DIR		"/run/NetworkManager"
+
+#define NM_DBUS_SERVICE		"org.freedesktop.NetworkManager"
+#define NM_DBUS_PATH		"/org/freedesktop/NetworkManager"
+#define NM_DBUS_IFACE_DEVICE	NM_DBUS_SERVICE ".Device"
+#define NM_DBUS_IFACE_IP4CONFIG	NM_DBUS_SERVICE ".IP4Config"
+/* Timeout of the NetworkManager method calls in microseconds */
+#define NM_DBUS_TIMEOUT_US	(2 * 1000000ULL)
 
 #define UNKOWN_CODE	"Unknown network state error"
 
@@ -56,384 +71,595 @@ static const char* net_state_error_descs[] = {
 	"Unable to configure network interface",
 };
 
-/*
- * get_socket() - Opens a socket
+/**
+ * nl_iface_t - Data of an interface collected from rtnetlink
+ *
+ * @index:		Index of the interface.
+ * @state:		State to fill.
+ * @found:		True once the link of the interface was received.
+ * @flags:		Interface flags (IFF_*).
+ * @has_ip:		True once the primary IPv4 address was received.
+ * @dynamic_ip:		True if the address has a limited lifetime.
+ * @has_gw:		True once a default route was received.
+ * @dhcp_gw:		True if the default route was set by a DHCP client.
+ * @gw_metric:		Metric of the default route.
+ */
+typedef struct {
+	int index;
+	net_state_t *state;
+	bool found;
+	unsigned int flags;
+	bool has_ip;
+	bool dynamic_ip;
+	bool has_gw;
+	bool dhcp_gw;
+	uint32_t gw_metric;
+} nl_iface_t;
+
+/**
+ * link_cb() - Fill the link data of an interface from a RTM_NEWLINK message
  *
- * @action_msg:	The final action to log.
- * @iface_name:	Name of the interface.
+ * @nlh:	The netlink message.
+ * @arg:	The interface data (nl_iface_t *).
  *
- * Return: The opened socket file descriptor.
+ * Return: 0 always.
  */
-static int get_socket(const char *action_msg, const char *iface_name)
+static int link_cb(struct nlmsghdr *nlh, void *arg)
 {
-	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+	nl_iface_t *iface = arg;
+	struct ifinfomsg *ifi = NLMSG_DATA(nlh);
+	struct rtattr *tb[IFLA_MAX + 1];
+
+	if (nlh->nlmsg_type != RTM_NEWLINK || ifi->ifi_index != iface->index)
+		return 0;
 
-	if (sock == -1 && action_msg != NULL && iface_name != NULL)
-		log_debug("%s: Unable to %s of interface '%s': %s (%d)",
-			  __func__, action_msg, iface_name, strerror(errno), errno);
+	nl_parse_attrs(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(nlh));
 
-	return sock;
+	iface->found = true;
+	iface->flags = ifi->ifi_flags;
+
+	if (tb[IFLA_IFNAME] != NULL)
+		strncpy(iface->state->name, RTA_DATA(tb[IFLA_IFNAME]), IFNAMSIZ - 1);
+
+	if (tb[IFLA_ADDRESS] != NULL
+	    && RTA_PAYLOAD(tb[IFLA_ADDRESS]) >= MAC_ADDRESS_GROUPS)
+		memcpy(iface->state->mac, RTA_DATA(tb[IFLA_ADDRESS]),
+		       MAC_ADDRESS_GROUPS);
+
+	if (tb[IFLA_MTU] != NULL)
+		iface->state->mtu = *(uint32_t *)RTA_DATA(tb[IFLA_MTU]);
+
+	return 0;
 }
 
-/*
- * net_ioctl() - Execute net IOCL
+/**
+ * addr_cb() - Fill the IPv4 data of an interface from a RTM_NEWADDR message
  *
- * @sock:	Socket to the kernel.
- * @iface_name:	Name of the interface.
- * @request:	Request code.
- * @wreq:	In/out request parameter.
+ * @nlh:	The netlink message.
+ * @arg:	The interface data (nl_iface_t *).
  *
- * Return: ioctl code.
+ * Only the first primary address of the interface is used.
+ *
+ * Return: 0 always.
  */
-static int net_ioctl(int sock, const char *iface_name, int request, struct ifreq *ifr) {
-	strncpy(ifr->ifr_name, iface_name, IFNAMSIZ - 1);
+static int addr_cb(struct nlmsghdr *nlh, void *arg)
+{
+	nl_iface_t *iface = arg;
+	struct ifaddrmsg *ifa = NLMSG_DATA(nlh);
+	struct rtattr *tb[IFA_MAX + 1], *addr;
+	uint32_t flags, mask;
 
-	return ioctl(sock, request, ifr);
+	if (nlh->nlmsg_type != RTM_NEWADDR || iface->has_ip
+	    || ifa->ifa_family != AF_INET || (int)ifa->ifa_index != iface->index)
+		return 0;
+
+	nl_parse_attrs(tb, IFA_MAX, IFA_RTA(ifa), IFA_PAYLOAD(nlh));
+
+	/* IFA_FLAGS holds the complete 32-bit flags */
+	flags = tb[IFA_FLAGS] != NULL ?
+		*(uint32_t *)RTA_DATA(tb[IFA_FLAGS]) : ifa->ifa_flags;
+	if (flags & IFA_F_SECONDARY)
+		return 0;
+
+	addr = tb[IFA_LOCAL] != NULL ? tb[IFA_LOCAL] : tb[IFA_ADDRESS];
+	if (addr == NULL)
+		return 0;
+
+	memcpy(iface->state->ipv4, RTA_DATA(addr), IPV4_GROUPS);
+	if (tb[IFA_BROADCAST] != NULL)
+		memcpy(iface->state->broadcast, RTA_DATA(tb[IFA_BROADCAST]),
+		       IPV4_GROUPS);
+
+	mask = ifa->ifa_prefixlen ? htonl(~0U << (32 - ifa->ifa_prefixlen)) : 0;
+	memcpy(iface->state->netmask, &mask, IPV4_GROUPS);
+
+	iface->has_ip = true;
+	iface->dynamic_ip = !(flags & IFA_F_PERMANENT);
+
+	return 0;
 }
 
 /**
- * _get_mac() - Get the MAC address of the given interface
+ * route_cb() - Find the default gateway of an interface from a RTM_NEWROUTE
+ *		message
+ *
+ * @nlh:	The netlink message.
+ * @arg:	The interface data (nl_iface_t *).
  *
- * @iface_name:	Name of the network interface to retrieve its MAC address.
- * @mac:	Pointer to store the MAC address.
+ * When there are several default routes through the interface, the one with
+ * the lowest metric is used.
  *
- * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_MAC otherwise.
+ * Return: 0 always.
  */
-static net_state_error_t _get_mac(const char *iface_name, uint8_t (*mac)[MAC_ADDRESS_GROUPS], int sock)
+static int route_cb(struct nlmsghdr *nlh, void *arg)
 {
-	struct ifreq ifr;
-	net_state_error_t ret = NET_STATE_ERROR_MAC;
-	bool internal_sock = (sock < 0);
+	nl_iface_t *iface = arg;
+	struct rtmsg *rtm = NLMSG_DATA(nlh);
+	struct rtattr *tb[RTA_MAX + 1];
+	uint32_t table, metric = 0;
 
-	if (internal_sock)
-		sock = get_socket("get MAC", iface_name);
+	if (nlh->nlmsg_type != RTM_NEWROUTE || rtm->rtm_family != AF_INET
+	    || rtm->rtm_dst_len != 0 || rtm->rtm_type != RTN_UNICAST)
+		return 0;
 
-	if (sock == -1)
-		goto done;
+	nl_parse_attrs(tb, RTA_MAX, RTM_RTA(rtm), RTM_PAYLOAD(nlh));
 
-	memset(&ifr, 0, sizeof(ifr));
-	if (net_ioctl(sock, iface_name, SIOCGIFHWADDR, &ifr) < 0) {
-		log_debug("%s: %s '%s': %s (%d)", __func__,
-			  ldx_net_code_to_str(ret), iface_name, strerror(errno), errno);
-		goto done;
-	}
-	memcpy(mac, ifr.ifr_hwaddr.sa_data, MAC_ADDRESS_GROUPS);
-	ret = NET_STATE_ERROR_NONE;
+	table = tb[RTA_TABLE] != NULL ?
+		*(uint32_t *)RTA_DATA(tb[RTA_TABLE]) : rtm->rtm_table;
+	if (table != RT_TABLE_MAIN || tb[RTA_GATEWAY] == NULL || tb[RTA_OIF] == NULL
+	    || *(int *)RTA_DATA(tb[RTA_OIF]) != iface->index)
+		return 0;
 
-done:
-	if (internal_sock && sock >= 0)
-		close(sock);
+	if (tb[RTA_PRIORITY] != NULL)
+		metric = *(uint32_t *)RTA_DATA(tb[RTA_PRIORITY]);
 
-	return ret;
+	/* A route with the same metric replaces the previous one */
+	if (iface->has_gw && metric > iface->gw_metric)
+		return 0;
+
+	memcpy(iface->state->gateway, RTA_DATA(tb[RTA_GATEWAY]), IPV4_GROUPS);
+	iface->has_gw = true;
+	iface->dhcp_gw = rtm->rtm_protocol == RTPROT_DHCP;
+	iface->gw_metric = metric;
+
+	return 0;
 }
 
 /**
- * _get_ip() - Get the IP of the given interface
+ * get_status() - Get the status of an interface from its link data
  *
- * @iface_name:	Name of the network interface to retrieve its IP address.
- * @ip:		Pointer to store the IP address.
+ * @iface:	The interface data.
  *
- * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_IP otherwise.
+ * Return: The status of the interface.
  */
-static net_state_error_t _get_ip(const char *iface_name, uint8_t (*ip)[IPV4_GROUPS], int sock)
+static net_status_t get_status(const nl_iface_t *iface)
 {
-	struct ifreq ifr;
-	net_state_error_t ret = NET_STATE_ERROR_IP;
-	bool internal_sock = (sock < 0);
+	if (!(iface->flags & IFF_UP))
+		return NET_STATUS_DISCONNECTED;
 
-	if (internal_sock)
-		sock = get_socket("get IP", iface_name);
+	/* Up but without carrier */
+	if (!(iface->flags & IFF_RUNNING))
+		return NET_STATUS_UNAVAILABLE;
 
-	if (sock == -1)
-		goto done;
+	return iface->has_ip ? NET_STATUS_CONNECTED : NET_STATUS_DISCONNECTED;
+}
 
-	memset(&ifr, 0, sizeof(ifr));
-	ifr.ifr_addr.sa_family = AF_INET;
-	if (net_ioctl(sock, iface_name, SIOCGIFADDR, &ifr) < 0) {
-		log_debug("%s: %s '%s': %s (%d)", __func__,
-			  ldx_net_code_to_str(ret), iface_name, strerror(errno), errno);
-		goto done;
-	}
+/**
+ * get_dhcp() - Check if an interface is configured by DHCP
+ *
+ * @iface:	The interface data.
+ *
+ * DHCP leases have a lifetime and DHCP clients tag their routes.
+ *
+ * Return: NET_ENABLED if the interface uses DHCP, NET_DISABLED otherwise.
+ */
+static net_enabled_t get_dhcp(const nl_iface_t *iface)
+{
+	return (iface->dynamic_ip || iface->dhcp_gw) ? NET_ENABLED : NET_DISABLED;
+}
 
-	ret = NET_STATE_ERROR_NONE;
-	if (ifr.ifr_addr.sa_family == AF_INET) {
-		struct sockaddr_in *sa = (struct sockaddr_in *) &ifr.ifr_addr;
+/**
+ * read_dns() - Read DNS server addresses from a configuration file
+ *
+ * @path:	Path of the file.
+ * @key:	Prefix of the lines that list servers ("nameserver", "SERVERS=",
+ *		"DNS=").
+ * @dns:	Array to store up to MAX_DNS_ADDRESSES addresses.
+ *
+ * Addresses that are not IPv4 are skipped.
+ *
+ * Return: The number of addresses read, -1 if the file cannot be read.
+ */
+static int read_dns(const char *path, const char *key,
+		    uint8_t (*dns)[IPV4_GROUPS])
+{
+	char line[256], *token, *saveptr;
+	struct in_addr iaddr;
+	size_t key_len = strlen(key);
+	int n = 0;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -1;
 
-		memcpy(ip, &(sa->sin_addr), IPV4_GROUPS);
+	while (n < MAX_DNS_ADDRESSES && fgets(line, sizeof(line), f) != NULL) {
+		if (strncmp(line, key, key_len) != 0)
+			continue;
+
+		for (token = strtok_r(line + key_len, " \t\n", &saveptr);
+		     token != NULL && n < MAX_DNS_ADDRESSES;
+		     token = strtok_r(NULL, " \t\n", &saveptr)) {
+			if (inet_aton(token, &iaddr))
+				memcpy(dns[n++], &iaddr, IPV4_GROUPS);
+		}
 	}
 
-done:
-	if (internal_sock && sock >= 0)
-		close(sock);
+	fclose(f);
 
-	return ret;
+	return n;
 }
 
+#ifdef LDX_NM_DBUS
+
+/* Connection to the system bus, kept between queries */
+static sd_bus *nm_bus;
+static pthread_mutex_t nm_bus_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
- * _get_mtu() - Get the MTU (Maximum Transfer Unit) of the given interface
+ * nm_get_object_property() - Get an object path property of NetworkManager
+ *
+ * @path:	Object with the property.
+ * @iface:	Interface of the property.
+ * @name:	Name of the property.
+ * @value:	Where to store the object path, must be freed with 'free()'.
+ * @error:	D-Bus error of the call.
  *
- * @iface_name:	Name of the network interface to retrieve its MTU.
- * @mtu:	Pointer to store the MTU.
+ * Must be called with 'nm_bus_lock' held.
  *
- * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_MTU otherwise.
+ * Return: 0 on success, a negative errno value otherwise.
  */
-static net_state_error_t _get_mtu(const char *iface_name, int *mtu, int sock)
+static int nm_get_object_property(const char *path, const char *iface,
+				  const char *name, char **value,
+				  sd_bus_error *error)
 {
-	struct ifreq ifr;
-	net_state_error_t ret = NET_STATE_ERROR_MTU;
-	bool internal_sock = (sock < 0);
+	sd_bus_message *reply = NULL;
+	const char *obj;
+	int r;
+
+	r = sd_bus_get_property(nm_bus, NM_DBUS_SERVICE, path, iface, name,
+				error, &reply, "o");
+	if (r >= 0)
+		r = sd_bus_message_read(reply, "o", &obj);
+	if (r >= 0) {
+		*value = strdup(obj);
+		if (*value == NULL)
+			r = -ENOMEM;
+	}
+	sd_bus_message_unref(reply);
 
-	if (internal_sock)
-		sock = get_socket("get MTU", iface_name);
+	return r;
+}
 
-	if (sock == -1)
-		goto done;
+/**
+ * nm_read_nameservers() - Parse the 'NameserverData' property of an IP4Config
+ *
+ * @reply:	Message positioned at the 'aa{sv}' value of the property.
+ * @dns:	Array to store up to MAX_DNS_ADDRESSES addresses.
+ *
+ * Return: The number of addresses read, a negative errno value on error.
+ */
+static int nm_read_nameservers(sd_bus_message *reply,
+			       uint8_t (*dns)[IPV4_GROUPS])
+{
+	struct in_addr iaddr;
+	const char *key, *addr;
+	int n = 0, r;
+
+	r = sd_bus_message_enter_container(reply, SD_BUS_TYPE_ARRAY, "a{sv}");
+	if (r < 0)
+		return r;
+
+	while ((r = sd_bus_message_enter_container(reply, SD_BUS_TYPE_ARRAY,
+						   "{sv}")) > 0) {
+		while ((r = sd_bus_message_enter_container(reply,
+							   SD_BUS_TYPE_DICT_ENTRY,
+							   "sv")) > 0) {
+			r = sd_bus_message_read(reply, "s", &key);
+			if (r < 0)
+				return r;
+
+			if (strcmp(key, "address") == 0) {
+				r = sd_bus_message_read(reply, "v", "s", &addr);
+				if (r >= 0 && n < MAX_DNS_ADDRESSES &&
+				    inet_aton(addr, &iaddr))
+					memcpy(dns[n++], &iaddr, IPV4_GROUPS);
+			} else {
+				r = sd_bus_message_skip(reply, "v");
+			}
+			if (r < 0)
+				return r;
 
-	memset(&ifr, 0, sizeof(ifr));
-	if (net_ioctl(sock, iface_name, SIOCGIFMTU, &ifr) < 0) {
-		log_debug("%s: %s '%s': %s (%d)", __func__,
-			  ldx_net_code_to_str(ret), iface_name, strerror(errno), errno);
-		goto done;
+			r = sd_bus_message_exit_container(reply);
+			if (r < 0)
+				return r;
+		}
+		if (r < 0)
+			return r;
+
+		r = sd_bus_message_exit_container(reply);
+		if (r < 0)
+			return r;
 	}
-	memcpy(mtu, &ifr.ifr_mtu, sizeof(*mtu));
-	ret = NET_STATE_ERROR_NONE;
+	if (r < 0)
+		return r;
 
-done:
-	if (internal_sock && sock >= 0)
-		close(sock);
+	r = sd_bus_message_exit_container(reply);
 
-	return ret;
+	return r < 0 ? r : n;
 }
 
 /**
- * is_dhcp() - Check if provided interface uses DHCP or not
+ * read_nm_dns() - Get the DNS server addresses of a NetworkManager device
+ *
+ * @iface_name:	Name of the network interface.
+ * @dns:	Array to store up to MAX_DNS_ADDRESSES addresses.
  *
- * @iface_name:	Name of the network interface to retrieve its DHCP status.
+ * Only used when NetworkManager is running, as it keeps the servers of its
+ * devices in memory. The 'NameserverData' property of the IPv4
+ * configuration of the device is read over D-Bus, so nothing is forked.
  *
- * Return: NET_ENABLED if interface uses DHCP, NET_DISABLED otherwise, and
- * NET_ENABLED_ERROR on error.
+ * Return: The number of addresses read, -1 if they cannot be read.
  */
-static net_enabled_t is_dhcp(const char *iface_name)
+static int read_nm_dns(const char *iface_name, uint8_t (*dns)[IPV4_GROUPS])
 {
-	char *cmd = NULL, *resp = NULL;
-	int len;
-	net_enabled_t ret = NET_ENABLED_ERROR;
+	sd_bus_error error = SD_BUS_ERROR_NULL;
+	sd_bus_message *reply = NULL;
+	char *device = NULL, *config = NULL;
+	const char *obj;
+	int r;
+
+	if (access(NM_RUN_DIR, F_OK) != 0)
+		return -1;
 
-	if (strcmp(iface_name, "lo") == 0)
-		return NET_DISABLED;
+	pthread_mutex_lock(&nm_bus_lock);
 
-	len = snprintf(NULL, 0, CMD_IS_DHCP, iface_name);
-	cmd = calloc(len + 1, sizeof(*cmd));
-	if (cmd == NULL) {
-		log_debug("%s: Unable to check '%s' DHCP: Out of memory",
-			  __func__, iface_name);
-		goto done;
+	if (nm_bus == NULL) {
+		r = sd_bus_open_system(&nm_bus);
+		if (r < 0) {
+			log_debug("%s: Unable to connect to the system bus (%d)",
+				  __func__, -r);
+			nm_bus = NULL;
+			goto out;
+		}
+		sd_bus_set_method_call_timeout(nm_bus, NM_DBUS_TIMEOUT_US);
 	}
 
-	sprintf(cmd, CMD_IS_DHCP, iface_name);
-
-	if (ldx_process_execute_cmd(cmd, &resp, 2) != 0 || resp == NULL) {
-		if (resp != NULL)
-			log_debug("%s: Unable to check '%s' DHCP: %s", __func__,
-				  iface_name, resp);
-		else
-			log_debug("%s: Unable to check '%s' DHCP", __func__,
-				  iface_name);
-		goto done;
+	r = sd_bus_call_method(nm_bus, NM_DBUS_SERVICE, NM_DBUS_PATH,
+			       NM_DBUS_SERVICE, "GetDeviceByIpIface", &error,
+			       &reply, "s", iface_name);
+	if (r >= 0)
+		r = sd_bus_message_read(reply, "o", &obj);
+	if (r >= 0) {
+		device = strdup(obj);
+		if (device == NULL)
+			r = -ENOMEM;
+	}
+	reply = sd_bus_message_unref(reply);
+	if (r < 0)
+		goto out;
+
+	r = nm_get_object_property(device, NM_DBUS_IFACE_DEVICE, "Ip4Config",
+				   &config, &error);
+	if (r < 0)
+		goto out;
+
+	/* The device has no IPv4 configuration */
+	if (strcmp(config, "/") == 0) {
+		r = -ENOENT;
+		goto out;
 	}
 
-	ret = strncmp(resp, "dhcp", 4) == 0;
+	r = sd_bus_get_property(nm_bus, NM_DBUS_SERVICE, config,
+				NM_DBUS_IFACE_IP4CONFIG, "NameserverData",
+				&error, &reply, "aa{sv}");
+	if (r >= 0)
+		r = nm_read_nameservers(reply, dns);
+	sd_bus_message_unref(reply);
 
-done:
-	free(cmd);
-	free(resp);
+out:
+	/* Reconnect on the next query if the connection itself failed */
+	if (r < 0 && nm_bus != NULL && !sd_bus_error_is_set(&error))
+		nm_bus = sd_bus_flush_close_unref(nm_bus);
 
-	return ret;
+	pthread_mutex_unlock(&nm_bus_lock);
+
+	if (r < 0 && sd_bus_error_is_set(&error))
+		log_debug("%s: Unable to get the DNS servers of '%s': %s",
+			  __func__, iface_name, error.message);
+	sd_bus_error_free(&error);
+	free(device);
+	free(config);
+
+	return r < 0 ? -1 : r;
+}
+
+#else
+
+static int read_nm_dns(const char *iface_name, uint8_t (*dns)[IPV4_GROUPS])
+{
+	/* Built without D-Bus support (CONFIG_NM_DBUS) */
+	return -1;
 }
 
+#endif /* LDX_NM_DBUS */
+
 /**
  * get_dns() - Get the DNS addresses of the given interface
  *
- * @iface_name:	Name of the network interface to retrieve DNS.
- * @dns1:	Pointer to store the primary DNS address.
- * @dns2:	Pointer to store the secondary DNS address.
+ * @iface_index:	Index of the network interface.
+ * @net_state:		State to store the DNS addresses.
+ *
+ * The servers of the interface are taken from the per-link data of
+ * systemd-resolved, systemd-networkd or NetworkManager, in this order. If
+ * none of them knows the interface, the global servers of the resolver
+ * configuration are reported instead.
  *
- * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_DNS, or
- * NET_STATE_ERROR_NO_MEM otherwise.
+ * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_DNS otherwise.
  */
-static net_state_error_t get_dns(const char *iface_name, uint8_t (*dns1)[IPV4_GROUPS], uint8_t (*dns2)[IPV4_GROUPS])
+static net_state_error_t get_dns(int iface_index, net_state_t *net_state)
 {
-	int len, i = 0;
-	net_state_error_t ret = NET_STATE_ERROR_DNS;
-	char *cmd = NULL, *resp = NULL, *token = NULL;
-	char *nm_name = NULL, *iname = (char *)iface_name;
-	char delim[] = " | ", dns_str[20];
-	struct in_addr iaddr;
+	uint8_t dns[MAX_DNS_ADDRESSES][IPV4_GROUPS];
+	char path[64];
+	int n;
 
-	if (_get_nm_dev_name(iface_name, &nm_name) == 0)
-		iname = nm_name;
+	memset(dns, 0, sizeof(dns));
 
-	len = snprintf(NULL, 0, CMD_GET_DNS, iname);
-	cmd = calloc(len + 1, sizeof(*cmd));
-	if (cmd == NULL) {
-		ret = NET_STATE_ERROR_NO_MEM;
-		log_debug("%s: Unable to get '%s' DNS: %s", __func__,
-			  iface_name, ldx_net_code_to_str(ret));
-		goto done;
+	snprintf(path, sizeof(path), RESOLVED_LINK_FMT, iface_index);
+	n = read_dns(path, "SERVERS=", dns);
+	if (n <= 0) {
+		snprintf(path, sizeof(path), NETWORKD_LINK_FMT, iface_index);
+		n = read_dns(path, "DNS=", dns);
 	}
-
-	sprintf(cmd, CMD_GET_DNS, iname);
-	len = ldx_process_execute_cmd(cmd, &resp, 2);
-	if (len != 0 || resp == NULL) {
-		if (len == 127) /* Command not found */
-			log_debug("%s: 'nmcli' not found", __func__);
-		else if (resp != NULL)
-			log_debug("%s: %s '%s': %s", __func__,
-				  ldx_net_code_to_str(ret), iface_name, resp);
-		else
-			log_debug("%s: %s '%s'", __func__,
-				  ldx_net_code_to_str(ret), iface_name);
-		goto done;
+	if (n <= 0)
+		n = read_nm_dns(net_state->name, dns);
+
+	if (n <= 0) {
+		log_debug("%s: No DNS servers for '%s', using the global ones",
+			  __func__, net_state->name);
+		n = read_dns(RESOLVED_RESOLV_CONF, "nameserver", dns);
+		if (n <= 0)
+			n = read_dns(RESOLV_CONF, "nameserver", dns);
 	}
 
-	if (strlen(resp) == 0)
-		goto done;
-
-	resp[strlen(resp) - 1] = '\0';  /* Remove the last line feed */
-
-	token = strtok(resp, delim);
-	/* Walk through other tokens */
-	while (token && i < MAX_DNS_ADDRESSES) {
-		snprintf(dns_str, sizeof(dns_str), "%s", token);
-		if (inet_aton(dns_str, &iaddr)) {
-			if (i == 0)
-				memcpy(dns1, &iaddr, IPV4_GROUPS);
-			else
-				memcpy(dns2, &iaddr, IPV4_GROUPS);
-		} else {
-			log_debug("%s: Unable to convert '%s' into a valid IP",
-				  __func__, dns_str);
-		}
-		i += 1;
-		token = strtok(NULL, delim);
+	if (n <= 0) {
+		log_debug("%s: %s '%s'", __func__,
+			  ldx_net_code_to_str(NET_STATE_ERROR_DNS), net_state->name);
+		return NET_STATE_ERROR_DNS;
 	}
-	ret = NET_STATE_ERROR_NONE;
 
-done:
-	free(nm_name);
-	free(cmd);
-	free(resp);
+	memcpy(net_state->dns1, dns[0], IPV4_GROUPS);
+	memcpy(net_state->dns2, dns[1], IPV4_GROUPS);
 
-	return ret;
+	return NET_STATE_ERROR_NONE;
 }
 
 /**
- * get_gateway() - Get the gateway address of the given interface
+ * stats_query_t - Query of the statistics of an interface
  *
- * @iface_name:	Name of the network interface to retrieve its gateway address.
- * @gateway:	Pointer to store the gateway address.
+ * @index:	Index of the interface.
+ * @stats:	Statistics to fill.
+ * @found:	True once the statistics were received.
+ */
+typedef struct {
+	int index;
+	net_stats_t *stats;
+	bool found;
+} stats_query_t;
+
+/**
+ * link_stats_cb() - Fill the statistics of an interface from a RTM_NEWLINK
+ *		     message
  *
- * Return: NET_STATE_ERROR_NONE on success, NET_STATE_ERROR_GATEWAY or
- * NET_STATE_ERROR_NO_MEM otherwise.
+ * @nlh:	The netlink message.
+ * @arg:	The query (stats_query_t *).
+ *
+ * Return: 0 always.
  */
-static net_state_error_t get_gateway(const char *iface_name, uint8_t (*gateway)[IPV4_GROUPS])
+static int link_stats_cb(struct nlmsghdr *nlh, void *arg)
 {
-	struct in_addr iaddr;
-	char *cmd = NULL, *resp = NULL;
-	int len;
-	net_state_error_t ret = NET_STATE_ERROR_GATEWAY;
-
-	len = snprintf(NULL, 0, CMD_GET_GATEWAY, iface_name);
-	cmd = calloc(len + 1, sizeof(*cmd));
-	if (cmd == NULL) {
-		ret = NET_STATE_ERROR_NO_MEM;
-		log_debug("%s: Unable to get '%s' gateway: %s", __func__,
-			  iface_name, ldx_net_code_to_str(ret));
-		return ret;
-	}
+	stats_query_t *query = arg;
+	struct ifinfomsg *ifi = NLMSG_DATA(nlh);
+	struct rtattr *tb[IFLA_MAX + 1];
+	size_t len;
 
-	sprintf(cmd, CMD_GET_GATEWAY, iface_name);
-
-	if (ldx_process_execute_cmd(cmd, &resp, 2) != 0 || resp == NULL) {
-		if (resp != NULL)
-			log_debug("%s: %s '%s': %s", __func__,
-				  ldx_net_code_to_str(ret), iface_name, resp);
-		else
-			log_debug("%s: %s '%s'", __func__,
-				  ldx_net_code_to_str(ret), iface_name);
-		goto done;
-	}
+	if (nlh->nlmsg_type != RTM_NEWLINK || ifi->ifi_index != query->index)
+		return 0;
 
-	if (strlen(resp) > 0)
-		resp[strlen(resp) - 1] = '\0';  /* Remove the last line feed */
+	nl_parse_attrs(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(nlh));
+	if (tb[IFLA_STATS] == NULL)
+		return 0;
 
-	if (!inet_aton(resp, &iaddr)) {
-		log_debug("%s: %s '%s': Invalid IP", __func__,
-			  ldx_net_code_to_str(ret), iface_name);
-		goto done;
-	}
-
-	memcpy(gateway, &iaddr, IPV4_GROUPS);
-	ret = NET_STATE_ERROR_NONE;
-
-done:
-	free(cmd);
-	free(resp);
+	len = RTA_PAYLOAD(tb[IFLA_STATS]);
+	memcpy(query->stats, RTA_DATA(tb[IFLA_STATS]),
+	       len < sizeof(net_stats_t) ? len : sizeof(net_stats_t));
+	query->found = true;
 
-	return ret;
+	return 0;
 }
 
-static net_status_t get_device_status(const char *iface_name)
-{
-	net_status_t status = NET_STATUS_UNKNOWN;
-	char *cmd = NULL, *resp = NULL;
-	char *nm_name = NULL, *iname = (char *)iface_name;
-	int rc;
-
-	if (_get_nm_dev_name(iface_name, &nm_name) == 0)
-		iname = nm_name;
+/**
+ * stats_snapshot_internal_t - Data of a statistics snapshot for internal use
+ *
+ * @nl:		Socket kept open between snapshots.
+ * @capacity:	Number of entries allocated in the 'ifaces' array.
+ * @snapshot:	The snapshot being filled.
+ * @no_mem:	True if some interfaces did not fit in the array.
+ */
+typedef struct {
+	nl_sock_t nl;
+	unsigned int capacity;
+	net_stats_snapshot_t *snapshot;
+	bool no_mem;
+} stats_snapshot_internal_t;
 
-	rc = snprintf(NULL, 0, CMD_IFACE_STATE, iname);
-	cmd = calloc(rc + 1, sizeof(*cmd));
-	if (cmd == NULL) {
-		log_debug("%s: Unable to determine if '%s' is configurable: Out of memory",
-			  __func__, iface_name);
-		return NET_STATUS_UNKNOWN;
+/**
+ * snapshot_cb() - Add the statistics of an interface to a snapshot from a
+ *		   RTM_NEWLINK message
+ *
+ * @nlh:	The netlink message.
+ * @arg:	The snapshot (stats_snapshot_internal_t *).
+ *
+ * Return: 0 always.
+ */
+static int snapshot_cb(struct nlmsghdr *nlh, void *arg)
+{
+	stats_snapshot_internal_t *_snap = arg;
+	net_stats_snapshot_t *snapshot = _snap->snapshot;
+	struct ifinfomsg *ifi = NLMSG_DATA(nlh);
+	struct rtattr *tb[IFLA_MAX + 1];
+	net_iface_stats_t *entry;
+
+	if (nlh->nlmsg_type != RTM_NEWLINK)
+		return 0;
+
+	if (snapshot->n_ifaces == _snap->capacity) {
+		unsigned int capacity = _snap->capacity ? _snap->capacity * 2 : MAX_NET_IFACES;
+		net_iface_stats_t *tmp;
+
+		tmp = realloc(snapshot->ifaces, capacity * sizeof(*tmp));
+		if (tmp == NULL) {
+			_snap->no_mem = true;
+			return 0;
+		}
+		snapshot->ifaces = tmp;
+		_snap->capacity = capacity;
 	}
 
-	sprintf(cmd, CMD_IFACE_STATE, iname);
-	rc = ldx_process_execute_cmd(cmd, &resp, 2);
-	if (rc != 0) {
-		if (rc == 127) /* Command not found */
-			log_debug("%s: 'nmcli' not found", __func__);
-		else if (resp != NULL)
-			log_debug("%s: Unable to determine if '%s' is configurable: %s",
-				  __func__, iface_name, resp);
-		else
-			log_debug("%s: Unable to determine if '%s' is configurable",
-				  __func__, iface_name);
-		goto done;
-	}
+	nl_parse_attrs(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(nlh));
 
-	if (strlen(resp) == 0)
-		goto done;
+	entry = &snapshot->ifaces[snapshot->n_ifaces++];
+	memset(entry, 0, sizeof(*entry));
+	entry->index = ifi->ifi_index;
+	if (tb[IFLA_IFNAME] != NULL)
+		strncpy(entry->name, RTA_DATA(tb[IFLA_IFNAME]), IFNAMSIZ - 1);
 
-	resp[strlen(resp) - 1] = '\0';  /* Remove the last line feed */
-	if (strcmp(resp, "connected") == 0)
-		status = NET_STATUS_CONNECTED;
-	else if (strcmp(resp, "disconnected") == 0)
-		status = NET_STATUS_DISCONNECTED;
-	else if (strcmp(resp, "unmanaged") == 0)
-		status = NET_STATUS_UNMANAGED;
-	else if (strcmp(resp, "unavailable") == 0)
-		status = NET_STATUS_UNAVAILABLE;
+	if (tb[IFLA_STATS64] != NULL) {
+		size_t len = RTA_PAYLOAD(tb[IFLA_STATS64]);
 
-done:
-	free(nm_name);
-	free(cmd);
-	free(resp);
+		/* The attribute is only 4-byte aligned */
+		memcpy(&entry->stats, RTA_DATA(tb[IFLA_STATS64]),
+		       len < sizeof(net_stats64_t) ? len : sizeof(net_stats64_t));
+	} else if (tb[IFLA_STATS] != NULL) {
+		const uint32_t *src = RTA_DATA(tb[IFLA_STATS]);
+		uint64_t *dst = (uint64_t *)&entry->stats;
+		size_t i, n = RTA_PAYLOAD(tb[IFLA_STATS]) / sizeof(uint32_t);
+
+		for (i = 0; i < n && i < sizeof(net_stats64_t) / sizeof(uint64_t); i++)
+			dst[i] = src[i];
+	}
 
-	return status;
+	return 0;
 }
 
 const char *ldx_net_code_to_str(net_state_error_t code)
@@ -501,16 +727,22 @@ int ldx_net_list_available_ifaces(net_names_list_t *iface_list)
 
 net_state_error_t ldx_net_get_iface_state(const char *iface_name, net_state_t *net_state)
 {
-	struct ifreq ifr;
+	struct {
+		struct nlmsghdr nlh;
+		struct ifinfomsg ifi;
+	} req;
 	net_state_error_t ret = NET_STATE_ERROR_NONE, tmp_ret;
-	short flags = 0;
-	int sock = -1;
+	nl_iface_t iface;
+	nl_sock_t nl;
+	int index = 0;
 
 	memset(net_state, 0, sizeof(*net_state));
 	net_state->status = NET_STATUS_UNKNOWN;
 	net_state->is_dhcp = NET_ENABLED_ERROR;
 
-	if (!ldx_net_iface_exists(iface_name)) {
+	if (iface_name != NULL && strlen(iface_name) > 0)
+		index = if_nametoindex(iface_name);
+	if (index == 0) {
 		ret = NET_STATE_ERROR_NO_EXIST;
 		log_debug("%s: Unable to get state for '%s': %s",
 			  __func__, iface_name, ldx_net_code_to_str(ret));
@@ -520,118 +752,217 @@ net_state_error_t ldx_net_get_iface_state(const char *iface_name, net_state_t *n
 	/* Fill interface name */
 	strncpy(net_state->name, iface_name, IFNAMSIZ - 1);
 
-	sock = get_socket("get state", iface_name);
-	if (sock == -1)
+	if (nl_open(&nl, NETLINK_ROUTE, 0) != EXIT_SUCCESS)
 		return NET_STATE_ERROR_STATE;
 
-	/* Get MAC address */
-	ret = _get_mac(iface_name, &net_state->mac, sock);
-
-	/* Get flags */
-	memset(&ifr, 0, sizeof(ifr));
-	if (net_ioctl(sock, iface_name, SIOCGIFFLAGS, &ifr) >= 0) {
-		flags = ifr.ifr_flags;
-	} else {
-		log_debug("%s: Unable to get flags of interface '%s': %s (%d)",
-			  __func__, iface_name, strerror(errno), errno);
+	memset(&iface, 0, sizeof(iface));
+	iface.index = index;
+	iface.state = net_state;
+
+	/* Get flags, MAC and MTU */
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+	req.nlh.nlmsg_type = RTM_GETLINK;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST;
+	req.ifi.ifi_family = AF_UNSPEC;
+	req.ifi.ifi_index = index;
+	if (nl_request(&nl, &req.nlh, link_cb, &iface) != EXIT_SUCCESS || !iface.found) {
+		ret = NET_STATE_ERROR_STATE;
+		log_debug("%s: %s '%s': %s (%d)", __func__, ldx_net_code_to_str(ret),
+			  iface_name, strerror(errno), errno);
+		goto done;
 	}
 
-	net_state->status = get_device_status(iface_name);
-	if (net_state->status == NET_STATUS_CONNECTED
-		|| net_state->status == NET_STATUS_UNMANAGED
-		|| flags & IFF_LOOPBACK) {
-		/* Get IP */
-		tmp_ret = _get_ip(iface_name, &net_state->ipv4, sock);
-		if (ret == NET_STATE_ERROR_NONE)
-			ret = tmp_ret;
-
-		if (tmp_ret == NET_STATE_ERROR_NONE && _is_valid_ip(net_state->ipv4)) {
-			/* Get Broadcast address */
-			memset(&ifr, 0, sizeof(ifr));
-			if (net_ioctl(sock, iface_name, SIOCGIFBRDADDR, &ifr) >= 0) {
-				struct sockaddr_in *sa = (struct sockaddr_in *) &ifr.ifr_broadaddr;
-
-				memcpy(net_state->broadcast, &(sa->sin_addr), IPV4_GROUPS);
-			}
+	/* Get IP, netmask and broadcast address */
+	if (nl_dump(&nl, RTM_GETADDR, AF_INET, addr_cb, &iface) != EXIT_SUCCESS) {
+		ret = NET_STATE_ERROR_IP;
+		log_debug("%s: %s '%s': %s (%d)", __func__, ldx_net_code_to_str(ret),
+			  iface_name, strerror(errno), errno);
+	}
 
-			/* Get netmask */
-			memset(&ifr, 0, sizeof(ifr));
-			if (net_ioctl(sock, iface_name, SIOCGIFNETMASK, &ifr) >= 0) {
-				struct sockaddr_in *sa = (struct sockaddr_in *) &ifr.ifr_netmask;
+	net_state->status = get_status(&iface);
 
-				memcpy(net_state->netmask, &(sa->sin_addr), IPV4_GROUPS);
-			}
-		}
-
-		if (!(flags & IFF_LOOPBACK)) {
-			tmp_ret = get_gateway(iface_name, &net_state->gateway);
-			if (ret == NET_STATE_ERROR_NONE)
-				ret = tmp_ret;
-			tmp_ret = get_dns(iface_name, &net_state->dns1, &(net_state->dns2));
+	if (net_state->status == NET_STATUS_CONNECTED && !(iface.flags & IFF_LOOPBACK)) {
+		/* Get gateway */
+		if (nl_dump(&nl, RTM_GETROUTE, AF_INET, route_cb, &iface) != EXIT_SUCCESS
+		    || !iface.has_gw) {
+			log_debug("%s: %s '%s'", __func__,
+				  ldx_net_code_to_str(NET_STATE_ERROR_GATEWAY), iface_name);
 			if (ret == NET_STATE_ERROR_NONE)
-				ret = tmp_ret;
-			net_state->is_dhcp = is_dhcp(iface_name);
+				ret = NET_STATE_ERROR_GATEWAY;
 		}
-	}
 
-	/* Get MTU */
-	tmp_ret = _get_mtu(iface_name, &net_state->mtu, sock);
-	if (ret == NET_STATE_ERROR_NONE)
-		ret = tmp_ret;
+		tmp_ret = get_dns(index, net_state);
+		if (ret == NET_STATE_ERROR_NONE)
+			ret = tmp_ret;
+
+		net_state->is_dhcp = get_dhcp(&iface);
+	}
 
-	if (sock >= 0)
-		close(sock);
+done:
+	nl_close(&nl);
 
 	return ret;
 }
 
 net_state_error_t ldx_net_get_iface_stats(const char *iface_name, net_stats_t *net_stats)
 {
-	struct ifaddrs *ifaddr = NULL, *ifa = NULL;
-	net_state_error_t ret = NET_STATE_ERROR_STATS;
+	struct {
+		struct nlmsghdr nlh;
+		struct ifinfomsg ifi;
+	} req;
+	net_state_error_t ret = NET_STATE_ERROR_NONE;
+	stats_query_t query;
+	nl_sock_t nl;
+	int index = 0;
 
 	memset(net_stats, 0, sizeof(*net_stats));
 
-	if (!ldx_net_iface_exists(iface_name)) {
+	if (iface_name != NULL && strlen(iface_name) > 0)
+		index = if_nametoindex(iface_name);
+	if (index == 0) {
 		ret = NET_STATE_ERROR_NO_EXIST;
 		log_debug("%s: Unable to get network statistics of '%s': %s",
 			  __func__, iface_name, ldx_net_code_to_str(ret));
 		return ret;
 	}
 
-	if (getifaddrs(&ifaddr) == -1) {
-		ret = NET_STATE_ERROR_NO_IFACES;
+	if (nl_open(&nl, NETLINK_ROUTE, 0) != EXIT_SUCCESS)
+		return NET_STATE_ERROR_STATS;
+
+	memset(&query, 0, sizeof(query));
+	query.index = index;
+	query.stats = net_stats;
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+	req.nlh.nlmsg_type = RTM_GETLINK;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST;
+	req.ifi.ifi_family = AF_UNSPEC;
+	req.ifi.ifi_index = index;
+	if (nl_request(&nl, &req.nlh, link_stats_cb, &query) != EXIT_SUCCESS || !query.found) {
+		ret = NET_STATE_ERROR_STATS;
+		log_debug("%s: %s '%s'", __func__, ldx_net_code_to_str(ret),
+			  iface_name);
+	}
+
+	nl_close(&nl);
+
+	return ret;
+}
+
+net_state_error_t ldx_net_get_all_stats(net_stats_snapshot_t *snapshot)
+{
+	stats_snapshot_internal_t *_snap;
+	struct timespec now;
+
+	if (snapshot == NULL)
+		return NET_STATE_ERROR_STATS;
+
+	_snap = snapshot->_data;
+	if (_snap == NULL) {
+		_snap = calloc(1, sizeof(*_snap));
+		if (_snap == NULL) {
+			log_debug("%s: %s", __func__,
+				  ldx_net_code_to_str(NET_STATE_ERROR_NO_MEM));
+			return NET_STATE_ERROR_NO_MEM;
+		}
+		if (nl_open(&_snap->nl, NETLINK_ROUTE, 0) != EXIT_SUCCESS) {
+			free(_snap);
+			return NET_STATE_ERROR_STATS;
+		}
+		snapshot->_data = _snap;
+	}
+
+	_snap->snapshot = snapshot;
+	_snap->no_mem = false;
+	snapshot->n_ifaces = 0;
+
+	if (nl_dump(&_snap->nl, RTM_GETLINK, AF_UNSPEC, snapshot_cb, _snap) != EXIT_SUCCESS) {
 		log_debug("%s: %s: %s (%d)", __func__,
-			  ldx_net_code_to_str(ret), strerror(errno), errno);
-		return ret;
+			  ldx_net_code_to_str(NET_STATE_ERROR_NO_IFACES),
+			  strerror(errno), errno);
+		return NET_STATE_ERROR_NO_IFACES;
 	}
 
-	for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
-		struct rtnl_link_stats *stats = NULL;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	snapshot->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
 
-		if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_PACKET)
-			continue;
+	if (_snap->no_mem) {
+		log_debug("%s: %s", __func__, ldx_net_code_to_str(NET_STATE_ERROR_NO_MEM));
+		return NET_STATE_ERROR_NO_MEM;
+	}
 
-		if (strncmp(iface_name, ifa->ifa_name, strlen(iface_name)) != 0
-			|| ifa->ifa_addr == NULL)
-			continue;
+	return NET_STATE_ERROR_NONE;
+}
 
-		if (ifa->ifa_data == NULL) {
-			log_debug("%s: %s '%s'", __func__,
-				  ldx_net_code_to_str(ret), iface_name);
-			goto done;
-		}
+void ldx_net_free_stats_snapshot(net_stats_snapshot_t *snapshot)
+{
+	stats_snapshot_internal_t *_snap;
 
-		stats = ifa->ifa_data;
-		memcpy(net_stats, stats, sizeof(*stats));
-		break;
+	if (snapshot == NULL)
+		return;
+
+	_snap = snapshot->_data;
+	if (_snap != NULL) {
+		nl_close(&_snap->nl);
+		free(_snap);
 	}
-	ret = NET_STATE_ERROR_NONE;
-done:
-	if (ifaddr != NULL)
-		freeifaddrs(ifaddr);
 
-	return ret;
+	free(snapshot->ifaces);
+	memset(snapshot, 0, sizeof(*snapshot));
+}
+
+net_state_error_t ldx_net_get_stats_rate(const net_stats_snapshot_t *prev,
+					 const net_stats_snapshot_t *cur,
+					 unsigned int index, net_stats_rate_t *rate)
+{
+	const net_iface_stats_t *now, *before = NULL;
+	const uint64_t *a, *b;
+	uint64_t *d;
+	unsigned int i;
+	double secs;
+
+	if (prev == NULL || cur == NULL || rate == NULL || index >= cur->n_ifaces)
+		return NET_STATE_ERROR_STATS;
+
+	memset(rate, 0, sizeof(*rate));
+
+	now = &cur->ifaces[index];
+
+	/* Interfaces are usually dumped in the same order */
+	if (index < prev->n_ifaces && prev->ifaces[index].index == now->index) {
+		before = &prev->ifaces[index];
+	} else {
+		for (i = 0; i < prev->n_ifaces; i++) {
+			if (prev->ifaces[i].index == now->index) {
+				before = &prev->ifaces[i];
+				break;
+			}
+		}
+	}
+
+	if (before == NULL)
+		return NET_STATE_ERROR_NO_EXIST;
+
+	/* All the counters are uint64_t, walk them as an array */
+	a = (const uint64_t *)&before->stats;
+	b = (const uint64_t *)&now->stats;
+	d = (uint64_t *)&rate->delta;
+	for (i = 0; i < sizeof(net_stats64_t) / sizeof(uint64_t); i++)
+		d[i] = b[i] >= a[i] ? b[i] - a[i] : b[i];
+
+	if (cur->timestamp_ns <= prev->timestamp_ns)
+		return NET_STATE_ERROR_NONE;
+
+	rate->interval_ns = cur->timestamp_ns - prev->timestamp_ns;
+	secs = rate->interval_ns / 1e9;
+	rate->rx_bytes_rate = rate->delta.rx_bytes / secs;
+	rate->tx_bytes_rate = rate->delta.tx_bytes / secs;
+	rate->rx_packets_rate = rate->delta.rx_packets / secs;
+	rate->tx_packets_rate = rate->delta.tx_packets / secs;
+
+	return NET_STATE_ERROR_NONE;
 }
 
 net_state_error_t ldx_net_set_config(net_config_t net_cfg)
@@ -677,3 +1008,702 @@ done:
 
 	return ret;
 }
+
+/**
+ * net_cache_entry_t - Cached state of a network interface
+ *
+ * @list:		Entry in the cache.
+ * @iface:		Data of the interface collected from rtnetlink.
+ * @raw:		State filled from the rtnetlink messages.
+ * @state:		State reported to the applications.
+ * @dirty:		True if 'raw' changed since 'state' was built.
+ * @is_new:		True until the appearance of the interface is notified.
+ * @removed:		True if the interface disappeared.
+ * @resync_addr:	True to dump the addresses again, the cached one was
+ *			removed.
+ * @resync_route:	True to dump the routes again, the cached gateway was
+ *			removed.
+ */
+typedef struct {
+	struct list_head list;
+	nl_iface_t iface;
+	net_state_t raw;
+	net_state_t state;
+	bool dirty;
+	bool is_new;
+	bool removed;
+	bool resync_addr;
+	bool resync_route;
+} net_cache_entry_t;
+
+/**
+ * net_change_cb_entry_t - A registered network change callback
+ *
+ * @list:	Entry in the list of callbacks.
+ * @cb:		The function to call.
+ * @arg:	Argument to pass to the function.
+ */
+typedef struct {
+	struct list_head list;
+	ldx_net_change_cb_t cb;
+	void *arg;
+} net_change_cb_entry_t;
+
+/**
+ * net_monitor_t - Network change monitor
+ *
+ * @state_lock:	Serializes starting and stopping the monitor.
+ * @cb_lock:	Protects the list of callbacks.
+ * @cache_lock:	Protects the cache entries.
+ * @callbacks:	List of registered callbacks.
+ * @entries:	Cached interfaces.
+ * @events:	Socket subscribed to the notifications.
+ * @requests:	Socket for the dumps.
+ * @thread:	Monitor thread.
+ * @running:	True while the monitor thread exists, protected by
+ *		'cache_lock'.
+ * @failed:	True if the monitor thread stopped on an error, so the cache
+ *		is no longer updated. Protected by 'cache_lock'.
+ * @stop_fd:	Event descriptor to stop the monitor thread.
+ */
+typedef struct {
+	pthread_mutex_t state_lock;
+	pthread_mutex_t cb_lock;
+	pthread_mutex_t cache_lock;
+	struct list_head callbacks;
+	struct list_head entries;
+	nl_sock_t events;
+	nl_sock_t requests;
+	pthread_t thread;
+	bool running;
+	bool failed;
+	int stop_fd;
+} net_monitor_t;
+
+static net_monitor_t monitor = {
+	.state_lock = PTHREAD_MUTEX_INITIALIZER,
+	.cb_lock = PTHREAD_MUTEX_INITIALIZER,
+	.cache_lock = PTHREAD_MUTEX_INITIALIZER,
+	.callbacks = LIST_HEAD_INIT(monitor.callbacks),
+	.entries = LIST_HEAD_INIT(monitor.entries),
+	.stop_fd = -1,
+};
+
+/**
+ * get_cache_entry() - Find the cache entry of an interface
+ *
+ * @index:	Index of the interface.
+ * @create:	True to create the entry if it does not exist.
+ *
+ * Return: The entry, NULL if not found or it cannot be created.
+ */
+static net_cache_entry_t *get_cache_entry(int index, bool create)
+{
+	net_cache_entry_t *entry;
+
+	list_for_each_entry(entry, &monitor.entries, list) {
+		if (entry->iface.index == index)
+			return entry;
+	}
+
+	if (!create)
+		return NULL;
+
+	entry = calloc(1, sizeof(*entry));
+	if (entry == NULL) {
+		log_error("%s: Unable to cache interface %d, cannot allocate memory",
+			  __func__, index);
+		return NULL;
+	}
+
+	entry->iface.index = index;
+	entry->iface.state = &entry->raw;
+	entry->raw.status = NET_STATUS_UNKNOWN;
+	entry->raw.is_dhcp = NET_ENABLED_ERROR;
+	entry->state = entry->raw;
+	entry->is_new = true;
+
+	pthread_mutex_lock(&monitor.cache_lock);
+	list_add_tail(&entry->list, &monitor.entries);
+	pthread_mutex_unlock(&monitor.cache_lock);
+
+	return entry;
+}
+
+/**
+ * get_ifa_address() - Get the address of a RTM_NEWADDR/RTM_DELADDR message
+ *
+ * @nlh:	The netlink message.
+ *
+ * Return: The address, NULL if the message has none.
+ */
+static const uint8_t *get_ifa_address(struct nlmsghdr *nlh)
+{
+	struct ifaddrmsg *ifa = NLMSG_DATA(nlh);
+	struct rtattr *tb[IFA_MAX + 1];
+
+	nl_parse_attrs(tb, IFA_MAX, IFA_RTA(ifa), IFA_PAYLOAD(nlh));
+	if (tb[IFA_LOCAL] != NULL)
+		return RTA_DATA(tb[IFA_LOCAL]);
+	if (tb[IFA_ADDRESS] != NULL)
+		return RTA_DATA(tb[IFA_ADDRESS]);
+
+	return NULL;
+}
+
+/**
+ * monitor_msg_cb() - Update the cache from a rtnetlink message
+ *
+ * @nlh:	The netlink message, a notification or part of a dump.
+ * @arg:	Unused.
+ *
+ * Return: 0 always.
+ */
+static int monitor_msg_cb(struct nlmsghdr *nlh, void *arg)
+{
+	net_cache_entry_t *entry;
+
+	(void)arg;
+
+	switch (nlh->nlmsg_type) {
+	case RTM_NEWLINK:
+	case RTM_DELLINK: {
+		struct ifinfomsg *ifi = NLMSG_DATA(nlh);
+
+		entry = get_cache_entry(ifi->ifi_index, nlh->nlmsg_type == RTM_NEWLINK);
+		if (entry == NULL)
+			break;
+
+		if (nlh->nlmsg_type == RTM_DELLINK)
+			entry->removed = true;
+		else
+			link_cb(nlh, &entry->iface);
+		entry->dirty = true;
+		break;
+	}
+	case RTM_NEWADDR:
+	case RTM_DELADDR: {
+		struct ifaddrmsg *ifa = NLMSG_DATA(nlh);
+		const uint8_t *addr;
+
+		if (ifa->ifa_family != AF_INET)
+			break;
+
+		entry = get_cache_entry(ifa->ifa_index, false);
+		addr = get_ifa_address(nlh);
+		if (entry == NULL || addr == NULL)
+			break;
+
+		/* Only the cached primary address is tracked */
+		if (entry->iface.has_ip && memcmp(addr, entry->raw.ipv4, IPV4_GROUPS) != 0)
+			break;
+
+		if (nlh->nlmsg_type == RTM_DELADDR) {
+			/* Another address may be the primary one now */
+			entry->resync_addr = true;
+		} else {
+			entry->iface.has_ip = false;
+			addr_cb(nlh, &entry->iface);
+		}
+		entry->dirty = true;
+		break;
+	}
+	case RTM_NEWROUTE:
+	case RTM_DELROUTE: {
+		struct rtmsg *rtm = NLMSG_DATA(nlh);
+		struct rtattr *tb[RTA_MAX + 1];
+
+		if (rtm->rtm_family != AF_INET || rtm->rtm_dst_len != 0)
+			break;
+
+		nl_parse_attrs(tb, RTA_MAX, RTM_RTA(rtm), RTM_PAYLOAD(nlh));
+		if (tb[RTA_OIF] == NULL || tb[RTA_GATEWAY] == NULL)
+			break;
+
+		entry = get_cache_entry(*(int *)RTA_DATA(tb[RTA_OIF]), false);
+		if (entry == NULL)
+			break;
+
+		if (nlh->nlmsg_type == RTM_NEWROUTE) {
+			route_cb(nlh, &entry->iface);
+		} else if (entry->iface.has_gw
+			   && memcmp(RTA_DATA(tb[RTA_GATEWAY]), entry->raw.gateway,
+				     IPV4_GROUPS) == 0) {
+			/* Another default route may be used now */
+			entry->resync_route = true;
+		}
+		entry->dirty = true;
+		break;
+	}
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/**
+ * reset_addr() - Forget the address data of a cached interface
+ *
+ * @entry:	The cache entry.
+ */
+static void reset_addr(net_cache_entry_t *entry)
+{
+	entry->iface.has_ip = false;
+	entry->iface.dynamic_ip = false;
+	memset(entry->raw.ipv4, 0, IPV4_GROUPS);
+	memset(entry->raw.netmask, 0, IPV4_GROUPS);
+	memset(entry->raw.broadcast, 0, IPV4_GROUPS);
+}
+
+/**
+ * reset_route() - Forget the gateway of a cached interface
+ *
+ * @entry:	The cache entry.
+ */
+static void reset_route(net_cache_entry_t *entry)
+{
+	entry->iface.has_gw = false;
+	entry->iface.dhcp_gw = false;
+	entry->iface.gw_metric = 0;
+	memset(entry->raw.gateway, 0, IPV4_GROUPS);
+}
+
+/**
+ * build_state() - Build the reported state of a cached interface
+ *
+ * @entry:	The cache entry.
+ * @state:	Where to store the state.
+ *
+ * Applies the same rules as 'ldx_net_get_iface_state()': gateway, DNS and
+ * DHCP are only reported for connected interfaces other than loopback. The
+ * DNS servers are kept from the current reported state.
+ */
+static void build_state(net_cache_entry_t *entry, net_state_t *state)
+{
+	*state = entry->raw;
+	state->status = get_status(&entry->iface);
+
+	if (state->status != NET_STATUS_CONNECTED || entry->iface.flags & IFF_LOOPBACK) {
+		memset(state->gateway, 0, IPV4_GROUPS);
+		memset(state->dns1, 0, IPV4_GROUPS);
+		memset(state->dns2, 0, IPV4_GROUPS);
+		state->is_dhcp = NET_ENABLED_ERROR;
+		return;
+	}
+
+	memcpy(state->dns1, entry->state.dns1, IPV4_GROUPS);
+	memcpy(state->dns2, entry->state.dns2, IPV4_GROUPS);
+	state->is_dhcp = get_dhcp(&entry->iface);
+}
+
+/**
+ * diff_states() - Compare two states of an interface
+ *
+ * @a:	A state.
+ * @b:	Another state.
+ *
+ * Return: Bitmask of the changes between the states (net_change_t).
+ */
+static unsigned int diff_states(const net_state_t *a, const net_state_t *b)
+{
+	unsigned int changes = 0;
+
+	if (strcmp(a->name, b->name) != 0 || a->status != b->status
+	    || memcmp(a->mac, b->mac, MAC_ADDRESS_GROUPS) != 0 || a->mtu != b->mtu)
+		changes |= NET_CHANGE_LINK;
+
+	if (memcmp(a->ipv4, b->ipv4, IPV4_GROUPS) != 0
+	    || memcmp(a->netmask, b->netmask, IPV4_GROUPS) != 0
+	    || memcmp(a->broadcast, b->broadcast, IPV4_GROUPS) != 0
+	    || a->is_dhcp != b->is_dhcp)
+		changes |= NET_CHANGE_ADDR;
+
+	if (memcmp(a->gateway, b->gateway, IPV4_GROUPS) != 0)
+		changes |= NET_CHANGE_ROUTE;
+
+	if (memcmp(a->dns1, b->dns1, IPV4_GROUPS) != 0
+	    || memcmp(a->dns2, b->dns2, IPV4_GROUPS) != 0)
+		changes |= NET_CHANGE_DNS;
+
+	return changes;
+}
+
+/**
+ * notify_change() - Call the registered callbacks
+ *
+ * @state:	The new state of the interface.
+ * @changes:	Bitmask of the changes (net_change_t).
+ */
+static void notify_change(const net_state_t *state, unsigned int changes)
+{
+	net_change_cb_entry_t *cb_entry;
+
+	pthread_mutex_lock(&monitor.cb_lock);
+	list_for_each_entry(cb_entry, &monitor.callbacks, list)
+		cb_entry->cb(state, changes, cb_entry->arg);
+	pthread_mutex_unlock(&monitor.cb_lock);
+}
+
+/**
+ * monitor_flush() - Publish the changes of the cached interfaces
+ *
+ * @notify:	True to call the callbacks for the changed interfaces.
+ */
+static void monitor_flush(bool notify)
+{
+	net_cache_entry_t *entry, *tmp;
+
+	list_for_each_entry_safe(entry, tmp, &monitor.entries, list) {
+		net_state_t state;
+		unsigned int changes;
+
+		if (!entry->dirty)
+			continue;
+		entry->dirty = false;
+
+		if (entry->removed) {
+			pthread_mutex_lock(&monitor.cache_lock);
+			list_del(&entry->list);
+			pthread_mutex_unlock(&monitor.cache_lock);
+			if (notify && !entry->is_new)
+				notify_change(&entry->state, NET_CHANGE_REMOVED);
+			free(entry);
+			continue;
+		}
+
+		if (entry->resync_addr) {
+			entry->resync_addr = false;
+			reset_addr(entry);
+			nl_dump(&monitor.requests, RTM_GETADDR, AF_INET, addr_cb,
+				&entry->iface);
+		}
+
+		if (entry->resync_route) {
+			entry->resync_route = false;
+			reset_route(entry);
+			nl_dump(&monitor.requests, RTM_GETROUTE, AF_INET, route_cb,
+				&entry->iface);
+		}
+
+		build_state(entry, &state);
+		changes = diff_states(&entry->state, &state);
+
+		/* DNS servers are not notified by rtnetlink, refresh them */
+		if ((changes || entry->is_new) && state.status == NET_STATUS_CONNECTED
+		    && !(entry->iface.flags & IFF_LOOPBACK))
+			get_dns(entry->iface.index, &state);
+
+		changes = diff_states(&entry->state, &state);
+		if (entry->is_new)
+			changes |= NET_CHANGE_NEW;
+		entry->is_new = false;
+
+		if (!changes)
+			continue;
+
+		pthread_mutex_lock(&monitor.cache_lock);
+		entry->state = state;
+		pthread_mutex_unlock(&monitor.cache_lock);
+
+		if (notify)
+			notify_change(&state, changes);
+	}
+}
+
+/**
+ * monitor_sync() - Fill the cache from scratch with rtnetlink dumps
+ *
+ * @notify:	True to call the callbacks for the changed interfaces.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int monitor_sync(bool notify)
+{
+	net_cache_entry_t *entry;
+	int ret = EXIT_SUCCESS;
+
+	list_for_each_entry(entry, &monitor.entries, list) {
+		entry->iface.found = false;
+		reset_addr(entry);
+		reset_route(entry);
+	}
+
+	if (nl_dump(&monitor.requests, RTM_GETLINK, AF_UNSPEC, monitor_msg_cb, NULL) != EXIT_SUCCESS
+	    || nl_dump(&monitor.requests, RTM_GETADDR, AF_INET, monitor_msg_cb, NULL) != EXIT_SUCCESS
+	    || nl_dump(&monitor.requests, RTM_GETROUTE, AF_INET, monitor_msg_cb, NULL) != EXIT_SUCCESS) {
+		log_error("%s: Unable to get the network interfaces: %s (%d)",
+			  __func__, strerror(errno), errno);
+		ret = EXIT_FAILURE;
+	}
+
+	list_for_each_entry(entry, &monitor.entries, list) {
+		if (!entry->iface.found)
+			entry->removed = true;
+		entry->dirty = true;
+	}
+
+	monitor_flush(notify);
+
+	return ret;
+}
+
+/**
+ * monitor_thread() - Process the rtnetlink notifications
+ *
+ * @arg:	Unused.
+ *
+ * Return: NULL.
+ */
+static void *monitor_thread(void *arg)
+{
+	struct pollfd pfds[2];
+	bool stopped = false;
+
+	(void)arg;
+
+	pfds[0].fd = monitor.events.fd;
+	pfds[0].events = POLLIN;
+	pfds[1].fd = monitor.stop_fd;
+	pfds[1].events = POLLIN;
+
+	for (;;) {
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: Unable to wait for network changes: %s (%d)",
+				  __func__, strerror(errno), errno);
+			break;
+		}
+
+		if (pfds[1].revents) {
+			stopped = true;
+			break;
+		}
+
+		if (nl_recv(&monitor.events, monitor_msg_cb, NULL) != EXIT_SUCCESS) {
+			if (errno != ENOBUFS) {
+				log_error("%s: Unable to receive network changes: %s (%d)",
+					  __func__, strerror(errno), errno);
+				break;
+			}
+
+			/* Notifications were lost, start over */
+			log_debug("%s: Network notifications lost, synchronizing",
+				  __func__);
+			monitor_sync(true);
+			continue;
+		}
+
+		monitor_flush(true);
+	}
+
+	/* Unless stopped, let the cached queries read the kernel again */
+	pthread_mutex_lock(&monitor.cache_lock);
+	if (!stopped)
+		monitor.failed = true;
+	pthread_mutex_unlock(&monitor.cache_lock);
+
+	return NULL;
+}
+
+/**
+ * monitor_clear_cache() - Free all the cache entries
+ */
+static void monitor_clear_cache(void)
+{
+	net_cache_entry_t *entry, *tmp;
+
+	pthread_mutex_lock(&monitor.cache_lock);
+	list_for_each_entry_safe(entry, tmp, &monitor.entries, list) {
+		list_del(&entry->list);
+		free(entry);
+	}
+	pthread_mutex_unlock(&monitor.cache_lock);
+}
+
+/**
+ * monitor_start() - Start the network change monitor
+ *
+ * Must be called with 'state_lock' held.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int monitor_start(void)
+{
+	/* Subscribe before the dumps, so no change is missed in between */
+	if (nl_open(&monitor.events, NETLINK_ROUTE, RTMGRP_LINK
+		    | RTMGRP_IPV4_IFADDR | RTMGRP_IPV4_ROUTE) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (nl_open(&monitor.requests, NETLINK_ROUTE, 0) != EXIT_SUCCESS)
+		goto err_events;
+
+	monitor.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (monitor.stop_fd < 0) {
+		log_error("%s: Unable to create stop event: %s (%d)", __func__,
+			  strerror(errno), errno);
+		goto err_requests;
+	}
+
+	if (monitor_sync(false) != EXIT_SUCCESS)
+		goto err_cache;
+
+	if (pthread_create(&monitor.thread, NULL, monitor_thread, NULL) != 0) {
+		log_error("%s: Unable to start the network monitor thread", __func__);
+		goto err_cache;
+	}
+
+	pthread_mutex_lock(&monitor.cache_lock);
+	monitor.running = true;
+	monitor.failed = false;
+	pthread_mutex_unlock(&monitor.cache_lock);
+
+	return EXIT_SUCCESS;
+
+err_cache:
+	monitor_clear_cache();
+	close(monitor.stop_fd);
+	monitor.stop_fd = -1;
+err_requests:
+	nl_close(&monitor.requests);
+err_events:
+	nl_close(&monitor.events);
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * monitor_stop() - Stop the network change monitor
+ *
+ * Must be called with 'state_lock' held.
+ */
+static void monitor_stop(void)
+{
+	uint64_t val = 1;
+
+	if (write(monitor.stop_fd, &val, sizeof(val)) < 0)
+		log_error("%s: Unable to stop the network monitor thread: %s (%d)",
+			  __func__, strerror(errno), errno);
+
+	pthread_mutex_lock(&monitor.cache_lock);
+	monitor.running = false;
+	pthread_mutex_unlock(&monitor.cache_lock);
+
+	pthread_join(monitor.thread, NULL);
+
+	monitor_clear_cache();
+	close(monitor.stop_fd);
+	monitor.stop_fd = -1;
+	nl_close(&monitor.requests);
+	nl_close(&monitor.events);
+}
+
+int ldx_net_register_change_cb(ldx_net_change_cb_t cb, void *arg)
+{
+	net_change_cb_entry_t *cb_entry;
+	int ret = EXIT_SUCCESS;
+	bool failed;
+
+	if (cb == NULL) {
+		log_error("%s: Callback cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	cb_entry = calloc(1, sizeof(*cb_entry));
+	if (cb_entry == NULL) {
+		log_error("%s: Unable to register callback, cannot allocate memory",
+			  __func__);
+		return EXIT_FAILURE;
+	}
+
+	cb_entry->cb = cb;
+	cb_entry->arg = arg;
+
+	pthread_mutex_lock(&monitor.state_lock);
+
+	/* Restart the monitor if its thread stopped on an error */
+	pthread_mutex_lock(&monitor.cache_lock);
+	failed = monitor.running && monitor.failed;
+	pthread_mutex_unlock(&monitor.cache_lock);
+	if (failed)
+		monitor_stop();
+
+	if (!monitor.running)
+		ret = monitor_start();
+
+	if (ret == EXIT_SUCCESS) {
+		pthread_mutex_lock(&monitor.cb_lock);
+		list_add_tail(&cb_entry->list, &monitor.callbacks);
+		pthread_mutex_unlock(&monitor.cb_lock);
+	} else {
+		free(cb_entry);
+	}
+
+	pthread_mutex_unlock(&monitor.state_lock);
+
+	return ret;
+}
+
+int ldx_net_unregister_change_cb(ldx_net_change_cb_t cb, void *arg)
+{
+	net_change_cb_entry_t *cb_entry, *tmp;
+	bool found = false, empty;
+
+	pthread_mutex_lock(&monitor.state_lock);
+
+	pthread_mutex_lock(&monitor.cb_lock);
+	list_for_each_entry_safe(cb_entry, tmp, &monitor.callbacks, list) {
+		if (cb_entry->cb == cb && cb_entry->arg == arg) {
+			list_del(&cb_entry->list);
+			free(cb_entry);
+			found = true;
+			break;
+		}
+	}
+	empty = list_empty(&monitor.callbacks);
+	pthread_mutex_unlock(&monitor.cb_lock);
+
+	if (found && empty && monitor.running)
+		monitor_stop();
+
+	pthread_mutex_unlock(&monitor.state_lock);
+
+	if (!found) {
+		log_error("%s: Callback not registered", __func__);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+net_state_error_t ldx_net_get_cached_state(const char *iface_name, net_state_t *net_state)
+{
+	net_cache_entry_t *entry;
+	net_state_error_t ret = NET_STATE_ERROR_NO_EXIST;
+
+	if (iface_name == NULL || net_state == NULL)
+		return NET_STATE_ERROR_NO_EXIST;
+
+	pthread_mutex_lock(&monitor.cache_lock);
+
+	if (!monitor.running || monitor.failed) {
+		pthread_mutex_unlock(&monitor.cache_lock);
+		return ldx_net_get_iface_state(iface_name, net_state);
+	}
+
+	list_for_each_entry(entry, &monitor.entries, list) {
+		if (strncmp(entry->state.name, iface_name, IFNAMSIZ) == 0) {
+			*net_state = entry->state;
+			ret = NET_STATE_ERROR_NONE;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&monitor.cache_lock);
+
+	if (ret != NET_STATE_ERROR_NONE)
+		log_debug("%s: Unable to get state for '%s': %s",
+			  __func__, iface_name, ldx_net_code_to_str(ret));
+
+	return ret;
+}
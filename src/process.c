@@ -16,17 +16,26 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
+#include <spawn.h>
+#include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include <sys/wait.h>
 
 #include "_log.h"
 #include "process.h"
 
+#define PROCESS_CHUNK_LEN	4096
+
+extern char **environ;
+
 #define concat_va_list(arg) __extension__({		\
 	__typeof__(arg) *_l;				\
 	va_list _ap;					\
@@ -134,51 +143,331 @@ int ldx_process_execute_cmd(const char *cmd, char **resp, int timeout)
 	return rc;
 }
 
+/*
+ * spawn_fd_action() - Add the file actions to use a descriptor in the child
+ *
+ * @actions:	Spawn file actions.
+ * @fd:		Descriptor to use, -1 to use '/dev/null'.
+ * @target:	Descriptor of the child (STDIN_FILENO, STDOUT_FILENO, ...).
+ * @flags:	Flags to open '/dev/null'.
+ *
+ * Return: 0 on success, an error number otherwise.
+ */
+static int spawn_fd_action(posix_spawn_file_actions_t *actions, int fd,
+			   int target, int flags)
+{
+	if (fd < 0)
+		return posix_spawn_file_actions_addopen(actions, target,
+							"/dev/null", flags, 0);
+
+	/* dup2() to itself does not clear FD_CLOEXEC, do it here */
+	if (fd == target)
+		return fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) & ~FD_CLOEXEC) < 0 ?
+			errno : 0;
+
+	return posix_spawn_file_actions_adddup2(actions, fd, target);
+}
+
+/*
+ * spawn_fd() - Spawn a process with the given standard descriptors
+ *
+ * @argv:	NULL terminated list with the command and its arguments.
+ * @infd:	File descriptor for the process input, -1 for '/dev/null'.
+ * @outfd:	File descriptor for the process output, -1 for '/dev/null'.
+ * @errfd:	File descriptor for the process error, -1 for '/dev/null'.
+ *
+ * posix_spawn() does not duplicate the address space of the caller, so
+ * spawning is cheap even from a big process under memory pressure.
+ *
+ * Return: The process identifier, -1 on error.
+ */
+static pid_t spawn_fd(char *const argv[], int infd, int outfd, int errfd)
+{
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t sigdef, sigmask;
+	int fds[] = { infd, outfd, errfd };
+	pid_t pid;
+	int i, j, ret;
+
+	ret = posix_spawn_file_actions_init(&actions);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	ret = posix_spawnattr_init(&attr);
+	if (ret) {
+		posix_spawn_file_actions_destroy(&actions);
+		errno = ret;
+		return -1;
+	}
+
+	ret = spawn_fd_action(&actions, infd, STDIN_FILENO, O_RDONLY);
+	if (!ret)
+		ret = spawn_fd_action(&actions, outfd, STDOUT_FILENO, O_WRONLY);
+	if (!ret)
+		ret = spawn_fd_action(&actions, errfd, STDERR_FILENO, O_WRONLY);
+
+	/* Do not leak the original descriptors to the child */
+	for (i = 0; i < (int)(sizeof(fds) / sizeof(fds[0])) && !ret; i++) {
+		if (fds[i] <= STDERR_FILENO)
+			continue;
+		for (j = 0; j < i && fds[j] != fds[i]; j++)
+			;
+		if (j == i)
+			ret = posix_spawn_file_actions_addclose(&actions, fds[i]);
+	}
+
+	/* Same signal setup as a freshly started process */
+	sigemptyset(&sigdef);
+	sigaddset(&sigdef, SIGPIPE);
+	sigemptyset(&sigmask);
+	if (!ret)
+		ret = posix_spawnattr_setsigdefault(&attr, &sigdef);
+	if (!ret)
+		ret = posix_spawnattr_setsigmask(&attr, &sigmask);
+	if (!ret)
+		ret = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF
+						      | POSIX_SPAWN_SETSIGMASK);
+	if (!ret)
+		ret = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+
+	if (ret) {
+		log_debug("%s: Unable to execute '%s': %s (%d)", __func__,
+			  argv[0], strerror(ret), ret);
+		errno = ret;
+		return -1;
+	}
+
+	return pid;
+}
+
 pid_t _ldx_process_exec_fd(int infd, int outfd, int errfd, const char *cmd, ...)
 {
 	const char **cmd_list = NULL;
-	struct sigaction sa = { .sa_handler = SIG_DFL };
-	pid_t pid;
 	va_list argp;
 
 	va_start(argp, cmd);
 	cmd_list = concat_va_list(cmd);
+	va_end(argp);
+
+	return spawn_fd((char * const *)cmd_list, infd, outfd, errfd);
+}
 
-	pid = fork();
-	if (pid != 0)
-		return pid;
+/*
+ * get_time_ms() - Get the monotonic time in milliseconds
+ *
+ * Return: The time in milliseconds.
+ */
+static int64_t get_time_ms(void)
+{
+	struct timespec ts;
 
-	if (infd < 0)
-		infd = open("/dev/null", O_RDONLY);
-	fcntl(infd, F_SETFD, fcntl(infd, F_GETFD) & ~FD_CLOEXEC);
-	if (infd != STDIN_FILENO) {
-		dup2(infd, STDIN_FILENO);
-		if (infd != outfd && infd != errfd)
-			close(infd);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * get_remaining_ms() - Get the time left until a deadline
+ *
+ * @deadline:	The deadline in milliseconds, 0 for no deadline.
+ *
+ * Return: The milliseconds left (0 if expired), -1 if there is no deadline.
+ */
+static int get_remaining_ms(int64_t deadline)
+{
+	int64_t now;
+
+	if (deadline == 0)
+		return -1;
+
+	now = get_time_ms();
+
+	return now >= deadline ? 0 : (int)(deadline - now);
+}
+
+/*
+ * wait_deadline() - Wait for a process to finish before a deadline
+ *
+ * @pid:	Identifier of the process to wait for.
+ * @deadline:	The deadline in milliseconds, 0 for no deadline.
+ *
+ * The process is killed if it is still running at the deadline.
+ *
+ * Return: The same as 'ldx_process_wait()'.
+ */
+static int wait_deadline(pid_t pid, int64_t deadline)
+{
+	int status, ret = 0;
+
+	while (deadline) {
+		ret = waitpid(pid, &status, WNOHANG);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret != 0)
+			break;
+		if (get_remaining_ms(deadline) == 0) {
+			kill(pid, SIGKILL);
+			break;
+		}
+		poll(NULL, 0, 10);
+	}
+
+	if (deadline && ret == pid) {
+		if (WIFEXITED(status))
+			return WEXITSTATUS(status);
+		else if (WIFSIGNALED(status))
+			return -WTERMSIG(status);
+		else
+			return -258;
+	} else if (deadline && ret < 0) {
+		return -257;
+	}
+
+	return ldx_process_wait(pid);
+}
+
+/*
+ * deliver_lines() - Pass the complete lines of a buffer to a callback
+ *
+ * @buf:	Buffer with the output.
+ * @len:	Number of bytes in the buffer.
+ * @cb:		Callback to pass the lines to.
+ * @arg:	Argument of the callback.
+ * @stop:	Set to true if the callback asks to stop.
+ *
+ * Return: The number of bytes consumed.
+ */
+static size_t deliver_lines(char *buf, size_t len,
+			    const ldx_process_output_cb_t cb, void *arg, bool *stop)
+{
+	char *start = buf, *end;
+
+	while (!*stop && (end = memchr(start, '\n', len - (start - buf))) != NULL) {
+		*end = '\0';
+		*stop = cb(start, end - start, arg) != 0;
+		start = end + 1;
+	}
+
+	return start - buf;
+}
+
+int ldx_process_spawn(char *const argv[], const ldx_process_output_cb_t cb,
+		      void *arg, int flags, int timeout)
+{
+	char *buf = NULL;
+	size_t size = PROCESS_CHUNK_LEN, len = 0;
+	int64_t deadline = 0;
+	int pipefd[2] = { -1, -1 };
+	bool stop = false;
+	pid_t pid;
+
+	if (argv == NULL || argv[0] == NULL || strlen(argv[0]) == 0) {
+		log_error("%s: Invalid command", __func__);
+		return -256;
+	}
+
+	if (timeout < 0) {
+		log_error("%s: Invalid timeout '%d'", __func__, timeout);
+		return -256;
 	}
 
-	if (outfd < 0)
-		outfd = open("/dev/null", O_WRONLY);
-	fcntl(outfd, F_SETFD, fcntl(outfd, F_GETFD) & ~FD_CLOEXEC);
-	if (outfd != STDOUT_FILENO) {
-		dup2(outfd, STDOUT_FILENO);
-		if (outfd != errfd)
-			close(outfd);
+	if (timeout > 0)
+		deadline = get_time_ms() + (int64_t)timeout * 1000;
+
+	if (cb != NULL) {
+		buf = malloc(size + 1);
+		if (buf == NULL) {
+			log_error("%s: Unable to execute '%s': Out of memory",
+				  __func__, argv[0]);
+			return -256;
+		}
+
+		if (pipe2(pipefd, O_CLOEXEC) < 0) {
+			log_error("%s: Unable to execute '%s': %s (%d)", __func__,
+				  argv[0], strerror(errno), errno);
+			free(buf);
+			return -256;
+		}
+	}
+
+	pid = spawn_fd(argv, -1, pipefd[1],
+		       (flags & LDX_PROCESS_STDERR) ? pipefd[1] : -1);
+	if (pipefd[1] >= 0)
+		close(pipefd[1]);
+	if (pid < 0) {
+		if (pipefd[0] >= 0)
+			close(pipefd[0]);
+		free(buf);
+		return -256;
+	}
+
+	while (cb != NULL && !stop) {
+		struct pollfd pfd = { .fd = pipefd[0], .events = POLLIN };
+		ssize_t n;
+		int ret;
+
+		ret = poll(&pfd, 1, get_remaining_ms(deadline));
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0) {
+			if (ret == 0)
+				log_debug("%s: Timeout executing '%s'", __func__, argv[0]);
+			kill(pid, SIGKILL);
+			break;
+		}
+
+		n = read(pipefd[0], buf + len, size - len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		len += n;
+
+		if (!(flags & LDX_PROCESS_LINES)) {
+			stop = cb(buf, len, arg) != 0;
+			len = 0;
+			continue;
+		}
+
+		n = deliver_lines(buf, len, cb, arg, &stop);
+		len -= n;
+		memmove(buf, buf + n, len);
+
+		/* Grow the buffer for lines longer than it */
+		if (len == size) {
+			char *tmp = realloc(buf, size * 2 + 1);
+
+			if (tmp == NULL) {
+				log_error("%s: Unable to read '%s' output: Out of memory",
+					  __func__, argv[0]);
+				kill(pid, SIGKILL);
+				break;
+			}
+			buf = tmp;
+			size *= 2;
+		}
 	}
 
-	if (errfd < 0)
-		errfd = open("/dev/null", O_WRONLY);
-	fcntl(errfd, F_SETFD, fcntl(errfd, F_GETFD) & ~FD_CLOEXEC);
-	if (errfd != STDERR_FILENO) {
-		dup2(errfd, STDERR_FILENO);
-		close(errfd);
+	/* Last line without line feed */
+	if (!stop && len > 0 && (flags & LDX_PROCESS_LINES)) {
+		buf[len] = '\0';
+		cb(buf, len, arg);
 	}
 
-	sigaction(SIGPIPE, &sa, NULL);
+	if (stop)
+		kill(pid, SIGTERM);
 
-	execvp(cmd_list[0], (char * const *)cmd_list);
+	if (pipefd[0] >= 0)
+		close(pipefd[0]);
+	free(buf);
 
-	_exit(1);
+	return wait_deadline(pid, deadline);
 }
 
 int ldx_process_wait(pid_t pid)
@@ -25,6 +25,8 @@
 #include "_common.h"
 #include "_libsoc_interfaces.h"
 #include "_log.h"
+#include "_pwm.h"
+#include "_stats.h"
 #include "pwm.h"
 
 #define BUFF_SIZE		256
@@ -42,12 +44,18 @@ static const char * const pwm_enable_strings[] = {
 };
 #undef P
 
+static inline libsoc_pwm_t *get_libsoc_pwm(pwm_t *pwm);
+static int load_state(pwm_t *pwm);
+static int write_attr(pwm_t *pwm, int fd, const char *attr, unsigned int value);
+static int write_polarity(pwm_t *pwm, pwm_polarity_t polarity);
+static unsigned int format_uint(unsigned int value, char *end);
 static int check_valid_pwm(pwm_t *pwm);
 
 pwm_t *ldx_pwm_request(unsigned int pwm_chip, unsigned int pwm_channel,
 		       request_mode_t request_mode)
 {
 	libsoc_pwm_t *_pwm = NULL;
+	pwm_internal_t *internal_data = NULL;
 	pwm_t *new_pwm = NULL;
 	pwm_t init_pwm = {
 		.alias = NULL,
@@ -71,15 +79,21 @@ pwm_t *ldx_pwm_request(unsigned int pwm_chip, unsigned int pwm_channel,
 		return NULL;
 
 	new_pwm = calloc(1, sizeof(pwm_t));
-	if (new_pwm == NULL) {
+	internal_data = calloc(1, sizeof(pwm_internal_t));
+	if (new_pwm == NULL || internal_data == NULL) {
 		log_error("%s: Unable to request PWM %d:%d [request mode: %d], cannot allocate memory",
 			  __func__, pwm_chip, pwm_channel, request_mode);
 		libsoc_pwm_free(_pwm);
+		free(new_pwm);
+		free(internal_data);
 		return NULL;
 	}
 
+	internal_data->libsoc = _pwm;
+	internal_data->cached = false;
+
 	memcpy(new_pwm, &init_pwm, sizeof(pwm_t));
-	((pwm_t *)new_pwm)->_data = _pwm;
+	((pwm_t *)new_pwm)->_data = internal_data;
 
 	return new_pwm;
 }
@@ -187,8 +201,12 @@ int ldx_pwm_free(pwm_t *pwm)
 
 	log_debug("%s: Freeing PWM %d:%d", __func__, pwm->chip, pwm->channel);
 
-	if (pwm->_data != NULL)
-		ret = libsoc_pwm_free(pwm->_data);
+	if (pwm->_data != NULL) {
+		pwm_internal_t *_pwm = (pwm_internal_t *)pwm->_data;
+
+		ret = libsoc_pwm_free(_pwm->libsoc);
+		free(_pwm);
+	}
 
 	free(pwm);
 
@@ -197,19 +215,23 @@ int ldx_pwm_free(pwm_t *pwm)
 
 pwm_config_error_t ldx_pwm_set_period(pwm_t *pwm, unsigned int period)
 {
+	pwm_internal_t *_pwm = NULL;
 	pwm_config_error_t ret = PWM_CONFIG_ERROR;
 	int duty_cycle = -1;
 
 	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
 		return PWM_CONFIG_ERROR_INVALID;
 
+	_pwm = (pwm_internal_t *)pwm->_data;
+
 	if (period > INT_MAX) {
 		log_error("%s: Invalid period for PWM %d:%d, it must be between 1 and %d",
 			  __func__, pwm->chip, pwm->channel, INT_MAX);
 		return PWM_CONFIG_ERROR_INVALID;
 	}
 
-	duty_cycle = ldx_pwm_get_duty_cycle(pwm);
+	if (load_state(pwm) == EXIT_SUCCESS)
+		duty_cycle = _pwm->state.duty_cycle;
 	if (duty_cycle > -1 && (int)period < duty_cycle) {
 		log_error("%s: The duty cycle (%d ns) is greater than period (%d ns) "
 			  "that you are setting. Change the duty cycle "
@@ -221,13 +243,15 @@ pwm_config_error_t ldx_pwm_set_period(pwm_t *pwm, unsigned int period)
 	log_debug("%s: Setting period for PWM %d:%d: %d ns", __func__,
 		pwm->chip, pwm->channel, period);
 
-	ret = libsoc_pwm_set_period(pwm->_data, period);
+	ret = libsoc_pwm_set_period(_pwm->libsoc, period);
 
 	if (ret != EXIT_SUCCESS) {
 		log_error("%s: Unable to set PWM %d:%d period to %d ns",
 			  __func__, pwm->chip, pwm->channel, period);
+		_pwm->cached = false;
 		ret = PWM_CONFIG_ERROR;
 	} else {
+		_pwm->state.period = period;
 		ret = PWM_CONFIG_ERROR_NONE;
 	}
 
@@ -244,10 +268,12 @@ int ldx_pwm_get_period(pwm_t *pwm)
 	log_debug("%s: Getting period of PWM %d:%d", __func__, pwm->chip,
 		  pwm->channel);
 
-	period = libsoc_pwm_get_period(pwm->_data);
+	period = libsoc_pwm_get_period(get_libsoc_pwm(pwm));
 	if (period == -1)
 		log_error("%s: Unable to get the PWM %d:%d period",
 			  __func__, pwm->chip, pwm->channel);
+	else
+		((pwm_internal_t *)pwm->_data)->state.period = period;
 
 	return period;
 }
@@ -279,14 +305,21 @@ long ldx_pwm_get_freq(pwm_t *pwm)
 	return (period > 0) ? (SECS_TO_NANOSECS / period) + 0.5 : -1;
 }
 
-pwm_config_error_t ldx_pwm_set_duty_cycle(pwm_t *pwm, unsigned int duty_cycle)
+static pwm_config_error_t pwm_set_duty_cycle(pwm_t *pwm, unsigned int duty_cycle)
 {
-	int current_period;
+	pwm_internal_t *_pwm = NULL;
+	int current_period = -1;
+
+	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
+		return PWM_CONFIG_ERROR_INVALID;
+
+	_pwm = (pwm_internal_t *)pwm->_data;
 
 	log_debug("%s: Setting duty cycle of PWM %d:%d: %d ns", __func__,
 		  pwm->chip, pwm->channel, duty_cycle);
 
-	current_period = ldx_pwm_get_period(pwm);
+	if (load_state(pwm) == EXIT_SUCCESS)
+		current_period = _pwm->state.period;
 	if (current_period > -1 && duty_cycle > (unsigned int)current_period) {
 		log_error("%s: Invalid duty cycle value, %d ns. Duty cycle must"
 			  " be less than the current period (%d ns)",
@@ -294,24 +327,51 @@ pwm_config_error_t ldx_pwm_set_duty_cycle(pwm_t *pwm, unsigned int duty_cycle)
 		return PWM_CONFIG_ERROR_INVALID;
 	}
 
-	return (libsoc_pwm_set_duty_cycle(pwm->_data, duty_cycle) == EXIT_SUCCESS) ?
-			PWM_CONFIG_ERROR_NONE : PWM_CONFIG_ERROR;
+	if (libsoc_pwm_set_duty_cycle(_pwm->libsoc, duty_cycle) != EXIT_SUCCESS) {
+		_pwm->cached = false;
+		return PWM_CONFIG_ERROR;
+	}
+
+	_pwm->state.duty_cycle = duty_cycle;
+
+	return PWM_CONFIG_ERROR_NONE;
+}
+
+pwm_config_error_t ldx_pwm_set_duty_cycle(pwm_t *pwm, unsigned int duty_cycle)
+{
+	uint64_t start = stats_begin();
+	pwm_config_error_t ret;
+
+	ret = pwm_set_duty_cycle(pwm, duty_cycle);
+	stats_end(STATS_API_PWM_SET_DUTY_CYCLE, start,
+		  stats_result_ok(ret == PWM_CONFIG_ERROR_NONE), 0);
+
+	return ret;
 }
 
 int ldx_pwm_get_duty_cycle(pwm_t *pwm)
 {
+	int duty_cycle;
+
 	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
 		return -1;
 
 	log_debug("%s: Getting duty cycle of PWM %d:%d", __func__, pwm->chip, pwm->channel);
 
-	return libsoc_pwm_get_duty_cycle(pwm->_data);
+	duty_cycle = libsoc_pwm_get_duty_cycle(get_libsoc_pwm(pwm));
+	if (duty_cycle > -1)
+		((pwm_internal_t *)pwm->_data)->state.duty_cycle = duty_cycle;
+
+	return duty_cycle;
 }
 
 pwm_config_error_t ldx_pwm_set_duty_cycle_percentage(pwm_t *pwm, unsigned int percentage)
 {
 	int current_period;
 
+	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
+		return PWM_CONFIG_ERROR_INVALID;
+
 	if (percentage > 100) {
 		log_error("%s: Invalid duty cycle percentage %d%%. It must be between 0 and 100",
 			  __func__, percentage);
@@ -321,24 +381,28 @@ pwm_config_error_t ldx_pwm_set_duty_cycle_percentage(pwm_t *pwm, unsigned int pe
 	log_debug("%s: Setting duty cycle percentage of PWM %d:%d: %d%%",
 		  __func__, pwm->chip, pwm->channel, percentage);
 
-	current_period = ldx_pwm_get_period(pwm);
-	if (current_period == -1)
+	if (load_state(pwm) != EXIT_SUCCESS)
 		return PWM_CONFIG_ERROR;
 
+	current_period = ((pwm_internal_t *)pwm->_data)->state.period;
+
 	return ldx_pwm_set_duty_cycle(pwm, (current_period / 100.0 * percentage) + 0.5);
 }
 
-int ldx_pwm_get_duty_percentage(pwm_t *pwm)
+int ldx_pwm_get_duty_cycle_percentage(pwm_t *pwm)
 {
 	int duty_cycle;
 	int period;
 
+	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
+		return -1;
+
 	log_debug("%s: Getting duty cycle percentage of PWM %d:%d", __func__,
 		  pwm->chip, pwm->channel);
 
 	duty_cycle = ldx_pwm_get_duty_cycle(pwm);
 	period = ldx_pwm_get_period(pwm);
-	if (duty_cycle > 0 && period > 0)
+	if (duty_cycle >= 0 && period > 0)
 		return (duty_cycle * 1.0 / period * 100) + 0.5;
 
 	return -1;
@@ -365,7 +429,7 @@ int ldx_pwm_set_polarity(pwm_t *pwm, pwm_polarity_t polarity)
 		  pwm->chip, pwm->channel,
 		  pwm_polarity_strings[polarity], polarity);
 
-	return libsoc_pwm_set_polarity(pwm->_data, polarity);
+	return write_polarity(pwm, polarity);
 }
 
 pwm_polarity_t ldx_pwm_get_polarity(pwm_t *pwm)
@@ -377,7 +441,7 @@ pwm_polarity_t ldx_pwm_get_polarity(pwm_t *pwm)
 
 	log_debug("%s: Getting polarity of PWM %d:%d", __func__, pwm->chip, pwm->channel);
 
-	polarity = libsoc_pwm_get_polarity(pwm->_data);
+	polarity = libsoc_pwm_get_polarity(get_libsoc_pwm(pwm));
 
 	switch (polarity) {
 	case POLARITY_ERROR:
@@ -414,7 +478,14 @@ int ldx_pwm_enable(pwm_t *pwm, pwm_enabled_t enabled)
 	log_debug("%s: %s PWM %d:%d", __func__, enabled == PWM_ENABLED ?
 		  "Enabling" : "Disabling", pwm->chip, pwm->channel);
 
-	return libsoc_pwm_set_enabled(pwm->_data, enabled);
+	if (libsoc_pwm_set_enabled(get_libsoc_pwm(pwm), enabled) != EXIT_SUCCESS) {
+		((pwm_internal_t *)pwm->_data)->cached = false;
+		return EXIT_FAILURE;
+	}
+
+	((pwm_internal_t *)pwm->_data)->state.enabled = enabled;
+
+	return EXIT_SUCCESS;
 }
 
 pwm_enabled_t ldx_pwm_is_enabled(pwm_t *pwm)
@@ -426,7 +497,7 @@ pwm_enabled_t ldx_pwm_is_enabled(pwm_t *pwm)
 
 	log_debug("%s: Checking if PWM %d:%d is enabled", __func__, pwm->chip, pwm->channel);
 
-	enabled = libsoc_pwm_get_enabled(pwm->_data);
+	enabled = libsoc_pwm_get_enabled(get_libsoc_pwm(pwm));
 
 	switch (enabled) {
 	case ENABLED_ERROR:
@@ -443,6 +514,401 @@ pwm_enabled_t ldx_pwm_is_enabled(pwm_t *pwm)
 	}
 }
 
+static pwm_config_error_t pwm_apply(pwm_t *pwm, const pwm_state_t *state)
+{
+	pwm_internal_t *_pwm = NULL;
+	libsoc_pwm_t *_soc = NULL;
+	pwm_state_t *cur = NULL;
+	bool new_polarity;
+
+	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
+		return PWM_CONFIG_ERROR_INVALID;
+
+	if (state == NULL) {
+		log_error("%s: State cannot be NULL", __func__);
+		return PWM_CONFIG_ERROR_INVALID;
+	}
+
+	if (state->period == 0 || state->period > INT_MAX ||
+	    state->duty_cycle > state->period) {
+		log_error("%s: Invalid state for PWM %d:%d, period %u ns, duty cycle %u ns",
+			  __func__, pwm->chip, pwm->channel, state->period,
+			  state->duty_cycle);
+		return PWM_CONFIG_ERROR_INVALID;
+	}
+
+	if ((state->polarity != PWM_NORMAL && state->polarity != PWM_INVERSED) ||
+	    (state->enabled != PWM_ENABLED && state->enabled != PWM_DISABLED)) {
+		log_error("%s: Invalid polarity (%d) or enabled value (%d) for PWM %d:%d",
+			  __func__, state->polarity, state->enabled, pwm->chip,
+			  pwm->channel);
+		return PWM_CONFIG_ERROR_INVALID;
+	}
+
+	if (load_state(pwm) != EXIT_SUCCESS)
+		return PWM_CONFIG_ERROR;
+
+	_pwm = (pwm_internal_t *)pwm->_data;
+	_soc = _pwm->libsoc;
+	cur = &_pwm->state;
+
+	log_debug("%s: Applying state to PWM %d:%d: period %u ns, duty cycle %u ns, %s, %s",
+		  __func__, pwm->chip, pwm->channel, state->period,
+		  state->duty_cycle, pwm_polarity_strings[state->polarity],
+		  pwm_enable_strings[state->enabled]);
+
+	new_polarity = state->polarity != cur->polarity;
+
+	/*
+	 * Stop the output before reconfiguring it when it must end disabled,
+	 * and to change the polarity, which most drivers only allow while
+	 * disabled.
+	 */
+	if (cur->enabled == PWM_ENABLED &&
+	    (state->enabled == PWM_DISABLED || new_polarity)) {
+		if (write_attr(pwm, _soc->enable_fd, "enable", 0) != EXIT_SUCCESS)
+			return PWM_CONFIG_ERROR;
+		cur->enabled = PWM_DISABLED;
+	}
+
+	if (new_polarity && write_polarity(pwm, state->polarity) != EXIT_SUCCESS)
+		return PWM_CONFIG_ERROR;
+
+	/*
+	 * The kernel rejects a duty cycle longer than the period, so shrink
+	 * the duty cycle first if the new period is shorter than it.
+	 */
+	if (state->period >= cur->duty_cycle) {
+		if (state->period != cur->period) {
+			if (write_attr(pwm, _soc->period_fd, "period", state->period) != EXIT_SUCCESS)
+				return PWM_CONFIG_ERROR;
+			cur->period = state->period;
+		}
+		if (state->duty_cycle != cur->duty_cycle) {
+			if (write_attr(pwm, _soc->duty_fd, "duty_cycle", state->duty_cycle) != EXIT_SUCCESS)
+				return PWM_CONFIG_ERROR;
+			cur->duty_cycle = state->duty_cycle;
+		}
+	} else {
+		if (write_attr(pwm, _soc->duty_fd, "duty_cycle", state->duty_cycle) != EXIT_SUCCESS)
+			return PWM_CONFIG_ERROR;
+		cur->duty_cycle = state->duty_cycle;
+		if (state->period != cur->period) {
+			if (write_attr(pwm, _soc->period_fd, "period", state->period) != EXIT_SUCCESS)
+				return PWM_CONFIG_ERROR;
+			cur->period = state->period;
+		}
+	}
+
+	if (state->enabled == PWM_ENABLED && cur->enabled != PWM_ENABLED) {
+		if (write_attr(pwm, _soc->enable_fd, "enable", 1) != EXIT_SUCCESS)
+			return PWM_CONFIG_ERROR;
+		cur->enabled = PWM_ENABLED;
+	}
+
+	return PWM_CONFIG_ERROR_NONE;
+}
+
+pwm_config_error_t ldx_pwm_apply(pwm_t *pwm, const pwm_state_t *state)
+{
+	uint64_t start = stats_begin();
+	pwm_config_error_t ret;
+
+	ret = pwm_apply(pwm, state);
+	stats_end(STATS_API_PWM_APPLY, start,
+		  stats_result_ok(ret == PWM_CONFIG_ERROR_NONE), 0);
+
+	return ret;
+}
+
+int ldx_pwm_get_state(pwm_t *pwm, pwm_state_t *state)
+{
+	if (check_valid_pwm(pwm) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (state == NULL) {
+		log_error("%s: State cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (load_state(pwm) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	*state = ((pwm_internal_t *)pwm->_data)->state;
+
+	return EXIT_SUCCESS;
+}
+
+pwm_group_t *ldx_pwm_group_create(pwm_t **pwms, unsigned int num_pwms)
+{
+	pwm_group_t *new_group = NULL;
+	pwm_group_internal_t *_group = NULL;
+	unsigned int i;
+
+	if (pwms == NULL || num_pwms == 0) {
+		log_error("%s: Invalid PWM list", __func__);
+		return NULL;
+	}
+
+	for (i = 0; i < num_pwms; i++) {
+		if (check_valid_pwm(pwms[i]) != EXIT_SUCCESS)
+			return NULL;
+
+		if (pwms[i]->chip != pwms[0]->chip) {
+			log_error("%s: PWM %d:%d is not in chip %d", __func__,
+				  pwms[i]->chip, pwms[i]->channel, pwms[0]->chip);
+			return NULL;
+		}
+
+		/* Cache the periods now, to validate the updates in memory */
+		if (load_state(pwms[i]) != EXIT_SUCCESS) {
+			log_error("%s: Unable to get the state of PWM %d:%d",
+				  __func__, pwms[i]->chip, pwms[i]->channel);
+			return NULL;
+		}
+	}
+
+	new_group = calloc(1, sizeof(pwm_group_t));
+	_group = calloc(1, sizeof(pwm_group_internal_t));
+	if (_group != NULL) {
+		_group->pwms = calloc(num_pwms, sizeof(pwm_t *));
+		_group->duty_fds = calloc(num_pwms, sizeof(int));
+		_group->digits = calloc(num_pwms, PWM_GROUP_DIGITS);
+		_group->lengths = calloc(num_pwms, sizeof(unsigned int));
+	}
+	if (new_group == NULL || _group == NULL || _group->pwms == NULL ||
+	    _group->duty_fds == NULL || _group->digits == NULL ||
+	    _group->lengths == NULL) {
+		log_error("%s: Unable to create PWM group, cannot allocate memory",
+			  __func__);
+		if (_group != NULL) {
+			free(_group->pwms);
+			free(_group->duty_fds);
+			free(_group->digits);
+			free(_group->lengths);
+		}
+		free(_group);
+		free(new_group);
+		return NULL;
+	}
+
+	for (i = 0; i < num_pwms; i++) {
+		_group->pwms[i] = pwms[i];
+		_group->duty_fds[i] = get_libsoc_pwm(pwms[i])->duty_fd;
+	}
+
+	{
+		pwm_group_t init_group = {
+			.chip = pwms[0]->chip,
+			.num_pwms = num_pwms,
+			._data = _group
+		};
+
+		memcpy(new_group, &init_group, sizeof(pwm_group_t));
+	}
+
+	return new_group;
+}
+
+int ldx_pwm_group_free(pwm_group_t *group)
+{
+	pwm_group_internal_t *_group = NULL;
+
+	if (group == NULL)
+		return EXIT_SUCCESS;
+
+	_group = (pwm_group_internal_t *)group->_data;
+	if (_group != NULL) {
+		free(_group->pwms);
+		free(_group->duty_fds);
+		free(_group->digits);
+		free(_group->lengths);
+		free(_group);
+	}
+
+	free(group);
+
+	return EXIT_SUCCESS;
+}
+
+pwm_config_error_t ldx_pwm_group_set_duty_cycles(pwm_group_t *group,
+						 const unsigned int *duty_ns)
+{
+	pwm_group_internal_t *_group = NULL;
+	unsigned int *len = NULL;
+	unsigned int i;
+	pwm_config_error_t ret = PWM_CONFIG_ERROR_NONE;
+
+	if (group == NULL || group->_data == NULL) {
+		log_error("%s: Invalid PWM group", __func__);
+		return PWM_CONFIG_ERROR_INVALID;
+	}
+
+	if (duty_ns == NULL) {
+		log_error("%s: Duty cycles cannot be NULL", __func__);
+		return PWM_CONFIG_ERROR_INVALID;
+	}
+
+	_group = (pwm_group_internal_t *)group->_data;
+	len = _group->lengths;
+
+	for (i = 0; i < group->num_pwms; i++) {
+		pwm_internal_t *_pwm = (pwm_internal_t *)_group->pwms[i]->_data;
+
+		if (_pwm->cached && duty_ns[i] > _pwm->state.period) {
+			log_error("%s: Invalid duty cycle for PWM %d:%d, %u ns. It must be less than the period (%u ns)",
+				  __func__, group->chip, _group->pwms[i]->channel,
+				  duty_ns[i], _pwm->state.period);
+			return PWM_CONFIG_ERROR_INVALID;
+		}
+
+		len[i] = format_uint(duty_ns[i],
+				     _group->digits + (i + 1) * PWM_GROUP_DIGITS);
+	}
+
+	for (i = 0; i < group->num_pwms; i++) {
+		const char *str = _group->digits + (i + 1) * PWM_GROUP_DIGITS - len[i];
+
+		if (pwrite(_group->duty_fds[i], str, len[i], 0) != (ssize_t)len[i]) {
+			((pwm_internal_t *)_group->pwms[i]->_data)->cached = false;
+			ret = PWM_CONFIG_ERROR;
+			continue;
+		}
+
+		((pwm_internal_t *)_group->pwms[i]->_data)->state.duty_cycle = duty_ns[i];
+	}
+
+	if (ret != PWM_CONFIG_ERROR_NONE)
+		log_error("%s: Unable to set the duty cycles of the PWM group of chip %d",
+			  __func__, group->chip);
+
+	return ret;
+}
+
+/**
+ * format_uint() - Format an unsigned integer in decimal
+ *
+ * @value:	The value to format.
+ * @end:	End of the buffer, which must have room for PWM_GROUP_DIGITS
+ *		characters before it.
+ *
+ * The digits are written backwards ending right before 'end', without a
+ * terminating null character.
+ *
+ * Return: The number of characters written.
+ */
+static unsigned int format_uint(unsigned int value, char *end)
+{
+	char *p = end;
+
+	do {
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	return end - p;
+}
+
+/**
+ * get_libsoc_pwm() - Get the libsoc handle of a PWM
+ *
+ * @pwm:	A requested PWM.
+ *
+ * Return: The libsoc PWM handle.
+ */
+static inline libsoc_pwm_t *get_libsoc_pwm(pwm_t *pwm)
+{
+	return ((pwm_internal_t *)pwm->_data)->libsoc;
+}
+
+/**
+ * load_state() - Read the state of a PWM from sysfs if it is not cached
+ *
+ * @pwm:	A requested PWM.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int load_state(pwm_t *pwm)
+{
+	pwm_internal_t *_pwm = (pwm_internal_t *)pwm->_data;
+	int period, duty_cycle;
+	pwm_polarity_t polarity;
+	pwm_enabled_t enabled;
+
+	if (_pwm->cached)
+		return EXIT_SUCCESS;
+
+	period = ldx_pwm_get_period(pwm);
+	duty_cycle = ldx_pwm_get_duty_cycle(pwm);
+	polarity = ldx_pwm_get_polarity(pwm);
+	enabled = ldx_pwm_is_enabled(pwm);
+	if (period < 0 || duty_cycle < 0 || polarity == PWM_POLARITY_ERROR ||
+	    enabled == PWM_ENABLED_ERROR)
+		return EXIT_FAILURE;
+
+	_pwm->state.period = period;
+	_pwm->state.duty_cycle = duty_cycle;
+	_pwm->state.polarity = polarity;
+	_pwm->state.enabled = enabled;
+	_pwm->cached = true;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * write_attr() - Write a numeric value to an open sysfs attribute of a PWM
+ *
+ * @pwm:	A requested PWM.
+ * @fd:		The descriptor of the attribute.
+ * @attr:	Name of the attribute, for logging.
+ * @value:	The value to write.
+ *
+ * On error the cached state is dropped, since the hardware state is unknown.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int write_attr(pwm_t *pwm, int fd, const char *attr, unsigned int value)
+{
+	char buf[16];
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "%u", value);
+	if (pwrite(fd, buf, len, 0) != len) {
+		log_error("%s: Unable to write %s of PWM %d:%d (%d)", __func__,
+			  attr, pwm->chip, pwm->channel, errno);
+		((pwm_internal_t *)pwm->_data)->cached = false;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * write_polarity() - Write the polarity of a PWM and update the cached state
+ *
+ * @pwm:	A requested PWM.
+ * @polarity:	The new polarity.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int write_polarity(pwm_t *pwm, pwm_polarity_t polarity)
+{
+	pwm_internal_t *_pwm = (pwm_internal_t *)pwm->_data;
+	const char *value = polarity == PWM_INVERSED ? "inversed" : "normal";
+	ssize_t len = strlen(value);
+
+	if (pwrite(_pwm->libsoc->polarity_fd, value, len, 0) != len) {
+		log_error("%s: Unable to write polarity of PWM %d:%d (%d)",
+			  __func__, pwm->chip, pwm->channel, errno);
+		_pwm->cached = false;
+		return EXIT_FAILURE;
+	}
+
+	_pwm->state.polarity = polarity;
+
+	return EXIT_SUCCESS;
+}
+
 static int check_valid_pwm(pwm_t *pwm)
 {
 	if (pwm == NULL) {
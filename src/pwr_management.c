@@ -14,10 +14,15 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <linux/version.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <stdio.h>
@@ -44,6 +49,7 @@
 #define CC8MN_GPU_PATH			"/sys/devices/platform/38000000.gpu/"
 #define CC8MM_GPU_PATH			"/sys/devices/platform/38000000.gpu/"
 #define FREQ_PATH 				"/sys/devices/system/cpu/cpufreq/policy0/"
+#define POLICIES_PATH			"/sys/devices/system/cpu/cpufreq"
 #define MIN_MULTIPLIER_PATH		"/sys/bus/platform/drivers/galcore/"
 #define TEMP_PATH				"/sys/devices/virtual/thermal/thermal_zone0/"
 #define CPU_USAGE_PATH			"/proc/stat"
@@ -53,6 +59,7 @@
 #define AVALAIBLE_SCALING_GOVERNORS "scaling_available_governors"
 #define CORES 						"cpu"
 #define CRITICAL_TRIP_POINT			"trip_point_1_temp"
+#define CUR_FREQ_PATH				"scaling_cur_freq"
 #define GPU_MULT					"gpu_mult"
 #define MAX_SCALING_FREQ_PATH 		"scaling_max_freq"
 #define MAX_FREQ_PATH		  		"cpuinfo_max_freq"
@@ -61,12 +68,16 @@
 #define MIN_MULTIPLIER_ENTRY		"gpu3DMinClock"
 #define ONLINE 						"online"
 #define PASSIVE_TRIP_POINT			"trip_point_0_temp"
+#define POLICY						"policy"
 #define SCALING_GOVERNOR			"scaling_governor"
 #define SCALING_FREQ_PATH			"scaling_setspeed"
 #define TEMPERATURE					"temp"
 
-// Commands
-#define COMMAND_GET_CORES 			"ls /sys/devices/system/cpu | awk '/cpu[0-9]/' | wc -l"
+// Room for the aggregate line and each core line of /proc/stat
+#define CPU_STAT_LINE_LEN			256
+#define INT_VALUE_LEN				32
+// Room for the longest cpufreq attribute (list of available frequencies)
+#define POLICY_VALUE_LEN			1024
 
 // Governors Strings
 #define GOVERNOR_PERFORMANCE_STRING		"performance"
@@ -78,35 +89,130 @@
 #define	GOVERNOR_SCHEDUTIL_STRING		"schedutil"
 
 /**
- * check_frequency() - Verify that the frequency is valid
+ * cpu_times_t - Time accounted to a CPU in /proc/stat
  *
- * @freq:	The frequency to check.
+ * @busy:	Ticks spent running tasks or handling interrupts.
+ * @total:	Total ticks, including idle and iowait.
+ * @valid:	False if the CPU was not listed (offline).
+ */
+typedef struct {
+	unsigned long long busy;
+	unsigned long long total;
+	bool valid;
+} cpu_times_t;
+
+/**
+ * cpu_sampler_internal_t - Internal data of a CPU telemetry sampler
  *
- * Return: EXIT_SUCCESS if the freq is valid, EXIT_FAILURE otherwise.
+ * @stat_fd:	Descriptor of /proc/stat.
+ * @temp_fd:	Descriptor of the temperature file, -1 if not available.
+ * @freq_fd:	Descriptor of the current frequency file, -1 if not available.
+ * @buf:	Buffer to read /proc/stat.
+ * @buf_len:	Size of the buffer.
+ * @prev:	Times of the previous sample, aggregate first, then each core.
+ * @cur:	Times of the current sample.
+ * @core_usage:	Usage of each core returned to the caller.
+ */
+typedef struct {
+	int stat_fd;
+	int temp_fd;
+	int freq_fd;
+	char *buf;
+	size_t buf_len;
+	cpu_times_t *prev;
+	cpu_times_t *cur;
+	int *core_usage;
+} cpu_sampler_internal_t;
+
+/**
+ * read_int_fd() - Read an integer from the beginning of an open file
+ *
+ * @fd:		The file descriptor.
+ * @value:	Integer to store the value.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_int_fd(int fd, int *value)
+{
+	char buf[INT_VALUE_LEN];
+	ssize_t len;
+
+	len = pread(fd, buf, sizeof(buf) - 1, 0);
+	if (len <= 0)
+		return EXIT_FAILURE;
+
+	buf[len] = '\0';
+	*value = atoi(buf);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * read_cpu_times() - Read the time accounted to each CPU
+ *
+ * @_data:	Internal data of the sampler.
+ * @n_cores:	Number of CPU cores.
+ * @times:	Array of 'n_cores' + 1 entries to fill.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int check_frequency(int freq)
+static int read_cpu_times(cpu_sampler_internal_t *_data, int n_cores, cpu_times_t *times)
 {
-	available_frequencies_t frequencies;
+	char *line, *end;
+	ssize_t len;
 	int i;
 
-	if (freq < ldx_cpu_get_min_freq() || freq > ldx_cpu_get_max_freq()) {
-		log_debug("%s: %d is not a valid frequency", __func__, freq);
+	for (i = 0; i <= n_cores; i++)
+		times[i].valid = false;
+
+	/* The CPU lines come first, the rest of the file is not needed */
+	len = pread(_data->stat_fd, _data->buf, _data->buf_len - 1, 0);
+	if (len <= 0)
 		return EXIT_FAILURE;
-	}
+	_data->buf[len] = '\0';
 
-	frequencies = ldx_cpu_get_available_freq();
+	for (line = _data->buf; strncmp(line, CORES, strlen(CORES)) == 0; line = end + 1) {
+		unsigned long long t[8] = { 0 };
+		char *ptr = line + strlen(CORES);
+		int idx = 0;
 
-	for (i = 0; i < frequencies.len; i++) {
-		if (freq == frequencies.data[i]) {
-			ldx_cpu_free_available_freq(frequencies);
-			return EXIT_SUCCESS;
+		end = strchr(line, '\n');
+		if (end == NULL)
+			break;
+
+		if (*ptr != ' ') {
+			idx = strtol(ptr, &ptr, 10) + 1;
+			if (idx <= 0 || idx > n_cores)
+				continue;
 		}
+
+		/* user nice system idle iowait irq softirq steal */
+		if (sscanf(ptr, "%llu %llu %llu %llu %llu %llu %llu %llu", &t[0], &t[1],
+			   &t[2], &t[3], &t[4], &t[5], &t[6], &t[7]) < 4)
+			continue;
+
+		times[idx].busy = t[0] + t[1] + t[2] + t[5] + t[6] + t[7];
+		times[idx].total = times[idx].busy + t[3] + t[4];
+		times[idx].valid = true;
 	}
 
-	log_debug("%s: %d is not a valid frequency", __func__, freq);
-	ldx_cpu_free_available_freq(frequencies);
+	return times[0].valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-	return EXIT_FAILURE;
+/**
+ * get_usage() - Compute the usage between two samples
+ *
+ * @prev:	Times of the previous sample.
+ * @cur:	Times of the current sample.
+ *
+ * Return: The usage in %, -1 if unknown.
+ */
+static int get_usage(const cpu_times_t *prev, const cpu_times_t *cur)
+{
+	if (!prev->valid || !cur->valid || cur->total <= prev->total)
+		return -1;
+
+	return (cur->busy - prev->busy) * 100 / (cur->total - prev->total);
 }
 
 /**
@@ -118,51 +224,261 @@ static int check_frequency(int freq)
  */
 static int get_int_from_path(const char* path)
 {
-	char *data = NULL;
-	char *cmd;
-	int number;
+	int fd, number, ret;
 
-	if (asprintf(&cmd, READ_PATH, path) < 0) {
-		log_error("%s: Unable to allocate memory for the command", __func__);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		log_error("%s: Unable to get the data from path", __func__);
 		return -1;
 	}
 
-	data = get_cmd_output(cmd);
+	ret = read_int_fd(fd, &number);
+	close(fd);
 
-	if (data == NULL) {
+	if (ret != EXIT_SUCCESS) {
 		log_error("%s: Unable to get the data from path", __func__);
-		free(cmd);
 		return -1;
 	}
 
-	number = atoi(data);
+	return number;
+}
 
-	free(data);
-	free(cmd);
+/**
+ * get_policy_path() - Build the path of a cpufreq policy attribute
+ *
+ * @policy:	The cpufreq policy.
+ * @attr:	The attribute, NULL for the policy directory.
+ * @path:	Buffer of PATH_MAX bytes to store the path.
+ *
+ * Return: The path.
+ */
+static char *get_policy_path(int policy, const char *attr, char *path)
+{
+	if (attr == NULL)
+		snprintf(path, PATH_MAX, "%s/%s%d", POLICIES_PATH, POLICY, policy);
+	else
+		snprintf(path, PATH_MAX, "%s/%s%d/%s", POLICIES_PATH, POLICY, policy, attr);
 
-	return number;
+	return path;
 }
 
 /**
- * get_frequency_from_path() - Get the value of a selected frequency path
+ * check_policy() - Verify that a cpufreq policy exists
  *
- * @path:	The path to get the frequency value.
+ * @policy:	The cpufreq policy to check.
  *
- * Return: The frequency value read from the path, -1 on failure.
+ * Return: EXIT_SUCCESS if the policy exists, EXIT_FAILURE otherwise.
  */
-static int get_frequency_from_path(const char* path)
+static int check_policy(int policy)
 {
-	char *dir_path = NULL;
-	int frequency;
+	char path[PATH_MAX];
+
+	if (policy < 0 || access(get_policy_path(policy, NULL, path), F_OK) != 0) {
+		log_error("%s: Invalid cpufreq policy %d", __func__, policy);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * read_policy_attr() - Read a cpufreq policy attribute
+ *
+ * @policy:	The cpufreq policy.
+ * @attr:	The attribute to read.
+ * @buf:	Buffer of POLICY_VALUE_LEN bytes to store the value, without
+ *		the trailing line feed.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int read_policy_attr(int policy, const char *attr, char *buf)
+{
+	char path[PATH_MAX];
+	ssize_t len;
+	int fd;
+
+	fd = open(get_policy_path(policy, attr, path), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return EXIT_FAILURE;
+
+	len = read(fd, buf, POLICY_VALUE_LEN - 1);
+	close(fd);
+	if (len <= 0)
+		return EXIT_FAILURE;
+
+	while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == ' '))
+		len--;
+	buf[len] = '\0';
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * write_policy_attr() - Write a cpufreq policy attribute
+ *
+ * @policy:	The cpufreq policy.
+ * @attr:	The attribute to write.
+ * @value:	The value to write.
+ *
+ * Unlike 'write_file()', the error reported by the kernel when the value is
+ * rejected is detected.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int write_policy_attr(int policy, const char *attr, const char *value)
+{
+	char path[PATH_MAX];
+	ssize_t len;
+	int fd, ret = EXIT_SUCCESS;
 
-	dir_path = concat_path(FREQ_PATH, path);
-	if (dir_path == NULL)
+	fd = open(get_policy_path(policy, attr, path), O_WRONLY | O_CLOEXEC);
+	if (fd < 0) {
+		log_error("%s: Unable to open '%s': %s", __func__, path, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	len = write(fd, value, strlen(value));
+	if (len != (ssize_t)strlen(value)) {
+		log_error("%s: Unable to write '%s' to '%s': %s", __func__, value,
+			  path, len < 0 ? strerror(errno) : "Short write");
+		ret = EXIT_FAILURE;
+	}
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * get_policy_int() - Get an integer cpufreq policy attribute
+ *
+ * @policy:	The cpufreq policy.
+ * @attr:	The attribute to read.
+ *
+ * Return: The value of the attribute, -1 on failure.
+ */
+static int get_policy_int(int policy, const char *attr)
+{
+	char buf[POLICY_VALUE_LEN];
+
+	if (check_policy(policy))
 		return -1;
 
-	frequency = get_int_from_path(dir_path);
-	free(dir_path);
+	if (read_policy_attr(policy, attr, buf)) {
+		log_error("%s: Unable to get '%s' of policy %d", __func__, attr, policy);
+		return -1;
+	}
+
+	return atoi(buf);
+}
+
+/**
+ * set_policy_int() - Set an integer cpufreq policy attribute
+ *
+ * @policy:	The cpufreq policy.
+ * @attr:	The attribute to write.
+ * @value:	The value to write.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int set_policy_int(int policy, const char *attr, int value)
+{
+	char buf[INT_VALUE_LEN];
+
+	snprintf(buf, sizeof(buf), "%d", value);
 
-	return frequency;
+	return write_policy_attr(policy, attr, buf);
+}
+
+/**
+ * check_frequency() - Verify that the frequency is valid for a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @freq:	The frequency to check.
+ *
+ * Drivers without a table of frequencies (no 'scaling_available_frequencies')
+ * accept any value between the minimum and maximum.
+ *
+ * Return: EXIT_SUCCESS if the freq is valid, EXIT_FAILURE otherwise.
+ */
+static int check_frequency(int policy, int freq)
+{
+	char buf[POLICY_VALUE_LEN];
+	char *ptr, *saveptr = NULL;
+
+	if (freq < ldx_cpu_policy_get_min_freq(policy)
+	    || freq > ldx_cpu_policy_get_max_freq(policy)) {
+		log_debug("%s: %d is not a valid frequency", __func__, freq);
+		return EXIT_FAILURE;
+	}
+
+	if (read_policy_attr(policy, AVALAIBLE_SCALING_FREQ, buf))
+		return EXIT_SUCCESS;
+
+	for (ptr = strtok_r(buf, " ", &saveptr); ptr != NULL;
+	     ptr = strtok_r(NULL, " ", &saveptr)) {
+		if (freq == atoi(ptr))
+			return EXIT_SUCCESS;
+	}
+
+	log_debug("%s: %d is not a valid frequency", __func__, freq);
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * check_governor() - Verify that a governor is available for a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @governor:	The governor to check.
+ *
+ * Return: EXIT_SUCCESS if the governor is available, EXIT_FAILURE otherwise.
+ */
+static int check_governor(int policy, governor_mode_t governor)
+{
+	char buf[POLICY_VALUE_LEN];
+	char *ptr, *saveptr = NULL;
+
+	if (read_policy_attr(policy, AVALAIBLE_SCALING_GOVERNORS, buf)) {
+		log_error("%s: Unable to get the available governors", __func__);
+		return EXIT_FAILURE;
+	}
+
+	for (ptr = strtok_r(buf, " ", &saveptr); ptr != NULL;
+	     ptr = strtok_r(NULL, " ", &saveptr)) {
+		if (ldx_cpu_get_governor_type_from_string(ptr) == governor)
+			return EXIT_SUCCESS;
+	}
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * set_freq_limits() - Set the scaling limits of a policy
+ *
+ * @policy:	The cpufreq policy.
+ * @min_freq:	The minimum scaling frequency, -1 to keep the current one.
+ * @max_freq:	The maximum scaling frequency, -1 to keep the current one.
+ *
+ * The limits are written in the order that keeps the minimum below the
+ * maximum at all times, so the kernel does not reject any of them.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int set_freq_limits(int policy, int min_freq, int max_freq)
+{
+	if (min_freq >= 0 && min_freq > ldx_cpu_policy_get_max_scaling_freq(policy)) {
+		if (max_freq >= 0 && set_policy_int(policy, MAX_SCALING_FREQ_PATH, max_freq))
+			return EXIT_FAILURE;
+		return set_policy_int(policy, MIN_SCALING_FREQ_PATH, min_freq);
+	}
+
+	if (min_freq >= 0 && set_policy_int(policy, MIN_SCALING_FREQ_PATH, min_freq))
+		return EXIT_FAILURE;
+
+	if (max_freq >= 0 && set_policy_int(policy, MAX_SCALING_FREQ_PATH, max_freq))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
 }
 
 /**
@@ -284,21 +600,17 @@ governor_mode_t ldx_cpu_get_governor_type_from_string(const char *governor_strin
 
 int ldx_cpu_get_number_of_cores()
 {
-	char *cores = NULL;
-	int num_cores = 0;
+	long num_cores;
 
 	log_debug("%s: Getting number of cores from the CPU", __func__);
 
-	cores = get_cmd_output(COMMAND_GET_CORES);
-
-	if (cores == NULL) {
+	/* Configured cores, including the offline ones */
+	num_cores = sysconf(_SC_NPROCESSORS_CONF);
+	if (num_cores <= 0) {
 		log_error("%s: Unable to get the number of CPU cores", __func__);
 		return -1;
 	}
 
-	num_cores = atoi(cores);
-	free(cores);
-
 	return num_cores;
 }
 
@@ -334,109 +646,132 @@ int ldx_cpu_disable_core(int core)
 	return ldx_cpu_set_status_core(core, DISABLED);
 }
 
-available_frequencies_t ldx_cpu_get_available_freq()
+int ldx_cpu_list_policies(int **policies)
 {
-	char *available_frequencies = NULL;
-	char *cmd;
-	char *ptr;
+	struct dirent *entry;
+	int n_policies = 0, size = 0, *tmp;
+	DIR *dir;
+
+	*policies = NULL;
+
+	dir = opendir(POLICIES_PATH);
+	if (dir == NULL) {
+		log_error("%s: Unable to list the cpufreq policies", __func__);
+		return -1;
+	}
+
+	while ((entry = readdir(dir)) != NULL) {
+		char *end;
+		long policy;
+
+		if (strncmp(entry->d_name, POLICY, strlen(POLICY)) != 0)
+			continue;
+
+		policy = strtol(entry->d_name + strlen(POLICY), &end, 10);
+		if (*end != '\0' || end == entry->d_name + strlen(POLICY))
+			continue;
+
+		if (n_policies == size) {
+			size = size ? size * 2 : 4;
+			tmp = realloc(*policies, size * sizeof(**policies));
+			if (tmp == NULL) {
+				log_error("%s: Unable to list the cpufreq policies: Out of memory",
+					  __func__);
+				free(*policies);
+				*policies = NULL;
+				closedir(dir);
+				return -1;
+			}
+			*policies = tmp;
+		}
+
+		(*policies)[n_policies++] = policy;
+	}
+
+	closedir(dir);
+
+	/* readdir() returns them in any order */
+	for (size = 1; size < n_policies; size++) {
+		int j, policy = (*policies)[size];
+
+		for (j = size; j > 0 && (*policies)[j - 1] > policy; j--)
+			(*policies)[j] = (*policies)[j - 1];
+		(*policies)[j] = policy;
+	}
+
+	if (n_policies == 0) {
+		free(*policies);
+		*policies = NULL;
+	}
+
+	return n_policies;
+}
+
+available_frequencies_t ldx_cpu_policy_get_available_freq(int policy)
+{
+	char buf[POLICY_VALUE_LEN];
+	char *ptr, *saveptr = NULL;
 	available_frequencies_t freq = {
 		.data = NULL,
 		.len = 0
 	};
-	int i = 0;
+	int i = 1;
 
-	if (asprintf(&cmd, READ_PATH, FREQ_PATH AVALAIBLE_SCALING_FREQ) < 0) {
-		log_error("%s: Unable to allocate memory for the command", __func__);
+	if (check_policy(policy))
 		return freq;
-	}
 
-	available_frequencies = get_cmd_output(cmd);
-	if (available_frequencies == NULL) {
+	if (read_policy_attr(policy, AVALAIBLE_SCALING_FREQ, buf)) {
 		log_error("%s: Unable to get the available frequencies", __func__);
-		free(cmd);
 		return freq;
 	}
 
-	ptr = available_frequencies;
-
-	/*
-	 * Count the spaces inside the returned string.
-	 *
-	 * There is an extra space at the end of the list "900000 1200000 "
-	 * so, the list of frequencies is equal to the number of ' '
-	 */
-	while (*ptr) {
-		if (*ptr == ' ') {
+	/* The number of frequencies is the number of separators plus one */
+	for (ptr = buf; *ptr; ptr++) {
+		if (*ptr == ' ')
 			i++;
-		}
-		ptr++;
 	}
 
-	if (i)
-		freq.data = malloc((i) * sizeof(*freq.data));
+	freq.data = malloc(i * sizeof(*freq.data));
 	if (!freq.data)
-		goto err_free;
+		return freq;
 
-	ptr = strtok(available_frequencies, " ");
-	while (ptr != NULL) {
+	for (ptr = strtok_r(buf, " ", &saveptr); ptr != NULL;
+	     ptr = strtok_r(NULL, " ", &saveptr)) {
 		log_debug("%s: Frequency available %s", __func__, ptr);
 		freq.data[freq.len] = atoi(ptr);
 		freq.len++;
-		ptr = strtok(NULL, " ");
 	}
 
-err_free:
-	free(available_frequencies);
-	free(cmd);
-
 	return freq;
 }
 
+available_frequencies_t ldx_cpu_get_available_freq()
+{
+	return ldx_cpu_policy_get_available_freq(0);
+}
+
 void ldx_cpu_free_available_freq(available_frequencies_t freq)
 {
 	log_debug("%s: Freeing available frequencies", __func__);
 	free(freq.data);
 }
 
-int ldx_cpu_is_governor_available(governor_mode_t governor)
+int ldx_cpu_policy_is_governor_available(int policy, governor_mode_t governor)
 {
-	char *cmd_output = NULL;
-	char *cmd;
-	char *ptr;
-
-	if (asprintf(&cmd, READ_PATH, FREQ_PATH AVALAIBLE_SCALING_GOVERNORS) < 0) {
-		log_error("%s: Unable to allocate memory for the command", __func__);
-		return EXIT_FAILURE;
-	}
-
-	cmd_output = get_cmd_output(cmd);
-	if (cmd_output == NULL) {
-		log_error("%s: Unable to get the available governors", __func__);
-		free(cmd);
+	if (check_policy(policy))
 		return EXIT_FAILURE;
-	}
-
-	ptr = strtok(cmd_output, " ");
 
-	while (ptr != NULL) {
-		if (ldx_cpu_get_governor_type_from_string(ptr) == governor) {
-			free(cmd_output);
-			free(cmd);
-			return EXIT_SUCCESS;
-		}
-		ptr = strtok(NULL, " ");
-	}
-
-	free(cmd_output);
-	free(cmd);
+	return check_governor(policy, governor);
+}
 
-	return EXIT_FAILURE;
+int ldx_cpu_is_governor_available(governor_mode_t governor)
+{
+	return ldx_cpu_policy_is_governor_available(0, governor);
 }
 
-int ldx_cpu_set_governor (governor_mode_t governor)
+int ldx_cpu_policy_set_governor(int policy, governor_mode_t governor)
 {
 	const char *governor_string = NULL;
-	char *cmd;
 
 	governor_string = ldx_cpu_get_governor_string_from_type(governor);
 
@@ -444,96 +779,110 @@ int ldx_cpu_set_governor (governor_mode_t governor)
 		return EXIT_FAILURE;
 	}
 
-	if (asprintf(&cmd, "%s/%s", FREQ_PATH, SCALING_GOVERNOR) < 0) {
-		log_error("%s: Unable to allocate memory for the command", __func__);
+	if (check_policy(policy))
 		return EXIT_FAILURE;
-	}
 
-	if (write_file(cmd, "%s", governor_string) != 0) {
+	if (write_policy_attr(policy, SCALING_GOVERNOR, governor_string)) {
 		log_error("%s: Unable to set the governor status", __func__);
-		free(cmd);
 		return EXIT_FAILURE;
 	}
 
-	free(cmd);
-
 	return EXIT_SUCCESS;
 }
 
-governor_mode_t ldx_cpu_get_governor()
+int ldx_cpu_set_governor (governor_mode_t governor)
 {
-	char *cmd_output = NULL;
-	char *cmd;
-	char *ptr;
-	governor_mode_t governor;
+	return ldx_cpu_policy_set_governor(0, governor);
+}
 
-	if (asprintf(&cmd, READ_PATH, FREQ_PATH SCALING_GOVERNOR) < 0) {
-		log_error("%s: Unable to allocate memory for the command", __func__);
-		return GOVERNOR_INVALID;
-	}
+governor_mode_t ldx_cpu_policy_get_governor(int policy)
+{
+	char buf[POLICY_VALUE_LEN];
 
-	cmd_output = get_cmd_output(cmd);
-	if (cmd_output == NULL) {
-		log_error("%s: Unable to get the current governor", __func__);
-		free(cmd);
+	if (check_policy(policy))
 		return GOVERNOR_INVALID;
-	}
 
-	ptr = strtok(cmd_output, " ");
-	if (ptr == NULL) {
+	if (read_policy_attr(policy, SCALING_GOVERNOR, buf)) {
 		log_error("%s: Unable to get the current governor", __func__);
-		free(cmd);
-		free(cmd_output);
 		return GOVERNOR_INVALID;
 	}
 
-	governor = ldx_cpu_get_governor_type_from_string(ptr);
-	free(cmd_output);
-	free(cmd);
+	return ldx_cpu_get_governor_type_from_string(buf);
+}
 
-	return governor;
+governor_mode_t ldx_cpu_get_governor()
+{
+	return ldx_cpu_policy_get_governor(0);
+}
+
+int ldx_cpu_policy_get_max_freq(int policy)
+{
+	return get_policy_int(policy, MAX_FREQ_PATH);
 }
 
 int ldx_cpu_get_max_freq()
 {
-	return get_frequency_from_path(MAX_FREQ_PATH);
+	return ldx_cpu_policy_get_max_freq(0);
+}
+
+int ldx_cpu_policy_get_min_freq(int policy)
+{
+	return get_policy_int(policy, MIN_FREQ_PATH);
 }
 
 int ldx_cpu_get_min_freq()
 {
-	return get_frequency_from_path(MIN_FREQ_PATH);
+	return ldx_cpu_policy_get_min_freq(0);
+}
+
+int ldx_cpu_policy_get_max_scaling_freq(int policy)
+{
+	return get_policy_int(policy, MAX_SCALING_FREQ_PATH);
 }
 
 int ldx_cpu_get_max_scaling_freq()
 {
-	return get_frequency_from_path(MAX_SCALING_FREQ_PATH);
+	return ldx_cpu_policy_get_max_scaling_freq(0);
+}
+
+int ldx_cpu_policy_get_min_scaling_freq(int policy)
+{
+	return get_policy_int(policy, MIN_SCALING_FREQ_PATH);
 }
 
 int ldx_cpu_get_min_scaling_freq()
 {
-	return get_frequency_from_path(MIN_SCALING_FREQ_PATH);
+	return ldx_cpu_policy_get_min_scaling_freq(0);
+}
+
+int ldx_cpu_policy_get_scaling_freq(int policy)
+{
+	return get_policy_int(policy, SCALING_FREQ_PATH);
 }
 
 int ldx_cpu_get_scaling_freq()
 {
-	return get_frequency_from_path(SCALING_FREQ_PATH);
+	return ldx_cpu_policy_get_scaling_freq(0);
 }
 
-int ldx_cpu_set_min_scaling_freq(int freq)
+int ldx_cpu_policy_set_min_scaling_freq(int policy, int freq)
 {
-	if (check_frequency(freq)) {
+	if (check_policy(policy))
+		return EXIT_FAILURE;
+
+	if (check_frequency(policy, freq)) {
 		log_error("%s: Frequency %d is not an available frequency",
 			  __func__, freq);
 		return EXIT_FAILURE;
 	}
 
-	if (freq > ldx_cpu_get_max_scaling_freq()){
+	if (freq > ldx_cpu_policy_get_max_scaling_freq(policy)){
 		log_error("%s: Frequency %d is higher than the max frequency",
 			  __func__, freq);
 		return EXIT_FAILURE;
 	}
 
-	if (write_file(FREQ_PATH MIN_SCALING_FREQ_PATH, "%d", freq) != 0) {
+	if (set_policy_int(policy, MIN_SCALING_FREQ_PATH, freq)) {
 		log_error("%s: Unable to set the min frequency", __func__);
 		return EXIT_FAILURE;
 	}
@@ -541,21 +890,29 @@ int ldx_cpu_set_min_scaling_freq(int freq)
 	return EXIT_SUCCESS;
 }
 
-int ldx_cpu_set_max_scaling_freq(int freq)
+int ldx_cpu_set_min_scaling_freq(int freq)
 {
-	if (check_frequency(freq)) {
+	return ldx_cpu_policy_set_min_scaling_freq(0, freq);
+}
+
+int ldx_cpu_policy_set_max_scaling_freq(int policy, int freq)
+{
+	if (check_policy(policy))
+		return EXIT_FAILURE;
+
+	if (check_frequency(policy, freq)) {
 		log_error("%s: Frequency %d is not an available frequency",
 				  __func__, freq);
 		return EXIT_FAILURE;
 	}
 
-	if (freq < ldx_cpu_get_min_scaling_freq()) {
+	if (freq < ldx_cpu_policy_get_min_scaling_freq(policy)) {
 		log_error("%s: Frequency %d is lower than the min frequency",
 				  __func__, freq);
 		return EXIT_FAILURE;
 	}
 
-	if (write_file(FREQ_PATH MAX_SCALING_FREQ_PATH, "%d", freq) != 0) {
+	if (set_policy_int(policy, MAX_SCALING_FREQ_PATH, freq)) {
 		log_error("%s: Unable to set the max frequency",
 				  __func__);
 		return EXIT_FAILURE;
@@ -564,23 +921,136 @@ int ldx_cpu_set_max_scaling_freq(int freq)
 	return EXIT_SUCCESS;
 }
 
-int ldx_cpu_set_scaling_freq(int freq)
+int ldx_cpu_set_max_scaling_freq(int freq)
 {
-	if (check_frequency(freq)) {
+	return ldx_cpu_policy_set_max_scaling_freq(0, freq);
+}
+
+int ldx_cpu_policy_set_scaling_freq(int policy, int freq)
+{
+	if (check_policy(policy))
+		return EXIT_FAILURE;
+
+	if (check_frequency(policy, freq)) {
 		log_error("%s: Frequency %d is not an available frequency",
 				  __func__, freq);
 		return EXIT_FAILURE;
 	}
 
-	if (write_file(FREQ_PATH SCALING_FREQ_PATH, "%d", freq) != 0) {
-		log_error("%s: Unable to set the frequency %s %d",
-				  __func__, FREQ_PATH SCALING_FREQ_PATH ,freq);
+	if (set_policy_int(policy, SCALING_FREQ_PATH, freq)) {
+		log_error("%s: Unable to set the frequency %d of policy %d",
+				  __func__, freq, policy);
 		return EXIT_FAILURE;
 	}
 
 	return EXIT_SUCCESS;
 }
 
+int ldx_cpu_set_scaling_freq(int freq)
+{
+	return ldx_cpu_policy_set_scaling_freq(0, freq);
+}
+
+int ldx_cpu_apply_profile(const cpu_profile_t *profile)
+{
+	int n_cores, n_online = 0, i;
+	size_t p;
+
+	if (profile == NULL || (profile->n_policies > 0 && profile->policies == NULL)
+	    || (profile->n_cores > 0 && profile->cores_online == NULL)) {
+		log_error("%s: Invalid profile", __func__);
+		return EXIT_FAILURE;
+	}
+
+	/* Validate everything before changing anything */
+	n_cores = ldx_cpu_get_number_of_cores();
+	if (n_cores <= 0 || profile->n_cores > (size_t)n_cores) {
+		log_error("%s: Invalid number of cores in the profile", __func__);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < n_cores; i++) {
+		int online = (size_t)i < profile->n_cores ? profile->cores_online[i] : -1;
+
+		if (online < 0) {
+			online = ldx_cpu_get_status_core(i);
+			/* Cores that cannot go offline have no 'online' file */
+			if (online < 0)
+				online = ENABLED;
+		} else if (online == DISABLED && ldx_cpu_get_status_core(i) < 0) {
+			log_error("%s: Core %d cannot be disabled", __func__, i);
+			return EXIT_FAILURE;
+		}
+		n_online += online != DISABLED;
+	}
+
+	if (n_online == 0) {
+		log_error("%s: At least one core must stay enabled", __func__);
+		return EXIT_FAILURE;
+	}
+
+	for (p = 0; p < profile->n_policies; p++) {
+		const cpu_policy_profile_t *pol = &profile->policies[p];
+		int min_freq = pol->min_freq, max_freq = pol->max_freq;
+
+		if (check_policy(pol->policy))
+			return EXIT_FAILURE;
+
+		if (pol->governor != GOVERNOR_INVALID
+		    && check_governor(pol->policy, pol->governor)) {
+			log_error("%s: Governor %d is not available for policy %d",
+				  __func__, pol->governor, pol->policy);
+			return EXIT_FAILURE;
+		}
+
+		if ((min_freq >= 0 && check_frequency(pol->policy, min_freq))
+		    || (max_freq >= 0 && check_frequency(pol->policy, max_freq))) {
+			log_error("%s: Invalid frequencies for policy %d", __func__,
+				  pol->policy);
+			return EXIT_FAILURE;
+		}
+
+		if (min_freq < 0)
+			min_freq = ldx_cpu_policy_get_min_scaling_freq(pol->policy);
+		if (max_freq < 0)
+			max_freq = ldx_cpu_policy_get_max_scaling_freq(pol->policy);
+		if (min_freq > max_freq) {
+			log_error("%s: Min frequency %d is higher than max frequency %d for policy %d",
+				  __func__, min_freq, max_freq, pol->policy);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* Policies of offline cores may be inactive, so enable cores first */
+	for (i = 0; (size_t)i < profile->n_cores; i++) {
+		if (profile->cores_online[i] == ENABLED
+		    && ldx_cpu_get_status_core(i) == DISABLED
+		    && ldx_cpu_enable_core(i))
+			return EXIT_FAILURE;
+	}
+
+	for (p = 0; p < profile->n_policies; p++) {
+		const cpu_policy_profile_t *pol = &profile->policies[p];
+
+		if (pol->governor != GOVERNOR_INVALID
+		    && write_policy_attr(pol->policy, SCALING_GOVERNOR,
+					 ldx_cpu_get_governor_string_from_type(pol->governor)))
+			return EXIT_FAILURE;
+
+		if (set_freq_limits(pol->policy, pol->min_freq, pol->max_freq))
+			return EXIT_FAILURE;
+	}
+
+	for (i = 0; (size_t)i < profile->n_cores; i++) {
+		if (profile->cores_online[i] == DISABLED
+		    && ldx_cpu_get_status_core(i) == ENABLED
+		    && ldx_cpu_disable_core(i))
+			return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
 int ldx_cpu_get_current_temp()
 {
 	return get_int_from_path(TEMP_PATH TEMPERATURE);
@@ -655,41 +1125,162 @@ int ldx_cpu_set_critical_trip_point(int temp)
 
 int ldx_cpu_get_usage()
 {
-	long double a[4], b[4];
-	FILE *fp;
+	cpu_sampler_t *sampler;
+	cpu_sample_t sample;
+	int usage = -1;
 
-	fp = fopen(CPU_USAGE_PATH,"r");
-	if (fp == NULL) {
+	sampler = ldx_cpu_sampler_create();
+	if (sampler == NULL) {
 		log_error("%s: Unable to get the cpu usage",  __func__);
 		return -1;
 	}
 
-	if (fscanf(fp, "%*s %Lf %Lf %Lf %Lf", &a[0], &a[1], &a[2], &a[3]) == -1) {
+	sleep(1);
+
+	if (ldx_cpu_sampler_read(sampler, &sample) == EXIT_SUCCESS)
+		usage = sample.usage;
+	else
 		log_error("%s: Error getting the cpu usage",  __func__);
-		fclose(fp);
-		return -1;
+
+	ldx_cpu_sampler_free(sampler);
+
+	return usage;
+}
+
+cpu_sampler_t *ldx_cpu_sampler_create(void)
+{
+	cpu_sampler_t *new_sampler = NULL;
+	cpu_sampler_internal_t *_data = NULL;
+	int n_cores = ldx_cpu_get_number_of_cores();
+	cpu_sampler_t init_sampler = {
+		.n_cores = n_cores,
+		._data = NULL,
+	};
+
+	if (n_cores <= 0)
+		return NULL;
+
+	new_sampler = calloc(1, sizeof(cpu_sampler_t));
+	_data = calloc(1, sizeof(cpu_sampler_internal_t));
+	if (new_sampler == NULL || _data == NULL)
+		goto err_no_mem;
+
+	_data->stat_fd = _data->temp_fd = _data->freq_fd = -1;
+	_data->buf_len = CPU_STAT_LINE_LEN * (n_cores + 1);
+	_data->buf = malloc(_data->buf_len);
+	_data->prev = calloc(n_cores + 1, sizeof(cpu_times_t));
+	_data->cur = calloc(n_cores + 1, sizeof(cpu_times_t));
+	_data->core_usage = calloc(n_cores, sizeof(int));
+	if (_data->buf == NULL || _data->prev == NULL || _data->cur == NULL
+	    || _data->core_usage == NULL)
+		goto err_no_mem;
+
+	_data->stat_fd = open(CPU_USAGE_PATH, O_RDONLY | O_CLOEXEC);
+	if (_data->stat_fd < 0) {
+		log_error("%s: Unable to open '%s'", __func__, CPU_USAGE_PATH);
+		goto err_free;
 	}
 
-	fclose(fp);
+	/* Temperature and frequency are optional */
+	_data->temp_fd = open(TEMP_PATH TEMPERATURE, O_RDONLY | O_CLOEXEC);
+	if (_data->temp_fd < 0)
+		log_debug("%s: CPU temperature not available", __func__);
+	_data->freq_fd = open(FREQ_PATH CUR_FREQ_PATH, O_RDONLY | O_CLOEXEC);
+	if (_data->freq_fd < 0)
+		log_debug("%s: CPU frequency not available", __func__);
 
-	sleep(1);
+	if (read_cpu_times(_data, n_cores, _data->prev) != EXIT_SUCCESS) {
+		log_error("%s: Unable to read the CPU times", __func__);
+		goto err_free;
+	}
 
-	fp = fopen(CPU_USAGE_PATH,"r");
-	if (fp == NULL) {
-		log_error("%s: Unable to get the cpu usage",  __func__);
-		return -1;
+	memcpy(new_sampler, &init_sampler, sizeof(cpu_sampler_t));
+	new_sampler->_data = _data;
+
+	return new_sampler;
+
+err_no_mem:
+	log_error("%s: Unable to allocate memory for the sampler", __func__);
+err_free:
+	if (_data != NULL) {
+		if (_data->stat_fd >= 0)
+			close(_data->stat_fd);
+		if (_data->temp_fd >= 0)
+			close(_data->temp_fd);
+		if (_data->freq_fd >= 0)
+			close(_data->freq_fd);
+		free(_data->buf);
+		free(_data->prev);
+		free(_data->cur);
+		free(_data->core_usage);
 	}
+	free(_data);
+	free(new_sampler);
+
+	return NULL;
+}
 
-	if (fscanf(fp, "%*s %Lf %Lf %Lf %Lf", &b[0], &b[1], &b[2], &b[3]) == -1) {
-			log_error("%s: Error getting the cpu usage",  __func__);
-			fclose(fp);
-			return -1;
+int ldx_cpu_sampler_read(cpu_sampler_t *sampler, cpu_sample_t *sample)
+{
+	cpu_sampler_internal_t *_data;
+	cpu_times_t *tmp;
+	struct timespec now;
+	int i;
+
+	if (sampler == NULL || sample == NULL) {
+		log_error("%s: Invalid sampler", __func__);
+		return EXIT_FAILURE;
 	}
 
-	fclose(fp);
+	_data = sampler->_data;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
 
-	return (((b[0] + b[1] + b[2]) - (a[0] + a[1] + a[2]))) * 100 /
-			((b[0] + b[1] + b[2] + b[3]) - (a[0] + a[1] + a[2] + a[3]));
+	if (read_cpu_times(_data, sampler->n_cores, _data->cur) != EXIT_SUCCESS) {
+		log_error("%s: Unable to read the CPU times", __func__);
+		return EXIT_FAILURE;
+	}
+
+	sample->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	sample->usage = get_usage(&_data->prev[0], &_data->cur[0]);
+	for (i = 0; i < sampler->n_cores; i++)
+		_data->core_usage[i] = get_usage(&_data->prev[i + 1], &_data->cur[i + 1]);
+	sample->n_cores = sampler->n_cores;
+	sample->core_usage = _data->core_usage;
+
+	if (_data->temp_fd < 0 || read_int_fd(_data->temp_fd, &sample->temp) != EXIT_SUCCESS)
+		sample->temp = -1;
+	if (_data->freq_fd < 0 || read_int_fd(_data->freq_fd, &sample->freq) != EXIT_SUCCESS)
+		sample->freq = -1;
+
+	/* The current times are the reference of the next sample */
+	tmp = _data->prev;
+	_data->prev = _data->cur;
+	_data->cur = tmp;
+
+	return EXIT_SUCCESS;
+}
+
+void ldx_cpu_sampler_free(cpu_sampler_t *sampler)
+{
+	cpu_sampler_internal_t *_data;
+
+	if (sampler == NULL)
+		return;
+
+	_data = sampler->_data;
+
+	close(_data->stat_fd);
+	if (_data->temp_fd >= 0)
+		close(_data->temp_fd);
+	if (_data->freq_fd >= 0)
+		close(_data->freq_fd);
+	free(_data->buf);
+	free(_data->prev);
+	free(_data->cur);
+	free(_data->core_usage);
+	free(_data);
+	free(sampler);
 }
 
 int ldx_gpu_set_multiplier(int multiplier) {
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "_log.h"
+#include "reactor.h"
+
+/* Maximum number of ready descriptors served per epoll_wait() call */
+#define REACTOR_MAX_EVENTS	32
+
+/* Slot index used to identify the stop eventfd */
+#define REACTOR_STOP_IDX	UINT32_MAX
+
+/*
+ * The epoll data of each descriptor encodes its slot index and the
+ * generation of the slot, so events of a descriptor that was removed
+ * (and whose slot could have been reused) are discarded.
+ */
+#define REACTOR_DATA(idx, gen)	(((uint64_t)(gen) << 32) | (idx))
+#define REACTOR_DATA_IDX(data)	((uint32_t)(data))
+#define REACTOR_DATA_GEN(data)	((uint32_t)((data) >> 32))
+
+/**
+ * reactor_slot_t - Descriptor watched by the reactor
+ *
+ * @fd:		The watched descriptor.
+ * @events:	The events to watch.
+ * @cb:		Callback to execute when the descriptor is ready.
+ * @arg:	Argument of the callback.
+ * @gen:	Generation of the slot, incremented each time it is released.
+ * @used:	True if the slot holds a descriptor.
+ * @busy:	True while the callback is running.
+ * @removed:	True if the descriptor was removed while the callback was running.
+ * @busy_thr:	Thread running the callback.
+ */
+typedef struct {
+	int			fd;
+	uint32_t		events;
+	ldx_reactor_cb_t	cb;
+	void			*arg;
+	uint32_t		gen;
+	bool			used;
+	bool			busy;
+	bool			removed;
+	pthread_t		busy_thr;
+} reactor_slot_t;
+
+/**
+ * reactor_priv_t - Internal data of a reactor
+ *
+ * @epfd:	Epoll instance.
+ * @stop_fd:	Eventfd used to stop the threads running the reactor.
+ * @stop:	True once the reactor has been stopped.
+ * @slots:	Table of watched descriptors.
+ * @mutex:	Mutex protecting the slot table.
+ * @cond:	Signaled each time a busy slot is released.
+ */
+typedef struct {
+	int			epfd;
+	int			stop_fd;
+	volatile bool		stop;
+	reactor_slot_t		*slots;
+	pthread_mutex_t		mutex;
+	pthread_cond_t		cond;
+} reactor_priv_t;
+
+static int check_reactor(reactor_t *reactor);
+
+/**
+ * release_slot() - Mark a slot as free
+ *
+ * @priv:	The reactor internal data.
+ * @slot:	The slot to release.
+ *
+ * Must be called with the mutex held.
+ */
+static void release_slot(reactor_priv_t *priv, reactor_slot_t *slot)
+{
+	slot->used = false;
+	slot->busy = false;
+	slot->removed = false;
+	slot->gen++;
+	pthread_cond_broadcast(&priv->cond);
+}
+
+/**
+ * arm_slot() - Arm the descriptor of a slot for its next event
+ *
+ * @priv:	The reactor internal data.
+ * @slot:	The slot to arm.
+ * @op:		EPOLL_CTL_ADD or EPOLL_CTL_MOD.
+ *
+ * Descriptors are armed as one-shot, so when several threads run the
+ * reactor each event is delivered to only one of them.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int arm_slot(reactor_priv_t *priv, reactor_slot_t *slot, int op)
+{
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = slot->events | EPOLLONESHOT;
+	ev.data.u64 = REACTOR_DATA(slot - priv->slots, slot->gen);
+
+	return epoll_ctl(priv->epfd, op, slot->fd, &ev);
+}
+
+reactor_t *ldx_reactor_create(unsigned int max_fds)
+{
+	reactor_t *new_reactor = NULL;
+	reactor_priv_t *priv = NULL;
+	struct epoll_event ev;
+	reactor_t init_reactor = {
+		.max_fds = max_fds ? max_fds : LDX_REACTOR_DEF_MAX_FDS,
+		._data = NULL,
+	};
+
+	max_fds = init_reactor.max_fds;
+
+	log_debug("%s: Creating reactor for %u descriptors", __func__, max_fds);
+
+	new_reactor = calloc(1, sizeof(reactor_t));
+	priv = calloc(1, sizeof(reactor_priv_t));
+	if (!new_reactor || !priv) {
+		log_error("%s: Unable to allocate memory for the reactor", __func__);
+		goto err_free;
+	}
+
+	priv->slots = calloc(max_fds, sizeof(reactor_slot_t));
+	if (!priv->slots) {
+		log_error("%s: Unable to allocate memory for the reactor", __func__);
+		goto err_free;
+	}
+
+	priv->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (priv->epfd < 0) {
+		log_error("%s: Unable to create epoll instance (%d)", __func__, errno);
+		goto err_free;
+	}
+
+	priv->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (priv->stop_fd < 0) {
+		log_error("%s: Unable to create eventfd (%d)", __func__, errno);
+		goto err_epoll_close;
+	}
+
+	/* Level triggered and never read, so it wakes up every thread */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = REACTOR_DATA(REACTOR_STOP_IDX, 0);
+	if (epoll_ctl(priv->epfd, EPOLL_CTL_ADD, priv->stop_fd, &ev)) {
+		log_error("%s: Unable to watch the eventfd (%d)", __func__, errno);
+		goto err_evfd_close;
+	}
+
+	pthread_mutex_init(&priv->mutex, NULL);
+	pthread_cond_init(&priv->cond, NULL);
+
+	memcpy(new_reactor, &init_reactor, sizeof(reactor_t));
+	new_reactor->_data = priv;
+
+	return new_reactor;
+
+err_evfd_close:
+	close(priv->stop_fd);
+
+err_epoll_close:
+	close(priv->epfd);
+
+err_free:
+	if (priv)
+		free(priv->slots);
+	free(priv);
+	free(new_reactor);
+
+	return NULL;
+}
+
+int ldx_reactor_free(reactor_t *reactor)
+{
+	reactor_priv_t *priv;
+
+	if (reactor == NULL)
+		return EXIT_SUCCESS;
+
+	log_debug("%s: Freeing reactor", __func__);
+
+	priv = reactor->_data;
+	if (priv) {
+		close(priv->stop_fd);
+		close(priv->epfd);
+		pthread_cond_destroy(&priv->cond);
+		pthread_mutex_destroy(&priv->mutex);
+		free(priv->slots);
+		free(priv);
+	}
+
+	free(reactor);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_reactor_add_fd(reactor_t *reactor, int fd, uint32_t events,
+		       const ldx_reactor_cb_t cb, void *arg)
+{
+	reactor_priv_t *priv;
+	reactor_slot_t *slot = NULL;
+	unsigned int i;
+	int ret = EXIT_FAILURE;
+
+	if (check_reactor(reactor) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (fd < 0 || cb == NULL) {
+		log_error("%s: Invalid descriptor or callback", __func__);
+		return EXIT_FAILURE;
+	}
+
+	priv = reactor->_data;
+
+	pthread_mutex_lock(&priv->mutex);
+
+	for (i = 0; i < reactor->max_fds; i++) {
+		if (!priv->slots[i].used) {
+			if (!slot)
+				slot = &priv->slots[i];
+		} else if (priv->slots[i].fd == fd) {
+			log_error("%s: Descriptor %d already added", __func__, fd);
+			goto out_unlock;
+		}
+	}
+
+	if (!slot) {
+		log_error("%s: No room for descriptor %d (max %u)", __func__, fd,
+			  reactor->max_fds);
+		goto out_unlock;
+	}
+
+	slot->fd = fd;
+	slot->events = events;
+	slot->cb = cb;
+	slot->arg = arg;
+
+	if (arm_slot(priv, slot, EPOLL_CTL_ADD)) {
+		log_error("%s: Unable to watch descriptor %d (%d)", __func__, fd,
+			  errno);
+		goto out_unlock;
+	}
+
+	slot->used = true;
+	ret = EXIT_SUCCESS;
+
+out_unlock:
+	pthread_mutex_unlock(&priv->mutex);
+
+	return ret;
+}
+
+int ldx_reactor_del_fd(reactor_t *reactor, int fd)
+{
+	reactor_priv_t *priv;
+	reactor_slot_t *slot = NULL;
+	unsigned int i;
+	uint32_t gen;
+
+	if (check_reactor(reactor) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	priv = reactor->_data;
+
+	pthread_mutex_lock(&priv->mutex);
+
+	for (i = 0; i < reactor->max_fds; i++) {
+		if (priv->slots[i].used && !priv->slots[i].removed &&
+		    priv->slots[i].fd == fd) {
+			slot = &priv->slots[i];
+			break;
+		}
+	}
+
+	if (!slot) {
+		log_error("%s: Descriptor %d not found", __func__, fd);
+		pthread_mutex_unlock(&priv->mutex);
+		return EXIT_FAILURE;
+	}
+
+	epoll_ctl(priv->epfd, EPOLL_CTL_DEL, fd, NULL);
+
+	if (!slot->busy) {
+		release_slot(priv, slot);
+	} else {
+		/* The thread running the callback releases the slot */
+		slot->removed = true;
+		if (!pthread_equal(slot->busy_thr, pthread_self())) {
+			gen = slot->gen;
+			while (slot->gen == gen)
+				pthread_cond_wait(&priv->cond, &priv->mutex);
+		}
+	}
+
+	pthread_mutex_unlock(&priv->mutex);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_reactor_run_once(reactor_t *reactor, int timeout)
+{
+	reactor_priv_t *priv;
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+	int nfds, i, dispatched = 0;
+
+	if (check_reactor(reactor) != EXIT_SUCCESS)
+		return -1;
+
+	priv = reactor->_data;
+
+	nfds = epoll_wait(priv->epfd, events, REACTOR_MAX_EVENTS, timeout);
+	if (nfds < 0) {
+		if (errno == EINTR)
+			return 0;
+
+		log_error("%s: epoll_wait error (%d)", __func__, errno);
+		return -1;
+	}
+
+	for (i = 0; i < nfds; i++) {
+		uint32_t idx = REACTOR_DATA_IDX(events[i].data.u64);
+		uint32_t gen = REACTOR_DATA_GEN(events[i].data.u64);
+		reactor_slot_t *slot;
+		ldx_reactor_cb_t cb;
+		void *arg;
+		int fd;
+
+		if (idx == REACTOR_STOP_IDX)
+			continue;
+
+		slot = &priv->slots[idx];
+
+		pthread_mutex_lock(&priv->mutex);
+		if (!slot->used || slot->removed || slot->gen != gen) {
+			/* Removed after epoll_wait() returned */
+			pthread_mutex_unlock(&priv->mutex);
+			continue;
+		}
+		slot->busy = true;
+		slot->busy_thr = pthread_self();
+		cb = slot->cb;
+		arg = slot->arg;
+		fd = slot->fd;
+		pthread_mutex_unlock(&priv->mutex);
+
+		cb(fd, events[i].events, arg);
+		dispatched++;
+
+		pthread_mutex_lock(&priv->mutex);
+		if (slot->removed) {
+			release_slot(priv, slot);
+		} else {
+			slot->busy = false;
+			if (arm_slot(priv, slot, EPOLL_CTL_MOD))
+				log_error("%s: Unable to rearm descriptor %d (%d)",
+					  __func__, fd, errno);
+		}
+		pthread_mutex_unlock(&priv->mutex);
+	}
+
+	return dispatched;
+}
+
+int ldx_reactor_run(reactor_t *reactor)
+{
+	reactor_priv_t *priv;
+
+	if (check_reactor(reactor) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	priv = reactor->_data;
+
+	log_debug("%s: Running reactor", __func__);
+
+	while (!priv->stop) {
+		if (ldx_reactor_run_once(reactor, -1) < 0)
+			return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_reactor_stop(reactor_t *reactor)
+{
+	reactor_priv_t *priv;
+	uint64_t val = 1;
+
+	if (check_reactor(reactor) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	priv = reactor->_data;
+
+	log_debug("%s: Stopping reactor", __func__);
+
+	priv->stop = true;
+	if (write(priv->stop_fd, &val, sizeof(val)) < 0) {
+		log_error("%s: Unable to wake up the reactor (%d)", __func__, errno);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * check_reactor() - Verify that the reactor pointer is valid
+ *
+ * @reactor:	The reactor pointer to check.
+ *
+ * Return: EXIT_SUCCESS if the reactor is valid, EXIT_FAILURE otherwise.
+ */
+static int check_reactor(reactor_t *reactor)
+{
+	if (reactor == NULL || reactor->_data == NULL) {
+		log_error("%s: Reactor cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
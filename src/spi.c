@@ -14,8 +14,10 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <glob.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -26,12 +28,21 @@
 #include "_common.h"
 #include "_libsoc_interfaces.h"
 #include "_log.h"
+#include "_spi.h"
+#include "_stats.h"
+#include "_trace.h"
 #include "spi.h"
 
 #define MAX_SPI_DEVICES		10
 #define MAX_SPI_SLAVES		5
 #define HIGH_SPI_BASE		32766
 
+/* Segments of a batch that are prepared on the stack */
+#define SPI_STACK_SEGMENTS	8
+
+#define SPIDEV_BUFSIZ_PATH	"/sys/module/spidev/parameters/bufsiz"
+#define SPIDEV_DEF_BUFSIZ	4096
+
 #define M(x)	#x,
 static const char * const spi_clk_mode_strings[] = {
 	M(SPI_CLK_MODE_0)
@@ -57,6 +68,9 @@ static const char * const spi_bpw_strings[] = {
 };
 #undef M
 
+static inline libsoc_spi_t *get_libsoc_spi(spi_t *spi);
+static void spi_bus_acquire(spi_t *spi);
+static int spi_bus_release(spi_t *spi);
 static int check_spi(spi_t *spi);
 static int check_transfer_mode(spi_transfer_cfg_t *transfer_mode);
 static int check_clock_mode(spi_clk_mode_t clock_mode);
@@ -64,10 +78,16 @@ static int check_chip_select(spi_cs_t chip_select);
 static int check_bit_order(spi_bo_t bit_order);
 static int check_bpw(spi_bpw_t bpw);
 static int check_data_buffer(uint8_t *buffer);
+static size_t get_spidev_bufsiz(void);
+static int spi_transfer_segments(spi_t *spi, spi_segment_t *segs, unsigned int n);
+
+static size_t spidev_bufsiz = SPIDEV_DEF_BUFSIZ;
+static pthread_once_t spidev_bufsiz_once = PTHREAD_ONCE_INIT;
 
 spi_t *ldx_spi_request(unsigned int spi_device, unsigned int spi_slave)
 {
 	libsoc_spi_t *_spi = NULL;
+	spi_internal_t *internal_data = NULL;
 	spi_t *new_spi = NULL;
 	spi_t init_spi = {
 		.alias = NULL,
@@ -84,15 +104,30 @@ spi_t *ldx_spi_request(unsigned int spi_device, unsigned int spi_slave)
 		return NULL;
 
 	new_spi = calloc(1, sizeof(spi_t));
-	if (new_spi == NULL) {
+	internal_data = calloc(1, sizeof(spi_internal_t));
+	if (new_spi == NULL || internal_data == NULL) {
 		log_error("%s: Unable to request SPI %d:%d, cannot allocate memory",
 			  __func__, spi_device, spi_slave);
 		libsoc_spi_free(_spi);
+		free(new_spi);
+		free(internal_data);
+		return NULL;
+	}
+
+	internal_data->sched = bus_sched_get(BUS_TYPE_SPI, spi_device);
+	if (internal_data->sched == NULL) {
+		libsoc_spi_free(_spi);
+		free(new_spi);
+		free(internal_data);
 		return NULL;
 	}
+	internal_data->libsoc = _spi;
+	internal_data->async = NULL;
+	pthread_mutex_init(&internal_data->async_lock, NULL);
+	internal_data->prio = BUS_PRIO_NORMAL;
 
 	memcpy(new_spi, &init_spi, sizeof(spi_t));
-	((spi_t *)new_spi)->_data = _spi;
+	((spi_t *)new_spi)->_data = internal_data;
 
 	return new_spi;
 }
@@ -224,8 +259,17 @@ int ldx_spi_free(spi_t *spi)
 	log_debug("%s: Freeing SPI %d:%d", __func__, spi->spi_device,
 		  spi->spi_slave);
 
-	if (spi->_data != NULL)
-		ret = libsoc_spi_free(spi->_data);
+	if (spi->_data != NULL) {
+		spi_internal_t *_spi = (spi_internal_t *)spi->_data;
+
+		if (ldx_spi_async_stop(spi) != EXIT_SUCCESS)
+			ret = EXIT_FAILURE;
+		if (libsoc_spi_free(_spi->libsoc) != EXIT_SUCCESS)
+			ret = EXIT_FAILURE;
+		bus_sched_put(_spi->sched);
+		pthread_mutex_destroy(&_spi->async_lock);
+		free(_spi);
+	}
 
 	free(spi);
 
@@ -278,7 +322,7 @@ int ldx_spi_set_transfer_mode(spi_t *spi_dev, spi_transfer_cfg_t *transfer_mode)
 		break;
 	}
 
-	_spi = (libsoc_spi_t *)spi_dev->_data;
+	_spi = get_libsoc_spi(spi_dev);
 
 	if (ioctl(_spi->fd, SPI_IOC_WR_MODE, &new_value) == -1) {
 		log_error("%s: Unable to set SPI %d:%d transfer mode to to:\n - Clock mode '%s' (%d)\n - Chip select '%s' (%d)\n - Bit order '%s' (%d)\n",
@@ -311,7 +355,7 @@ int ldx_spi_get_transfer_mode(spi_t *spi, spi_transfer_cfg_t *transfer_mode)
 	log_debug("%s: Getting transfer mode of SPI %d:%d", __func__,
 		  spi->spi_device, spi->spi_slave);
 
-	_spi = (libsoc_spi_t *)spi->_data;
+	_spi = get_libsoc_spi(spi);
 
 	if (ioctl(_spi->fd, SPI_IOC_RD_MODE, &read_value) == -1) {
 		log_error("%s: Unable to get SPI %d:%d transfer mode",
@@ -397,7 +441,7 @@ int ldx_spi_set_bits_per_word(spi_t *spi, spi_bpw_t bpw)
 		return EXIT_FAILURE;
 	}
 
-	if (libsoc_spi_set_bits_per_word(spi->_data, _bpw) != EXIT_SUCCESS) {
+	if (libsoc_spi_set_bits_per_word(get_libsoc_spi(spi), _bpw) != EXIT_SUCCESS) {
 		log_error("%s: Unable to set SPI %d:%d bits-per-word to '%s' (%d)",
 			  __func__, spi->spi_device, spi->spi_slave,
 			  spi_bpw_strings[bpw], bpw);
@@ -417,7 +461,7 @@ spi_bpw_t ldx_spi_get_bits_per_word(spi_t *spi)
 	log_debug("%s: Getting bits-per-word of SPI %d:%d", __func__,
 		  spi->spi_device, spi->spi_slave);
 
-	bpw = libsoc_spi_get_bits_per_word(spi->_data);
+	bpw = libsoc_spi_get_bits_per_word(get_libsoc_spi(spi));
 	if (bpw == BPW_ERROR) {
 		log_error("%s: Unable to get SPI %d:%d bits-per-word",
 			  __func__, spi->spi_device, spi->spi_slave);
@@ -443,7 +487,7 @@ int ldx_spi_set_speed(spi_t *spi, unsigned int speed)
 	log_debug("%s: Setting SPI %d:%d speed to %dHz", __func__,
 		  spi->spi_device, spi->spi_slave, speed);
 
-	if (libsoc_spi_set_speed(spi->_data, speed) == EXIT_FAILURE) {
+	if (libsoc_spi_set_speed(get_libsoc_spi(spi), speed) == EXIT_FAILURE) {
 		log_error("%s: Unable to set SPI %d:%d speed to %dHz",
 			  __func__, spi->spi_device, spi->spi_slave, speed);
 		return EXIT_FAILURE;
@@ -462,7 +506,7 @@ int ldx_spi_get_speed(spi_t *spi)
 	log_debug("%s: Getting SPI %d:%d speed", __func__, spi->spi_device,
 		  spi->spi_slave);
 
-	speed = libsoc_spi_get_speed(spi->_data);
+	speed = libsoc_spi_get_speed(get_libsoc_spi(spi));
 	if (speed == -1) {
 		log_error("%s: Unable to get SPI %d:%d speed", __func__,
 			  spi->spi_device, spi->spi_slave);
@@ -472,8 +516,10 @@ int ldx_spi_get_speed(spi_t *spi)
 	return speed;
 }
 
-int ldx_spi_write(spi_t *spi, uint8_t *tx_data, unsigned int length)
+static int spi_write(spi_t *spi, uint8_t *tx_data, unsigned int length)
 {
+	int ret;
+
 	if (check_spi(spi) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
@@ -486,8 +532,20 @@ int ldx_spi_write(spi_t *spi, uint8_t *tx_data, unsigned int length)
 	log_debug("%s: Writing %d bytes to SPI %d:%d", __func__, length,
 		  spi->spi_device, spi->spi_slave);
 
-	if (libsoc_spi_write(spi->_data, tx_data, length) != EXIT_SUCCESS) {
-		log_error("%s: Unable to write %d bytes to SPI %d:%d", __func__,
+	if (length > get_spidev_bufsiz()) {
+		spi_segment_t seg = {
+			.tx_data = tx_data,
+			.length = length,
+		};
+
+		return spi_transfer_segments(spi, &seg, 1);
+	}
+
+	spi_bus_acquire(spi);
+	ret = libsoc_spi_write(get_libsoc_spi(spi), tx_data, length);
+	spi_bus_release(spi);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to write %d bytes to SPI %d:%d", __func__,
 			  length, spi->spi_device, spi->spi_slave);
 		return EXIT_FAILURE;
 	}
@@ -495,8 +553,23 @@ int ldx_spi_write(spi_t *spi, uint8_t *tx_data, unsigned int length)
 	return EXIT_SUCCESS;
 }
 
-int ldx_spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length)
+int ldx_spi_write(spi_t *spi, uint8_t *tx_data, unsigned int length)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_spi_begin(__func__, spi, length);
+	ret = spi_write(spi, tx_data, length);
+	trace_spi_end(__func__, spi, ret);
+	stats_end(STATS_API_SPI_WRITE, start, stats_result(ret), length);
+
+	return ret;
+}
+
+static int spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length)
 {
+	int ret;
+
 	if (check_spi(spi) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
@@ -509,8 +582,20 @@ int ldx_spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length)
 	log_debug("%s: Reading %d bytes from SPI %d:%d", __func__, length,
 		  spi->spi_device, spi->spi_slave);
 
-	if (libsoc_spi_read(spi->_data, rx_data, length) != EXIT_SUCCESS) {
-		log_error("%s: Unable to read %d bytes from SPI %d:%d",
+	if (length > get_spidev_bufsiz()) {
+		spi_segment_t seg = {
+			.rx_data = rx_data,
+			.length = length,
+		};
+
+		return spi_transfer_segments(spi, &seg, 1);
+	}
+
+	spi_bus_acquire(spi);
+	ret = libsoc_spi_read(get_libsoc_spi(spi), rx_data, length);
+	spi_bus_release(spi);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to read %d bytes from SPI %d:%d",
 			  __func__, length, spi->spi_device, spi->spi_slave);
 		return EXIT_FAILURE;
 	}
@@ -518,8 +603,24 @@ int ldx_spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length)
 	return EXIT_SUCCESS;
 }
 
-int ldx_spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data, unsigned int length)
+int ldx_spi_read(spi_t *spi, uint8_t *rx_data, unsigned int length)
 {
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_spi_begin(__func__, spi, length);
+	ret = spi_read(spi, rx_data, length);
+	trace_spi_end(__func__, spi, ret);
+	stats_end(STATS_API_SPI_READ, start, stats_result(ret), length);
+
+	return ret;
+}
+
+static int spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data,
+			unsigned int length)
+{
+	int ret;
+
 	if (check_spi(spi) != EXIT_SUCCESS)
 		return EXIT_FAILURE;
 
@@ -535,8 +636,21 @@ int ldx_spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data, unsigned in
 	log_debug("%s: Transferring %d bytes on SPI %d:%d", __func__, length,
 		  spi->spi_device, spi->spi_slave);
 
-	if (libsoc_spi_rw(spi->_data, tx_data, rx_data, length) != EXIT_SUCCESS) {
-		log_error("%s: Unable to transfer %d bytes on SPI %d:%d",
+	if (length > get_spidev_bufsiz()) {
+		spi_segment_t seg = {
+			.tx_data = tx_data,
+			.rx_data = rx_data,
+			.length = length,
+		};
+
+		return spi_transfer_segments(spi, &seg, 1);
+	}
+
+	spi_bus_acquire(spi);
+	ret = libsoc_spi_rw(get_libsoc_spi(spi), tx_data, rx_data, length);
+	spi_bus_release(spi);
+	if (ret != EXIT_SUCCESS) {
+		log_error_ratelimited("%s: Unable to transfer %d bytes on SPI %d:%d",
 			  __func__, length, spi->spi_device, spi->spi_slave);
 		return EXIT_FAILURE;
 	}
@@ -544,6 +658,519 @@ int ldx_spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data, unsigned in
 	return EXIT_SUCCESS;
 }
 
+int ldx_spi_transfer(spi_t *spi, uint8_t *tx_data, uint8_t *rx_data, unsigned int length)
+{
+	uint64_t start = stats_begin();
+	int ret;
+
+	trace_spi_begin(__func__, spi, length);
+	ret = spi_transfer(spi, tx_data, rx_data, length);
+	trace_spi_end(__func__, spi, ret);
+	stats_end(STATS_API_SPI_TRANSFER, start, stats_result(ret), length);
+
+	return ret;
+}
+
+/**
+ * read_spidev_bufsiz() - Read the maximum message size of spidev
+ *
+ * spidev rejects messages whose total tx or rx length exceeds its 'bufsiz'
+ * module parameter. It cannot change without reloading the module, so it is
+ * read only once.
+ */
+static void read_spidev_bufsiz(void)
+{
+	FILE *f;
+	unsigned long value;
+
+	f = fopen(SPIDEV_BUFSIZ_PATH, "r");
+	if (f == NULL)
+		return;
+
+	if (fscanf(f, "%lu", &value) == 1 && value > 0)
+		spidev_bufsiz = value;
+
+	fclose(f);
+}
+
+/**
+ * get_spidev_bufsiz() - Get the maximum message size of spidev
+ *
+ * Return: The maximum number of bytes in each direction of a message.
+ */
+static size_t get_spidev_bufsiz(void)
+{
+	pthread_once(&spidev_bufsiz_once, read_spidev_bufsiz);
+
+	return spidev_bufsiz;
+}
+
+/**
+ * spi_message() - Submit a SPI message to the kernel
+ *
+ * @spi:	A requested SPI.
+ * @xfers:	Array of transfers of the message.
+ * @n:		Number of transfers.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int spi_message(spi_t *spi, struct spi_ioc_transfer *xfers,
+		       unsigned int n)
+{
+	libsoc_spi_t *_spi = get_libsoc_spi(spi);
+
+	if (ioctl(_spi->fd, SPI_IOC_MESSAGE(n), xfers) < 0) {
+		log_error_ratelimited("%s: Unable to transfer %u segments on SPI %d:%d (%d)",
+			  __func__, n, spi->spi_device, spi->spi_slave, errno);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * spi_transfer_segments() - Transfer segments splitting them to fit spidev
+ *
+ * @spi:	A requested SPI.
+ * @segs:	Array of segments to transfer.
+ * @n:		Number of segments.
+ *
+ * Segments are split in pieces of at most 'bufsiz' bytes that point into the
+ * caller buffers, and the pieces are grouped in as few messages as possible.
+ * Between messages the device is kept selected (unless the segment ending a
+ * message requested a chip select change) by setting 'cs_change' in the last
+ * transfer of the message.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int spi_transfer_segments(spi_t *spi, spi_segment_t *segs, unsigned int n)
+{
+	struct spi_ioc_transfer stack_xfers[SPI_STACK_SEGMENTS];
+	struct spi_ioc_transfer *xfers = stack_xfers;
+	const size_t bufsiz = get_spidev_bufsiz();
+	size_t tx_total = 0, rx_total = 0, npieces = 0, max_xfers;
+	unsigned int nxfers = 0, i;
+	int ret = EXIT_SUCCESS;
+
+	for (i = 0; i < n; i++)
+		npieces += segs[i].length ? (segs[i].length + bufsiz - 1) / bufsiz : 1;
+
+	max_xfers = npieces < LDX_SPI_MAX_SEGMENTS ? npieces : LDX_SPI_MAX_SEGMENTS;
+	if (max_xfers > SPI_STACK_SEGMENTS) {
+		xfers = calloc(max_xfers, sizeof(struct spi_ioc_transfer));
+		if (xfers == NULL) {
+			log_error("%s: Unable to transfer on SPI %d:%d, cannot allocate memory",
+				  __func__, spi->spi_device, spi->spi_slave);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* The whole batch runs in a single turn of the bus */
+	spi_bus_acquire(spi);
+
+	for (i = 0; i < n && ret == EXIT_SUCCESS; i++) {
+		unsigned int offset = 0;
+
+		do {
+			struct spi_ioc_transfer *xfer;
+			size_t len = segs[i].length - offset;
+			bool last_piece;
+
+			if (len > bufsiz)
+				len = bufsiz;
+
+			/* Flush the message if this piece does not fit */
+			if (nxfers == max_xfers ||
+			    (segs[i].tx_data && tx_total + len > bufsiz) ||
+			    (segs[i].rx_data && rx_total + len > bufsiz)) {
+				/*
+				 * At the end of a message cs_change means the
+				 * opposite: keep the device selected.
+				 */
+				xfers[nxfers - 1].cs_change = !xfers[nxfers - 1].cs_change;
+				ret = spi_message(spi, xfers, nxfers);
+				if (ret != EXIT_SUCCESS)
+					break;
+				nxfers = 0;
+				tx_total = 0;
+				rx_total = 0;
+			}
+
+			last_piece = offset + len == segs[i].length;
+
+			xfer = &xfers[nxfers++];
+			memset(xfer, 0, sizeof(*xfer));
+			xfer->tx_buf = segs[i].tx_data ?
+				       (uintptr_t)(segs[i].tx_data + offset) : 0;
+			xfer->rx_buf = segs[i].rx_data ?
+				       (uintptr_t)(segs[i].rx_data + offset) : 0;
+			xfer->len = len;
+			xfer->speed_hz = segs[i].speed;
+			xfer->bits_per_word = segs[i].bits_per_word;
+			if (last_piece) {
+				xfer->delay_usecs = segs[i].delay_usecs;
+				/*
+				 * On the last transfer of the batch cs_change
+				 * already has the meaning the kernel gives it.
+				 */
+				xfer->cs_change = segs[i].cs_change;
+			}
+
+			if (segs[i].tx_data)
+				tx_total += len;
+			if (segs[i].rx_data)
+				rx_total += len;
+			offset += len;
+		} while (offset < segs[i].length);
+	}
+
+	if (ret == EXIT_SUCCESS && nxfers > 0)
+		ret = spi_message(spi, xfers, nxfers);
+
+	spi_bus_release(spi);
+
+	if (xfers != stack_xfers)
+		free(xfers);
+
+	return ret;
+}
+
+static int spi_transfer_batch(spi_t *spi, spi_segment_t *segs, unsigned int n)
+{
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (segs == NULL) {
+		log_error("%s: Segments cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (n == 0)
+		return EXIT_SUCCESS;
+
+	if (n > LDX_SPI_MAX_SEGMENTS) {
+		log_error("%s: Too many segments, %u. Maximum is %d", __func__,
+			  n, LDX_SPI_MAX_SEGMENTS);
+		return EXIT_FAILURE;
+	}
+
+	log_debug("%s: Transferring %u segments on SPI %d:%d", __func__, n,
+		  spi->spi_device, spi->spi_slave);
+
+	return spi_transfer_segments(spi, segs, n);
+}
+
+int ldx_spi_transfer_batch(spi_t *spi, spi_segment_t *segs, unsigned int n)
+{
+	uint64_t start = stats_begin(), bytes = 0;
+	unsigned int i;
+	int ret;
+
+	trace_spi_begin(__func__, spi, n);
+	ret = spi_transfer_batch(spi, segs, n);
+	trace_spi_end(__func__, spi, ret);
+	if (ret == EXIT_SUCCESS) {
+		for (i = 0; i < n; i++)
+			bytes += segs[i].length;
+	}
+	stats_end(STATS_API_SPI_TRANSFER_BATCH, start, stats_result(ret), bytes);
+
+	return ret;
+}
+
+/**
+ * spi_async_worker() - Run the queued requests of a SPI
+ *
+ * @arg:	The SPI (spi_t *).
+ *
+ * Return: NULL.
+ */
+static void *spi_async_worker(void *arg)
+{
+	spi_t *spi = arg;
+	spi_async_t *async = ((spi_internal_t *)spi->_data)->async;
+	spi_request_t req;
+	int status;
+
+	pthread_mutex_lock(&async->lock);
+	while (1) {
+		while (async->count == 0 && !async->stop)
+			pthread_cond_wait(&async->not_empty, &async->lock);
+
+		if (async->count == 0)
+			break;
+
+		req = async->requests[async->head];
+		async->head = (async->head + 1) % async->len;
+		async->count--;
+		async->busy = true;
+		pthread_cond_signal(&async->not_full);
+		pthread_mutex_unlock(&async->lock);
+
+		status = spi_transfer_segments(spi, req.segs, req.n);
+		if (req.cb != NULL)
+			req.cb(spi, req.segs, req.n, status, req.arg);
+
+		pthread_mutex_lock(&async->lock);
+		async->busy = false;
+		if (async->count == 0)
+			pthread_cond_broadcast(&async->idle);
+	}
+	pthread_mutex_unlock(&async->lock);
+
+	return NULL;
+}
+
+int ldx_spi_async_start(spi_t *spi, unsigned int queue_len)
+{
+	spi_internal_t *_spi = NULL;
+	spi_async_t *async = NULL;
+
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_spi = (spi_internal_t *)spi->_data;
+
+	/*
+	 * Lock-free when running, so completion callbacks can submit while
+	 * 'ldx_spi_async_stop()' waits for the worker with the lock held.
+	 */
+	if (__atomic_load_n(&_spi->async, __ATOMIC_ACQUIRE) != NULL)
+		return EXIT_SUCCESS;
+
+	/* Only one of several threads starting the queue creates it */
+	pthread_mutex_lock(&_spi->async_lock);
+	if (_spi->async != NULL) {
+		pthread_mutex_unlock(&_spi->async_lock);
+		return EXIT_SUCCESS;
+	}
+
+	if (queue_len == 0)
+		queue_len = LDX_SPI_DEF_QUEUE_LEN;
+
+	log_debug("%s: Starting async queue of %u requests on SPI %d:%d",
+		  __func__, queue_len, spi->spi_device, spi->spi_slave);
+
+	async = calloc(1, sizeof(spi_async_t));
+	if (async != NULL)
+		async->requests = calloc(queue_len, sizeof(spi_request_t));
+	if (async == NULL || async->requests == NULL) {
+		log_error("%s: Unable to start async queue on SPI %d:%d, cannot allocate memory",
+			  __func__, spi->spi_device, spi->spi_slave);
+		free(async);
+		pthread_mutex_unlock(&_spi->async_lock);
+		return EXIT_FAILURE;
+	}
+
+	async->len = queue_len;
+	pthread_mutex_init(&async->lock, NULL);
+	pthread_cond_init(&async->not_empty, NULL);
+	pthread_cond_init(&async->not_full, NULL);
+	pthread_cond_init(&async->idle, NULL);
+
+	__atomic_store_n(&_spi->async, async, __ATOMIC_RELEASE);
+	if (pthread_create(&async->thread, NULL, spi_async_worker, spi) != 0) {
+		log_error("%s: Unable to create the worker of SPI %d:%d",
+			  __func__, spi->spi_device, spi->spi_slave);
+		__atomic_store_n(&_spi->async, NULL, __ATOMIC_RELEASE);
+		pthread_cond_destroy(&async->idle);
+		pthread_cond_destroy(&async->not_full);
+		pthread_cond_destroy(&async->not_empty);
+		pthread_mutex_destroy(&async->lock);
+		free(async->requests);
+		free(async);
+		pthread_mutex_unlock(&_spi->async_lock);
+		return EXIT_FAILURE;
+	}
+	pthread_mutex_unlock(&_spi->async_lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_submit(spi_t *spi, spi_segment_t *segs, unsigned int n,
+		   const ldx_spi_done_cb_t cb, void *arg)
+{
+	spi_async_t *async = NULL;
+	spi_request_t *req;
+
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (segs == NULL || n == 0 || n > LDX_SPI_MAX_SEGMENTS) {
+		log_error("%s: Invalid segments", __func__);
+		return EXIT_FAILURE;
+	}
+
+	if (ldx_spi_async_start(spi, 0) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	async = __atomic_load_n(&((spi_internal_t *)spi->_data)->async,
+				__ATOMIC_ACQUIRE);
+
+	pthread_mutex_lock(&async->lock);
+	if (async->count == async->len &&
+	    pthread_equal(pthread_self(), async->thread)) {
+		pthread_mutex_unlock(&async->lock);
+		log_error("%s: Async queue of SPI %d:%d is full", __func__,
+			  spi->spi_device, spi->spi_slave);
+		return EXIT_FAILURE;
+	}
+	while (async->count == async->len)
+		pthread_cond_wait(&async->not_full, &async->lock);
+
+	req = &async->requests[(async->head + async->count) % async->len];
+	req->segs = segs;
+	req->n = n;
+	req->cb = cb;
+	req->arg = arg;
+	async->count++;
+	pthread_cond_signal(&async->not_empty);
+	pthread_mutex_unlock(&async->lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_async_flush(spi_t *spi)
+{
+	spi_async_t *async = NULL;
+
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	async = __atomic_load_n(&((spi_internal_t *)spi->_data)->async,
+				__ATOMIC_ACQUIRE);
+	if (async == NULL)
+		return EXIT_SUCCESS;
+
+	if (pthread_equal(pthread_self(), async->thread)) {
+		log_error("%s: Cannot flush from a completion callback", __func__);
+		return EXIT_FAILURE;
+	}
+
+	pthread_mutex_lock(&async->lock);
+	while (async->count > 0 || async->busy)
+		pthread_cond_wait(&async->idle, &async->lock);
+	pthread_mutex_unlock(&async->lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_async_stop(spi_t *spi)
+{
+	spi_internal_t *_spi = NULL;
+	spi_async_t *async = NULL;
+
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	_spi = (spi_internal_t *)spi->_data;
+	async = __atomic_load_n(&_spi->async, __ATOMIC_ACQUIRE);
+	if (async == NULL)
+		return EXIT_SUCCESS;
+
+	if (pthread_equal(pthread_self(), async->thread)) {
+		log_error("%s: Cannot stop from a completion callback", __func__);
+		return EXIT_FAILURE;
+	}
+
+	pthread_mutex_lock(&_spi->async_lock);
+	async = _spi->async;
+	if (async == NULL) {
+		pthread_mutex_unlock(&_spi->async_lock);
+		return EXIT_SUCCESS;
+	}
+
+	log_debug("%s: Stopping async queue on SPI %d:%d", __func__,
+		  spi->spi_device, spi->spi_slave);
+
+	pthread_mutex_lock(&async->lock);
+	async->stop = true;
+	pthread_cond_signal(&async->not_empty);
+	pthread_mutex_unlock(&async->lock);
+
+	pthread_join(async->thread, NULL);
+	__atomic_store_n(&_spi->async, NULL, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&_spi->async_lock);
+
+	pthread_cond_destroy(&async->idle);
+	pthread_cond_destroy(&async->not_full);
+	pthread_cond_destroy(&async->not_empty);
+	pthread_mutex_destroy(&async->lock);
+	free(async->requests);
+	free(async);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_set_priority(spi_t *spi, bus_prio_t prio)
+{
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (prio < 0 || prio >= BUS_PRIO_COUNT) {
+		log_error("%s: Invalid priority, %d", __func__, prio);
+		return EXIT_FAILURE;
+	}
+
+	((spi_internal_t *)spi->_data)->prio = prio;
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_lock_bus(spi_t *spi)
+{
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	spi_bus_acquire(spi);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_spi_unlock_bus(spi_t *spi)
+{
+	if (check_spi(spi) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	return spi_bus_release(spi);
+}
+
+/**
+ * spi_bus_acquire() - Wait for the turn of a SPI handle on its device
+ *
+ * @spi:	A requested SPI.
+ */
+static void spi_bus_acquire(spi_t *spi)
+{
+	spi_internal_t *_spi = (spi_internal_t *)spi->_data;
+
+	bus_sched_acquire(_spi->sched, _spi->prio);
+}
+
+/**
+ * spi_bus_release() - Release the device of a SPI handle
+ *
+ * @spi:	A requested SPI.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int spi_bus_release(spi_t *spi)
+{
+	return bus_sched_release(((spi_internal_t *)spi->_data)->sched);
+}
+
+/**
+ * get_libsoc_spi() - Get the libsoc handle of a SPI
+ *
+ * @spi:	A requested SPI.
+ *
+ * Return: The libsoc SPI handle.
+ */
+static inline libsoc_spi_t *get_libsoc_spi(spi_t *spi)
+{
+	return ((spi_internal_t *)spi->_data)->libsoc;
+}
+
 /**
  * check_spi() - Verify that the SPI pointer is valid
  *
@@ -0,0 +1,631 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "_common.h"
+#include "_list.h"
+#include "_log.h"
+#include "_stats.h"
+
+/* Timeout to write a snapshot to a client of the export socket */
+#define EXPORT_SEND_TIMEOUT_MS	1000
+
+static const char * const stats_api_names[] = {
+	[STATS_API_GPIO_SET_VALUE]	= "ldx_gpio_set_value",
+	[STATS_API_GPIO_GET_VALUE]	= "ldx_gpio_get_value",
+	[STATS_API_GPIO_BANK_SET_VALUES] = "ldx_gpio_bank_set_values",
+	[STATS_API_GPIO_BANK_GET_VALUES] = "ldx_gpio_bank_get_values",
+	[STATS_API_SPI_WRITE]		= "ldx_spi_write",
+	[STATS_API_SPI_READ]		= "ldx_spi_read",
+	[STATS_API_SPI_TRANSFER]	= "ldx_spi_transfer",
+	[STATS_API_SPI_TRANSFER_BATCH]	= "ldx_spi_transfer_batch",
+	[STATS_API_I2C_READ]		= "ldx_i2c_read",
+	[STATS_API_I2C_WRITE]		= "ldx_i2c_write",
+	[STATS_API_I2C_TRANSFER]	= "ldx_i2c_transfer",
+	[STATS_API_I2C_TRANSFER_MSGS]	= "ldx_i2c_transfer_msgs",
+	[STATS_API_ADC_GET_SAMPLE]	= "ldx_adc_get_sample",
+	[STATS_API_ADC_BUFFER_READ]	= "ldx_adc_buffer_read",
+	[STATS_API_PWM_SET_DUTY_CYCLE]	= "ldx_pwm_set_duty_cycle",
+	[STATS_API_PWM_APPLY]		= "ldx_pwm_apply",
+	[STATS_API_CAN_TX_FRAME]	= "ldx_can_tx_frame",
+	[STATS_API_CAN_TX_FRAMES]	= "ldx_can_tx_frames",
+	[STATS_API_CAN_RX_POP]		= "ldx_can_rx_pop",
+	[STATS_API_CAN_RX_POP_BATCH]	= "ldx_can_rx_pop_batch",
+};
+
+const char *ldx_stats_api_name(stats_api_t api)
+{
+	if (api < 0 || api >= STATS_API_COUNT)
+		return NULL;
+
+	return stats_api_names[api];
+}
+
+uint64_t ldx_stats_bucket_limit(unsigned int bucket)
+{
+	unsigned int shift;
+
+	if (bucket >= STATS_HIST_BUCKETS - 1)
+		return UINT64_MAX;
+
+	if (bucket < STATS_HIST_SUB_BUCKETS)
+		return bucket + 1;
+
+	/* Bucket 'b' starts at (SUB + b % SUB) << (b / SUB - 1) */
+	shift = bucket / STATS_HIST_SUB_BUCKETS - 1;
+
+	return (uint64_t)(STATS_HIST_SUB_BUCKETS + bucket % STATS_HIST_SUB_BUCKETS + 1)
+		<< shift;
+}
+
+uint64_t ldx_stats_percentile(const stats_counters_t *counters, double percentile)
+{
+	uint64_t total = 0, rank, seen = 0;
+	unsigned int i;
+
+	if (counters == NULL)
+		return 0;
+
+	for (i = 0; i < STATS_HIST_BUCKETS; i++)
+		total += counters->hist[i];
+	if (total == 0)
+		return 0;
+
+	if (percentile < 0)
+		percentile = 0;
+	else if (percentile > 100)
+		percentile = 100;
+
+	/* Nearest rank, at least the first sample */
+	rank = (uint64_t)(percentile / 100.0 * total + 0.999999);
+	if (rank == 0)
+		rank = 1;
+
+	for (i = 0; i < STATS_HIST_BUCKETS; i++) {
+		seen += counters->hist[i];
+		if (seen >= rank)
+			return ldx_stats_bucket_limit(i);
+	}
+
+	return ldx_stats_bucket_limit(STATS_HIST_BUCKETS - 1);
+}
+
+#ifdef LDX_STATS
+
+/**
+ * stats_thread_t - Counters of a thread that called instrumented functions
+ *
+ * @api:	Counters of each entry point. Only written by the thread.
+ * @list:	Entry in the list of threads.
+ */
+typedef struct {
+	stats_counters_t api[STATS_API_COUNT];
+	struct list_head list;
+} stats_thread_t;
+
+static void __attribute__ ((destructor)) stats_fini(void);
+
+static __thread stats_thread_t *stats_self;
+
+static LIST_HEAD(stats_threads);
+/* Counters of the threads that already finished */
+static stats_counters_t stats_exited[STATS_API_COUNT];
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t stats_key;
+static pthread_once_t stats_key_once = PTHREAD_ONCE_INIT;
+static bool stats_key_created;
+/* Set when the library is unloaded, the calls are no longer accounted */
+static bool stats_shutdown;
+
+static struct {
+	pthread_t thread;
+	int listen_fd;
+	int stop_fd;
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	bool running;
+} export = { .listen_fd = -1, .stop_fd = -1 };
+static pthread_mutex_t export_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * bucket_index() - Get the histogram bucket of a latency
+ *
+ * @ns:		Latency in nanoseconds.
+ *
+ * Return: The index of the bucket.
+ */
+static unsigned int bucket_index(uint64_t ns)
+{
+	unsigned int msb, bucket;
+
+	if (ns < STATS_HIST_SUB_BUCKETS)
+		return ns;
+
+	/* Power of two of the value, then the next two bits for 4 sub-buckets */
+	msb = 63 - __builtin_clzll(ns);
+	bucket = (msb - 1) * STATS_HIST_SUB_BUCKETS
+		 + ((ns >> (msb - 2)) & (STATS_HIST_SUB_BUCKETS - 1));
+
+	return bucket < STATS_HIST_BUCKETS ? bucket : STATS_HIST_BUCKETS - 1;
+}
+
+/**
+ * counter_add() - Increase a counter owned by the calling thread
+ *
+ * @counter:	The counter.
+ * @value:	Value to add.
+ *
+ * There is a single writer, so a plain load and an atomic store are enough
+ * for the readers to never see a torn value.
+ */
+static inline void counter_add(uint64_t *counter, uint64_t value)
+{
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value,
+			 __ATOMIC_RELAXED);
+}
+
+/**
+ * counters_sum() - Add the counters of an entry point to others
+ *
+ * @dst:	Counters to update.
+ * @src:	Counters to add, read atomically.
+ */
+static void counters_sum(stats_counters_t *dst, const stats_counters_t *src)
+{
+	int i;
+
+	dst->calls += __atomic_load_n(&src->calls, __ATOMIC_RELAXED);
+	dst->errors += __atomic_load_n(&src->errors, __ATOMIC_RELAXED);
+	dst->retries += __atomic_load_n(&src->retries, __ATOMIC_RELAXED);
+	dst->bytes += __atomic_load_n(&src->bytes, __ATOMIC_RELAXED);
+	dst->total_ns += __atomic_load_n(&src->total_ns, __ATOMIC_RELAXED);
+	for (i = 0; i < STATS_HIST_BUCKETS; i++)
+		dst->hist[i] += __atomic_load_n(&src->hist[i], __ATOMIC_RELAXED);
+}
+
+/**
+ * stats_thread_exit() - Keep the counters of a finished thread
+ *
+ * @arg:	Counters of the thread.
+ *
+ * Executed by the thread itself when it finishes.
+ */
+static void stats_thread_exit(void *arg)
+{
+	stats_thread_t *self = arg;
+	int i;
+
+	pthread_mutex_lock(&stats_lock);
+	for (i = 0; i < STATS_API_COUNT; i++)
+		counters_sum(&stats_exited[i], &self->api[i]);
+	list_del(&self->list);
+	pthread_mutex_unlock(&stats_lock);
+
+	stats_self = NULL;
+	free(self);
+}
+
+static void stats_key_init(void)
+{
+	stats_key_created = pthread_key_create(&stats_key, stats_thread_exit) == 0;
+}
+
+/**
+ * stats_thread_get() - Get the counters of the calling thread
+ *
+ * The counters are allocated and registered the first time a thread calls
+ * an instrumented function.
+ *
+ * Return: The counters, NULL on error.
+ */
+static stats_thread_t *stats_thread_get(void)
+{
+	stats_thread_t *self = stats_self;
+
+	if (self != NULL)
+		return self;
+
+	pthread_once(&stats_key_once, stats_key_init);
+	if (!stats_key_created)
+		return NULL;
+
+	self = calloc(1, sizeof(stats_thread_t));
+	if (self == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&stats_lock);
+	list_add_tail(&self->list, &stats_threads);
+	pthread_mutex_unlock(&stats_lock);
+
+	pthread_setspecific(stats_key, self);
+	stats_self = self;
+
+	return self;
+}
+
+void stats_end(stats_api_t api, uint64_t start_ns, stats_result_t result,
+	       uint64_t bytes)
+{
+	uint64_t elapsed = stats_begin() - start_ns;
+	stats_thread_t *self;
+	stats_counters_t *c;
+	int err = errno;
+
+	if (__atomic_load_n(&stats_shutdown, __ATOMIC_ACQUIRE))
+		goto out;
+
+	self = stats_thread_get();
+	if (self == NULL)
+		goto out;
+
+	c = &self->api[api];
+	counter_add(&c->calls, 1);
+	counter_add(&c->total_ns, elapsed);
+	counter_add(&c->hist[bucket_index(elapsed)], 1);
+
+	switch (result) {
+	case STATS_RESULT_OK:
+		counter_add(&c->bytes, bytes);
+		break;
+	case STATS_RESULT_RETRY:
+		counter_add(&c->retries, 1);
+		break;
+	default:
+		counter_add(&c->errors, 1);
+		break;
+	}
+
+out:
+	errno = err;
+}
+
+int ldx_stats_snapshot(stats_snapshot_t *snapshot)
+{
+	stats_thread_t *t;
+	int i;
+
+	if (snapshot == NULL) {
+		log_error("%s: Snapshot cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	memset(snapshot, 0, sizeof(*snapshot));
+	snapshot->timestamp_ns = stats_begin();
+
+	pthread_mutex_lock(&stats_lock);
+	memcpy(snapshot->api, stats_exited, sizeof(stats_exited));
+	list_for_each_entry(t, &stats_threads, list) {
+		for (i = 0; i < STATS_API_COUNT; i++)
+			counters_sum(&snapshot->api[i], &t->api[i]);
+	}
+	pthread_mutex_unlock(&stats_lock);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * snapshot_to_json() - Format a snapshot as JSON
+ *
+ * @snapshot:	The snapshot.
+ * @len:	Where the length of the document is stored.
+ *
+ * Only the entry points that were called are included. Memory for the
+ * document is obtained with 'malloc' and must be freed with 'free'.
+ *
+ * Return: The document, NULL on error.
+ */
+static char *snapshot_to_json(const stats_snapshot_t *snapshot, size_t *len)
+{
+	char *buf = NULL;
+	bool first = true;
+	FILE *f;
+	int i, b;
+
+	f = open_memstream(&buf, len);
+	if (f == NULL)
+		return NULL;
+
+	fprintf(f, "{\"timestamp_ns\":%llu,\"apis\":[",
+		(unsigned long long)snapshot->timestamp_ns);
+
+	for (i = 0; i < STATS_API_COUNT; i++) {
+		const stats_counters_t *c = &snapshot->api[i];
+		bool first_bucket = true;
+
+		if (c->calls == 0)
+			continue;
+
+		fprintf(f, "%s{\"name\":\"%s\",\"calls\":%llu,\"errors\":%llu,"
+			"\"retries\":%llu,\"bytes\":%llu,\"total_ns\":%llu,"
+			"\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,"
+			"\"histogram\":[",
+			first ? "" : ",", stats_api_names[i],
+			(unsigned long long)c->calls,
+			(unsigned long long)c->errors,
+			(unsigned long long)c->retries,
+			(unsigned long long)c->bytes,
+			(unsigned long long)c->total_ns,
+			(unsigned long long)ldx_stats_percentile(c, 50),
+			(unsigned long long)ldx_stats_percentile(c, 99),
+			(unsigned long long)ldx_stats_percentile(c, 99.9));
+		first = false;
+
+		/* [limit_ns, count] of the used buckets, null limit for the last */
+		for (b = 0; b < STATS_HIST_BUCKETS; b++) {
+			if (c->hist[b] == 0)
+				continue;
+			if (b == STATS_HIST_BUCKETS - 1)
+				fprintf(f, "%s[null,%llu]", first_bucket ? "" : ",",
+					(unsigned long long)c->hist[b]);
+			else
+				fprintf(f, "%s[%llu,%llu]", first_bucket ? "" : ",",
+					(unsigned long long)ldx_stats_bucket_limit(b),
+					(unsigned long long)c->hist[b]);
+			first_bucket = false;
+		}
+		fputs("]}", f);
+	}
+	fputs("]}\n", f);
+
+	if (fclose(f) != 0) {
+		free(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
+/**
+ * export_client() - Write a snapshot to a client of the export socket
+ *
+ * @fd:		Socket of the client.
+ */
+static void export_client(int fd)
+{
+	struct timeval tv = {
+		.tv_sec = EXPORT_SEND_TIMEOUT_MS / 1000,
+		.tv_usec = (EXPORT_SEND_TIMEOUT_MS % 1000) * 1000,
+	};
+	stats_snapshot_t *snapshot;
+	size_t len = 0, sent = 0;
+	char *json = NULL;
+
+	snapshot = malloc(sizeof(stats_snapshot_t));
+	if (snapshot == NULL)
+		return;
+
+	if (ldx_stats_snapshot(snapshot) == EXIT_SUCCESS)
+		json = snapshot_to_json(snapshot, &len);
+	free(snapshot);
+	if (json == NULL)
+		return;
+
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	while (sent < len) {
+		ssize_t ret = send(fd, json + sent, len - sent, MSG_NOSIGNAL);
+
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			log_debug("%s: Unable to send the snapshot (%d)", __func__,
+				  errno);
+			break;
+		}
+		sent += ret;
+	}
+
+	free(json);
+}
+
+/**
+ * export_thread() - Serve snapshots to the clients of the export socket
+ *
+ * @arg:	Not used.
+ *
+ * Return: NULL.
+ */
+static void *export_thread(void *arg)
+{
+	struct pollfd pfds[] = {
+		{ .fd = export.listen_fd, .events = POLLIN },
+		{ .fd = export.stop_fd, .events = POLLIN },
+	};
+
+	for (;;) {
+		int fd;
+
+		if (poll(pfds, ARRAY_SIZE(pfds), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: Unable to wait for clients (%d)", __func__,
+				  errno);
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (!(pfds[0].revents & POLLIN))
+			continue;
+
+		fd = accept4(export.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0)
+			continue;
+
+		export_client(fd);
+		close(fd);
+	}
+
+	return NULL;
+}
+
+int ldx_stats_export_start(const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+	if (path == NULL || strlen(path) == 0
+	    || strlen(path) >= sizeof(addr.sun_path)) {
+		log_error("%s: Invalid socket path", __func__);
+		return EXIT_FAILURE;
+	}
+
+	pthread_mutex_lock(&export_lock);
+
+	if (export.running) {
+		log_error("%s: Statistics already exported to %s", __func__,
+			  export.path);
+		goto err_unlock;
+	}
+
+	strcpy(addr.sun_path, path);
+	unlink(path);
+
+	export.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	export.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (export.listen_fd < 0 || export.stop_fd < 0) {
+		log_error("%s: Unable to create the export descriptors (%d)",
+			  __func__, errno);
+		goto err_close;
+	}
+
+	if (bind(export.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+	    || listen(export.listen_fd, 4) < 0) {
+		log_error("%s: Unable to listen on %s (%d)", __func__, path, errno);
+		goto err_close;
+	}
+
+	strcpy(export.path, path);
+
+	if (pthread_create(&export.thread, NULL, export_thread, NULL) != 0) {
+		log_error("%s: Unable to create the export thread", __func__);
+		unlink(path);
+		goto err_close;
+	}
+	export.running = true;
+
+	pthread_mutex_unlock(&export_lock);
+
+	log_debug("%s: Exporting statistics to %s", __func__, path);
+
+	return EXIT_SUCCESS;
+
+err_close:
+	if (export.listen_fd >= 0)
+		close(export.listen_fd);
+	if (export.stop_fd >= 0)
+		close(export.stop_fd);
+	export.listen_fd = -1;
+	export.stop_fd = -1;
+err_unlock:
+	pthread_mutex_unlock(&export_lock);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_stats_export_stop(void)
+{
+	uint64_t one = 1;
+	int ret = EXIT_SUCCESS;
+
+	pthread_mutex_lock(&export_lock);
+
+	if (!export.running)
+		goto out;
+
+	if (write(export.stop_fd, &one, sizeof(one)) != sizeof(one)) {
+		log_error("%s: Unable to stop the export thread", __func__);
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	pthread_join(export.thread, NULL);
+	export.running = false;
+
+	close(export.listen_fd);
+	close(export.stop_fd);
+	export.listen_fd = -1;
+	export.stop_fd = -1;
+	unlink(export.path);
+
+out:
+	pthread_mutex_unlock(&export_lock);
+
+	return ret;
+}
+
+/**
+ * stats_fini() - Release the instrumentation resources
+ *
+ * Executed when the library is unloaded. Other threads may still be inside
+ * 'stats_end()' with their counters, so only the ones of the calling thread
+ * are freed.
+ */
+static void stats_fini(void)
+{
+	stats_thread_t *self = stats_self;
+
+	__atomic_store_n(&stats_shutdown, true, __ATOMIC_RELEASE);
+
+	ldx_stats_export_stop();
+
+	if (stats_key_created)
+		pthread_key_delete(stats_key);
+
+	if (self == NULL)
+		return;
+
+	pthread_mutex_lock(&stats_lock);
+	list_del(&self->list);
+	pthread_mutex_unlock(&stats_lock);
+	stats_self = NULL;
+	free(self);
+}
+
+#else
+
+int ldx_stats_snapshot(stats_snapshot_t *snapshot)
+{
+	log_error("%s: Library built without statistics (CONFIG_STATS)", __func__);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_stats_export_start(const char *path)
+{
+	log_error("%s: Library built without statistics (CONFIG_STATS)", __func__);
+
+	return EXIT_FAILURE;
+}
+
+int ldx_stats_export_stop(void)
+{
+	return EXIT_SUCCESS;
+}
+
+#endif /* LDX_STATS */
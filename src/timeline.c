@@ -0,0 +1,498 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef CONFIG_DISABLE_CAN
+#include "can.h"
+#endif
+#include "_log.h"
+#include "_timestamp.h"
+#include "timeline.h"
+
+/* Events the ring of a GPIO event stream can hold */
+#define TIMELINE_GPIO_RING_LEN	1024
+
+struct timeline_internal;
+
+/**
+ * timeline_source_t - Peripheral feeding a timeline
+ *
+ * @tl:		The timeline, passed to the peripheral callbacks.
+ * @type:	Peripheral type.
+ * @id:		Identifier of the source in the events.
+ * @handle:	The CAN interface, GPIO or ADC group.
+ */
+typedef struct {
+	struct timeline_internal *tl;
+	timeline_event_type_t type;
+	unsigned int id;
+	void *handle;
+} timeline_source_t;
+
+/**
+ * timeline_entry_t - Event held in the timeline
+ *
+ * @seq:	Arrival order, to keep events with the same time in order.
+ * @event:	The event.
+ */
+typedef struct {
+	uint64_t seq;
+	timeline_event_t event;
+} timeline_entry_t;
+
+/**
+ * timeline_internal_t - Data of a timeline for internal use
+ *
+ * @lock:	Protects the heap and the counters.
+ * @cond:	Signaled when events are added or the timeline is stopped.
+ * @heap:	Binary min-heap of the held events, by time.
+ * @capacity:	Number of events the heap can hold.
+ * @count:	Number of held events.
+ * @seq:	Number of events added.
+ * @lost:	Events dropped because the heap was full.
+ * @latency_ns:	Time events are held before they can be read.
+ * @stopped:	True once the sources are released.
+ * @sources:	The sources of the timeline.
+ * @nsources:	Number of sources.
+ */
+typedef struct timeline_internal {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	timeline_entry_t *heap;
+	unsigned int capacity;
+	unsigned int count;
+	uint64_t seq;
+	uint64_t lost;
+	uint64_t latency_ns;
+	bool stopped;
+	timeline_source_t sources[TIMELINE_MAX_SOURCES];
+	unsigned int nsources;
+} timeline_internal_t;
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return timestamp_timespec_ns(&now);
+}
+
+static bool entry_before(const timeline_entry_t *a, const timeline_entry_t *b)
+{
+	if (a->event.ts.ns != b->event.ts.ns)
+		return a->event.ts.ns < b->event.ts.ns;
+
+	return a->seq < b->seq;
+}
+
+/* Add an event to the heap, must be called with the lock held */
+static void timeline_push(timeline_internal_t *_tl, const timeline_event_t *event)
+{
+	timeline_entry_t entry;
+	unsigned int i;
+
+	if (_tl->count == _tl->capacity) {
+		_tl->lost++;
+		return;
+	}
+
+	entry.seq = _tl->seq++;
+	entry.event = *event;
+
+	for (i = _tl->count++; i > 0; i = (i - 1) / 2) {
+		unsigned int parent = (i - 1) / 2;
+
+		if (!entry_before(&entry, &_tl->heap[parent]))
+			break;
+		_tl->heap[i] = _tl->heap[parent];
+	}
+	_tl->heap[i] = entry;
+}
+
+/* Remove the oldest event of the heap, must be called with the lock held */
+static void timeline_pop(timeline_internal_t *_tl, timeline_event_t *event)
+{
+	timeline_entry_t *last;
+	unsigned int i = 0, child;
+
+	*event = _tl->heap[0].event;
+	last = &_tl->heap[--_tl->count];
+
+	while ((child = 2 * i + 1) < _tl->count) {
+		if (child + 1 < _tl->count &&
+		    entry_before(&_tl->heap[child + 1], &_tl->heap[child]))
+			child++;
+		if (!entry_before(&_tl->heap[child], last))
+			break;
+		_tl->heap[i] = _tl->heap[child];
+		i = child;
+	}
+	_tl->heap[i] = *last;
+}
+
+#ifndef CONFIG_DISABLE_CAN
+static void timeline_can_cb(const struct canfd_frame *frames,
+			    const ldx_timestamp_t *ts, unsigned int nframes,
+			    void *arg)
+{
+	timeline_source_t *src = arg;
+	timeline_event_t event = { .type = TIMELINE_EVENT_CAN, .source = src->id };
+	unsigned int i;
+
+	pthread_mutex_lock(&src->tl->lock);
+	for (i = 0; i < nframes; i++) {
+		event.ts = ts[i];
+		event.data.can = frames[i];
+		timeline_push(src->tl, &event);
+	}
+	pthread_cond_broadcast(&src->tl->cond);
+	pthread_mutex_unlock(&src->tl->lock);
+}
+#endif /* CONFIG_DISABLE_CAN */
+
+static void timeline_gpio_cb(gpio_t *gpio, gpio_event_t *events,
+			     unsigned int nevents, void *arg)
+{
+	timeline_source_t *src = arg;
+	timeline_event_t event = { .type = TIMELINE_EVENT_GPIO, .source = src->id };
+	unsigned int i;
+
+	pthread_mutex_lock(&src->tl->lock);
+	for (i = 0; i < nevents; i++) {
+		ldx_gpio_event_get_timestamp(&events[i], &event.ts);
+		event.data.edge = events[i].edge;
+		timeline_push(src->tl, &event);
+	}
+	pthread_cond_broadcast(&src->tl->cond);
+	pthread_mutex_unlock(&src->tl->lock);
+}
+
+static int timeline_adc_cb(int *samples, unsigned int num_samples, void *arg)
+{
+	timeline_source_t *src = arg;
+	timeline_event_t event = { .type = TIMELINE_EVENT_ADC, .source = src->id };
+	unsigned int i;
+
+	ldx_adc_group_get_timestamp(src->handle, &event.ts);
+
+	pthread_mutex_lock(&src->tl->lock);
+	for (i = 0; i < num_samples; i++) {
+		event.data.adc.index = i;
+		event.data.adc.sample = samples[i];
+		timeline_push(src->tl, &event);
+	}
+	pthread_cond_broadcast(&src->tl->cond);
+	pthread_mutex_unlock(&src->tl->lock);
+
+	return EXIT_SUCCESS;
+}
+
+timeline_t *ldx_timeline_create(unsigned int capacity, unsigned int latency_ms)
+{
+	timeline_t *new_tl = NULL;
+	timeline_internal_t *_tl = NULL;
+	pthread_condattr_t cond_attr;
+
+	if (capacity == 0)
+		capacity = TIMELINE_DEF_LEN;
+	if (latency_ms == 0)
+		latency_ms = TIMELINE_DEF_LATENCY_MS;
+
+	new_tl = calloc(1, sizeof(timeline_t));
+	_tl = calloc(1, sizeof(timeline_internal_t));
+	if (_tl != NULL)
+		_tl->heap = calloc(capacity, sizeof(timeline_entry_t));
+	if (new_tl == NULL || _tl == NULL || _tl->heap == NULL) {
+		log_error("%s: Unable to create the timeline, cannot allocate memory",
+			  __func__);
+		if (_tl != NULL)
+			free(_tl->heap);
+		free(_tl);
+		free(new_tl);
+		return NULL;
+	}
+
+	_tl->capacity = capacity;
+	_tl->latency_ns = (uint64_t)latency_ms * 1000000;
+	pthread_mutex_init(&_tl->lock, NULL);
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_tl->cond, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+
+	{
+		timeline_t init_tl = {
+			.capacity = capacity,
+			.latency_ms = latency_ms,
+			._data = _tl
+		};
+
+		memcpy(new_tl, &init_tl, sizeof(timeline_t));
+	}
+
+	log_debug("%s: Created timeline of %u events, %u ms latency", __func__,
+		  capacity, latency_ms);
+
+	return new_tl;
+}
+
+/* Prepare the next source of a timeline, NULL if it can not take more */
+static timeline_source_t *timeline_new_source(timeline_t *tl,
+					      timeline_event_type_t type,
+					      void *handle)
+{
+	timeline_internal_t *_tl;
+	timeline_source_t *src;
+
+	if (tl == NULL || handle == NULL) {
+		log_error("%s: Timeline and source cannot be NULL", __func__);
+		return NULL;
+	}
+
+	_tl = tl->_data;
+	if (_tl->stopped) {
+		log_error("%s: The timeline is stopped", __func__);
+		return NULL;
+	}
+
+	if (_tl->nsources == TIMELINE_MAX_SOURCES) {
+		log_error("%s: The timeline already has %d sources", __func__,
+			  TIMELINE_MAX_SOURCES);
+		return NULL;
+	}
+
+	src = &_tl->sources[_tl->nsources];
+	src->tl = _tl;
+	src->type = type;
+	src->id = _tl->nsources;
+	src->handle = handle;
+
+	return src;
+}
+
+int ldx_timeline_add_can(timeline_t *tl, struct can_if *cif)
+{
+#ifndef CONFIG_DISABLE_CAN
+	timeline_source_t *src;
+
+	src = timeline_new_source(tl, TIMELINE_EVENT_CAN, cif);
+	if (src == NULL)
+		return -1;
+
+	if (ldx_can_register_rx_ts_handler(cif, timeline_can_cb, src, NULL, 0)) {
+		log_error("%s: Unable to receive the frames of %s", __func__,
+			  cif->name);
+		return -1;
+	}
+
+	/* Only sources that were started are released by the stop */
+	return src->tl->nsources++;
+#else
+	log_error("%s: CAN support is not available", __func__);
+
+	return -1;
+#endif /* CONFIG_DISABLE_CAN */
+}
+
+int ldx_timeline_add_gpio(timeline_t *tl, gpio_t *gpio)
+{
+	timeline_source_t *src;
+
+	src = timeline_new_source(tl, TIMELINE_EVENT_GPIO, gpio);
+	if (src == NULL)
+		return -1;
+
+	if (ldx_gpio_start_event_stream(gpio, TIMELINE_GPIO_RING_LEN,
+					timeline_gpio_cb, src) != EXIT_SUCCESS) {
+		log_error("%s: Unable to receive the events of GPIO %u", __func__,
+			  gpio->kernel_number);
+		return -1;
+	}
+
+	/* Only sources that were started are released by the stop */
+	return src->tl->nsources++;
+}
+
+int ldx_timeline_add_adc_group(timeline_t *tl, adc_group_t *group,
+			       unsigned int period_us)
+{
+	timeline_source_t *src;
+
+	src = timeline_new_source(tl, TIMELINE_EVENT_ADC, group);
+	if (src == NULL)
+		return -1;
+
+	if (ldx_adc_group_start_sampling(group, timeline_adc_cb, period_us,
+					 src) != EXIT_SUCCESS) {
+		log_error("%s: Unable to sample the ADC group", __func__);
+		return -1;
+	}
+
+	/* Only sources that were started are released by the stop */
+	return src->tl->nsources++;
+}
+
+int ldx_timeline_read(timeline_t *tl, timeline_event_t *events,
+		      unsigned int max, int timeout)
+{
+	timeline_internal_t *_tl;
+	uint64_t now, deadline = 0, wake;
+	unsigned int n = 0;
+
+	if (tl == NULL || events == NULL || max == 0) {
+		log_error("%s: Invalid timeline or events buffer", __func__);
+		return -1;
+	}
+
+	if (timeout < -1) {
+		log_error("%s: Invalid timeout value, %d", __func__, timeout);
+		return -1;
+	}
+
+	_tl = tl->_data;
+	if (timeout > 0)
+		deadline = monotonic_ns() + (uint64_t)timeout * 1000000;
+
+	pthread_mutex_lock(&_tl->lock);
+
+	while (1) {
+		now = monotonic_ns();
+		while (n < max && _tl->count > 0 &&
+		       (_tl->stopped ||
+			_tl->heap[0].event.ts.ns + _tl->latency_ns <= now))
+			timeline_pop(_tl, &events[n++]);
+
+		if (n > 0 || timeout == 0 || (_tl->stopped && _tl->count == 0))
+			break;
+		if (timeout > 0 && now >= deadline)
+			break;
+
+		/* Sleep until the oldest event is old enough or a new one comes */
+		wake = _tl->count > 0 ?
+		       _tl->heap[0].event.ts.ns + _tl->latency_ns : UINT64_MAX;
+		if (timeout > 0 && deadline < wake)
+			wake = deadline;
+
+		if (wake == UINT64_MAX) {
+			pthread_cond_wait(&_tl->cond, &_tl->lock);
+		} else {
+			struct timespec abstime = {
+				.tv_sec = wake / 1000000000ULL,
+				.tv_nsec = wake % 1000000000ULL,
+			};
+
+			pthread_cond_timedwait(&_tl->cond, &_tl->lock, &abstime);
+		}
+	}
+
+	pthread_mutex_unlock(&_tl->lock);
+
+	return n;
+}
+
+int ldx_timeline_get_lost(timeline_t *tl, uint64_t *lost)
+{
+	timeline_internal_t *_tl;
+
+	if (tl == NULL || lost == NULL) {
+		log_error("%s: Timeline and lost cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_tl = tl->_data;
+	pthread_mutex_lock(&_tl->lock);
+	*lost = _tl->lost;
+	pthread_mutex_unlock(&_tl->lock);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_timeline_stop(timeline_t *tl)
+{
+	timeline_internal_t *_tl;
+	int ret = EXIT_SUCCESS;
+	unsigned int i;
+
+	if (tl == NULL) {
+		log_error("%s: Timeline cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_tl = tl->_data;
+	if (_tl->stopped)
+		return EXIT_SUCCESS;
+
+	/* The callbacks take the lock, release the sources without it */
+	for (i = 0; i < _tl->nsources; i++) {
+		timeline_source_t *src = &_tl->sources[i];
+
+		switch (src->type) {
+		case TIMELINE_EVENT_CAN:
+#ifndef CONFIG_DISABLE_CAN
+			if (ldx_can_unregister_rx_ts_handler(src->handle,
+							     timeline_can_cb, src))
+				ret = EXIT_FAILURE;
+#endif /* CONFIG_DISABLE_CAN */
+			break;
+		case TIMELINE_EVENT_GPIO:
+			if (ldx_gpio_stop_event_stream(src->handle) != EXIT_SUCCESS)
+				ret = EXIT_FAILURE;
+			break;
+		case TIMELINE_EVENT_ADC:
+			if (ldx_adc_group_stop_sampling(src->handle) != EXIT_SUCCESS)
+				ret = EXIT_FAILURE;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&_tl->lock);
+	_tl->stopped = true;
+	pthread_cond_broadcast(&_tl->cond);
+	pthread_mutex_unlock(&_tl->lock);
+
+	log_debug("%s: Timeline stopped, %u events held, %llu lost", __func__,
+		  _tl->count, (unsigned long long)_tl->lost);
+
+	return ret;
+}
+
+int ldx_timeline_free(timeline_t *tl)
+{
+	timeline_internal_t *_tl;
+	int ret;
+
+	if (tl == NULL)
+		return EXIT_SUCCESS;
+
+	ret = ldx_timeline_stop(tl);
+
+	_tl = tl->_data;
+	pthread_cond_destroy(&_tl->cond);
+	pthread_mutex_destroy(&_tl->lock);
+	free(_tl->heap);
+	free(_tl);
+	free(tl);
+
+	return ret;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <time.h>
+
+#include "_timestamp.h"
+
+int64_t timestamp_realtime_offset(void)
+{
+	struct timespec mono1, real, mono2;
+
+	/* Bracket the wall clock reading to halve the error of the offset */
+	clock_gettime(CLOCK_MONOTONIC, &mono1);
+	clock_gettime(CLOCK_REALTIME, &real);
+	clock_gettime(CLOCK_MONOTONIC, &mono2);
+
+	return (int64_t)timestamp_timespec_ns(&real) -
+	       (int64_t)((timestamp_timespec_ns(&mono1) +
+			  timestamp_timespec_ns(&mono2)) / 2);
+}
+
+void ldx_timestamp_now(ldx_timestamp_t *ts)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	ts->ns = timestamp_timespec_ns(&now);
+	ts->hw_ns = 0;
+	ts->source = LDX_TIMESTAMP_SRC_SOFTWARE;
+}
+
+void ldx_timestamp_from_realtime(ldx_timestamp_t *ts, const struct timespec *rt,
+				 ldx_timestamp_source_t source)
+{
+	timestamp_from_realtime(ts, timestamp_timespec_ns(rt),
+				timestamp_realtime_offset(), source);
+}
+
+void ldx_timestamp_to_realtime(const ldx_timestamp_t *ts, struct timespec *rt)
+{
+	uint64_t ns = ts->ns + timestamp_realtime_offset();
+
+	rt->tv_sec = ns / 1000000000ULL;
+	rt->tv_nsec = ns % 1000000000ULL;
+}
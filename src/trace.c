@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#if defined(LDX_TRACE_LTTNG)
+
+/* Instantiate the LTTng-UST probes of the 'digiapix' provider */
+#define TRACEPOINT_CREATE_PROBES
+#define TRACEPOINT_DEFINE
+#include "_trace_lttng.h"
+
+#else
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "_common.h"
+#include "_trace.h"
+
+static void __attribute__ ((constructor)) trace_init(void);
+static void __attribute__ ((destructor)) trace_fini(void);
+
+/* tracefs mount points, the second one for kernels older than 4.1 */
+static const char * const trace_marker_paths[] = {
+	"/sys/kernel/tracing/trace_marker",
+	"/sys/kernel/debug/tracing/trace_marker",
+};
+
+int trace_marker_fd = -1;
+
+void trace_marker_write(const char *format, ...)
+{
+	char buf[256];
+	va_list args;
+	int len;
+
+	va_start(args, format);
+	len = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (len < 0)
+		return;
+	if (len >= (int)sizeof(buf))
+		len = sizeof(buf) - 1;
+
+	/* A single write per event, so it is not mixed with others */
+	if (write(trace_marker_fd, buf, len) < 0)
+		return;
+}
+
+/**
+ * trace_init() - Open the ftrace 'trace_marker' file
+ *
+ * Executed when the library is loaded.
+ */
+static void trace_init(void)
+{
+	int i, fd;
+
+	for (i = 0; i < ARRAY_SIZE(trace_marker_paths); i++) {
+		fd = open(trace_marker_paths[i], O_WRONLY | O_CLOEXEC);
+		if (fd >= 0) {
+			__atomic_store_n(&trace_marker_fd, fd, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+}
+
+/**
+ * trace_fini() - Close the ftrace 'trace_marker' file
+ *
+ * Executed when the library is unloaded.
+ */
+static void trace_fini(void)
+{
+	int fd = __atomic_exchange_n(&trace_marker_fd, -1, __ATOMIC_RELAXED);
+
+	if (fd >= 0)
+		close(fd);
+}
+
+#endif /* LDX_TRACE_LTTNG */
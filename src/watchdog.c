@@ -14,18 +14,160 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <linux/watchdog.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/timerfd.h>
 
 #include "_common.h"
 #include "watchdog.h"
 #include "_watchdog.h"
 #include "_log.h"
 
+#define NSEC_PER_SEC		1000000000ULL
+#define NSEC_PER_MSEC		1000000ULL
+
+/**
+ * get_time_ns() - Get the monotonic time in nanoseconds
+ *
+ * Return: The time in nanoseconds.
+ */
+static uint64_t get_time_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/**
+ * get_client() - Get the slot of a registered client
+ *
+ * @wd:		The watchdog.
+ * @client:	The client identifier.
+ *
+ * Return: The slot of the client, NULL if it is not registered.
+ */
+static wd_client_t *get_client(wd_t *wd, int client)
+{
+	wd_internal_t *_wd = NULL;
+
+	if (wd == NULL || client < 0 || client >= LDX_WATCHDOG_MAX_CLIENTS)
+		return NULL;
+
+	_wd = (wd_internal_t *) wd->_data;
+	if (__atomic_load_n(&_wd->clients[client].state, __ATOMIC_ACQUIRE) != WD_CLIENT_ACTIVE)
+		return NULL;
+
+	return &_wd->clients[client];
+}
+
+/**
+ * get_late_clients() - Check the deadline of every registered client
+ *
+ * @_wd:	The watchdog internal data.
+ * @now:	Current time in nanoseconds.
+ *
+ * Return: Bitmask with the clients that missed their deadline.
+ */
+static uint64_t get_late_clients(wd_internal_t *_wd, uint64_t now)
+{
+	uint64_t late = 0;
+	int i;
+
+	for (i = 0; i < LDX_WATCHDOG_MAX_CLIENTS; i++) {
+		wd_client_t *c = &_wd->clients[i];
+		uint64_t last_kick;
+
+		if (__atomic_load_n(&c->state, __ATOMIC_ACQUIRE) != WD_CLIENT_ACTIVE)
+			continue;
+
+		last_kick = __atomic_load_n(&c->last_kick_ns, __ATOMIC_ACQUIRE);
+		if (now > last_kick && now - last_kick > c->deadline_ns)
+			late |= 1ULL << i;
+	}
+
+	return late;
+}
+
+/**
+ * supervisor_thread() - Refresh the watchdog while all the clients are alive
+ *
+ * @arg:	The watchdog.
+ *
+ * Return: NULL.
+ */
+static void *supervisor_thread(void *arg)
+{
+	wd_t *wd = arg;
+	wd_internal_t *_wd = (wd_internal_t *) wd->_data;
+	struct pollfd pfds[] = {
+		{ .fd = _wd->timer_fd, .events = POLLIN },
+		{ .fd = _wd->stop_fd, .events = POLLIN },
+	};
+	uint64_t last_refresh = get_time_ns(), notify_ns = 0;
+	bool notified = false;
+	int timeout, pretimeout;
+
+	timeout = ldx_watchdog_get_timeout(wd);
+	pretimeout = ldx_watchdog_get_pretimeout(wd);
+	if (timeout > 0)
+		notify_ns = (uint64_t)timeout * NSEC_PER_SEC;
+	if (pretimeout > 0 && (uint64_t)pretimeout * NSEC_PER_SEC < notify_ns)
+		notify_ns -= (uint64_t)pretimeout * NSEC_PER_SEC;
+	else
+		notify_ns = 0;
+
+	for (;;) {
+		uint64_t expirations, late, now;
+
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_error("%s: Unable to wait for the supervisor timer (%d)",
+				  __func__, errno);
+			break;
+		}
+
+		if (pfds[1].revents)
+			break;
+
+		if (read(_wd->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+			continue;
+
+		now = get_time_ns();
+		late = get_late_clients(_wd, now);
+		__atomic_store_n(&_wd->late_clients, late, __ATOMIC_RELEASE);
+
+		if (late == 0) {
+			if (ldx_watchdog_refresh(wd) == EXIT_SUCCESS)
+				last_refresh = now;
+			notified = false;
+			continue;
+		}
+
+		if (!notified && now - last_refresh >= notify_ns) {
+			uint64_t one = 1;
+
+			log_error("%s: Watchdog %s not refreshed, late clients 0x%llx",
+				  __func__, wd->node, (unsigned long long)late);
+			if (write(_wd->pretimeout_fd, &one, sizeof(one)) != sizeof(one))
+				log_debug("%s: eventfd write error (%d)", __func__, errno);
+			notified = true;
+		}
+	}
+
+	return NULL;
+}
+
 wd_t *ldx_watchdog_request(char const * const wd_device_file)
 {
 	wd_t *new_wd = NULL;
@@ -65,6 +207,10 @@ wd_t *ldx_watchdog_request(char const * const wd_device_file)
 	log_debug("%s: watchdog (%s) opened and started\n",
 			__func__, wd_device_file);
 
+	internal_data->timer_fd = -1;
+	internal_data->stop_fd = -1;
+	internal_data->pretimeout_fd = -1;
+
 	memcpy(new_wd, &init_wd, sizeof(wd_t));
 	((wd_t *)new_wd)->_data = internal_data;
 
@@ -308,6 +454,216 @@ int ldx_watchdog_start(wd_t *wd)
 	}
 }
 
+int ldx_watchdog_supervisor_start(wd_t *wd, unsigned int period_ms)
+{
+	wd_internal_t *_wd = NULL;
+	struct itimerspec its;
+	uint64_t period_ns;
+
+	if (wd == NULL) {
+		log_error("%s: watchdog cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_wd = (wd_internal_t *) wd->_data;
+	if (_wd->running) {
+		log_error("%s: The supervisor of %s is already running", __func__,
+			  wd->node);
+		return EXIT_FAILURE;
+	}
+
+	if (period_ms == 0) {
+		int timeout = ldx_watchdog_get_timeout(wd);
+
+		if (timeout <= 0)
+			return EXIT_FAILURE;
+		period_ms = timeout * 1000 / 4;
+	}
+	period_ns = (uint64_t)period_ms * NSEC_PER_MSEC;
+
+	log_debug("%s: Starting supervisor of %s, period %u ms", __func__,
+		  wd->node, period_ms);
+
+	_wd->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	_wd->stop_fd = eventfd(0, EFD_CLOEXEC);
+	_wd->pretimeout_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (_wd->timer_fd < 0 || _wd->stop_fd < 0 || _wd->pretimeout_fd < 0) {
+		log_error("%s: Unable to create the supervisor descriptors (%d)",
+			  __func__, errno);
+		goto err_close;
+	}
+
+	its.it_interval.tv_sec = period_ns / NSEC_PER_SEC;
+	its.it_interval.tv_nsec = period_ns % NSEC_PER_SEC;
+	its.it_value = its.it_interval;
+	if (timerfd_settime(_wd->timer_fd, 0, &its, NULL) < 0) {
+		log_error("%s: Unable to start the supervisor timer (%d)", __func__,
+			  errno);
+		goto err_close;
+	}
+
+	__atomic_store_n(&_wd->late_clients, 0, __ATOMIC_RELEASE);
+
+	if (pthread_create(&_wd->thread, NULL, supervisor_thread, wd) != 0) {
+		log_error("%s: Unable to create the supervisor thread", __func__);
+		goto err_close;
+	}
+	_wd->running = true;
+
+	return EXIT_SUCCESS;
+
+err_close:
+	if (_wd->timer_fd >= 0)
+		close(_wd->timer_fd);
+	if (_wd->stop_fd >= 0)
+		close(_wd->stop_fd);
+	if (_wd->pretimeout_fd >= 0)
+		close(_wd->pretimeout_fd);
+	_wd->timer_fd = -1;
+	_wd->stop_fd = -1;
+	_wd->pretimeout_fd = -1;
+
+	return EXIT_FAILURE;
+}
+
+int ldx_watchdog_supervisor_stop(wd_t *wd)
+{
+	wd_internal_t *_wd = NULL;
+	uint64_t one = 1;
+	int ret = EXIT_SUCCESS;
+
+	if (wd == NULL) {
+		log_error("%s: watchdog cannot be NULL", __func__);
+		return EXIT_FAILURE;
+	}
+
+	_wd = (wd_internal_t *) wd->_data;
+	if (!_wd->running)
+		return EXIT_SUCCESS;
+
+	if (write(_wd->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+		log_error("%s: Unable to stop the supervisor thread", __func__);
+		return EXIT_FAILURE;
+	}
+
+	pthread_join(_wd->thread, NULL);
+	_wd->running = false;
+
+	if (close(_wd->timer_fd) < 0)
+		ret = EXIT_FAILURE;
+	if (close(_wd->stop_fd) < 0)
+		ret = EXIT_FAILURE;
+	if (close(_wd->pretimeout_fd) < 0)
+		ret = EXIT_FAILURE;
+	if (ret != EXIT_SUCCESS)
+		log_error("%s: Error closing the supervisor descriptors", __func__);
+	_wd->timer_fd = -1;
+	_wd->stop_fd = -1;
+	_wd->pretimeout_fd = -1;
+
+	log_debug("%s: Supervisor of %s was stopped", __func__, wd->node);
+
+	return ret;
+}
+
+int ldx_watchdog_supervisor_get_pretimeout_fd(wd_t *wd)
+{
+	wd_internal_t *_wd = NULL;
+
+	if (wd == NULL) {
+		log_error("%s: watchdog cannot be NULL", __func__);
+		return -1;
+	}
+
+	_wd = (wd_internal_t *) wd->_data;
+	if (!_wd->running) {
+		log_error("%s: The supervisor of %s is not running", __func__,
+			  wd->node);
+		return -1;
+	}
+
+	return _wd->pretimeout_fd;
+}
+
+uint64_t ldx_watchdog_supervisor_get_late_clients(wd_t *wd)
+{
+	wd_internal_t *_wd = NULL;
+
+	if (wd == NULL)
+		return 0;
+
+	_wd = (wd_internal_t *) wd->_data;
+
+	return __atomic_load_n(&_wd->late_clients, __ATOMIC_ACQUIRE);
+}
+
+int ldx_watchdog_client_register(wd_t *wd, unsigned int deadline_ms)
+{
+	wd_internal_t *_wd = NULL;
+	int i;
+
+	if (wd == NULL) {
+		log_error("%s: watchdog cannot be NULL", __func__);
+		return -1;
+	}
+
+	if (deadline_ms == 0) {
+		log_error("%s: Invalid client deadline", __func__);
+		return -1;
+	}
+
+	_wd = (wd_internal_t *) wd->_data;
+
+	for (i = 0; i < LDX_WATCHDOG_MAX_CLIENTS; i++) {
+		wd_client_t *c = &_wd->clients[i];
+		int expected = WD_CLIENT_FREE;
+
+		if (!__atomic_compare_exchange_n(&c->state, &expected, WD_CLIENT_BUSY,
+						 false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			continue;
+
+		c->deadline_ns = (uint64_t)deadline_ms * NSEC_PER_MSEC;
+		__atomic_store_n(&c->last_kick_ns, get_time_ns(), __ATOMIC_RELAXED);
+		__atomic_store_n(&c->state, WD_CLIENT_ACTIVE, __ATOMIC_RELEASE);
+
+		log_debug("%s: Registered client %d of %s, deadline %u ms",
+			  __func__, i, wd->node, deadline_ms);
+
+		return i;
+	}
+
+	log_error("%s: Too many clients of %s. Maximum is %d", __func__,
+		  wd->node, LDX_WATCHDOG_MAX_CLIENTS);
+
+	return -1;
+}
+
+int ldx_watchdog_client_kick(wd_t *wd, int client)
+{
+	wd_client_t *c = get_client(wd, client);
+
+	if (c == NULL)
+		return EXIT_FAILURE;
+
+	__atomic_store_n(&c->last_kick_ns, get_time_ns(), __ATOMIC_RELEASE);
+
+	return EXIT_SUCCESS;
+}
+
+int ldx_watchdog_client_unregister(wd_t *wd, int client)
+{
+	wd_client_t *c = get_client(wd, client);
+
+	if (c == NULL) {
+		log_error("%s: Invalid watchdog client %d", __func__, client);
+		return EXIT_FAILURE;
+	}
+
+	__atomic_store_n(&c->state, WD_CLIENT_FREE, __ATOMIC_RELEASE);
+
+	return EXIT_SUCCESS;
+}
+
 int ldx_watchdog_free(wd_t *wd)
 {
 	int ret = EXIT_SUCCESS;
@@ -321,6 +677,9 @@ int ldx_watchdog_free(wd_t *wd)
 	log_debug("%s: Freeing watchdog %s", __func__,
 			wd->node);
 
+	if (ldx_watchdog_supervisor_stop(wd) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+
 	if (close(_wd->fd) < 0) {
 		log_error("%s: Error freering watchdog", __func__);
 		ret = EXIT_FAILURE;
@@ -17,6 +17,7 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <linux/wireless.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,12 +26,14 @@
 #include <unistd.h>
 
 #include "_common.h"
+#include "_ctl_socket.h"
+#include "_list.h"
 #include "_log.h"
 #include "_network.h"
+#include "_nl80211.h"
 #include "process.h"
 #include "wifi.h"
 
-#define CMD_GET_SECURITY	"nmcli -g IN-USE,SSID,SECURITY device wifi list ifname %s --rescan no | grep '*:' | awk -F'[:]' '{print $3}'"
 #define CMD_DEL_CONN		"nmcli connection delete %s"
 #define CMD_CONN_SSID		" 802-11-wireless.ssid \"%s\" 802-11-wireless.hidden true"
 #define CMD_CONN_KEY_MGMT	" 802-11-wireless-security.key-mgmt %s"	/* none, wpa-psk */
@@ -42,6 +45,20 @@
 
 #define UNKOWN_CODE	"Unknown WiFi state error"
 
+/* Information elements that carry the SSID and the security of a BSS */
+#define IE_SSID			0
+#define IE_RSN			48
+#define IE_VENDOR		221
+
+/* AKM suite types of the RSN element that are WPA3 (SAE, FT-SAE, SAE-EXT) */
+#define RSN_AKM_SAE		8
+#define RSN_AKM_FT_SAE		9
+#define RSN_AKM_SAE_EXT		24
+#define RSN_AKM_FT_SAE_EXT	25
+
+/* Privacy bit of the capability field of a BSS */
+#define BSS_CAPABILITY_PRIVACY	0x0010
+
 static const char* wifi_state_error_descs[] = {
 	"No error",
 	"Interface not found",
@@ -62,6 +79,8 @@ static const char* wifi_state_error_descs[] = {
 	"Unable to get frequency",
 	"Unable to get channel",
 	"Unable to get security mode",
+	"Unable to scan",
+	"Unable to get station information",
 };
 
 static const char* wifi_sec_mode_names[] = {
@@ -71,6 +90,93 @@ static const char* wifi_sec_mode_names[] = {
 	"WPA3",
 };
 
+static const unsigned char ieee80211_oui[] = { 0x00, 0x0f, 0xac };
+static const unsigned char wpa_oui[] = { 0x00, 0x50, 0xf2 };
+
+/*
+ * nl_iface_t - Interface data retrieved through nl80211
+ *
+ * @ssid:	String to store the SSID, empty if not reported.
+ * @freq:	Frequency in MHz, 0 if not reported.
+ * @sec_mode:	Security mode of the associated BSS.
+ * @found:	True if the associated BSS was found in the scan results.
+ */
+typedef struct {
+	char *ssid;
+	unsigned int freq;
+	wifi_sec_mode_t sec_mode;
+	bool found;
+} nl_iface_t;
+
+/*
+ * bss_list_t - Growing list of scan results
+ *
+ * @bss:	Array of results.
+ * @n_bss:	Number of results in the array.
+ * @size:	Number of allocated entries.
+ * @no_mem:	True if the array could not be grown.
+ */
+typedef struct {
+	wifi_bss_t *bss;
+	int n_bss;
+	int size;
+	bool no_mem;
+} bss_list_t;
+
+/*
+ * station_query_t - Data of a NL80211_CMD_GET_STATION query
+ *
+ * @info:	Struct to fill with the station information.
+ * @found:	True once a station is found.
+ */
+typedef struct {
+	wifi_station_info_t *info;
+	bool found;
+} station_query_t;
+
+/*
+ * range_entry_t - Cached range information of an interface
+ *
+ * @list:	Entry in the list of cached ranges.
+ * @index:	Index of the interface.
+ * @range:	The range information.
+ */
+typedef struct {
+	struct list_head list;
+	int index;
+	struct iw_range range;
+} range_entry_t;
+
+/*
+ * scan_req_t - Scan waiting for its results
+ *
+ * @list:	Entry in the list of pending scans.
+ * @index:	Index of the interface.
+ * @iface_name:	Name of the interface.
+ * @cb:		Function to call with the results.
+ * @arg:	Argument to pass to the callback.
+ */
+typedef struct {
+	struct list_head list;
+	int index;
+	char iface_name[IFNAMSIZ];
+	ldx_wifi_scan_cb_t cb;
+	void *arg;
+} scan_req_t;
+
+/*
+ * The range information only changes with the regulatory domain or the
+ * wireless devices, so it is cached while the nl80211 notifications that
+ * report those changes are received. 'range_gen' is increased on every
+ * invalidation, so a query that raced with one is not cached.
+ */
+static LIST_HEAD(range_cache);
+static unsigned int range_gen;
+static pthread_mutex_t range_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static LIST_HEAD(scan_reqs);
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * wifi_ioctl() - Execute WiFi IOCL
  *
@@ -105,6 +211,367 @@ static double freq2float(struct iw_freq freq)
 	return res;
 }
 
+/*
+ * check_iface_name() - Verify that an interface name is valid
+ *
+ * @iface_name:	The interface name to check.
+ * @func:	Name of the calling function, for the log message.
+ *
+ * NULL and empty names are treated as interfaces that do not exist, like
+ * 'ldx_wifi_iface_exists()' does.
+ *
+ * Return: True if the name is valid, false otherwise.
+ */
+static bool check_iface_name(const char *iface_name, const char *func)
+{
+	if (iface_name != NULL && iface_name[0] != '\0')
+		return true;
+
+	log_debug("%s: Invalid interface name: %s", func,
+		  ldx_wifi_code_to_str(WIFI_STATE_ERROR_NO_EXIST));
+
+	return false;
+}
+
+/*
+ * get_iface_index() - Retrieve the index of an interface
+ *
+ * @iface_name:	Name of the interface.
+ * @sock:	Socket for the IOCTL.
+ * @index:	Integer to store the index.
+ *
+ * Return: WIFI_STATE_ERROR_NONE on success, WIFI_STATE_ERROR_NO_EXIST otherwise.
+ */
+static wifi_state_error_t get_iface_index(const char *iface_name, int sock, int *index)
+{
+	struct ifreq ifr;
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, iface_name, IFNAMSIZ - 1);
+	if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0)
+		return WIFI_STATE_ERROR_NO_EXIST;
+
+	*index = ifr.ifr_ifindex;
+
+	return WIFI_STATE_ERROR_NONE;
+}
+
+/*
+ * parse_ies() - Parse the information elements of a BSS
+ *
+ * @ies:	The information elements.
+ * @len:	Length of the information elements.
+ * @ssid:	String of IW_ESSID_MAX_SIZE bytes to store the SSID, can be
+ *		NULL.
+ *
+ * Like the security reported by NetworkManager, the most secure of the
+ * advertised modes is returned.
+ *
+ * Return: The security mode of the BSS, WIFI_SEC_MODE_OPEN if it does not
+ *	   advertise WPA or RSN.
+ */
+static wifi_sec_mode_t parse_ies(const unsigned char *ies, size_t len, char *ssid)
+{
+	wifi_sec_mode_t mode = WIFI_SEC_MODE_OPEN;
+
+	while (len >= 2 && len >= (size_t)ies[1] + 2) {
+		const unsigned char *data = ies + 2;
+		unsigned char id = ies[0], ie_len = ies[1];
+
+		if (id == IE_SSID && ssid != NULL) {
+			size_t n = ie_len < IW_ESSID_MAX_SIZE ? ie_len : IW_ESSID_MAX_SIZE - 1;
+
+			memcpy(ssid, data, n);
+			ssid[n] = '\0';
+		} else if (id == IE_VENDOR && ie_len >= 4
+			   && memcmp(data, wpa_oui, sizeof(wpa_oui)) == 0 && data[3] == 1) {
+			if (mode < WIFI_SEC_MODE_WPA)
+				mode = WIFI_SEC_MODE_WPA;
+		} else if (id == IE_RSN) {
+			/* Version (2), group cipher (4), pairwise ciphers (2 + 4 * n) */
+			size_t off = 6, n, i;
+
+			if (mode < WIFI_SEC_MODE_WPA2)
+				mode = WIFI_SEC_MODE_WPA2;
+
+			if (ie_len >= off + 2) {
+				n = data[off] | (data[off + 1] << 8);
+				off += 2 + 4 * n;
+			}
+
+			if (ie_len >= off + 2) {
+				n = data[off] | (data[off + 1] << 8);
+				off += 2;
+				for (i = 0; i < n && ie_len >= off + 4; i++, off += 4) {
+					if (memcmp(data + off, ieee80211_oui, sizeof(ieee80211_oui)) != 0)
+						continue;
+					switch (data[off + 3]) {
+					case RSN_AKM_SAE:
+					case RSN_AKM_FT_SAE:
+					case RSN_AKM_SAE_EXT:
+					case RSN_AKM_FT_SAE_EXT:
+						mode = WIFI_SEC_MODE_WPA3;
+						break;
+					}
+				}
+			}
+		}
+
+		len -= ie_len + 2;
+		ies += ie_len + 2;
+	}
+
+	return mode;
+}
+
+/*
+ * parse_bss() - Parse a BSS of a NL80211_CMD_GET_SCAN dump
+ *
+ * @nlh:	The NL80211_CMD_NEW_SCAN_RESULTS message.
+ * @bss:	Struct to fill with the BSS data.
+ *
+ * Return: True if the message holds a BSS, false otherwise.
+ */
+static bool parse_bss(struct nlmsghdr *nlh, wifi_bss_t *bss)
+{
+	struct rtattr *tb[NL80211_ATTR_MAX + 1];
+	struct rtattr *attrs[NL80211_BSS_MAX + 1];
+	struct rtattr *ies;
+
+	nl_parse_attrs(tb, NL80211_ATTR_MAX, GENL_ATTRS(nlh), GENL_ATTRS_LEN(nlh));
+	if (tb[NL80211_ATTR_BSS] == NULL)
+		return false;
+
+	nl_parse_attrs(attrs, NL80211_BSS_MAX, RTA_DATA(tb[NL80211_ATTR_BSS]),
+		       RTA_PAYLOAD(tb[NL80211_ATTR_BSS]));
+	if (attrs[NL80211_BSS_BSSID] == NULL
+	    || RTA_PAYLOAD(attrs[NL80211_BSS_BSSID]) < MAC_ADDRESS_GROUPS)
+		return false;
+
+	memset(bss, 0, sizeof(*bss));
+	memcpy(bss->bssid, RTA_DATA(attrs[NL80211_BSS_BSSID]), MAC_ADDRESS_GROUPS);
+	bss->freq = -1;
+	bss->channel = -1;
+
+	if (attrs[NL80211_BSS_FREQUENCY] != NULL) {
+		uint32_t freq = *(uint32_t *)RTA_DATA(attrs[NL80211_BSS_FREQUENCY]);
+
+		bss->freq = freq * 1e6;
+		bss->channel = nl80211_freq_to_channel(freq);
+	}
+
+	if (attrs[NL80211_BSS_SIGNAL_MBM] != NULL)
+		bss->signal = *(int32_t *)RTA_DATA(attrs[NL80211_BSS_SIGNAL_MBM]) / 100;
+
+	if (attrs[NL80211_BSS_SEEN_MS_AGO] != NULL)
+		bss->age = *(uint32_t *)RTA_DATA(attrs[NL80211_BSS_SEEN_MS_AGO]);
+
+	if (attrs[NL80211_BSS_STATUS] != NULL) {
+		uint32_t status = *(uint32_t *)RTA_DATA(attrs[NL80211_BSS_STATUS]);
+
+		bss->associated = status == NL80211_BSS_STATUS_ASSOCIATED
+				  || status == NL80211_BSS_STATUS_IBSS_JOINED;
+	}
+
+	bss->sec_mode = WIFI_SEC_MODE_OPEN;
+	ies = attrs[NL80211_BSS_INFORMATION_ELEMENTS];
+	if (ies != NULL)
+		bss->sec_mode = parse_ies(RTA_DATA(ies), RTA_PAYLOAD(ies), bss->ssid);
+
+	/* Privacy without WPA or RSN is WEP, not a supported mode */
+	if (bss->sec_mode == WIFI_SEC_MODE_OPEN && attrs[NL80211_BSS_CAPABILITY] != NULL
+	    && (*(uint16_t *)RTA_DATA(attrs[NL80211_BSS_CAPABILITY]) & BSS_CAPABILITY_PRIVACY))
+		bss->sec_mode = WIFI_SEC_MODE_ERROR;
+
+	return true;
+}
+
+/*
+ * bss_list_cb() - Add each BSS of a NL80211_CMD_GET_SCAN dump to a list
+ *
+ * @nlh:	The NL80211_CMD_NEW_SCAN_RESULTS message.
+ * @arg:	The bss_list_t to fill.
+ *
+ * Return: 0 to keep on processing the dump, 1 if out of memory.
+ */
+static int bss_list_cb(struct nlmsghdr *nlh, void *arg)
+{
+	bss_list_t *list = arg;
+
+	if (list->n_bss == list->size) {
+		int size = list->size > 0 ? list->size * 2 : 16;
+		wifi_bss_t *tmp = realloc(list->bss, size * sizeof(*tmp));
+
+		if (tmp == NULL) {
+			list->no_mem = true;
+			return 1;
+		}
+		list->bss = tmp;
+		list->size = size;
+	}
+
+	if (parse_bss(nlh, &list->bss[list->n_bss]))
+		list->n_bss++;
+
+	return 0;
+}
+
+/*
+ * scan_cb() - Find the associated BSS in a NL80211_CMD_GET_SCAN dump
+ *
+ * @nlh:	The NL80211_CMD_NEW_SCAN_RESULTS message.
+ * @arg:	The nl_iface_t to fill.
+ *
+ * Return: 1 once the associated BSS is found, 0 otherwise.
+ */
+static int scan_cb(struct nlmsghdr *nlh, void *arg)
+{
+	nl_iface_t *data = arg;
+	wifi_bss_t bss;
+
+	if (!parse_bss(nlh, &bss) || !bss.associated)
+		return 0;
+
+	data->sec_mode = bss.sec_mode;
+	data->found = true;
+
+	return 1;
+}
+
+/*
+ * get_bss_list() - Retrieve the scan results of an interface
+ *
+ * @iface_name:	Name of the wireless interface.
+ * @index:	Index of the interface.
+ * @bss:	A pointer to store the results, NULL if there are none.
+ *
+ * Return: The number of results, -1 on error.
+ */
+static int get_bss_list(const char *iface_name, int index, wifi_bss_t **bss)
+{
+	bss_list_t list = { 0 };
+
+	*bss = NULL;
+
+	if (nl80211_request(NL80211_CMD_GET_SCAN, NLM_F_DUMP, index, bss_list_cb,
+			    &list) != EXIT_SUCCESS || list.no_mem) {
+		log_debug("%s: %s of '%s': %s", __func__,
+			  ldx_wifi_code_to_str(WIFI_STATE_ERROR_SCAN), iface_name,
+			  list.no_mem ? "Out of memory" : strerror(errno));
+		free(list.bss);
+		return -1;
+	}
+
+	if (list.n_bss == 0) {
+		free(list.bss);
+		return 0;
+	}
+
+	*bss = list.bss;
+
+	return list.n_bss;
+}
+
+/*
+ * complete_scans() - Deliver the results of the pending scans
+ *
+ * @index:	Index of the interface whose scan finished, -1 for all.
+ * @success:	False if the scan was aborted or its completion was missed.
+ */
+static void complete_scans(int index, bool success)
+{
+	LIST_HEAD(done);
+	scan_req_t *req, *tmp;
+	wifi_bss_t *bss = NULL;
+	int n_bss = -1;
+
+	pthread_mutex_lock(&scan_lock);
+	list_for_each_entry_safe(req, tmp, &scan_reqs, list) {
+		if (index < 0 || req->index == index)
+			list_move_tail(&req->list, &done);
+	}
+	pthread_mutex_unlock(&scan_lock);
+
+	if (list_empty(&done))
+		return;
+
+	list_for_each_entry_safe(req, tmp, &done, list) {
+		/* Requests of the same interface share a single dump */
+		if (success && bss == NULL && n_bss < 0)
+			n_bss = get_bss_list(req->iface_name, req->index, &bss);
+
+		req->cb(req->iface_name, n_bss, bss, req->arg);
+
+		list_del(&req->list);
+		free(req);
+	}
+
+	free(bss);
+}
+
+/*
+ * range_cache_clear() - Invalidate the cached range information
+ */
+static void range_cache_clear(void)
+{
+	range_entry_t *entry, *tmp;
+
+	pthread_mutex_lock(&range_lock);
+	list_for_each_entry_safe(entry, tmp, &range_cache, list) {
+		list_del(&entry->list);
+		free(entry);
+	}
+	range_gen++;
+	pthread_mutex_unlock(&range_lock);
+}
+
+/*
+ * nl80211_event_cb() - Process the nl80211 notifications
+ *
+ * @nlh:	The notification, NULL if notifications were lost.
+ * @arg:	Unused.
+ *
+ * Return: 0 always.
+ */
+static int nl80211_event_cb(struct nlmsghdr *nlh, void *arg)
+{
+	struct rtattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *genl;
+	int index = -1;
+
+	(void)arg;
+
+	if (nlh == NULL) {
+		range_cache_clear();
+		complete_scans(-1, false);
+		return 0;
+	}
+
+	genl = NLMSG_DATA(nlh);
+	switch (genl->cmd) {
+	case NL80211_CMD_NEW_SCAN_RESULTS:
+	case NL80211_CMD_SCAN_ABORTED:
+		nl_parse_attrs(tb, NL80211_ATTR_MAX, GENL_ATTRS(nlh), GENL_ATTRS_LEN(nlh));
+		if (tb[NL80211_ATTR_IFINDEX] != NULL)
+			index = *(uint32_t *)RTA_DATA(tb[NL80211_ATTR_IFINDEX]);
+		if (index > 0)
+			complete_scans(index, genl->cmd == NL80211_CMD_NEW_SCAN_RESULTS);
+		break;
+	case NL80211_CMD_NEW_WIPHY:
+	case NL80211_CMD_DEL_WIPHY:
+	case NL80211_CMD_NEW_INTERFACE:
+	case NL80211_CMD_DEL_INTERFACE:
+	case NL80211_CMD_REG_CHANGE:
+	case NL80211_CMD_WIPHY_REG_CHANGE:
+		range_cache_clear();
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
 /*
  * get_range_info() - Retrieve the range information of the provided interface
  *
@@ -119,21 +586,53 @@ static wifi_state_error_t get_range_info(const char *iface_name, int sock, struc
 	struct iwreq wreq;
 	char buffer[sizeof(struct iw_range) * 2]; /* Large enough */
 	wifi_state_error_t ret = WIFI_STATE_ERROR_RANGE_INFO;
+	range_entry_t *entry;
+	unsigned int gen = 0;
+	int index = -1;
+	bool cache;
+
+	cache = get_iface_index(iface_name, sock, &index) == WIFI_STATE_ERROR_NONE
+		&& nl80211_events_start(nl80211_event_cb, NULL) == EXIT_SUCCESS;
+	if (cache) {
+		pthread_mutex_lock(&range_lock);
+		list_for_each_entry(entry, &range_cache, list) {
+			if (entry->index == index) {
+				memcpy(range, &entry->range, sizeof(*range));
+				pthread_mutex_unlock(&range_lock);
+				return WIFI_STATE_ERROR_NONE;
+			}
+		}
+		gen = range_gen;
+		pthread_mutex_unlock(&range_lock);
+	}
 
 	memset(buffer, 0, sizeof(buffer));
 
 	wreq.u.data.pointer = (caddr_t) buffer;
 	wreq.u.data.length = sizeof(buffer);
 	wreq.u.data.flags = 0;
-	if(wifi_ioctl(sock, iface_name, SIOCGIWRANGE, &wreq) >= 0) {
-		ret = WIFI_STATE_ERROR_NONE;
-		memcpy((char *)range, buffer, sizeof(struct iw_range));
-	} else {
+	if (wifi_ioctl(sock, iface_name, SIOCGIWRANGE, &wreq) < 0) {
 		log_debug("%s: %s of '%s': %s (%d)", __func__,
 			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
+		return ret;
 	}
 
-	return ret;
+	memcpy((char *)range, buffer, sizeof(struct iw_range));
+
+	if (cache) {
+		entry = malloc(sizeof(*entry));
+		pthread_mutex_lock(&range_lock);
+		if (entry != NULL && gen == range_gen) {
+			entry->index = index;
+			memcpy(&entry->range, range, sizeof(*range));
+			list_add_tail(&entry->list, &range_cache);
+			entry = NULL;
+		}
+		pthread_mutex_unlock(&range_lock);
+		free(entry);
+	}
+
+	return WIFI_STATE_ERROR_NONE;
 }
 
 /*
@@ -236,71 +735,151 @@ static wifi_state_error_t get_channel(const char *iface_name, int sock, double f
  * get_sec_mode() - Retrieve the WiFi security mode
  *
  * @iface_name:	Name of the wireless interface to retrieve its security mode.
- * @freq:	WiFi security mode.
+ * @index:	Index of the interface.
+ * @mode:	WiFi security mode.
  *
- * Return: WIFI_STATE_ERROR_NONE on success, WIFI_STATE_ERROR_CHANNEL or
- * WIFI_STATE_ERROR_NO_MEM otherwise.
+ * The security mode is taken from the scan results of the associated access
+ * point.
+ *
+ * Return: WIFI_STATE_ERROR_NONE on success, WIFI_STATE_ERROR_SEC_MODE
+ * otherwise.
  */
-static wifi_state_error_t get_sec_mode(const char *iface_name, wifi_sec_mode_t *mode)
+static wifi_state_error_t get_sec_mode(const char *iface_name, int index, wifi_sec_mode_t *mode)
 {
-	char *cmd = NULL, *resp = NULL, *token = NULL;
-	char delim[] = " ";
+	nl_iface_t data = { .sec_mode = WIFI_SEC_MODE_ERROR };
 	wifi_state_error_t ret = WIFI_STATE_ERROR_SEC_MODE;
-	size_t len;
 
 	*mode = WIFI_SEC_MODE_ERROR;
 
-	len = snprintf(NULL, 0, CMD_GET_SECURITY, iface_name);
-	cmd = calloc(len + 1, sizeof(char));
-	if (cmd == NULL) {
-		ret = WIFI_STATE_ERROR_NO_MEM;
-		log_debug("%s: Unable to get security mode of '%s': %s",
-			  __func__, iface_name, ldx_wifi_code_to_str(ret));
+	if (nl80211_request(NL80211_CMD_GET_SCAN, NLM_F_DUMP, index, scan_cb,
+			    &data) != EXIT_SUCCESS) {
+		log_debug("%s: %s of '%s': %s (%d)", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
 		return ret;
 	}
 
-	sprintf(cmd, CMD_GET_SECURITY, iface_name);
-
-	if (ldx_process_execute_cmd(cmd, &resp, 2) != 0) {
-		if (resp != NULL) {
-			log_debug("%s: %s of '%s': %s", __func__,
-				  ldx_wifi_code_to_str(ret), iface_name, resp);
-			free(resp);
-		} else {
-			log_debug("%s: %s of '%s'", __func__,
-				  ldx_wifi_code_to_str(ret), iface_name);
-		}
-		goto done;
+	if (!data.found) {
+		log_debug("%s: %s of '%s': Access point not found", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name);
+		return ret;
 	}
 
-	if (resp == NULL || strlen(resp) == 0)
-		goto done;
+	*mode = data.sec_mode;
 
-	resp[strlen(resp) - 1] = '\0';  /* Remove the last line feed */
-	if (strlen(resp) == 0) { /* Empty is an open access point */
-		*mode = 0;
-		ret = WIFI_STATE_ERROR_NONE;
-		goto done;
-	}
+	return *mode == WIFI_SEC_MODE_ERROR ? ret : WIFI_STATE_ERROR_NONE;
+}
+
+/*
+ * interface_cb() - Process the reply of NL80211_CMD_GET_INTERFACE
+ *
+ * @nlh:	The NL80211_CMD_NEW_INTERFACE message.
+ * @arg:	The nl_iface_t to fill.
+ *
+ * Return: 0 always.
+ */
+static int interface_cb(struct nlmsghdr *nlh, void *arg)
+{
+	struct rtattr *tb[NL80211_ATTR_MAX + 1];
+	nl_iface_t *data = arg;
 
-	token = strtok(resp, delim);
-	while (token) {
-		int i;
+	nl_parse_attrs(tb, NL80211_ATTR_MAX, GENL_ATTRS(nlh), GENL_ATTRS_LEN(nlh));
 
-		for (i = 0; i < ARRAY_SIZE(wifi_sec_mode_names); i++) {
-			if (strncmp(token, wifi_sec_mode_names[i], strlen(wifi_sec_mode_names[i])) == 0
-				&& *mode < i) {
-				*mode = i;
-				ret = WIFI_STATE_ERROR_NONE;
-				break;
-			}
-		}
-		token = strtok(NULL, delim);
+	if (tb[NL80211_ATTR_SSID] != NULL) {
+		size_t len = RTA_PAYLOAD(tb[NL80211_ATTR_SSID]);
+
+		if (len > IW_ESSID_MAX_SIZE - 1)
+			len = IW_ESSID_MAX_SIZE - 1;
+		memcpy(data->ssid, RTA_DATA(tb[NL80211_ATTR_SSID]), len);
+		data->ssid[len] = '\0';
 	}
-done:
-	free(cmd);
 
-	return ret;
+	if (tb[NL80211_ATTR_WIPHY_FREQ] != NULL)
+		data->freq = *(uint32_t *)RTA_DATA(tb[NL80211_ATTR_WIPHY_FREQ]);
+
+	return 0;
+}
+
+/*
+ * get_bitrate() - Get the bitrate of a NL80211_STA_INFO_*_BITRATE attribute
+ *
+ * @rta:	The nested rate information.
+ *
+ * Return: The bitrate in kbit/s, 0 if not reported.
+ */
+static unsigned int get_bitrate(struct rtattr *rta)
+{
+	struct rtattr *tb[NL80211_RATE_INFO_MAX + 1];
+
+	nl_parse_attrs(tb, NL80211_RATE_INFO_MAX, RTA_DATA(rta), RTA_PAYLOAD(rta));
+
+	/* Both are in units of 100 kbit/s */
+	if (tb[NL80211_RATE_INFO_BITRATE32] != NULL)
+		return *(uint32_t *)RTA_DATA(tb[NL80211_RATE_INFO_BITRATE32]) * 100;
+	if (tb[NL80211_RATE_INFO_BITRATE] != NULL)
+		return *(uint16_t *)RTA_DATA(tb[NL80211_RATE_INFO_BITRATE]) * 100;
+
+	return 0;
+}
+
+/*
+ * station_cb() - Process the first station of a NL80211_CMD_GET_STATION dump
+ *
+ * @nlh:	The NL80211_CMD_NEW_STATION message.
+ * @arg:	The station_query_t to fill.
+ *
+ * Return: 1 once a station is processed, 0 otherwise.
+ */
+static int station_cb(struct nlmsghdr *nlh, void *arg)
+{
+	struct rtattr *tb[NL80211_ATTR_MAX + 1];
+	struct rtattr *sta[NL80211_STA_INFO_MAX + 1];
+	station_query_t *query = arg;
+	wifi_station_info_t *info = query->info;
+
+	nl_parse_attrs(tb, NL80211_ATTR_MAX, GENL_ATTRS(nlh), GENL_ATTRS_LEN(nlh));
+	if (tb[NL80211_ATTR_MAC] == NULL || tb[NL80211_ATTR_STA_INFO] == NULL)
+		return 0;
+
+	nl_parse_attrs(sta, NL80211_STA_INFO_MAX, RTA_DATA(tb[NL80211_ATTR_STA_INFO]),
+		       RTA_PAYLOAD(tb[NL80211_ATTR_STA_INFO]));
+
+	memcpy(info->bssid, RTA_DATA(tb[NL80211_ATTR_MAC]), MAC_ADDRESS_GROUPS);
+	query->found = true;
+
+	if (sta[NL80211_STA_INFO_SIGNAL] != NULL)
+		info->signal = *(int8_t *)RTA_DATA(sta[NL80211_STA_INFO_SIGNAL]);
+	if (sta[NL80211_STA_INFO_SIGNAL_AVG] != NULL)
+		info->signal_avg = *(int8_t *)RTA_DATA(sta[NL80211_STA_INFO_SIGNAL_AVG]);
+	if (sta[NL80211_STA_INFO_TX_BITRATE] != NULL)
+		info->tx_bitrate = get_bitrate(sta[NL80211_STA_INFO_TX_BITRATE]);
+	if (sta[NL80211_STA_INFO_RX_BITRATE] != NULL)
+		info->rx_bitrate = get_bitrate(sta[NL80211_STA_INFO_RX_BITRATE]);
+	if (sta[NL80211_STA_INFO_TX_RETRIES] != NULL)
+		info->tx_retries = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_TX_RETRIES]);
+	if (sta[NL80211_STA_INFO_TX_FAILED] != NULL)
+		info->tx_failed = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_TX_FAILED]);
+	if (sta[NL80211_STA_INFO_RX_PACKETS] != NULL)
+		info->rx_packets = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_RX_PACKETS]);
+	if (sta[NL80211_STA_INFO_TX_PACKETS] != NULL)
+		info->tx_packets = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_TX_PACKETS]);
+
+	if (sta[NL80211_STA_INFO_RX_BYTES64] != NULL)
+		memcpy(&info->rx_bytes, RTA_DATA(sta[NL80211_STA_INFO_RX_BYTES64]),
+		       sizeof(info->rx_bytes));
+	else if (sta[NL80211_STA_INFO_RX_BYTES] != NULL)
+		info->rx_bytes = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_RX_BYTES]);
+	if (sta[NL80211_STA_INFO_TX_BYTES64] != NULL)
+		memcpy(&info->tx_bytes, RTA_DATA(sta[NL80211_STA_INFO_TX_BYTES64]),
+		       sizeof(info->tx_bytes));
+	else if (sta[NL80211_STA_INFO_TX_BYTES] != NULL)
+		info->tx_bytes = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_TX_BYTES]);
+
+	if (sta[NL80211_STA_INFO_CONNECTED_TIME] != NULL)
+		info->connected_time = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_CONNECTED_TIME]);
+	if (sta[NL80211_STA_INFO_INACTIVE_TIME] != NULL)
+		info->inactive_time = *(uint32_t *)RTA_DATA(sta[NL80211_STA_INFO_INACTIVE_TIME]);
+
+	return 1;
 }
 
 const char *ldx_wifi_code_to_str(wifi_state_error_t code)
@@ -313,14 +892,13 @@ const char *ldx_wifi_code_to_str(wifi_state_error_t code)
 
 bool ldx_wifi_iface_exists(const char* iface_name)
 {
-	bool exists = false;
-	int sock = -1;
 	struct iwreq wreq;
+	int sock;
 
 	if (!ldx_net_iface_exists(iface_name))
 		return false;
 
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	sock = ctl_socket_get(CTL_SOCKET_INET);
 	if (sock == -1) {
 		log_debug("%s: Unable to check if interface '%s' exists: %s (%d)",
 			  __func__, iface_name, strerror(errno), errno);
@@ -328,11 +906,8 @@ bool ldx_wifi_iface_exists(const char* iface_name)
 	}
 
 	memset(&wreq, 0, sizeof(wreq));
-	exists = wifi_ioctl(sock, iface_name, SIOCGIWNAME, &wreq) >= 0;
 
-	close(sock);
-
-	return exists;
+	return wifi_ioctl(sock, iface_name, SIOCGIWNAME, &wreq) >= 0;
 }
 
 int ldx_wifi_list_available_ifaces(net_names_list_t *iface_list)
@@ -358,7 +933,7 @@ int ldx_wifi_list_available_ifaces(net_names_list_t *iface_list)
 
 wifi_state_error_t ldx_wifi_get_iface_state(const char *iface_name, wifi_state_t *wifi_state)
 {
-	int sock = -1;
+	int sock = -1, index;
 	wifi_state_error_t ret;
 
 	memset(wifi_state, 0, sizeof(*wifi_state));
@@ -366,6 +941,9 @@ wifi_state_error_t ldx_wifi_get_iface_state(const char *iface_name, wifi_state_t
 	wifi_state->channel = -1;
 	wifi_state->sec_mode = WIFI_SEC_MODE_ERROR;
 
+	if (!check_iface_name(iface_name, __func__))
+		return WIFI_STATE_ERROR_NO_EXIST;
+
 	if (!ldx_wifi_iface_exists(iface_name)) {
 		ret = WIFI_STATE_ERROR_NO_EXIST;
 		log_debug("%s: Unable to get state of '%s': %s", __func__,
@@ -380,12 +958,12 @@ wifi_state_error_t ldx_wifi_get_iface_state(const char *iface_name, wifi_state_t
 	if (wifi_state->net_state.status != NET_STATUS_CONNECTED)
 		wifi_state->sec_mode = WIFI_SEC_MODE_ERROR;
 
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	sock = ctl_socket_get(CTL_SOCKET_INET);
 	if (sock == -1) {
 		ret = WIFI_STATE_ERROR_STATE;
 		log_debug("%s: %s of '%s': %s (%d)", __func__,
 			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
-		goto done;
+		return ret;
 	}
 
 	ret = get_ssid(iface_name, sock, wifi_state->ssid);
@@ -395,17 +973,235 @@ wifi_state_error_t ldx_wifi_get_iface_state(const char *iface_name, wifi_state_t
 		get_channel(iface_name, sock, wifi_state->freq, &wifi_state->channel);
 
 	if (wifi_state->net_state.status == NET_STATUS_CONNECTED) {
-		wifi_state_error_t err = get_sec_mode(iface_name, &wifi_state->sec_mode);
+		wifi_state_error_t err = get_iface_index(iface_name, sock, &index);
+
+		if (err == WIFI_STATE_ERROR_NONE)
+			err = get_sec_mode(iface_name, index, &wifi_state->sec_mode);
 		if (ret == WIFI_STATE_ERROR_NONE)
 			ret = err;
 	}
-done:
-	if (sock > -1)
-		close(sock);
 
 	return ret;
 }
 
+wifi_state_error_t ldx_wifi_get_iface_state_fast(const char *iface_name, wifi_state_t *wifi_state)
+{
+	nl_iface_t data = { .sec_mode = WIFI_SEC_MODE_ERROR };
+	wifi_state_error_t ret;
+	int sock, index;
+
+	if (wifi_state == NULL) {
+		log_error("%s: Wi-Fi state cannot be NULL", __func__);
+		return WIFI_STATE_ERROR_STATE;
+	}
+
+	memset(wifi_state, 0, sizeof(*wifi_state));
+	data.ssid = wifi_state->ssid;
+	wifi_state->freq = -1;
+	wifi_state->channel = -1;
+	wifi_state->sec_mode = WIFI_SEC_MODE_ERROR;
+
+	if (!check_iface_name(iface_name, __func__))
+		return WIFI_STATE_ERROR_NO_EXIST;
+
+	sock = ctl_socket_get(CTL_SOCKET_INET);
+	if (sock == -1) {
+		ret = WIFI_STATE_ERROR_STATE;
+		log_debug("%s: %s of '%s': %s (%d)", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
+		return ret;
+	}
+
+	ret = get_iface_index(iface_name, sock, &index);
+	if (ret != WIFI_STATE_ERROR_NONE) {
+		log_debug("%s: Unable to get state of '%s': %s", __func__,
+			  iface_name, ldx_wifi_code_to_str(ret));
+		return ret;
+	}
+
+	/* Interfaces that are not wireless are rejected by nl80211 */
+	if (nl80211_request(NL80211_CMD_GET_INTERFACE, 0, index, interface_cb,
+			    &data) != EXIT_SUCCESS) {
+		ret = errno == ENODEV || errno == EOPNOTSUPP ?
+			WIFI_STATE_ERROR_NO_EXIST : WIFI_STATE_ERROR_STATE;
+		log_debug("%s: %s of '%s': %s (%d)", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
+		return ret;
+	}
+
+	ret = ldx_net_get_iface_state(iface_name, &(wifi_state->net_state));
+	if (ret != WIFI_STATE_ERROR_NONE)
+		return ret;
+
+	/* Older kernels only report the SSID of access points */
+	if (wifi_state->ssid[0] == '\0')
+		ret = get_ssid(iface_name, sock, wifi_state->ssid);
+
+	if (data.freq > 0) {
+		wifi_state->freq = data.freq * 1e6;
+		wifi_state->channel = nl80211_freq_to_channel(data.freq);
+	}
+
+	if (wifi_state->net_state.status == NET_STATUS_CONNECTED) {
+		wifi_state_error_t err = get_sec_mode(iface_name, index, &wifi_state->sec_mode);
+
+		if (ret == WIFI_STATE_ERROR_NONE)
+			ret = err;
+	}
+
+	return ret;
+}
+
+wifi_state_error_t ldx_wifi_scan_start(const char *iface_name, const ldx_wifi_scan_cb_t cb, void *arg)
+{
+	/* A single wildcard SSID makes an active scan */
+	struct {
+		struct rtattr ssids;
+		struct rtattr wildcard;
+	} attrs = {
+		.ssids = { .rta_len = 2 * RTA_LENGTH(0), .rta_type = NL80211_ATTR_SCAN_SSIDS | NLA_F_NESTED },
+		.wildcard = { .rta_len = RTA_LENGTH(0), .rta_type = 1 },
+	};
+	wifi_state_error_t ret = WIFI_STATE_ERROR_SCAN;
+	scan_req_t *req = NULL, *pending;
+	int sock, index, err;
+	bool completed = true;
+
+	if (!check_iface_name(iface_name, __func__))
+		return WIFI_STATE_ERROR_NO_EXIST;
+
+	sock = ctl_socket_get(CTL_SOCKET_INET);
+	if (sock == -1 || get_iface_index(iface_name, sock, &index) != WIFI_STATE_ERROR_NONE) {
+		ret = WIFI_STATE_ERROR_NO_EXIST;
+		log_debug("%s: Unable to scan '%s': %s", __func__,
+			  iface_name, ldx_wifi_code_to_str(ret));
+		return ret;
+	}
+
+	if (cb != NULL) {
+		if (nl80211_events_start(nl80211_event_cb, NULL) != EXIT_SUCCESS) {
+			log_debug("%s: %s '%s': Unable to receive nl80211 notifications",
+				  __func__, ldx_wifi_code_to_str(ret), iface_name);
+			return ret;
+		}
+
+		req = calloc(1, sizeof(*req));
+		if (req == NULL) {
+			ret = WIFI_STATE_ERROR_NO_MEM;
+			log_debug("%s: Unable to scan '%s': %s", __func__,
+				  iface_name, ldx_wifi_code_to_str(ret));
+			return ret;
+		}
+
+		req->index = index;
+		strncpy(req->iface_name, iface_name, IFNAMSIZ - 1);
+		req->cb = cb;
+		req->arg = arg;
+
+		/* Queued before the trigger, so its completion cannot be missed */
+		pthread_mutex_lock(&scan_lock);
+		list_add_tail(&req->list, &scan_reqs);
+		pthread_mutex_unlock(&scan_lock);
+	}
+
+	/* EBUSY means a scan is already running, its results are delivered */
+	if (nl80211_request_attrs(NL80211_CMD_TRIGGER_SCAN, 0, index, &attrs,
+				  sizeof(attrs), NULL, NULL) == EXIT_SUCCESS
+	    || errno == EBUSY)
+		return WIFI_STATE_ERROR_NONE;
+
+	err = errno;
+
+	if (req != NULL) {
+		pthread_mutex_lock(&scan_lock);
+		list_for_each_entry(pending, &scan_reqs, list) {
+			if (pending == req) {
+				list_del(&req->list);
+				completed = false;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&scan_lock);
+
+		/* The callback already got the results of another scan */
+		if (completed)
+			return WIFI_STATE_ERROR_NONE;
+
+		free(req);
+	}
+
+	log_debug("%s: %s '%s': %s (%d)", __func__, ldx_wifi_code_to_str(ret),
+		  iface_name, strerror(err), err);
+
+	return ret;
+}
+
+int ldx_wifi_get_scan_results(const char *iface_name, wifi_bss_t **bss)
+{
+	int sock, index;
+
+	if (bss == NULL) {
+		log_error("%s: BSS list cannot be NULL", __func__);
+		return -1;
+	}
+
+	*bss = NULL;
+
+	if (!check_iface_name(iface_name, __func__))
+		return -1;
+
+	sock = ctl_socket_get(CTL_SOCKET_INET);
+	if (sock == -1 || get_iface_index(iface_name, sock, &index) != WIFI_STATE_ERROR_NONE) {
+		log_debug("%s: %s of '%s': %s", __func__,
+			  ldx_wifi_code_to_str(WIFI_STATE_ERROR_SCAN), iface_name,
+			  ldx_wifi_code_to_str(WIFI_STATE_ERROR_NO_EXIST));
+		return -1;
+	}
+
+	return get_bss_list(iface_name, index, bss);
+}
+
+wifi_state_error_t ldx_wifi_get_station_info(const char *iface_name, wifi_station_info_t *info)
+{
+	station_query_t query = { .info = info, .found = false };
+	wifi_state_error_t ret = WIFI_STATE_ERROR_STATION;
+	int sock, index;
+
+	if (info == NULL) {
+		log_error("%s: Station information cannot be NULL", __func__);
+		return ret;
+	}
+
+	memset(info, 0, sizeof(*info));
+
+	if (!check_iface_name(iface_name, __func__))
+		return WIFI_STATE_ERROR_NO_EXIST;
+
+	sock = ctl_socket_get(CTL_SOCKET_INET);
+	if (sock == -1 || get_iface_index(iface_name, sock, &index) != WIFI_STATE_ERROR_NONE) {
+		ret = WIFI_STATE_ERROR_NO_EXIST;
+		log_debug("%s: %s of '%s': %s", __func__,
+			  ldx_wifi_code_to_str(WIFI_STATE_ERROR_STATION), iface_name,
+			  ldx_wifi_code_to_str(ret));
+		return ret;
+	}
+
+	if (nl80211_request(NL80211_CMD_GET_STATION, NLM_F_DUMP, index, station_cb,
+			    &query) != EXIT_SUCCESS) {
+		log_debug("%s: %s of '%s': %s (%d)", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name, strerror(errno), errno);
+		return ret;
+	}
+
+	if (!query.found) {
+		log_debug("%s: %s of '%s': Not connected", __func__,
+			  ldx_wifi_code_to_str(ret), iface_name);
+		return ret;
+	}
+
+	return WIFI_STATE_ERROR_NONE;
+}
+
 wifi_state_error_t ldx_wifi_set_config(wifi_config_t wifi_cfg)
 {
 	char *iface_name = wifi_cfg.name;
@@ -544,11 +1340,11 @@ int ldx_wifi_list_available_freqs(const char *iface_name, double **freqs)
 
 	*freqs = NULL;
 
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	sock = ctl_socket_get(CTL_SOCKET_INET);
 	if (sock == -1) {
 		log_error("%s: Unable to get available frequencies of '%s': %s (%d)",
 			  __func__, iface_name, strerror(errno), errno);
-		goto done;
+		return -1;
 	}
 
 	if (get_range_info(iface_name, sock, &range) != 0)
@@ -570,9 +1366,6 @@ int ldx_wifi_list_available_freqs(const char *iface_name, double **freqs)
 		(*freqs)[i] = freq2float(range.freq[i]);
 
 done:
-	if (sock > -1)
-		close(sock);
-
 	return n_freqs;
 }
 
@@ -583,11 +1376,11 @@ int ldx_wifi_list_available_channels(const char *iface_name, int **channels)
 
 	*channels = NULL;
 
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	sock = ctl_socket_get(CTL_SOCKET_INET);
 	if (sock == -1) {
 		log_error("%s: Unable to get available channels of '%s': %s (%d)",
 			  __func__, iface_name, strerror(errno), errno);
-		goto done;
+		return -1;
 	}
 
 	if (get_range_info(iface_name, sock, &range) != 0)
@@ -609,9 +1402,6 @@ int ldx_wifi_list_available_channels(const char *iface_name, int **channels)
 		(*channels)[i] = range.freq[i].i;
 
 done:
-	if (sock > -1)
-		close(sock);
-
 	return n_channels;
 }
 